@@ -0,0 +1,201 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : foreign facility test                                           *
+ * File  : engines_c.c                                                     *
+ * Descr.: test file - C part (parallel engines)                           *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "gprolog.h"
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define NB_ENGINES                 8
+#define NB_QUERIES                 1000
+#define N                          100
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static PlEngine engine[NB_ENGINES];
+static int nb_errors[NB_ENGINES];
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INTERVAL                                                                *
+ *                                                                         *
+ * A non-deterministic predicate: interval(Low, High, X) enumerates the    *
+ * integers X in Low..High. The choice buffer (choice_size(1)) and the     *
+ * choice counter are private to the engine calling it.                    *
+ *-------------------------------------------------------------------------*/
+PlBool
+interval(PlLong low, PlLong high, PlLong *x)
+{
+  PlLong *next;
+
+  next = Pl_Get_Choice_Buffer(PlLong *); /* recover the buffer */
+
+  if (Pl_Get_Choice_Counter() == 0) /* first invocation ? */
+    *next = low;
+
+  if (*next >= high)		/* last solution (or none) */
+    Pl_No_More_Choice();	/* remove choice-point */
+
+  if (*next > high)
+    return PL_FALSE;		/* fail */
+
+  *x = (*next)++;
+  return PL_TRUE;		/* succeed */
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RUN                                                                     *
+ *                                                                         *
+ * Executed by each thread on its own engine: compares the solutions of    *
+ * interval/3 collected by findall/3 (solutions/3) and by the C API.       *
+ *-------------------------------------------------------------------------*/
+static void *
+Run(void *arg)
+{
+  int k = (int) (PlLong) arg;
+  PlTerm args[3];
+  PlLong nb, sum;
+  int res, i;
+
+  if (!Pl_Engine_Attach(engine[k]))
+    {
+      nb_errors[k]++;
+      return NULL;
+    }
+
+  for (i = 0; i < NB_QUERIES; i++)
+    {
+      Pl_Query_Begin(PL_TRUE);
+      args[0] = Pl_Mk_Integer(N);
+      args[1] = Pl_Mk_Variable();
+      args[2] = Pl_Mk_Variable();
+      res = Pl_Query_Call(Pl_Find_Atom("solutions"), 3, args);
+      if (res != PL_SUCCESS || Pl_Rd_Integer(args[1]) != N ||
+	  Pl_Rd_Integer(args[2]) != N * (N + 1) / 2)
+	nb_errors[k]++;
+      Pl_Query_End(PL_RECOVER);
+
+      Pl_Query_Begin(PL_TRUE);
+      args[0] = Pl_Mk_Integer(1);
+      args[1] = Pl_Mk_Integer(N);
+      args[2] = Pl_Mk_Variable();
+      nb = sum = 0;
+      res = Pl_Query_Call(Pl_Find_Atom("interval"), 3, args);
+      while (res == PL_SUCCESS)
+	{
+	  nb++;
+	  sum += Pl_Rd_Integer(args[2]);
+	  res = Pl_Query_Next_Solution();
+	}
+      if (nb != N || sum != N * (N + 1) / 2)
+	nb_errors[k]++;
+      Pl_Query_End(PL_RECOVER);
+    }
+
+  Pl_Engine_Detach();
+  return NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MAIN                                                                    *
+ *                                                                         *
+ * See comments in EnginePl/main.c about the use of the wrapper function.  *
+ *-------------------------------------------------------------------------*/
+static int
+Main_Wrapper(int argc, char *argv[])
+{
+  pthread_t thread[NB_ENGINES];
+  PlEngine main_engine;
+  int k, nb = 0;
+
+  Pl_Start_Prolog(argc, argv);
+
+  main_engine = Pl_Engine_Current();
+  for (k = 0; k < NB_ENGINES; k++)
+    engine[k] = Pl_Engine_Create();
+
+  Pl_Engine_Detach();		/* let the other threads attach their engine */
+
+  for (k = 0; k < NB_ENGINES; k++)
+    pthread_create(&thread[k], NULL, Run, (void *) (PlLong) k);
+
+  for (k = 0; k < NB_ENGINES; k++)
+    {
+      pthread_join(thread[k], NULL);
+      nb += nb_errors[k];
+    }
+
+  Pl_Engine_Attach(main_engine);
+  for (k = 0; k < NB_ENGINES; k++)
+    Pl_Engine_Destroy(engine[k]);
+
+  printf("%d engines x %d queries: %d error(s)\n", NB_ENGINES, NB_QUERIES, nb);
+
+  Pl_Stop_Prolog();
+  return nb != 0;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  return Main_Wrapper(argc, argv);
+}
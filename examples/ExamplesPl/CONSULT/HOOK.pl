@@ -0,0 +1,11 @@
+% hook file for GNU Prolog (consulted code, i.e. byte-code emulator)
+% Count is passed on the command line as the 1st argument after --
+% q/0 is run by --entry-goal (consulted code is executed by the byte-code
+% emulator, it is only interpreted when the debugger is active)
+
+get_count(Count) :-
+	argument_list([ACount|_]),
+	number_atom(Count, ACount).
+
+get_cpu_time(T) :-
+	statistics(runtime, [T, _]).
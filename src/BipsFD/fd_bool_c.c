@@ -99,11 +99,11 @@
 static WamWord bool_tbl[NB_OF_OP];
 static WamWord bool_xor;
 
-static WamWord stack[BOOL_STACK_SIZE];
-static WamWord *sp;
+static PL_THREAD_LOCAL WamWord *stack;
+static PL_THREAD_LOCAL WamWord *sp;
 
-static WamWord vars_tbl[VARS_STACK_SIZE];
-static WamWord *vars_sp;
+static PL_THREAD_LOCAL WamWord *vars_tbl;
+static PL_THREAD_LOCAL WamWord *vars_sp;
 
 static Bool (*func_tbl[NB_OF_OP + 2]) (WamWord *exp, int result, WamWord *load_word);
 
@@ -213,6 +213,9 @@ Bool Pl_Fd_Lte_2(WamWord le_word, WamWord re_word);
 static void
 Fd_Bool_Initializer(void)
 {
+  Pl_Engine_Add_Buffer(&stack, BOOL_STACK_SIZE * sizeof(WamWord));
+  Pl_Engine_Add_Buffer(&vars_tbl, VARS_STACK_SIZE * sizeof(WamWord));
+
   bool_tbl[NOT] = Functor_Arity(Pl_Create_Atom("#\\"), 1);
 
   bool_tbl[EQUIV] = Functor_Arity(Pl_Create_Atom("#<=>"), 2);
@@ -284,7 +287,7 @@ Pl_Fd_Bool_Meta_3(WamWord le_word, WamWord re_word, WamWord op_word)
   WamWord *adr, *fdv_adr;
   WamWord *exp;
   int op;
-  static WamWord h[3];		/* static to avoid high address */
+  static PL_THREAD_LOCAL WamWord h[3];	/* static to avoid high address */
 
 
   DEREF(op_word, word, tag_mask);
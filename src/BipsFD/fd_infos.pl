@@ -105,3 +105,47 @@ fd_has_vector(Fdv) :-
 fd_use_vector(Fdv) :-
 	set_bip_name(fd_use_vector, 1),
 	'$call_c_test'('Pl_Fd_Use_Vector_1'(Fdv)).
+
+
+
+
+fd_statistics :-
+	set_bip_name(fd_statistics, 0),
+	'$call_c'('Pl_Fd_Statistics_0').
+
+
+fd_statistics(Key, Values) :-
+	set_bip_name(fd_statistics, 2),
+	'$check_fd_stat_key'(Key), !,
+	(   Values = [Val1, Val2] ->
+	    true
+	;   '$pl_err_domain'(statistics_value, Values)
+	),
+	'$fd_stat'(Key, Val1, Val2).
+
+
+
+
+'$check_fd_stat_key'(Key) :-
+	var(Key).
+
+'$check_fd_stat_key'(propagations).
+
+'$check_fd_stat_key'(wake_ups).
+
+'$check_fd_stat_key'(failures).
+
+'$check_fd_stat_key'(Key) :-
+	'$pl_err_domain'(statistics_key, Key).
+
+
+
+
+'$fd_stat'(propagations, SinceStart, SinceLast) :-
+	'$call_c_test'('Pl_Fd_Statistics_2'(0, SinceStart, SinceLast)).
+
+'$fd_stat'(wake_ups, SinceStart, SinceLast) :-
+	'$call_c_test'('Pl_Fd_Statistics_2'(1, SinceStart, SinceLast)).
+
+'$fd_stat'(failures, SinceStart, SinceLast) :-
+	'$call_c_test'('Pl_Fd_Statistics_2'(2, SinceStart, SinceLast)).
@@ -36,6 +36,8 @@
  *-------------------------------------------------------------------------*/
 
 
+#define OBJ_INIT Fd_Infos_Initializer
+
 #include "engine_pl.h"
 #include "engine_fd.h"
 
@@ -55,11 +57,27 @@
  * Global Variables                *
  *---------------------------------*/
 
+static PL_THREAD_LOCAL PlLong last_fd_stat[3]; /* values at last call (for since last) */
 
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
 
+static PlLong Fd_Stat_Value(int key);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FD_INFOS_INITIALIZER                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Fd_Infos_Initializer(void)
+{
+  Pl_Engine_Add_Context(last_fd_stat, sizeof(last_fd_stat));
+}
+
 
 
 
@@ -161,7 +179,7 @@ Pl_Fd_Dom_2(WamWord fdv_word, WamWord list_word)
   WamWord *fdv_adr;
   PlLong x;
   int end;
-  int vec_elem;
+  int range_elem;
 
   Pl_Check_For_Un_List(list_word);
 
@@ -191,14 +209,14 @@ Pl_Fd_Dom_2(WamWord fdv_word, WamWord list_word)
 	}
       else
 	{
-	  VECTOR_BEGIN_ENUM(Vec(fdv_adr), vec_elem);
+	  RANGE_BEGIN_ENUM(Range(fdv_adr), range_elem);
 
-	  if (!Pl_Get_List(list_word) || !Pl_Unify_Integer(vec_elem))
+	  if (!Pl_Get_List(list_word) || !Pl_Unify_Integer(range_elem))
 	    return FALSE;
 
 	  list_word = Pl_Unify_Variable();
 
-	  VECTOR_END_ENUM;
+	  RANGE_END_ENUM;
 	}
     }
 
@@ -277,3 +295,73 @@ Pl_Fd_Use_Vector_1(WamWord fdv_word)
 
   return tag_mask == TAG_INT_MASK || Pl_Fd_Use_Vector(UnTag_FDV(word));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_STATISTICS_0                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Statistics_0(void)
+{
+  StmInf *pstm = pl_stm_tbl[pl_stm_stdout];
+  static char *n[3] = { "propagations", "wake-ups", "failures" };
+  PlLong v;
+  int i;
+
+  Pl_Stream_Printf(pstm, "FD solver            since start      since last\n\n");
+
+  for (i = 0; i < 3; i++)
+    {
+      v = Fd_Stat_Value(i);
+      Pl_Stream_Printf(pstm, "   %-12s %14" PL_FMT_d "  %14" PL_FMT_d "\n",
+		       n[i], v, v - last_fd_stat[i]);
+      last_fd_stat[i] = v;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_STATISTICS_2                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Statistics_2(WamWord key_word, WamWord since_start_word,
+		   WamWord since_last_word)
+{
+  int key = Pl_Rd_Integer(key_word);
+  PlLong since_start, since_last;
+
+  since_start = Fd_Stat_Value(key);
+  since_last = since_start - last_fd_stat[key];
+  last_fd_stat[key] = since_start;
+
+  return Pl_Un_Integer_Check(since_start, since_start_word) &&
+    Pl_Un_Integer_Check(since_last, since_last_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FD_STAT_VALUE                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Fd_Stat_Value(int key)
+{
+  switch (key)
+    {
+    case 0:
+      return pl_fd_nb_propag;
+
+    case 1:
+      return pl_fd_nb_wake_up;
+    }
+
+  return pl_fd_nb_failure;
+}
@@ -44,21 +44,17 @@
 :- meta_predicate(fd_minimize(0, ?)).
 
 fd_minimize(Goal, Var) :-
-	fd_max_integer(Inf),
-	g_assign('$cur_min', Inf),
-	repeat,
-	g_read('$cur_min', B),
-	B1 is B - 1,
 	set_bip_name(fd_minimize, 2),
-	(   '$fd_domain'(Var, 0, B1),
-	    '$call'(Goal, fd_minimize, 2, true) ->
-	    fd_min(Var, C),
-	    g_assign('$cur_min', C),
-	    fail
-	;   !,
-	    Var = B,
-	    '$call'(Goal, fd_minimize, 2, true)
-	).
+	'$fd_optim'(Goal, Var, [], 0, fd_minimize, 2).
+
+
+
+
+:- meta_predicate(fd_minimize(0, ?, +)).
+
+fd_minimize(Goal, Var, Options) :-
+	set_bip_name(fd_minimize, 3),
+	'$fd_optim'(Goal, Var, Options, 0, fd_minimize, 3).
 
 
 
@@ -66,18 +62,199 @@ fd_minimize(Goal, Var) :-
 :- meta_predicate(fd_maximize(0, ?)).
 
 fd_maximize(Goal, Var) :-
-	fd_max_integer(Inf),
-	g_assign('$cur_max', 0),
-	repeat,
-	g_read('$cur_max', B),
-	B1 is B + 1,
 	set_bip_name(fd_maximize, 2),
-	(   '$fd_domain'(Var, B1, Inf),
-	    '$call'(Goal, fd_maximize, 2, true) ->
-	    fd_max(Var, C),
-	    g_assign('$cur_max', C),
-	    fail
-	;   !,
-	    Var = B,
-	    '$call'(Goal, fd_maximize, 2, true)
+	'$fd_optim'(Goal, Var, [], 1, fd_maximize, 2).
+
+
+
+
+:- meta_predicate(fd_maximize(0, ?, +)).
+
+fd_maximize(Goal, Var, Options) :-
+	set_bip_name(fd_maximize, 3),
+	'$fd_optim'(Goal, Var, Options, 1, fd_maximize, 3).
+
+
+
+
+	% Dir: 0 (minimize) or 1 (maximize) - same order as in fd_optim_c.c
+
+'$fd_optim'(Goal, Var, Options, Dir, Func, Arity) :-
+	'$get_optim_options'(Options, Strategy, NodeLimit, TimeLimit, OnLimit, Status, Lns),
+	g_read('$fd_optim_sol', OldSol),                      % for nested calls
+	'$call_c'('Pl_Fd_Optim_Begin_5'(Var, Dir, Strategy, NodeLimit, TimeLimit)),
+	catch('$fd_optim1'(Strategy, Goal, Var, Lns, Func, Arity), Err,
+	      '$fd_optim_abort'(OldSol, Err)),
+	'$call_c_test'('Pl_Fd_Optim_End_2'(StatusCode, Bound)),
+	g_read('$fd_optim_sol', Sol),
+	g_assign('$fd_optim_sol', OldSol),
+	integer(Bound),
+	'$fd_optim_status'(StatusCode, Status1),
+	(   Status1 == optimal ->
+	    true
+	;   OnLimit == best
+	),
+	Status = Status1,
+	'$fd_optim_solution'(Strategy, Goal, Var, Bound, Sol, Func, Arity).
+
+
+
+
+'$fd_optim_abort'(OldSol, Err) :-
+	'$call_c_test'('Pl_Fd_Optim_End_2'(_, _)),
+	g_assign('$fd_optim_sol', OldSol),
+	throw(Err).
+
+
+
+
+	% Strategy: 0 (restart), 1 (continue) or 2 (lns) - same order as in fd_optim_c.c
+
+'$fd_optim1'(0, Goal, _, _, Func, Arity) :-
+	repeat,
+	(   '$call_c_test'('Pl_Fd_Optim_Post_Bound_0'),
+	    '$call'(Goal, Func, Arity, true) ->
+	    '$call_c_test'('Pl_Fd_Optim_Solution_0'),
+	    '$call_c_test'('Pl_Fd_Optim_Limit_Reached_0')
+	;   true
+	), !.
+
+'$fd_optim1'(1, Goal, Var, _, Func, Arity) :-
+	(   '$call'(Goal, Func, Arity, true),
+	    '$call_c_test'('Pl_Fd_Optim_Solution_0'),
+	    g_assign('$fd_optim_sol', Var - Goal),
+	    '$call_c_test'('Pl_Fd_Optim_Limit_Reached_0') ->
+	    true
+	;   true
+	).
+
+'$fd_optim1'(2, Goal, Var, lns(Vars, Neighbourhood, FailLimit, IterLimit), Func, Arity) :-
+	'$fd_lns_neighbourhood'(Neighbourhood, Kind, Percent),
+	'$call_c'('Pl_Fd_Optim_Lns_Begin_5'(Vars, Kind, Percent, FailLimit, IterLimit)),
+	repeat,                          % each iteration is undone by backtracking
+	(   '$call_c_test'('Pl_Fd_Optim_Lns_Relax_0'),     % bound + fragment
+	    '$fd_lns_user_relax'(Kind, Neighbourhood, Vars, Func, Arity),
+	    '$call'(Goal, Func, Arity, true) ->
+	    '$call_c_test'('Pl_Fd_Optim_Solution_0'),
+	    '$call_c'('Pl_Fd_Optim_Lns_Record_0'),
+	    g_assign('$fd_optim_sol', Var - Goal)
+	;   true
+	),
+	'$call_c_test'('Pl_Fd_Optim_Lns_Stop_0'), !.
+
+
+
+
+	% Kind: 0 (random), 1 (block) or 2 (user) - same order as in fd_optim_c.c
+
+'$fd_lns_neighbourhood'(random(Percent), 0, Percent) :-
+	!.
+
+'$fd_lns_neighbourhood'(block(Percent), 1, Percent) :-
+	!.
+
+'$fd_lns_neighbourhood'(_, 2, 0).
+
+
+
+
+'$fd_lns_user_relax'(2, Neighbourhood, Vars, Func, Arity) :-
+	'$call_c_test'('Pl_Fd_Optim_Lns_Incumbent_1'(Values)), !,
+	'$call'(call(Neighbourhood, Vars, Values), Func, Arity, true).
+
+'$fd_lns_user_relax'(_, _, _, _, _).
+
+
+
+
+'$fd_optim_solution'(0, Goal, Var, Bound, _, Func, Arity) :-
+	Var = Bound,
+	'$call'(Goal, Func, Arity, true).
+
+'$fd_optim_solution'(1, Goal, Var, _, Var - Goal, _, _).
+
+'$fd_optim_solution'(2, Goal, Var, _, Var - Goal, _, _).
+
+
+
+
+'$fd_optim_status'(0, optimal).
+'$fd_optim_status'(1, node_limit).
+'$fd_optim_status'(2, time_limit).
+'$fd_optim_status'(3, iteration_limit).
+
+
+
+
+'$get_optim_options'(Options, Strategy, NodeLimit, TimeLimit, OnLimit, Status, Lns) :-
+	'$check_list'(Options),
+	'$get_optim_options1'(Options, optim(0, 0, 0, best, Status, lns([], random(30), 100, 0)),
+			      optim(Strategy, NodeLimit, TimeLimit, OnLimit, Status, Lns)).
+
+
+'$get_optim_options1'([], Opt, Opt).
+
+'$get_optim_options1'([X|Options], Opt0, Opt) :-
+	'$get_optim_options2'(X, Opt0, Opt1), !,
+	'$get_optim_options1'(Options, Opt1, Opt).
+
+
+'$get_optim_options2'(X, _, _) :-
+	var(X),
+	'$pl_err_instantiation'.
+
+'$get_optim_options2'(strategy(X), optim(_, N, T, L, S, lns(V, H, F, I)), optim(Y, N, T, L, S, lns(V1, H, F, I))) :-
+	'$check_nonvar'(X),                           % same order as in fd_optim_c.c
+	(   X = restart,
+	    Y = 0,
+	    V1 = V
+	;   X = continue,
+	    Y = 1,
+	    V1 = V
+	;   X = lns(V1),
+	    Y = 2,
+	    '$check_list'(V1)
+	).
+
+	% ranges are checked with @>= etc. (no arithmetic: keeps the bip name)
+
+'$get_optim_options2'(node_limit(N), optim(Y, _, T, L, S, Lns), optim(Y, N, T, L, S, Lns)) :-
+	'$check_nonvar'(N),
+	integer(N),
+	N @>= 0.
+
+'$get_optim_options2'(time_limit(T), optim(Y, N, _, L, S, Lns), optim(Y, N, T, L, S, Lns)) :-
+	'$check_nonvar'(T),
+	integer(T),
+	T @>= 0.
+
+'$get_optim_options2'(on_limit(L), optim(Y, N, T, _, S, Lns), optim(Y, N, T, L, S, Lns)) :-
+	'$check_nonvar'(L),
+	(   L = best
+	;   L = fail
 	).
+
+'$get_optim_options2'(status(S), Opt, Opt) :-
+	arg(5, Opt, S).
+
+'$get_optim_options2'(neighbourhood(H), optim(Y, N, T, L, S, lns(V, _, F, I)), optim(Y, N, T, L, S, lns(V, H, F, I))) :-
+	'$check_nonvar'(H),
+	(   ( H = random(P) ; H = block(P) ) ->
+	    integer(P),
+	    P @> 0,
+	    P @=< 100
+	;   callable(H)                                   % user neighbourhood
+	).
+
+'$get_optim_options2'(fail_limit(F), optim(Y, N, T, L, S, lns(V, H, _, I)), optim(Y, N, T, L, S, lns(V, H, F, I))) :-
+	'$check_nonvar'(F),
+	integer(F),
+	F @>= 0.
+
+'$get_optim_options2'(iteration_limit(I), optim(Y, N, T, L, S, lns(V, H, F, _)), optim(Y, N, T, L, S, lns(V, H, F, I))) :-
+	'$check_nonvar'(I),
+	integer(I),
+	I @>= 0.
+
+'$get_optim_options2'(X, _, _) :-
+	'$pl_err_domain'(fd_optimization_option, X).
@@ -0,0 +1,688 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : FD constraint solver buit-in predicates                         *
+ * File  : fd_optim_c.c                                                    *
+ * Descr.: optimization predicate management - C part                      *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+#define OBJ_INIT Fd_Optim_Initializer
+
+#include "engine_pl.h"
+#include "bips_pl.h"
+
+#include "engine_fd.h"
+#include "bips_fd.h"
+
+
+
+
+/*---------------------------------------------------------------------*
+ * An optimization context is pushed by fd_minimize/fd_maximize for    *
+ * the duration of the search (they can be nested). It records the     *
+ * objective, the best value found so far and the search limits.       *
+ *                                                                     *
+ * With the continue strategy the search is not restarted after a      *
+ * solution: Pl_Fd_Optim_Check() is called by the labeling at each     *
+ * choice (Pl_Indomain_2) and each alternative (Pl_Indomain_Alt_0) and  *
+ * constrains the objective to be better than the best value (this     *
+ * constraint is undone on backtracking but posted again at the next   *
+ * choice). Pl_Fd_Optim_Check() also counts the nodes and detects when *
+ * a limit is reached: all remaining choices then fail at once.        *
+ *                                                                     *
+ * With the lns strategy (Large Neighbourhood Search) the incumbent    *
+ * (the values of the decision variables in the best solution) is kept *
+ * here. Each iteration (see fd_optim.pl) posts the bound, fixes the   *
+ * variables outside the fragment to their incumbent value (or lets a  *
+ * user predicate do it) and re-solves with a limit on the number of   *
+ * failures (backtracks in Pl_Indomain_Alt_0). An iteration is undone  *
+ * by backtracking so that the constraint stack is simply reset to its *
+ * state before the first iteration. After LNS_MAX_STALL iterations    *
+ * without improvement, the fragment size and the fail limit are       *
+ * doubled: the search eventually becomes complete and can prove the   *
+ * optimality of the incumbent.                                        *
+ *                                                                     *
+ * The objective and the decision variables are kept as WamWords       *
+ * (updated by the heap GC).                                           *
+ *---------------------------------------------------------------------*/
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define OPTIM_MINIMIZE             0
+#define OPTIM_MAXIMIZE             1
+
+#define OPTIM_RESTART              0
+#define OPTIM_CONTINUE             1
+#define OPTIM_LNS                  2
+
+#define LNS_RANDOM                 0
+#define LNS_BLOCK                  1
+#define LNS_USER                   2
+
+#define LNS_MAX_STALL              20
+
+#define STATUS_OPTIMAL             0
+#define STATUS_NODE_LIMIT          1
+#define STATUS_TIME_LIMIT          2
+#define STATUS_ITERATION_LIMIT     3
+
+	  /* the time is checked every TIME_CHECK_FREQ + 1 nodes */
+
+#define TIME_CHECK_FREQ            15
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct
+{
+  WamWord obj_word;		/* the objective FD variable */
+  int direction;		/* OPTIM_MINIMIZE / OPTIM_MAXIMIZE */
+  int strategy;			/* OPTIM_RESTART / OPTIM_CONTINUE / OPTIM_LNS */
+  Bool found;			/* a solution has been found */
+  int best;			/* the best value (if found) */
+  PlLong nb_nodes;		/* nb of labeling nodes */
+  PlLong node_limit;		/* 0 if no limit */
+  PlLong time_limit;		/* in ms (0 if no limit) */
+  PlLong start_time;
+  int status;			/* STATUS_xxx */
+				/* --- OPTIM_LNS only --- */
+  WamWord *lns_var;		/* the decision variables */
+  int *lns_val;			/* their incumbent values (-1 if unknown) */
+  int *lns_perm;		/* permutation of 0..nb_var-1 (LNS_RANDOM) */
+  int lns_nb_var;
+  int neighbourhood;		/* LNS_RANDOM / LNS_BLOCK / LNS_USER */
+  int percent;			/* size of the fragment (% of nb_var) */
+  int cur_percent;		/* current size (grows when stalled) */
+  PlLong fail_limit;		/* nb of failures per iteration (0: none) */
+  PlLong cur_fail_limit;	/* current limit (grows when stalled) */
+  int nb_stall;			/* nb of iterations without improvement */
+  PlLong iter_limit;		/* 0 if no limit */
+  PlLong nb_iter;		/* nb of iterations */
+  PlLong nb_fail;		/* nb of failures in the current iteration */
+  Bool limited;			/* the fail limit applies to this iteration */
+  Bool stopped;			/* this iteration reached its fail limit */
+  Bool fixed;			/* some variables are fixed in this iteration */
+  Bool improved;		/* this iteration found a better solution */
+}
+OptimCtx;
+
+
+
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static PL_THREAD_LOCAL OptimCtx *optim_stack;
+static PL_THREAD_LOCAL int optim_stack_size;
+static PL_THREAD_LOCAL int optim_top;		/* nb of active contexts */
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static void Optim_GC_Roots(GCScanFct scan);
+
+static Bool Post_Bound(OptimCtx *ctx);
+
+static Bool Fix_Variable(OptimCtx *ctx, int i);
+
+static PlLong Cpu_Time(void);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FD_OPTIM_INITIALIZER                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Fd_Optim_Initializer(void)
+{
+  Pl_Engine_Add_Context(&optim_stack, sizeof(optim_stack));
+  Pl_Engine_Add_Context(&optim_stack_size, sizeof(optim_stack_size));
+  Pl_Engine_Add_Context(&optim_top, sizeof(optim_top));
+
+  Pl_GC_Add_Root_Fct(Optim_GC_Roots);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OPTIM_GC_ROOTS                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Optim_GC_Roots(GCScanFct scan)
+{
+  int i, j;
+
+  for (i = 0; i < optim_top; i++)
+    {
+      (*scan) (&optim_stack[i].obj_word);
+      for (j = 0; j < optim_stack[i].lns_nb_var; j++)
+	(*scan) (&optim_stack[i].lns_var[j]);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CPU_TIME                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Cpu_Time(void)
+{
+  return Pl_M_User_Time() + Pl_M_System_Time();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_BEGIN_5                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Optim_Begin_5(WamWord var_word, WamWord direction_word,
+		    WamWord strategy_word, WamWord node_limit_word,
+		    WamWord time_limit_word)
+{
+  WamWord *fdv_adr;
+  OptimCtx *ctx;
+
+  fdv_adr = Pl_Fd_Prolog_To_Fd_Var(var_word, TRUE);
+
+  if (optim_top == optim_stack_size)
+    {
+      optim_stack_size = (optim_stack_size == 0) ? 8 : optim_stack_size * 2;
+      optim_stack = (OptimCtx *) Realloc(optim_stack,
+					 optim_stack_size * sizeof(OptimCtx));
+    }
+
+  ctx = optim_stack + optim_top++;
+  ctx->obj_word = Tag_REF(fdv_adr);
+  ctx->direction = Pl_Rd_Integer(direction_word);
+  ctx->strategy = Pl_Rd_Integer(strategy_word);
+  ctx->found = FALSE;
+  ctx->best = 0;
+  ctx->nb_nodes = 0;
+  ctx->node_limit = Pl_Rd_Integer(node_limit_word);
+  ctx->time_limit = Pl_Rd_Integer(time_limit_word);
+  ctx->start_time = (ctx->time_limit) ? Cpu_Time() : 0;
+  ctx->status = STATUS_OPTIMAL;
+  ctx->lns_var = NULL;
+  ctx->lns_val = NULL;
+  ctx->lns_perm = NULL;
+  ctx->lns_nb_var = 0;
+  ctx->nb_iter = 0;
+  ctx->limited = FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_END_2                                                       *
+ *                                                                         *
+ * Pops the current context. Unifies status_word with the status and if a  *
+ * solution has been found, bound_word with the best value.                *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_End_2(WamWord status_word, WamWord bound_word)
+{
+  OptimCtx *ctx;
+
+  if (optim_top == 0)
+    return FALSE;
+
+  ctx = optim_stack + --optim_top;
+
+  if (ctx->lns_var)
+    {
+      Free(ctx->lns_var);
+      Free(ctx->lns_val);
+      Free(ctx->lns_perm);
+    }
+
+  return Pl_Un_Integer(ctx->status, status_word) &&
+    (!ctx->found || Pl_Un_Integer(ctx->best, bound_word));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POST_BOUND                                                              *
+ *                                                                         *
+ * Constrains the objective to be better than the best value found.        *
+ *-------------------------------------------------------------------------*/
+static Bool
+Post_Bound(OptimCtx *ctx)
+{
+  WamWord word, tag_mask;
+  int n;
+
+  if (!ctx->found)
+    return TRUE;
+
+  DEREF(ctx->obj_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    {
+      n = (int) UnTag_INT(word);
+      return (ctx->direction == OPTIM_MINIMIZE) ? n < ctx->best : n > ctx->best;
+    }
+
+  if (ctx->direction == OPTIM_MINIMIZE)
+    return Pl_Fd_In_Interval(UnTag_FDV(word), 0, ctx->best - 1);
+
+  return Pl_Fd_In_Interval(UnTag_FDV(word), ctx->best + 1, INTERVAL_MAX_INTEGER);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_POST_BOUND_0                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Post_Bound_0(void)
+{
+  return Post_Bound(optim_stack + optim_top - 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_SOLUTION_0                                                  *
+ *                                                                         *
+ * Records the value of the objective at a solution (its min for a         *
+ * minimization, its max for a maximization). Fails if it is not better    *
+ * than the best value (only possible if the goal does not use the FD      *
+ * labeling since else the objective is already constrained).              *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Solution_0(void)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+  WamWord word, tag_mask;
+  WamWord *fdv_adr;
+  int n;
+
+  DEREF(ctx->obj_word, word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    n = (int) UnTag_INT(word);
+  else
+    {
+      fdv_adr = UnTag_FDV(word);
+      n = (ctx->direction == OPTIM_MINIMIZE) ? Min(fdv_adr) : Max(fdv_adr);
+    }
+
+  if (ctx->found &&
+      ((ctx->direction == OPTIM_MINIMIZE) ? n >= ctx->best : n <= ctx->best))
+    return FALSE;
+
+  ctx->found = TRUE;
+  ctx->best = n;
+
+  if (ctx->time_limit && ctx->status == STATUS_OPTIMAL &&
+      Cpu_Time() - ctx->start_time >= ctx->time_limit)
+    ctx->status = STATUS_TIME_LIMIT;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LIMIT_REACHED_0                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Limit_Reached_0(void)
+{
+  return optim_stack[optim_top - 1].status != STATUS_OPTIMAL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_CHECK                                                       *
+ *                                                                         *
+ * Called by the labeling before each choice and before each alternative  *
+ * (failure is then TRUE). Returns FALSE if a limit is reached or if the   *
+ * objective cannot be improved (continue strategy).                       *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Check(Bool failure)
+{
+  OptimCtx *ctx;
+  int i;
+
+  for (i = 0; i < optim_top; i++)
+    {
+      ctx = optim_stack + i;
+
+      if (ctx->status != STATUS_OPTIMAL)
+	return FALSE;
+
+      ctx->nb_nodes++;
+      if (ctx->node_limit && ctx->nb_nodes > ctx->node_limit)
+	{
+	  ctx->status = STATUS_NODE_LIMIT;
+	  return FALSE;
+	}
+
+      if (ctx->time_limit && (ctx->nb_nodes & TIME_CHECK_FREQ) == 0 &&
+	  Cpu_Time() - ctx->start_time >= ctx->time_limit)
+	{
+	  ctx->status = STATUS_TIME_LIMIT;
+	  return FALSE;
+	}
+
+      if (ctx->strategy == OPTIM_CONTINUE && !Post_Bound(ctx))
+	return FALSE;
+
+      if (ctx->limited)
+	{
+	  if (ctx->stopped)
+	    return FALSE;
+
+	  if (failure && ++ctx->nb_fail >= ctx->cur_fail_limit)
+	    {
+	      ctx->stopped = TRUE;
+	      return FALSE;
+	    }
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LNS_BEGIN_5                                                 *
+ *                                                                         *
+ * Initializes the LNS part of the current context (vars_word is a list).  *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Optim_Lns_Begin_5(WamWord vars_word, WamWord neighbourhood_word,
+			WamWord percent_word, WamWord fail_limit_word,
+			WamWord iter_limit_word)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+  WamWord word, tag_mask;
+  WamWord *lst_adr;
+  int i, n;
+
+  ctx->neighbourhood = Pl_Rd_Integer(neighbourhood_word);
+  ctx->percent = Pl_Rd_Integer(percent_word);
+  ctx->fail_limit = Pl_Rd_Integer(fail_limit_word);
+  ctx->iter_limit = Pl_Rd_Integer(iter_limit_word);
+  ctx->limited = FALSE;
+  ctx->cur_percent = ctx->percent;
+  ctx->cur_fail_limit = ctx->fail_limit;
+  ctx->nb_stall = 0;
+
+  n = Pl_List_Length(vars_word);
+  ctx->lns_var = (WamWord *) Malloc((n + 1) * sizeof(WamWord));
+  ctx->lns_val = (int *) Malloc((n + 1) * sizeof(int));
+  ctx->lns_perm = (int *) Malloc((n + 1) * sizeof(int));
+
+  for (i = 0; i < n; i++)
+    {
+      DEREF(vars_word, word, tag_mask);
+      lst_adr = UnTag_LST(word);
+      DEREF(Car(lst_adr), word, tag_mask);
+      ctx->lns_var[i] = (tag_mask == TAG_INT_MASK) ? word :
+	Tag_REF(Pl_Fd_Prolog_To_Fd_Var(word, TRUE));
+      ctx->lns_val[i] = -1;
+      ctx->lns_perm[i] = i;
+      ctx->lns_nb_var = i + 1;	/* only GC-scan initialized words */
+      vars_word = Cdr(lst_adr);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LNS_RELAX_0                                                 *
+ *                                                                         *
+ * Starts a new iteration: posts the bound and, if there is an incumbent,  *
+ * fixes the variables which are not in the fragment (LNS_RANDOM: a random *
+ * subset, LNS_BLOCK: a random window of consecutive variables).           *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Lns_Relax_0(void)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+  int n = ctx->lns_nb_var;
+  int k, i, j, x;
+
+  ctx->nb_fail = 0;
+  ctx->stopped = FALSE;
+  ctx->fixed = FALSE;
+  ctx->improved = FALSE;
+  ctx->limited = ctx->found && ctx->fail_limit > 0;
+
+  if (!Post_Bound(ctx))		/* nothing fixed: the incumbent is optimal */
+    return FALSE;
+
+  if (!ctx->found)		/* first solution: complete search */
+    return TRUE;
+
+  if (ctx->neighbourhood == LNS_USER)
+    {
+      ctx->fixed = TRUE;	/* unknown: assume incomplete */
+      return TRUE;
+    }
+
+  k = (int) (((PlLong) n * ctx->cur_percent + 99) / 100); /* fragment size */
+  if (k <= 0)
+    k = 1;
+
+  if (ctx->neighbourhood == LNS_RANDOM)
+    {
+      for (i = 0; i < k && i < n - 1; i++)	/* k first of a shuffle */
+	{
+	  j = i + (int) Pl_M_Random_Integer(n - i);
+	  x = ctx->lns_perm[i];
+	  ctx->lns_perm[i] = ctx->lns_perm[j];
+	  ctx->lns_perm[j] = x;
+	}
+
+      for (i = k; i < n; i++)
+	if (!Fix_Variable(ctx, ctx->lns_perm[i]))
+	  return FALSE;
+
+      return TRUE;
+    }
+
+  if (k >= n)
+    return TRUE;
+
+  j = (int) Pl_M_Random_Integer(n);	/* fragment: j..j+k-1 (mod n) */
+  for (i = k; i < n; i++)
+    if (!Fix_Variable(ctx, (j + i) % n))
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FIX_VARIABLE                                                            *
+ *                                                                         *
+ * Fixes the ith decision variable to its incumbent value (if known).      *
+ *-------------------------------------------------------------------------*/
+static Bool
+Fix_Variable(OptimCtx *ctx, int i)
+{
+  WamWord word, tag_mask;
+
+  if (ctx->lns_val[i] < 0)
+    return TRUE;
+
+  DEREF(ctx->lns_var[i], word, tag_mask);
+  if (tag_mask == TAG_INT_MASK)
+    return TRUE;
+
+  ctx->fixed = TRUE;
+  return Pl_Fd_Assign_Value(UnTag_FDV(word), ctx->lns_val[i]);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LNS_INCUMBENT_1                                             *
+ *                                                                         *
+ * Unifies values_word with the list of the incumbent values (a variable   *
+ * whose value is unknown appears as itself). Fails if no incumbent.       *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Lns_Incumbent_1(WamWord values_word)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+  WamWord *arg = H;		/* in-place array->list transformation */
+  int i;
+
+  if (!ctx->found)
+    return FALSE;
+
+  for (i = 0; i < ctx->lns_nb_var; i++)
+    arg[i] = (ctx->lns_val[i] < 0) ? ctx->lns_var[i] :
+      Tag_INT(ctx->lns_val[i]);
+
+  return Pl_Unify(Pl_Mk_Proper_List(ctx->lns_nb_var, arg), values_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LNS_RECORD_0                                                *
+ *                                                                         *
+ * Records the values of the decision variables at a (better) solution.    *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Optim_Lns_Record_0(void)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+  WamWord word, tag_mask;
+  int i;
+
+  ctx->improved = TRUE;
+
+  for (i = 0; i < ctx->lns_nb_var; i++)
+    {
+      DEREF(ctx->lns_var[i], word, tag_mask);
+      ctx->lns_val[i] = (tag_mask == TAG_INT_MASK) ? (int) UnTag_INT(word) : -1;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_OPTIM_LNS_STOP_0                                                  *
+ *                                                                         *
+ * Called at the end of an iteration. Succeeds if the search is over: a    *
+ * limit is reached or the last iteration was a complete search (nothing   *
+ * fixed, no fail limit reached) without a better solution, proving that   *
+ * the incumbent is optimal (or that there is no solution).                *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Optim_Lns_Stop_0(void)
+{
+  OptimCtx *ctx = optim_stack + optim_top - 1;
+
+  ctx->nb_iter++;
+  ctx->limited = FALSE;
+
+  if (ctx->status != STATUS_OPTIMAL)
+    return TRUE;
+
+  if (!ctx->fixed && !ctx->stopped && !ctx->improved)
+    return TRUE;
+
+  if (ctx->improved)
+    {
+      ctx->nb_stall = 0;
+      ctx->cur_percent = ctx->percent;
+      ctx->cur_fail_limit = ctx->fail_limit;
+    }
+  else if (++ctx->nb_stall >= LNS_MAX_STALL)
+    {
+      ctx->nb_stall = 0;
+      ctx->cur_percent *= 2;
+      if (ctx->cur_percent > 100)
+	ctx->cur_percent = 100;
+      ctx->cur_fail_limit *= 2;
+    }
+
+  if (ctx->iter_limit && ctx->nb_iter >= ctx->iter_limit)
+    {
+      ctx->status = STATUS_ITERATION_LIMIT;
+      return TRUE;
+    }
+
+  if (ctx->time_limit && Cpu_Time() - ctx->start_time >= ctx->time_limit)
+    {
+      ctx->status = STATUS_TIME_LIMIT;
+      return TRUE;
+    }
+
+  return FALSE;
+}
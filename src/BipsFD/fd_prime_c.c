@@ -59,9 +59,9 @@
  * Global Variables                *
  *---------------------------------*/
 
-static int prime_vec_size;
-static Range prime_range;
-static Range not_prime_range;
+static PL_THREAD_LOCAL int prime_vec_size;
+static PL_THREAD_LOCAL Range prime_range;
+static PL_THREAD_LOCAL Range not_prime_range;
 
 
 
@@ -47,6 +47,53 @@ fd_all_different(L) :-
 
 
 
+
+fd_all_different(L, Options) :-
+	set_bip_name(fd_all_different, 2),
+	'$get_all_different_options'(Options, Consistency),
+	'$fd_all_different'(Consistency, L).
+
+
+'$fd_all_different'(bounds, L) :-
+	fd_tell(pl_fd_all_different_bounds(L)).
+
+'$fd_all_different'(domain, L) :-
+	fd_tell(pl_fd_all_different_domain(L)).
+
+'$fd_all_different'(value, L) :-
+	'$call_c_test'('Pl_Fd_All_Different_1'(L, L)).
+
+
+
+
+'$get_all_different_options'(Options, Consistency) :-
+	'$check_list'(Options),
+	'$get_all_different_options1'(Options, value, Consistency).
+
+
+'$get_all_different_options1'([], Consistency, Consistency).
+
+'$get_all_different_options1'([X|Options], Consistency0, Consistency) :-
+	'$get_all_different_options2'(X, Consistency0, Consistency1), !,
+	'$get_all_different_options1'(Options, Consistency1, Consistency).
+
+
+'$get_all_different_options2'(X, _, _) :-
+	var(X),
+	'$pl_err_instantiation'.
+
+'$get_all_different_options2'(consistency(X), _, X) :-
+	'$check_nonvar'(X),
+	(   X = bounds
+	;   X = domain
+	;   X = value
+	).
+
+'$get_all_different_options2'(X, _, _) :-
+	'$pl_err_domain'(fd_all_different_option, X).
+
+
+
 fd_element(I, List, V) :-
 	set_bip_name(fd_element, 3),
 	'$fd_element'(I, List, V).
@@ -90,8 +137,7 @@ fd_relation(Tuples, Vars) :-
 	set_bip_name(fd_relation, 2),
 	'$check_list'(Tuples),
 	'$check_list_or_partial_list'(Vars),
-	'$lines_to_columns'(Tuples, CTuples),
-	'$fd_relationc1'(CTuples, Vars, _).
+	'$fd_table'(Tuples, Vars).
 
 
 
@@ -99,16 +145,20 @@ fd_relationc(CTuples, Vars) :-
 	set_bip_name(fd_relationc, 2),
 	'$check_list'(CTuples),
 	'$check_list_or_partial_list'(Vars),
-	'$fd_relationc1'(CTuples, Vars, _).
-
+	(   CTuples = [] ->
+	    Vars = []
+	;   '$lines_to_columns'(CTuples, Tuples),
+	    '$fd_table'(Tuples, Vars)
+	).
 
 
 
-'$fd_relationc1'([], [], _).
 
-'$fd_relationc1'([C|CTuples], [X|Vars], R) :-
-	'$fd_element'(R, C, X),
-	'$fd_relationc1'(CTuples, Vars, R).
+'$fd_table'([Tuple|Tuples], Vars) :-
+	'$check_list'(Tuple),
+	length(Tuple, N),
+	length(Vars, N),
+	fd_tell(pl_fd_table(Vars, [Tuple|Tuples], [0])).
 
 
 
@@ -36,6 +36,8 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <string.h>
+
 #include "engine_pl.h"
 #include "bips_pl.h"
 
@@ -49,14 +51,106 @@
  * Constants                       *
  *---------------------------------*/
 
+#define AD_MAX_NB_VAL              (1 << 20)	/* max span for the domain propagator */
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* a variable of a table constraint */
+{
+  WamWord *fdv_adr;
+  int nb_val;			/* nb of distinct values in its column */
+  int *val;			/* these values (sorted) */
+  int *set;			/* sparse set of the values (indexes) */
+  WamWord *size;		/* [stamp, nb of values in set] (trailed) */
+  VecWord *supports;		/* per value: bitset of its tuples */
+  int *residue;			/* per value: last word with a support */
+}
+TableVar;
+
+
+typedef struct			/* a table constraint (Compact-Table) */
+{
+  int arity;
+  int nb_word;			/* nb of words of a bitset of tuples */
+  WamWord *words;		/* [stamp, word] of the current table (trailed) */
+  int *index;			/* the non zero words are index[0..limit] */
+  WamWord *limit;		/* [stamp, limit] (trailed) */
+  PlULong last_stamp;		/* pl_fd_update_stamp at the last fix point */
+  TableVar var[1];		/* arity variables */
+}
+TableCstr;
+
+
+typedef struct			/* interval of a var for all_different */
+{
+  int min;			/* bounds of the variable (inclusive) */
+  int max;
+  int min_rank;			/* rank of min in the bounds array */
+  int max_rank;			/* rank of max + 1 in the bounds array */
+}
+AllDiffInterv;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
+	  /* scratch buffers for all_different (grown on demand) */
+
+static PL_THREAD_LOCAL AllDiffInterv *ad_interv;
+static PL_THREAD_LOCAL AllDiffInterv **ad_min_sorted;
+static PL_THREAD_LOCAL AllDiffInterv **ad_max_sorted;
+static PL_THREAD_LOCAL int *ad_ground;		/* values of the ground variables */
+static PL_THREAD_LOCAL int ad_nb_interv;
+
+static PL_THREAD_LOCAL int *ad_bounds;		/* bounds[], t[], d[], h[] of the paper */
+static PL_THREAD_LOCAL int *ad_t;
+static PL_THREAD_LOCAL int *ad_d;
+static PL_THREAD_LOCAL int *ad_h;
+static PL_THREAD_LOCAL int ad_nb_bounds;
+static PL_THREAD_LOCAL int ad_nb;		/* nb of distinct bounds (see Sort_Intervals) */
+
+static PL_THREAD_LOCAL int *ad_var_match;	/* var  -> matched value (or -1) */
+static PL_THREAD_LOCAL int *ad_adj_start;	/* var  -> start of its values in ad_adj */
+static PL_THREAD_LOCAL int ad_nb_var;
+
+static PL_THREAD_LOCAL int *ad_val_match;	/* value -> matched var (or -1) */
+static PL_THREAD_LOCAL int *ad_rev_start;	/* value -> start of its vars in ad_rev */
+static PL_THREAD_LOCAL int *ad_stamp;		/* value -> visit stamp for augmenting paths */
+static PL_THREAD_LOCAL int ad_nb_val;
+
+static PL_THREAD_LOCAL int *ad_adj;		/* edges var -> value */
+static PL_THREAD_LOCAL int *ad_rev;		/* edges value -> var */
+static PL_THREAD_LOCAL int ad_nb_edge;
+
+static PL_THREAD_LOCAL int *ad_index;		/* per node (vars then values) for Tarjan */
+static PL_THREAD_LOCAL int *ad_low;
+static PL_THREAD_LOCAL int *ad_comp;
+static PL_THREAD_LOCAL int *ad_stack;
+static PL_THREAD_LOCAL int *ad_call_node;
+static PL_THREAD_LOCAL int *ad_call_pos;
+static PL_THREAD_LOCAL int ad_nb_node;
+
+static PL_THREAD_LOCAL int ad_cur_stamp;
+
+static PL_THREAD_LOCAL WamWord **ad_last_array;	/* last constraint at its fix point */
+static PL_THREAD_LOCAL PlULong ad_last_stamp;	/* and the pl_fd_update_stamp then */
+
+	  /* scratch buffers for table constraints (grown on demand) */
+
+static PL_THREAD_LOCAL int *tb_tuple;		/* tuples being read (row major) */
+static PL_THREAD_LOCAL int tb_nb_tuple;
+static PL_THREAD_LOCAL int *tb_column;		/* a column being sorted */
+static PL_THREAD_LOCAL int tb_nb_column;
+static PL_THREAD_LOCAL VecWord *tb_mask;	/* mask of the tuples to keep/remove */
+static PL_THREAD_LOCAL int tb_nb_mask;
+static PL_THREAD_LOCAL int *tb_removed;		/* values removed from a variable */
+static PL_THREAD_LOCAL int tb_nb_removed;
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
@@ -64,6 +158,53 @@
 static Bool Fd_All_Different_Rec(WamWord list_word, PlLong x_tag, WamWord x_word,
 				 WamWord save_list_word);
 
+static Bool All_Different_Ground(WamWord **array, int n);
+
+static Bool All_Different_Bounds(WamWord **array, int n);
+
+static int Compar_Int(int *i1, int *i2);
+
+static int Compar_Interv_Min(AllDiffInterv **i1, AllDiffInterv **i2);
+
+static int Compar_Interv_Max(AllDiffInterv **i1, AllDiffInterv **i2);
+
+static void Sort_Intervals(int n);
+
+static int Path_Min(int *t, int i);
+
+static int Path_Max(int *t, int i);
+
+static Bool Filter_Lower(int n);
+
+static Bool Filter_Upper(int n);
+
+static Bool Augment_Path(int x);
+
+static int Next_Successor(int u, int *pos, int n);
+
+static void Mark_Reachable(int s, int n);
+
+static void Compute_SCC(int nb_node, int n);
+
+static void *Table_Alloc(PlLong size);
+
+static int Table_Read_Tuples(WamWord tuples_word, int n);
+
+static int Table_Sort_Column(int n, int nb_tuple, int i);
+
+static int Table_Search_Value(TableVar *tv, int v);
+
+static Bool Table_Restrict_Domain(TableVar *tv);
+
+static Bool Table_Update_Var(TableCstr *tc, TableVar *tv);
+
+static Bool Table_Filter_Var(TableCstr *tc, TableVar *tv);
+
+
+
+#define Grow_Buffer(buff, size) \
+  (buff) = Realloc((buff), (size) * sizeof(*(buff)))
+
 
 
 
@@ -139,8 +280,739 @@ Fd_All_Different_Rec(WamWord list_word, PlLong x_tag, WamWord x_word,
     ret = (tag_mask == TAG_INT_MASK) ? pl_x_neq_c(x_word, word) :
              pl_x_neq_y(x_word, word);
 
-  return ret &&
-    Fd_All_Different_Rec(Cdr(lst_adr), x_tag, x_word, save_list_word);
+  return ret &&
+    Fd_All_Different_Rec(Cdr(lst_adr), x_tag, x_word, save_list_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * The global all_different constraint (options consistency(bounds) and    *
+ * consistency(domain), the default being the pairwise decomposition of    *
+ * Pl_Fd_All_Different_1) is implemented by 2 propagators both triggered   *
+ * as soon as a variable of the list is modified:                          *
+ *                                                                         *
+ * Pl_Fd_All_Different_Bounds: first removes the value of each ground      *
+ * variable from the other variables (this is the pruning of the pairwise  *
+ * decomposition) then ensures bounds consistency detecting Hall intervals *
+ * with the union-find based algorithm of Lopez-Ortiz, Quimper, Tromp and  *
+ * van Beek (IJCAI 2003). The cost is O(n log n) per execution.            *
+ *                                                                         *
+ * Pl_Fd_All_Different_Domain: ensures domain consistency with the Regin   *
+ * algorithm (AAAI 1994): a maximum matching between variables and values  *
+ * is computed then the values which belong neither to the matching, nor   *
+ * to an even alternating path starting from a free value, nor to an even  *
+ * alternating cycle (i.e. a strongly connected component of the residual  *
+ * graph) are removed. Values are numbered from the smallest min so this   *
+ * propagator falls back to the bounds one when the values span more than  *
+ * AD_MAX_NB_VAL integers.                                                 *
+ *                                                                         *
+ * Each propagator reaches its own fix point then records the current      *
+ * pl_fd_update_stamp: the reexecutions due to its own updates (one per    *
+ * modified variable) are then skipped in constant time.                   *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ALL_DIFFERENT_BOUNDS                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_All_Different_Bounds(WamWord **array)
+{
+  int n = (int) (PlLong) (array[0]);
+  PlULong stamp;
+
+  if (array == ad_last_array && pl_fd_update_stamp == ad_last_stamp)
+    return TRUE;
+
+  if (n > ad_nb_interv)
+    {
+      Grow_Buffer(ad_interv, n);
+      Grow_Buffer(ad_min_sorted, n);
+      Grow_Buffer(ad_max_sorted, n);
+      Grow_Buffer(ad_ground, n);
+      ad_nb_interv = n;
+    }
+
+  if (2 * n + 2 > ad_nb_bounds)
+    {
+      Grow_Buffer(ad_bounds, 2 * n + 2);
+      Grow_Buffer(ad_t, 2 * n + 2);
+      Grow_Buffer(ad_d, 2 * n + 2);
+      Grow_Buffer(ad_h, 2 * n + 2);
+      ad_nb_bounds = 2 * n + 2;
+    }
+
+  do
+    {
+      stamp = pl_fd_update_stamp;
+      if (!All_Different_Ground(array + 1, n) ||
+	  !All_Different_Bounds(array + 1, n))
+	return FALSE;
+    }
+  while (stamp != pl_fd_update_stamp);
+
+  ad_last_array = array;
+  ad_last_stamp = stamp;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFFERENT_GROUND                                                    *
+ *                                                                         *
+ * Removes the value of each ground variable from the other variables.     *
+ * The values are sorted to detect duplicates and to only consider, for a  *
+ * variable, the values between its min and its max.                       *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Different_Ground(WamWord **array, int n)
+{
+  WamWord *fdv_adr;
+  int nb_ground = 0;
+  int i, j, k, a, b, v;
+
+  for (i = 0; i < n; i++)
+    if (Fd_Variable_Is_Ground(array[i]))
+      ad_ground[nb_ground++] = Min(array[i]);
+
+  if (nb_ground == 0)
+    return TRUE;
+
+  qsort(ad_ground, nb_ground, sizeof(int),
+	(int (*)(const void *, const void *)) Compar_Int);
+
+  for (k = 1; k < nb_ground; k++)
+    if (ad_ground[k] == ad_ground[k - 1])
+      return FALSE;
+
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      if (Fd_Variable_Is_Ground(fdv_adr))
+	continue;
+
+      a = 0;			/* first value >= min */
+      b = nb_ground;
+      while (a < b)
+	{
+	  j = (a + b) / 2;
+	  if (ad_ground[j] < Min(fdv_adr))
+	    a = j + 1;
+	  else
+	    b = j;
+	}
+
+      for (k = a; k < nb_ground && (v = ad_ground[k]) <= Max(fdv_adr); k++)
+	if (!Pl_Fd_Tell_Not_Value(fdv_adr, v))
+	  return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ALL_DIFFERENT_BOUNDS                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+All_Different_Bounds(WamWord **array, int n)
+{
+  WamWord *fdv_adr;
+  AllDiffInterv *p;
+  int i;
+
+  if (n <= 1)
+    return TRUE;
+
+  for (i = 0; i < n; i++)
+    {
+      p = ad_interv + i;
+      p->min = Min(array[i]);
+      p->max = Max(array[i]);
+      ad_min_sorted[i] = ad_max_sorted[i] = p;
+    }
+
+  Sort_Intervals(n);
+
+  if (!Filter_Lower(n) || !Filter_Upper(n))
+    return FALSE;
+
+  for (i = 0; i < n; i++)
+    {
+      fdv_adr = array[i];
+      p = ad_interv + i;
+      if ((p->min != Min(fdv_adr) || p->max != Max(fdv_adr)) &&
+	  !Pl_Fd_Tell_Interval(fdv_adr, p->min, p->max))
+	return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPAR_INT                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Compar_Int(int *i1, int *i2)
+{
+  return (*i1 > *i2) - (*i1 < *i2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPAR_INTERV_MIN                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Compar_Interv_Min(AllDiffInterv **i1, AllDiffInterv **i2)
+{
+  return ((*i1)->min > (*i2)->min) - ((*i1)->min < (*i2)->min);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPAR_INTERV_MAX                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Compar_Interv_Max(AllDiffInterv **i1, AllDiffInterv **i2)
+{
+  return ((*i1)->max > (*i2)->max) - ((*i1)->max < (*i2)->max);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SORT_INTERVALS                                                          *
+ *                                                                         *
+ * Sorts the intervals by min and by max and merges all (distinct) bounds  *
+ * min and max + 1 in ad_bounds[1..nb], recording the rank of each bound.  *
+ * ad_bounds[0] and ad_bounds[nb + 1] are sentinels.                       *
+ *-------------------------------------------------------------------------*/
+static void
+Sort_Intervals(int n)
+{
+  int min, max, last;
+  int i, j, nb;
+
+  qsort(ad_min_sorted, n, sizeof(AllDiffInterv *),
+	(int (*)(const void *, const void *)) Compar_Interv_Min);
+  qsort(ad_max_sorted, n, sizeof(AllDiffInterv *),
+	(int (*)(const void *, const void *)) Compar_Interv_Max);
+
+  min = ad_min_sorted[0]->min;
+  max = ad_max_sorted[0]->max + 1;
+  ad_bounds[0] = last = min - 2;
+
+  i = j = nb = 0;
+  for (;;)
+    {
+      if (i < n && min <= max)
+	{
+	  if (min != last)
+	    ad_bounds[++nb] = last = min;
+	  ad_min_sorted[i]->min_rank = nb;
+	  if (++i < n)
+	    min = ad_min_sorted[i]->min;
+	}
+      else
+	{
+	  if (max != last)
+	    ad_bounds[++nb] = last = max;
+	  ad_max_sorted[j]->max_rank = nb;
+	  if (++j == n)
+	    break;
+	  max = ad_max_sorted[j]->max + 1;
+	}
+    }
+
+  ad_nb = nb;
+  ad_bounds[nb + 1] = ad_bounds[nb] + 2;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PATH_SET, PATH_MIN, PATH_MAX                                            *
+ *                                                                         *
+ * Union-find like operations on the t[] and h[] arrays (path compression).*
+ *-------------------------------------------------------------------------*/
+#define Path_Set(t, start, end, to)					\
+  do									\
+    {									\
+      int _k, _l;							\
+      for (_l = (start); (_k = _l) != (end); t[_k] = (to))		\
+	_l = t[_k];							\
+    }									\
+  while (0)
+
+
+static int
+Path_Min(int *t, int i)
+{
+  while (t[i] < i)
+    i = t[i];
+
+  return i;
+}
+
+
+static int
+Path_Max(int *t, int i)
+{
+  while (t[i] > i)
+    i = t[i];
+
+  return i;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FILTER_LOWER                                                            *
+ *                                                                         *
+ * Updates the min of the intervals (processed by increasing max). Returns *
+ * FALSE if a Hall interval contains more variables than values.           *
+ *-------------------------------------------------------------------------*/
+static Bool
+Filter_Lower(int n)
+{
+  int *bounds = ad_bounds, *t = ad_t, *d = ad_d, *h = ad_h;
+  int i, j, w, x, y, z;
+
+  for (i = 1; i <= ad_nb + 1; i++)
+    {
+      t[i] = h[i] = i - 1;
+      d[i] = bounds[i] - bounds[i - 1];
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      x = ad_max_sorted[i]->min_rank;
+      y = ad_max_sorted[i]->max_rank;
+      z = Path_Max(t, x + 1);
+      j = t[z];
+      if (--d[z] == 0)
+	{
+	  t[z] = z + 1;
+	  z = Path_Max(t, t[z]);
+	  t[z] = j;
+	}
+      Path_Set(t, x + 1, z, z);
+      if (d[z] < bounds[z] - bounds[y])
+	return FALSE;
+
+      if (h[x] > x)
+	{
+	  w = Path_Max(h, h[x]);
+	  ad_max_sorted[i]->min = bounds[w];
+	  Path_Set(h, x, w, w);
+	}
+
+      if (d[z] == bounds[z] - bounds[y])
+	{
+	  Path_Set(h, h[y], j - 1, y);
+	  h[y] = j - 1;
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FILTER_UPPER                                                            *
+ *                                                                         *
+ * Updates the max of the intervals (processed by decreasing min).         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Filter_Upper(int n)
+{
+  int *bounds = ad_bounds, *t = ad_t, *d = ad_d, *h = ad_h;
+  int i, j, w, x, y, z;
+
+  for (i = 0; i <= ad_nb; i++)
+    {
+      t[i] = h[i] = i + 1;
+      d[i] = bounds[i + 1] - bounds[i];
+    }
+
+  for (i = n - 1; i >= 0; i--)
+    {
+      x = ad_min_sorted[i]->max_rank;
+      y = ad_min_sorted[i]->min_rank;
+      z = Path_Min(t, x - 1);
+      j = t[z];
+      if (--d[z] == 0)
+	{
+	  t[z] = z - 1;
+	  z = Path_Min(t, t[z]);
+	  t[z] = j;
+	}
+      Path_Set(t, x - 1, z, z);
+      if (d[z] < bounds[y] - bounds[z])
+	return FALSE;
+
+      if (h[x] < x)
+	{
+	  w = Path_Min(h, h[x]);
+	  ad_min_sorted[i]->max = bounds[w] - 1;
+	  Path_Set(h, x, w, w);
+	}
+
+      if (d[z] == bounds[y] - bounds[z])
+	{
+	  Path_Set(h, h[y], j + 1, y);
+	  h[y] = j + 1;
+	}
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_ALL_DIFFERENT_DOMAIN                                              *
+ *                                                                         *
+ * Vars are numbered 0..n-1 and values (relative to the smallest min) are  *
+ * numbered 0..nb_val-1. In the residual graph a var points to its matched *
+ * value and a value points to the vars it is not matched with. Nodes are  *
+ * vars (0..n-1) followed by values (n..n+nb_val-1).                       *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_All_Different_Domain(WamWord **array)
+{
+  WamWord **p;
+  Range *r;
+  int n = (int) (PlLong) (array[0]);
+  int lo, hi, nb_val, nb_edge, nb_node;
+  int i, k, v, x;
+
+  if (n <= 1 || (array == ad_last_array && pl_fd_update_stamp == ad_last_stamp))
+    return TRUE;
+
+  p = array + 1;
+  lo = Min(p[0]);
+  hi = Max(p[0]);
+  nb_edge = 0;
+  for (i = 0; i < n; i++)
+    {
+      r = Range(p[i]);
+      if (r->min < lo)
+	lo = r->min;
+      if (r->max > hi)
+	hi = r->max;
+      nb_edge += (int) Nb_Elem(p[i]);
+    }
+
+  if (hi - lo >= AD_MAX_NB_VAL)
+    return Pl_Fd_All_Different_Bounds(array);
+
+  nb_val = hi - lo + 1;
+  if (nb_val < n)		/* pigeonhole */
+    return FALSE;
+
+  nb_node = n + nb_val;
+
+  if (n + 1 > ad_nb_var)
+    {
+      Grow_Buffer(ad_var_match, n + 1);
+      Grow_Buffer(ad_adj_start, n + 1);
+      ad_nb_var = n + 1;
+    }
+
+  if (nb_val + 1 > ad_nb_val)
+    {
+      Grow_Buffer(ad_val_match, nb_val + 1);
+      Grow_Buffer(ad_rev_start, nb_val + 1);
+      Grow_Buffer(ad_stamp, nb_val + 1);
+      ad_nb_val = nb_val + 1;
+    }
+
+  if (nb_edge > ad_nb_edge)
+    {
+      Grow_Buffer(ad_adj, nb_edge);
+      Grow_Buffer(ad_rev, nb_edge);
+      ad_nb_edge = nb_edge;
+    }
+
+  if (nb_node > ad_nb_node)
+    {
+      Grow_Buffer(ad_index, nb_node);
+      Grow_Buffer(ad_low, nb_node);
+      Grow_Buffer(ad_comp, nb_node);
+      Grow_Buffer(ad_stack, nb_node);
+      Grow_Buffer(ad_call_node, nb_node);
+      Grow_Buffer(ad_call_pos, nb_node);
+      ad_nb_node = nb_node;
+    }
+
+				/* build the var -> values edges */
+  for (v = 0; v <= nb_val; v++)
+    ad_rev_start[v] = 0;
+
+  k = 0;
+  for (i = 0; i < n; i++)
+    {
+      r = Range(p[i]);
+      ad_adj_start[i] = k;
+      RANGE_BEGIN_ENUM(r, v);
+
+      ad_adj[k++] = v - lo;
+      ad_rev_start[v - lo + 1]++;
+
+      RANGE_END_ENUM;
+    }
+  ad_adj_start[n] = k;
+
+				/* build the value -> vars edges */
+  for (v = 0; v < nb_val; v++)
+    ad_rev_start[v + 1] += ad_rev_start[v];
+
+  for (v = 0; v < nb_val; v++)
+    ad_stamp[v] = ad_rev_start[v];
+
+  for (i = 0; i < n; i++)
+    for (k = ad_adj_start[i]; k < ad_adj_start[i + 1]; k++)
+      ad_rev[ad_stamp[ad_adj[k]]++] = i;
+
+				/* maximum matching */
+  for (v = 0; v < nb_val; v++)
+    {
+      ad_val_match[v] = -1;
+      ad_stamp[v] = 0;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      ad_var_match[i] = -1;
+      for (k = ad_adj_start[i]; k < ad_adj_start[i + 1]; k++)
+	if (ad_val_match[ad_adj[k]] < 0)
+	  {
+	    ad_var_match[i] = ad_adj[k];
+	    ad_val_match[ad_adj[k]] = i;
+	    break;
+	  }
+    }
+
+  ad_cur_stamp = 0;
+  for (i = 0; i < n; i++)
+    if (ad_var_match[i] < 0)
+      {
+	ad_cur_stamp++;
+	if (!Augment_Path(i))
+	  return FALSE;
+      }
+
+				/* even alternating paths and cycles */
+  for (i = 0; i < nb_node; i++)
+    {
+      ad_index[i] = -1;
+      ad_comp[i] = -1;
+    }
+
+  for (v = 0; v < nb_val; v++)
+    if (ad_val_match[v] < 0 && ad_index[n + v] < 0)
+      Mark_Reachable(n + v, n);
+
+  Compute_SCC(nb_node, n);
+
+				/* remove unsupported values */
+  for (i = 0; i < n; i++)
+    for (k = ad_adj_start[i]; k < ad_adj_start[i + 1]; k++)
+      {
+	v = ad_adj[k];
+	x = n + v;
+	if (v != ad_var_match[i] && ad_low[x] >= 0 &&
+	    ad_comp[x] != ad_comp[i] && !Pl_Fd_Tell_Not_Value(p[i], v + lo))
+	  return FALSE;
+      }
+
+  ad_last_array = array;	/* the filtering is idempotent */
+  ad_last_stamp = pl_fd_update_stamp;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * AUGMENT_PATH                                                            *
+ *                                                                         *
+ * Searches an augmenting path from the free var x (depth-first).          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Augment_Path(int x)
+{
+  int k, v;
+
+  for (k = ad_adj_start[x]; k < ad_adj_start[x + 1]; k++)
+    {
+      v = ad_adj[k];
+      if (ad_stamp[v] == ad_cur_stamp)
+	continue;
+
+      ad_stamp[v] = ad_cur_stamp;
+      if (ad_val_match[v] < 0 || Augment_Path(ad_val_match[v]))
+	{
+	  ad_var_match[x] = v;
+	  ad_val_match[v] = x;
+	  return TRUE;
+	}
+    }
+
+  return FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEXT_SUCCESSOR                                                          *
+ *                                                                         *
+ * Returns the next successor of the node u in the residual graph (or -1). *
+ * *pos is the position of the next edge to consider (initially 0).        *
+ *-------------------------------------------------------------------------*/
+static int
+Next_Successor(int u, int *pos, int n)
+{
+  int v, x;
+
+  if (u < n)
+    return ((*pos)++ == 0) ? n + ad_var_match[u] : -1;
+
+  v = u - n;
+  while (ad_rev_start[v] + *pos < ad_rev_start[v + 1])
+    {
+      x = ad_rev[ad_rev_start[v] + (*pos)++];
+      if (ad_var_match[x] != v)
+	return x;
+    }
+
+  return -1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MARK_REACHABLE                                                          *
+ *                                                                         *
+ * Marks (in ad_index) all nodes reachable from the free value s. Their    *
+ * ad_low is set to -1 to keep all edges leaving a reachable value.        *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Reachable(int s, int n)
+{
+  int sp = 0;
+  int u, w, pos;
+
+  ad_index[s] = 0;
+  ad_low[s] = -1;
+  ad_stack[sp++] = s;
+  while (sp > 0)
+    {
+      u = ad_stack[--sp];
+      pos = 0;
+      while ((w = Next_Successor(u, &pos, n)) >= 0)
+	if (ad_index[w] < 0)
+	  {
+	    ad_index[w] = 0;
+	    ad_low[w] = -1;
+	    ad_stack[sp++] = w;
+	  }
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPUTE_SCC                                                             *
+ *                                                                         *
+ * Computes the strongly connected components (in ad_comp) of the nodes   *
+ * not reached from a free value (Tarjan's algorithm, non recursive). For  *
+ * these nodes ad_low >= 0 at the end.                                     *
+ *-------------------------------------------------------------------------*/
+static void
+Compute_SCC(int nb_node, int n)
+{
+  int counter = 0, nb_comp = 0;
+  int sp = 0, call_sp = 0;
+  int s, u, w;
+
+  for (s = 0; s < nb_node; s++)
+    {
+      if (ad_index[s] >= 0)
+	continue;
+
+      ad_index[s] = ad_low[s] = counter++;
+      ad_stack[sp++] = s;
+      ad_call_node[call_sp] = s;
+      ad_call_pos[call_sp++] = 0;
+
+      while (call_sp > 0)
+	{
+	  u = ad_call_node[call_sp - 1];
+	  w = Next_Successor(u, &ad_call_pos[call_sp - 1], n);
+	  if (w >= 0)
+	    {
+	      if (ad_index[w] < 0)
+		{
+		  ad_index[w] = ad_low[w] = counter++;
+		  ad_stack[sp++] = w;
+		  ad_call_node[call_sp] = w;
+		  ad_call_pos[call_sp++] = 0;
+		}
+	      else if (ad_comp[w] < 0 && ad_low[w] >= 0 &&
+		       ad_index[w] < ad_low[u])
+		ad_low[u] = ad_index[w];
+	      continue;
+	    }
+
+	  if (ad_low[u] == ad_index[u])
+	    {
+	      do
+		{
+		  w = ad_stack[--sp];
+		  ad_comp[w] = nb_comp;
+		}
+	      while (w != u);
+	      nb_comp++;
+	    }
+
+	  if (--call_sp > 0)
+	    {
+	      w = ad_call_node[call_sp - 1];
+	      if (ad_low[u] < ad_low[w])
+		ad_low[w] = ad_low[u];
+	    }
+	}
+    }
 }
 
 
@@ -169,6 +1041,7 @@ Pl_Fd_Element_I(Range *i, WamWord *l)
 void
 Pl_Fd_Element_I_To_V(Range *v, Range *i, WamWord *l)
 {
+  Ilist *il;
   int val;
   int j;
 
@@ -177,25 +1050,31 @@ Pl_Fd_Element_I_To_V(Range *v, Range *i, WamWord *l)
   Vector_Allocate(v->vec);
   Pl_Vector_Empty(v->vec);
 
-  if (i->min == i->max || Is_Interval(i))
-    {
-      for (j = i->min; j <= i->max; j++)
-	{
-	  val = (int) (l[j]);
-	  Vector_Set_Value(v->vec, val);
-	}
-    }
-  else
-    {
-      VECTOR_BEGIN_ENUM(i->vec, j);
+  RANGE_BEGIN_ENUM(i, j);
 
-      val = (int) (l[j]);
-      Vector_Set_Value(v->vec, val);
+  val = (int) (l[j]);
+  if ((unsigned) val > (unsigned) pl_vec_max_integer)
+    goto use_ilist;
 
-      VECTOR_END_ENUM;
-    }
+  Vector_Set_Value(v->vec, val);
+
+  RANGE_END_ENUM;
 
   Pl_Range_From_Vector(v);
+  return;
+
+use_ilist:			/* a value does not fit in a vector */
+  Ilist_Allocate(il, Pl_Range_Nb_Elem(i));
+
+  RANGE_BEGIN_ENUM(i, j);
+
+  val = (int) (l[j]);
+  Ilist_Push_Interval(il, val, val);
+
+  RANGE_END_ENUM;
+
+  Set_Range_Ilist(v, il);
+  Pl_Range_From_Ilist(v);
 }
 
 
@@ -208,17 +1087,33 @@ Pl_Fd_Element_I_To_V(Range *v, Range *i, WamWord *l)
 void
 Pl_Fd_Element_V_To_I(Range *i, Range *v, WamWord *l)
 {
+  Ilist *il;
   int val;
   int n;
   int j;
 
   /* when V changes -> update I */
 
+  n = (int) (*l);
+
+  if (n > pl_vec_max_integer)	/* too many indexes for a vector */
+    {
+      Ilist_Allocate(il, n / 2 + 1);
+      for (j = 1; j <= n; j++)
+	{
+	  val = (int) (l[j]);
+	  if (Pl_Range_Test_Value(v, val))
+	    Ilist_Add_Interval(il, j, j);
+	}
+
+      Set_Range_Ilist(i, il);
+      Pl_Range_From_Ilist(i);
+      return;
+    }
+
   Vector_Allocate(i->vec);
   Pl_Vector_Empty(i->vec);
 
-  n = (int) (*l);
-
   for (j = 1; j <= n; j++)
     {
       val = (int) (l[j]);		/* val=Lj */
@@ -264,23 +1159,12 @@ Pl_Fd_Element_Var_I_To_V(Range *v, Range *i, WamWord **l)
 
   /* when I or L changes -> update V */
 
-  if (i->min == i->max || Is_Interval(i))
-    {
-      for (j = i->min; j <= i->max; j++)
-	{
-	  fdv_adr = l[j];
-	  Pl_Range_Union(v, Range(fdv_adr));
-	}
-    }
-  else
-    {
-      VECTOR_BEGIN_ENUM(i->vec, j);
+  RANGE_BEGIN_ENUM(i, j);
 
-      fdv_adr = l[j];
-      Pl_Range_Union(v, Range(fdv_adr));
+  fdv_adr = l[j];
+  Pl_Range_Union(v, Range(fdv_adr));
 
-      VECTOR_END_ENUM;
-    }
+  RANGE_END_ENUM;
 }
 
 
@@ -294,15 +1178,32 @@ void
 Pl_Fd_Element_Var_V_To_I(Range *i, Range *v, WamWord **l)
 {
   WamWord *fdv_adr;
+  Ilist *il;
   PlLong n;
   int j;
 
-  Vector_Allocate(i->vec);
-  Pl_Vector_Empty(i->vec);
   /* when V or L changes -> update I */
 
   n = (PlLong) *l;
 
+  if (n > pl_vec_max_integer)	/* too many indexes for a vector */
+    {
+      Ilist_Allocate(il, n / 2 + 1);
+      for (j = 1; j <= n; j++)
+	{
+	  fdv_adr = l[j];
+	  if (!Pl_Range_Test_Null_Inter(Range(fdv_adr), v))
+	    Ilist_Add_Interval(il, j, j);
+	}
+
+      Set_Range_Ilist(i, il);
+      Pl_Range_From_Ilist(i);
+      return;
+    }
+
+  Vector_Allocate(i->vec);
+  Pl_Vector_Empty(i->vec);
+
   for (j = 1; j <= n; j++)
     {
       fdv_adr = l[j];
@@ -478,3 +1379,492 @@ Pl_Fd_Exactly(int n, WamWord **array, int v)
     }
   return TRUE;
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * fd_relation/2 is implemented by a table constraint ensuring generalized *
+ * arc consistency with the Compact-Table algorithm (Demeulenaere et al.,  *
+ * CP 2016). The set of the tuples which are still valid is a reversible   *
+ * sparse bitset: an array of words whose non zero words are given by      *
+ * index[0..limit]. For each variable X and each value a of its column a   *
+ * bitset supports(X,a) gives the tuples where X = a.                      *
+ *                                                                         *
+ * When executed, the tuples are first updated: for each variable whose    *
+ * domain has been reduced since the last execution the table is ANDed    *
+ * with the union of the supports of its removed values (complemented) or *
+ * of its remaining values (whichever is smaller). Then each value of each *
+ * non ground variable is kept if its supports intersect the table (the   *
+ * word found last time - residue - is tested first), else it is removed. *
+ *                                                                         *
+ * The state of the constraint is allocated on the constraint stack when   *
+ * it is posted (Pl_Fd_Table_Init). Each word of the table, the limit and  *
+ * the number of values of each variable are stored with the STAMP of     *
+ * their last trailing (as the range of an FD variable) so that a word is *
+ * trailed at most once per choice point. The order of index[] and of the *
+ * sparse sets of values is not restored on backtracking: only their      *
+ * limits need to be.                                                      *
+ *-------------------------------------------------------------------------*/
+
+#define Table_Stamp_Trail_If_Necessary(cell)	\
+  do						\
+    {						\
+      if ((cell)[0] != STAMP)			\
+	{					\
+	  Trail_MV(cell, 2);			\
+	  (cell)[0] = STAMP;			\
+	}					\
+    }						\
+  while (0)
+
+
+#define Table_Word(tc, k)          ((VecWord) (tc)->words[2 * (k) + 1])
+#define Table_Supports(tv, j, nb_word) ((tv)->supports + (PlLong) (j) * (nb_word))
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TABLE_INIT                                                        *
+ *                                                                         *
+ * Reads the tuples, allocates the state of the constraint (its address is *
+ * stored in slot[1]) and restricts each variable to the values of its     *
+ * column. Tuples whose length is not the number of variables make the     *
+ * constraint fail.                                                        *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Table_Init(WamWord **array, WamWord tuples_word, WamWord *slot)
+{
+  int n = (int) (PlLong) (array[0]);
+  int nb_tuple, nb_word, nb_val;
+  TableCstr *tc;
+  TableVar *tv;
+  VecWord *supp;
+  int *tuple;
+  int i, j, k, t;
+
+  slot[1] = (WamWord) NULL;
+  if (n == 0)
+    return TRUE;
+
+  if ((nb_tuple = Table_Read_Tuples(tuples_word, n)) <= 0)
+    return FALSE;
+
+  nb_word = (nb_tuple + WORD_SIZE - 1) >> WORD_SIZE_BITS;
+
+  tc = (TableCstr *) Table_Alloc(sizeof(TableCstr) + (n - 1) * sizeof(TableVar));
+  tc->arity = n;
+  tc->nb_word = nb_word;
+  tc->last_stamp = 0;
+
+  tc->words = (WamWord *) Table_Alloc(2 * nb_word * sizeof(WamWord));
+  tc->index = (int *) Table_Alloc(nb_word * sizeof(int));
+  tc->limit = (WamWord *) Table_Alloc(2 * sizeof(WamWord));
+  for (k = 0; k < nb_word; k++)
+    {
+      tc->words[2 * k] = STAMP;
+      tc->words[2 * k + 1] = (WamWord) ~(VecWord) 0;
+      tc->index[k] = k;
+    }
+  if (nb_tuple % WORD_SIZE)
+    tc->words[2 * nb_word - 1] = (WamWord) (((VecWord) 1 << (nb_tuple % WORD_SIZE)) - 1);
+  tc->limit[0] = STAMP;
+  tc->limit[1] = nb_word - 1;
+
+  if (nb_word > tb_nb_mask)
+    {
+      Grow_Buffer(tb_mask, nb_word);
+      tb_nb_mask = nb_word;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      tv = tc->var + i;
+      tv->fdv_adr = array[i + 1];
+      nb_val = Table_Sort_Column(n, nb_tuple, i);
+      tv->nb_val = nb_val;
+      tv->val = (int *) Table_Alloc(nb_val * sizeof(int));
+      memcpy(tv->val, tb_column, nb_val * sizeof(int));
+      tv->set = (int *) Table_Alloc(nb_val * sizeof(int));
+      tv->residue = (int *) Table_Alloc(nb_val * sizeof(int));
+      for (j = 0; j < nb_val; j++)
+	{
+	  tv->set[j] = j;
+	  tv->residue[j] = 0;
+	}
+      tv->size = (WamWord *) Table_Alloc(2 * sizeof(WamWord));
+      tv->size[0] = STAMP;
+      tv->size[1] = nb_val;
+      tv->supports = (VecWord *) Table_Alloc((PlLong) nb_val * nb_word * sizeof(VecWord));
+      memset(tv->supports, 0, (PlLong) nb_val * nb_word * sizeof(VecWord));
+
+      if (nb_val > tb_nb_removed)
+	{
+	  Grow_Buffer(tb_removed, nb_val);
+	  tb_nb_removed = nb_val;
+	}
+    }
+
+  for (t = 0, tuple = tb_tuple; t < nb_tuple; t++, tuple += n)
+    for (i = 0; i < n; i++)
+      {
+	tv = tc->var + i;
+	j = Table_Search_Value(tv, tuple[i]);
+	supp = Table_Supports(tv, j, nb_word);
+	supp[Word_No(t)] |= (VecWord) 1 << Bit_No(t);
+      }
+
+  slot[1] = (WamWord) tc;
+
+  for (i = 0; i < n; i++)	/* last: can use the top of the stack */
+    if (!Table_Restrict_Domain(tc->var + i))
+      return FALSE;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_ALLOC                                                             *
+ *                                                                         *
+ * Allocates size bytes (word aligned) on the constraint stack.            *
+ *-------------------------------------------------------------------------*/
+static void *
+Table_Alloc(PlLong size)
+{
+  WamWord *p = CS;
+
+  CS += (size + sizeof(WamWord) - 1) / sizeof(WamWord);
+
+  return p;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_READ_TUPLES                                                       *
+ *                                                                         *
+ * Reads the list of tuples in tb_tuple and returns the number of tuples   *
+ * or -1 if a tuple has not n elements.                                    *
+ *-------------------------------------------------------------------------*/
+static int
+Table_Read_Tuples(WamWord tuples_word, int n)
+{
+  WamWord word, tag_mask;
+  WamWord save_tuples_word = tuples_word;
+  WamWord tuple_word, save_tuple_word;
+  WamWord *lst_adr, *lst_adr1;
+  int nb_tuple = 0;
+  int *p;
+  int i;
+
+  for (;;)
+    {
+      DEREF(tuples_word, word, tag_mask);
+      if (tag_mask == TAG_REF_MASK)
+	Pl_Err_Instantiation();
+
+      if (word == NIL_WORD)
+	break;
+
+      if (tag_mask != TAG_LST_MASK)
+	Pl_Err_Type(pl_type_list, save_tuples_word);
+
+      lst_adr = UnTag_LST(word);
+      if ((nb_tuple + 1) * n > tb_nb_tuple)
+	{
+	  tb_nb_tuple = (tb_nb_tuple == 0) ? 1024 * n : 2 * tb_nb_tuple;
+	  Grow_Buffer(tb_tuple, tb_nb_tuple);
+	}
+
+      p = tb_tuple + nb_tuple * n;
+      tuple_word = save_tuple_word = Car(lst_adr);
+      for (i = 0;; i++)
+	{
+	  DEREF(tuple_word, word, tag_mask);
+	  if (tag_mask == TAG_REF_MASK)
+	    Pl_Err_Instantiation();
+
+	  if (word == NIL_WORD)
+	    break;
+
+	  if (tag_mask != TAG_LST_MASK)
+	    Pl_Err_Type(pl_type_list, save_tuple_word);
+
+	  if (i == n)
+	    return -1;
+
+	  lst_adr1 = UnTag_LST(word);
+	  *p++ = Pl_Fd_Prolog_To_Value(Car(lst_adr1));
+	  tuple_word = Cdr(lst_adr1);
+	}
+
+      if (i != n)
+	return -1;
+
+      nb_tuple++;
+      tuples_word = Cdr(lst_adr);
+    }
+
+  return nb_tuple;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_SORT_COLUMN                                                       *
+ *                                                                         *
+ * Stores in tb_column the distinct values of the ith column (sorted) and  *
+ * returns their number.                                                   *
+ *-------------------------------------------------------------------------*/
+static int
+Table_Sort_Column(int n, int nb_tuple, int i)
+{
+  int *tuple;
+  int t, k, nb_val;
+
+  if (nb_tuple > tb_nb_column)
+    {
+      Grow_Buffer(tb_column, nb_tuple);
+      tb_nb_column = nb_tuple;
+    }
+
+  for (t = 0, tuple = tb_tuple + i; t < nb_tuple; t++, tuple += n)
+    tb_column[t] = *tuple;
+
+  qsort(tb_column, nb_tuple, sizeof(int),
+	(int (*)(const void *, const void *)) Compar_Int);
+
+  for (k = 1, nb_val = 1; k < nb_tuple; k++)
+    if (tb_column[k] != tb_column[nb_val - 1])
+      tb_column[nb_val++] = tb_column[k];
+
+  return nb_val;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_SEARCH_VALUE                                                      *
+ *                                                                         *
+ * Returns the index of v in the values of a variable (v must be present). *
+ *-------------------------------------------------------------------------*/
+static int
+Table_Search_Value(TableVar *tv, int v)
+{
+  int a = 0, b = tv->nb_val - 1;
+  int j;
+
+  while (a < b)
+    {
+      j = (a + b) / 2;
+      if (tv->val[j] < v)
+	a = j + 1;
+      else
+	b = j;
+    }
+
+  return a;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_RESTRICT_DOMAIN                                                   *
+ *                                                                         *
+ * Removes from the domain of a variable the values absent from its column.*
+ *-------------------------------------------------------------------------*/
+static Bool
+Table_Restrict_Domain(TableVar *tv)
+{
+  WamWord *save_CS = CS;
+  Range range;
+  Ilist *il;
+  int j;
+
+  Ilist_Allocate(il, tv->nb_val);
+  for (j = 0; j < tv->nb_val; j++)
+    Ilist_Push_Interval(il, tv->val[j], tv->val[j]);
+
+  range.extra_cstr = FALSE;
+  Set_Range_Ilist(&range, il);
+  Pl_Range_From_Ilist(&range);
+
+  CS = save_CS;
+
+  return Pl_Fd_Tell_Range(tv->fdv_adr, &range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_TABLE                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Table(WamWord **array, WamWord *slot)
+{
+  TableCstr *tc = (TableCstr *) slot[1];
+  TableVar *tv, *end;
+
+  if (tc == NULL || tc->last_stamp == pl_fd_update_stamp)
+    return TRUE;
+
+  end = tc->var + tc->arity;
+  for (tv = tc->var; tv < end; tv++)
+    if (Nb_Elem(tv->fdv_adr) != tv->size[1] && !Table_Update_Var(tc, tv))
+      return FALSE;
+
+  for (tv = tc->var; tv < end; tv++)
+    if (!Fd_Variable_Is_Ground(tv->fdv_adr) && !Table_Filter_Var(tc, tv))
+      return FALSE;
+				/* removing values without support does not */
+				/* change the table: this is a fix point     */
+  tc->last_stamp = pl_fd_update_stamp;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_UPDATE_VAR                                                        *
+ *                                                                         *
+ * Removes from the table the tuples of the values no longer in the       *
+ * domain of a variable. Fails if the table becomes empty.                 *
+ *-------------------------------------------------------------------------*/
+static Bool
+Table_Update_Var(TableCstr *tc, TableVar *tv)
+{
+  Range *range = Range(tv->fdv_adr);
+  int nb_word = tc->nb_word;
+  int *index = tc->index;
+  int limit = (int) tc->limit[1];
+  int size = (int) tv->size[1];
+  int nb_removed = 0;
+  VecWord *supp, w;
+  Bool keep;
+  int p, j, k, off;
+
+  for (p = size - 1; p >= 0; p--)
+    {
+      j = tv->set[p];
+      if (!Pl_Range_Test_Value(range, tv->val[j]))
+	{
+	  tv->set[p] = tv->set[--size];
+	  tv->set[size] = j;
+	  tb_removed[nb_removed++] = j;
+	}
+    }
+
+  Table_Stamp_Trail_If_Necessary(tv->size);
+  tv->size[1] = size;
+
+  if (nb_removed == 0)
+    return TRUE;
+
+  keep = (size < nb_removed);	/* mask of the tuples to keep or to remove */
+  for (k = 0; k <= limit; k++)
+    tb_mask[index[k]] = 0;
+
+  for (p = 0; p < ((keep) ? size : nb_removed); p++)
+    {
+      j = (keep) ? tv->set[p] : tb_removed[p];
+      supp = Table_Supports(tv, j, nb_word);
+      for (k = 0; k <= limit; k++)
+	{
+	  off = index[k];
+	  tb_mask[off] |= supp[off];
+	}
+    }
+
+  for (k = limit; k >= 0; k--)
+    {
+      off = index[k];
+      w = Table_Word(tc, off);
+      w &= (keep) ? tb_mask[off] : ~tb_mask[off];
+      if (w == Table_Word(tc, off))
+	continue;
+
+      Table_Stamp_Trail_If_Necessary(tc->words + 2 * off);
+      tc->words[2 * off + 1] = (WamWord) w;
+      if (w == 0)
+	{
+	  index[k] = index[limit];
+	  index[limit--] = off;
+	}
+    }
+
+  if (limit != tc->limit[1])
+    {
+      Table_Stamp_Trail_If_Necessary(tc->limit);
+      tc->limit[1] = limit;
+    }
+
+  return limit >= 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_FILTER_VAR                                                        *
+ *                                                                         *
+ * Removes from the domain of a variable the values without support.       *
+ *-------------------------------------------------------------------------*/
+static Bool
+Table_Filter_Var(TableCstr *tc, TableVar *tv)
+{
+  int nb_word = tc->nb_word;
+  int *index = tc->index;
+  int limit = (int) tc->limit[1];
+  int size = (int) tv->size[1];
+  int old_size = size;
+  VecWord *supp;
+  int p, j, k, off;
+
+  for (p = size - 1; p >= 0; p--)
+    {
+      j = tv->set[p];
+      supp = Table_Supports(tv, j, nb_word);
+      off = tv->residue[j];
+      if (Table_Word(tc, off) & supp[off])
+	continue;
+
+      for (k = 0; k <= limit; k++)
+	{
+	  off = index[k];
+	  if (Table_Word(tc, off) & supp[off])
+	    break;
+	}
+
+      if (k <= limit)
+	{
+	  tv->residue[j] = off;
+	  continue;
+	}
+
+      if (!Pl_Fd_Tell_Not_Value(tv->fdv_adr, tv->val[j]))
+	return FALSE;
+
+      tv->set[p] = tv->set[--size];
+      tv->set[size] = j;
+    }
+
+  if (size != old_size)
+    {
+      Table_Stamp_Trail_If_Necessary(tv->size);
+      tv->size[1] = size;
+    }
+
+  return TRUE;
+}
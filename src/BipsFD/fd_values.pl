@@ -85,7 +85,7 @@ fd_labeling(List, Options) :-
 
 '$fd_labeling'(List, Options) :-
 	'$set_labeling_defaults',
-	'$get_labeling_options'(Options, Bckts),
+	'$get_labeling_options'(Options, Bckts, Restart, Nogoods),
 	'$sys_var_read'(0, VarMethod),
 	'$sys_var_read'(1, ValMethod),
 	'$sys_var_read'(2, Reorder),
@@ -94,7 +94,12 @@ fd_labeling(List, Options) :-
 	    '$indomain'(List, ValMethod)
 	;
 	    '$check_list'(List),
-	    '$fd_labeling1'(List, VarMethod, ValMethod, Reorder)
+	    (   Restart = none ->
+		'$fd_labeling1'(List, VarMethod, ValMethod, Reorder)
+	    ;
+		'$fd_labeling_restart'(List, VarMethod, ValMethod, Reorder,
+				       Restart, Nogoods)
+	    )
 	),
 	'$fd_get_labeling_backtracks'(Bckts).
 
@@ -122,11 +127,15 @@ fd_labeling(List, Options) :-
 
 
 
-'$get_labeling_options'(Options, Bckts) :-
+'$get_labeling_options'(Options, Bckts, Restart, Nogoods) :-
 	'$check_list'(Options),
 	g_link('$backtracks', _),
+	g_assign('$fd_restart', none),
+	g_assign('$fd_nogoods', 1),
 	'$get_labeling_options1'(Options),
-	g_read('$backtracks', Bckts).
+	g_read('$backtracks', Bckts),
+	g_read('$fd_restart', Restart),
+	g_read('$fd_nogoods', Nogoods).
 
 
 '$get_labeling_options1'([]).
@@ -158,6 +167,12 @@ fd_labeling(List, Options) :-
 	    '$sys_var_write'(0, 5)
 	;   X = random,
 	    '$sys_var_write'(0, 6)
+	;   X = dom_wdeg,
+	    '$sys_var_write'(0, 7)
+	;   X = activity,
+	    '$sys_var_write'(0, 8)
+	;   X = impact,
+	    '$sys_var_write'(0, 9)
 	).
 
 '$get_labeling_options2'(value_method(X)) :-
@@ -187,6 +202,31 @@ fd_labeling(List, Options) :-
 '$get_labeling_options2'(backtracks(Bckts)) :- % maybe check Bckts is var or integer ?
 	g_link('$backtracks', Bckts).
 
+'$get_labeling_options2'(restart(X)) :-        % no arithmetic (keeps bip name)
+	'$check_nonvar'(X),
+	(   X = none
+	;   X = luby(Scale),
+	    integer(Scale),
+	    Scale @> 0
+	;   X = geometric(Scale, Factor),
+	    integer(Scale),
+	    Scale @> 0,
+	    (   integer(Factor) ->
+		Factor @>= 1
+	    ;   float(Factor),
+		Factor @>= 1.0
+	    )
+	),
+	g_assign('$fd_restart', X).
+
+'$get_labeling_options2'(nogoods(X)) :-
+	'$check_nonvar'(X),
+	(   X = false,
+	    g_assign('$fd_nogoods', 0)
+	;   X = true,
+	    g_assign('$fd_nogoods', 1)
+	).
+
 '$get_labeling_options2'(X) :-
 	'$pl_err_domain'(fd_labeling_option, X).
 
@@ -206,6 +246,77 @@ fd_labeling(List, Options) :-
 
 
 
+'$fd_labeling_restart'(List, VarMethod, ValMethod, Reorder, Restart, Nogoods) :-
+	'$call_c'('Pl_Fd_Restart_Begin_1'(Nogoods)),
+	catch('$fd_restart_runs'(1, List, VarMethod, ValMethod, Reorder,
+				 Restart, Found), Err,
+	      '$fd_restart_abort'(Err)),
+	'$call_c'('Pl_Fd_Restart_End_0'),
+	Found = true.
+
+
+
+
+'$fd_restart_abort'(Err) :-
+	'$call_c'('Pl_Fd_Restart_End_0'),
+	throw(Err).
+
+
+
+
+	% Found = true (solution), false (search space exhausted)
+
+'$fd_restart_runs'(I, List, VarMethod, ValMethod, Reorder, Restart, Found) :-
+	'$fd_restart_limit'(Restart, I, Limit),
+	(   '$call_c_test'('Pl_Fd_Restart_Run_1'(Limit)),
+	    '$fd_labeling1'(List, VarMethod, ValMethod, Reorder) ->
+	    Found = true
+	;   '$call_c_test'('Pl_Fd_Restart_Limit_Reached_0') ->
+	    I1 is I + 1,
+	    '$fd_restart_runs'(I1, List, VarMethod, ValMethod, Reorder,
+			       Restart, Found)
+	;   Found = false
+	).
+
+
+
+
+'$fd_restart_limit'(luby(Scale), I, Limit) :-
+	'$fd_luby'(I, L),
+	Limit is Scale * L.
+
+'$fd_restart_limit'(geometric(Scale, Factor), I, Limit) :-
+	current_prolog_flag(max_integer, Max),
+	L is Scale * Factor ** (I - 1),
+	(   L >= Max ->
+	    Limit = Max
+	;   Limit is round(L)
+	).
+
+
+
+
+	% I-th term of the Luby sequence (1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ...)
+
+'$fd_luby'(I, L) :-
+	'$fd_luby_k'(I, 1, K),
+	(   I =:= (1 << K) - 1 ->
+	    L is 1 << (K - 1)
+	;   I1 is I - (1 << (K - 1)) + 1,
+	    '$fd_luby'(I1, L)
+	).
+
+
+'$fd_luby_k'(I, K, K) :-
+	(1 << K) - 1 >= I, !.
+
+'$fd_luby_k'(I, K, K2) :-
+	K1 is K + 1,
+	'$fd_luby_k'(I, K1, K2).
+
+
+
+
 '$fd_labeling_std'([], _).
 
 '$fd_labeling_std'([X|List], ValMethod) :-
@@ -37,6 +37,9 @@
 
 
 #include <stdlib.h>
+#include <math.h>
+
+#define OBJ_INIT Fd_Values_Initializer
 
 #include "engine_pl.h"
 #include "bips_pl.h"
@@ -70,6 +73,33 @@
 #define METHOD_LARGEST             4
 #define METHOD_MAX_REGRET          5
 #define METHOD_RANDOM              6
+#define METHOD_DOM_WDEG            7
+#define METHOD_ACTIVITY            8
+#define METHOD_IMPACT              9
+
+
+
+#define IMPACT_RATE                0.25	/* weight of a new impact measure */
+
+	  /* before the nb of elems of a selection array (not trailed) */
+#define SEL_ARRAY_INFO_SIZE        4
+#define Last_Pick_Fdv(sel)         (*(WamWord **) &(sel)[-4])
+#define Last_Pick_Size(sel)        ((sel)[-3])
+#define Last_Pick_Stamp(sel)       ((sel)[-2])
+#define Last_Pick_Space(sel)       (*(float *)    &(sel)[-1])
+
+
+
+	  /* decisions of a restarted labeling (pushed on the CS) */
+#define DECISION_FRAME_SIZE        4
+#define Decision_Prev(d)           (*(WamWord **) &(d)[0])
+#define Decision_Fdv(d)            (*(WamWord **) &(d)[1])
+#define Decision_Value(d)          ((d)[2])
+#define Decision_Kind(d)           ((d)[3])
+
+#define DECISION_EQ                0 /* X = V  (negation: X \= V) */
+#define DECISION_LE                1 /* X =< V (negation: X > V)  */
+#define DECISION_NEG               2 /* flag: negated decision     */
 
 
 
@@ -80,6 +110,20 @@
 
 typedef Bool (*CmpFct) (WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
+typedef struct
+{
+  Bool active;			/* a labeling with restarts is running */
+  Bool nogoods;			/* record nogoods at each restart */
+  PlLong fail_limit;		/* nb of failures allowed in the current run */
+  PlLong nb_fail;		/* nb of failures in the current run */
+  Bool limit_reached;		/* the current run has to be stopped */
+  WamWord *base;		/* decision_top at the start of the run */
+  WamWord *ng;			/* nogoods: n, n vars, n kinds, n values */
+  PlLong ng_size;		/* size of ng (in words) */
+  PlLong ng_max;		/* allocated size of ng (in words) */
+}
+RestartCtx;
+
 
 
 
@@ -87,6 +131,12 @@ typedef Bool (*CmpFct) (WamWord *last_fdv_adr, WamWord *new_fdv_adr);
  * Global Variables                *
  *---------------------------------*/
 
+static PL_THREAD_LOCAL WamWord *score_fdv_adr;	/* cache for Cmp_Score (last compared var) */
+static PL_THREAD_LOCAL double score_value;
+
+static PL_THREAD_LOCAL RestartCtx restart;
+static PL_THREAD_LOCAL WamWord *decision_top;	/* last decision (trailed) */
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
@@ -101,6 +151,29 @@ static Bool Cmp_Largest(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
 static Bool Cmp_Max_Regret(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
 
+static Bool Cmp_Dom_Wdeg(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
+
+static Bool Cmp_Activity(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
+
+static Bool Cmp_Impact(WamWord *last_fdv_adr, WamWord *new_fdv_adr);
+
+static Bool Cmp_Score(WamWord *last_fdv_adr, WamWord *new_fdv_adr,
+		      double (*score_fct) (WamWord *fdv_adr));
+
+static double Score_Dom_Wdeg(WamWord *fdv_adr);
+
+static double Score_Activity(WamWord *fdv_adr);
+
+static double Update_Impact(WamWord *sel_array, WamWord **array, WamWord **end);
+
+static void Push_Decision(WamWord *fdv_adr, int value, int kind);
+
+static Bool Restart_Failure(WamWord *fdv_adr, int value, int kind);
+
+static void Record_Nogoods(WamWord *fdv_adr, int value, int kind);
+
+static void Add_Nogood(WamWord **pos, int n, WamWord *fdv_adr, int value, int kind);
+
 
 
 #define INDOMAIN_ALT               X1_24696E646F6D61696E5F616C74
@@ -116,6 +189,27 @@ Prolog_Prototype(EXTRA_CSTR_ALT, 0);
 
 Bool pl_fd_domain_r(WamWord x_word, WamWord r_word);
 
+Bool pl_fd_nogood(WamWord l_word, WamWord k_word, WamWord v_word);
+
+  /* defined in fd_optim_c.c */
+
+Bool Pl_Fd_Optim_Check(Bool failure);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FD_VALUES_INITIALIZER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Fd_Values_Initializer(void)
+{
+  Pl_Engine_Add_Context(&score_fdv_adr, sizeof(score_fdv_adr));
+  Pl_Engine_Add_Context(&restart, sizeof(restart));
+  Pl_Engine_Add_Context(&decision_top, sizeof(decision_top));
+}
+
 
 
 
@@ -345,6 +439,12 @@ Pl_Indomain_2(WamWord x_word, WamWord method_word)
   if (tag_mask == TAG_INT_MASK)
     return TRUE;
 
+  if (!Pl_Fd_Optim_Check(FALSE))	/* branch-and-bound / limits */
+    return FALSE;
+
+  if (restart.limit_reached)	/* restart: stop the current run */
+    return FALSE;
+
   value = Select_Value(fdv_adr, value_method);
   
   A(0) = (WamWord) fdv_adr | Extra_Cstr(fdv_adr);
@@ -353,6 +453,10 @@ Pl_Indomain_2(WamWord x_word, WamWord method_word)
 
   Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 3);
 
+  if (restart.nogoods)
+    Push_Decision(fdv_adr, value,
+		  (value_method == METHOD_BISECT) ? DECISION_LE : DECISION_EQ);
+
   if (value_method == METHOD_BISECT)
     {
       if (!Pl_Fd_In_Interval(fdv_adr, 0, value))
@@ -391,6 +495,14 @@ Pl_Indomain_Alt_0(void)
   value_method = (int) A(1);
   value = (int) A(2);
 
+  if (restart.active &&
+      Restart_Failure(fdv_adr, value,
+		      (value_method == METHOD_BISECT) ? DECISION_LE : DECISION_EQ))
+    return FALSE;
+
+  if (!Pl_Fd_Optim_Check(TRUE))	/* branch-and-bound / limits */
+    return FALSE;
+
   if (value_method == METHOD_LIMITS_MIN)
     value_method = METHOD_LIMITS_MAX;
   else if (value_method == METHOD_LIMITS_MAX)
@@ -403,6 +515,9 @@ Pl_Indomain_Alt_0(void)
       if (!Pl_Fd_In_Interval(fdv_adr, value + 1, INTERVAL_MAX_INTEGER))
 	return FALSE;
 
+      if (restart.nogoods)
+	Push_Decision(fdv_adr, value, DECISION_LE | DECISION_NEG);
+
       /* simple and enough (like in Prolog) */
       return Pl_Indomain_2(*fdv_adr, Tag_INT(value_method));
     }
@@ -416,6 +531,9 @@ Pl_Indomain_Alt_0(void)
       return FALSE;
     }
 
+  if (restart.nogoods)
+    Push_Decision(fdv_adr, value, DECISION_EQ | DECISION_NEG);
+
   if (Tag_Mask_Of(*fdv_adr) == TAG_INT_MASK)
     {
       if (extra_cstr)
@@ -435,6 +553,9 @@ Pl_Indomain_Alt_0(void)
 
   Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(INDOMAIN_ALT, 0), 3);
 
+  if (restart.nogoods)
+    Push_Decision(fdv_adr, value, DECISION_EQ);
+
   return Pl_Fd_Assign_Value_Fast(fdv_adr, value);
 }
 
@@ -461,6 +582,280 @@ Pl_Extra_Cstr_Alt_0(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * Restarts (fd_labeling/2 option restart(S))                              *
+ *                                                                         *
+ * The labeling is executed by runs (see fd_values.pl). A run is stopped   *
+ * (all its remaining choices fail at once) when its number of failures    *
+ * (backtracks in Pl_Indomain_Alt_0) reaches the limit given by the        *
+ * restart strategy. If nogoods are recorded, the decisions of the current *
+ * run are pushed on the CS (the last one being decision_top, which is     *
+ * trailed, so that the decision path is restored on backtracking). When   *
+ * the limit is reached, for each negated decision X \= V (or X > V) of    *
+ * the path the conjunction of the positive decisions before it and of     *
+ * X = V (resp. X =< V) is a nogood (reduced nld-nogoods). The nogoods are *
+ * stored outside the stacks and posted (pl_fd_nogood) at each run.        *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_BEGIN_1                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Restart_Begin_1(WamWord nogoods_word)
+{
+  restart.active = TRUE;
+  restart.nogoods = Pl_Rd_Integer(nogoods_word);
+  restart.fail_limit = 0;
+  restart.nb_fail = 0;
+  restart.limit_reached = FALSE;
+  restart.ng_size = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_END_0                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fd_Restart_End_0(void)
+{
+  restart.active = FALSE;
+  restart.nogoods = FALSE;
+  restart.limit_reached = FALSE;
+  restart.ng_size = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_RUN_1                                                     *
+ *                                                                         *
+ * Starts a new run with a given failure limit and posts the nogoods.      *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Restart_Run_1(WamWord limit_word)
+{
+  WamWord *p, *end;
+  int n;
+
+  restart.fail_limit = Pl_Rd_Integer(limit_word);
+  restart.nb_fail = 0;
+  restart.limit_reached = FALSE;
+  restart.base = decision_top;
+
+  p = restart.ng;
+  end = p + restart.ng_size;
+  while (p < end)
+    {
+      n = (int) *p++;
+      if (!pl_fd_nogood(Pl_Mk_Proper_List(n, p), Pl_Mk_Proper_List(n, p + n),
+			Pl_Mk_Proper_List(n, p + 2 * n)))
+	return FALSE;
+      p += 3 * n;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_RESTART_LIMIT_REACHED_0                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Restart_Limit_Reached_0(void)
+{
+  return restart.limit_reached;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PUSH_DECISION                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Push_Decision(WamWord *fdv_adr, int value, int kind)
+{
+  WamWord *d = CS;
+
+  CS += DECISION_FRAME_SIZE;
+
+  Decision_Prev(d) = decision_top;
+  Decision_Fdv(d) = fdv_adr;
+  Decision_Value(d) = value;
+  Decision_Kind(d) = kind;
+
+  Trail_OV((WamWord *) &decision_top);
+  decision_top = d;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RESTART_FAILURE                                                         *
+ *                                                                         *
+ * Called when the decision fdv_adr = value (or fdv_adr =< value if kind   *
+ * is DECISION_LE) has been refuted. Returns TRUE if the run must stop.    *
+ *-------------------------------------------------------------------------*/
+static Bool
+Restart_Failure(WamWord *fdv_adr, int value, int kind)
+{
+  if (restart.limit_reached)
+    return TRUE;
+
+  if (restart.fail_limit <= 0 || ++restart.nb_fail < restart.fail_limit)
+    return FALSE;
+
+  if (restart.nogoods)
+    Record_Nogoods(fdv_adr, value, kind);
+
+  restart.limit_reached = TRUE;
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RECORD_NOGOODS                                                          *
+ *                                                                         *
+ * Records the nogoods of the decision path (the refuted decision being    *
+ * fdv_adr = value or fdv_adr =< value). The top of the CS (free) is used  *
+ * to store the path and then the positive decisions.                      *
+ *-------------------------------------------------------------------------*/
+static void
+Record_Nogoods(WamWord *fdv_adr, int value, int kind)
+{
+  WamWord **path = (WamWord **) CS;
+  WamWord **pos;
+  WamWord *d;
+  int n = 0, nb_pos = 0;
+
+  for (d = decision_top; d != restart.base; d = Decision_Prev(d))
+    path[n++] = d;
+
+  pos = path + n;
+  while (--n >= 0)
+    {
+      d = path[n];
+      if (Decision_Kind(d) & DECISION_NEG)
+	Add_Nogood(pos, nb_pos, Decision_Fdv(d), (int) Decision_Value(d),
+		   (int) (Decision_Kind(d) & ~DECISION_NEG));
+      else
+	pos[nb_pos++] = d;
+    }
+
+  Add_Nogood(pos, nb_pos, fdv_adr, value, kind);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ADD_NOGOOD                                                              *
+ *                                                                         *
+ * Adds the nogood made of the n positive decisions pos and of the         *
+ * decision fdv_adr = value (or fdv_adr =< value).                         *
+ *-------------------------------------------------------------------------*/
+static void
+Add_Nogood(WamWord **pos, int n, WamWord *fdv_adr, int value, int kind)
+{
+  WamWord *p;
+  int i;
+
+  if (restart.ng_size + 1 + 3 * (n + 1) > restart.ng_max)
+    {
+      restart.ng_max = restart.ng_max * 2 + 1 + 3 * (n + 1) + 1024;
+      restart.ng = (WamWord *) Realloc(restart.ng, restart.ng_max * sizeof(WamWord));
+    }
+
+  p = restart.ng + restart.ng_size;
+  *p++ = n + 1;
+  for (i = 0; i < n; i++)
+    {
+      p[i] = Tag_REF(Decision_Fdv(pos[i]));
+      p[i + n + 1] = Tag_INT(Decision_Kind(pos[i]));
+      p[i + 2 * (n + 1)] = Tag_INT(Decision_Value(pos[i]));
+    }
+  p[n] = Tag_REF(fdv_adr);
+  p[2 * n + 1] = Tag_INT(kind);
+  p[3 * n + 2] = Tag_INT(value);
+
+  restart.ng_size += 1 + 3 * (n + 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_NOGOOD                                                            *
+ *                                                                         *
+ * Constraint: the decisions (L[i] = V[i] if K[i] = DECISION_EQ, L[i] =<   *
+ * V[i] if K[i] = DECISION_LE) cannot be all true. When all but one are    *
+ * true the last one is negated.                                           *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fd_Nogood(WamWord **array, WamWord *kinds, WamWord *values)
+{
+  PlLong size = (PlLong) array[0];
+  WamWord *fdv_adr;
+  WamWord *last_fdv_adr = NULL;
+  int last_kind = 0, last_value = 0;
+  int kind, value;
+  int i;
+
+  array++;
+  kinds++;
+  values++;
+  for (i = 0; i < size; i++)
+    {
+      fdv_adr = array[i];
+      kind = (int) kinds[i];
+      value = (int) values[i];
+      if (kind == DECISION_EQ)
+	{
+	  if (!Pl_Range_Test_Value(Range(fdv_adr), value))
+	    return TRUE;	/* false decision: entailed */
+	  if (Fd_Variable_Is_Ground(fdv_adr))
+	    continue;		/* true decision */
+	}
+      else
+	{
+	  if (Min(fdv_adr) > value)
+	    return TRUE;
+	  if (Max(fdv_adr) <= value)
+	    continue;
+	}
+
+      if (last_fdv_adr != NULL)	/* 2 undecided decisions */
+	return TRUE;
+
+      last_fdv_adr = fdv_adr;
+      last_kind = kind;
+      last_value = value;
+    }
+
+  if (last_fdv_adr == NULL)	/* all decisions are true */
+    return FALSE;
+
+  if (last_kind == DECISION_EQ)
+    return Pl_Fd_Tell_Not_Value(last_fdv_adr, last_value);
+
+  return Pl_Fd_Tell_Interval(last_fdv_adr, last_value + 1, INTERVAL_MAX_INTEGER);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_FD_SEL_ARRAY_FROM_LIST_2                                             *
  *                                                                         *
@@ -477,10 +872,11 @@ Pl_Fd_Sel_Array_From_List_2(WamWord list_word, WamWord sel_array_word)
   WamWord *save_array;
 
 
-  array = CS;
+  array = CS + SEL_ARRAY_INFO_SIZE;
 
   save_list_word = list_word;
   save_array = array;
+  Last_Pick_Fdv(save_array) = NULL;
 
   array++;			/* +1 for the nb of elems */
 
@@ -546,6 +942,9 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
   WamWord *fdv_adr;
   WamWord **res_elem = NULL;
   Bool reorder;
+  int method;
+  WamWord *sel_array;
+  double space = 0.0;		/* init for the compiler */
 
 #ifdef PACK_ARRAY
   WamWord **q;
@@ -558,12 +957,16 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
   if (n == 0)
     return FALSE;
 
+  sel_array = (WamWord *) array;
   array++;
   end = array + n;
 
   reorder = (Bool) Pl_Rd_Integer_Check(reorder_word);
 
-  switch (Pl_Rd_Integer_Check(method_word))
+  pl_fd_nb_decision++;
+  score_fdv_adr = NULL;
+
+  switch (method = Pl_Rd_Integer_Check(method_word))
     {
     case METHOD_FIRST_FAIL:
       cmp_meth = Cmp_First_Fail;
@@ -585,6 +988,19 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
       cmp_meth = Cmp_Max_Regret;
       break;
 
+    case METHOD_DOM_WDEG:
+      cmp_meth = Cmp_Dom_Wdeg;
+      break;
+
+    case METHOD_ACTIVITY:
+      cmp_meth = Cmp_Activity;
+      break;
+
+    case METHOD_IMPACT:
+      space = Update_Impact(sel_array, array, end);
+      cmp_meth = Cmp_Impact;
+      break;
+
     case METHOD_RANDOM:
       for (;;)
 	{
@@ -636,6 +1052,16 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
   if (res_elem == NULL)
     return FALSE;
 
+  fdv_adr = *res_elem;		/* before packing (which moves the elements) */
+
+  if (method == METHOD_IMPACT)
+    {
+      Last_Pick_Fdv(sel_array) = fdv_adr;
+      Last_Pick_Size(sel_array) = Nb_Elem(fdv_adr);
+      Last_Pick_Stamp(sel_array) = STAMP;
+      Last_Pick_Space(sel_array) = (float) space;
+    }
+
 #ifdef PACK_ARRAY
   if (n > 50 && nb_ground >= n / 2)
     {
@@ -644,8 +1070,7 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
       array[-1] = (WamWord *) n;
       for (p = q = array; n; p++)
 	{
-	  fdv_adr = *p;
-	  if (!Fd_Variable_Is_Ground(fdv_adr))
+	  if (!Fd_Variable_Is_Ground(*p))
 	    {
 	      *q++ = *p;
 	      n--;
@@ -654,8 +1079,6 @@ Pl_Fd_Sel_Array_Pick_Var_4(WamWord sel_array_word, WamWord method_word,
     }
 #endif
 
-  fdv_adr = *res_elem;
-
 finish:
   return Pl_Unify(Tag_REF(fdv_adr), fdv_word);
 }
@@ -747,3 +1170,145 @@ Cmp_Max_Regret(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
   return n_diff > l_diff ||
     (n_diff == l_diff && Nb_Cstr(new_fdv_adr) > Nb_Cstr(last_fdv_adr));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CMP_DOM_WDEG                                                            *
+ *                                                                         *
+ * Selects the var with the smallest ratio domain size / weighted degree.  *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cmp_Dom_Wdeg(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
+{
+  return Cmp_Score(last_fdv_adr, new_fdv_adr, Score_Dom_Wdeg);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CMP_ACTIVITY                                                            *
+ *                                                                         *
+ * Selects the var with the largest ratio activity / domain size.          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cmp_Activity(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
+{
+  return Cmp_Score(last_fdv_adr, new_fdv_adr, Score_Activity);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CMP_IMPACT                                                              *
+ *                                                                         *
+ * Selects the var whose labeling should leave the smallest search space,  *
+ * i.e. the smallest domain size * (1 - impact).                           *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cmp_Impact(WamWord *last_fdv_adr, WamWord *new_fdv_adr)
+{
+  double l_space = Nb_Elem(last_fdv_adr) * (1.0 - Impact(last_fdv_adr));
+  double n_space = Nb_Elem(new_fdv_adr) * (1.0 - Impact(new_fdv_adr));
+
+  return n_space < l_space;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CMP_SCORE                                                               *
+ *                                                                         *
+ * Compares the scores of 2 vars (the best one has the largest score).     *
+ * The score of the last best var is cached (reset at each selection).     *
+ *-------------------------------------------------------------------------*/
+static Bool
+Cmp_Score(WamWord *last_fdv_adr, WamWord *new_fdv_adr,
+	  double (*score_fct) (WamWord *fdv_adr))
+{
+  double n_score = (*score_fct) (new_fdv_adr);
+
+  if (score_fdv_adr != last_fdv_adr)
+    {
+      score_fdv_adr = last_fdv_adr;
+      score_value = (*score_fct) (last_fdv_adr);
+    }
+
+  if (n_score <= score_value)
+    return FALSE;
+
+  score_fdv_adr = new_fdv_adr;
+  score_value = n_score;
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCORE_DOM_WDEG                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static double
+Score_Dom_Wdeg(WamWord *fdv_adr)
+{
+  return (double) Pl_Fd_Weighted_Degree(fdv_adr) / (double) Nb_Elem(fdv_adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCORE_ACTIVITY                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static double
+Score_Activity(WamWord *fdv_adr)
+{
+  return Pl_Fd_Activity(fdv_adr) / (double) Nb_Elem(fdv_adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UPDATE_IMPACT                                                           *
+ *                                                                         *
+ * Computes the (log of the) size of the search space of the selection     *
+ * array. If the previous selection (on this array) has been followed by   *
+ * its labeling (i.e. no backtracking since) its impact is updated:        *
+ * impact = 1 - space after / space before (0: no pruning at all), where   *
+ * the space only counts the other vars (the reduction of the labeled var  *
+ * itself is already accounted for by its domain size in Cmp_Impact).      *
+ * The impact of a var is an exponential moving average of its impacts.    *
+ *-------------------------------------------------------------------------*/
+static double
+Update_Impact(WamWord *sel_array, WamWord **array, WamWord **end)
+{
+  WamWord **p;
+  WamWord *fdv_adr;
+  double space = 0.0;
+  double impact;
+
+  for (p = array; p < end; p++)
+    if (!Fd_Variable_Is_Ground(*p))
+      space += log((double) Nb_Elem(*p));
+
+  fdv_adr = Last_Pick_Fdv(sel_array);
+  if (fdv_adr != NULL && STAMP > Last_Pick_Stamp(sel_array) &&
+      Nb_Elem(fdv_adr) < Last_Pick_Size(sel_array))
+    {
+      impact = 1.0 - exp((space - log((double) Nb_Elem(fdv_adr))) -
+			 (Last_Pick_Space(sel_array) -
+			  log((double) Last_Pick_Size(sel_array))));
+      Impact(fdv_adr) += (float) ((impact - Impact(fdv_adr)) * IMPACT_RATE);
+    }
+
+  Last_Pick_Fdv(sel_array) = NULL;
+
+  return space;
+}
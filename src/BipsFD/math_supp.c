@@ -149,15 +149,15 @@ NonLin;
 static WamWord arith_tbl[NB_OF_OP];
 
 
-static NonLin delay_cstr_stack[DELAY_CSTR_STACK_SIZE];
-static NonLin *delay_sp;
+static PL_THREAD_LOCAL NonLin *delay_cstr_stack;
+static PL_THREAD_LOCAL NonLin *delay_sp;
 
 
-static WamWord vars_tbl[VARS_STACK_SIZE];
-static WamWord *vars_sp;
+static PL_THREAD_LOCAL WamWord *vars_tbl;
+static PL_THREAD_LOCAL WamWord *vars_sp;
 
 
-static Bool sort;
+static PL_THREAD_LOCAL Bool sort;
 
 
 
@@ -218,6 +218,9 @@ void Pl_Write_1(WamWord term_word);
 static void
 Math_Supp_Initializer(void)
 {
+  Pl_Engine_Add_Buffer(&delay_cstr_stack, DELAY_CSTR_STACK_SIZE * sizeof(NonLin));
+  Pl_Engine_Add_Buffer(&vars_tbl, VARS_STACK_SIZE * sizeof(WamWord));
+
   arith_tbl[PLUS_1] = Functor_Arity(ATOM_CHAR('+'), 1);
   arith_tbl[PLUS_2] = Functor_Arity(ATOM_CHAR('+'), 2);
   arith_tbl[MINUS_1] = Functor_Arity(ATOM_CHAR('-'), 1);
@@ -65,7 +65,7 @@
 
 #ifdef MATH_SUPP_FILE
 
-Bool pl_full_ac;
+PL_THREAD_LOCAL Bool pl_full_ac;
 
 #ifdef DEBUG
 char *cur_op;
@@ -77,7 +77,7 @@ char *cur_op;
 char *cur_op;
 #endif
 
-extern Bool pl_full_ac;
+extern PL_THREAD_LOCAL Bool pl_full_ac;
 
 #endif
 
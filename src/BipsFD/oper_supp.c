@@ -338,7 +338,7 @@ Pl_Find_Expon_Exact(unsigned x, unsigned y)
 static unsigned
 Find_Expon_General(unsigned x, unsigned y, unsigned *pxn)
 {
-  static unsigned txp[sizeof(unsigned) * 8];
+  unsigned txp[sizeof(unsigned) * 8];
   unsigned *p = txp;
   unsigned xp;
   unsigned prod;
@@ -418,7 +418,7 @@ Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n)
     {
       y->extra_cstr = n->extra_cstr;
 
-      VECTOR_BEGIN_ENUM(n->vec, vec_elem);
+      RANGE_BEGIN_ENUM(n, vec_elem);
 
       an = Pl_Power(a, vec_elem);
       if (an > (unsigned) pl_vec_max_integer)
@@ -426,7 +426,7 @@ Pl_Full_Coeff_Power_Var(Range *y, int a, Range *n)
 
       Vector_Set_Value(y->vec, an);
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
 end_loop:
 
@@ -471,7 +471,7 @@ Pl_Full_Find_Expon(Range *n, int a, Range *y)
     }
   else				/* Y is Sparse */
     {
-      VECTOR_BEGIN_ENUM(y->vec, vec_elem);
+      RANGE_BEGIN_ENUM(y, vec_elem);
 
       e = Pl_Find_Expon_Exact(a, vec_elem);
 
@@ -483,7 +483,7 @@ Pl_Full_Find_Expon(Range *n, int a, Range *y)
 	  Vector_Set_Value(n->vec, e);
 	}
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
 
   n->min = min;
@@ -532,7 +532,7 @@ Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a)
     {
       y->extra_cstr = x->extra_cstr;
 
-      VECTOR_BEGIN_ENUM(x->vec, vec_elem);
+      RANGE_BEGIN_ENUM(x, vec_elem);
 
       xa = Pl_Power(vec_elem, a);
       if (xa > (unsigned) pl_vec_max_integer)
@@ -540,7 +540,7 @@ Pl_Full_Var_Power_Coeff(Range *y, Range *x, int a)
 
       Vector_Set_Value(y->vec, xa);
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
 end_loop:
 
@@ -557,14 +557,14 @@ end_loop:
 void
 Pl_Full_Nth_Root(Range *x, Range *y, int a)
 {
-  int e = 0, min;		/* init for the compiler */
+  int e, min, max;
   int i, vec_elem;
 
   Vector_Allocate(x->vec);
   Pl_Vector_Empty(x->vec);
   x->extra_cstr = y->extra_cstr;
 
-  min = -1;
+  min = max = -1;
 
 
   if (Is_Interval(y))		/* Y is Interval */
@@ -573,34 +573,49 @@ Pl_Full_Nth_Root(Range *x, Range *y, int a)
 	{
 	  e = Pl_Nth_Root_Exact(i, a);
 
+	  if (e > pl_vec_max_integer)	/* roots increase with Y */
+	    {
+	      x->extra_cstr = TRUE;
+	      goto end_loop;
+	    }
+
 	  if (e >= 0)
 	    {
 	      if (min < 0)
 		min = e;
 
 	      Vector_Set_Value(x->vec, e);
+	      max = e;
 	    }
 	}
     }
   else				/* Y is Sparse */
     {
-      VECTOR_BEGIN_ENUM(y->vec, vec_elem);
+      RANGE_BEGIN_ENUM(y, vec_elem);
 
       e = Pl_Nth_Root_Exact(vec_elem, a);
 
+      if (e > pl_vec_max_integer)	/* roots increase with Y */
+	{
+	  x->extra_cstr = TRUE;
+	  goto end_loop;
+	}
+
       if (e >= 0)
 	{
 	  if (min < 0)
 	    min = e;
 
 	  Vector_Set_Value(x->vec, e);
+	  max = e;
 	}
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
+end_loop:
 
   x->min = min;
-  x->max = e;
+  x->max = max;
 }
 
 
@@ -645,7 +660,7 @@ Pl_Full_Var_Power_2(Range *y, Range *x)
     {
       y->extra_cstr = x->extra_cstr;
 
-      VECTOR_BEGIN_ENUM(x->vec, vec_elem);
+      RANGE_BEGIN_ENUM(x, vec_elem);
 
       x2 = vec_elem * vec_elem;
       if (x2 > (unsigned) pl_vec_max_integer)
@@ -653,7 +668,7 @@ Pl_Full_Var_Power_2(Range *y, Range *x)
 
       Vector_Set_Value(y->vec, x2);
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
 end_loop:
 
@@ -670,14 +685,14 @@ end_loop:
 void
 Pl_Full_Sqrt_Var(Range *x, Range *y)
 {
-  int e = 0, min;		/* init for the compiler */
+  int e, min, max;
   int i, vec_elem;
 
   Vector_Allocate(x->vec);
   Pl_Vector_Empty(x->vec);
   x->extra_cstr = y->extra_cstr;
 
-  min = -1;
+  min = max = -1;
 
 
   if (Is_Interval(y))		/* Y is Interval */
@@ -686,34 +701,49 @@ Pl_Full_Sqrt_Var(Range *x, Range *y)
 	{
 	  e = Pl_Sqrt_Exact(i);
 
+	  if (e > pl_vec_max_integer)	/* roots increase with Y */
+	    {
+	      x->extra_cstr = TRUE;
+	      goto end_loop;
+	    }
+
 	  if (e >= 0)
 	    {
 	      if (min < 0)
 		min = e;
 
 	      Vector_Set_Value(x->vec, e);
+	      max = e;
 	    }
 	}
     }
   else				/* Y is Sparse */
     {
-      VECTOR_BEGIN_ENUM(y->vec, vec_elem);
+      RANGE_BEGIN_ENUM(y, vec_elem);
 
       e = Pl_Sqrt_Exact(vec_elem);
 
+      if (e > pl_vec_max_integer)	/* roots increase with Y */
+	{
+	  x->extra_cstr = TRUE;
+	  goto end_loop;
+	}
+
       if (e >= 0)
 	{
 	  if (min < 0)
 	    min = e;
 
 	  Vector_Set_Value(x->vec, e);
+	  max = e;
 	}
 
-      VECTOR_END_ENUM;
+      RANGE_END_ENUM;
     }
+end_loop:
 
   x->min = min;
-  x->max = e;
+  x->max = max;
 }
 
 
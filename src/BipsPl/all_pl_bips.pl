@@ -46,6 +46,7 @@
 	'$use_arith_inl',
 	'$use_assert',
 	'$use_all_solut',
+	'$use_table',
 	'$use_sort',
 	'$use_list',
 	'$use_stream',
@@ -60,6 +60,58 @@ findall(Template, Generator, Instances, Tail) :-
 
 
 
+:- meta_predicate(aggregate_all(?, 0, -)).
+
+aggregate_all(Spec, Goal, Result) :-
+	set_bip_name(aggregate_all, 3),
+	'$aggregate_all'(Spec, Goal, Result).
+
+
+'$aggregate_all'(Spec, _, _) :-
+	var(Spec), !,
+	'$pl_err_instantiation'.
+
+'$aggregate_all'(count, Goal, Count) :-
+	!,
+	'$fold_solutions'(count, _, Goal, Count, aggregate_all, 3).
+
+'$aggregate_all'(sum(Expr), Goal, Sum) :-
+	!,
+	'$fold_solutions'(sum, Expr, Goal, Sum, aggregate_all, 3).
+
+'$aggregate_all'(max(Expr), Goal, Max) :-
+	!,
+	'$fold_solutions'(max, Expr, Goal, Max, aggregate_all, 3).
+
+'$aggregate_all'(min(Expr), Goal, Min) :-
+	!,
+	'$fold_solutions'(min, Expr, Goal, Min, aggregate_all, 3).
+
+'$aggregate_all'(max(Expr, Witness), Goal, Result) :-
+	!,
+	'$fold_solutions'(max_witness, Expr - Witness, Goal, Max - Witness1, aggregate_all, 3),
+	Result = max(Max, Witness1).
+
+'$aggregate_all'(min(Expr, Witness), Goal, Result) :-
+	!,
+	'$fold_solutions'(min_witness, Expr - Witness, Goal, Min - Witness1, aggregate_all, 3),
+	Result = min(Min, Witness1).
+
+'$aggregate_all'(bag(Template), Goal, Bag) :-
+	!,
+	'$findall'(Template, Goal, Bag, [], aggregate_all, 3).
+
+'$aggregate_all'(set(Template), Goal, Set) :-
+	!,
+	'$findall'(Template, Goal, Bag, [], aggregate_all, 3),
+	sort(Bag, Set).
+
+'$aggregate_all'(Spec, _, _) :-
+	'$pl_err_domain'(aggregate_spec, Spec).
+
+
+
+
 :- meta_predicate(setof(?, 0, -)).
 
 setof(Template, Goal, Instances) :-
@@ -111,6 +163,19 @@ bagof(Template, Generator, Instances) :-
 
 
 
+'$fold_solutions'(Op, Template, Generator, Result, Func, Arity) :-
+	'$call_c'('Pl_Fold_Start_2'(Op, Acc)),
+	(   '$call'(Generator, Func, Arity, true),
+	    set_bip_name(Func, Arity),  % for arithmetic errors in C function
+	    '$call_c'('Pl_Fold_Solution_2'(Acc, Template)),
+	    fail
+	;   true
+	),
+	'$call_c_test'('Pl_Fold_Result_2'(Acc, Result)).
+
+
+
+
 '$group_solutions'(AllInstances1, Key, Instances) :-
 	'$call_c_test'('Pl_Group_Solutions_3'(AllInstances1, Key, Instances)).
 
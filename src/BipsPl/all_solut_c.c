@@ -36,6 +36,7 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <string.h>
 #include <sys/types.h>
 
 #define OBJ_INIT All_Solut_Initializer
@@ -55,20 +56,48 @@
  * Constants                       *
  *---------------------------------*/
 
+#define SOL_BLOCK_SIZE             16384	/* in WamWords */
+#define SOL_BLOCK_MAX_SIZE         (1024 * 1024)
+
+#define FOLD_COUNT                 0
+#define FOLD_SUM                   1
+#define FOLD_MAX                   2
+#define FOLD_MIN                   3
+#define FOLD_MAX_WITNESS           4
+#define FOLD_MIN_WITNESS           5
+#define NB_FOLD                    6
+
+
+
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
 
-typedef struct onesol *OneSolP;
+typedef struct solblock *SolBlockP;
 
-typedef struct onesol
+typedef struct solblock		/* a block of stored solutions */
 {
-  OneSolP prev;
-  int sol_no;
-  int term_size;
-  WamWord term_word;
+  SolBlockP prev;
+  WamWord *top;			/* first free word */
+  WamWord *end;			/* end of the block */
+  WamWord data[1];		/* solutions: term words + term size */
 }
-OneSol;
+SolBlock;
+
+
+typedef struct			/* accumulator of a folding collector */
+{
+  int op;			/* FOLD_XXX */
+  PlLong nb_sol;
+  Bool is_int;			/* type of the value (if nb_sol > 0) */
+  PlLong int_val;
+  double flt_val;
+  WamWord *witness;		/* copy of the witness (FOLD_XXX_WITNESS) */
+  int witness_size;
+  int witness_max_size;		/* size of the witness buffer */
+}
+FoldAcc;
 
 
 
@@ -79,21 +108,28 @@ OneSol;
 
 static WamWord exist_2;
 
-static WamWord new_gen_word;
+static int atom_fold[NB_FOLD];		/* indexed by FOLD_XXX */
+
+static PL_THREAD_LOCAL WamWord new_gen_word;
 
 
 
-static PlLong *bound_var_ptr;
-static WamWord *free_var_base;
+static PL_THREAD_LOCAL PlLong *bound_var_ptr;
+static PL_THREAD_LOCAL WamWord *free_var_base;
 
 
 
-static OneSol dummy = { NULL, 0, 0 };
-static OneSol *sol = &dummy;
+static PL_THREAD_LOCAL SolBlock *sol_blk = NULL;	/* current block (last solutions) */
+static PL_THREAD_LOCAL SolBlock *spare_blk = NULL;	/* a free block kept for reuse */
+static PL_THREAD_LOCAL PlLong nb_sol_stored = 0;
 
-static PlLong *key_var_ptr;
-static PlLong *save_key_var_ptr;
-static PlLong *next_key_var_ptr;
+static PL_THREAD_LOCAL FoldAcc *fold_acc = NULL;	/* stack of fold accumulators */
+static PL_THREAD_LOCAL int fold_top = 0;
+static PL_THREAD_LOCAL int fold_max = 0;
+
+static PL_THREAD_LOCAL PlLong *key_var_ptr;
+static PL_THREAD_LOCAL PlLong *save_key_var_ptr;
+static PL_THREAD_LOCAL PlLong *next_key_var_ptr;
 
 
 
@@ -120,6 +156,18 @@ static WamWord Group(WamWord all_sol_word, WamWord gl_key_word, WamWord *key_adr
 
 
 
+static void New_Sol_Block(int min_size);
+
+static void Release_Sol_Block(void);
+
+static WamWord Fold_Acc_Value(FoldAcc *acc);
+
+
+
+static void Atom_GC_Roots(void);
+
+
+
 #define GROUP_SOLUTIONS_ALT       X1_2467726F75705F736F6C7574696F6E735F616C74
 
 Prolog_Prototype(GROUP_SOLUTIONS_ALT, 0);
@@ -135,6 +183,49 @@ static void
 All_Solut_Initializer(void)
 {
   exist_2 = Functor_Arity(ATOM_CHAR('^'), 2);
+
+  atom_fold[FOLD_COUNT] = Pl_Create_Atom("count");
+  atom_fold[FOLD_SUM] = Pl_Create_Atom("sum");
+  atom_fold[FOLD_MAX] = Pl_Create_Atom("max");
+  atom_fold[FOLD_MIN] = Pl_Create_Atom("min");
+  atom_fold[FOLD_MAX_WITNESS] = Pl_Create_Atom("max_witness");
+  atom_fold[FOLD_MIN_WITNESS] = Pl_Create_Atom("min_witness");
+
+  Pl_Engine_Add_Context(&sol_blk, sizeof(sol_blk));
+  Pl_Engine_Add_Context(&spare_blk, sizeof(spare_blk));
+  Pl_Engine_Add_Context(&nb_sol_stored, sizeof(nb_sol_stored));
+  Pl_Engine_Add_Context(&fold_acc, sizeof(fold_acc));
+  Pl_Engine_Add_Context(&fold_top, sizeof(fold_top));
+  Pl_Engine_Add_Context(&fold_max, sizeof(fold_max));
+  Pl_Atom_GC_Add_Engine_Root_Fct(Atom_GC_Roots);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_ROOTS                                                           *
+ *                                                                         *
+ * Mark the atoms of the solutions stored by findall/bagof/setof.          *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Roots(void)
+{
+  SolBlock *b;
+  WamWord *p;
+  int size;
+  int i;
+
+  for (b = sol_blk; b; b = b->prev)
+    for (p = b->top; p > b->data; p -= size + 1)
+      {
+	size = (int) p[-1];
+	Pl_Atom_GC_Mark_Words(p - 1 - size, size);
+      }
+
+  for (i = 0; i < fold_top; i++)
+    if (fold_acc[i].op >= FOLD_MAX_WITNESS && fold_acc[i].nb_sol > 0)
+      Pl_Atom_GC_Mark_Words(fold_acc[i].witness, fold_acc[i].witness_size);
 }
 
 
@@ -292,9 +383,11 @@ Free_Var(WamWord *adr, WamWord var_word)
 
 /*-------------------------------------------------------------------------*
  * This part saves and restores all solutions found. A stack of solutions  *
- * is used (each solution is copied to a Mallocated memory area). To handle*
- * nested findall and al, each solution receive a sequential number. At the*
- * start, the number of the solution on the top of the stack serves as a   *
+ * is used. To avoid a Malloc/Free per solution, solutions are copied one  *
+ * after the other in large blocks (each solution is followed by its size  *
+ * so that the stack can be popped). A block is released (or kept as spare *
+ * block) once all its solutions have been recovered. To handle nested     *
+ * findall and al, the number of stored solutions at the start serves as a *
  * stop mark.                                                              *
  *                                                                         *
  * Recovering the solutions: a space for the list of (nb_sol) solutions is *
@@ -346,7 +439,7 @@ Free_Var(WamWord *adr, WamWord var_word)
 void
 Pl_Stop_Mark_1(WamWord stop_word)
 {
-  Pl_Get_Integer(sol->sol_no, stop_word);
+  Pl_Get_Integer(nb_sol_stored, stop_word);
 }
 
 
@@ -359,23 +452,84 @@ Pl_Stop_Mark_1(WamWord stop_word)
 void
 Pl_Store_Solution_1(WamWord term_word)
 {
-  OneSol *s;
   int size;
 /* fix_bug is because when gcc sees &xxx where xxx is a fct argument variable
  * it allocates a frame even with -fomit-frame-pointer.
  * This corrupts ebp on ix86 */
-  static WamWord fix_bug;
+  static PL_THREAD_LOCAL WamWord fix_bug;
 
   size = Pl_Term_Size(term_word);
 
-  s = (OneSol *) Malloc(sizeof(OneSol) - sizeof(WamWord) +
-			size * sizeof(WamWord));
-  s->prev = sol;
-  s->sol_no = sol->sol_no + 1;
-  s->term_size = size;
+  if (sol_blk == NULL || sol_blk->end - sol_blk->top < size + 1)
+    New_Sol_Block(size + 1);
+
   fix_bug = term_word;
-  Pl_Copy_Term(&s->term_word, &fix_bug);
-  sol = s;
+  Pl_Copy_Term(sol_blk->top, &fix_bug);
+  sol_blk->top += size;
+  *sol_blk->top++ = size;
+  nb_sol_stored++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEW_SOL_BLOCK                                                           *
+ *                                                                         *
+ * Pushes a new block with room for at least min_size words. The size of  *
+ * the blocks doubles (up to a limit) to handle big collections with few   *
+ * blocks while keeping a small footprint for the common small ones.       *
+ *-------------------------------------------------------------------------*/
+static void
+New_Sol_Block(int min_size)
+{
+  SolBlock *b;
+  PlLong size;
+
+  size = (sol_blk == NULL) ? SOL_BLOCK_SIZE : 2 * (sol_blk->end - sol_blk->data);
+  if (size > SOL_BLOCK_MAX_SIZE)
+    size = SOL_BLOCK_MAX_SIZE;
+  if (size < min_size)
+    size = min_size;
+
+  b = spare_blk;
+  if (b != NULL && b->end - b->data >= size)
+    spare_blk = NULL;
+  else
+    {
+      b = (SolBlock *) Malloc(sizeof(SolBlock) + (size - 1) * sizeof(WamWord));
+      b->end = b->data + size;
+    }
+
+  b->prev = sol_blk;
+  b->top = b->data;
+  sol_blk = b;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELEASE_SOL_BLOCK                                                       *
+ *                                                                         *
+ * Pops the current (empty) block. The biggest free block is kept.         *
+ *-------------------------------------------------------------------------*/
+static void
+Release_Sol_Block(void)
+{
+  SolBlock *b = sol_blk;
+
+  sol_blk = b->prev;
+
+  if (spare_blk == NULL)
+    spare_blk = b;
+  else if (spare_blk->end - spare_blk->data < b->end - b->data)
+    {
+      Free(spare_blk);
+      spare_blk = b;
+    }
+  else
+    Free(b);
 }
 
 
@@ -389,14 +543,14 @@ Bool
 Pl_Recover_Solutions_4(WamWord stop_word, WamWord handle_key_word,
 		       WamWord list_word, WamWord tail_word)
 {
-  int stop;
-  int nb_sol;
-  WamWord *p, *q;
-  OneSol *s;
+  PlLong stop;
+  PlLong nb_sol;
+  WamWord *p, *q, *term;
+  int size;
   Bool handle_key;
 
-  stop = Pl_Rd_C_Int(stop_word);
-  nb_sol = sol->sol_no - stop;
+  stop = Pl_Rd_Integer(stop_word);
+  nb_sol = nb_sol_stored - stop;
 
   if (nb_sol == 0)
     return Pl_Unify(list_word, tail_word);
@@ -410,29 +564,38 @@ Pl_Recover_Solutions_4(WamWord stop_word, WamWord handle_key_word,
   /* Since we start from the end to the beginning, if nb_sol is very big
    * when the heap overflow triggers a SIGSEGV the handler will not detect
    * that the heap is the culprit (and emits a simple Segmentation Violation
-   * message). To avoid this we remain just after the end of the stack.
+   * message). To avoid this we remain just after the end of the stack
+   * (i.e. of the area the stack can grow into).
    */
-  if (H > Global_Stack + Global_Size)
-    H =  Global_Stack + Global_Size;
+  if (H > Global_Stack + Global_Max_Size)
+    H =  Global_Stack + Global_Max_Size;
 
   p = q = H;
 
+  nb_sol_stored = stop;
   while (nb_sol--)
     {
+      while (sol_blk->top == sol_blk->data)
+	Release_Sol_Block();
+
+      size = (int) sol_blk->top[-1];
+      term = sol_blk->top - 1 - size;
+
       p--;
       *p = Tag_LST(p + 1);
       *--p = Tag_REF(H);
-      Pl_Copy_Contiguous_Term(H, &sol->term_word);
+      Pl_Copy_Contiguous_Term(H, term);
 
       if (handle_key)
 	Handle_Key_Variables(*H);
 
-      H += sol->term_size;
-      s = sol;
-      sol = sol->prev;
-      Free(s);
+      H += size;
+      sol_blk->top = term;
     }
 
+  if (sol_blk->top == sol_blk->data)
+    Release_Sol_Block();
+
   q[-1] = tail_word;
   return Pl_Unify(Tag_LST(p), list_word);
 }
@@ -608,3 +771,191 @@ Group(WamWord all_sol_word, WamWord gl_key_word, WamWord *key_adr)
 
   return all_sol_word;
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * This part folds the solutions as they are found instead of storing them *
+ * (count, sum, max, min of an evaluated expression). Each fold uses an    *
+ * accumulator on a stack (to handle nested folds) which only records the  *
+ * number of solutions and the current value (as a C integer or double     *
+ * since the heap is restored at each backtracking). Thus it uses a        *
+ * constant memory whatever the number of solutions is.                    *
+ * The max/min_witness variants (the solution is a term Value-Witness)     *
+ * also keep a copy of the witness of the best value (in a buffer which is *
+ * reused).                                                                *
+ * The index of the accumulator is passed to Prolog and back. Popping the  *
+ * accumulator at the end also removes those left by an exception raised   *
+ * inside a nested fold.                                                   *
+ *-------------------------------------------------------------------------*/
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FOLD_START_2                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fold_Start_2(WamWord op_word, WamWord acc_word)
+{
+  int atom = Pl_Rd_Atom(op_word);
+  FoldAcc *acc;
+  int op;
+
+  for (op = FOLD_COUNT; op < NB_FOLD - 1 && atom_fold[op] != atom; op++)
+    ;
+
+  if (fold_top == fold_max)
+    {
+      fold_max = (fold_max == 0) ? 16 : fold_max * 2;
+      fold_acc = (FoldAcc *) Realloc(fold_acc, fold_max * sizeof(FoldAcc));
+      memset(fold_acc + fold_top, 0, (fold_max - fold_top) * sizeof(FoldAcc));
+    }
+
+  acc = fold_acc + fold_top;
+  acc->op = op;
+  acc->nb_sol = 0;
+
+  Pl_Get_Integer(fold_top++, acc_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FOLD_SOLUTION_2                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Fold_Solution_2(WamWord acc_word, WamWord value_word)
+{
+  FoldAcc *acc = fold_acc + Pl_Rd_C_Int(acc_word);
+  WamWord word, tag_mask;
+  WamWord witness_word;
+  WamWord *adr;
+  int size;
+/* see Pl_Store_Solution_1 for fix_bug */
+  static PL_THREAD_LOCAL WamWord fix_bug;
+
+  if (acc->op == FOLD_COUNT)
+    {
+      acc->nb_sol++;
+      return;
+    }
+
+  if (acc->op >= FOLD_MAX_WITNESS)	/* value_word is Value-Witness */
+    {
+      DEREF(value_word, word, tag_mask);
+      adr = UnTag_STC(word);
+      Pl_Math_Load_Value(Arg(adr, 0), &word);
+
+      if (acc->nb_sol > 0 &&
+	  !((acc->op == FOLD_MAX_WITNESS) ? Pl_Blt_Gt(word, Fold_Acc_Value(acc))
+	    : Pl_Blt_Lt(word, Fold_Acc_Value(acc))))
+	{
+	  acc->nb_sol++;	/* keep the first best solution */
+	  return;
+	}
+
+      witness_word = Arg(adr, 1);
+      size = Pl_Term_Size(witness_word);
+      if (size > acc->witness_max_size)
+	{
+	  acc->witness_max_size = size;
+	  acc->witness = (WamWord *) Realloc(acc->witness, size * sizeof(WamWord));
+	}
+      acc->witness_size = size;
+      fix_bug = witness_word;
+      Pl_Copy_Term(acc->witness, &fix_bug);
+    }
+  else
+    {
+      Pl_Math_Load_Value(value_word, &word);
+
+      if (acc->nb_sol > 0)
+	switch (acc->op)
+	  {
+	  case FOLD_SUM:
+	    word = Pl_Fct_Add(Fold_Acc_Value(acc), word);
+	    break;
+
+	  case FOLD_MAX:
+	    word = Pl_Fct_Max(Fold_Acc_Value(acc), word);
+	    break;
+
+	  case FOLD_MIN:
+	    word = Pl_Fct_Min(Fold_Acc_Value(acc), word);
+	    break;
+	  }
+    }
+
+  acc->is_int = Tag_Is_INT(word);
+  if (acc->is_int)
+    acc->int_val = UnTag_INT(word);
+  else
+    acc->flt_val = Pl_Obtain_Float(UnTag_FLT(word));
+
+  acc->nb_sol++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FOLD_RESULT_2                                                        *
+ *                                                                         *
+ * Fails for max/min if there is no solution. For max/min_witness the      *
+ * result is Value-Witness.                                                *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Fold_Result_2(WamWord acc_word, WamWord result_word)
+{
+  int i = Pl_Rd_C_Int(acc_word);
+  FoldAcc *acc = fold_acc + i;
+  WamWord word;
+  WamWord *witness_adr, *adr;
+
+  fold_top = i;
+
+  if (acc->op == FOLD_COUNT)
+    return Pl_Un_Integer(acc->nb_sol, result_word);
+
+  if (acc->nb_sol == 0)
+    return acc->op == FOLD_SUM && Pl_Un_Integer(0, result_word);
+
+  word = Fold_Acc_Value(acc);
+  if (acc->op < FOLD_MAX_WITNESS)
+    return Pl_Unify(word, result_word);
+
+  witness_adr = H;
+  Pl_Copy_Contiguous_Term(H, acc->witness);
+  H += acc->witness_size;
+
+  adr = H;
+  *H++ = Functor_Arity(ATOM_CHAR('-'), 2);
+  *H++ = word;
+  *H++ = Tag_REF(witness_adr);
+
+  return Pl_Unify(Tag_STC(adr), result_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FOLD_ACC_VALUE                                                          *
+ *                                                                         *
+ * Returns the current value of an accumulator as a Prolog number.        *
+ *-------------------------------------------------------------------------*/
+static WamWord
+Fold_Acc_Value(FoldAcc *acc)
+{
+  WamWord word;
+
+  if (acc->is_int)
+    return Tag_INT(acc->int_val);
+
+  word = Tag_FLT(H);
+  Pl_Global_Push_Float(acc->flt_val);
+  return word;
+}
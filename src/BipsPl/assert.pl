@@ -135,6 +135,53 @@ abolish(PI) :-
 
 
 
+:- meta_predicate(dynamic_index(:)).
+
+dynamic_index(Spec) :-
+	set_bip_name(dynamic_index, 1),
+	'$check_head'(Spec),
+	Spec =.. [_|LArg],
+	'$dynamic_index_args'(LArg, LPlus),
+	length(LPlus, NbArg),
+	(   NbArg > 0,
+	    NbArg =< 8               % see DYN_JIT_MAX_ARGS in dynam_supp.h
+	->  set_bip_name(dynamic_index, 1),
+	    '$call_c'('Pl_Dynamic_Index_1'(Spec))
+	;   set_bip_name(dynamic_index, 1),
+	    '$pl_err_domain'(index_specifier, Spec)
+	).
+
+
+'$dynamic_index_args'([], []).
+
+'$dynamic_index_args'([A|LArg], LPlus) :-
+	(   var(A) ->
+	    '$pl_err_instantiation'
+	;   A == (+) ->
+	    LPlus = [A|LPlus1]
+	;   A == (-) ->
+	    LPlus = LPlus1
+	;   '$pl_err_domain'(index_specifier, A)
+	),
+	'$dynamic_index_args'(LArg, LPlus1).
+
+
+
+
+save_dynamic_db(File, Preds) :-
+	set_bip_name(save_dynamic_db, 2),
+	'$call_c_test'('Pl_Save_Dynamic_Db_2'(File, Preds)).
+
+
+
+
+load_dynamic_db(File) :-
+	set_bip_name(load_dynamic_db, 1),
+	'$call_c_test'('Pl_Load_Dynamic_Db_1'(File)).
+
+
+
+
 '$remove_predicate'(Name, Arity) :-
 	'$call_c'('Pl_Remove_Predicate_2'(Name, Arity)).
 
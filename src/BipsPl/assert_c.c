@@ -46,6 +46,8 @@
  * Constants                       *
  *---------------------------------*/
 
+#define ERR_BAD_DYN_DB_FILE        "not a dynamic database file (or incompatible)"
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
@@ -54,7 +56,7 @@
  * Global Variables                *
  *---------------------------------*/
 
-static DynCInf *last_clause;
+static PL_THREAD_LOCAL DynCInf *last_clause;
 
 
 
@@ -67,6 +69,8 @@ static PlLong Clause_Alt(DynCInf *clause, WamWord *w, Bool is_last);
 
 static PlLong Retract_Alt(DynCInf *clause, WamWord *w, Bool is_last);
 
+static char *Get_Db_Path_Name(WamWord path_name_word);
+
 
 
 
@@ -145,13 +149,10 @@ Pl_Clause_3(WamWord head_word, WamWord body_word, WamWord for_what_word)
   if (dyn == NULL)		/* no dynamic info */
     return FALSE;
 
-  if (arity > 0)
-    word = *first_arg_adr;
-
   w[0] = head_word;
   w[1] = body_word;
 
-  clause = Pl_Scan_Dynamic_Pred(-1, 0, pred->dyn, word,
+  clause = Pl_Scan_Dynamic_Pred(-1, 0, pred->dyn, first_arg_adr,
 				Clause_Alt, DYN_ALT_FCT_FOR_TEST, 2, w);
   if (clause == NULL)
     return FALSE;
@@ -231,13 +232,10 @@ Pl_Retract_2(WamWord head_word, WamWord body_word)
   if (dyn == NULL)		/* no dynamic info */
     return FALSE;
 
-  if (arity > 0)
-    word = *first_arg_adr;
-
   w[0] = head_word;
   w[1] = body_word;
 
-  clause = Pl_Scan_Dynamic_Pred(-1, 0, pred->dyn, word,
+  clause = Pl_Scan_Dynamic_Pred(-1, 0, pred->dyn, first_arg_adr,
 				Retract_Alt, DYN_ALT_FCT_FOR_TEST, 2, w);
   if (clause == NULL)
     return FALSE;
@@ -393,6 +391,47 @@ Pl_Abolish_1(WamWord pred_indic_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_DYNAMIC_INDEX_1                                                      *
+ *                                                                         *
+ * the arguments of head_word are + or - (checked by dynamic_index/1).     *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Dynamic_Index_1(WamWord head_word)
+{
+  WamWord word, tag_mask;
+  WamWord *arg_adr;
+  int func, arity;
+  PredInf *pred;
+  int arg_no[DYN_JIT_MAX_ARGS];
+  int i, nb_arg;
+
+  arg_adr = Pl_Rd_Callable_Check(head_word, &func, &arity);
+
+  if ((pred = Pl_Lookup_Pred(func, arity)) != NULL &&
+      !(pred->prop & MASK_PRED_DYNAMIC))
+    {
+      word = Pl_Put_Structure(ATOM_CHAR('/'), 2);
+      Pl_Unify_Atom(func);
+      Pl_Unify_Integer(arity);
+      Pl_Err_Permission(pl_permission_operation_modify,
+			pl_permission_type_static_procedure, word);
+    }
+
+  nb_arg = 0;
+  for (i = 0; i < arity; i++)
+    {
+      DEREF(arg_adr[i], word, tag_mask);
+      if (word == Tag_ATM(ATOM_CHAR('+')) && nb_arg < DYN_JIT_MAX_ARGS)
+	arg_no[nb_arg++] = i;
+    }
+
+  Pl_Declare_Dynamic_Index(func, arity, nb_arg, arg_no);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_REMOVE_PREDICATE_2                                                   *
  *                                                                         *
@@ -407,3 +446,127 @@ Pl_Remove_Predicate_2(WamWord name_word, WamWord arity_word)
 
   Pl_Update_Dynamic_Pred(func, arity, 2, -1);
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_SAVE_DYNAMIC_DB_2                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Save_Dynamic_Db_2(WamWord path_name_word, WamWord list_word)
+{
+  WamWord word, tag_mask;
+  WamWord save_list_word;
+  WamWord *lst_adr;
+  char *path_name;
+  int func, arity;
+  int *tfunc, *tarity;
+  int nb_pred, i;
+  PredInf *pred;
+  PlLong ret;
+
+  path_name = Get_Db_Path_Name(path_name_word);
+
+  save_list_word = list_word;	/* 1st pass: check the list */
+  nb_pred = 0;
+  for (;;)
+    {
+      DEREF(list_word, word, tag_mask);
+      if (tag_mask == TAG_REF_MASK)
+	Pl_Err_Instantiation();
+
+      if (word == NIL_WORD)
+	break;
+
+      if (tag_mask != TAG_LST_MASK)
+	Pl_Err_Type(pl_type_list, save_list_word);
+
+      lst_adr = UnTag_LST(word);
+      func = Pl_Get_Pred_Indicator(Car(lst_adr), TRUE, &arity);
+      if ((pred = Pl_Lookup_Pred(func, arity)) != NULL &&
+	  !(pred->prop & MASK_PRED_DYNAMIC))
+	Pl_Err_Permission(pl_permission_operation_access,
+			  pl_permission_type_private_procedure, Car(lst_adr));
+
+      nb_pred++;
+      list_word = Cdr(lst_adr);
+    }
+
+  tfunc = (int *) Malloc((nb_pred + 1) * sizeof(int));
+  tarity = (int *) Malloc((nb_pred + 1) * sizeof(int));
+
+  list_word = save_list_word;	/* 2nd pass: collect the predicates */
+  for (i = 0; i < nb_pred; i++)
+    {
+      DEREF(list_word, word, tag_mask);
+      lst_adr = UnTag_LST(word);
+      tfunc[i] = Pl_Get_Pred_Indicator(Car(lst_adr), TRUE, &tarity[i]);
+      list_word = Cdr(lst_adr);
+    }
+
+  ret = Pl_Save_Dynamic_Db(path_name, nb_pred, tfunc, tarity);
+
+  Free(tfunc);
+  Free(tarity);
+
+  Os_Test_Error((ret == DYN_DB_OS_ERROR) ? -1 : 0);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOAD_DYNAMIC_DB_1                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Load_Dynamic_Db_1(WamWord path_name_word)
+{
+  WamWord word;
+  char *path_name;
+  int func, arity;
+  PlLong ret;
+
+  path_name = Get_Db_Path_Name(path_name_word);
+
+  ret = Pl_Load_Dynamic_Db(path_name, &func, &arity);
+
+  if (ret == DYN_DB_BAD_FILE)
+    Pl_Err_System(Pl_Create_Atom(ERR_BAD_DYN_DB_FILE));
+
+  if (ret == DYN_DB_STATIC_PRED)
+    {
+      word = Pl_Put_Structure(ATOM_CHAR('/'), 2);
+      Pl_Unify_Atom(func);
+      Pl_Unify_Integer(arity);
+      Pl_Err_Permission(pl_permission_operation_modify,
+			pl_permission_type_static_procedure, word);
+    }
+
+  Os_Test_Error((ret == DYN_DB_OS_ERROR) ? -1 : 0);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GET_DB_PATH_NAME                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static char *
+Get_Db_Path_Name(WamWord path_name_word)
+{
+  char *path_name;
+
+  path_name = pl_atom_tbl[Pl_Rd_Atom_Check(path_name_word)].name;
+  if ((path_name = Pl_M_Absolute_Path_Name(path_name)) == NULL)
+    Pl_Err_Domain(pl_domain_os_path, path_name_word);
+
+  return path_name;
+}
@@ -64,6 +64,10 @@
 
 #define ERR_UNKNOWN_INSTRUCTION    "bc_supp: Unknown WAM instruction: %s"
 
+#define ERR_BAD_PROGRAM_FILE       "not a saved program file (or incompatible)"
+
+#define BC_LONG_WORDS              (WORD_SIZE / 32) /* words of a PlLong/ptr */
+
 
 
 
@@ -138,7 +142,18 @@ typedef enum
   CUT_Y,
 
   SOFT_CUT_X,
-  SOFT_CUT_Y
+  SOFT_CUT_Y,
+
+  /* superinstructions (created by BC_Fuse_Inst) */
+
+  GET_Y_VARIABLE_2,
+  PUT_Y_VALUE_2,
+  UNIFY_X_VARIABLE_2,
+  UNIFY_Y_VARIABLE_2,
+  UNIFY_X_VALUE_2,
+  GET_LIST_UNIFY_X_VARIABLE_2,
+  GET_LIST_UNIFY_Y_VARIABLE_2,
+  DEALLOCATE_EXECUTE
 }
 BCCodOp;
 
@@ -159,6 +174,23 @@ typedef union
     unsigned i24:24;
   }
   t2;
+  struct
+  {
+    unsigned code_op:8;
+    unsigned r1:8;
+    unsigned r2:8;
+    unsigned r3:8;
+  }
+  t3;
+  struct
+  {
+    unsigned code_op:8;
+    unsigned r1:6;
+    unsigned r2:6;
+    unsigned r3:6;
+    unsigned r4:6;
+  }
+  t4;
   unsigned word;
 }
 BCWord;
@@ -187,9 +219,11 @@ C64To32;
 static BCWord op_tbl[MAX_OP];
 static int nb_op;
 
-static BCWord *bc;
-static BCWord *bc_sp;
-static int bc_nb_block;
+static PL_THREAD_LOCAL BCWord *bc;
+static PL_THREAD_LOCAL BCWord *bc_sp;
+static PL_THREAD_LOCAL int bc_nb_block;
+static PL_THREAD_LOCAL int bc_last1;		/* offset of the last emitted inst (or -1) */
+static PL_THREAD_LOCAL int bc_last2;		/* offset of the inst before (or -1) */
 
 static int atom_dynamic;
 static int atom_public;
@@ -198,12 +232,13 @@ static int atom_built_in;
 static int atom_built_in_fd;
 static int atom_fail;
 
-static int caller_func;
-static int caller_arity;
+static PL_THREAD_LOCAL int caller_func;
+static PL_THREAD_LOCAL int caller_arity;
 
-static int glob_func;
-static DynPInf *glob_dyn;
-static Bool debug_call;
+static PL_THREAD_LOCAL int glob_func;
+static PL_THREAD_LOCAL DynPInf *glob_dyn;
+static PL_THREAD_LOCAL Bool debug_call;
+static PL_THREAD_LOCAL int nb_live_x;		/* for the GC at ALLOCATE: args + cut reg */
 
 WamCont pl_debug_call_code;	/* overwritten by debugger_c.c */
 
@@ -222,6 +257,8 @@ static int BC_Arg_X_Or_Y(WamWord arg_word, int *op);
 
 static int BC_Arg_Func_Arity(WamWord arg_word, int *arity);
 
+static Bool BC_Fuse_Inst(int *op, BCWord *w);
+
 
 
 WamCont Pl_BC_Emulate_Pred(int func, DynPInf *dyn);
@@ -230,10 +267,17 @@ static WamCont BC_Emulate_Pred_Alt(DynCInf *clause, WamWord *w, Bool is_last);
 
 static WamCont BC_Emulate_Clause(DynCInf *clause);
 
+static WamCont BC_Emulate_Fact(DynCInf *clause);
+
+static Bool Unify_Ground_In_Place(WamWord g_word, WamWord start_word);
+
 static WamCont BC_Emulate_Byte_Code(BCWord *bc);
 
 static void Prep_Debug_Call(int func, int arity, int caller_func, int caller_arity);
 
+static unsigned *BC_Relocate(unsigned *byte_code, int size, int (*map_atom) (int atom),
+			     Bool to_file, int func, int arity);
+
 
 
 #define BC_EMULATE_CONT            X1_2462635F656D756C6174655F636F6E74
@@ -263,6 +307,24 @@ Prolog_Prototype(CALL_INTERNAL_WITH_CUT, 3);
 
 #define BC2_Int(w)                 ((w).t2.i24)
 
+#define BC3_R1(w)                  ((w).t3.r1)
+
+#define BC3_R2(w)                  ((w).t3.r2)
+
+#define BC3_R3(w)                  ((w).t3.r3)
+
+#define BC4_R1(w)                  ((w).t4.r1)
+
+#define BC4_R2(w)                  ((w).t4.r2)
+
+#define BC4_R3(w)                  ((w).t4.r3)
+
+#define BC4_R4(w)                  ((w).t4.r4)
+
+#define Fit_In_6bits(n)            ((PlULong) (n) < (1 << 6))
+
+#define Fit_In_8bits(n)            ((PlULong) (n) < (1 << 8))
+
 #define Fit_In_16bits(n)           ((PlULong) (n) < (1 << 16))
 
 #define Fit_In_24bits(n)           ((PlULong) (n) < (1 << 24))
@@ -271,6 +333,31 @@ Prolog_Prototype(CALL_INTERNAL_WITH_CUT, 3);
 
 
 
+	  /* threaded code: with GCC, each instruction directly jumps to the */
+	  /* next one (labels as values) instead of going back to the switch */
+
+#if defined(__GNUC__) && !defined(NO_USE_BC_THREADED_CODE)
+#define BC_THREADED_CODE
+#endif
+
+#ifdef BC_THREADED_CODE
+
+#define BC_Label(op)               [op] = &&lbl_##op
+
+#define BC_Case(op)                case op: lbl_##op
+
+#define BC_Next                    w = *bc++; goto *bc_label[BC_Op(w)]
+
+#else
+
+#define BC_Case(op)                case op
+
+#define BC_Next                    goto bc_loop
+
+#endif
+
+
+
 
 /*-------------------------------------------------------------------------*
  * BYTE_CODE_INITIALIZER                                                   *
@@ -465,6 +552,7 @@ void
 Pl_BC_Start_Emit_0(void)
 {
   bc_sp = bc;
+  bc_last1 = bc_last2 = -1;
 }
 
 
@@ -482,7 +570,8 @@ Pl_BC_Stop_Emit_0(void)
   
   pl_byte_code_len = (int) (bc_sp - bc);
 
-  pl_byte_code = (unsigned *) Malloc(pl_byte_code_len * sizeof(BCWord));
+  pl_byte_code = (unsigned *) Malloc((pl_byte_code_len + 1) * sizeof(BCWord));
+  *pl_byte_code++ = pl_byte_code_len; /* see BC_Byte_Code_Size */
 
 #if 0
   memcpy(pl_byte_code, bc, pl_byte_code_len * sizeof(BCWord));
@@ -572,6 +661,7 @@ Pl_BC_Emit_Inst_1(WamWord inst_word)
     case GET_ATOM:
     case PUT_ATOM:
       w1 = Pl_Rd_Atom(*arg_adr++);
+      Pl_Keep_Atom(w1);		/* as for native code, atoms of byte-code are permanent */
       if (Fit_In_16bits(w1))
 	BC1_Atom(w) = w1;
       else
@@ -650,6 +740,7 @@ Pl_BC_Emit_Inst_1(WamWord inst_word)
 
     case UNIFY_ATOM:
       w1 = Pl_Rd_Atom(*arg_adr);
+      Pl_Keep_Atom(w1);
       if (Fit_In_24bits(w1))
 	BC2_Atom(w) = w1;
       else
@@ -718,6 +809,12 @@ Pl_BC_Emit_Inst_1(WamWord inst_word)
     }
 
 
+  if (BC_Fuse_Inst(&op, &w))
+    bc_last2 = -1;
+  else
+    bc_last2 = bc_last1;
+  bc_last1 = (int) (bc_sp - bc);
+
   ASSEMBLE_INST(bc_sp, op, nb_word, w, w1, w2, w3);
 
 
@@ -778,6 +875,7 @@ Pl_BC_Emit_Inst_Execute_Native(int func, int arity, PlLong *codep)
   w3 = cv.u[1];
 #endif
 
+  bc_last1 = bc_last2 = -1;
   ASSEMBLE_INST(bc_sp, EXECUTE_NATIVE, nb_word, w, w1, w2, w3);
 }
 
@@ -833,6 +931,7 @@ BC_Arg_Func_Arity(WamWord arg_word, int *arity)
 {
   WamWord word, tag_mask;
   WamWord *stc_adr;
+  int func;
 
   DEREF(arg_word, word, tag_mask);              /* functor/arity */
   stc_adr = UnTag_STC(word);
@@ -841,7 +940,95 @@ BC_Arg_Func_Arity(WamWord arg_word, int *arity)
   *arity = (int) UnTag_INT(word);
 
   DEREF(Arg(stc_adr, 0), word, tag_mask);	/* functor */
-  return UnTag_ATM(word);
+  func = UnTag_ATM(word);
+  Pl_Keep_Atom(func);
+  return func;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BC_FUSE_INST                                                            *
+ *                                                                         *
+ * Peephole optimizer: try to merge the instruction about to be emitted    *
+ * (op, w: its additional words are not yet emitted) with the last emitted *
+ * instruction(s) to form a superinstruction. The set of superinstructions *
+ * comes from a profile of the sequences executed by the classic benchs.   *
+ * On success the merged instructions are removed from the buffer and      *
+ * op/w are updated (the caller then emits the superinstruction).          *
+ *-------------------------------------------------------------------------*/
+static Bool
+BC_Fuse_Inst(int *op, BCWord *w)
+{
+  BCWord *last1, *last2;
+  BCWord w0;
+  int new_op;
+
+  if (bc_last1 < 0)
+    return FALSE;
+
+  last1 = bc + bc_last1;
+  last2 = (bc_last2 >= 0) ? bc + bc_last2 : NULL;
+  w0.word = 0;
+
+  switch (*op)
+    {
+    case GET_Y_VARIABLE:
+    case PUT_Y_VALUE:
+      if (BC_Op(*last1) != *op ||
+	  !Fit_In_6bits(BC1_X0(*last1)) || !Fit_In_6bits(BC1_XY(*last1)) ||
+	  !Fit_In_6bits(BC1_X0(*w)) || !Fit_In_6bits(BC1_XY(*w)))
+	return FALSE;
+
+      BC4_R1(w0) = BC1_X0(*last1);
+      BC4_R2(w0) = BC1_XY(*last1);
+      BC4_R3(w0) = BC1_X0(*w);
+      BC4_R4(w0) = BC1_XY(*w);
+      new_op = (*op == GET_Y_VARIABLE) ? GET_Y_VARIABLE_2 : PUT_Y_VALUE_2;
+      break;
+
+    case UNIFY_X_VARIABLE:
+    case UNIFY_Y_VARIABLE:
+    case UNIFY_X_VALUE:
+      if (BC_Op(*last1) != *op ||
+	  !Fit_In_8bits(BC2_XY(*last1)) || !Fit_In_8bits(BC2_XY(*w)))
+	return FALSE;
+
+      if (*op != UNIFY_X_VALUE && last2 && BC_Op(*last2) == GET_LIST)
+	{			/* get_list + 2 unify_variable */
+	  BC3_R1(w0) = BC1_X0(*last2);
+	  BC3_R2(w0) = BC2_XY(*last1);
+	  BC3_R3(w0) = BC2_XY(*w);
+	  new_op = (*op == UNIFY_X_VARIABLE) ? GET_LIST_UNIFY_X_VARIABLE_2 :
+	    GET_LIST_UNIFY_Y_VARIABLE_2;
+	  last1 = last2;
+	  break;
+	}
+
+      BC3_R1(w0) = BC2_XY(*last1);
+      BC3_R2(w0) = BC2_XY(*w);
+      new_op = (*op == UNIFY_X_VARIABLE) ? UNIFY_X_VARIABLE_2 :
+	(*op == UNIFY_Y_VARIABLE) ? UNIFY_Y_VARIABLE_2 : UNIFY_X_VALUE_2;
+      break;
+
+    case EXECUTE:		/* same additional words as EXECUTE */
+      if (BC_Op(*last1) != DEALLOCATE)
+	return FALSE;
+
+      w0 = *w;
+      new_op = DEALLOCATE_EXECUTE;
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  bc_sp = last1;
+  *op = new_op;
+  *w = w0;
+
+  return TRUE;
 }
 
 
@@ -916,7 +1103,7 @@ Pl_BC_Emulate_Pred(int func, DynPInf *dyn)
       A(arity) = Pl_Get_Current_Choice();	/* init cut register */
       A(arity + 1) = debug_call;
 
-      clause = Pl_Scan_Dynamic_Pred(func, arity, dyn, A(0),
+      clause = Pl_Scan_Dynamic_Pred(func, arity, dyn, &A(0),
 				    (ScanFct) BC_Emulate_Pred_Alt,
 				    DYN_ALT_FCT_FOR_JUMP, arity + 2, &A(0));
       if (clause == NULL)
@@ -979,6 +1166,7 @@ BC_Emulate_Clause(DynCInf *clause)
   int i;
 
   bc = (BCWord *) clause->byte_code;
+  nb_live_x = clause->dyn->arity + 1;
 
   /* Issue #12: infinite loop when debugger is active on Call ports for dynamic/multifile compiled code.
    * Each clause of such a predicate gives rise to both an assert (suitable for interpretation) and
@@ -986,9 +1174,17 @@ BC_Emulate_Clause(DynCInf *clause)
    * not yet used). See in .wam call_c to Pl_Emit_BC_Execute_Wrapper and Pl_BC_Emit_Inst_Execute_Native.
    * To fix the issue: either do not use BC if debug is active (use interpreted code - see below)
    * or do not call the debugger inside EXECUTE_NATIVE (and CALL_NATIVE for consistency ?)
+   * NB: debug_call is set for any call from debuggable code (e.g. the top-level) so only
+   * fall back to interpreted code if the debugger is really active.
    */
-  if (bc && !debug_call)	/* emulated code (see above for test !debug_call) */
-    return BC_Emulate_Byte_Code(bc);
+  if (!(debug_call && pl_debug_call_code != NULL))
+    {
+      if (bc)			/* emulated code (see above) */
+	return BC_Emulate_Byte_Code(bc);
+
+      if (clause->kind != DYN_CLAUSE_RULE)
+	return BC_Emulate_Fact(clause);
+    }
 				/* interpreted code */
   Pl_Copy_Clause_To_Heap(clause, &head_word, &body_word);
 
@@ -1007,6 +1203,133 @@ BC_Emulate_Clause(DynCInf *clause)
 
 
 
+/*-------------------------------------------------------------------------*
+ * BC_EMULATE_FACT                                                         *
+ *                                                                         *
+ * Execute a fact without byte-code (e.g. added by assertz/1). There is no *
+ * body to call. A ground fact is unified in place: the stored head is     *
+ * only copied to the heap if a compound argument is bound to a variable.  *
+ *-------------------------------------------------------------------------*/
+static WamCont
+BC_Emulate_Fact(DynCInf *clause)
+{
+  WamWord head_word, body_word;
+  WamWord word, tag_mask;
+  WamWord *arg_adr;
+  int func, arity;
+  int i;
+  Bool copy = FALSE;
+
+  if (clause->kind == DYN_CLAUSE_GROUND_FACT)
+    {
+      arity = clause->dyn->arity;
+      arg_adr = (arity > 0) ? &Arg(UnTag_STC(clause->head_word), 0) : NULL;
+      for (i = 0; i < arity; i++, arg_adr++)
+	{
+	  DEREF(A(i), word, tag_mask);
+	  if (tag_mask == TAG_REF_MASK && Tag_Mask_Of(*arg_adr) != TAG_ATM_MASK &&
+	      Tag_Mask_Of(*arg_adr) != TAG_INT_MASK)
+	    copy = TRUE;	/* to bind: done below with a single copy */
+	  else if (!Unify_Ground_In_Place(*arg_adr, word))
+	    return ALTB(B);	/* fail */
+	}
+
+      if (!copy)
+	return UnAdjust_CP(CP);
+    }
+
+  Pl_Copy_Clause_To_Heap(clause, &head_word, &body_word);
+
+  arg_adr = Pl_Rd_Callable_Check(head_word, &func, &arity);
+
+  for (i = 0; i < arity; i++)
+    if (!Pl_Unify(A(i), *arg_adr++))
+      return ALTB(B);		/* fail */
+
+  return UnAdjust_CP(CP);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UNIFY_GROUND_IN_PLACE                                                   *
+ *                                                                         *
+ * Unify a ground term g_word stored outside the stacks (e.g. in a clause) *
+ * with a term. No binding may point to g_word so a sub-term of g_word is  *
+ * copied to the heap when it has to be bound to a variable.               *
+ *-------------------------------------------------------------------------*/
+static Bool
+Unify_Ground_In_Place(WamWord g_word, WamWord start_word)
+{
+  WamWord word, tag_mask;
+  WamWord *adr, *g_adr;
+  int i;
+
+terminal_rec:
+
+  DEREF(start_word, word, tag_mask);
+
+  if (tag_mask == Tag_Mask_Of(g_word))
+    switch (Tag_From_Tag_Mask(tag_mask))
+      {
+      case ATM:
+      case INT:
+	return word == g_word;
+
+      case FLT:
+	return Pl_Obtain_Float(UnTag_FLT(word)) ==
+	  Pl_Obtain_Float(UnTag_FLT(g_word));
+
+      case LST:
+	adr = &Car(UnTag_LST(word));
+	g_adr = &Car(UnTag_LST(g_word));
+	if (!Unify_Ground_In_Place(*g_adr++, *adr++))
+	  return FALSE;
+
+	g_word = *g_adr;
+	start_word = *adr;
+	goto terminal_rec;
+
+      case STC:
+	adr = UnTag_STC(word);
+	g_adr = UnTag_STC(g_word);
+	if (Functor_And_Arity(adr) != Functor_And_Arity(g_adr))
+	  return FALSE;
+
+	i = Arity(adr);
+	adr = &Arg(adr, 0);
+	g_adr = &Arg(g_adr, 0);
+	while (--i)
+	  if (!Unify_Ground_In_Place(*g_adr++, *adr++))
+	    return FALSE;
+
+	g_word = *g_adr;
+	start_word = *adr;
+	goto terminal_rec;
+      }
+
+  if (tag_mask != TAG_REF_MASK
+#ifndef NO_USE_FD_SOLVER
+      && tag_mask != TAG_FDV_MASK
+#endif
+      )
+    return FALSE;
+
+  if (Tag_Mask_Of(g_word) != TAG_ATM_MASK && Tag_Mask_Of(g_word) != TAG_INT_MASK)
+    {				/* copy the compound term (or float) */
+      adr = H;
+      Pl_Copy_Term(adr, &g_word);
+      H += Pl_Term_Size(g_word);
+      g_word = *adr;
+    }
+
+  return Pl_Unify(word, g_word);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * BC_EMULATE_BYTE_CODE                                                    *
  *                                                                         *
@@ -1022,59 +1345,127 @@ BC_Emulate_Byte_Code(BCWord *bc)
   int func, arity;
   PredInf *pred;
   C64To32 cv;
+#ifdef BC_THREADED_CODE
+  static void *bc_label[] = {
+    BC_Label(GET_X_VARIABLE),
+    BC_Label(GET_Y_VARIABLE),
+    BC_Label(GET_X_VALUE),
+    BC_Label(GET_Y_VALUE),
+    BC_Label(GET_ATOM),
+    BC_Label(GET_ATOM_BIG),
+    BC_Label(GET_INTEGER),
+    BC_Label(GET_INTEGER_BIG),
+    BC_Label(GET_FLOAT),
+    BC_Label(GET_NIL),
+    BC_Label(GET_LIST),
+    BC_Label(GET_STRUCTURE),
+    BC_Label(PUT_X_VARIABLE),
+    BC_Label(PUT_Y_VARIABLE),
+    BC_Label(PUT_VOID),
+    BC_Label(PUT_X_VALUE),
+    BC_Label(PUT_Y_VALUE),
+    BC_Label(PUT_Y_UNSAFE_VALUE),
+    BC_Label(PUT_ATOM),
+    BC_Label(PUT_ATOM_BIG),
+    BC_Label(PUT_INTEGER),
+    BC_Label(PUT_INTEGER_BIG),
+    BC_Label(PUT_FLOAT),
+    BC_Label(PUT_NIL),
+    BC_Label(PUT_LIST),
+    BC_Label(PUT_STRUCTURE),
+    BC_Label(MATH_LOAD_X_VALUE),
+    BC_Label(MATH_LOAD_Y_VALUE),
+    BC_Label(UNIFY_X_VARIABLE),
+    BC_Label(UNIFY_Y_VARIABLE),
+    BC_Label(UNIFY_VOID),
+    BC_Label(UNIFY_X_VALUE),
+    BC_Label(UNIFY_Y_VALUE),
+    BC_Label(UNIFY_X_LOCAL_VALUE),
+    BC_Label(UNIFY_Y_LOCAL_VALUE),
+    BC_Label(UNIFY_ATOM),
+    BC_Label(UNIFY_ATOM_BIG),
+    BC_Label(UNIFY_INTEGER),
+    BC_Label(UNIFY_INTEGER_BIG),
+    BC_Label(UNIFY_NIL),
+    BC_Label(UNIFY_LIST),
+    BC_Label(UNIFY_STRUCTURE),
+    BC_Label(ALLOCATE),
+    BC_Label(DEALLOCATE),
+    BC_Label(CALL),
+    BC_Label(CALL_NATIVE),
+    BC_Label(EXECUTE),
+    BC_Label(EXECUTE_NATIVE),
+    BC_Label(PROCEED),
+    BC_Label(FAIL),
+    BC_Label(GET_CURRENT_CHOICE_X),
+    BC_Label(GET_CURRENT_CHOICE_Y),
+    BC_Label(CUT_X),
+    BC_Label(CUT_Y),
+    BC_Label(SOFT_CUT_X),
+    BC_Label(SOFT_CUT_Y),
+    BC_Label(GET_Y_VARIABLE_2),
+    BC_Label(PUT_Y_VALUE_2),
+    BC_Label(UNIFY_X_VARIABLE_2),
+    BC_Label(UNIFY_Y_VARIABLE_2),
+    BC_Label(UNIFY_X_VALUE_2),
+    BC_Label(GET_LIST_UNIFY_X_VARIABLE_2),
+    BC_Label(GET_LIST_UNIFY_Y_VARIABLE_2),
+    BC_Label(DEALLOCATE_EXECUTE)
+  };
+#endif
 
 
 bc_loop:
   w = *bc++;
   switch (BC_Op(w))
     {
-    case GET_X_VARIABLE:
+    BC_Case(GET_X_VARIABLE):
       x0 = BC1_X0(w);
       x = BC1_XY(w);
       X(x) = X(x0);
-      goto bc_loop;
+      BC_Next;
 
-    case GET_Y_VARIABLE:
+    BC_Case(GET_Y_VARIABLE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       Y(E, y) = X(x0);
-      goto bc_loop;
+      BC_Next;
 
-    case GET_X_VALUE:
+    BC_Case(GET_X_VALUE):
       x0 = BC1_X0(w);
       x = BC1_XY(w);
       if (!Pl_Unify(X(x), X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_Y_VALUE:
+    BC_Case(GET_Y_VALUE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       if (!Pl_Unify(Y(E, y), X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_ATOM:
+    BC_Case(GET_ATOM):
       x0 = BC1_X0(w);
       if (!Pl_Get_Atom(BC1_Atom(w), X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_ATOM_BIG:
+    BC_Case(GET_ATOM_BIG):
       x0 = BC1_X0(w);
       w1 = bc->word;
       bc++;
       if (!Pl_Get_Atom(w1, X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_INTEGER:
+    BC_Case(GET_INTEGER):
       x0 = BC1_X0(w);
       if (!Pl_Get_Integer(BC1_Int(w), X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_INTEGER_BIG:
+    BC_Case(GET_INTEGER_BIG):
       x0 = BC1_X0(w);
 #if WORD_SIZE == 32
       l = bc->word;
@@ -1088,9 +1479,9 @@ bc_loop:
 #endif
       if (!Pl_Get_Integer(l, X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_FLOAT:
+    BC_Case(GET_FLOAT):
       x0 = BC1_X0(w);
       cv.u[0] = bc->word;
       bc++;
@@ -1098,83 +1489,83 @@ bc_loop:
       bc++;
       if (!Pl_Get_Float(cv.d, X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_NIL:
+    BC_Case(GET_NIL):
       x0 = BC1_X0(w);
       if (!Pl_Get_Nil(X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_LIST:
+    BC_Case(GET_LIST):
       x0 = BC1_X0(w);
       if (!Pl_Get_List(X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case GET_STRUCTURE:
+    BC_Case(GET_STRUCTURE):
       x0 = BC1_X0(w);
       arity = BC1_Arity(w);
       func = bc->word;
       bc++;
       if (!Pl_Get_Structure(func, arity, X(x0)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
 
-    case PUT_X_VARIABLE:
+    BC_Case(PUT_X_VARIABLE):
       x0 = BC1_X0(w);
       x = BC1_XY(w);
       X(x) = X(x0) = Pl_Put_X_Variable();
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_Y_VARIABLE:
+    BC_Case(PUT_Y_VARIABLE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       X(x0) = Pl_Put_Y_Variable(&Y(E, y));
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_VOID:
+    BC_Case(PUT_VOID):
       x0 = BC1_X0(w);
       X(x0) = Pl_Put_X_Variable();
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_X_VALUE:
+    BC_Case(PUT_X_VALUE):
       x0 = BC1_X0(w);
       x = BC1_XY(w);
       X(x0) = X(x);
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_Y_VALUE:
+    BC_Case(PUT_Y_VALUE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       X(x0) = Y(E, y);
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_Y_UNSAFE_VALUE:
+    BC_Case(PUT_Y_UNSAFE_VALUE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       X(x0) = Pl_Put_Unsafe_Value(Y(E, y));
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_ATOM:
+    BC_Case(PUT_ATOM):
       x0 = BC1_X0(w);
       X(x0) = Pl_Put_Atom(BC1_Atom(w));
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_ATOM_BIG:
+    BC_Case(PUT_ATOM_BIG):
       x0 = BC1_X0(w);
       w1 = bc->word;
       bc++;
       X(x0) = Pl_Put_Atom(w1);
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_INTEGER:
+    BC_Case(PUT_INTEGER):
       x0 = BC1_X0(w);
       X(x0) = Pl_Put_Integer(BC1_Int(w));
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_INTEGER_BIG:
+    BC_Case(PUT_INTEGER_BIG):
       x0 = BC1_X0(w);
 #if WORD_SIZE == 32
       l = bc->word;
@@ -1187,34 +1578,34 @@ bc_loop:
       l = cv.l;
 #endif
       X(x0) = Pl_Put_Integer(l);
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_FLOAT:
+    BC_Case(PUT_FLOAT):
       x0 = BC1_X0(w);
       cv.u[0] = bc->word;
       bc++;
       cv.u[1] = bc->word;
       bc++;
       X(x0) = Pl_Put_Float(cv.d);
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_NIL:
+    BC_Case(PUT_NIL):
       x0 = BC1_X0(w);
       X(x0) = NIL_WORD;		/* faster than Pl_Put_Nil() */
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_LIST:
+    BC_Case(PUT_LIST):
       x0 = BC1_X0(w);
       X(x0) = Pl_Put_List();
-      goto bc_loop;
+      BC_Next;
 
-    case PUT_STRUCTURE:
+    BC_Case(PUT_STRUCTURE):
       x0 = BC1_X0(w);
       arity = BC1_Arity(w);
       func = bc->word;
       bc++;
       X(x0) = Pl_Put_Structure(func, arity);
-      goto bc_loop;
+      BC_Next;
 /*
     case PUT_META_TERM:
       x0 = BC1_X0(w);
@@ -1224,74 +1615,74 @@ bc_loop:
       X(x) = Pl_Put_Meta_Term(module, X(x0));
       goto bc_loop;
 */
-    case MATH_LOAD_X_VALUE:
+    BC_Case(MATH_LOAD_X_VALUE):
       x0 = BC1_X0(w);
       x = BC1_XY(w);
       Pl_Math_Load_Value(X(x), &X(x0));
-      goto bc_loop;
+      BC_Next;
 
-    case MATH_LOAD_Y_VALUE:
+    BC_Case(MATH_LOAD_Y_VALUE):
       x0 = BC1_X0(w);
       y = BC1_XY(w);
       Pl_Math_Load_Value(Y(E, y), &X(x0));
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_X_VARIABLE:
+    BC_Case(UNIFY_X_VARIABLE):
       x = BC2_XY(w);
       X(x) = Pl_Unify_Variable();
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_Y_VARIABLE:
+    BC_Case(UNIFY_Y_VARIABLE):
       y = BC2_XY(w);
       Y(E, y) = Pl_Unify_Variable();
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_VOID:
+    BC_Case(UNIFY_VOID):
       Pl_Unify_Void(BC2_Int(w));
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_X_VALUE:
+    BC_Case(UNIFY_X_VALUE):
       x = BC2_XY(w);
       if (!Pl_Unify_Value(X(x)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_Y_VALUE:
+    BC_Case(UNIFY_Y_VALUE):
       y = BC2_XY(w);
       if (!Pl_Unify_Value(Y(E, y)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_X_LOCAL_VALUE:
+    BC_Case(UNIFY_X_LOCAL_VALUE):
       x = BC2_XY(w);
       if (!Pl_Unify_Local_Value(X(x)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_Y_LOCAL_VALUE:
+    BC_Case(UNIFY_Y_LOCAL_VALUE):
       y = BC2_XY(w);
       if (!Pl_Unify_Local_Value(Y(E, y)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_ATOM:
+    BC_Case(UNIFY_ATOM):
       if (!Pl_Unify_Atom(BC2_Atom(w)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_ATOM_BIG:
+    BC_Case(UNIFY_ATOM_BIG):
       w1 = bc->word;
       bc++;
       if (!Pl_Unify_Atom(w1))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_INTEGER:
+    BC_Case(UNIFY_INTEGER):
       if (!Pl_Unify_Integer(BC2_Int(w)))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_INTEGER_BIG:
+    BC_Case(UNIFY_INTEGER_BIG):
 #if WORD_SIZE == 32
       l = bc->word;
       bc++;
@@ -1304,38 +1695,43 @@ bc_loop:
 #endif
       if (!Pl_Unify_Integer(l))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_NIL:
+    BC_Case(UNIFY_NIL):
       if (!Pl_Unify_Nil())
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_LIST:
+    BC_Case(UNIFY_LIST):
       if (!Pl_Unify_List())
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case UNIFY_STRUCTURE:
+    BC_Case(UNIFY_STRUCTURE):
       arity = BC2_Arity(w);
       func = bc->word;
       bc++;
       if (!Pl_Unify_Structure(func, arity))
 	goto fail;
-      goto bc_loop;
+      BC_Next;
 
-    case ALLOCATE:
-      Pl_Allocate(BC2_Int(w));
-      goto bc_loop;
+    BC_Case(ALLOCATE):
+      Pl_Allocate(BC2_Int(w), nb_live_x);
+      BC_Next;
 
-    case DEALLOCATE:
+    BC_Case(DEALLOCATE):
       Pl_Deallocate();
-      goto bc_loop;
+      BC_Next;
 
-    case CALL:
+    BC_Case(DEALLOCATE_EXECUTE):
+      Pl_Deallocate();
+      goto execute;
+
+    BC_Case(CALL):
       BCI = (WamWord) (bc + 2) | debug_call;	/* use low bit of adr */
       CP = Adjust_CP(Prolog_Predicate(BC_EMULATE_CONT, 0));
-    case EXECUTE:
+    BC_Case(EXECUTE):
+    execute:
       arity = BC2_Arity(w);
       func = bc->word;
       bc++;
@@ -1367,7 +1763,7 @@ bc_loop:
       glob_dyn = pred->dyn;
       return NULL;		/* to then call BC_Emulate_Pred */
 
-    case CALL_NATIVE:
+    BC_Case(CALL_NATIVE):
       arity = BC2_Arity(w);
       func = bc->word;
       bc++;
@@ -1390,7 +1786,7 @@ bc_loop:
 	}
       return codep;
 
-    case EXECUTE_NATIVE:
+    BC_Case(EXECUTE_NATIVE):
       arity = BC2_Arity(w);
       func = bc->word;
       bc++;
@@ -1412,10 +1808,10 @@ bc_loop:
 	}
       return codep;
 
-    case PROCEED:
+    BC_Case(PROCEED):
       return UnAdjust_CP(CP);
 
-    case FAIL:
+    BC_Case(FAIL):
       if (pl_debug_call_code != NULL && debug_call)
 	{			/* invoke the debugger which will then call fail/0 */
 	  Prep_Debug_Call(atom_fail, 0, 0, 0);
@@ -1423,35 +1819,96 @@ bc_loop:
 	}
       goto fail;
 
-    case GET_CURRENT_CHOICE_X:
+    BC_Case(GET_CURRENT_CHOICE_X):
       x = BC2_XY(w);
       X(x) = Pl_Get_Current_Choice();
-      goto bc_loop;
+      BC_Next;
 
-    case GET_CURRENT_CHOICE_Y:
+    BC_Case(GET_CURRENT_CHOICE_Y):
       y = BC2_XY(w);
       Y(E, y) = Pl_Get_Current_Choice();
-      goto bc_loop;
+      BC_Next;
 
-    case CUT_X:
+    BC_Case(CUT_X):
       x = BC2_XY(w);
       Pl_Cut(X(x));
-      goto bc_loop;
+      BC_Next;
 
-    case CUT_Y:
+    BC_Case(CUT_Y):
       y = BC2_XY(w);
       Pl_Cut(Y(E, y));
-      goto bc_loop;
+      BC_Next;
 
-    case SOFT_CUT_X:
+    BC_Case(SOFT_CUT_X):
       x = BC2_XY(w);
       Pl_Soft_Cut(X(x));
-      goto bc_loop;
+      BC_Next;
 
-    case SOFT_CUT_Y:
+    BC_Case(SOFT_CUT_Y):
       y = BC2_XY(w);
       Pl_Soft_Cut(Y(E, y));
-      goto bc_loop;
+      BC_Next;
+
+    BC_Case(GET_Y_VARIABLE_2):
+      x0 = BC4_R1(w);
+      y = BC4_R2(w);
+      Y(E, y) = X(x0);
+      x0 = BC4_R3(w);
+      y = BC4_R4(w);
+      Y(E, y) = X(x0);
+      BC_Next;
+
+    BC_Case(PUT_Y_VALUE_2):
+      x0 = BC4_R1(w);
+      y = BC4_R2(w);
+      X(x0) = Y(E, y);
+      x0 = BC4_R3(w);
+      y = BC4_R4(w);
+      X(x0) = Y(E, y);
+      BC_Next;
+
+    BC_Case(UNIFY_X_VARIABLE_2):
+      x = BC3_R1(w);
+      X(x) = Pl_Unify_Variable();
+      x = BC3_R2(w);
+      X(x) = Pl_Unify_Variable();
+      BC_Next;
+
+    BC_Case(UNIFY_Y_VARIABLE_2):
+      y = BC3_R1(w);
+      Y(E, y) = Pl_Unify_Variable();
+      y = BC3_R2(w);
+      Y(E, y) = Pl_Unify_Variable();
+      BC_Next;
+
+    BC_Case(UNIFY_X_VALUE_2):
+      x = BC3_R1(w);
+      if (!Pl_Unify_Value(X(x)))
+	goto fail;
+      x = BC3_R2(w);
+      if (!Pl_Unify_Value(X(x)))
+	goto fail;
+      BC_Next;
+
+    BC_Case(GET_LIST_UNIFY_X_VARIABLE_2):
+      x0 = BC3_R1(w);
+      if (!Pl_Get_List(X(x0)))
+	goto fail;
+      x = BC3_R2(w);
+      X(x) = Pl_Unify_Variable();
+      x = BC3_R3(w);
+      X(x) = Pl_Unify_Variable();
+      BC_Next;
+
+    BC_Case(GET_LIST_UNIFY_Y_VARIABLE_2):
+      x0 = BC3_R1(w);
+      if (!Pl_Get_List(X(x0)))
+	goto fail;
+      y = BC3_R2(w);
+      Y(E, y) = Pl_Unify_Variable();
+      y = BC3_R3(w);
+      Y(E, y) = Pl_Unify_Variable();
+      BC_Next;
     }
 
 fail:
@@ -1505,3 +1962,274 @@ Prep_Debug_Call(int func, int arity, int caller_func, int caller_arity)
     }
   A(1) = Tag_INT(Call_Info(caller_func, caller_arity, debug_call));
 }
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * Part III. Saved programs (save_program/1, load_program/1)               *
+ *                                                                         *
+ * The clauses and predicates are saved/loaded by dynam_supp.c which uses  *
+ * BC_Relocate to relocate the byte-code of each clause.                   *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * PL_SAVE_PROGRAM_2                                                       *
+ *                                                                         *
+ * Saves all user predicates which are not in native code (predicates     *
+ * whose name begins with $ are system predicates) and the goal term.     *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Save_Program_2(WamWord path_name_word, WamWord goal_word)
+{
+  char *path_name;
+  HashScan scan;
+  PredInf *pred;
+  int *tfunc, *tarity;
+  int nb_pred = 0;
+  int func, arity, arity1;
+  PlLong ret;
+
+  path_name = pl_atom_tbl[Pl_Rd_Atom_Check(path_name_word)].name;
+  if ((path_name = Pl_M_Absolute_Path_Name(path_name)) == NULL)
+    Pl_Err_Domain(pl_domain_os_path, path_name_word);
+
+  Pl_Lock_Acquire(pl_pred_lock);
+
+  tfunc = (int *) Malloc((Pl_Hash_Nb_Elements(pl_pred_tbl) + 1) * sizeof(int));
+  tarity = (int *) Malloc((Pl_Hash_Nb_Elements(pl_pred_tbl) + 1) * sizeof(int));
+
+  for (pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan); pred;
+       pred = (PredInf *) Pl_Hash_Next(&scan))
+    {
+      func = Functor_Of(pred->f_n);
+      arity = Arity_Of(pred->f_n);
+      if ((pred->prop & MASK_PRED_NATIVE_CODE) ||
+	  *pl_atom_tbl[Pl_Pred_Without_Aux(func, arity, &arity1)].name == '$')
+	continue;
+
+      tfunc[nb_pred] = func;
+      tarity[nb_pred++] = arity;
+    }
+
+  ret = Pl_Save_Program(path_name, nb_pred, tfunc, tarity, goal_word, BC_Relocate);
+
+  Pl_Lock_Release(pl_pred_lock);
+
+  Free(tfunc);
+  Free(tarity);
+
+  Os_Test_Error((ret == DYN_DB_OS_ERROR) ? -1 : 0);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOAD_PROGRAM_2                                                       *
+ *                                                                         *
+ * Loads a saved program and unifies goal_word with its goal term.        *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Load_Program_2(WamWord path_name_word, WamWord goal_word)
+{
+  char *path_name;
+  WamWord word;
+  PlLong ret;
+
+  path_name = pl_atom_tbl[Pl_Rd_Atom_Check(path_name_word)].name;
+  if ((path_name = Pl_M_Absolute_Path_Name(path_name)) == NULL)
+    Pl_Err_Domain(pl_domain_os_path, path_name_word);
+
+  ret = Pl_Load_Program(path_name, &word, BC_Relocate);
+
+  if (ret == DYN_DB_BAD_FILE)
+    Pl_Err_System(Pl_Create_Atom(ERR_BAD_PROGRAM_FILE));
+
+  Os_Test_Error((ret == DYN_DB_OS_ERROR) ? -1 : 0);
+
+  return Pl_Unify(word, goal_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BC_RELOCATE                                                             *
+ *                                                                         *
+ * Relocates a byte-code of size words of the predicate func/arity (see   *
+ * DynBCFct). Its atoms are mapped by map_atom and the short form of an    *
+ * instruction is used when the new atom fits (the size can thus change). *
+ * If to_file is TRUE the calls to native code become calls by name (an   *
+ * address cannot be saved), else the calls are resolved as done by       *
+ * Pl_BC_Emit_Inst_1. Returns the new byte-code (to free with              *
+ * BC_Free_Byte_Code) or NULL if the byte-code is invalid (corrupted file) *
+ * or calls a native predicate not in the predicate table (the clause of  *
+ * a dynamic predicate compiled to native code).                          *
+ *-------------------------------------------------------------------------*/
+static unsigned *
+BC_Relocate(unsigned *byte_code, int size, int (*map_atom) (int atom),
+	    Bool to_file, int func, int arity)
+{
+  BCWord *src = (BCWord *) byte_code;
+  BCWord *end = src + size;
+  BCWord *start, *dst;
+  BCWord w, w0;
+  int op, atom, f, n, i;
+  unsigned caller;
+  PredInf *pred;
+  int *codep;
+#if WORD_SIZE == 64
+  C64To32 cv;
+#endif
+
+  start = (BCWord *) Malloc((2 * size + 2) * sizeof(BCWord)); /* max growth */
+  dst = start + 1;
+
+  while (src < end)
+    {
+      w = *src++;
+      op = BC_Op(w);
+      switch (op)
+	{
+	case GET_ATOM_BIG:
+	case PUT_ATOM_BIG:
+	case UNIFY_ATOM_BIG:
+	  if (src >= end)
+	    goto error;
+	  atom = (src++)->word;
+	  op--;
+	  goto map_atom;
+
+	case GET_ATOM:
+	case PUT_ATOM:
+	  atom = BC1_Atom(w);
+	  goto map_atom;
+
+	case UNIFY_ATOM:
+	  atom = BC2_Atom(w);
+	map_atom:
+	  if ((atom = (*map_atom) (atom)) < 0)
+	    goto error;
+
+	  if (op == UNIFY_ATOM)
+	    {
+	      BC2_Atom(w) = (Fit_In_24bits(atom)) ? atom : 0;
+	      n = !Fit_In_24bits(atom);
+	    }
+	  else
+	    {
+	      BC1_Atom(w) = (Fit_In_16bits(atom)) ? atom : 0;
+	      n = !Fit_In_16bits(atom);
+	    }
+	  BC_Op(w) = op + n;
+	  *dst++ = w;
+	  if (n)
+	    (dst++)->word = atom;
+	  break;
+
+	case GET_STRUCTURE:
+	case PUT_STRUCTURE:
+	case UNIFY_STRUCTURE:
+	  if (src >= end || (atom = (*map_atom) ((int) src->word)) < 0)
+	    goto error;
+	  src++;
+	  *dst++ = w;
+	  (dst++)->word = atom;
+	  break;
+
+	case GET_INTEGER_BIG:
+	case PUT_INTEGER_BIG:
+	case UNIFY_INTEGER_BIG:
+	case GET_FLOAT:
+	case PUT_FLOAT:
+	  n = (op == GET_FLOAT || op == PUT_FLOAT) ? 2 : BC_LONG_WORDS;
+	  if (end - src < n)
+	    goto error;
+	  *dst++ = w;
+	  for (i = 0; i < n; i++)
+	    *dst++ = *src++;
+	  break;
+
+	case CALL_NATIVE:
+	case EXECUTE_NATIVE:
+	  if (!to_file || end - src < 1 + BC_LONG_WORDS)
+	    goto error;
+	  f = src->word;
+#if WORD_SIZE == 32
+	  codep = (int *) (src[1].word);
+#else
+	  cv.u[0] = src[1].word;
+	  cv.u[1] = src[2].word;
+	  codep = cv.p;
+#endif
+	  if ((pred = Pl_Lookup_Pred(f, BC2_Arity(w))) == NULL ||
+	      (int *) (pred->codep) != codep)
+	    goto error;		/* e.g. the aux pred of a compiled clause */
+	  src += 1 + BC_LONG_WORDS;
+	  atom = Pl_Pred_Without_Aux(func, arity, &n);
+	  caller = (unsigned) Functor_Arity(atom, n);
+	  op = (op == CALL_NATIVE) ? CALL : EXECUTE;
+	  goto call;
+
+	case CALL:
+	case EXECUTE:
+	case DEALLOCATE_EXECUTE:
+	  if (end - src < 2)
+	    goto error;
+	  f = src[0].word;
+	  caller = src[1].word;
+	  src += 2;
+	call:
+	  if ((f = (*map_atom) (f)) < 0 || (atom = (*map_atom) (Functor_Of(caller))) < 0)
+	    goto error;
+	  caller = (unsigned) Functor_Arity(atom, Arity_Of(caller));
+
+	  if (!to_file && (pred = Pl_Lookup_Pred(f, BC2_Arity(w))) != NULL &&
+	      (pred->prop & MASK_PRED_NATIVE_CODE))
+	    {
+	      if (op == DEALLOCATE_EXECUTE)
+		{
+		  w0.word = 0;
+		  BC_Op(w0) = DEALLOCATE;
+		  *dst++ = w0;
+		  op = EXECUTE;
+		}
+	      BC_Op(w) = op + 1;	/* CALL_NATIVE or EXECUTE_NATIVE */
+	      *dst++ = w;
+	      (dst++)->word = f;
+#if WORD_SIZE == 32
+	      (dst++)->word = (unsigned) (pred->codep);
+#else
+	      cv.p = (int *) (pred->codep);
+	      (dst++)->word = cv.u[0];
+	      (dst++)->word = cv.u[1];
+#endif
+	      break;
+	    }
+
+	  BC_Op(w) = op;
+	  *dst++ = w;
+	  (dst++)->word = f;
+	  (dst++)->word = caller;
+	  break;
+
+	default:
+	  if (op > DEALLOCATE_EXECUTE)
+	    goto error;
+	  *dst++ = w;
+	  break;
+	}
+    }
+
+  size = (int) (dst - start) - 1;
+  start = (BCWord *) Realloc((char *) start, (size + 1) * sizeof(BCWord));
+  start->word = size;		/* see BC_Byte_Code_Size */
+  return (unsigned *) (start + 1);
+
+ error:
+  Free(start);
+  return NULL;
+}
@@ -40,6 +40,11 @@
  * Constants                       *
  *---------------------------------*/
 
+	/* the size (in words) of a byte-code is stored just before it */
+#define BC_Byte_Code_Size(byte_code)  ((int) (byte_code)[-1])
+
+#define BC_Free_Byte_Code(byte_code)  Free((byte_code) - 1)
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
@@ -49,10 +54,10 @@
  * Global Variables                *
  *---------------------------------*/
 
-				/* defined as this to avoid to force the   */
-				/* inclusion of bc_supp.o if not needed    */
-				/* (dynam_supp.c uses pl_byte_code)        */
-unsigned *pl_byte_code;
+				/* defined in dynam_supp.c to avoid to     */
+				/* force the inclusion of bc_supp.o if not */
+				/* needed (a TLS variable cannot be common)*/
+extern PL_THREAD_LOCAL unsigned *pl_byte_code;
 
 
 
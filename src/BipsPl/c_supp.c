@@ -2127,7 +2127,7 @@ Pl_Un_String_Check(char *value, WamWord start_word)
 {
   CHECK_FOR_UN_ATOM;
 
-  return Pl_Get_Atom(Pl_Create_Allocate_Atom(value), word);
+  return Pl_Get_Atom(Pl_Create_Collectable_Atom(value), word);
 }
 
 
@@ -2140,7 +2140,7 @@ Pl_Un_String_Check(char *value, WamWord start_word)
 Bool
 Pl_Un_String(char *value, WamWord start_word)
 {
-  return Pl_Get_Atom(Pl_Create_Allocate_Atom(value), start_word);
+  return Pl_Get_Atom(Pl_Create_Collectable_Atom(value), start_word);
 }
 
 
@@ -2599,7 +2599,7 @@ Pl_Mk_In_Byte(int value)
 WamWord
 Pl_Mk_String(char *value)
 {
-  return Pl_Put_Atom(Pl_Create_Allocate_Atom(value));
+  return Pl_Put_Atom(Pl_Create_Collectable_Atom(value));
 }
 
 
@@ -54,7 +54,7 @@
  * Global Variables                *
  *---------------------------------*/
 
-static PlLong save_call_info;
+static PL_THREAD_LOCAL PlLong save_call_info;
 
 
 
@@ -152,36 +152,34 @@ consult(File, Options) :-
 	        '$pl_err_existence'(source_sink, File1)
 	    )
 	),
-	PipedConsult = piped,	% can be spawn, exec (Prolog) or piped (see consult_c.c)
-	temporary_file('', gplc, TmpFile),
-	atom_concat(TmpFile, '.wbc', TmpByteCodeFile),
-	atom_concat(TmpFile, '.pl', TmpIncludeFile),
-	'$create_include_file'(PipedConsult, TmpIncludeFile),
-	Pl2WamArgs = ['-w', File2, '--include', TmpIncludeFile, '-o', TmpByteCodeFile|Pl2WamArgs1],
-%	Pl2WamArgs = ['-w', File2, '-o', TmpByteCodeFile|Pl2WamArgs1], % without --include (for debug)
-	set_bip_name(consult, Arity),	
-	(   '$consult2'(PipedConsult, Pl2WamArgs) ->
-	    '$load_file'(TmpByteCodeFile),
-	    unlink(TmpByteCodeFile),
-	    unlink(TmpIncludeFile)
-	;   unlink(TmpByteCodeFile),
-	    unlink(TmpIncludeFile),
-	    format(top_level_output, 'compilation failed~n', []),
+	g_inc('$consult_key', Key),
+	Pl2WamArgs = ['-w', File2|Pl2WamArgs1],
+	set_bip_name(consult, Arity),
+	(   '$consult_compile'(Pl2WamArgs, Key) ->
+	    '$load_bc'(Key)
+	;   format(top_level_output, 'compilation failed~n', []),
 	    fail
 	).
 
 
 
 
-'$create_include_file'(piped, IncludeFile) :-
-	!,
-	'$sys_var_read'(20, Say_GetC), 
-	'$sys_var_write'(20, 1), % activate SAY_GETC in case of piped consult (see consult_c.c)
-	write_default_include_file(IncludeFile),
-	'$sys_var_write'(20, Say_GetC).
+          % The compiler is linked in the run-time (see pl2wam_lib.pl). It
+          % records the byte-code as '$pl2wam_bc'(Key, Term) facts (nothing
+          % if the compilation fails).
 
-'$create_include_file'(_, IncludeFile) :-
-	write_default_include_file(IncludeFile).
+'$consult_compile'(Pl2WamArgs, Key) :-
+	current_input(SIn),
+	current_output(SOut),
+	set_input(top_level_input),
+	set_output(top_level_output),
+	(   '$pl2wam_compile'(Pl2WamArgs, Key) ->
+	    Ok = t
+	;   Ok = f
+	),
+	set_input(SIn),
+	set_output(SOut),
+	Ok = t.
 
 
 
@@ -235,39 +233,37 @@ write_default_include_file(_).
 
 
 
-'$consult2'(spawn, Pl2WamArgs) :-
-	spawn(pl2wam, Pl2WamArgs, 0).
-
-'$consult2'(exec, Pl2WamArgs) :-
-	'$list_to_atom'([pl2wam|Pl2WamArgs], Cmd),
-	exec(Cmd, top_level_input, top_level_output, top_level_output, Pid),
-	wait(Pid, 0).
+'$load_file'(BCFile) :-
+	open(BCFile, read, Stream),
+	'$load_terms'(Stream),
+	close(Stream).
 
-'$consult2'(piped, Pl2WamArgs) :-
-	'$call_c_test'('Pl_Consult_1'(Pl2WamArgs)).
 
+'$load_bc'(Key) :-
+	'$load_terms'(bc(Key)).
 
-'$list_to_atom'(List, Atom) :-
-	open_output_atom_stream(S),
-	(   member(A, List),
-	    write(S, A),
-	    put_char(S, ' '),
-	    fail
-	;   close_output_atom_stream(S, Atom)
-	).
 
 
 
-'$load_file'(BCFile) :-
-	open(BCFile, read, Stream),
+'$load_terms'(Src) :-
 	repeat,
-	read(Stream, P),
+	'$load_read'(Src, P),
 	(   P = end_of_file ->
 	    !
-	;   '$load_pred'(P, Stream),
+	;   '$load_pred'(P, Src),
 	    fail
-	),
-	close(Stream).
+	).
+
+
+'$load_read'(bc(Key), P) :-
+	!,
+	(   retract('$pl2wam_bc'(Key, P1)) ->
+	    P = P1
+	;   P = end_of_file
+	).
+
+'$load_read'(Stream, P) :-
+	read(Stream, P).
 
 
 
@@ -283,7 +279,7 @@ write_default_include_file(_).
 	).
 
 
-'$load_pred'(predicate(PI, PlLine, StaDyn, PubPriv, MonoMulti, UsBplBfd, NbCl), Stream) :-
+'$load_pred'(predicate(PI, PlLine, StaDyn, PubPriv, MonoMulti, UsBplBfd, NbCl), Src) :-
 	PI = Pred / N,
 	g_read('$pl_file', PlFile),
 	'$check_pred_type'(Pred, N, PlFile, PlLine),
@@ -300,7 +296,7 @@ write_default_include_file(_).
 	g_assign('$ctr', Ctr1),
 	(   Ctr = NbCl ->
 	    true
-	;   read(Stream, clause(Cl, WamCl)),
+	;   '$load_read'(Src, clause(Cl, WamCl)),
 	    '$add_clause_term_and_bc'(Cl, PlFile, WamCl),
 	    fail
 	), !.
@@ -379,6 +375,48 @@ load(File) :-
 
 
 
+save_program(File) :-
+	findall(Goal, '$save_program_goal'(Goal), Goals),
+	set_bip_name(save_program, 1),
+	'$call_c_test'('Pl_Save_Program_2'(File, Goals)).
+
+
+'$save_program_goal'(op(Prior, Type, Op)) :-
+	current_op(Prior, Type, Op),
+	Op \== (',').
+
+'$save_program_goal'(set_prolog_flag(Flag, Value)) :-
+	member(Flag, [char_conversion, double_quotes, back_quotes, unknown,
+		      syntax_error, os_error, singleton_warning, suspicious_warning,
+		      multifile_warning, strict_iso]),
+	current_prolog_flag(Flag, Value).
+
+'$save_program_goal'(char_conversion(Ch1, Ch2)) :-
+	current_char_conversion(Ch1, Ch2).
+
+'$save_program_goal'(g_assign(Var, Value)) :-
+	'$g_var_names'(Vars),
+	member(Var, Vars),
+	g_read(Var, Value).
+
+
+
+
+load_program(File) :-
+	set_bip_name(load_program, 1),
+	'$call_c_test'('Pl_Load_Program_2'(File, Goals)),
+	'$load_program_goals'(Goals).
+
+
+'$load_program_goals'([]).
+
+'$load_program_goals'([Goal|Goals]) :-
+	call(Goal),
+	'$load_program_goals'(Goals).
+
+
+
+
 '$bc_start_pred'(Pred, N, PlFile, PlLine, StaDyn, PubPriv, MonoMulti, UsBplBfd) :-
 	'$call_c'('Pl_BC_Start_Pred_8'(Pred, N, PlFile, PlLine, StaDyn, PubPriv, MonoMulti, UsBplBfd)).
 
@@ -94,21 +94,21 @@ InfCmd;
 
 WamCont pl_debug_call_code;
 
-static int nb_read_arg;
-static char read_arg[30][80];
+static PL_THREAD_LOCAL int nb_read_arg;
+static PL_THREAD_LOCAL char read_arg[30][80];
 
 
 static char *envir_name[] = ENVIR_NAMES;
 static char *choice_name[] = CHOICE_NAMES;
 static char *trail_tag_name[] = TRAIL_TAG_NAMES;
-static WamWord reg_copy[NB_OF_REGS];
+static PL_THREAD_LOCAL WamWord reg_copy[NB_OF_REGS];
 
-static StmInf *pstm_i;
-static StmInf *pstm_o;
+static PL_THREAD_LOCAL StmInf *pstm_i;
+static PL_THREAD_LOCAL StmInf *pstm_o;
 
-static sigjmp_buf dbg_jumper;
+static PL_THREAD_LOCAL sigjmp_buf dbg_jumper;
 
-static void *invalid_addr;
+static PL_THREAD_LOCAL void *invalid_addr;
 
 
 
@@ -262,6 +262,7 @@ Pl_Choice_Point_Info_4(WamWord b_word, WamWord name_word, WamWord arity_word, Wa
 
   code = (PlULong) ALTB(b);
 
+  Pl_Lock_Acquire(pl_pred_lock);
   for (pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan); pred;
        pred = (PredInf *) Pl_Hash_Next(&scan))
     {
@@ -272,6 +273,7 @@ Pl_Choice_Point_Info_4(WamWord b_word, WamWord name_word, WamWord arity_word, Wa
 	  last_code = code1;
 	}
     }
+  Pl_Lock_Release(pl_pred_lock);
 
   func = Functor_Of(last_pred->f_n);
   arity = Arity_Of(last_pred->f_n);
@@ -1168,6 +1170,7 @@ Detect_Pred_From_Code(PlLong *codep)
   PredInf *last_pred = NULL;
   PlLong dist = 0, d;		/* init for the compiler */
 
+  Pl_Lock_Acquire(pl_pred_lock);
   for (pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan); pred;
        pred = (PredInf *) Pl_Hash_Next(&scan))
     {
@@ -1182,6 +1185,7 @@ Detect_Pred_From_Code(PlLong *codep)
 	  dist = d;
 	}
     }
+  Pl_Lock_Release(pl_pred_lock);
 
   return last_pred;
 }
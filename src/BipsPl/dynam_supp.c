@@ -36,14 +36,26 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
+#define OBJ_INIT Dynam_Supp_Initializer
 
 #include "engine_pl.h"
 #include "bips_pl.h"
 
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#define USE_MMAP_FOR_DYN_DB
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 
 #define DEBUG_LEVEL 0
 
@@ -77,6 +89,25 @@
 #define LST_INDEX                  4
 #define STC_INDEX                  5
 
+#define JIT_MIN_CLAUSES            16   /* no JIT index for smaller preds */
+#define JIT_CHECK_PERIOD           1024 /* scans+adds between 2 checks */
+
+
+#define DYN_DB_MAGIC               "GPDYNDB"
+#define DYN_PROG_MAGIC             "GPSTATE" /* saved program (same format) */
+#define DYN_DB_VERSION             2
+
+#define DB_PRED_APPEND             1 /* pred has clauses in native code */
+
+				/* how to relocate a word of a db file */
+#define DB_RAW                     0 /* as is (integer, float data) */
+#define DB_ATM                     1 /* atom index */
+#define DB_FCT                     2 /* functor (atom index, arity) */
+#define DB_REF                     3 /* offsets in the clause term */
+#define DB_LST                     4
+#define DB_STC                     5
+#define DB_FLT                     6
+
 
 
 
@@ -96,22 +127,98 @@ typedef struct			/* Dynamic clause scanning info   */
   Bool xxx_is_seq_chain;        /* scan all clauses ?             */
   DynCInf *xxx_ind_chain;	/* current assoc idx (->clause)   */
   DynCInf *var_ind_chain;	/* current var   idx (->clause)   */
+  DynJitIdx *jit;		/* JIT index used (or NULL)       */
+  DynJitCell *jit_key_cell;	/* current key cell (JIT index)   */
+  DynJitCell *jit_var_cell;	/* current var cell (JIT index)   */
   DynCInf *clause;		/* current clause                 */
 }
 DynScan;
 
 
+typedef struct jitdecl		/* Declared JIT index (spec)      */
+{				/* ------------------------------ */
+  struct jitdecl *next;		/* next declaration for this pred */
+  int nb_arg;			/* number of indexed arguments    */
+  int arg_no[DYN_JIT_MAX_ARGS];	/* indexed arg positions (from 0) */
+}
+JitDecl;
+
+
+typedef struct			/* Declared JIT indexes of a pred */
+{				/* ------------------------------ */
+  PlLong f_n;			/* key is <functor,arity>         */
+  JitDecl *first;		/* list of declarations           */
+}
+JitDeclInf;
+
+
+typedef struct			/* Dynamic db file header         */
+{				/* ------------------------------ */
+  char magic[8];		/* DYN_DB_MAGIC or DYN_PROG_MAGIC */
+  char prolog_version[16];	/* PROLOG_VERSION (byte-code ops) */
+  int version;			/* DYN_DB_VERSION                 */
+  int word_size;		/* sizeof(WamWord)                */
+  int atom_max_bits;		/* ATOM_MAX_BITS (for functors)   */
+  int nb_atom;			/* nb of atoms in the atom table  */
+  int nb_pred;			/* nb of predicates               */
+  PlLong atom_size;		/* size of the atom names (bytes) */
+  PlLong goal_offset;		/* offset of the goal term (or 0) */
+}
+DynDbHdr;
+
+
+typedef struct			/* Dynamic db file predicate      */
+{				/* ------------------------------ */
+  int func;			/* functor (index in atom table)  */
+  int arity;			/* arity                          */
+  int prop;			/* pred props (saved program)     */
+  int pl_file;			/* file (index in atom table)     */
+  int pl_line;			/* line in this file              */
+  int flags;			/* DB_PRED_xxx                    */
+  PlLong nb_clause;		/* number of clauses              */
+  PlLong nb_key[3];		/* nb of atm/int/stc index keys   */
+  PlLong offset;		/* offset of the clauses (bytes)  */
+  PlLong size;			/* size of the clauses (words)    */
+}
+DynDbPred;
+
+
+struct dynblock			/* Block of loaded clauses        */
+{				/* ------------------------------ */
+  PlLong nb_alive;		/* nb of clauses not yet freed    */
+};
+
+
 
 
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
+PL_THREAD_LOCAL unsigned *pl_byte_code; /* see bc_supp.h */
+
+	  /* the variables below are shared: only used with pl_pred_lock held */
+
 static DynPInf *first_dyn_with_erase = NULL;
 
 static int longest_skip_erased = 0; /* max nb of skipped clauses during a scan */
 static int nb_erased_clauses = 0;   /* number of clauses waiting to be cleaned */
 
+static char *jit_decl_tbl = NULL;   /* declared JIT indexes (see dynamic_index/1) */
+
+				/* save_dynamic_db/2, load_dynamic_db/1 */
+static WamWord *db_base;	/* clause term being encoded      */
+static WamWord *db_code;	/* its encoded words              */
+static unsigned char *db_kind;	/* and their kind (DB_xxx)        */
+static int db_code_size;	/* size of db_code (in words)     */
+static int *db_atom_no;		/* atom -> index+1 in atom table  */
+static int *db_atom;		/* atom table of the file         */
+static int db_nb_atom;		/* nb of atoms in db_atom         */
+static int db_max_atom;		/* size of db_atom                */
+static int *db_atom_map;	/* loading: index -> atom         */
+static int db_map_nb_atom;	/* nb of atoms in db_atom_map     */
+static DynBCFct db_bc_fct;	/* byte-code relocation (or NULL) */
+
 
 
 
@@ -125,8 +232,75 @@ static int nb_erased_clauses = 0;   /* number of clauses waiting to be cleaned *
       
 #define Is_Clause_Erased(clause)   ((clause)->erase_stamp != DYN_STAMP_ALIVE)
 
+	/* size of a DynCInf whose clause term has size words */
+#define Dyn_Clause_Size(size)      (sizeof(DynCInf) + ((size) - 3) * sizeof(WamWord))
+
+	/* a clause of a loaded block is checked through its block */
+#define MPROBE_CLAUSE(clause)      MPROBE_PTR("clause", ((clause)->block) ?	\
+					      (void *) (clause)->block :	\
+					      (void *) (clause))
+
+	/* db file: sizes in words (a clause is size, kind, pl_file, bc_size, */
+	/* words, kinds and byte-code) */
+#define Db_Round_Up(n)             (((n) + (PlLong) sizeof(WamWord) - 1) / \
+				    (PlLong) sizeof(WamWord) * (PlLong) sizeof(WamWord))
+
+#define Db_Kind_Words(size)        (((size) + (PlLong) sizeof(WamWord) - 1) / \
+				    (PlLong) sizeof(WamWord))
+
+#define Db_BC_Words(bc_size)       (Db_Round_Up((bc_size) * (PlLong) sizeof(unsigned)) / \
+				    (PlLong) sizeof(WamWord))
+
+#define Db_Rec_Size(size, bc_size) (4 + (size) + Db_Kind_Words(size) + Db_BC_Words(bc_size))
+
+static DynPInf *Get_Dyn_Info(int func, int arity, Bool check_perm);
+
+static void Err_Static_Procedure(int func, int arity);
+
 static DynPInf *Alloc_Init_Dyn_Info(int func, int arity);
 
+static void Link_Clause(DynPInf *dyn, DynCInf *clause, WamWord *first_arg_adr,
+			int index_no, PlLong key, Bool asserta);
+
+static int Db_Atom_Index(int atom);
+
+static int Db_Atom_Of_Index(int index);
+
+static void Db_Encode_Term(WamWord *adr);
+
+static void Db_Encode(WamWord *base, int size);
+
+static unsigned *Db_Clause_Byte_Code(DynCInf *clause, int func, int arity);
+
+static Bool Db_Write_Record(FILE *f, WamWord *rec_hdr, unsigned *bc);
+
+static PlLong Db_Save(char *path, char *magic, int nb_pred, int *func, int *arity,
+		      WamWord goal_word);
+
+static DynPInf *Db_Dyn_Of(int func, int arity);
+
+static char *Db_Map_File(char *path, PlLong *len);
+
+static void Db_Unmap_File(char *addr, PlLong len);
+
+static PlLong Db_Check_Record(WamWord *rec, WamWord *end, int min_size, int nb_atom);
+
+static PlLong Db_Check_Clauses(DynDbPred *tp, char *addr, PlLong len, int nb_atom);
+
+static Bool Db_Relocate_Byte_Code(DynDbPred *tp, char *addr, unsigned **bc_tbl);
+
+static void Db_Decode_Term(WamWord *dst, WamWord *rec);
+
+static void Db_Define_Pred(DynDbPred *tp);
+
+static void Db_Presize_Table(char **p_htbl, PlLong nb_key);
+
+static void Db_Load_Clauses(DynPInf *dyn, DynDbPred *tp, char *addr,
+			    PlLong block_size, unsigned **bc_tbl);
+
+static PlLong Db_Load(char *path, char *magic, int *func, int *arity,
+		      WamWord *goal_word);
+
 static int Index_From_First_Arg(WamWord first_arg_word, PlLong *key);
 
 static void Add_To_2Chain(D2ChHdr *hdr, DynCInf *clause, Bool in_seq_chain, Bool asserta);
@@ -147,6 +321,36 @@ static DynScan *Get_Scan_Choice_Point(WamWord *b);
 
 static void Clean_Erased_Clauses(void);
 
+static void Mark_Scanned_Dyn(void *arg);
+
+static void Atom_GC_Roots(void);
+
+static Bool Jit_Key(DynJitIdx *idx, WamWord *arg_adr, PlLong *key);
+
+static Bool Jit_Arg_Key(WamWord arg_word, PlLong *key);
+
+static DynJitIdx *Jit_Create_Index(DynPInf *dyn, int nb_arg, int *arg_no, Bool declared);
+
+static DynJitIdx *Jit_Find_Index(DynPInf *dyn, int nb_arg, int *arg_no);
+
+static void Jit_Add_Clause(DynJitIdx *idx, DynCInf *clause, WamWord *arg_adr,
+			   Bool asserta);
+
+static void Jit_Remove_Cell(DynJitCell *cell);
+
+static void Jit_Free_Index(DynJitIdx *idx, Bool unlink_from_clauses);
+
+static void Jit_Free_All_Indexes(DynPInf *dyn);
+
+static DynJitIdx *Jit_Select_Index(DynPInf *dyn, WamWord *arg_adr, int index_no,
+				   PlLong *key);
+
+static void Jit_Tick(DynPInf *dyn);
+
+static void Jit_Check_Unused(DynPInf *dyn);
+
+static void Jit_Mark_Used(void *arg);
+
 /* size of a DynScan in WamWords (rounded up) */
 #define DYNSCAN_SIZE ((sizeof(DynScan) + sizeof(WamWord) - 1) / sizeof(WamWord))
 
@@ -265,8 +469,90 @@ Prolog_Prototype(SCAN_DYN_JUMP_ALT, 0);
  * clauses of a predicate are linked (first/next_erased_cl). All dynamic 
  * predicates with at least one erased clause are linked 
  * (first/next_dyn_with_erase).
+ *
+ * JIT indexes: the above indexing only considers the 1st argument. When a
+ * call does not bind it (var or float), a scan would traverse the whole
+ * sequential chain. In that case, if the predicate has enough clauses
+ * (JIT_MIN_CLAUSES), an index is built "just in time" on the first other
+ * argument bound by the call (atom, integer, list or structure). Further
+ * calls binding this argument use it. A JIT index (DynJitIdx) can also
+ * be on several arguments (composite index): this is only done when 
+ * declared by dynamic_index/1. A composite index is used when all its 
+ * arguments are bound (it is then preferred to the 1st arg indexing).
+ * Declarations are recorded (jit_decl_tbl) so that a new dyn (e.g. after
+ * a retractall/1) gets its declared indexes back.
+ *
+ * A JIT index is a hash table: key=combination of the keys of its args,
+ * info=chain of cells (DynJitCell), and a chain (var_chain) for clauses
+ * with an unindexable arg (var or float). As for 1st arg chains, clauses
+ * are chained in the order of their clause no and a scan merges the key
+ * chain with the var chain. Since the number of JIT indexes varies, the
+ * cells are not embedded in the clause but allocated apart and linked
+ * (first/next_of_clause) to their clause. Indexes are maintained by
+ * Pl_Add_Dynamic_Clause and Unlink_And_Free_Clause (erased clauses remain
+ * in the chains until the GC-clause, exactly as for other chains). 
+ * Different keys can have the same combination: a JIT index only selects
+ * candidate clauses (as the 1st arg indexing does for structures).
+ *
+ * Unused JIT indexes are dropped: every JIT_CHECK_PERIOD scans+adds (and
+ * not before the pred has been totally scanned/added, to amortize the 
+ * rebuild) the non-declared indexes which have not been used since the 
+ * last check (and not used by an alive scan-point) are freed.
  */
 
+/*-------------------------------------------------------------------------*
+ * DYNAM_SUPP_INITIALIZER                                                  *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Dynam_Supp_Initializer(void)
+{
+  Pl_Atom_GC_Add_Root_Fct(Atom_GC_Roots);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_ROOTS                                                           *
+ *                                                                         *
+ * Mark the atoms of all dynamic clauses (erased clauses are still in the  *
+ * sequential chain until they are cleaned).                               *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Roots(void)
+{
+  HashScan scan;
+  PredInf *pred;
+  DynCInf *clause;
+  JitDeclInf *decl;
+
+  /* called by the atom GC with pl_pred_lock held */
+  for (pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan); pred;
+       pred = (PredInf *) Pl_Hash_Next(&scan))
+    {
+      if (pred->dyn == NULL)
+	continue;
+
+      for (clause = ((DynPInf *) pred->dyn)->seq_chain.first; clause;
+	   clause = clause->seq_chain.next)
+	{
+	  Pl_Atom_GC_Mark_Words(&clause->term_word, clause->term_size);
+	  Pl_Atom_GC_Mark(clause->pl_file);
+	}
+    }
+
+  if (jit_decl_tbl == NULL)
+    return;
+
+  for (decl = (JitDeclInf *) Pl_Hash_First(jit_decl_tbl, &scan); decl;
+       decl = (JitDeclInf *) Pl_Hash_Next(&scan))
+    Pl_Atom_GC_Mark(Functor_Of(decl->f_n));
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_ADD_DYNAMIC_CLAUSE                                                   *
  *                                                                         *
@@ -275,34 +561,25 @@ DynCInf *
 Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
 		      Bool check_perm, int pl_file)
 {
-  WamWord word;
+  WamWord word, tag_mask;
   WamWord *first_arg_adr;
   int func, arity;
-  PredInf *pred;
   int index_no;
   PlLong key = 0;		/* init for the compiler */
   DynCInf *clause;
   DynPInf *dyn;
-  char **p_ind_htbl;
-  D2ChHdr *p_ind_hdr;
-  DSwtInf swt_info;
-  DSwtInf *swt;
   int size;
   WamWord lst_h_b;
 
   first_arg_adr = Pl_Rd_Callable_Check(head_word, &func, &arity);
 
-  if ((pred = Pl_Lookup_Pred(func, arity)) == NULL)
-    pred = Pl_Create_Pred(func, arity, pl_atom_user_input,
-			  (int) pl_stm_tbl[pl_stm_stdin]->line_count,
-			  MASK_PRED_DYNAMIC | MASK_PRED_PUBLIC, NULL);
-  else if (check_perm && !(pred->prop & MASK_PRED_DYNAMIC))
+  Pl_Lock_Acquire(pl_pred_lock);
+
+  dyn = Get_Dyn_Info(func, arity, check_perm);
+  if (dyn == NULL)
     {
-      word = Pl_Put_Structure(ATOM_CHAR('/'), 2);
-      Pl_Unify_Atom(func);
-      Pl_Unify_Integer(arity);
-      Pl_Err_Permission(pl_permission_operation_modify,
-			pl_permission_type_static_procedure, word);
+      Pl_Lock_Release(pl_pred_lock);
+      Err_Static_Procedure(func, arity);
     }
 
   /* pl_file is the file name of its definition (or -1). Used for multifile
@@ -311,12 +588,6 @@ Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
   if (pl_file == pl_atom_void)
     pl_file = -1;
 
-  if (pred->dyn == NULL)		/* dynamic info not yet allocated ? */
-    pred->dyn = Alloc_Init_Dyn_Info(func, arity);
-  dyn = pred->dyn;
-  
-  MPROBE_PTR("dyn", dyn);
-
   index_no = (dyn->arity) ? Index_From_First_Arg(*first_arg_adr, &key) : NO_INDEX;
 
   lst_h_b = Tag_LST(H);
@@ -329,7 +600,8 @@ Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
   Pl_Write(lst_h_b);
   DBGPRINTF(" - size: %d   H: %p\n", size, H);
 #endif
-  clause = (DynCInf *) Malloc(sizeof(DynCInf) + (size - 3) * sizeof(WamWord));
+  clause = (DynCInf *) Malloc(Dyn_Clause_Size(size));
+  clause->block = NULL;
 
   Add_To_2Chain(&dyn->seq_chain, clause, TRUE, asserta);
 
@@ -345,6 +617,14 @@ Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
   clause->byte_code = pl_byte_code;
   pl_byte_code = NULL;
 
+  DEREF(body_word, word, tag_mask);
+  if (word != Tag_ATM(pl_atom_true))
+    clause->kind = DYN_CLAUSE_RULE;
+  else if (Pl_Blt_Ground(head_word))
+    clause->kind = DYN_CLAUSE_GROUND_FACT;
+  else
+    clause->kind = DYN_CLAUSE_FACT;
+
 #if DEBUG_LEVEL >= 1
   Print_Dynamic_Clause("Add clause:", clause);
   DBGPRINTF("\t| index_no: %d  byte-code: %p\n", index_no, pl_byte_code);
@@ -358,6 +638,83 @@ Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
 #endif
 #endif
 
+  Link_Clause(dyn, clause, first_arg_adr, index_no, key, asserta);
+
+  Pl_Lock_Release(pl_pred_lock);
+
+  MPROBE_CLAUSE(clause);
+  return clause;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GET_DYN_INFO                                                            *
+ *                                                                         *
+ * Returns the dynamic info of a predicate (created as a dynamic predicate *
+ * if needed). Returns NULL if check_perm is TRUE and the predicate is     *
+ * static (the caller raises the error once pl_pred_lock is released).     *
+ *-------------------------------------------------------------------------*/
+static DynPInf *
+Get_Dyn_Info(int func, int arity, Bool check_perm)
+{
+  PredInf *pred;
+  DynPInf *dyn;
+
+  if ((pred = Pl_Lookup_Pred(func, arity)) == NULL)
+    pred = Pl_Create_Pred(func, arity, pl_atom_user_input,
+			  (int) pl_stm_tbl[pl_stm_stdin]->line_count,
+			  MASK_PRED_DYNAMIC | MASK_PRED_PUBLIC, NULL);
+  else if (check_perm && !(pred->prop & MASK_PRED_DYNAMIC))
+    return NULL;
+
+  if (pred->dyn == NULL)		/* dynamic info not yet allocated ? */
+    pred->dyn = Alloc_Init_Dyn_Info(func, arity);
+  dyn = pred->dyn;
+  
+  MPROBE_PTR("dyn", dyn);
+
+  return dyn;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ERR_STATIC_PROCEDURE                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Err_Static_Procedure(int func, int arity)
+{
+  WamWord word;
+
+  word = Pl_Put_Structure(ATOM_CHAR('/'), 2);
+  Pl_Unify_Atom(func);
+  Pl_Unify_Integer(arity);
+  Pl_Err_Permission(pl_permission_operation_modify,
+		    pl_permission_type_static_procedure, word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * LINK_CLAUSE                                                             *
+ *                                                                         *
+ * Adds a clause (already in the sequential chain) to the first argument   *
+ * index (index_no/key) and to the JIT indexes of its predicate.           *
+ *-------------------------------------------------------------------------*/
+static void
+Link_Clause(DynPInf *dyn, DynCInf *clause, WamWord *first_arg_adr,
+	    int index_no, PlLong key, Bool asserta)
+{
+  char **p_ind_htbl;
+  D2ChHdr *p_ind_hdr;
+  DSwtInf swt_info;
+  DSwtInf *swt;
+  DynJitIdx *jit;
 
   switch(index_no)
     {
@@ -410,12 +767,18 @@ Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word, Bool asserta,
   if (p_ind_hdr)
     Add_To_2Chain(p_ind_hdr, clause, FALSE, asserta);
 
+  clause->jit_cells = NULL;
+  if (dyn->jit_idx)
+    {
+      for (jit = dyn->jit_idx; jit; jit = jit->next)
+	Jit_Add_Clause(jit, clause, first_arg_adr, asserta);
+
+      Jit_Tick(dyn);
+    }
+
 #if DEBUG_LEVEL >= 5
   Print_Dynamic_Info(dyn, __func__, FALSE);
 #endif
-
-  MPROBE_PTR("clause", clause);
-  return clause;
 }
 
 
@@ -429,6 +792,8 @@ static DynPInf *
 Alloc_Init_Dyn_Info(int func, int arity)
 {
   DynPInf *dyn;
+  JitDeclInf *decl_inf;
+  JitDecl *decl;
 
   dyn = (DynPInf *) Malloc(sizeof(DynPInf));
 
@@ -440,9 +805,16 @@ Alloc_Init_Dyn_Info(int func, int arity)
   dyn->arity = arity;
   dyn->count_a = -1;
   dyn->count_z = 0;
+  dyn->jit_idx = NULL;
+  dyn->jit_clock = 0;
   dyn->first_erased_cl = NULL;
   dyn->next_dyn_with_erase = NULL;
 
+  if (jit_decl_tbl &&
+      (decl_inf = (JitDeclInf *) Pl_Hash_Find(jit_decl_tbl, Functor_Arity(func, arity))))
+    for (decl = decl_inf->first; decl; decl = decl->next)
+      Jit_Create_Index(dyn, decl->nb_arg, decl->arg_no, TRUE);
+
   return dyn;
 }
 
@@ -509,7 +881,7 @@ Add_To_2Chain(D2ChHdr *hdr, DynCInf *clause, Bool in_seq_chain, Bool asserta)
 {
   D2ChCell *cell = (in_seq_chain) ? &clause->seq_chain : &clause->ind_chain;
 
-  MPROBE_PTR("clause", clause);
+  MPROBE_CLAUSE(clause);
 
   if (hdr->first == NULL)	/* empty chain ? */
     {
@@ -556,7 +928,7 @@ Remove_From_2Chain(D2ChHdr *hdr, DynCInf *clause, Bool in_seq_chain)
   DynCInf *prev = cell->prev;
   DynCInf *next = cell->next;
 
-  MPROBE_PTR("clause", clause);
+  MPROBE_CLAUSE(clause);
 
   if (prev == NULL)		/* first cell ? */
     {
@@ -592,17 +964,20 @@ Remove_From_2Chain(D2ChHdr *hdr, DynCInf *clause, Bool in_seq_chain)
 static void
 Free_Clause(DynCInf *clause)
 {
-  MPROBE_PTR("clause", clause);
+  MPROBE_CLAUSE(clause);
 
   if (clause->byte_code)
-    Free(clause->byte_code);
+    BC_Free_Byte_Code(clause->byte_code);
 
 #if DEBUG_LEVEL >= 4
   DBGPRINTF("Free clause no: %d at %p\n", clause->cl_no, clause);
 #endif
 
   nb_erased_clauses--;
-  Free(clause);
+  if (clause->block == NULL)
+    Free(clause);
+  else if (--clause->block->nb_alive == 0)
+    Free(clause->block);
 }
 
 
@@ -617,8 +992,9 @@ Unlink_And_Free_Clause(DynCInf *clause)
 {
   DynPInf *dyn = clause->dyn;
   PlLong *p_key;
+  DynJitCell *cell, *cell1;
 
-  MPROBE_PTR("clause", clause);
+  MPROBE_CLAUSE(clause);
 
 #if DEBUG_LEVEL >= 2
   Print_Dynamic_Clause("Unlink+Free clause:", clause);
@@ -638,6 +1014,12 @@ Unlink_And_Free_Clause(DynCInf *clause)
 #endif
       Pl_Hash_Delete(*clause->p_ind_htbl, *p_key);
     }
+
+  for (cell = clause->jit_cells; cell; cell = cell1)
+    {
+      cell1 = cell->next_of_clause;
+      Jit_Remove_Cell(cell);
+    }
 #if DEBUG_LEVEL >= 3
   Print_Dynamic_Info(dyn, __func__, FALSE);
 #endif
@@ -658,7 +1040,7 @@ Pl_Delete_Dynamic_Clause(DynCInf *clause)
 {
   DynPInf *dyn;
 
-  MPROBE_PTR("clause", clause);
+  MPROBE_CLAUSE(clause);
 
   /* Test if clause is already deleted. This can occurs with LDUV with
    * foo(1).
@@ -667,8 +1049,13 @@ Pl_Delete_Dynamic_Clause(DynCInf *clause)
    * | ?- retract(foo(X)), retract(foo(2)).
    * foo(2) is deleted after X=1 and on backtracking (LDUV) with X=2 (then failure).
    */
+  Pl_Lock_Acquire(pl_pred_lock);
+
   if (Is_Clause_Erased(clause))
-    return;
+    {
+      Pl_Lock_Release(pl_pred_lock);
+      return;
+    }
 
   dyn = clause->dyn;
 
@@ -704,6 +1091,8 @@ Pl_Delete_Dynamic_Clause(DynCInf *clause)
 #if DEBUG_LEVEL >= 5
   Print_Dynamic_Info(dyn, __func__, FALSE);
 #endif
+
+  Pl_Lock_Release(pl_pred_lock);
 }
 
 
@@ -727,7 +1116,7 @@ Erase_All_Clauses_Of_File(DynPInf *dyn, int pl_file)
 
   for (clause = dyn->seq_chain.first; clause; clause = clause->seq_chain.next)
     {
-      MPROBE_PTR("clause", clause);
+      MPROBE_CLAUSE(clause);
 
       if (clause->pl_file == pl_file)
 	Pl_Delete_Dynamic_Clause(clause);
@@ -770,7 +1159,7 @@ Erase_All(DynPInf *dyn)
 
   for (clause = dyn->seq_chain.first; clause; clause = clause->seq_chain.next)
     {
-      MPROBE_PTR("clause", clause);
+      MPROBE_CLAUSE(clause);
       
       if (!Is_Clause_Erased(clause))
 	nb_erased_clauses++;
@@ -802,20 +1191,21 @@ Erase_All(DynPInf *dyn)
 PredInf *
 Pl_Update_Dynamic_Pred(int func, int arity, int what_to_do, int pl_file_for_multi)
 {
-  WamWord word;
   PredInf *pred;
 
+  Pl_Lock_Acquire(pl_pred_lock);
+
   pred = Pl_Lookup_Pred(func, arity);
   if (pred == NULL)
-    return NULL;
+    {
+      Pl_Lock_Release(pl_pred_lock);
+      return NULL;
+    }
 
   if ((what_to_do & 1) && !(pred->prop & MASK_PRED_DYNAMIC))
     {
-      word = Pl_Put_Structure(ATOM_CHAR('/'), 2);
-      Pl_Unify_Atom(func);
-      Pl_Unify_Integer(arity);
-      Pl_Err_Permission(pl_permission_operation_modify,
-			pl_permission_type_static_procedure, word);
+      Pl_Lock_Release(pl_pred_lock);
+      Err_Static_Procedure(func, arity);
     }
 
   if (pl_file_for_multi >= 0 && (pred->prop & MASK_PRED_MULTIFILE))
@@ -831,9 +1221,11 @@ Pl_Update_Dynamic_Pred(int func, int arity, int what_to_do, int pl_file_for_mult
   if ((what_to_do & 2))
     {
       Pl_Delete_Pred(func, arity);
-      return NULL;
+      pred = NULL;
     }
 
+  Pl_Lock_Release(pl_pred_lock);
+
   return pred;
 }
 
@@ -846,7 +1238,7 @@ Pl_Update_Dynamic_Pred(int func, int arity, int what_to_do, int pl_file_for_mult
  *-------------------------------------------------------------------------*/
 DynCInf *
 Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
-		     DynPInf *dyn, WamWord first_arg_word,
+		     DynPInf *dyn, WamWord *arg_adr,
 		     ScanFct alt_fct, int alt_fct_type,
 		     int alt_info_size, WamWord *alt_info)
 {
@@ -854,6 +1246,8 @@ Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
   PlLong key;
   char **p_ind_htbl;
   DSwtInf *swt;
+  DynJitIdx *jit;
+  DJitSwtInf *jit_swt;
   DynScan scan;
   DynCInf *clause;
   WamWord *adr;
@@ -877,13 +1271,17 @@ Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
    * see OPTIM_FIRST_FOR_SCAN to improve this.
    */
 
+  Pl_Lock_Acquire(pl_pred_lock);
+
   Clean_Erased_Clauses();
   MPROBE_PTR("dyn", dyn);
   
   if (owner_func < 0)
     owner_func = Pl_Get_Current_Bip(&owner_arity);
 
-  index_no = (dyn->arity) ? Index_From_First_Arg(first_arg_word, &key) : NO_INDEX;
+  index_no = (dyn->arity) ? Index_From_First_Arg(*arg_adr, &key) : NO_INDEX;
+
+  jit = (dyn->arity) ? Jit_Select_Index(dyn, arg_adr, index_no, &key) : NULL;
 
   scan.alt_fct = alt_fct;
   scan.alt_size_info = alt_info_size;
@@ -892,11 +1290,27 @@ Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
   scan.dyn = dyn;
   scan.stop_cl_no = dyn->count_z;
   scan.erase_stamp = dyn->curr_stamp;
+  scan.jit = jit;
 
 #if DEBUG_LEVEL >= 1
   Print_Scan_Info("SCAN DYNAMIC", &scan);
 #endif
 
+  if (jit)
+    {
+      jit->used = TRUE;
+      if (jit->htbl && (jit_swt = (DJitSwtInf *) Pl_Hash_Find(jit->htbl, key)) != NULL)
+	scan.jit_key_cell = jit_swt->chain.first;
+      else
+	scan.jit_key_cell = NULL;
+
+      scan.jit_var_cell = jit->var_chain.first;
+      index_no = NO_INDEX;	/* do not use the 1st arg indexing */
+    }
+
+  if (dyn->jit_idx)
+    Jit_Tick(dyn);
+
   switch (index_no)
     {
     case NO_INDEX:
@@ -941,10 +1355,8 @@ Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
     scan.var_ind_chain = dyn->var_ind_chain.first_for_scan;
 
   clause = Scan_Dynamic_Pred_Next(&scan);
-  if (clause == NULL)
-    return NULL;
 
-  if (Scan_Dynamic_Pred_Next(&scan) != NULL)	/* non deterministic case */
+  if (clause != NULL && Scan_Dynamic_Pred_Next(&scan) != NULL)	/* non deterministic case */
     {
       dyn->curr_stamp++;	/* LDUV needs care only when there are more than one answer */
 
@@ -964,6 +1376,8 @@ Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
       *(DynScan *) adr = scan;
     }
 
+  Pl_Lock_Release(pl_pred_lock);
+
   return clause;
 }
 
@@ -999,7 +1413,17 @@ Scan_Dynamic_Pred_Next(DynScan *scan)
     {
       nb_skip_erased++;
 
-      xxx_ind_chain = scan->xxx_ind_chain;
+      if (scan->jit)
+	{
+	  xxx_ind_chain = (scan->jit_key_cell) ? scan->jit_key_cell->clause : NULL;
+	  var_ind_chain = (scan->jit_var_cell) ? scan->jit_var_cell->clause : NULL;
+	}
+      else
+	{
+	  xxx_ind_chain = scan->xxx_ind_chain;
+	  var_ind_chain = scan->var_ind_chain;
+	}
+
       if (xxx_ind_chain)
 	{
 	  xxx_clause = xxx_ind_chain;
@@ -1008,7 +1432,6 @@ Scan_Dynamic_Pred_Next(DynScan *scan)
       else
 	xxx_nb = INT_GREATEST_VALUE;
 
-      var_ind_chain = scan->var_ind_chain;
       if (var_ind_chain)
 	{
 	  var_clause = var_ind_chain;
@@ -1023,7 +1446,9 @@ Scan_Dynamic_Pred_Next(DynScan *scan)
 	    return NULL;
 
 	  clause = xxx_clause;
-	  if (scan->xxx_is_seq_chain)
+	  if (scan->jit)
+	    scan->jit_key_cell = scan->jit_key_cell->next;
+	  else if (scan->xxx_is_seq_chain)
 	    scan->xxx_ind_chain = xxx_ind_chain->seq_chain.next;
 	  else
 	    scan->xxx_ind_chain = xxx_ind_chain->ind_chain.next;
@@ -1031,10 +1456,13 @@ Scan_Dynamic_Pred_Next(DynScan *scan)
       else
 	{
 	  clause = var_clause;
-	  scan->var_ind_chain = var_ind_chain->ind_chain.next;
+	  if (scan->jit)
+	    scan->jit_var_cell = scan->jit_var_cell->next;
+	  else
+	    scan->var_ind_chain = var_ind_chain->ind_chain.next;
 	}
 
-      MPROBE_PTR("clause", clause);
+      MPROBE_CLAUSE(clause);
 
       /* Detect when remaining clauses are beyond the scan point (created after it) */
       if (clause->cl_no >= scan->stop_cl_no)
@@ -1102,7 +1530,9 @@ Pl_Scan_Dynamic_Pred_Alt_0(void)
 
   clause = scan->clause;
 
+  Pl_Lock_Acquire(pl_pred_lock);
   is_last = (Scan_Dynamic_Pred_Next(scan) == NULL);
+  Pl_Lock_Release(pl_pred_lock);
 
   if (is_last)
     Delete_Last_Choice_Point();
@@ -1114,62 +1544,1645 @@ Pl_Scan_Dynamic_Pred_Alt_0(void)
 
 
 /*-------------------------------------------------------------------------*
- * PL_COPY_CLAUSE_TO_HEAP                                                  *
+ * JIT_SELECT_INDEX                                                        *
  *                                                                         *
+ * Selects (or builds) a JIT index to use for a call (args at arg_adr).    *
+ * index_no is the index type of the 1st arg. Returns NULL if the 1st arg  *
+ * indexing should be used, else the JIT index and initializes key.        *
  *-------------------------------------------------------------------------*/
-void
-Pl_Copy_Clause_To_Heap(DynCInf *clause, WamWord *head_word, WamWord *body_word)
+static DynJitIdx *
+Jit_Select_Index(DynPInf *dyn, WamWord *arg_adr, int index_no, PlLong *key)
 {
-  MPROBE_PTR("clause", clause);
+  DynJitIdx *jit, *best = NULL;
+  PlLong k, best_key = 0;	/* init for the compiler */
+  int i;
 
-  Pl_Copy_Contiguous_Term(H, &clause->term_word);	/* *H=<LST,H+1> */
-  *head_word = H[1];
-  *body_word = H[2];
-  H += clause->term_size;
+  for (jit = dyn->jit_idx; jit; jit = jit->next)
+    if ((best == NULL || jit->nb_arg > best->nb_arg) && Jit_Key(jit, arg_adr, &k))
+      {
+	best = jit;
+	best_key = k;
+      }
+
+  if (index_no != NO_INDEX && index_no != VAR_INDEX && (best == NULL || best->nb_arg == 1))
+    return NULL;		/* 1st arg is bound: only use a composite index */
+
+  if (best)
+    {
+      *key = best_key;
+      return best;
+    }
+
+  if (dyn->count_z - dyn->count_a - 1 < JIT_MIN_CLAUSES)
+    return NULL;
+
+  for (i = 1; i < dyn->arity; i++)
+    if (Jit_Arg_Key(arg_adr[i], key))
+      return Jit_Create_Index(dyn, 1, &i, FALSE);
+
+  return NULL;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * GET_SCAN_CHOICE_POINT                                                   *
+ * JIT_KEY                                                                 *
  *                                                                         *
+ * Computes the key of the arguments (at arg_adr) for a JIT index. Returns *
+ * FALSE if one of the indexed args is not indexable (var or float).       *
  *-------------------------------------------------------------------------*/
-static DynScan *
-Get_Scan_Choice_Point(WamWord *b)
+static Bool
+Jit_Key(DynJitIdx *jit, WamWord *arg_adr, PlLong *key)
 {
-  DynScan *scan;
+  PlULong k1 = 0;
+  PlLong k;
   int i;
 
-  if (ALTB(b) != (CodePtr) Prolog_Predicate(SCAN_DYN_TEST_ALT, 0) &&
-      ALTB(b) != (CodePtr) Prolog_Predicate(SCAN_DYN_JUMP_ALT, 0))
-    return NULL;
+  for (i = 0; i < jit->nb_arg; i++)
+    {
+      if (!Jit_Arg_Key(arg_adr[jit->arg_no[i]], &k))
+	return FALSE;
 
-  i = DYNSCAN_SIZE - 1;
-  scan = (DynScan *) &AB(b, i);
+      k1 = k1 * 31 + (PlULong) k;
+    }
 
-  return scan;
+  *key = (PlLong) k1;
+  return TRUE;
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_SCAN_CHOICE_POINT_PRED                                               *
+ * JIT_ARG_KEY                                                             *
  *                                                                         *
- * returns the functor and initializes the arity of the scan choice point b*
- * or -1 if b is not a scan choice point.                                  *
  *-------------------------------------------------------------------------*/
-int
-Pl_Scan_Choice_Point_Pred(WamWord *b, int *arity)
+static Bool
+Jit_Arg_Key(WamWord arg_word, PlLong *key)
 {
-  DynScan *scan;
-
-  scan = Get_Scan_Choice_Point(b);
-  if (scan == NULL)
-    return -1;
+  WamWord word, tag_mask;
+
+  DEREF(arg_word, word, tag_mask);
+  switch (Tag_From_Tag_Mask(tag_mask))
+    {
+    case REF:
+#ifndef NO_USE_FD_SOLVER
+    case FDV:
+#endif
+    case FLT:
+      return FALSE;
+
+    case INT:
+    case ATM:
+      *key = (PlLong) word;	/* the tag distinguishes atoms and integers */
+      break;
+
+    case LST:
+      *key = (PlLong) TAG_LST_MASK;
+      break;
+
+    default:			/* tag==STC */
+      *key = (PlLong) Functor_And_Arity(UnTag_STC(word));
+      break;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_CREATE_INDEX                                                        *
+ *                                                                         *
+ * Creates a JIT index on the nb_arg args of arg_no and adds all clauses   *
+ * (except erased ones, ignored by subsequent scans anyway).               *
+ *-------------------------------------------------------------------------*/
+static DynJitIdx *
+Jit_Create_Index(DynPInf *dyn, int nb_arg, int *arg_no, Bool declared)
+{
+  DynJitIdx *jit;
+  DynCInf *clause;
+  WamWord *arg_adr;
+  int func, arity;
+
+  jit = (DynJitIdx *) Malloc(sizeof(DynJitIdx));
+
+  jit->nb_arg = nb_arg;
+  memcpy(jit->arg_no, arg_no, nb_arg * sizeof(int));
+  jit->declared = declared;
+  jit->used = FALSE;
+  jit->htbl = NULL;
+  jit->var_chain.first = jit->var_chain.last = NULL;
+
+  jit->next = dyn->jit_idx;
+  dyn->jit_idx = jit;
+
+#if DEBUG_LEVEL >= 1
+  DBGPRINTF("JIT index on %d arg(s) (1st: %d) of %s/%d\n", nb_arg, arg_no[0] + 1,
+	    pl_atom_tbl[dyn->func].name, dyn->arity);
+#endif
+
+  for (clause = dyn->seq_chain.first; clause; clause = clause->seq_chain.next)
+    {
+      if (Is_Clause_Erased(clause))
+	continue;
+
+      arg_adr = Pl_Rd_Callable_Check(clause->head_word, &func, &arity);
+      Jit_Add_Clause(jit, clause, arg_adr, FALSE);
+    }
+
+  return jit;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_FIND_INDEX                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static DynJitIdx *
+Jit_Find_Index(DynPInf *dyn, int nb_arg, int *arg_no)
+{
+  DynJitIdx *jit;
+
+  for (jit = dyn->jit_idx; jit; jit = jit->next)
+    if (jit->nb_arg == nb_arg && memcmp(jit->arg_no, arg_no, nb_arg * sizeof(int)) == 0)
+      break;
+
+  return jit;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_ADD_CLAUSE                                                          *
+ *                                                                         *
+ * arg_adr: the args of the head of the clause.                            *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Add_Clause(DynJitIdx *jit, DynCInf *clause, WamWord *arg_adr, Bool asserta)
+{
+  DynJitCell *cell;
+  DJitHdr *hdr;
+  DJitSwtInf swt_info;
+  DJitSwtInf *swt;
+  PlLong key;
+
+  cell = (DynJitCell *) Malloc(sizeof(DynJitCell));
+  cell->clause = clause;
+  cell->idx = jit;
+  cell->next_of_clause = clause->jit_cells;
+  clause->jit_cells = cell;
+
+  if (Jit_Key(jit, arg_adr, &key))
+    {
+      if (jit->htbl == NULL)
+	jit->htbl = Pl_Hash_Alloc_Table(START_DYNAMIC_SWT_SIZE, sizeof(DJitSwtInf));
+
+      swt_info.key = key;
+      swt_info.chain.first = swt_info.chain.last = NULL;
+
+      Pl_Extend_Table_If_Needed(&jit->htbl);
+      swt = (DJitSwtInf *) Pl_Hash_Insert(jit->htbl, (char *) &swt_info, FALSE);
+      hdr = &swt->chain;
+    }
+  else
+    hdr = &jit->var_chain;
+
+  cell->hdr = hdr;
+  if (hdr->first == NULL)	/* empty chain ? */
+    {
+      hdr->first = hdr->last = cell;
+      cell->next = cell->prev = NULL;
+    }
+  else if (asserta)
+    {
+      cell->next = hdr->first;
+      cell->prev = NULL;
+      hdr->first->prev = cell;
+      hdr->first = cell;
+    }
+  else
+    {
+      cell->next = NULL;
+      cell->prev = hdr->last;
+      hdr->last->next = cell;
+      hdr->last = cell;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_REMOVE_CELL                                                         *
+ *                                                                         *
+ * Unlinks and frees a cell (the caller unlinks it from its clause).       *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Remove_Cell(DynJitCell *cell)
+{
+  DJitHdr *hdr = cell->hdr;
+  DynJitIdx *jit = cell->idx;
+  PlLong *p_key;
+
+  if (cell->prev == NULL)	/* first cell ? */
+    hdr->first = cell->next;
+  else
+    cell->prev->next = cell->next;
+
+  if (cell->next == NULL)	/* last cell ? */
+    hdr->last = cell->prev;
+  else
+    cell->next->prev = cell->prev;
+
+  if (hdr->first == NULL && hdr != &jit->var_chain)
+    {
+      p_key = (PlLong *) ((char *) hdr - offsetof(DJitSwtInf, chain));
+      Pl_Hash_Delete(jit->htbl, *p_key);
+    }
+
+  Free(cell);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_FREE_INDEX                                                          *
+ *                                                                         *
+ * Frees a JIT index (the caller unlinks it from its dyn). If clauses are  *
+ * not freed, unlink_from_clauses must be TRUE.                            *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Free_Index(DynJitIdx *jit, Bool unlink_from_clauses)
+{
+  DJitSwtInf *swt;
+  HashScan scan;
+  DJitHdr *hdr;
+  DynJitCell *cell, *cell1, **p;
+
+  swt = (jit->htbl) ? (DJitSwtInf *) Pl_Hash_First(jit->htbl, &scan) : NULL;
+  hdr = &jit->var_chain;
+  for (;;)
+    {
+      for (cell = hdr->first; cell; cell = cell1)
+	{
+	  cell1 = cell->next;
+	  if (unlink_from_clauses)
+	    {
+	      for (p = &cell->clause->jit_cells; *p != cell; p = &(*p)->next_of_clause)
+		;
+	      *p = cell->next_of_clause;
+	    }
+	  Free(cell);
+	}
+
+      if (swt == NULL)
+	break;
+
+      hdr = &swt->chain;
+      swt = (DJitSwtInf *) Pl_Hash_Next(&scan);
+    }
+
+  if (jit->htbl)
+    Pl_Hash_Free_Table(jit->htbl);
+
+  Free(jit);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_FREE_ALL_INDEXES                                                    *
+ *                                                                         *
+ * Frees all JIT indexes of a dyn whose clauses are freed.                 *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Free_All_Indexes(DynPInf *dyn)
+{
+  DynJitIdx *jit, *jit1;
+
+  for (jit = dyn->jit_idx; jit; jit = jit1)
+    {
+      jit1 = jit->next;
+      Jit_Free_Index(jit, FALSE);
+    }
+
+  dyn->jit_idx = NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_TICK                                                                *
+ *                                                                         *
+ * Called at each scan/add of a dyn with JIT indexes.                      *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Tick(DynPInf *dyn)
+{
+  if (++dyn->jit_clock >= JIT_CHECK_PERIOD &&
+      dyn->jit_clock >= dyn->count_z - dyn->count_a - 1)
+    Jit_Check_Unused(dyn);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_CHECK_UNUSED                                                        *
+ *                                                                         *
+ * Drops the JIT indexes unused since the last check (except declared     *
+ * ones and those used by an alive scan-point).                            *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Check_Unused(DynPInf *dyn)
+{
+  DynJitIdx *jit, **p;
+
+  dyn->jit_clock = 0;
+
+  if (!Pl_Engine_Exclusive_Begin())	/* other engines running: keep all */
+    return;
+
+  Jit_Mark_Used(dyn);		/* scan-points of all engines */
+  Pl_Engine_Map_Detached(Jit_Mark_Used, dyn);
+  Pl_Engine_Exclusive_End();
+
+  p = &dyn->jit_idx;
+  while ((jit = *p) != NULL)
+    {
+      if (!jit->used && !jit->declared)
+	{
+#if DEBUG_LEVEL >= 1
+	  DBGPRINTF("JIT index dropped on %d arg(s) (1st: %d) of %s/%d\n", jit->nb_arg,
+		    jit->arg_no[0] + 1, pl_atom_tbl[dyn->func].name, dyn->arity);
+#endif
+	  *p = jit->next;
+	  Jit_Free_Index(jit, TRUE);
+	  continue;
+	}
+
+      jit->used = FALSE;
+      p = &jit->next;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * JIT_MARK_USED                                                           *
+ *                                                                         *
+ * Mark the JIT indexes of dyn used by a scan-point of the current engine. *
+ *-------------------------------------------------------------------------*/
+static void
+Jit_Mark_Used(void *arg)
+{
+  DynPInf *dyn = (DynPInf *) arg;
+  WamWord *b, *base;
+  DynScan *scan;
+
+  base = Local_Stack;
+  for (b = B; b > base; b = BB(b))
+    {
+      scan = Get_Scan_Choice_Point(b);
+      if (scan && scan->dyn == dyn && scan->jit)
+	scan->jit->used = TRUE;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_DECLARE_DYNAMIC_INDEX                                                *
+ *                                                                         *
+ * Declares a JIT index on the nb_arg args of arg_no (see dynamic_index/1).*
+ *-------------------------------------------------------------------------*/
+void
+Pl_Declare_Dynamic_Index(int func, int arity, int nb_arg, int *arg_no)
+{
+  PlLong f_n = Functor_Arity(func, arity);
+  JitDeclInf decl_info;
+  JitDeclInf *decl_inf;
+  JitDecl *decl;
+  PredInf *pred;
+  DynPInf *dyn;
+  DynJitIdx *jit;
+
+  Pl_Lock_Acquire(pl_pred_lock);
+
+  if (jit_decl_tbl == NULL)
+    jit_decl_tbl = Pl_Hash_Alloc_Table(START_DYNAMIC_SWT_SIZE, sizeof(JitDeclInf));
+
+  if ((decl_inf = (JitDeclInf *) Pl_Hash_Find(jit_decl_tbl, f_n)) == NULL)
+    {
+      decl_info.f_n = f_n;
+      decl_info.first = NULL;
+      Pl_Extend_Table_If_Needed(&jit_decl_tbl);
+      decl_inf = (JitDeclInf *) Pl_Hash_Insert(jit_decl_tbl, (char *) &decl_info, FALSE);
+    }
+
+  for (decl = decl_inf->first; decl; decl = decl->next)
+    if (decl->nb_arg == nb_arg && memcmp(decl->arg_no, arg_no, nb_arg * sizeof(int)) == 0)
+      break;
+
+  if (decl == NULL)
+    {
+      decl = (JitDecl *) Malloc(sizeof(JitDecl));
+      decl->nb_arg = nb_arg;
+      memcpy(decl->arg_no, arg_no, nb_arg * sizeof(int));
+      decl->next = decl_inf->first;
+      decl_inf->first = decl;
+    }
+
+  if ((pred = Pl_Lookup_Pred(func, arity)) != NULL && pred->dyn != NULL)
+    {
+      dyn = pred->dyn;
+      if ((jit = Jit_Find_Index(dyn, nb_arg, arg_no)) != NULL)
+	jit->declared = TRUE;
+      else
+	Jit_Create_Index(dyn, nb_arg, arg_no, TRUE);
+    }
+
+  Pl_Lock_Release(pl_pred_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * Dynamic database files (save_dynamic_db/2, load_dynamic_db/1) and saved *
+ * programs (save_program/1, load_program/1, see bc_supp.c)                *
+ *                                                                         *
+ * A file contains a header, the names of the atoms it references, a table *
+ * of predicates and, for each predicate, its clauses. A clause is stored  *
+ * as its term size, its kind, its file, the size of its byte-code, the    *
+ * words of its (contiguous) clause term, one byte per word giving how to  *
+ * relocate it and its byte-code. In the clause term pointers are stored  *
+ * as offsets from the start of the term and atoms (also in functors) as  *
+ * indexes in the atom table of the file. The byte-code is relocated by   *
+ * bc_supp.c (it uses the same atom indexes). The file is thus independent*
+ * of the address where it is loaded and of the atom numbering (but not of*
+ * the word size nor of the version for the byte-code).                   *
+ *                                                                         *
+ * A saved program also records the properties of its predicates and a   *
+ * goal term (stored as a clause term) executed once loaded to restore the*
+ * operators, flags, global variables,... (see consult.pl).               *
+ *                                                                         *
+ * Loading maps the file (read-only), creates the atoms once, relocates   *
+ * the clauses of each predicate into one single block (see DynBlock) and *
+ * links them to the first argument index whose hash tables are allocated *
+ * with their final size (the number of keys is stored in the file). No   *
+ * scanning, parsing nor heap copy is involved.                            *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * DB_ATOM_INDEX                                                           *
+ *                                                                         *
+ * Returns the index of an atom in the atom table of the file (added if    *
+ * needed).                                                                *
+ *-------------------------------------------------------------------------*/
+static int
+Db_Atom_Index(int atom)
+{
+  if (db_atom_no[atom] == 0)
+    {
+      if (db_nb_atom >= db_max_atom)
+	Pl_Extend_Array((char **) &db_atom, &db_max_atom, sizeof(int), FALSE);
+
+      db_atom[db_nb_atom++] = atom;
+      db_atom_no[atom] = db_nb_atom;
+    }
+
+  return db_atom_no[atom] - 1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_ATOM_OF_INDEX                                                        *
+ *                                                                         *
+ * Returns the atom of an index of the atom table of the file being loaded *
+ * or -1 if invalid. Used to relocate byte-code whose atoms are permanent. *
+ *-------------------------------------------------------------------------*/
+static int
+Db_Atom_Of_Index(int index)
+{
+  if ((unsigned) index >= (unsigned) db_map_nb_atom)
+    return -1;
+
+  Pl_Keep_Atom(db_atom_map[index]);
+  return db_atom_map[index];
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_ENCODE_TERM                                                          *
+ *                                                                         *
+ * Encodes the word at adr (in the clause term starting at db_base) and    *
+ * the subterms it references (see Pl_Copy_Contiguous_Term).               *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Encode_Term(WamWord *adr)
+{
+  WamWord word, *q;
+  PlLong i, j;
+  int n;
+
+terminal_rec:
+
+  i = adr - db_base;
+  word = *adr;
+
+  switch (Tag_Of(word))
+    {
+    case REF:
+      q = UnTag_REF(word);
+      db_code[i] = q - db_base;
+      db_kind[i] = DB_REF;
+      if (q > adr)		/* e.g. the copy of an FD variable */
+	Db_Encode_Term(q);
+      return;
+
+#ifndef NO_USE_FD_SOLVER
+    case FDV:			/* saved as a plain variable */
+      db_code[i] = i;
+      db_kind[i] = DB_REF;
+      return;
+#endif
+
+    case ATM:
+      db_code[i] = Db_Atom_Index(UnTag_ATM(word));
+      db_kind[i] = DB_ATM;
+      return;
+
+    case FLT:
+      q = UnTag_FLT(word);
+      j = q - db_base;
+      db_code[i] = j;
+      db_kind[i] = DB_FLT;
+      db_code[j] = q[0];
+#if WORD_SIZE == 32
+      db_code[j + 1] = q[1];
+#endif
+      return;
+
+    case LST:
+      q = UnTag_LST(word);
+      db_code[i] = q - db_base;
+      db_kind[i] = DB_LST;
+      Db_Encode_Term(&Car(q));
+      adr = &Cdr(q);
+      goto terminal_rec;
+
+    case STC:
+      q = UnTag_STC(word);
+      j = q - db_base;
+      db_code[i] = j;
+      db_kind[i] = DB_STC;
+      n = Arity(q);
+      db_code[j] = Functor_Arity(Db_Atom_Index(Functor(q)), n);
+      db_kind[j] = DB_FCT;
+      q = &Arg(q, 0);
+      while (--n)
+	Db_Encode_Term(q++);
+      adr = q;
+      goto terminal_rec;
+
+    default:			/* INT */
+      db_code[i] = word;
+      return;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_ENCODE                                                               *
+ *                                                                         *
+ * Encodes a contiguous term (e.g. a clause term) of size words in        *
+ * db_code/db_kind (grown if needed).                                      *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Encode(WamWord *base, int size)
+{
+  if (size > db_code_size)
+    {
+      db_code_size = size + size / 2;
+      db_code = (WamWord *) Realloc((char *) db_code, db_code_size * sizeof(WamWord));
+      db_kind = (unsigned char *) Realloc((char *) db_kind,
+					  Db_Kind_Words(db_code_size) * sizeof(WamWord));
+    }
+
+  memset(db_code, 0, size * sizeof(WamWord));
+  memset(db_kind, DB_RAW, Db_Kind_Words(size) * sizeof(WamWord));
+
+  db_base = base;
+  Db_Encode_Term(db_base);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_CLAUSE_BYTE_CODE                                                     *
+ *                                                                         *
+ * Returns the byte-code of a clause relocated for the file (to free) or   *
+ * NULL if the clause has no byte-code, if byte-code is not saved or if it *
+ * cannot be relocated (it calls native code of the executable).          *
+ *-------------------------------------------------------------------------*/
+static unsigned *
+Db_Clause_Byte_Code(DynCInf *clause, int func, int arity)
+{
+  if (db_bc_fct == NULL || clause->byte_code == NULL)
+    return NULL;
+
+  return (*db_bc_fct) (clause->byte_code, BC_Byte_Code_Size(clause->byte_code),
+		       Db_Atom_Index, TRUE, func, arity);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_WRITE_RECORD                                                         *
+ *                                                                         *
+ * Writes a record (header, term encoded in db_code/db_kind, byte-code).  *
+ *-------------------------------------------------------------------------*/
+static Bool
+Db_Write_Record(FILE *f, WamWord *rec_hdr, unsigned *bc)
+{
+  PlLong size = rec_hdr[0];
+  PlLong bc_size = rec_hdr[3];
+  PlLong pad = 0;
+  PlLong n;
+
+  if (fwrite(rec_hdr, sizeof(WamWord), 4, f) != 4 ||
+      fwrite(db_code, sizeof(WamWord), size, f) != (size_t) size ||
+      fwrite(db_kind, sizeof(WamWord), Db_Kind_Words(size), f) != (size_t) Db_Kind_Words(size))
+    return FALSE;
+
+  if (bc_size == 0)
+    return TRUE;
+
+  n = Db_BC_Words(bc_size) * sizeof(WamWord) - bc_size * sizeof(unsigned);
+  return fwrite(bc, sizeof(unsigned), bc_size, f) == (size_t) bc_size &&
+    (n == 0 || fwrite(&pad, n, 1, f) == 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_DYN_OF                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static DynPInf *
+Db_Dyn_Of(int func, int arity)
+{
+  PredInf *pred = Pl_Lookup_Pred(func, arity);
+
+  return (pred) ? (DynPInf *) pred->dyn : NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_SAVE_DYNAMIC_DB                                                      *
+ *                                                                         *
+ * Saves the clauses of the given (dynamic or undefined) predicates in     *
+ * path. Returns the number of saved clauses or DYN_DB_OS_ERROR.           *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Save_Dynamic_Db(char *path, int nb_pred, int *func, int *arity)
+{
+  PlLong ret;
+
+  Pl_Lock_Acquire(pl_pred_lock);	/* also protects the db_xxx variables */
+  db_bc_fct = NULL;
+  ret = Db_Save(path, DYN_DB_MAGIC, nb_pred, func, arity, NOT_A_WAM_WORD);
+  Pl_Lock_Release(pl_pred_lock);
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_SAVE_PROGRAM                                                         *
+ *                                                                         *
+ * Saves the given (non native) predicates with their properties and their*
+ * byte-code (relocated by bc_fct) and the goal term goal_word in path.    *
+ * The clauses of a predicate which call native code of the executable    *
+ * (clauses of a compiled dynamic predicate) are not saved (they are      *
+ * present in the executable which loads the file, see DB_PRED_APPEND).   *
+ * Returns the number of saved clauses or DYN_DB_OS_ERROR.                 *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Save_Program(char *path, int nb_pred, int *func, int *arity,
+		WamWord goal_word, DynBCFct bc_fct)
+{
+  PlLong ret;
+
+  Pl_Lock_Acquire(pl_pred_lock);
+  db_bc_fct = bc_fct;
+  ret = Db_Save(path, DYN_PROG_MAGIC, nb_pred, func, arity, goal_word);
+  Pl_Lock_Release(pl_pred_lock);
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_SAVE                                                                 *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Db_Save(char *path, char *magic, int nb_pred, int *func, int *arity,
+	WamWord goal_word)
+{
+  FILE *f = NULL;
+  DynDbHdr hdr;
+  DynDbPred *tpred, *tp;
+  PredInf *pred;
+  DynPInf *dyn;
+  DynCInf *clause;
+  PlLong offset, nb_clause = 0;
+  PlLong pad = 0;
+  WamWord rec_hdr[4];
+  WamWord *goal = NULL;
+  unsigned *bc;
+  char *name;
+  int i, err_no;
+  int size, goal_size = 0;
+
+  db_atom_no = (int *) Calloc(pl_max_atom, sizeof(int));
+  db_max_atom = 1024;
+  db_atom = (int *) Malloc(db_max_atom * sizeof(int));
+  db_nb_atom = 0;
+  db_code_size = 0;
+  db_code = NULL;
+  db_kind = NULL;
+
+  tpred = (DynDbPred *) Calloc(nb_pred, sizeof(DynDbPred));
+
+				/* pass 1: atom table and sizes */
+  for (i = 0, tp = tpred; i < nb_pred; i++, tp++)
+    {
+      tp->func = Db_Atom_Index(func[i]);
+      tp->arity = arity[i];
+      tp->pl_file = -1;
+      pred = Pl_Lookup_Pred(func[i], arity[i]);
+      if (db_bc_fct && pred)
+	{
+	  tp->prop = pred->prop;
+	  tp->pl_file = Db_Atom_Index(pred->pl_file);
+	  tp->pl_line = pred->pl_line;
+	}
+
+      if (pred == NULL || (dyn = pred->dyn) == NULL)
+	continue;
+
+      tp->nb_key[0] = (dyn->atm_htbl) ? Pl_Hash_Nb_Elements(dyn->atm_htbl) : 0;
+      tp->nb_key[1] = (dyn->int_htbl) ? Pl_Hash_Nb_Elements(dyn->int_htbl) : 0;
+      tp->nb_key[2] = (dyn->stc_htbl) ? Pl_Hash_Nb_Elements(dyn->stc_htbl) : 0;
+
+      for (clause = dyn->seq_chain.first; clause; clause = clause->seq_chain.next)
+	{
+	  if (Is_Clause_Erased(clause))
+	    continue;
+
+	  size = 0;
+	  if ((bc = Db_Clause_Byte_Code(clause, func[i], arity[i])) != NULL)
+	    {
+	      size = BC_Byte_Code_Size(bc);
+	      BC_Free_Byte_Code(bc);
+	    }
+	  else if (db_bc_fct && clause->byte_code)
+	    {
+	      tp->flags |= DB_PRED_APPEND;
+	      continue;
+	    }
+
+	  Db_Encode(&clause->term_word, clause->term_size);
+	  if (db_bc_fct && clause->pl_file >= 0)
+	    Db_Atom_Index(clause->pl_file);
+
+	  tp->nb_clause++;
+	  tp->size += Db_Rec_Size(clause->term_size, size);
+	}
+      nb_clause += tp->nb_clause;
+    }
+
+  if (goal_word != NOT_A_WAM_WORD)
+    {
+      goal_size = Pl_Term_Size(goal_word);
+      goal = (WamWord *) Malloc(goal_size * sizeof(WamWord));
+      Pl_Copy_Term(goal, &goal_word);
+      Db_Encode(goal, goal_size);
+    }
+
+  memset(&hdr, 0, sizeof(hdr));
+  strcpy(hdr.magic, magic);
+  strncpy(hdr.prolog_version, PROLOG_VERSION, sizeof(hdr.prolog_version) - 1);
+  hdr.version = DYN_DB_VERSION;
+  hdr.word_size = sizeof(WamWord);
+  hdr.atom_max_bits = ATOM_MAX_BITS;
+  hdr.nb_atom = db_nb_atom;
+  hdr.nb_pred = nb_pred;
+  for (i = 0; i < db_nb_atom; i++)
+    hdr.atom_size += strlen(pl_atom_tbl[db_atom[i]].name) + 1;
+  hdr.atom_size = Db_Round_Up(hdr.atom_size);
+
+  offset = sizeof(hdr) + hdr.atom_size + nb_pred * sizeof(DynDbPred);
+  for (i = 0, tp = tpred; i < nb_pred; i++, tp++)
+    {
+      tp->offset = offset;
+      offset += tp->size * sizeof(WamWord);
+    }
+  if (goal)
+    hdr.goal_offset = offset;
+
+				/* pass 2: write the file */
+  if ((f = fopen(path, "wb")) == NULL)
+    goto error;
+
+  if (fwrite(&hdr, sizeof(hdr), 1, f) != 1)
+    goto error;
+
+  offset = 0;
+  for (i = 0; i < db_nb_atom; i++)
+    {
+      name = pl_atom_tbl[db_atom[i]].name;
+      size = strlen(name) + 1;
+      if (fwrite(name, size, 1, f) != 1)
+	goto error;
+      offset += size;
+    }
+
+  if (offset < hdr.atom_size && fwrite(&pad, hdr.atom_size - offset, 1, f) != 1)
+    goto error;
+
+  if (nb_pred > 0 && fwrite(tpred, sizeof(DynDbPred), nb_pred, f) != (size_t) nb_pred)
+    goto error;
+
+  for (i = 0; i < nb_pred; i++)
+    {
+      if ((dyn = Db_Dyn_Of(func[i], arity[i])) == NULL)
+	continue;
+
+      for (clause = dyn->seq_chain.first; clause; clause = clause->seq_chain.next)
+	{
+	  if (Is_Clause_Erased(clause))
+	    continue;
+
+	  bc = Db_Clause_Byte_Code(clause, func[i], arity[i]);
+	  if (bc == NULL && db_bc_fct && clause->byte_code)
+	    continue;
+
+	  Db_Encode(&clause->term_word, clause->term_size);
+	  rec_hdr[0] = clause->term_size;
+	  rec_hdr[1] = clause->kind;
+	  rec_hdr[2] = (db_bc_fct && clause->pl_file >= 0) ? Db_Atom_Index(clause->pl_file) : -1;
+	  rec_hdr[3] = (bc) ? BC_Byte_Code_Size(bc) : 0;
+
+	  if (!Db_Write_Record(f, rec_hdr, bc))
+	    {
+	      if (bc)
+		BC_Free_Byte_Code(bc);
+	      goto error;
+	    }
+	  if (bc)
+	    BC_Free_Byte_Code(bc);
+	}
+    }
+
+  if (goal)
+    {
+      Db_Encode(goal, goal_size);
+      rec_hdr[0] = goal_size;
+      rec_hdr[1] = 0;
+      rec_hdr[2] = -1;
+      rec_hdr[3] = 0;
+      if (!Db_Write_Record(f, rec_hdr, NULL))
+	goto error;
+    }
+
+  if (fclose(f) != 0)
+    {
+      f = NULL;
+      goto error;
+    }
+
+  goto finish;
+
+ error:
+  err_no = errno;
+  if (f)
+    fclose(f);
+  errno = err_no;
+  nb_clause = DYN_DB_OS_ERROR;
+
+ finish:
+  Free(db_atom_no);
+  Free(db_atom);
+  if (db_code)
+    {
+      Free(db_code);
+      Free(db_kind);
+    }
+  if (goal)
+    Free(goal);
+  Free(tpred);
+
+  return nb_clause;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_MAP_FILE                                                             *
+ *                                                                         *
+ * Maps a file in memory (read-only). Returns NULL on error (see errno).   *
+ *-------------------------------------------------------------------------*/
+static char *
+Db_Map_File(char *path, PlLong *len)
+{
+  struct stat st;
+  char *addr;
+#ifdef USE_MMAP_FOR_DYN_DB
+  int fd, err_no;
+
+  if ((fd = open(path, O_RDONLY)) < 0)
+    return NULL;
+
+  if (fstat(fd, &st) < 0)
+    {
+      err_no = errno;
+      close(fd);
+      errno = err_no;
+      return NULL;
+    }
+
+  *len = st.st_size;
+  if (*len == 0)		/* mmap rejects a 0 length */
+    {
+      close(fd);
+      return (char *) Malloc(1);
+    }
+
+  addr = (char *) mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+  err_no = errno;
+  close(fd);
+  if (addr == (char *) MAP_FAILED)
+    {
+      errno = err_no;
+      return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+  madvise(addr, *len, MADV_SEQUENTIAL);
+#endif
+
+#else  /* read it in a Malloc'ed buffer */
+
+  FILE *f;
+  int err_no;
+
+  if (stat(path, &st) < 0 || (f = fopen(path, "rb")) == NULL)
+    return NULL;
+
+  *len = st.st_size;
+  addr = (char *) Malloc(*len + 1);
+  if (fread(addr, 1, *len, f) != (size_t) *len)
+    {
+      err_no = (ferror(f)) ? errno : EIO;
+      fclose(f);
+      Free(addr);
+      errno = err_no;
+      return NULL;
+    }
+  fclose(f);
+#endif
+
+  return addr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_UNMAP_FILE                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Unmap_File(char *addr, PlLong len)
+{
+#ifdef USE_MMAP_FOR_DYN_DB
+  if (len > 0)
+    {
+      munmap(addr, len);
+      return;
+    }
+#endif
+
+  Free(addr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_CHECK_RECORD                                                         *
+ *                                                                         *
+ * Checks a record (at least min_size words of term) ending before end.   *
+ * Returns its size (in words) or -1 if the file is corrupted.            *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Db_Check_Record(WamWord *rec, WamWord *end, int min_size, int nb_atom)
+{
+  WamWord *code;
+  unsigned char *kind;
+  PlLong size, bc_size, i, w;
+  int arity;
+
+  if (end - rec < 4)
+    return -1;
+
+  size = rec[0];
+  bc_size = rec[3];
+  if (size < min_size || size > end - rec - 4 ||
+      bc_size < 0 || bc_size > (end - rec) * (PlLong) (sizeof(WamWord) / sizeof(unsigned)) ||
+      Db_Rec_Size(size, bc_size) > end - rec ||
+      rec[2] < -1 || rec[2] >= nb_atom)
+    return -1;
+
+  code = rec + 4;
+  kind = (unsigned char *) (code + size);
+  for (i = 0; i < size; i++)
+    {
+      w = code[i];
+      switch (kind[i])
+	{
+	case DB_RAW:
+	  break;
+
+	case DB_ATM:
+	  if ((PlULong) w >= (PlULong) nb_atom)
+	    return -1;
+	  break;
+
+	case DB_FCT:
+	  arity = Arity_Of(w);
+	  if (Functor_Of(w) >= nb_atom || arity < 1 || arity > MAX_ARITY)
+	    return -1;
+	  break;
+
+	case DB_REF:
+	case DB_LST:
+	case DB_STC:
+	case DB_FLT:
+	  if ((PlULong) w >= (PlULong) size)
+	    return -1;
+	  break;
+
+	default:
+	  return -1;
+	}
+    }
+
+  return Db_Rec_Size(size, bc_size);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_CHECK_CLAUSES                                                        *
+ *                                                                         *
+ * Checks the clauses of a predicate entry. Returns the size of the block  *
+ * needed to load them or -1 if the file is corrupted.                     *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Db_Check_Clauses(DynDbPred *tp, char *addr, PlLong len, int nb_atom)
+{
+  WamWord *rec, *end;
+  PlLong rec_size;
+  PlLong nb_clause = 0;
+  PlLong block_size = sizeof(DynBlock);
+
+  if (tp->size < 0 || tp->nb_clause < 0 || tp->offset < 0 ||
+      tp->offset % sizeof(WamWord) != 0 ||
+      tp->offset > len || tp->size > (len - tp->offset) / (PlLong) sizeof(WamWord))
+    return -1;
+
+  rec = (WamWord *) (addr + tp->offset);
+  end = rec + tp->size;
+  while (rec < end)
+    {
+      if ((rec_size = Db_Check_Record(rec, end, 3, nb_atom)) < 0 ||
+	  rec[1] < DYN_CLAUSE_RULE || rec[1] > DYN_CLAUSE_GROUND_FACT)
+	return -1;
+
+      block_size += Dyn_Clause_Size(rec[0]);
+      nb_clause++;
+      rec += rec_size;
+    }
+
+  return (nb_clause == tp->nb_clause) ? block_size : -1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_RELOCATE_BYTE_CODE                                                   *
+ *                                                                         *
+ * Relocates the byte-code of the clauses of a (checked) predicate entry   *
+ * in bc_tbl. Returns FALSE if a byte-code is corrupted.                   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Db_Relocate_Byte_Code(DynDbPred *tp, char *addr, unsigned **bc_tbl)
+{
+  WamWord *rec;
+  PlLong n;
+  int size;
+
+  rec = (WamWord *) (addr + tp->offset);
+  for (n = 0; n < tp->nb_clause; n++)
+    {
+      size = (int) rec[0];
+      if (rec[3] > 0 &&
+	  (bc_tbl[n] = (*db_bc_fct) ((unsigned *) (rec + 4 + size + Db_Kind_Words(size)),
+				     (int) rec[3], Db_Atom_Of_Index, FALSE,
+				     db_atom_map[tp->func], tp->arity)) == NULL)
+	return FALSE;
+
+      rec += Db_Rec_Size(size, rec[3]);
+    }
+
+  return TRUE;
+}
 
-  *arity = scan->owner_arity;
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_PRESIZE_TABLE                                                        *
+ *                                                                         *
+ * Ensures a first argument hash table can receive nb_key new keys without *
+ * being extended.                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Presize_Table(char **p_htbl, PlLong nb_key)
+{
+  int size;
+
+  if (nb_key == 0)
+    return;
+
+  if (*p_htbl == NULL)
+    {
+      size = START_DYNAMIC_SWT_SIZE;
+      while (size <= nb_key)
+	size *= 2;
+      *p_htbl = Pl_Hash_Alloc_Table(size, sizeof(DSwtInf));
+      return;
+    }
+
+  size = Pl_Hash_Table_Size(*p_htbl);
+  if (Pl_Hash_Nb_Elements(*p_htbl) + nb_key < size)
+    return;
+
+  while (size <= Pl_Hash_Nb_Elements(*p_htbl) + nb_key)
+    size *= 2;
+  *p_htbl = Pl_Hash_Realloc_Table(*p_htbl, size);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_DECODE_TERM                                                          *
+ *                                                                         *
+ * Relocates the term of a (checked) record at dst.                        *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Decode_Term(WamWord *dst, WamWord *rec)
+{
+  WamWord *code;
+  unsigned char *kind;
+  PlLong i, w, size;
+
+  size = rec[0];
+  code = rec + 4;
+  kind = (unsigned char *) (code + size);
+
+  for (i = 0; i < size; i++)
+    {
+      w = code[i];
+      switch (kind[i])
+	{
+	case DB_RAW:
+	  dst[i] = w;
+	  break;
+
+	case DB_ATM:
+	  dst[i] = Tag_ATM(db_atom_map[w]);
+	  break;
+
+	case DB_FCT:
+	  dst[i] = Functor_Arity(db_atom_map[Functor_Of(w)], Arity_Of(w));
+	  break;
+
+	case DB_REF:
+	  dst[i] = Tag_REF(dst + w);
+	  break;
+
+	case DB_LST:
+	  dst[i] = Tag_LST(dst + w);
+	  break;
+
+	case DB_STC:
+	  dst[i] = Tag_STC(dst + w);
+	  break;
+
+	case DB_FLT:
+	  dst[i] = Tag_FLT(dst + w);
+	  break;
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_DEFINE_PRED                                                          *
+ *                                                                         *
+ * (Re)defines a predicate of a saved program as consult/1 does (its      *
+ * clauses are removed unless they are compiled, see DB_PRED_APPEND).     *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Define_Pred(DynDbPred *tp)
+{
+  int func = db_atom_map[tp->func];
+  int pl_file = (tp->pl_file >= 0) ? db_atom_map[tp->pl_file] : pl_atom_user_input;
+  int prop = tp->prop & ~MASK_PRED_NATIVE_CODE;
+  PredInf *pred;
+
+  if (tp->flags & DB_PRED_APPEND)
+    pred = Pl_Lookup_Pred(func, tp->arity);
+  else
+    pred = Pl_Update_Dynamic_Pred(func, tp->arity, 0, -1);
+
+  if (pred == NULL)
+    Pl_Create_Pred(func, tp->arity, pl_file, tp->pl_line, prop, NULL);
+  else if (!(tp->flags & DB_PRED_APPEND))
+    {
+      pred->pl_file = pl_file;
+      pred->pl_line = tp->pl_line;
+      pred->prop = prop;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_LOAD_CLAUSES                                                         *
+ *                                                                         *
+ * Relocates the clauses of a (checked) predicate entry in a new block and *
+ * adds them at the end of the predicate. bc_tbl gives their byte-code    *
+ * (or NULL if none).                                                      *
+ *-------------------------------------------------------------------------*/
+static void
+Db_Load_Clauses(DynPInf *dyn, DynDbPred *tp, char *addr, PlLong block_size,
+		unsigned **bc_tbl)
+{
+  DynBlock *block;
+  DynCInf *clause;
+  WamWord *rec;
+  WamWord *first_arg_adr;
+  PlLong n;
+  int size, func, arity;
+  int index_no;
+  PlLong key = 0;		/* init for the compiler */
+
+  block = (DynBlock *) Malloc(block_size);
+  block->nb_alive = tp->nb_clause;
+
+  clause = (DynCInf *) (block + 1);
+  rec = (WamWord *) (addr + tp->offset);
+  for (n = 0; n < tp->nb_clause; n++)
+    {
+      size = (int) rec[0];
+      Db_Decode_Term(&clause->term_word, rec);
+
+      clause->block = block;
+      Add_To_2Chain(&dyn->seq_chain, clause, TRUE, FALSE);
+
+      clause->dyn = dyn;
+      clause->cl_no = dyn->count_z++;
+      clause->pl_file = (rec[2] >= 0) ? db_atom_map[rec[2]] : -1;
+      clause->erase_stamp = DYN_STAMP_ALIVE;
+      clause->next_erased_cl = NULL;
+      clause->byte_code = (bc_tbl) ? bc_tbl[n] : NULL;
+      clause->kind = (int) rec[1];
+      clause->term_size = size;
+
+      first_arg_adr = Pl_Rd_Callable(clause->head_word, &func, &arity);
+      index_no = (dyn->arity) ? Index_From_First_Arg(*first_arg_adr, &key) : NO_INDEX;
+      Link_Clause(dyn, clause, first_arg_adr, index_no, key, FALSE);
+
+      clause = (DynCInf *) ((char *) clause + Dyn_Clause_Size(size));
+      rec += Db_Rec_Size(size, rec[3]);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOAD_DYNAMIC_DB                                                      *
+ *                                                                         *
+ * Loads a file created by Pl_Save_Dynamic_Db. The clauses are added at    *
+ * the end of their predicates (created as dynamic if needed). Returns the *
+ * number of loaded clauses or an error (nothing is then loaded):          *
+ *    DYN_DB_OS_ERROR   : cannot read the file (see errno)                 *
+ *    DYN_DB_BAD_FILE   : not a dynamic db file (or incompatible)          *
+ *    DYN_DB_STATIC_PRED: a predicate is static (func/arity are set)       *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Load_Dynamic_Db(char *path, int *func, int *arity)
+{
+  PlLong ret;
+
+  Pl_Lock_Acquire(pl_pred_lock);
+  db_bc_fct = NULL;
+  ret = Db_Load(path, DYN_DB_MAGIC, func, arity, NULL);
+  Pl_Lock_Release(pl_pred_lock);
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOAD_PROGRAM                                                         *
+ *                                                                         *
+ * Loads a file created by Pl_Save_Program. Each predicate of the file    *
+ * replaces the current one (if any) except the predicates of the         *
+ * executable in native code which are kept. The byte-code is relocated  *
+ * by bc_fct and the goal term is created on the heap (*goal_word).       *
+ * Returns the number of loaded clauses or an error (nothing is then      *
+ * loaded): DYN_DB_OS_ERROR or DYN_DB_BAD_FILE (see Pl_Load_Dynamic_Db).   *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Load_Program(char *path, WamWord *goal_word, DynBCFct bc_fct)
+{
+  PlLong ret;
+
+  Pl_Lock_Acquire(pl_pred_lock);
+  db_bc_fct = bc_fct;
+  ret = Db_Load(path, DYN_PROG_MAGIC, NULL, NULL, goal_word);
+  Pl_Lock_Release(pl_pred_lock);
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DB_LOAD                                                                 *
+ *                                                                         *
+ * Everything is checked (and the byte-code relocated) before modifying   *
+ * any predicate. A predicate whose block size is < 0 is ignored.         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Db_Load(char *path, char *magic, int *func, int *arity, WamWord *goal_word)
+{
+  char *addr, *name, *end;
+  PlLong len;
+  DynDbHdr *hdr;
+  DynDbPred *tpred, *tp;
+  PlLong *block_size = NULL;
+  unsigned **bc_tbl = NULL;
+  PlLong *bc_start = NULL;
+  WamWord *goal_rec = NULL;
+  PredInf *pred;
+  DynPInf *dyn;
+  PlLong nb_clause = DYN_DB_BAD_FILE;
+  PlLong nb_bc = 0, k;
+  int i, f;
+
+  if ((addr = Db_Map_File(path, &len)) == NULL)
+    return DYN_DB_OS_ERROR;
+
+  db_atom_map = NULL;
+  hdr = (DynDbHdr *) addr;
+  if (len < (PlLong) sizeof(DynDbHdr) ||
+      strncmp(hdr->magic, magic, sizeof(hdr->magic)) != 0 ||
+      strncmp(hdr->prolog_version, PROLOG_VERSION, sizeof(hdr->prolog_version) - 1) != 0 ||
+      hdr->version != DYN_DB_VERSION || hdr->word_size != sizeof(WamWord) ||
+      hdr->atom_max_bits != ATOM_MAX_BITS ||
+      hdr->nb_atom < 0 || hdr->nb_pred < 0 || hdr->atom_size < 0 ||
+      hdr->atom_size % sizeof(WamWord) != 0 ||
+      hdr->atom_size > len - (PlLong) sizeof(DynDbHdr) ||
+      hdr->nb_pred > (len - (PlLong) sizeof(DynDbHdr) - hdr->atom_size) /
+      (PlLong) sizeof(DynDbPred) ||
+      hdr->goal_offset < 0 || hdr->goal_offset > len ||
+      hdr->goal_offset % sizeof(WamWord) != 0 ||
+      (hdr->goal_offset != 0) != (goal_word != NULL))
+    goto finish;
+
+				/* atoms */
+  db_atom_map = (int *) Malloc((hdr->nb_atom + 1) * sizeof(int));
+  db_map_nb_atom = hdr->nb_atom;
+  name = addr + sizeof(DynDbHdr);
+  end = name + hdr->atom_size;
+  for (i = 0; i < hdr->nb_atom; i++)
+    {
+      if (memchr(name, '\0', end - name) == NULL)
+	goto finish;
+      db_atom_map[i] = Pl_Create_Collectable_Atom(name);
+      name += strlen(name) + 1;
+    }
+
+				/* predicates: check all before loading */
+  tpred = (DynDbPred *) end;
+  block_size = (PlLong *) Malloc((hdr->nb_pred + 1) * sizeof(PlLong));
+  bc_start = (PlLong *) Malloc((hdr->nb_pred + 1) * sizeof(PlLong));
+  for (i = 0, tp = tpred; i < hdr->nb_pred; i++, tp++)
+    {
+      if (tp->func < 0 || tp->func >= hdr->nb_atom ||
+	  tp->arity < 0 || tp->arity > MAX_ARITY ||
+	  tp->pl_file < -1 || tp->pl_file >= hdr->nb_atom ||
+	  (block_size[i] = Db_Check_Clauses(tp, addr, len, hdr->nb_atom)) < 0)
+	goto finish;
+
+      bc_start[i] = nb_bc;
+      f = db_atom_map[tp->func];
+      pred = Pl_Lookup_Pred(f, tp->arity);
+      if (db_bc_fct == NULL)
+	{
+	  if (pred != NULL && !(pred->prop & MASK_PRED_DYNAMIC))
+	    {
+	      *func = f;
+	      *arity = tp->arity;
+	      nb_clause = DYN_DB_STATIC_PRED;
+	      goto finish;
+	    }
+	}
+      else if (pred != NULL && (pred->prop & MASK_PRED_NATIVE_CODE))
+	block_size[i] = -1;	/* native code of the executable: kept */
+      else
+	nb_bc += tp->nb_clause;
+    }
+
+  if (goal_word)
+    {
+      goal_rec = (WamWord *) (addr + hdr->goal_offset);
+      if (Db_Check_Record(goal_rec, (WamWord *) (addr + len), 1, hdr->nb_atom) < 0)
+	goto finish;
+    }
+
+  if (db_bc_fct)		/* relocate the byte-code */
+    {
+      bc_tbl = (unsigned **) Calloc(nb_bc + 1, sizeof(unsigned *));
+      for (i = 0, tp = tpred; i < hdr->nb_pred; i++, tp++)
+	if (block_size[i] >= 0 &&
+	    !Db_Relocate_Byte_Code(tp, addr, bc_tbl + bc_start[i]))
+	  {
+	    for (k = 0; k < nb_bc; k++)
+	      if (bc_tbl[k])
+		BC_Free_Byte_Code(bc_tbl[k]);
+	    goto finish;
+	  }
+    }
+
+  nb_clause = 0;
+  for (i = 0, tp = tpred; i < hdr->nb_pred; i++, tp++)
+    {
+      if (block_size[i] < 0)
+	continue;
+
+      if (db_bc_fct)
+	Db_Define_Pred(tp);
+
+      dyn = Get_Dyn_Info(db_atom_map[tp->func], tp->arity, FALSE);
+
+      Db_Presize_Table(&dyn->atm_htbl, tp->nb_key[0]);
+      Db_Presize_Table(&dyn->int_htbl, tp->nb_key[1]);
+      Db_Presize_Table(&dyn->stc_htbl, tp->nb_key[2]);
+
+      if (tp->nb_clause > 0)
+	Db_Load_Clauses(dyn, tp, addr, block_size[i],
+			(bc_tbl) ? bc_tbl + bc_start[i] : NULL);
+
+      nb_clause += tp->nb_clause;
+    }
+
+  if (goal_word)
+    {
+      Db_Decode_Term(H, goal_rec);
+      *goal_word = *H;
+      H += goal_rec[0];
+    }
+
+ finish:
+  if (db_atom_map)
+    Free(db_atom_map);
+  if (block_size)
+    Free(block_size);
+  if (bc_start)
+    Free(bc_start);
+  if (bc_tbl)
+    Free(bc_tbl);
+  Db_Unmap_File(addr, len);
+
+  return nb_clause;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_COPY_CLAUSE_TO_HEAP                                                  *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Copy_Clause_To_Heap(DynCInf *clause, WamWord *head_word, WamWord *body_word)
+{
+  MPROBE_CLAUSE(clause);
+
+  Pl_Copy_Contiguous_Term(H, &clause->term_word);	/* *H=<LST,H+1> */
+  *head_word = H[1];
+  *body_word = H[2];
+  H += clause->term_size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GET_SCAN_CHOICE_POINT                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static DynScan *
+Get_Scan_Choice_Point(WamWord *b)
+{
+  DynScan *scan;
+  int i;
+
+  if (ALTB(b) != (CodePtr) Prolog_Predicate(SCAN_DYN_TEST_ALT, 0) &&
+      ALTB(b) != (CodePtr) Prolog_Predicate(SCAN_DYN_JUMP_ALT, 0))
+    return NULL;
+
+  i = DYNSCAN_SIZE - 1;
+  scan = (DynScan *) &AB(b, i);
+
+  return scan;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_SCAN_CHOICE_POINT_PRED                                               *
+ *                                                                         *
+ * returns the functor and initializes the arity of the scan choice point b*
+ * or -1 if b is not a scan choice point.                                  *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Scan_Choice_Point_Pred(WamWord *b, int *arity)
+{
+  DynScan *scan;
+
+  scan = Get_Scan_Choice_Point(b);
+  if (scan == NULL)
+    return -1;
+
+  *arity = scan->owner_arity;
 
   return scan->owner_func;
 }
@@ -1184,8 +3197,6 @@ Pl_Scan_Choice_Point_Pred(WamWord *b, int *arity)
 static void
 Clean_Erased_Clauses(void)
 {
-  WamWord *b, *base;
-  DynScan *scan;
   DynPInf *dyn, *dyn1, **p_last_dyn;
   DynCInf *clause, *clause1;
  
@@ -1193,6 +3204,9 @@ Clean_Erased_Clauses(void)
       longest_skip_erased < MAX_SKIP_BEFORE_CLEAN)
     return;
 
+  if (!Pl_Engine_Exclusive_Begin())	/* other engines running: retry later */
+    return;
+
 #if DEBUG_LEVEL >= 3
   DBGPRINTF("/// GC-DYN-ERASE: recoverable nb of clauses: %d\n", nb_erased_clauses);
 #endif
@@ -1204,27 +3218,10 @@ Clean_Erased_Clauses(void)
 
   /* GC-clauses: mark and clean */
 
-  /* Traverse all choice-points from top to bottom
+  /* Traverse all choice-points (of all engines) from top to bottom
    * marking those corresponding to a dyn scan (thus in use) */
-  base = Local_Stack;
-  for (b = B; b > base; b = BB(b))
-    {
-      scan = Get_Scan_Choice_Point(b);
-      if (scan == NULL)
-	{
-#if DEBUG_LEVEL >= 5
-	  DBGPRINTF("GC-DYN-ERASE: chc-point other\n");
-#endif
-	  continue;
-	}
-
-      dyn = scan->dyn;
-#if DEBUG_LEVEL >= 4
-      Print_Scan_Info("GC-DYN-ERASE: chc-point mark scan", scan);
-#endif
-      if (dyn->first_erased_cl)	/* has erased clause but is scanned: mark it */
-	MARK_AS_KEEP(dyn);
-    }
+  Mark_Scanned_Dyn(NULL);
+  Pl_Engine_Map_Detached(Mark_Scanned_Dyn, NULL);
 
   p_last_dyn = &first_dyn_with_erase;
   for (dyn = first_dyn_with_erase; dyn; dyn = dyn1)
@@ -1261,6 +3258,8 @@ Clean_Erased_Clauses(void)
 	  if (dyn->stc_htbl)
 	    Pl_Hash_Free_Table(dyn->stc_htbl);
 
+	  Jit_Free_All_Indexes(dyn);
+
 	  Free(dyn);		/* has been re-allocated if needed, so it is safe to free */
 	  continue;
 	}
@@ -1295,6 +3294,7 @@ Clean_Erased_Clauses(void)
     }
 
   longest_skip_erased = 0;
+  Pl_Engine_Exclusive_End();
   
 #if DEBUG_LEVEL >= 3
   DBGPRINTF("\\\\\\ GC-DYN-ERASE: remaining recoverable clauses: %d\n", nb_erased_clauses);
@@ -1304,6 +3304,43 @@ Clean_Erased_Clauses(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * MARK_SCANNED_DYN                                                        *
+ *                                                                         *
+ * Mark the dyn with erased clauses scanned by a choice-point of the       *
+ * current engine (see Clean_Erased_Clauses).                              *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Scanned_Dyn(void *arg)
+{
+  WamWord *b, *base;
+  DynScan *scan;
+  DynPInf *dyn;
+
+  base = Local_Stack;
+  for (b = B; b > base; b = BB(b))
+    {
+      scan = Get_Scan_Choice_Point(b);
+      if (scan == NULL)
+	{
+#if DEBUG_LEVEL >= 5
+	  DBGPRINTF("GC-DYN-ERASE: chc-point other\n");
+#endif
+	  continue;
+	}
+
+      dyn = scan->dyn;
+#if DEBUG_LEVEL >= 4
+      Print_Scan_Info("GC-DYN-ERASE: chc-point mark scan", scan);
+#endif
+      if (dyn->first_erased_cl)	/* has erased clause but is scanned: mark it */
+	MARK_AS_KEEP(dyn);
+    }
+}
+
+
+
+
 #if DEBUG_LEVEL != 0
 
 /*-------------------------------------------------------------------------*
@@ -1315,7 +3352,7 @@ void
 Print_Dynamic_Clause(const char *msg, DynCInf *clause)
 {
   
-  MPROBE_PTR("clause", clause);	      
+  MPROBE_CLAUSE(clause);	      
   MPROBE_PTR("dyn", clause->dyn);
   
   DBGPRINTF("%s %p  %s/%d  no: %d  size: %d", msg, clause,
@@ -50,6 +50,17 @@
 #define DYN_ALT_FCT_FOR_TEST       0
 #define DYN_ALT_FCT_FOR_JUMP       1
 
+#define DYN_JIT_MAX_ARGS           8
+
+#define DYN_CLAUSE_RULE            0
+#define DYN_CLAUSE_FACT            1
+#define DYN_CLAUSE_GROUND_FACT     2
+
+				/* Pl_Save/Load_Dynamic_Db errors */
+#define DYN_DB_OS_ERROR            -1 /* see errno */
+#define DYN_DB_BAD_FILE            -2 /* not a (compatible) db file */
+#define DYN_DB_STATIC_PRED         -3 /* a pred of the file is static */
+
 
 
 
@@ -63,8 +74,19 @@ typedef struct dynpinf DynPInf;
 
 typedef struct dyncinf DynCInf;
 
+typedef struct dynjitidx DynJitIdx;
+
+typedef struct dynjitcell DynJitCell;
+
+typedef struct dynblock DynBlock;
+
 typedef PlLong (*ScanFct) (DynCInf *clause, WamWord *alt_ino, Bool is_last);
 
+	/* relocates a byte-code of pred func/arity (see bc_supp.c) */
+typedef unsigned *(*DynBCFct) (unsigned *byte_code, int size,
+			       int (*map_atom) (int atom), Bool to_file,
+			       int func, int arity);
+
 typedef struct			/* Double-linked chain header    */
 {				/* ----------------------------- */
   DynCInf *first;		/* first clause (or NULL)        */
@@ -82,6 +104,44 @@ typedef struct			/* Double-linked chain cell      */
 }D2ChCell;
 
 
+typedef struct			/* JIT index chain header         */
+{				/* ------------------------------ */
+  DynJitCell *first;		/* first cell (or NULL)           */
+  DynJitCell *last;		/* last  cell (or NULL)           */
+}DJitHdr;
+
+
+struct dynjitcell		/* JIT index cell (1 per clause)  */
+{				/* ------------------------------ */
+  DynJitCell *next;		/* next     cell in the chain     */
+  DynJitCell *prev;		/* previous cell in the chain     */
+  DynCInf *clause;		/* associated clause              */
+  DynJitCell *next_of_clause;	/* next cell of the same clause   */
+  DJitHdr *hdr;			/* back ptr to the chain header   */
+  DynJitIdx *idx;		/* back ptr to the index          */
+};
+
+
+typedef struct			/* JIT index switch item info     */
+{				/* ------------------------------ */
+  PlLong key;			/* key: combination of arg keys   */
+  DJitHdr chain;		/* chain of the clauses           */
+}
+DJitSwtInf;
+
+
+struct dynjitidx		/* JIT index information          */
+{				/* ------------------------------ */
+  DynJitIdx *next;		/* next index of the predicate    */
+  int nb_arg;			/* number of indexed arguments    */
+  int arg_no[DYN_JIT_MAX_ARGS];	/* indexed arg positions (from 0) */
+  Bool declared;		/* from dynamic_index/1 (kept)    */
+  Bool used;			/* used since last check ?        */
+  char *htbl;			/* hash table: key -> chain       */
+  DJitHdr var_chain;		/* clauses with an unindexable arg*/
+};
+
+
 struct dyncinf			/* Dynamic clause information     */
 {				/* ------------------------------ */
   D2ChCell seq_chain;		/* sequential chain               */
@@ -89,11 +149,14 @@ struct dyncinf			/* Dynamic clause information     */
   DynPInf *dyn;			/* back ptr to associated dyn inf */
   D2ChHdr *p_ind_hdr;		/* back ptr to ind_chain header   */
   char **p_ind_htbl;		/* back ptr to ind htbl (or NULL) */
+  DynJitCell *jit_cells;	/* cells in JIT indexes (or NULL) */
+  DynBlock *block;		/* shared block (NULL=Malloc'ed)  */
   int cl_no;			/* clause number                  */
   int pl_file;			/* file name of its def (or -1)   */
   DynStamp erase_stamp;		/* erase stamp or FFF...F if not  */
   DynCInf *next_erased_cl;	/* pointer to next erased clause  */
   unsigned *byte_code;		/* bc pointer (NULL=interpreted)  */
+  int kind;			/* DYN_CLAUSE_RULE/FACT/GROUND... */
   int term_size;		/* size of the term of the clause */
   WamWord term_word;		/* clause [Head|Body]=<LST,adr+1> */
   WamWord head_word;		/* adr+1 = Car = clause term Head */
@@ -122,6 +185,8 @@ struct dynpinf			/* Dynamic predicate information  */
   int arity;			/* arity (redundant but faster)   */
   int count_a;			/* next clause no for asserta, < 0*/
   int count_z;			/* next clause no for assertz, >=0*/
+  DynJitIdx *jit_idx;		/* JIT indexes (other args)       */
+  int jit_clock;		/* scans+adds since last JIT check*/
 				/* ------- LDUV handling -------- */
   DynStamp curr_stamp;		/* erase stamp or FFF...F if not  */
   DynCInf *first_erased_cl;	/* 1st erased clause, NULL if none*/
@@ -144,13 +209,24 @@ DynCInf *Pl_Add_Dynamic_Clause(WamWord head_word, WamWord body_word,
 
 void Pl_Delete_Dynamic_Clause(DynCInf *clause);
 
+PlLong Pl_Save_Dynamic_Db(char *path, int nb_pred, int *func, int *arity);
+
+PlLong Pl_Load_Dynamic_Db(char *path, int *func, int *arity);
+
+PlLong Pl_Save_Program(char *path, int nb_pred, int *func, int *arity,
+		       WamWord goal_word, DynBCFct bc_fct);
+
+PlLong Pl_Load_Program(char *path, WamWord *goal_word, DynBCFct bc_fct);
+
 PredInf *Pl_Update_Dynamic_Pred(int func, int arity, int what_to_do, int pl_file_for_multi);
 
 DynCInf *Pl_Scan_Dynamic_Pred(int owner_func, int owner_arity,
-			      DynPInf *dyn, WamWord first_arg_word,
+			      DynPInf *dyn, WamWord *arg_adr,
 			      ScanFct alt_fct, int alt_fct_type,
 			      int alt_info_size, WamWord *alt_info);
 
+void Pl_Declare_Dynamic_Index(int func, int arity, int nb_arg, int *arg_no);
+
 void Pl_Copy_Clause_To_Heap(DynCInf *clause, WamWord *head_word, WamWord *body_word);
 
 int Pl_Scan_Choice_Point_Pred(WamWord *b, int *arity);
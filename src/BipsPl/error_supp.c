@@ -61,17 +61,17 @@
  * Global Variables                *
  *---------------------------------*/
 
-static int cur_bip_func;
-static int cur_bip_arity;
+static PL_THREAD_LOCAL int cur_bip_func;
+static PL_THREAD_LOCAL int cur_bip_arity;
 
-static char *c_bip_func_str;
-static int c_bip_arity;
+static PL_THREAD_LOCAL char *c_bip_func_str;
+static PL_THREAD_LOCAL int c_bip_arity;
 
 
-static char *last_err_file = NULL;
-static PlLong last_err_line;
-static PlLong last_err_col;
-static char *last_err_msg;
+static PL_THREAD_LOCAL char *last_err_file = NULL;
+static PL_THREAD_LOCAL PlLong last_err_line;
+static PL_THREAD_LOCAL PlLong last_err_col;
+static PL_THREAD_LOCAL char *last_err_msg;
 
 
 
@@ -84,6 +84,8 @@ static void Update_Cur_From_C_Bip(void);
 
 static char *Context_Error_String(void);
 
+static void Atom_GC_Roots(void);
+
 
 
 #define PL_ERR_INSTANTIATION       X1_24706C5F6572725F696E7374616E74696174696F6E
@@ -132,6 +134,16 @@ Prolog_Prototype(PL_ERR_SYSTEM, 1);
 static void
 Error_Supp_Initializer(void)
 {
+  Pl_Engine_Add_Context(&cur_bip_func, sizeof(cur_bip_func));
+  Pl_Engine_Add_Context(&cur_bip_arity, sizeof(cur_bip_arity));
+  Pl_Engine_Add_Context(&c_bip_func_str, sizeof(c_bip_func_str));
+  Pl_Engine_Add_Context(&c_bip_arity, sizeof(c_bip_arity));
+  Pl_Engine_Add_Context(&last_err_file, sizeof(last_err_file));
+  Pl_Engine_Add_Context(&last_err_line, sizeof(last_err_line));
+  Pl_Engine_Add_Context(&last_err_col, sizeof(last_err_col));
+  Pl_Engine_Add_Context(&last_err_msg, sizeof(last_err_msg));
+  Pl_Atom_GC_Add_Engine_Root_Fct(Atom_GC_Roots);
+
   pl_type_atom = Pl_Create_Atom("atom");
   pl_type_atomic = Pl_Create_Atom("atomic");
   pl_type_byte = Pl_Create_Atom("byte");
@@ -190,6 +202,7 @@ Error_Supp_Initializer(void)
   pl_domain_date_time = Pl_Create_Atom("date_time");/* for os_interf */
   pl_domain_selectable_item = Pl_Create_Atom("selectable_item");
 				/* for select_read/3 */
+  pl_domain_poll_event = Pl_Create_Atom("poll_event"); /* for pollers */
 #ifndef NO_USE_SOCKETS
   pl_domain_socket_domain = Pl_Create_Atom("socket_domain"); /* for sockets */
   pl_domain_socket_address = Pl_Create_Atom("socket_address"); /* for sockets */
@@ -200,6 +213,7 @@ Error_Supp_Initializer(void)
   pl_existence_stream = Pl_Create_Atom("stream");
   pl_existence_sr_descriptor = Pl_Create_Atom("sr_descriptor");
 				/* for source reader */
+  pl_existence_poller = Pl_Create_Atom("poller"); /* for pollers */
 
 
   pl_permission_operation_access = Pl_Create_Atom("access");
@@ -243,6 +257,7 @@ Error_Supp_Initializer(void)
   pl_resource_print_object_not_linked = Pl_Create_Atom("print_object_not_linked");
 				/* for print and format */
   pl_resource_finite_memory = Pl_Create_Atom("finite_memory"); /* e.g. for length(L, L) */
+  pl_resource_would_block = Pl_Create_Atom("would_block"); /* for non-blocking streams */
   if (pl_fd_init_solver)		/* FD solver linked */
     {
       pl_resource_too_big_fd_constraint = Pl_Create_Atom("too_big_fd_constraint");
@@ -252,6 +267,19 @@ Error_Supp_Initializer(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_ROOTS                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Roots(void)
+{
+  Pl_Atom_GC_Mark(cur_bip_func);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_SET_BIP_NAME_2                                                       *
  *                                                                         *
@@ -399,7 +427,7 @@ Pl_Context_Error_1(WamWord err_word)
 static char *
 Context_Error_String(void)
 {
-  static char buff[1024];
+  static PL_THREAD_LOCAL char buff[1024];
 
   if (cur_bip_arity < 0)
     return pl_atom_tbl[cur_bip_func].name;
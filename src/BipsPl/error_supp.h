@@ -102,6 +102,7 @@ int pl_domain_radix;		        	/* for format/2-3 */
 int pl_domain_os_path;				/* for absolute_file_name/2 */
 int pl_domain_os_file_permission;		/* for file_permission/2 */
 int pl_domain_selectable_item;			/* for select_read/3 */
+int pl_domain_poll_event;			/* for pollers */
 int pl_domain_date_time;			/* for os_interf */
 #ifndef NO_USE_SOCKETS
 int pl_domain_socket_domain;			/* for sockets */
@@ -112,6 +113,7 @@ int pl_existence_procedure;
 int pl_existence_source_sink;
 int pl_existence_stream;
 int pl_existence_sr_descriptor;			/* for source reader */
+int pl_existence_poller;			/* for pollers */
 
 int pl_permission_operation_access;
 int pl_permission_operation_close;
@@ -153,6 +155,7 @@ int pl_evaluation_zero_divisor;
 int pl_resource_print_object_not_linked; 	/* for print and format */
 int pl_resource_finite_memory;			/* e.g. for length(L, L) */
 int pl_resource_too_big_fd_constraint; 		/* for FD */
+int pl_resource_would_block;			/* for non-blocking streams */
 
 
 #else
@@ -209,6 +212,7 @@ extern int pl_domain_radix;			/* for format/2-3 */
 extern int pl_domain_os_path;			/* for absolute_file_name/2 */
 extern int pl_domain_os_file_permission; 	/* for file_permission/2 */
 extern int pl_domain_selectable_item; 		/* for select_read/3 */
+extern int pl_domain_poll_event;		/* for pollers */
 extern int pl_domain_date_time;			/* for os_interf */
 #ifndef NO_USE_SOCKETS
 extern int pl_domain_socket_domain; 		/* for sockets */
@@ -220,6 +224,7 @@ extern int pl_existence_procedure;
 extern int pl_existence_source_sink;
 extern int pl_existence_stream;
 extern int pl_existence_sr_descriptor; 		/* for source reader */
+extern int pl_existence_poller;			/* for pollers */
 
 
 extern int pl_permission_operation_access;
@@ -263,6 +268,7 @@ extern int pl_evaluation_zero_divisor;
 extern int pl_resource_finite_memory;		/* e.g. for length(L, L) */
 extern int pl_resource_print_object_not_linked; /* for print and format */
 extern int pl_resource_too_big_fd_constraint; 	/* for FD */
+extern int pl_resource_would_block;		/* for non-blocking streams */
 
 #endif
 
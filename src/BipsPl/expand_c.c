@@ -63,8 +63,8 @@
  * Global Variables                *
  *---------------------------------*/
 
-static WamWord *top;
-static Bool opt_term_unif;
+static PL_THREAD_LOCAL WamWord *top;
+static PL_THREAD_LOCAL Bool opt_term_unif;
 
 /* opt_term_unif: can we optimize equality between an in/out var and terminals ? */
 
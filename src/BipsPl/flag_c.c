@@ -105,6 +105,9 @@ static int atom_silent;
 static int atom_normal;
 static int atom_informational;
 
+static PL_THREAD_LOCAL WamWord *sys_var_copy[MAX_SYS_VARS]; /* copies done by sys_var_put */
+static PL_THREAD_LOCAL int sys_var_copy_size[MAX_SYS_VARS];
+
 
 
 
@@ -120,6 +123,8 @@ static Bool Fct_Chk_Version_Data(FlagInf *flag, WamWord tag_mask, WamWord value_
 static WamWord Fct_Get_Argv(FlagInf *flag);
 static Bool Fct_Chk_Argv(FlagInf *flag, WamWord tag_mask, WamWord value_word);
 
+static void Atom_GC_Roots(void);
+
 
 
 
@@ -167,6 +172,11 @@ Flag_Initializer(void)
   atom_normal = Pl_Create_Atom("normal");
   atom_informational = Pl_Create_Atom("informational");
 
+  Pl_Engine_Add_Context(pl_sys_var, sizeof(pl_sys_var));
+  Pl_Engine_Add_Context(sys_var_copy, sizeof(sys_var_copy));
+  Pl_Engine_Add_Context(sys_var_copy_size, sizeof(sys_var_copy_size));
+  Pl_Atom_GC_Add_Engine_Root_Fct(Atom_GC_Roots);
+
   /* Unchangeable flags */
 
   NEW_FLAG_R_ATOM    (prolog_name,               PROLOG_NAME);
@@ -488,6 +498,30 @@ Pl_Sys_Var_Put_2(WamWord var_word, WamWord term_word)
   adr = (WamWord *) Malloc(size * sizeof(WamWord));	/* recovered at next sys_var_put */
   Pl_Copy_Term(adr, &word);
   pl_sys_var[sv] = Tag_REF(adr);
+  sys_var_copy[sv] = adr;
+  sys_var_copy_size[sv] = size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_ROOTS                                                           *
+ *                                                                         *
+ * Mark the atoms of the system variables (e.g. the ball of an exception). *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Roots(void)
+{
+  int sv;
+
+  for (sv = 0; sv < MAX_SYS_VARS; sv++)
+    {
+      if (sys_var_copy[sv] != NULL && pl_sys_var[sv] == Tag_REF(sys_var_copy[sv]))
+	Pl_Atom_GC_Mark_Words(sys_var_copy[sv], sys_var_copy_size[sv]);
+      else
+	Pl_Atom_GC_Mark_Words((WamWord *) &pl_sys_var[sv], 1);
+    }
 }
 
 
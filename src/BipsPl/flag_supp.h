@@ -192,7 +192,7 @@ FlagInf *Pl_New_Prolog_Flag(char *name, Bool modifiable, FlagType type, PlLong v
 
 #ifdef FLAG_C_FILE
 
-PlLong pl_sys_var[MAX_SYS_VARS];
+PL_THREAD_LOCAL PlLong pl_sys_var[MAX_SYS_VARS]; /* private to each engine */
 
 FlagInf *pl_flag_back_quotes;
 FlagInf *pl_flag_char_conversion;
@@ -211,7 +211,7 @@ FlagInf *pl_flag_unknown;
 
 #else
 
-extern PlLong pl_sys_var[];
+extern PL_THREAD_LOCAL PlLong pl_sys_var[];
 
 extern FlagInf *pl_flag_back_quotes;
 extern FlagInf *pl_flag_char_conversion;
@@ -65,22 +65,24 @@
  * Global Variables                *
  *---------------------------------*/
 
-PlLong pl_foreign_long[NB_OF_X_REGS];
-double pl_foreign_double[NB_OF_X_REGS];
+PL_THREAD_LOCAL PlLong pl_foreign_long[NB_OF_X_REGS]; /* see Ma2Asm */
+PL_THREAD_LOCAL double pl_foreign_double[NB_OF_X_REGS];
 
+#ifndef PARALLEL_ENGINES	/* only used on sparc */
 PlLong *pl_base_fl = pl_foreign_long;	/* overwrite var of engine.c */
 double *pl_base_fd = pl_foreign_double;	/* overwrite var of engine.c */
+#endif
 
-static PlFIOArg fio_arg_array[NB_OF_X_REGS];
+static PL_THREAD_LOCAL PlFIOArg fio_arg_array[NB_OF_X_REGS];
 
 
 
-static WamWord *query_stack[QUERY_STACK_SIZE];
-static WamWord **query_stack_top = query_stack;
-static WamWord *goal_H;
+static PL_THREAD_LOCAL WamWord *query_stack[QUERY_STACK_SIZE];
+static PL_THREAD_LOCAL int query_stack_top; /* nb of queries in query_stack */
+static PL_THREAD_LOCAL WamWord *goal_H;
 
-WamWord *pl_query_top_b;		/* overwrite var of throw_c.c */
-WamWord pl_query_exception;		/* overwrite var of throw_c.c */
+extern PL_THREAD_LOCAL WamWord *pl_query_top_b; /* defined in throw_c.c */
+extern PL_THREAD_LOCAL WamWord pl_query_exception;
 
 
 
@@ -89,6 +91,8 @@ WamWord pl_query_exception;		/* overwrite var of throw_c.c */
  * Function Prototypes             *
  *---------------------------------*/
 
+static void Foreign_Engine_Init(void);
+
 static CodePtr Prepare_Call(int func, int arity, WamWord *arg_adr);
 
 
@@ -112,6 +116,29 @@ Prolog_Prototype(PL_QUERY_RECOVER_ALT, 0);
  *-------------------------------------------------------------------------*/
 static void
 Foreign_Initializer(void)
+{
+  Foreign_Engine_Init();
+
+  Pl_Engine_Add_Context(query_stack, sizeof(query_stack));
+  Pl_Engine_Add_Context(&query_stack_top, sizeof(query_stack_top));
+  Pl_Engine_Add_Context(&goal_H, sizeof(goal_H));
+  Pl_Engine_Add_Context(&pl_query_top_b, sizeof(pl_query_top_b));
+  Pl_Engine_Add_Context(&pl_query_exception, sizeof(pl_query_exception));
+  Pl_Engine_Add_Context(&pl_foreign_bkt_counter, sizeof(pl_foreign_bkt_counter));
+  Pl_Engine_Add_Context(&pl_foreign_bkt_buffer, sizeof(pl_foreign_bkt_buffer));
+  Pl_Engine_Add_Init_Fct(Foreign_Engine_Init);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FOREIGN_ENGINE_INIT                                                     *
+ *                                                                         *
+ * Called for the main engine and for each new engine (see engine.c).      *
+ *-------------------------------------------------------------------------*/
+static void
+Foreign_Engine_Init(void)
 {
   goal_H = H;
   H = H + MAX_ARITY + 1;
@@ -129,7 +156,11 @@ Foreign_Initializer(void)
 void
 Pl_Foreign_Create_Choice(CodePtr codep_alt, int arity, int choice_size)
 {
+  int i;
+
   A(arity) = -1;		/* bkt_counter */
+  for (i = 1; i <= choice_size; i++) /* no stale terms in the buffer (GC) */
+    A(arity + i) = 0;
   Pl_Create_Choice_Point(codep_alt, arity + 1 + choice_size);
 }
 
@@ -320,7 +351,7 @@ void
 Pl_Query_Begin(Bool recoverable)
 
 {
-  if (query_stack_top - query_stack >= QUERY_STACK_SIZE)
+  if (query_stack_top >= QUERY_STACK_SIZE)
     Pl_Fatal_Error("too many nested Pl_Query_Start() (max: %d)",
 		QUERY_STACK_SIZE);
 
@@ -338,8 +369,9 @@ Pl_Query_Begin(Bool recoverable)
 int
 Pl_Query_Call(int func, int arity, WamWord *arg_adr)
 {
-  *query_stack_top++ = pl_query_top_b = B;
+  query_stack[query_stack_top++] = pl_query_top_b = B;
   pl_query_exception = pl_atom_void;
+  pl_gc_lock++;			/* the caller holds refs to the heap */
 
   return Pl_Call_Prolog(Prepare_Call(func, arity, arg_adr));
 }
@@ -382,7 +414,7 @@ Pl_Query_Recover_Alt_0(void)
 int
 Pl_Query_Next_Solution(void)
 {
-  if (query_stack_top == query_stack)
+  if (query_stack_top == 0)
     Pl_Fatal_Error("Pl_Query_Next_Solution() but no query remaining");
 
   pl_query_exception = pl_atom_void;
@@ -403,11 +435,12 @@ Pl_Query_End(int op)
   Bool recoverable;
 
 
-  if (query_stack_top == query_stack)
+  if (query_stack_top == 0)
     Pl_Fatal_Error("Pl_Query_End() but no query remaining");
 
-  query_b = *--query_stack_top;
-  pl_query_top_b = query_stack_top[-1];
+  query_b = query_stack[--query_stack_top];
+  pl_query_top_b = (query_stack_top > 0) ? query_stack[query_stack_top - 1] : NULL;
+  pl_gc_lock--;
 
   recoverable =
     (ALTB(query_b) == Prolog_Predicate(PL_QUERY_RECOVER_ALT, 0));
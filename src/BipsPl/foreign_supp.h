@@ -83,13 +83,13 @@ PlFIOArg;
 
 #ifdef FOREIGN_SUPP_FILE
 
-PlLong pl_foreign_bkt_counter;
-char *pl_foreign_bkt_buffer;
+PL_THREAD_LOCAL PlLong pl_foreign_bkt_counter;	/* see gprolog.h */
+PL_THREAD_LOCAL char *pl_foreign_bkt_buffer;
 
 #else
 
-extern PlLong pl_foreign_bkt_counter;
-extern char *pl_foreign_bkt_buffer;
+extern PL_THREAD_LOCAL PlLong pl_foreign_bkt_counter;
+extern PL_THREAD_LOCAL char *pl_foreign_bkt_buffer;
 
 #endif
 
@@ -128,3 +128,7 @@ g_test_reset_bit(X, Y) :-
 	g_test_reset_bit(X, Y).
 
 
+
+
+'$g_var_names'(L) :-
+	'$call_c_test'('Pl_G_Var_Names_1'(L)).
@@ -52,6 +52,8 @@
 
 #define G_INITIAL_VALUE            Tag_INT(0)
 
+#define START_G_VAR_TBL_SIZE       64
+
 
 #define G_ARRAY                    0
 #define G_ARRAY_AUTO               1
@@ -79,6 +81,16 @@ GVarElt;
 
 
 
+typedef struct			/* Global variable (of an engine) */
+{				/* ------------------------------ */
+  PlLong atom;			/* key: its name                  */
+  GVarElt g_elem;		/* its information                */
+}
+GVarInf;
+
+
+
+
 typedef struct gundo		/* Undo record                    */
 {				/* ------------------------------ */
   GVarElt *g_elem;		/* elem to restore (NULL=invalid) */
@@ -103,7 +115,9 @@ typedef struct			/* Target designator record       */
  * Global Variables                *
  *---------------------------------*/
 
-static GTarget g_target;
+static PL_THREAD_LOCAL char *g_var_tbl = NULL; /* GVarInf of the engine */
+
+static PL_THREAD_LOCAL GTarget g_target;
 
 static int atom_g_array;
 static int atom_g_array_auto;
@@ -149,6 +163,18 @@ static void G_Trail_For_Backtrack(GVarElt *g_elem, PlLong save_size, WamWord sav
 
 static void G_Untrail(int n, WamWord *arg_frame);
 
+static void G_GC_Roots(GCScanFct scan);
+
+static void G_GC_Scan_Element(GVarElt *g_elem, GCScanFct scan);
+
+static void G_GC_Scan_Value(PlLong size, WamWord *p_val, GCScanFct scan);
+
+static void G_Atom_GC_Roots(void);
+
+static void G_Atom_GC_Mark_Element(GVarElt *g_elem);
+
+static void G_Atom_GC_Mark_Value(PlLong size, WamWord *p_val);
+
 static Bool G_Read(WamWord gvar_word, WamWord gval_word);
 
 static Bool G_Read_Element(GVarElt *g_elem, WamWord gval_word);
@@ -179,6 +205,10 @@ G_Var_Initializer(void)
   atom_g_array = Pl_Create_Atom("g_array");
   atom_g_array_auto = Pl_Create_Atom("g_array_auto");
   atom_g_array_extend = Pl_Create_Atom("g_array_extend");
+
+  Pl_Engine_Add_Context(&g_var_tbl, sizeof(g_var_tbl));
+  Pl_GC_Add_Root_Fct(G_GC_Roots);
+  Pl_Atom_GC_Add_Engine_Root_Fct(G_Atom_GC_Roots);
 }
 
 
@@ -469,10 +499,43 @@ Pl_Blt_G_Test_Reset_Bit(WamWord x_word, WamWord y_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_G_VAR_NAMES_1                                                        *
+ *                                                                         *
+ * Unifies list_word with the list of the user global variables (those   *
+ * whose name does not begin with $), e.g. for save_program/1.             *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_G_Var_Names_1(WamWord list_word)
+{
+  int atom;
+
+  if (g_var_tbl == NULL)
+    return Pl_Get_Nil(list_word);
+
+  for (atom = 0; atom < pl_max_atom; atom++)
+    if (pl_atom_tbl[atom].name != NULL && *pl_atom_tbl[atom].name != '$' &&
+	Pl_Hash_Find(g_var_tbl, atom) != NULL)
+      {
+	if (!Pl_Get_List(list_word) || !Pl_Unify_Atom(atom))
+	  return FALSE;
+
+	list_word = Pl_Unify_Variable();
+      }
+
+  return Pl_Get_Nil(list_word);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * Global variable management                                              *
  *                                                                         *
  * A global variable allows the user to associate an information to an atom*
+ * Global variables are private to each engine (they are recorded in the   *
+ * g_var_tbl of the engine, a link references its heap and backtrackable   *
+ * assignments are undone using its trail).                                *
  * There are 3 types of information (2 basic types + 1 constructor):       *
  *                                                                         *
  *   - copy of a term,   builtin: g_assign[b](Gvar, Term)                  *
@@ -842,6 +905,8 @@ Get_Target_From_Gvar(WamWord gvar_word)
   PlLong i, j, size;
   int new_size;
   PlLong index;
+  GVarInf g_var_info;
+  GVarInf *g_var;
   GTarget *gt = &g_target;
 
   arg_adr = Pl_Rd_Callable_Check(gvar_word, &atom, &arity);
@@ -849,17 +914,22 @@ Get_Target_From_Gvar(WamWord gvar_word)
   if (atom == ATOM_CHAR('-') && arity == 2)
     return Get_Target_From_Selector(arg_adr - OFFSET_ARG);
 
-  g_elem = (GVarElt *) pl_atom_tbl[atom].info;
+  if (g_var_tbl == NULL)
+    g_var_tbl = Pl_Hash_Alloc_Table(START_G_VAR_TBL_SIZE, sizeof(GVarInf));
 
-  if (g_elem == NULL)
+  g_var = (GVarInf *) Pl_Hash_Find(g_var_tbl, atom);
+  if (g_var == NULL)
     {
-      g_elem = (GVarElt *) Malloc(sizeof(GVarElt)); /* NB: never recovered */
-      g_elem->size = 0;
-      g_elem->val = G_INITIAL_VALUE;
-      g_elem->undo = NULL;
-      pl_atom_tbl[atom].info = g_elem;
+      g_var_info.atom = atom;	/* NB: never recovered */
+      g_var_info.g_elem.size = 0;
+      g_var_info.g_elem.val = G_INITIAL_VALUE;
+      g_var_info.g_elem.undo = NULL;
+      Pl_Extend_Table_If_Needed(&g_var_tbl);
+      g_var = (GVarInf *) Pl_Hash_Insert(g_var_tbl, (char *) &g_var_info, FALSE);
     }
 
+  g_elem = &g_var->g_elem;
+
   if (arity > 0 && g_elem->size >= 0)
     {
     error:
@@ -1211,6 +1281,156 @@ G_Untrail(int n, WamWord *arg_frame)
 
 
 
+/*-------------------------------------------------------------------------*
+ * G_GC_ROOTS                                                              *
+ *                                                                         *
+ * Links (and links saved in undo records) reference the heap.             *
+ *-------------------------------------------------------------------------*/
+static void
+G_GC_Roots(GCScanFct scan)
+{
+  HashScan hscan;
+  GVarInf *g_var;
+
+  if (g_var_tbl == NULL)
+    return;
+
+  for (g_var = (GVarInf *) Pl_Hash_First(g_var_tbl, &hscan); g_var;
+       g_var = (GVarInf *) Pl_Hash_Next(&hscan))
+    G_GC_Scan_Element(&g_var->g_elem, scan);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * G_GC_SCAN_ELEMENT                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+G_GC_Scan_Element(GVarElt *g_elem, GCScanFct scan)
+{
+  GUndo *u;
+
+  G_GC_Scan_Value(g_elem->size, &g_elem->val, scan);
+
+  for (u = g_elem->undo; u; u = u->next)
+    G_GC_Scan_Value(u->save_size, &u->save_val, scan);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * G_GC_SCAN_VALUE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+G_GC_Scan_Value(PlLong size, WamWord *p_val, GCScanFct scan)
+{
+  GVarElt *p;
+  PlLong i;
+
+  if (size == 0)		/* a link */
+    {
+      (*scan) (p_val);
+      return;
+    }
+
+  if (size > 0)			/* a copy (not in the heap) */
+    return;
+				/* an array */
+  size = -size;
+  p = (GVarElt *) *p_val;
+
+  for (i = 0; i < size; i++)
+    G_GC_Scan_Element(p++, scan);
+
+  if (p->size != G_IMPOSSIBLE_SIZE) /* last elem */
+    G_GC_Scan_Element(p, scan);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * G_ATOM_GC_ROOTS                                                         *
+ *                                                                         *
+ * Mark the names and the atoms of the values of the g_vars of the engine. *
+ *-------------------------------------------------------------------------*/
+static void
+G_Atom_GC_Roots(void)
+{
+  HashScan hscan;
+  GVarInf *g_var;
+
+  if (g_var_tbl == NULL)
+    return;
+
+  for (g_var = (GVarInf *) Pl_Hash_First(g_var_tbl, &hscan); g_var;
+       g_var = (GVarInf *) Pl_Hash_Next(&hscan))
+    {
+      Pl_Atom_GC_Mark(g_var->atom);
+      G_Atom_GC_Mark_Element(&g_var->g_elem);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * G_ATOM_GC_MARK_ELEMENT                                                  *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+G_Atom_GC_Mark_Element(GVarElt *g_elem)
+{
+  GUndo *u;
+
+  G_Atom_GC_Mark_Value(g_elem->size, &g_elem->val);
+
+  for (u = g_elem->undo; u; u = u->next)
+    G_Atom_GC_Mark_Value(u->save_size, &u->save_val);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * G_ATOM_GC_MARK_VALUE                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+G_Atom_GC_Mark_Value(PlLong size, WamWord *p_val)
+{
+  GVarElt *p;
+  PlLong i;
+
+  if (size == 0)		/* a link */
+    {
+      Pl_Atom_GC_Mark_Words(p_val, 1);
+      return;
+    }
+
+  if (size > 0)			/* a copy */
+    {
+      Pl_Atom_GC_Mark_Words((WamWord *) *p_val, size);
+      return;
+    }
+				/* an array */
+  size = -size;
+  p = (GVarElt *) *p_val;
+
+  for (i = 0; i < size; i++)
+    G_Atom_GC_Mark_Element(p++);
+
+  if (p->size != G_IMPOSSIBLE_SIZE) /* last elem */
+    G_Atom_GC_Mark_Element(p);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * G_READ                                                                  *
  *                                                                         *
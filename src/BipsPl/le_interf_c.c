@@ -58,7 +58,7 @@
  * Global Variables                *
  *---------------------------------*/
 
-static ComplMatch compl_match;
+static PL_THREAD_LOCAL ComplMatch compl_match;
 
 /*---------------------------------*
  * Function Prototypes             *
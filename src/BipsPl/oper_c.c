@@ -80,6 +80,11 @@ static int atom_specif_tbl[7];
  * Function Prototypes             *
  *---------------------------------*/
 
+static int Next_Oper_Atom(int atom, int *op_mask);
+
+static Bool Unify_Oper(int atom, int op_mask, WamWord prec_word,
+		       WamWord specif_word, WamWord oper_word);
+
 static int Detect_Oper_Specif(OperInf *oper);
 
 
@@ -187,15 +192,15 @@ Pl_Op_3(WamWord prec_word, WamWord specif_word, WamWord oper_word)
 /*-------------------------------------------------------------------------*
  * PL_CURRENT_OP_3                                                         *
  *                                                                         *
+ * The operators are enumerated via the op_mask of the atoms (rather than  *
+ * by a scan of the operator table which can grow in another engine).      *
  *-------------------------------------------------------------------------*/
 Bool
 Pl_Current_Op_3(WamWord prec_word, WamWord specif_word, WamWord oper_word)
 {
   WamWord word, tag_mask;
-  HashScan scan;
   PlLong prec;
   int atom_specif;
-  OperInf *oper;
   int atom;
   int op_mask;
   int i;
@@ -234,42 +239,26 @@ Pl_Current_Op_3(WamWord prec_word, WamWord specif_word, WamWord oper_word)
       op_mask = pl_atom_tbl[atom].prop.op_mask;
       if (op_mask == 0)
 	return FALSE;
-
-      for (i = PREFIX; i <= POSTFIX; i++)
-	if (op_mask & Make_Op_Mask(i))
-	  break;
-
-      op_mask &= ~Make_Op_Mask(i);
-      if (op_mask)		/* non deterministic case */
-	{
-	  A(0) = prec_word;
-	  A(1) = specif_word;
-	  A(2) = oper_word;
-	  A(3) = op_mask;
-	  Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(CURRENT_OP_ALT, 0),
-			      4);
-	}
-      oper = Pl_Lookup_Oper(atom, i);
     }
   else
     {
-      oper = (OperInf *) Pl_Hash_First(pl_oper_tbl, &scan);
-      if (oper == NULL)
+      atom = Next_Oper_Atom(-1, &op_mask);
+      if (atom < 0)
 	return FALSE;
+    }
 
-      /* non deterministic case */
+  if ((op_mask & (op_mask - 1)) || Tag_Mask_Of(oper_word) != TAG_ATM_MASK)
+    {				/* non deterministic case */
       A(0) = prec_word;
       A(1) = specif_word;
       A(2) = oper_word;
-      A(3) = (WamWord) scan.endt;
-      A(4) = (WamWord) scan.cur_t;
-      A(5) = (WamWord) scan.cur_p;
-      Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(CURRENT_OP_ALT, 0), 6);
+      A(3) = atom;
+      A(4) = op_mask & (op_mask - 1); /* remaining types of atom */
+      Pl_Create_Choice_Point((CodePtr) Prolog_Predicate(CURRENT_OP_ALT, 0),
+			     5);
     }
 
-  return Pl_Get_Integer(oper->prec, prec_word) &&
-    Pl_Get_Atom(Detect_Oper_Specif(oper), specif_word) &&
-    Pl_Get_Atom(Atom_Of_Oper(oper->a_t), oper_word);
+  return Unify_Oper(atom, op_mask, prec_word, specif_word, oper_word);
 }
 
 
@@ -283,11 +272,8 @@ Bool
 Pl_Current_Op_Alt_0(void)
 {
   WamWord prec_word, specif_word, oper_word;
-  HashScan scan;
-  OperInf *oper;
   int atom;
   int op_mask;
-  int i;
 
 
   Pl_Update_Choice_Point((CodePtr) Prolog_Predicate(CURRENT_OP_ALT, 0), 0);
@@ -295,47 +281,80 @@ Pl_Current_Op_Alt_0(void)
   prec_word = AB(B, 0);
   specif_word = AB(B, 1);
   oper_word = AB(B, 2);
+  atom = (int) AB(B, 3);
+  op_mask = (int) AB(B, 4);
 
-  if (Tag_Mask_Of(oper_word) == TAG_ATM_MASK)
-    {
-      atom = UnTag_ATM(oper_word);
-      op_mask = (int) AB(B, 3);
-
-      for (i = PREFIX; i <= POSTFIX; i++)
-	if (op_mask & Make_Op_Mask(i))
-	  break;
-
-      oper = Pl_Lookup_Oper(atom, i);
-
-      Delete_Last_Choice_Point();
-    }
-  else
+  if (op_mask == 0)		/* here oper_word is a variable */
     {
-      scan.endt = (char *) AB(B, 3);
-      scan.cur_t = (char *) AB(B, 4);
-      scan.cur_p = (char *) AB(B, 5);
-
-      oper = (OperInf *) Pl_Hash_Next(&scan);
-      if (oper == NULL)
+      atom = Next_Oper_Atom(atom, &op_mask);
+      if (atom < 0)
 	{
 	  Delete_Last_Choice_Point();
 	  return FALSE;
 	}
+    }
 
-
+  if ((op_mask & (op_mask - 1)) == 0 && Tag_Mask_Of(oper_word) == TAG_ATM_MASK)
+    Delete_Last_Choice_Point();
+  else
+    {
 #if 0 /* the following data is unchanged */
       AB(B, 0) = prec_word;
       AB(B, 1) = specif_word;
       AB(B, 2) = oper_word;
-      AB(B, 3) = (WamWord) scan.endt;
 #endif
-      AB(B, 4) = (WamWord) scan.cur_t;
-      AB(B, 5) = (WamWord) scan.cur_p;
+      AB(B, 3) = atom;
+      AB(B, 4) = op_mask & (op_mask - 1);
     }
 
+  return Unify_Oper(atom, op_mask, prec_word, specif_word, oper_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEXT_OPER_ATOM                                                          *
+ *                                                                         *
+ * returns the next atom after 'atom' (-1 to start) which is an operator   *
+ * (and its op_mask) or -1 at the end.                                     *
+ *-------------------------------------------------------------------------*/
+static int
+Next_Oper_Atom(int atom, int *op_mask)
+{
+  while ((atom = Pl_Find_Next_Atom(atom)) >= 0)
+    if ((*op_mask = pl_atom_tbl[atom].prop.op_mask) != 0)
+      break;
+
+  return atom;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UNIFY_OPER                                                              *
+ *                                                                         *
+ * Unifies the operator of atom whose type is the lowest one in op_mask.   *
+ *-------------------------------------------------------------------------*/
+static Bool
+Unify_Oper(int atom, int op_mask, WamWord prec_word, WamWord specif_word,
+	   WamWord oper_word)
+{
+  OperInf *oper;
+  int i;
+
+  for (i = PREFIX; i <= POSTFIX; i++)
+    if (op_mask & Make_Op_Mask(i))
+      break;
+
+  oper = Pl_Lookup_Oper(atom, i);
+  if (oper == NULL)		/* deleted meanwhile */
+    return FALSE;
+
   return Pl_Get_Integer(oper->prec, prec_word) &&
     Pl_Get_Atom(Detect_Oper_Specif(oper), specif_word) &&
-    Pl_Get_Atom(Atom_Of_Oper(oper->a_t), oper_word);
+    Pl_Get_Atom(atom, oper_word);
 }
 
 
@@ -360,6 +360,45 @@ select(Reads, ReadyReads, Writes, ReadyWrites, TimeOut) :-
 
 
 
+poller_create(Poller) :-
+	set_bip_name(poller_create, 1),
+	(   nonvar(Poller) ->
+	    '$pl_err_uninstantiation'(Poller)
+	;   true
+	),
+	'$call_c_test'('Pl_Poller_Create_1'(Poller)).
+
+
+
+
+poller_close(Poller) :-
+	set_bip_name(poller_close, 1),
+	'$call_c_test'('Pl_Poller_Close_1'(Poller)).
+
+
+
+
+poller_add(Poller, Item, Events) :-
+	set_bip_name(poller_add, 3),
+	'$call_c_test'('Pl_Poller_Add_3'(Poller, Item, Events)).
+
+
+
+
+poller_remove(Poller, Item) :-
+	set_bip_name(poller_remove, 2),
+	'$call_c_test'('Pl_Poller_Remove_2'(Poller, Item)).
+
+
+
+
+poller_wait(Poller, Ready, TimeOut) :-
+	set_bip_name(poller_wait, 3),
+	'$call_c_test'('Pl_Poller_Wait_3'(Poller, Ready, TimeOut)).
+
+
+
+
 prolog_pid(PrologPid) :-
 	set_bip_name(prolog_pid, 1),
 	'$call_c_test'('Pl_Prolog_Pid_1'(PrologPid)).
@@ -41,6 +41,7 @@
 #include <math.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <time.h>
 #include <sys/stat.h>
@@ -63,6 +64,13 @@
 #include <sys/wait.h>
 #endif
 
+#if defined(__linux__)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
 #define OBJ_INIT Os_Interf_Initializer
 
 #include "engine_pl.h"
@@ -83,6 +91,13 @@
 #define MAX_SIGNALS                255
 #define MAX_SPAWN_ARGS             1024
 
+#define POLLER_READ                1
+#define POLLER_WRITE               2
+#define POLLER_HANGUP              4
+
+#define POLLER_MIN_EVENTS          16
+#define POLLER_MAX_EVENTS          4096
+
 
 
 
@@ -98,6 +113,23 @@ typedef struct
 InfSig;
 
 
+typedef struct			/* a poller (see poller_create/1)   */
+{
+  Bool in_use;			/* is this slot allocated ?         */
+  int nb_item;			/* nb of registered descriptors     */
+#ifdef USE_EPOLL
+  int epfd;			/* epoll instance                   */
+  struct epoll_event *ev;	/* result buffer for epoll_wait()   */
+  int max_ev;			/* size of ev                       */
+#elif !defined(_WIN32)
+  struct pollfd *pfd;		/* registered descriptors           */
+  int *stm;			/* associated stream (or -1)        */
+  int max_item;			/* size of pfd and stm              */
+#endif
+}
+Poller;
+
+
 
 
 /*---------------------------------*
@@ -118,9 +150,14 @@ static int atom_character_device;
 static int atom_block_device;
 static int atom_unknown;
 
+static int atom_hangup;
+
 static InfSig tsig[MAX_SIGNALS];
 static int nb_sig;
 
+static PL_THREAD_LOCAL Poller *poller_tbl; /* pollers of the engine */
+static PL_THREAD_LOCAL int poller_max;
+
 
 
 
@@ -141,6 +178,18 @@ static int Select_Init_Set(WamWord list_word, fd_set *set, int check);
 static Bool Select_Init_Ready_List(WamWord list_word, fd_set *set,
 				   WamWord ready_list_word);
 
+#ifndef _WIN32
+
+static Poller *Get_Poller(WamWord poller_word);
+
+static int Poller_Item(WamWord item_word, int *stm);
+
+static int Poller_Events(WamWord events_word);
+
+static WamWord Poller_Ready_Item(int fd, int stm, int mask, WamWord tail_word);
+
+#endif
+
 
 
 
@@ -164,6 +213,11 @@ Os_Interf_Initializer(void)
   atom_block_device = Pl_Create_Atom("block_device");
   atom_unknown = Pl_Create_Atom("unknown");
 
+  atom_hangup = Pl_Create_Atom("hangup");
+
+  Pl_Engine_Add_Context(&poller_tbl, sizeof(poller_tbl));
+  Pl_Engine_Add_Context(&poller_max, sizeof(poller_max));
+
   nb_sig = 0;
 #if defined(__unix__) || defined(__CYGWIN__)
   tsig[nb_sig].atom = Pl_Create_Atom("SIGHUP");
@@ -345,7 +399,7 @@ Pl_Directory_Files_2(WamWord path_name_word, WamWord list_word)
   while ((cur_entry = readdir(dir)) != NULL)
     {
       name = cur_entry->d_name;
-      if (!Pl_Get_List(list_word) || !Pl_Unify_Atom(Pl_Create_Allocate_Atom(name)))
+      if (!Pl_Get_List(list_word) || !Pl_Unify_Atom(Pl_Create_Collectable_Atom(name)))
 	{
 	  res = FALSE;
 	  goto finish;
@@ -1419,6 +1473,480 @@ Select_Init_Ready_List(WamWord list_word, fd_set *set, WamWord ready_list_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * Pollers: unlike select/5, a poller keeps its set of file descriptors    *
+ * between calls. On Linux it is based on epoll(7) so that waiting only    *
+ * costs the number of ready descriptors. Elsewhere poll(2) is used, which *
+ * has no FD_SETSIZE limit but scans the whole set.                        *
+ * A registered item is a file descriptor or a stream. For epoll the item  *
+ * is encoded in the event data: stream + 1 in the upper 32 bits (0 for a  *
+ * plain descriptor) and the descriptor in the lower 32 bits.              *
+ * A poller is private to the engine which created it.                     *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * PL_POLLER_CREATE_1                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Poller_Create_1(WamWord poller_word)
+{
+#ifdef _WIN32
+
+  Pl_Err_Resource(Pl_Create_Atom("not implemented"));
+  return FALSE;
+
+#else
+
+  int p;
+  Poller *pol;
+
+  for (p = 0; p < poller_max; p++)
+    if (!poller_tbl[p].in_use)
+      break;
+
+  if (p == poller_max)
+    {
+      poller_max = (poller_max == 0) ? 8 : poller_max * 2;
+      poller_tbl = (Poller *) Realloc((char *) poller_tbl,
+				      poller_max * sizeof(Poller));
+      memset(poller_tbl + p, 0, (poller_max - p) * sizeof(Poller));
+    }
+
+  pol = poller_tbl + p;
+#ifdef USE_EPOLL
+  Os_Test_Error((pol->epfd = epoll_create1(EPOLL_CLOEXEC)));
+#endif
+  pol->in_use = TRUE;
+  pol->nb_item = 0;
+
+  return Pl_Get_Integer(p, poller_word);
+
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_POLLER_CLOSE_1                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Poller_Close_1(WamWord poller_word)
+{
+#ifdef _WIN32
+
+  Pl_Err_Resource(Pl_Create_Atom("not implemented"));
+  return FALSE;
+
+#else
+
+  Poller *pol = Get_Poller(poller_word);
+
+#ifdef USE_EPOLL
+  close(pol->epfd);
+  if (pol->ev)
+    Free(pol->ev);
+  pol->ev = NULL;
+  pol->max_ev = 0;
+#else
+  if (pol->pfd)
+    {
+      Free(pol->pfd);
+      Free(pol->stm);
+    }
+  pol->pfd = NULL;
+  pol->stm = NULL;
+  pol->max_item = 0;
+#endif
+  pol->in_use = FALSE;
+
+  return TRUE;
+
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_POLLER_ADD_3                                                         *
+ *                                                                         *
+ * Registers an item or modifies the events of an already registered one.  *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Poller_Add_3(WamWord poller_word, WamWord item_word, WamWord events_word)
+{
+#ifdef _WIN32
+
+  Pl_Err_Resource(Pl_Create_Atom("not implemented"));
+  return FALSE;
+
+#else
+
+  Poller *pol = Get_Poller(poller_word);
+  int stm;
+  int fd = Poller_Item(item_word, &stm);
+  int mask = Poller_Events(events_word);
+
+#ifdef USE_EPOLL
+  struct epoll_event e;
+
+  e.events = 0;
+  if (mask & POLLER_READ)
+    e.events |= EPOLLIN | EPOLLRDHUP;
+  if (mask & POLLER_WRITE)
+    e.events |= EPOLLOUT;
+  e.data.u64 = ((uint64_t) (stm + 1) << 32) | (uint32_t) fd;
+
+  if (epoll_ctl(pol->epfd, EPOLL_CTL_ADD, fd, &e) == 0)
+    pol->nb_item++;
+  else if (errno == EEXIST)
+    Os_Test_Error(epoll_ctl(pol->epfd, EPOLL_CTL_MOD, fd, &e));
+  else
+    Os_Test_Error(-1);
+
+#else
+
+  int i;
+
+  for (i = 0; i < pol->nb_item; i++)
+    if (pol->pfd[i].fd == fd)
+      break;
+
+  if (i == pol->nb_item)
+    {
+      if (i == pol->max_item)
+	{
+	  pol->max_item = (pol->max_item == 0) ? 16 : pol->max_item * 2;
+	  pol->pfd = (struct pollfd *)
+	    Realloc((char *) pol->pfd, pol->max_item * sizeof(struct pollfd));
+	  pol->stm = (int *)
+	    Realloc((char *) pol->stm, pol->max_item * sizeof(int));
+	}
+      pol->nb_item++;
+      pol->pfd[i].fd = fd;
+    }
+
+  pol->pfd[i].events = 0;
+  if (mask & POLLER_READ)
+    pol->pfd[i].events |= POLLIN;
+  if (mask & POLLER_WRITE)
+    pol->pfd[i].events |= POLLOUT;
+  pol->stm[i] = stm;
+
+#endif
+
+  return TRUE;
+
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_POLLER_REMOVE_2                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Poller_Remove_2(WamWord poller_word, WamWord item_word)
+{
+#ifdef _WIN32
+
+  Pl_Err_Resource(Pl_Create_Atom("not implemented"));
+  return FALSE;
+
+#else
+
+  Poller *pol = Get_Poller(poller_word);
+  int stm;
+  int fd = Poller_Item(item_word, &stm);
+
+#ifdef USE_EPOLL
+  struct epoll_event e;		/* non-NULL for kernels before 2.6.9 */
+
+  Os_Test_Error(epoll_ctl(pol->epfd, EPOLL_CTL_DEL, fd, &e));
+
+#else
+
+  int i;
+
+  for (i = 0; i < pol->nb_item; i++)
+    if (pol->pfd[i].fd == fd)
+      break;
+
+  if (i == pol->nb_item)
+    {
+      errno = ENOENT;
+      Os_Test_Error(-1);
+    }
+
+  pol->pfd[i] = pol->pfd[pol->nb_item - 1];
+  pol->stm[i] = pol->stm[pol->nb_item - 1];
+#endif
+
+  pol->nb_item--;
+
+  return TRUE;
+
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_POLLER_WAIT_3                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Poller_Wait_3(WamWord poller_word, WamWord ready_word,
+		 WamWord time_out_word)
+{
+#ifdef _WIN32
+
+  Pl_Err_Resource(Pl_Create_Atom("not implemented"));
+  return FALSE;
+
+#else
+
+  Poller *pol = Get_Poller(poller_word);
+  double time_out;
+  int ms;
+  int n, i, mask;
+  WamWord list_word = NIL_WORD;
+
+  Pl_Check_For_Un_List(ready_word);
+
+  time_out = Pl_Rd_Number_Check(time_out_word);
+  if (time_out <= 0)
+    ms = -1;
+  else if (time_out >= INT_MAX)
+    ms = INT_MAX;
+  else
+    ms = (int) time_out;
+
+#ifdef USE_EPOLL
+
+  n = pol->nb_item;
+  if (n < POLLER_MIN_EVENTS)
+    n = POLLER_MIN_EVENTS;
+  else if (n > POLLER_MAX_EVENTS)
+    n = POLLER_MAX_EVENTS;
+
+  if (n > pol->max_ev)
+    {
+      pol->max_ev = n;
+      pol->ev = (struct epoll_event *)
+	Realloc((char *) pol->ev, n * sizeof(struct epoll_event));
+    }
+
+  n = epoll_wait(pol->epfd, pol->ev, n, ms);
+  if (n < 0 && errno == EINTR)
+    n = 0;
+  Os_Test_Error(n);
+
+  for (i = n - 1; i >= 0; i--)	/* build the list from its end */
+    {
+      uint32_t r = pol->ev[i].events;
+      uint64_t data = pol->ev[i].data.u64;
+
+      mask = 0;
+      if (r & (EPOLLIN | EPOLLPRI))
+	mask |= POLLER_READ;
+      if (r & EPOLLOUT)
+	mask |= POLLER_WRITE;
+      if (r & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))
+	mask |= POLLER_HANGUP;
+
+      list_word = Poller_Ready_Item((int) (uint32_t) data,
+				    (int) (data >> 32) - 1, mask, list_word);
+    }
+
+#else
+
+  n = poll(pol->pfd, pol->nb_item, ms);
+  if (n < 0 && errno == EINTR)
+    n = 0;
+  Os_Test_Error(n);
+
+  for (i = pol->nb_item - 1; n > 0 && i >= 0; i--)
+    {
+      int r = pol->pfd[i].revents;
+
+      if (r == 0)
+	continue;
+
+      n--;
+      mask = 0;
+      if (r & (POLLIN | POLLPRI))
+	mask |= POLLER_READ;
+      if (r & POLLOUT)
+	mask |= POLLER_WRITE;
+      if (r & (POLLHUP | POLLERR | POLLNVAL))
+	mask |= POLLER_HANGUP;
+
+      list_word = Poller_Ready_Item(pol->pfd[i].fd, pol->stm[i], mask,
+				    list_word);
+    }
+
+#endif
+
+  return Pl_Unify(list_word, ready_word);
+
+#endif
+}
+
+
+
+
+#ifndef _WIN32
+
+/*-------------------------------------------------------------------------*
+ * GET_POLLER                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Poller *
+Get_Poller(WamWord poller_word)
+{
+  int p = Pl_Rd_C_Int_Check(poller_word);
+
+  if (p < 0 || p >= poller_max || !poller_tbl[p].in_use)
+    Pl_Err_Existence(pl_existence_poller, poller_word);
+
+  return poller_tbl + p;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POLLER_ITEM                                                             *
+ *                                                                         *
+ * Returns the file descriptor of an item (as select/5) and its stream.    *
+ *-------------------------------------------------------------------------*/
+static int
+Poller_Item(WamWord item_word, int *stm)
+{
+  WamWord word, tag_mask;
+  int fd;
+
+  DEREF(item_word, word, tag_mask);
+  if (tag_mask == TAG_REF_MASK)
+    Pl_Err_Instantiation();
+
+  if (tag_mask == TAG_INT_MASK)
+    {
+      *stm = -1;
+      return Pl_Rd_C_Int_Positive_Check(word);
+    }
+
+  *stm = Pl_Get_Stream_Or_Alias(word, STREAM_CHECK_EXIST);
+  fd = Pl_Io_Fileno_Of_Stream(*stm);
+  if (fd < 0)
+    Pl_Err_Domain(pl_domain_selectable_item, word);
+
+  return fd;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POLLER_EVENTS                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Poller_Events(WamWord events_word)
+{
+  WamWord word, tag_mask;
+  WamWord save_events_word;
+  WamWord *lst_adr;
+  int mask = 0;
+
+  save_events_word = events_word;
+  for (;;)
+    {
+      DEREF(events_word, word, tag_mask);
+
+      if (tag_mask == TAG_REF_MASK)
+	Pl_Err_Instantiation();
+
+      if (word == NIL_WORD)
+	break;
+
+      if (tag_mask != TAG_LST_MASK)
+	Pl_Err_Type(pl_type_list, save_events_word);
+
+      lst_adr = UnTag_LST(word);
+      DEREF(Car(lst_adr), word, tag_mask);
+      if (tag_mask == TAG_REF_MASK)
+	Pl_Err_Instantiation();
+
+      if (word == Tag_ATM(pl_atom_read))
+	mask |= POLLER_READ;
+      else if (word == Tag_ATM(pl_atom_write))
+	mask |= POLLER_WRITE;
+      else
+	Pl_Err_Domain(pl_domain_poll_event, word);
+
+      events_word = Cdr(lst_adr);
+    }
+
+  return mask;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POLLER_READY_ITEM                                                       *
+ *                                                                         *
+ * Returns [Item-Events|Tail] where Events is a sublist of                 *
+ * [read,write,hangup].                                                    *
+ *-------------------------------------------------------------------------*/
+static WamWord
+Poller_Ready_Item(int fd, int stm, int mask, WamWord tail_word)
+{
+  WamWord arg[2];
+
+  arg[1] = NIL_WORD;
+  if (mask & POLLER_HANGUP)
+    {
+      arg[0] = Tag_ATM(atom_hangup);
+      arg[1] = Pl_Mk_List(arg);
+    }
+  if (mask & POLLER_WRITE)
+    {
+      arg[0] = Tag_ATM(pl_atom_write);
+      arg[1] = Pl_Mk_List(arg);
+    }
+  if (mask & POLLER_READ)
+    {
+      arg[0] = Tag_ATM(pl_atom_read);
+      arg[1] = Pl_Mk_List(arg);
+    }
+
+  if (stm >= 0)
+    {
+      arg[0] = Pl_Put_Structure(pl_atom_stream, 1);
+      Pl_Unify_Integer(stm);
+    }
+  else
+    arg[0] = Tag_INT(fd);
+  arg[0] = Pl_Mk_Compound(ATOM_CHAR('-'), 2, arg);
+  arg[1] = tail_word;
+
+  return Pl_Mk_List(arg);
+}
+
+#endif /* !_WIN32 */
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_PROLOG_PID_1                                                         *
  *                                                                         *
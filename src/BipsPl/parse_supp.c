@@ -73,17 +73,16 @@
  * Global Variables                *
  *---------------------------------*/
 
-static StmInf *pstm_i;
+static PL_THREAD_LOCAL StmInf *pstm_i;
 
-static Bool tok_present;
-static char unget_tok_buffer[SCAN_BIG_BUFFER];
-static TokInf unget_tok = { .name = unget_tok_buffer };
+static PL_THREAD_LOCAL Bool tok_present;
+static PL_THREAD_LOCAL TokInf unget_tok;
 
 
-static sigjmp_buf jumper;
+static PL_THREAD_LOCAL sigjmp_buf jumper;
 
 #if !defined(NO_USE_REGS) && NB_OF_USED_MACHINE_REGS > 0
-static WamWord buff_save_machine_regs[NB_OF_USED_MACHINE_REGS];
+static PL_THREAD_LOCAL WamWord buff_save_machine_regs[NB_OF_USED_MACHINE_REGS];
 #endif
 
 static int atom_var;
@@ -159,6 +158,11 @@ Parse_Supp_Initializer(void)
   atom_back_quotes = Pl_Create_Atom("back_quotes");
   atom_full_stop = Pl_Create_Atom("full_stop");
   atom_extend = Pl_Create_Atom("extend");
+
+  Pl_Engine_Add_Buffer(&unget_tok.name, SCAN_BIG_BUFFER);
+  Pl_Engine_Add_Buffer(&pl_parse_dico_var, MAX_VAR_IN_TERM * sizeof(InfVar));
+  Pl_Engine_Add_Context(&pl_last_read_line, sizeof(pl_last_read_line));
+  Pl_Engine_Add_Context(&pl_last_read_col, sizeof(pl_last_read_col));
 }
 
 
@@ -222,6 +226,7 @@ Pl_Read_Term(StmInf *pstm, int parse_end_of_term)
   pl_last_read_line = -1;
 
   pstm_i = pstm;
+  Pl_Stream_Begin_Read(pstm);
 
   tok_present = FALSE;
   Save_Machine_Regs(buff_save_machine_regs);
@@ -275,6 +280,7 @@ Pl_Read_Term(StmInf *pstm, int parse_end_of_term)
     }
 
  finish:
+  Pl_Stream_End_Read();
   pl_use_le_prompt = save_use_le_prompt;
   return term;
 }
@@ -352,7 +358,7 @@ Parse_Term(int cur_prec, int context, Bool comma_is_punct)
 
       if (flag_value == PF_QUOT_AS_ATOM || flag_value == PF_QUOT_AS_ATOM_NO_ESCAPE)
 	{
-	  atom = Pl_Create_Allocate_Atom(pl_token.name);
+	  atom = Pl_Create_Collectable_Atom(pl_token.name);
 	  goto a_name;
 	}
 
@@ -389,7 +395,7 @@ Parse_Term(int cur_prec, int context, Bool comma_is_punct)
       break;
 
     case TOKEN_NAME:
-      atom = Pl_Create_Allocate_Atom(pl_token.name);
+      atom = Pl_Create_Collectable_Atom(pl_token.name);
 
     a_name:
       bracket = (Pl_Scan_Peek_Char(pstm_i, TRUE) == '(');
@@ -486,7 +492,7 @@ Parse_Term(int cur_prec, int context, Bool comma_is_punct)
 	  if (pl_token.type != TOKEN_NAME)
 	    break;
 
-	  atom = Pl_Create_Allocate_Atom(pl_token.name);
+	  atom = Pl_Create_Collectable_Atom(pl_token.name);
 	  if ((oper = Pl_Lookup_Oper(atom, INFIX)))
 	    infix_op = TRUE;
 	  else if ((oper = Pl_Lookup_Oper(atom, POSTFIX)))
@@ -775,7 +781,11 @@ Pl_Read_Atom(StmInf *pstm)
 {
   char *err_msg;
 
-  if ((err_msg = Pl_Scan_Next_Atom(pstm)) != NULL)
+  Pl_Stream_Begin_Read(pstm);
+  err_msg = Pl_Scan_Next_Atom(pstm);
+  Pl_Stream_End_Read();
+
+  if (err_msg != NULL)
     {
       Pl_Set_Last_Syntax_Error(pl_atom_tbl[pstm->atom_file_name].name,
 			       pl_token.line, pl_token.col, err_msg);
@@ -784,7 +794,7 @@ Pl_Read_Atom(StmInf *pstm)
 
   Update_Last_Read_Position;
 
-  return Pl_Put_Atom(Pl_Create_Allocate_Atom(pl_token.name));
+  return Pl_Put_Atom(Pl_Create_Collectable_Atom(pl_token.name));
 }
 
 
@@ -800,7 +810,11 @@ Pl_Read_Integer(StmInf *pstm)
 {
   char *err_msg;
 
-  if ((err_msg = Pl_Scan_Next_Number(pstm, TRUE)) != NULL)
+  Pl_Stream_Begin_Read(pstm);
+  err_msg = Pl_Scan_Next_Number(pstm, TRUE);
+  Pl_Stream_End_Read();
+
+  if (err_msg != NULL)
     {
       Pl_Set_Last_Syntax_Error(pl_atom_tbl[pstm->atom_file_name].name,
 			    pl_token.line, pl_token.col, err_msg);
@@ -826,7 +840,11 @@ Pl_Read_Number(StmInf *pstm)
 {
   char *err_msg;
 
-  if ((err_msg = Pl_Scan_Next_Number(pstm, FALSE)) != NULL)
+  Pl_Stream_Begin_Read(pstm);
+  err_msg = Pl_Scan_Next_Number(pstm, FALSE);
+  Pl_Stream_End_Read();
+
+  if (err_msg != NULL)
     {
       Pl_Set_Last_Syntax_Error(pl_atom_tbl[pstm->atom_file_name].name,
 			    pl_token.line, pl_token.col, err_msg);
@@ -854,7 +872,11 @@ Pl_Read_Token(StmInf *pstm)
   int func = 0, atom;		/* init for the compiler */
   char *err_msg;
 
-  if ((err_msg = Pl_Scan_Token(pstm, FALSE)) != NULL)
+  Pl_Stream_Begin_Read(pstm);
+  err_msg = Pl_Scan_Token(pstm, FALSE);
+  Pl_Stream_End_Read();
+
+  if (err_msg != NULL)
     {
       Pl_Set_Last_Syntax_Error(pl_atom_tbl[pstm->atom_file_name].name,
 			       pl_token.line, pl_token.col, err_msg);
@@ -870,7 +892,7 @@ Pl_Read_Token(StmInf *pstm)
     case TOKEN_VARIABLE:
       func = atom_var;
     arg_of_struct:
-      atom = Pl_Create_Allocate_Atom(pl_token.name);
+      atom = Pl_Create_Collectable_Atom(pl_token.name);
       arg = Pl_Put_Atom(atom);
       break;
 
@@ -895,7 +917,7 @@ Pl_Read_Token(StmInf *pstm)
       break;
 
     case TOKEN_NAME:
-      atom = Pl_Create_Allocate_Atom(pl_token.name);
+      atom = Pl_Create_Collectable_Atom(pl_token.name);
       term = Pl_Put_Atom(atom);
       break;
 
@@ -69,22 +69,23 @@ InfVar;
 
 #ifdef PARSE_SUPP_FILE
 
-InfVar pl_parse_dico_var[MAX_VAR_IN_TERM];
-int pl_parse_nb_var;
+PL_THREAD_LOCAL InfVar *pl_parse_dico_var; /* MAX_VAR_IN_TERM, per engine */
+PL_THREAD_LOCAL int pl_parse_nb_var;
 
 #else
 
-extern InfVar pl_parse_dico_var[];
-extern int pl_parse_nb_var;
+extern PL_THREAD_LOCAL InfVar *pl_parse_dico_var;
+extern PL_THREAD_LOCAL int pl_parse_nb_var;
 
 #endif
 
 
-				/* defined as this to avoid to force the   */
-				/* inclusion of parse_supp.o if not needed */
-				/* (stream_supp.c uses pl_last_read_line/col) */
-PlLong pl_last_read_line;
-PlLong pl_last_read_col;
+				/* defined in stream_supp.c to avoid to    */
+				/* force the inclusion of parse_supp.o if  */
+				/* not needed (a TLS variable cannot be    */
+				/* common)                                 */
+extern PL_THREAD_LOCAL PlLong pl_last_read_line;
+extern PL_THREAD_LOCAL PlLong pl_last_read_col;
 
 
 
@@ -0,0 +1,92 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : Prolog buit-in predicates                                       *
+ * File  : pl2wam_lib.pl                                                   *
+ * Descr.: Prolog to WAM compiler linked in the run-time (for consult/1)   *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+/* The compiler is included as a hidden unit: its predicates are not
+ * recorded in the predicate table (so they cannot clash with user
+ * predicates) except the '$' ones defined here, which are built-in.
+ * Its global variables and dynamic predicates all begin with '$'.
+ */
+
+:-	hidden.
+
+:-	include('../Pl2Wam/read_file').
+:-	include('../Pl2Wam/syn_sugar').
+:-	include('../Pl2Wam/internal').
+:-	include('../Pl2Wam/code_gen').
+:-	include('../Pl2Wam/reg_alloc').
+:-	include('../Pl2Wam/inst_codif').
+:-	include('../Pl2Wam/first_arg').
+:-	include('../Pl2Wam/indexing').
+:-	include('../Pl2Wam/wam_emit').
+:-	include('../Pl2Wam/pl2wam').
+
+
+
+
+          % '$pl2wam_compile'(LArg, Key): compile as pl2wam(LArg) but the
+          % byte-code is recorded as '$pl2wam_bc'(Key, Term) facts instead of
+          % being written (see wam_emit.pl). Fails if the compilation fails
+          % (nothing is then recorded).
+
+'$pl2wam_compile'(LArg, Key) :-
+	g_assign('$in_process', t),
+	g_assign('$bc_key', Key),
+	(   catch('$pl2wam_compile1'(LArg), Err, true) ->
+	    (   var(Err) ->
+	        Ok = t
+	    ;   Err = abandon_exec ->
+	        Ok = f
+	    ;   catch('$pl2wam_exception'(Err), abandon_exec, true),
+	        Ok = f
+	    )
+	;   Ok = f
+	),
+	read_file_clean,
+	(   Ok = t ->
+	    true
+	;   retractall('$pl2wam_bc'(Key, _)),
+	    fail
+	).
+
+
+'$pl2wam_compile1'(LArg) :-		% meta-called: must be visible
+	pl2wam1(LArg).
+
+
+'$pl2wam_exception'(Err) :-
+	exception(Err).
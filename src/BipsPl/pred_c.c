@@ -105,11 +105,12 @@ Pl_Current_Predicate_2(WamWord pred_indic_word, WamWord which_preds_word)
 				/* here func or arity == -1 (or both) */
   all = (func == -1 && arity == -1);
 
+  Pl_Lock_Acquire(pl_pred_lock);
   pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan);
   for (;;)
     {
       if (pred == NULL)
-	return FALSE;
+	break;
 
       func1 = Functor_Of(pred->f_n);
       arity1 = Arity_Of(pred->f_n);
@@ -120,6 +121,10 @@ Pl_Current_Predicate_2(WamWord pred_indic_word, WamWord which_preds_word)
 
       pred = (PredInf *) Pl_Hash_Next(&scan);
     }
+  Pl_Lock_Release(pl_pred_lock);
+
+  if (pred == NULL)
+    return FALSE;
 
 				/* non deterministic case */
   A(0) = name_word;
@@ -171,14 +176,12 @@ Pl_Current_Predicate_Alt_0(void)
 				/* here func or arity == -1 (or both) */
   all = (func == -1 && arity == -1);
 
+  Pl_Lock_Acquire(pl_pred_lock);
   for (;;)
     {
       pred = (PredInf *) Pl_Hash_Next(&scan);
       if (pred == NULL)
-	{
-	  Delete_Last_Choice_Point();
-	  return FALSE;
-	}
+	break;
 
       func1 = Functor_Of(pred->f_n);
       arity1 = Arity_Of(pred->f_n);
@@ -186,6 +189,13 @@ Pl_Current_Predicate_Alt_0(void)
       if ((all || func == func1 || arity == arity1) &&
 	  Pred_Is_Ok(pred, func1, which_preds))
 	break;
+    }
+  Pl_Lock_Release(pl_pred_lock);
+
+  if (pred == NULL)
+    {
+      Delete_Last_Choice_Point();
+      return FALSE;
     }
 
 				/* non deterministic case */
@@ -82,14 +82,14 @@ static WamWord dollar_var_1;
 static WamWord dollar_varname_1;
 static WamWord equal_2;
 
-static PlLong *singl_var_ptr;
-static PlLong nb_singl_var;
+static PL_THREAD_LOCAL PlLong *singl_var_ptr;
+static PL_THREAD_LOCAL PlLong nb_singl_var;
 
-static PlLong nb_excl_var_tabled;
+static PL_THREAD_LOCAL PlLong nb_excl_var_tabled;
 
-static PlLong nb_to_try;
+static PL_THREAD_LOCAL PlLong nb_to_try;
 
-static WamWord *above_H;
+static PL_THREAD_LOCAL WamWord *above_H;
 
 
 
@@ -133,7 +133,7 @@ Pl_Read_Term_5(WamWord sora_word, WamWord term_word,
 	  if (!pl_parse_dico_var[i].named)
 	    continue;
 	  /* pl_glob_dico_var: variable names (atoms) */
-	  pl_glob_dico_var[i] = Pl_Create_Allocate_Atom(pl_parse_dico_var[i].name);
+	  pl_glob_dico_var[i] = Pl_Create_Collectable_Atom(pl_parse_dico_var[i].name);
 
 	  word = Pl_Put_Structure(ATOM_CHAR('='), 2);
 	  Pl_Unify_Atom((int) pl_glob_dico_var[i]);
@@ -159,7 +159,7 @@ Pl_Read_Term_5(WamWord sora_word, WamWord term_word,
 	    continue;
 
 	  if ((SYS_VAR_OPTION_MASK & 2) == 0)	/* not yet allocated */
-	    pl_glob_dico_var[i] = Pl_Create_Allocate_Atom(pl_parse_dico_var[i].name);
+	    pl_glob_dico_var[i] = Pl_Create_Collectable_Atom(pl_parse_dico_var[i].name);
 
 	  word = Pl_Put_Structure(ATOM_CHAR('='), 2);
 	  Pl_Unify_Atom((int) pl_glob_dico_var[i]);
@@ -44,6 +44,8 @@
 
 #define SCAN_SUPP_FILE
 
+#define OBJ_INIT Scan_Supp_Initializer
+
 #include "engine_pl.h"
 #include "bips_pl.h"
 
@@ -62,10 +64,18 @@
  * Global Variables                *
  *---------------------------------*/
 
-static int c_orig, c;		/* for read */
-static int c_type;
+static PL_THREAD_LOCAL int c_orig, c;	/* for read */
+static PL_THREAD_LOCAL int c_type;
+
+				/* window on the stream (see below)  */
+static PL_THREAD_LOCAL char *win_start;	/* start of the window               */
+static PL_THREAD_LOCAL char *win_ptr;	/* next char to read                 */
+static PL_THREAD_LOCAL char *win_end;	/* end of the window                 */
+static PL_THREAD_LOCAL int win_nb_nl;	/* nb of \n read in the window       */
+static PL_THREAD_LOCAL char *win_line_start; /* char after the last \n read  */
+static PL_THREAD_LOCAL char *win_prev_line_start; /* idem for the previous \n */
 
-static char *err_msg;
+static PL_THREAD_LOCAL char *err_msg;
 
 
 
@@ -74,8 +84,30 @@ static char *err_msg;
  * Function Prototypes             *
  *---------------------------------*/
 
+static Bool Scan_Open_Window(StmInf *pstm);
+
+static void Scan_Sync(StmInf *pstm);
+
+static char *Scan_Token(StmInf *pstm, Bool comma_is_punct);
+
+static void Recover_After_Error(StmInf *pstm);
+
+static char *Scan_Next_Atom(StmInf *pstm);
+
+static char *Scan_Next_Number(StmInf *pstm, Bool integer_only);
+
 static int Read_Next_Char(StmInf *pstm, Bool convert);
 
+static void Scan_Unget_Last_Char(StmInf *pstm);
+
+static void Scan_Ungetc(int c, StmInf *pstm);
+
+static char *Scan_Fast_Copy(char *s, int type_mask);
+
+static char *Scan_Fast_Copy_Quoted(char *s, int c0);
+
+static void Scan_Fast_Comment(void);
+
 static void Scan_Number(StmInf *pstm, Bool integer_only);
 
 static void Scan_Quoted(StmInf *pstm);
@@ -84,7 +116,82 @@ static int Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape);
 
 
 
-#define   Unget_Last_Char       Pl_Stream_Ungetc(c_orig, pstm)
+#define   Unget_Last_Char       Scan_Unget_Last_Char(pstm)
+
+	/* position of the next char to read (taking the window into account) */
+#define   Scan_Line(pstm)       (pstm->line_count + win_nb_nl + 1)
+
+#define   Scan_Col(pstm)        ((win_nb_nl > 0)				\
+				 ? win_ptr - win_line_start			\
+				 : pstm->line_pos + (win_ptr - win_start))
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_SUPP_INITIALIZER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Supp_Initializer(void)
+{
+  Pl_Engine_Add_Buffer(&pl_token.name, SCAN_BIG_BUFFER);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * When the next characters of the stream are already in memory (stdio    *
+ * buffer of a file, string of a term stream - see Pl_Stream_Read_Window)  *
+ * the scanner reads them directly from this window instead of calling     *
+ * Pl_Stream_Getc() for each character. The line/column of a token is then *
+ * computed on demand (Scan_Line/Scan_Col) and the stream is only updated  *
+ * when the window is closed (Scan_Sync). This is done before any other    *
+ * access to the stream (push back, peek) and before returning from the    *
+ * public scanning functions. The window is not used if char_conversion is *
+ * on (each character must then be converted).                             *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * SCAN_OPEN_WINDOW                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Scan_Open_Window(StmInf *pstm)
+{
+  char *p, *end;
+
+  if (Flag_Value(char_conversion) ||
+      (p = Pl_Stream_Read_Window(pstm, &end)) == NULL || p == end)
+    return FALSE;
+
+  win_start = win_ptr = p;
+  win_end = end;
+  win_nb_nl = 0;
+  win_line_start = NULL;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_SYNC                                                               *
+ *                                                                         *
+ * Consumes the characters read in the window and closes it.              *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Sync(StmInf *pstm)
+{
+  if (win_start == NULL)
+    return;
+
+  Pl_Stream_Read_Skip(pstm, win_ptr, win_nb_nl, win_line_start);
+  win_start = win_ptr = win_end = NULL;
+  win_nb_nl = 0;
+}
 
 
 
@@ -98,6 +205,10 @@ Pl_Scan_Peek_Char(StmInf *pstm, Bool convert)
 {
   int c_look;
 
+  if (win_ptr < win_end)
+    return (unsigned char) *win_ptr;
+
+  Scan_Sync(pstm);
   c_look = Pl_Stream_Peekc(pstm);
 
   if (convert)
@@ -116,17 +227,35 @@ Pl_Scan_Peek_Char(StmInf *pstm, Bool convert)
 static int
 Read_Next_Char(StmInf *pstm, Bool convert)
 {
-  c_orig = c = Pl_Stream_Getc(pstm);
-
-  if (c == EOF)
-    c_type = 0;
-  else
+  if (win_ptr == win_end)	/* window exhausted (or closed) */
     {
-      if (convert)
-	c = Char_Conversion(c);
+      Scan_Sync(pstm);
+      if (!Scan_Open_Window(pstm))
+	{
+	  c_orig = c = Pl_Stream_Getc(pstm);
+
+	  if (c == EOF)
+	    c_type = 0;
+	  else
+	    {
+	      if (convert)
+		c = Char_Conversion(c);
 
-      c_type = pl_char_type[c];
+	      c_type = pl_char_type[c];
+	    }
+
+	  return c;
+	}
+    }
+
+  c_orig = c = (unsigned char) *win_ptr++;
+  if (c == '\n')
+    {
+      win_nb_nl++;
+      win_prev_line_start = win_line_start;
+      win_line_start = win_ptr;
     }
+  c_type = pl_char_type[c];
 
   return c;
 }
@@ -134,6 +263,112 @@ Read_Next_Char(StmInf *pstm, Bool convert)
 
 
 
+/*-------------------------------------------------------------------------*
+ * SCAN_UNGET_LAST_CHAR                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Unget_Last_Char(StmInf *pstm)
+{
+  if (win_ptr > win_start)	/* last char comes from the window */
+    {
+      if (*--win_ptr == '\n')
+	{
+	  win_nb_nl--;
+	  win_line_start = win_prev_line_start;
+	}
+      return;
+    }
+
+  Scan_Ungetc(c_orig, pstm);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_UNGETC                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Ungetc(int c, StmInf *pstm)
+{
+  Scan_Sync(pstm);
+  Pl_Stream_Ungetc(c, pstm);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_FAST_COPY                                                          *
+ *                                                                         *
+ * Copies in s the characters of the window whose type is in type_mask    *
+ * (which must not include LA, i.e. a newline is never consumed here).     *
+ *-------------------------------------------------------------------------*/
+static char *
+Scan_Fast_Copy(char *s, int type_mask)
+{
+  char *p = win_ptr;
+
+  while (p < win_end && (pl_char_type[(unsigned char) *p] & type_mask))
+    *s++ = *p++;
+
+  win_ptr = p;
+  return s;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_FAST_COPY_QUOTED                                                   *
+ *                                                                         *
+ * Copies in s the characters of the window which need no special         *
+ * treatment in Scan_Quoted_Char (all but the quote, \, newline and tab).  *
+ *-------------------------------------------------------------------------*/
+static char *
+Scan_Fast_Copy_Quoted(char *s, int c0)
+{
+  char *p = win_ptr;
+  int x;
+
+  while (p < win_end)
+    {
+      x = (unsigned char) *p;
+      if (x == c0 || x == '\\' || x == '\n' || x == '\t')
+	break;
+      *s++ = x;
+      p++;
+    }
+
+  win_ptr = p;
+  return s;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_FAST_COMMENT                                                       *
+ *                                                                         *
+ * Skips the characters of a % comment in the window up to the newline.   *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Fast_Comment(void)
+{
+  char *p;
+
+  if (win_ptr == win_end)
+    return;
+
+  p = (char *) memchr(win_ptr, '\n', win_end - win_ptr);
+  win_ptr = (p) ? p : win_end;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_SCAN_TOKEN                                                           *
  *                                                                         *
@@ -147,6 +382,22 @@ Read_Next_Char(StmInf *pstm, Bool convert)
  *-------------------------------------------------------------------------*/
 char *
 Pl_Scan_Token(StmInf *pstm, Bool comma_is_punct)
+{
+  char *msg = Scan_Token(pstm, comma_is_punct);
+
+  Scan_Sync(pstm);
+  return msg;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_TOKEN                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static char *
+Scan_Token(StmInf *pstm, Bool comma_is_punct)
 {
   int c0;
   char *s;
@@ -167,8 +418,8 @@ start_scan:
 
 
   pl_token.quoted = FALSE;
-  pl_token.line = pstm->line_count + 1;
-  pl_token.col = pstm->line_pos;
+  pl_token.line = Scan_Line(pstm);
+  pl_token.col = Scan_Col(pstm);
 
 
   if (c == EOF)
@@ -188,6 +439,7 @@ start_scan:
       do
 	{
 	  *s++ = c;
+	  s = Scan_Fast_Copy(s, UL | CL | SL | DI);
 	  Read_Next_Char(pstm, TRUE);
 	}
       while (c_type & (UL | CL | SL | DI));
@@ -231,8 +483,8 @@ start_scan:
 	  if (c == EOF)
 	    {
 	      pl_token.type = TOKEN_END_OF_FILE;
-	      pl_token.line = pstm->line_count + 1;
-	      pl_token.col = pstm->line_pos;
+	      pl_token.line = Scan_Line(pstm);
+	      pl_token.col = Scan_Col(pstm);
 	      err_msg = "*/ expected here for /*...*/ comment";
 	      break;
 	    }
@@ -256,14 +508,17 @@ start_scan:
 
     case CM:			/* comment character */
       do
-	Read_Next_Char(pstm, TRUE);
+	{
+	  Scan_Fast_Comment();
+	  Read_Next_Char(pstm, TRUE);
+	}
       while (c != '\n' && c != EOF);
 #if 0  // what says standard ? EOF allowed at end of %... comment ?
       if (c == EOF)
 	{
 	  pl_token.type = TOKEN_END_OF_FILE;
-	  pl_token.line = pstm->line_count + 1;
-	  pl_token.col = pstm->line_pos;
+	  pl_token.line = Scan_Line(pstm);
+	  pl_token.col = Scan_Col(pstm);
 	  err_msg = "new-line expected here for %%... comment";
 	  break;
 	}
@@ -351,6 +606,7 @@ Scan_Number(StmInf *pstm, Bool integer_only)
   do
     {
       *p++ = c;
+      p = Scan_Fast_Copy(p, DI);
       Read_Next_Char(pstm, TRUE);
     }
   while (c_type == DI);
@@ -390,13 +646,13 @@ Scan_Number(StmInf *pstm, Bool integer_only)
 #if 1
 	      if (Check_Oper(pl_atom_void, INFIX) || Check_Oper(pl_atom_void, POSTFIX))
 		{
-		  Pl_Stream_Ungetc('\'', pstm);	/* push back last ' */
-		  Pl_Stream_Ungetc('\'', pstm); /* push back first ' */
+		  Scan_Ungetc('\'', pstm);	/* push back last ' */
+		  Scan_Ungetc('\'', pstm); /* push back first ' */
 		  return;
 		}
 #endif
-	      pl_token.line = pstm->line_count + 1;
-	      pl_token.col = pstm->line_pos + 1;
+	      pl_token.line = Scan_Line(pstm);
+	      pl_token.col = Scan_Col(pstm) + 1;
 	      err_msg = "quote character expected here";
 	      return;
 	    }
@@ -406,8 +662,8 @@ Scan_Number(StmInf *pstm, Bool integer_only)
       else if (c == -2)		/* \ newline */
 	{
 	  Unget_Last_Char;		/* push back \n */
-	  Pl_Stream_Ungetc('\\', pstm); /* push back \  */
-	  Pl_Stream_Ungetc('\'', pstm); /* push back '  */
+	  Scan_Ungetc('\\', pstm); /* push back \  */
+	  Scan_Ungetc('\'', pstm); /* push back '  */
 	  return;
 	}
       else if (c < 0) 		/* \ newline   EOF   newline   tab    other error */
@@ -415,8 +671,8 @@ Scan_Number(StmInf *pstm, Bool integer_only)
 	  Unget_Last_Char;
 
 	  pl_token.type = TOKEN_FULL_STOP; /* to stop immediately Pl_Recover_After_Error */
-	  pl_token.line = pstm->line_count + 1;
-	  pl_token.col = pstm->line_pos + 1;
+	  pl_token.line = Scan_Line(pstm);
+	  pl_token.col = Scan_Col(pstm) + 1;
 	  err_msg = "character expected here";
 	  return;
 	}
@@ -443,7 +699,7 @@ Scan_Number(StmInf *pstm, Bool integer_only)
   if (p == pl_token.name)
     {
       Unget_Last_Char;		/* push back last char */
-      Pl_Stream_Ungetc(radix_c, pstm); /* push back \  */
+      Scan_Ungetc(radix_c, pstm); /* push back \  */
       return;
     }
 
@@ -459,6 +715,7 @@ Scan_Number(StmInf *pstm, Bool integer_only)
   while (c_type == DI)
     {
       *p++ = c;
+      p = Scan_Fast_Copy(p, DI);
       Read_Next_Char(pstm, TRUE);
     }
 
@@ -481,6 +738,7 @@ Scan_Number(StmInf *pstm, Bool integer_only)
       while (c_type == DI)
 	{
 	  *p++ = c;
+	  p = Scan_Fast_Copy(p, DI);
 	  Read_Next_Char(pstm, TRUE);
 	}
     }
@@ -534,6 +792,9 @@ Scan_Quoted(StmInf *pstm)
 
   for (;;)
     {
+      if (!error_found)
+	s = Scan_Fast_Copy_Quoted(s, c0);
+
       c = Scan_Quoted_Char(pstm, convert, c0, no_escape);
       if (c == -1)		/* closing quote */
 	{
@@ -575,8 +836,8 @@ Scan_Quoted(StmInf *pstm)
 
   Unget_Last_Char;
 
-  pl_token.line = pstm->line_count + 1;
-  pl_token.col = pstm->line_pos + 1;
+  pl_token.line = Scan_Line(pstm);
+  pl_token.col = Scan_Col(pstm) + 1;
 
   switch (pl_token.type)
     {
@@ -626,8 +887,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
       if (err_msg == NULL)
 	{
 	  Unget_Last_Char;
-	  pl_token.line = pstm->line_count + 1;
-	  pl_token.col = pstm->line_pos + 1;
+	  pl_token.line = Scan_Line(pstm);
+	  pl_token.col = Scan_Col(pstm) + 1;
 	  err_msg = "unexpected end of file";
 	}
       return -3;		/* -3 means EOF */
@@ -638,8 +899,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
       if (err_msg == NULL)
 	{
 	  Unget_Last_Char;
-	  pl_token.line = pstm->line_count + 1;
-	  pl_token.col = pstm->line_pos + 1;
+	  pl_token.line = Scan_Line(pstm);
+	  pl_token.col = Scan_Col(pstm) + 1;
 	  err_msg = "unexpected newline";
 	}
       return -4;		/* -4 means newline */
@@ -650,8 +911,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
       if (err_msg == NULL)
 	{
 	  Unget_Last_Char;
-	  pl_token.line = pstm->line_count + 1;
-	  pl_token.col = pstm->line_pos + 1;
+	  pl_token.line = Scan_Line(pstm);
+	  pl_token.col = Scan_Col(pstm) + 1;
 	  err_msg = "unexpected tab";
 	}
       return -5;		/* -5 means tab */
@@ -711,8 +972,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
 	{
 	  if (err_msg == NULL)
 	    {
-	      pl_token.line = pstm->line_count + 1;
-	      pl_token.col = pstm->line_pos;
+	      pl_token.line = Scan_Line(pstm);
+	      pl_token.col = Scan_Col(pstm);
 	      err_msg = "invalid character code in \\constant\\ sequence";
 	    }
 	  goto pump;
@@ -722,8 +983,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
 	{
 	  if (err_msg == NULL)
 	    {
-	      pl_token.line = pstm->line_count + 1;
-	      pl_token.col = pstm->line_pos;
+	      pl_token.line = Scan_Line(pstm);
+	      pl_token.col = Scan_Col(pstm);
 	      err_msg = "\\ expected in \\constant\\ sequence";
 	    }
 
@@ -742,8 +1003,8 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
 
   if (err_msg == NULL)
     {
-      pl_token.line = pstm->line_count + 1;
-      pl_token.col = pstm->line_pos;
+      pl_token.line = Scan_Line(pstm);
+      pl_token.col = Scan_Col(pstm);
       err_msg = "unknown escape sequence";
     }
 
@@ -760,6 +1021,20 @@ Scan_Quoted_Char(StmInf *pstm, Bool convert, int c0, Bool no_escape)
  *-------------------------------------------------------------------------*/
 void
 Pl_Recover_After_Error(StmInf *pstm)
+{
+  Recover_After_Error(pstm);
+  Scan_Sync(pstm);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RECOVER_AFTER_ERROR                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Recover_After_Error(StmInf *pstm)
 #define Next_Char   Read_Next_Char(pstm, convert); if (c == EOF) return
 {
   int c0;
@@ -855,6 +1130,22 @@ Pl_Recover_After_Error(StmInf *pstm)
  *-------------------------------------------------------------------------*/
 char *
 Pl_Scan_Next_Atom(StmInf *pstm)
+{
+  char *msg = Scan_Next_Atom(pstm);
+
+  Scan_Sync(pstm);
+  return msg;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_NEXT_ATOM                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static char *
+Scan_Next_Atom(StmInf *pstm)
 {
   char *s;
 
@@ -864,8 +1155,8 @@ Pl_Scan_Next_Atom(StmInf *pstm)
     Read_Next_Char(pstm, TRUE);
   while (c_type == LA);		/* layout character */
 
-  pl_token.line = pstm->line_count + 1;
-  pl_token.col = pstm->line_pos;
+  pl_token.line = Scan_Line(pstm);
+  pl_token.col = Scan_Col(pstm);
 
   switch (c_type)
     {
@@ -874,6 +1165,7 @@ Pl_Scan_Next_Atom(StmInf *pstm)
       do
 	{
 	  *s++ = c;
+	  s = Scan_Fast_Copy(s, UL | CL | SL | DI);
 	  Read_Next_Char(pstm, TRUE);
 	}
       while (c_type & (UL | CL | SL | DI));
@@ -935,6 +1227,22 @@ Pl_Scan_Next_Atom(StmInf *pstm)
  *-------------------------------------------------------------------------*/
 char *
 Pl_Scan_Next_Number(StmInf *pstm, Bool integer_only)
+{
+  char *msg = Scan_Next_Number(pstm, integer_only);
+
+  Scan_Sync(pstm);
+  return msg;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_NEXT_NUMBER                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static char *
+Scan_Next_Number(StmInf *pstm, Bool integer_only)
 {
   Bool minus_op = FALSE;
 
@@ -948,8 +1256,8 @@ Pl_Scan_Next_Number(StmInf *pstm, Bool integer_only)
     }
 
 
-  pl_token.line = pstm->line_count + 1;
-  pl_token.col = pstm->line_pos;
+  pl_token.line = Scan_Line(pstm);
+  pl_token.col = Scan_Col(pstm);
 
 
   if (c == '-'
@@ -90,13 +90,11 @@ TokInf;
 
 #ifdef SCAN_SUPP_FILE
 
-static char scan_tok_buffer[SCAN_BIG_BUFFER];
-
-TokInf pl_token = { .name = scan_tok_buffer, };
+PL_THREAD_LOCAL TokInf pl_token;
 
 #else
 
-extern TokInf pl_token;
+extern PL_THREAD_LOCAL TokInf pl_token;
 
 #endif
 
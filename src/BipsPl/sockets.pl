@@ -107,6 +107,13 @@ socket_accept(Socket, Client, StreamIn, StreamOut) :-
 
 
 
+socket_set_blocking(Socket, Blocking) :-
+	set_bip_name(socket_set_blocking, 2),
+	'$call_c_test'('Pl_Socket_Set_Blocking_2'(Socket, Blocking)).
+
+
+
+
 hostname_address(HostName, HostAddress) :-
 	set_bip_name(hostname_address, 2),
 	'$call_c_test'('Pl_Hostname_Address_2'(HostName, HostAddress)).
@@ -43,6 +43,8 @@
 #include <sys/types.h>
 #ifndef _WIN32
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 #else
 #include <io.h>
@@ -79,10 +81,36 @@
  * Constants                       *
  *---------------------------------*/
 
+#define SOCK_BUFF_SIZE             4096
+
+#ifdef _WIN32
+#define Sock_Would_Block()         (WSAGetLastError() == WSAEWOULDBLOCK)
+#define Sock_Interrupted()         (WSAGetLastError() == WSAEINTR)
+#else
+#define Sock_Would_Block()         (errno == EAGAIN || errno == EWOULDBLOCK)
+#define Sock_Interrupted()         (errno == EINTR)
+#endif
+
+
+
+
 /*---------------------------------*
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* Socket stream information      */
+{				/* ------------------------------ */
+  int fd;			/* the descriptor of the stream   */
+  StmInf *pstm;			/* the stream                     */
+  char *buff;			/* the buffer (input or output)   */
+  int buff_size;		/* its allocated size             */
+  int mark;			/* in: start of the current read  */
+  int ptr;			/* in: next char, out: next sent  */
+  int end;			/* end of the data in the buffer  */
+  int read_stamp;		/* see Pl_Stream_Read_Mark        */
+}
+SockInf;
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
@@ -102,6 +130,18 @@ static int atom_AF_INET;
 static Bool Create_Socket_Streams(int sock, char *stream_name,
 				  int *stm_in, int *stm_out);
 
+static int Add_Socket_Stream(int fd, int atom, Bool input);
+
+static int Sock_Getc(SockInf *sock);
+
+static int Sock_Putc(int c, SockInf *sock);
+
+static int Sock_Flush(SockInf *sock);
+
+static int Sock_Close(SockInf *sock);
+
+static void Sock_Wait_Writable(SockInf *sock);
+
 
 
 
@@ -464,7 +504,7 @@ Pl_Socket_Accept_4(WamWord socket_word, WamWord client_word,
       cli_ip_adr = inet_ntoa(adr_in.sin_addr);
       if (cli_ip_adr == NULL)
 	return FALSE;
-      Pl_Get_Atom(Pl_Create_Allocate_Atom(cli_ip_adr), client_word);
+      Pl_Get_Atom(Pl_Create_Collectable_Atom(cli_ip_adr), client_word);
     }
 
   sprintf(stream_name, "socket_stream(accept('%s'),%d)", cli_ip_adr, cli_sock);
@@ -508,40 +548,310 @@ Pl_Assoc_Socket_Streams_3(WamWord socket_word,
 /*-------------------------------------------------------------------------*
  * CREATE_SOCKET_STREAMS                                                   *
  *                                                                         *
+ * Socket streams do not use stdio: a non-blocking socket could make stdio *
+ * lose output or report an end of file when no data is available.         *
  *-------------------------------------------------------------------------*/
 static Bool
 Create_Socket_Streams(int sock, char *stream_name, int *stm_in, int *stm_out)
 {
-  int fd;
-  FILE *f_in, *f_out;
+  int fd_in, fd_out;
   int atom;
+
+#ifdef _WIN32
+  Os_Test_Error((fd_in = _open_osfhandle(sock, _O_BINARY | _O_RDWR | _O_BINARY)));
+  Os_Test_Error((fd_out = dup(fd_in)));
+#else
+  fd_in = sock;
+  Os_Test_Error((fd_out = dup(sock)));
+#endif
+
+  atom = Pl_Create_Allocate_Atom(stream_name);
+
+  *stm_in = Add_Socket_Stream(fd_in, atom, TRUE);
+  *stm_out = Add_Socket_Stream(fd_out, atom, FALSE);
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ADD_SOCKET_STREAM                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Add_Socket_Stream(int fd, int atom, Bool input)
+{
+  SockInf *sock;
+  StmProp prop;
   int stm;
 
+  sock = (SockInf *) Malloc(sizeof(SockInf));
+  sock->fd = fd;
+  sock->buff = (char *) Malloc(SOCK_BUFF_SIZE);
+  sock->buff_size = SOCK_BUFF_SIZE;
+  sock->mark = sock->ptr = sock->end = 0;
+  sock->read_stamp = 0;
+
+  prop.mode = (input) ? STREAM_MODE_READ : STREAM_MODE_WRITE;
+  prop.input = input;
+  prop.output = !input;
+  prop.text = TRUE;
+  prop.reposition = FALSE;
+  prop.eof_action = (input) ? STREAM_EOF_ACTION_RESET : STREAM_EOF_ACTION_EOF_CODE;
+  prop.buffering = STREAM_BUFFERING_LINE;
+  prop.special_close = FALSE;
+  prop.other = SOCKET_STREAM;
+
+  stm = Pl_Add_Stream(atom, sock, fd, prop,
+		      (StmFct) Sock_Getc, (StmFct) Sock_Putc,
+		      (StmFct) Sock_Flush, (StmFct) Sock_Close,
+		      STREAM_FCT_UNDEFINED, STREAM_FCT_UNDEFINED,
+		      STREAM_FCT_UNDEFINED);
+  sock->pstm = pl_stm_tbl[stm];
+
+  return stm;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SOCK_GETC                                                               *
+ *                                                                         *
+ * The characters from the mark are kept while a read is in progress (see *
+ * Pl_Stream_Read_Mark). If no data is available on a non-blocking socket, *
+ * goes back to the mark and returns STREAM_WOULD_BLOCK.                   *
+ *-------------------------------------------------------------------------*/
+static int
+Sock_Getc(SockInf *sock)
+{
+  int n;
+
+  if (Pl_Stream_Read_Mark(sock, &sock->read_stamp))
+    sock->mark = sock->ptr;
+
+  if (sock->ptr < sock->end)
+    return (unsigned char) sock->buff[sock->ptr++];
+
+  if (sock->mark > 0)		/* discard the chars before the mark */
+    {
+      memmove(sock->buff, sock->buff + sock->mark, sock->end - sock->mark);
+      sock->ptr -= sock->mark;
+      sock->end -= sock->mark;
+      sock->mark = 0;
+    }
+
+  if (sock->end == sock->buff_size) /* a long read in progress */
+    {
+      sock->buff_size *= 2;
+      sock->buff = (char *) Realloc(sock->buff, sock->buff_size);
+    }
+
+  do
+    {
 #ifdef _WIN32
-  int r;
+      n = recv((SOCKET) _get_osfhandle(sock->fd), sock->buff + sock->end,
+	       sock->buff_size - sock->end, 0);
+#else
+      n = read(sock->fd, sock->buff + sock->end, sock->buff_size - sock->end);
+#endif
+    }
+  while (n < 0 && Sock_Interrupted());
+
+  if (n > 0)
+    {
+      sock->end += n;
+      return (unsigned char) sock->buff[sock->ptr++];
+    }
+
+  if (n < 0 && Sock_Would_Block())
+    {
+      sock->ptr = sock->mark;
+      return STREAM_WOULD_BLOCK;
+    }
+
+  return EOF;
+}
+
+
 
-  Os_Test_Error((fd = _open_osfhandle(sock, _O_BINARY | _O_RDWR | _O_BINARY)));
-  Os_Test_Error((r = dup(fd)));
-  Os_Test_Error_Null((f_out = fdopen(fd, "w")));
-  Os_Test_Error_Null((f_in = fdopen(r, "r")));
+
+/*-------------------------------------------------------------------------*
+ * SOCK_PUTC                                                               *
+ *                                                                         *
+ * The buffer grows if a non-blocking socket cannot send its content.      *
+ *-------------------------------------------------------------------------*/
+static int
+Sock_Putc(int c, SockInf *sock)
+{
+  if (sock->end == sock->buff_size)
+    {
+      Sock_Flush(sock);
+      if (sock->end == sock->buff_size)
+	{
+	  sock->buff_size *= 2;
+	  sock->buff = (char *) Realloc(sock->buff, sock->buff_size);
+	}
+    }
+
+  sock->buff[sock->end++] = (char) c;
+
+  if (sock->pstm->prop.buffering == STREAM_BUFFERING_NONE ||
+      (c == '\n' && sock->pstm->prop.buffering == STREAM_BUFFERING_LINE))
+    Sock_Flush(sock);
+
+  return c;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SOCK_FLUSH                                                              *
+ *                                                                         *
+ * Sends as much as possible. On a non-blocking socket the data which      *
+ * cannot be sent at once is kept for a next flush.                        *
+ *-------------------------------------------------------------------------*/
+static int
+Sock_Flush(SockInf *sock)
+{
+  int n;
+
+  while (sock->ptr < sock->end)
+    {
+#ifdef _WIN32
+      n = send((SOCKET) _get_osfhandle(sock->fd), sock->buff + sock->ptr,
+	       sock->end - sock->ptr, 0);
 #else
-  Os_Test_Error((fd = dup(sock)));
-  Os_Test_Error_Null((f_in = fdopen(sock, "rt")));
-  Os_Test_Error_Null((f_out = fdopen(fd, "wt")));
+      n = write(sock->fd, sock->buff + sock->ptr, sock->end - sock->ptr);
 #endif
+      if (n >= 0)
+	sock->ptr += n;
+      else if (Sock_Would_Block())
+	break;
+      else if (!Sock_Interrupted())
+	{
+	  sock->ptr = sock->end = 0; /* e.g. closed by peer: lost */
+	  return EOF;
+	}
+    }
+
+  if (sock->ptr > 0)
+    {
+      memmove(sock->buff, sock->buff + sock->ptr, sock->end - sock->ptr);
+      sock->end -= sock->ptr;
+      sock->ptr = 0;
+    }
+
+  return 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SOCK_CLOSE                                                              *
+ *                                                                         *
+ * The output kept by a non-blocking socket is sent before closing.        *
+ *-------------------------------------------------------------------------*/
+static int
+Sock_Close(SockInf *sock)
+{
+  int ret;
+
+  if (sock->pstm->prop.output)
+    while (Sock_Flush(sock) == 0 && sock->end > 0)
+      Sock_Wait_Writable(sock);
+
+  ret = close(sock->fd);
+
+  Free(sock->buff);
+  Free(sock);
+
+  return ret;
+}
 
-  atom = Pl_Create_Allocate_Atom(stream_name);
 
-  stm = Pl_Add_Stream_For_Stdio_Desc(f_in, atom, STREAM_MODE_READ, TRUE, FALSE);
-  pl_stm_tbl[stm]->prop.eof_action = STREAM_EOF_ACTION_RESET;
-  pl_stm_tbl[stm]->prop.other = 4;
 
-  *stm_in = stm;
 
-  stm = Pl_Add_Stream_For_Stdio_Desc(f_out, atom, STREAM_MODE_WRITE, TRUE, FALSE);
-  pl_stm_tbl[stm]->prop.other = 4;
+/*-------------------------------------------------------------------------*
+ * SOCK_WAIT_WRITABLE                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Sock_Wait_Writable(SockInf *sock)
+{
+#ifdef _WIN32
+  fd_set set;
+
+  FD_ZERO(&set);
+  FD_SET((SOCKET) _get_osfhandle(sock->fd), &set);
+  select(0, NULL, &set, NULL, NULL);
+#else
+  struct pollfd pfd;
+
+  pfd.fd = sock->fd;
+  pfd.events = POLLOUT;
+  poll(&pfd, 1, -1);
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_SOCKET_SET_BLOCKING_2                                                *
+ *                                                                         *
+ * The item is a socket descriptor or a stream (e.g. created by            *
+ * socket_accept/4). The flag is shared by the descriptors of a socket, so *
+ * both streams of a connection change mode together.                      *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Socket_Set_Blocking_2(WamWord item_word, WamWord blocking_word)
+{
+  WamWord word, tag_mask;
+  int fd, stm;
+  Bool blocking;
+
+  DEREF(item_word, word, tag_mask);
+  if (tag_mask == TAG_REF_MASK)
+    Pl_Err_Instantiation();
+
+  if (tag_mask == TAG_INT_MASK)
+    fd = Pl_Rd_C_Int_Positive_Check(word);
+  else
+    {
+      stm = Pl_Get_Stream_Or_Alias(word, STREAM_CHECK_EXIST);
+      fd = Pl_Io_Fileno_Of_Stream(stm);
+      if (fd < 0)
+	Pl_Err_Domain(pl_domain_selectable_item, word);
+#ifdef _WIN32
+      fd = (int) _get_osfhandle(fd);
+#endif
+    }
+
+  blocking = Pl_Rd_Boolean_Check(blocking_word);
 
-  *stm_out = stm;
+#ifdef _WIN32
+  {
+    u_long mode = !blocking;
+
+    Os_Test_Error(ioctlsocket((SOCKET) fd, FIONBIO, &mode));
+  }
+#else
+  {
+    int flags;
+
+    Os_Test_Error((flags = fcntl(fd, F_GETFL)));
+    if (blocking)
+      flags &= ~O_NONBLOCK;
+    else
+      flags |= O_NONBLOCK;
+    Os_Test_Error(fcntl(fd, F_SETFL, flags));
+  }
+#endif
 
   return TRUE;
 }
@@ -48,6 +48,7 @@
 #include <io.h>
 #endif
 
+#define OBJ_INIT Src_Rdr_Initializer
 
 #include "engine_pl.h"
 #include "bips_pl.h"
@@ -169,10 +170,11 @@ typedef struct
  * Global Variables                *
  *---------------------------------*/
 
-static SRInf *sr_tbl = NULL;	/* table (mallocated) */
-static int sr_tbl_size = 0;	/* allocated size */
-static int sr_last_used = -1;	/* last sr used */
-static SRInf *cur_sr;		/* the current sr entry used */
+				/* source readers: private to each engine */
+static PL_THREAD_LOCAL SRInf *sr_tbl = NULL;	/* table (mallocated) */
+static PL_THREAD_LOCAL int sr_tbl_size = 0;	/* allocated size */
+static PL_THREAD_LOCAL int sr_last_used = -1;	/* last sr used */
+static PL_THREAD_LOCAL SRInf *cur_sr;		/* the current sr entry used */
 
 
 
@@ -236,6 +238,21 @@ Prolog_Prototype(SR_CURRENT_DESC_ALT, 0);
  */
 
 
+
+
+/*-------------------------------------------------------------------------*
+ * SRC_RDR_INITIALIZER                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Src_Rdr_Initializer(void)
+{
+  Pl_Engine_Add_Context(&sr_tbl, sizeof(sr_tbl));
+  Pl_Engine_Add_Context(&sr_tbl_size, sizeof(sr_tbl_size));
+  Pl_Engine_Add_Context(&sr_last_used, sizeof(sr_last_used));
+}
+
+
 /*-------------------------------------------------------------------------*
  * PL_SR_INIT_OPEN_2                                                       *
  *                                                                         *
@@ -357,6 +374,7 @@ Pl_SR_Open_File_2(WamWord file_name_word, WamWord from_stream_word)
 	}
       pstm = pl_stm_tbl[stm];
       file = (SRFile *) Malloc(sizeof(SRFile));
+      Pl_Keep_Atom(atom_file_name);
       file->atom_file_name = atom_file_name;
       file->stm = stm;
       file->reposition = pstm->prop.reposition;
@@ -798,6 +816,7 @@ Pl_SR_Start_Module_3(WamWord module_name_word, WamWord interface_word,
 		  pl_atom_tbl[atom_module_name].name);
 	}
       m = (SRModule *) Malloc(sizeof(SRModule));
+      Pl_Keep_Atom(atom_module_name);
       m->atom_module_name = atom_module_name;
       m->i_atom_file_def = sr->file_top->atom_file_name;
       m->i_line_def = sr->cur_l1;
@@ -80,6 +80,10 @@ statistics(Key, Values) :-
 
 '$check_stat_key'(atoms).
 
+'$check_stat_key'(garbage_collection).
+
+'$check_stat_key'(atom_garbage_collection).
+
 '$check_stat_key'(Key) :-
 	'$pl_err_domain'(statistics_key, Key).
 
@@ -119,6 +123,26 @@ statistics(Key, Values) :-
 '$stat'(atoms, Used, Free) :-
 	'$call_c_test'('Pl_Statistics_Atoms_2'(Used, Free)).
 
+'$stat'(garbage_collection, Nb, Reclaimed) :-
+	'$call_c_test'('Pl_Statistics_Garbage_Collection_2'(Nb, Reclaimed)).
+
+'$stat'(atom_garbage_collection, Nb, Reclaimed) :-
+	'$call_c_test'('Pl_Statistics_Atom_Garbage_Collection_2'(Nb, Reclaimed)).
+
+
+
+
+garbage_collect :-
+	set_bip_name(garbage_collect, 0),
+	'$call_c'('Pl_Garbage_Collect_0').
+
+
+
+
+garbage_collect_atoms :-
+	set_bip_name(garbage_collect_atoms, 0),
+	'$call_c'('Pl_Garbage_Collect_Atoms_0').
+
 
 
 
@@ -36,6 +36,8 @@
  *-------------------------------------------------------------------------*/
 
 
+#define OBJ_INIT Stat_Initializer
+
 #include "engine_pl.h"
 #include "bips_pl.h"
 
@@ -54,10 +56,10 @@
  * Global Variables                *
  *---------------------------------*/
 
-static PlLong last_user_time = 0;
-static PlLong last_system_time = 0;
-static PlLong last_cpu_time = 0;
-static PlLong last_real_time = 0;
+static PL_THREAD_LOCAL PlLong last_user_time = 0; /* private to each engine */
+static PL_THREAD_LOCAL PlLong last_system_time = 0;
+static PL_THREAD_LOCAL PlLong last_cpu_time = 0;
+static PL_THREAD_LOCAL PlLong last_real_time = 0;
 
 
 
@@ -71,6 +73,22 @@ static void Stack_Size(int stack_nb, PlLong *used, PlLong *free);
 
 
 
+/*-------------------------------------------------------------------------*
+ * STAT_INITIALIZER                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Stat_Initializer(void)
+{
+  Pl_Engine_Add_Context(&last_user_time, sizeof(last_user_time));
+  Pl_Engine_Add_Context(&last_system_time, sizeof(last_system_time));
+  Pl_Engine_Add_Context(&last_cpu_time, sizeof(last_cpu_time));
+  Pl_Engine_Add_Context(&last_real_time, sizeof(last_real_time));
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_STATISTICS_0                                                         *
  *                                                                         *
@@ -107,6 +125,13 @@ Pl_Statistics_0(void)
 #else
   Pl_Stream_Printf(pstm, "\nAtoms: %10d  %10d max\n", pl_nb_atom, pl_max_atom);
 #endif
+
+  Pl_Stream_Printf(pstm, "\nGarbage collection  collections       reclaimed            time\n\n");
+  Pl_Stream_Printf(pstm, "   global stack %10" PL_FMT_d "    %10" PL_FMT_d " Kb %11.3f sec\n",
+		   pl_gc_nb_collections, (PlLong) (pl_gc_reclaimed * sizeof(WamWord) / 1024),
+		   (double) pl_gc_time / 1000.0);
+  Pl_Stream_Printf(pstm, "   atoms        %10" PL_FMT_d "    %10" PL_FMT_d " atoms\n",
+		   pl_atom_gc_nb_collections, pl_atom_gc_reclaimed);
   
 
   t[0] = Pl_M_User_Time();
@@ -320,6 +345,61 @@ Pl_Statistics_Atoms_2(WamWord used_word, WamWord free_word)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_STATISTICS_GARBAGE_COLLECTION_2                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Statistics_Garbage_Collection_2(WamWord nb_word, WamWord reclaimed_word)
+{
+  return Pl_Un_Integer_Check(pl_gc_nb_collections, nb_word) &&
+    Pl_Un_Integer_Check((PlLong) (pl_gc_reclaimed * sizeof(WamWord)), reclaimed_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GARBAGE_COLLECT_0                                                    *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Garbage_Collect_0(void)
+{
+  Pl_GC_Collect(0);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_STATISTICS_ATOM_GARBAGE_COLLECTION_2                                 *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Statistics_Atom_Garbage_Collection_2(WamWord nb_word, WamWord reclaimed_word)
+{
+  return Pl_Un_Integer_Check(pl_atom_gc_nb_collections, nb_word) &&
+    Pl_Un_Integer_Check(pl_atom_gc_reclaimed, reclaimed_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GARBAGE_COLLECT_ATOMS_0                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Garbage_Collect_Atoms_0(void)
+{
+  Pl_Atom_GC_Request();
+  Pl_GC_Collect(0);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * STACK_SIZE                                                              *
  *                                                                         *
@@ -289,6 +289,7 @@ Pl_Open_3(WamWord source_sink_word, WamWord mode_word, WamWord stm_word)
       }
   mask >>= 3;
 
+  Pl_Keep_Atom(atom_file_name);
   pl_stm_tbl[stm]->atom_file_name = atom_file_name;
   pl_stm_tbl[stm]->prop = prop;
 
@@ -971,23 +972,27 @@ Pl_Current_Alias_2(WamWord stm_word, WamWord alias_word)
   if (tag_mask != TAG_REF_MASK)
     return Pl_Find_Stream_By_Alias(Pl_Rd_Atom_Check(word)) == stm;
 
+  Pl_Lock_Acquire(pl_stm_lock);
+
   for (alias = (AliasInf *) Pl_Hash_First(pl_alias_tbl, &scan); alias;
        alias = (AliasInf *) Pl_Hash_Next(&scan))
-    if (alias->stm == stm)
+    if (Alias_Stm(alias) == stm)
       break;
 
-  if (alias == NULL)
-    return FALSE;
-
   save_alias = alias;
 
-  for (;;)
+  while (alias)
     {
       alias = (AliasInf *) Pl_Hash_Next(&scan);
-      if (alias == NULL || alias->stm == stm)
+      if (alias == NULL || Alias_Stm(alias) == stm)
 	break;
     }
 
+  Pl_Lock_Release(pl_stm_lock);
+
+  if (save_alias == NULL)
+    return FALSE;
+
 
   if (alias)			/* non deterministic case */
     {
@@ -1033,12 +1038,14 @@ Pl_Current_Alias_Alt_0(void)
 
   save_alias = alias;
 
+  Pl_Lock_Acquire(pl_stm_lock);
   for (;;)
     {
       alias = (AliasInf *) Pl_Hash_Next(&scan);
-      if (alias == NULL || alias->stm == stm)
+      if (alias == NULL || Alias_Stm(alias) == stm)
 	break;
     }
+  Pl_Lock_Release(pl_stm_lock);
 
 
   if (alias)			/* non deterministic case */
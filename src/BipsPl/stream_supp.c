@@ -78,6 +78,18 @@ extern void clearerr(FILE *stream);
 
 #define START_ALIAS_TBL_SIZE       128
 
+	/* direct access to the read buffer of a stdio FILE (if known) */
+#if defined(__GLIBC__)
+#define STDIO_READ_PTR(f)          ((f)->_IO_read_ptr)
+#define STDIO_READ_END(f)          ((f)->_IO_read_end)
+#define STDIO_READ_SET(f, p)       ((f)->_IO_read_ptr = (p))
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#define STDIO_READ_PTR(f)          ((char *) (f)->_p)
+#define STDIO_READ_END(f)          ((char *) (f)->_p + (f)->_r)
+#define STDIO_READ_SET(f, p)       ((f)->_r -= (int) ((p) - (char *) (f)->_p), \
+                                    (f)->_p = (unsigned char *) (p))
+#endif
+
 #define STR_STREAM_WRITE_BLOCK     1024
 
 #define TTY_BUFFER_SIZE            10240
@@ -98,6 +110,22 @@ extern void clearerr(FILE *stream);
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* Start of a term read           */
+{				/* ------------------------------ */
+  StmInf *pstm;			/* the stream (NULL if none)      */
+  void *file;			/* its accessor                   */
+  int stamp;			/* incremented at each start      */
+  PlLong char_count;		/* position at the start          */
+  PlLong line_count;		/*                                */
+  PlLong line_pos;		/*                                */
+  PbStk pb_char;		/* push back stacks at the start  */
+  PbStk pb_line_pos;		/*                                */
+}
+ReadMark;
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
@@ -105,6 +133,9 @@ extern void clearerr(FILE *stream);
 static void Init_Stream_Supp(void);
 void (*pl_init_stream_supp)(void) = Init_Stream_Supp; /* overwrite var of engine.c */
 
+PL_THREAD_LOCAL PlLong pl_last_read_line; /* see parse_supp.h */
+PL_THREAD_LOCAL PlLong pl_last_read_col;
+
 static int atom_constant_term_stream;
 
 static WamWord stream_1;
@@ -112,14 +143,17 @@ static WamWord stream_1;
 static WamWord word_current_input_stream;
 static WamWord word_current_output_stream;
 
-static StrSInf static_str_stream_rd = { NULL, NULL, 0 }; /* input */
-static StrSInf static_str_stream_wr = { NULL, NULL, 0 }; /* output */
+static StrSInf static_str_stream_rd = { NULL, NULL, NULL, 0 }; /* input */
+static StrSInf static_str_stream_wr = { NULL, NULL, NULL, 0 }; /* output */
 
+static PL_THREAD_LOCAL ReadMark read_mark;
 
-#ifndef NO_USE_LINEDIT
-static char tty_first_buff[TTY_BUFFER_SIZE];	/* current buffer (end with '\0') */
-static char *tty_buff;
-static char *tty_ptr = NULL;	/* current pointer into the buff  */
+
+#ifndef NO_USE_LINEDIT		/* per engine (see Init_Stream_Supp) */
+static PL_THREAD_LOCAL char *tty_first_buff; /* current buffer (end with '\0') */
+static PL_THREAD_LOCAL char *tty_buff;
+static PL_THREAD_LOCAL char *tty_ptr = NULL;	/* current pointer into the buff  */
+static PL_THREAD_LOCAL int tty_linedit_depth = 0;
 #endif
 
 
@@ -155,6 +189,8 @@ static int Str_Stream_Getc(StrSInf *str_stream);
 
 static void Str_Stream_Putc(int c, StrSInf *str_stream);
 
+static void Stream_Would_Block(StmInf *pstm);
+
 
 
 
@@ -177,6 +213,9 @@ Init_Stream_Supp(void)
   pl_stm_last_used = -1;
 
   pl_alias_tbl = Pl_Hash_Alloc_Table(START_ALIAS_TBL_SIZE, sizeof(AliasInf));
+  pl_stm_lock = Pl_Lock_Create();
+
+  Pl_Engine_Add_Context(&read_mark, sizeof(read_mark));
 
   pl_atom_stream = Pl_Create_Atom("$stream");
   stream_1 = Functor_Arity(pl_atom_stream, 1);
@@ -230,6 +269,14 @@ Init_Stream_Supp(void)
 
   pl_le_prompt = "";
   pl_use_le_prompt = TRUE;
+  Pl_Engine_Add_Context(&pl_le_prompt, sizeof(pl_le_prompt));
+  Pl_Engine_Add_Context(&pl_use_le_prompt, sizeof(pl_use_le_prompt));
+#ifndef NO_USE_LINEDIT
+  Pl_Engine_Add_Buffer(&tty_first_buff, TTY_BUFFER_SIZE);
+  Pl_Engine_Add_Context(&tty_buff, sizeof(tty_buff));
+  Pl_Engine_Add_Context(&tty_ptr, sizeof(tty_ptr));
+  Pl_Engine_Add_Context(&tty_linedit_depth, sizeof(tty_linedit_depth));
+#endif
 
 
   
@@ -283,8 +330,10 @@ Init_Stream_Supp(void)
   pl_alias_user_output = Pl_Set_Alias_To_Stream(pl_atom_user_output, pl_stm_stdout, TRUE);
   pl_alias_user_error = Pl_Set_Alias_To_Stream(pl_atom_user_error, pl_stm_stderr, TRUE);
 
-  pl_alias_current_input = Pl_Set_Alias_To_Stream(pl_atom_current_input, pl_stm_stdin, TRUE); 
-  pl_alias_current_output = Pl_Set_Alias_To_Stream(pl_atom_current_output, pl_stm_stdout, TRUE);
+  Pl_Set_Alias_To_Stream(pl_atom_current_input, pl_stm_stdin, TRUE);
+  Pl_Set_Alias_To_Stream(pl_atom_current_output, pl_stm_stdout, TRUE);
+  Pl_Engine_Add_Context(&pl_stm_current_input, sizeof(pl_stm_current_input));
+  Pl_Engine_Add_Context(&pl_stm_current_output, sizeof(pl_stm_current_output));
 
   pl_alias_top_level_input = Pl_Set_Alias_To_Stream(pl_atom_top_level_input, pl_stm_stdin, TRUE);
   pl_alias_top_level_output = Pl_Set_Alias_To_Stream(pl_atom_top_level_output, pl_stm_stdout, TRUE);
@@ -407,6 +456,7 @@ Init_Stream_Struct(int atom_file_name, void *file, int fileno, StmProp prop,
 		   StmFct fct_tell, StmFct fct_seek, StmFct fct_clearerr,
 		   StmInf *pstm)
 {
+  Pl_Keep_Atom(atom_file_name); /* its name can be kept (e.g. last syntax error) */
   pstm->atom_file_name = atom_file_name;
   pstm->file = file;
   pstm->fileno = fileno;
@@ -452,17 +502,20 @@ Pl_Add_Stream(int atom_file_name, void *file, int fileno, StmProp prop,
   int stm;
   StmInf *pstm;
 
-  stm = Find_Free_Stream();
-
   if (prop.reposition && (fct_tell == STREAM_FCT_UNDEFINED || fct_seek == STREAM_FCT_UNDEFINED))
     Pl_Fatal_Error(ERR_TELL_OR_SEEK_UNDEFINED);
 
+  Pl_Lock_Acquire(pl_stm_lock);
+
+  stm = Find_Free_Stream();
 
   pstm = pl_stm_tbl[stm];
   Init_Stream_Struct(atom_file_name, file, fileno, prop, fct_getc, fct_putc,
 		     fct_flush, fct_close, fct_tell, fct_seek, fct_clearerr,
 		     pstm);
 
+  Pl_Lock_Release(pl_stm_lock);
+
   return stm;
 }
 
@@ -476,18 +529,22 @@ Pl_Add_Stream(int atom_file_name, void *file, int fileno, StmProp prop,
 void
 Pl_Delete_Stream(int stm, Bool keep_stream)
 {
+  Pl_Lock_Acquire(pl_stm_lock);
+
   Del_Aliases_Of_Stream(stm);
 
-  if (keep_stream)
-    return;
+  if (!keep_stream)
+    {
+      Update_Mirrors_To_Del_Stream(stm);
 
-  Update_Mirrors_To_Del_Stream(stm);
+      Free(pl_stm_tbl[stm]);
+      pl_stm_tbl[stm] = NULL;
 
-  Free(pl_stm_tbl[stm]);
-  pl_stm_tbl[stm] = NULL;
+      while(pl_stm_tbl[pl_stm_last_used] == NULL)
+	pl_stm_last_used--;
+    }
 
-  while(pl_stm_tbl[pl_stm_last_used] == NULL)
-    pl_stm_last_used--;
+  Pl_Lock_Release(pl_stm_lock);
 }
 
 
@@ -496,18 +553,32 @@ Pl_Delete_Stream(int stm, Bool keep_stream)
 /*-------------------------------------------------------------------------*
  * FIND_FREE_STREAM                                                        *
  *                                                                         *
+ * Called with pl_stm_lock held. With PARALLEL_ENGINES the old table is    *
+ * not freed when it grows since other engines read it without lock.      *
  *-------------------------------------------------------------------------*/
 static int
 Find_Free_Stream(void)
 {
   int stm;
+#ifdef PARALLEL_ENGINES
+  StmInf **new_tbl;
+#endif
 
   for (stm = 0; stm < pl_stm_tbl_size; stm++)
     if (pl_stm_tbl[stm] == NULL)
       break;
 
   if (stm == pl_stm_tbl_size)
-    Pl_Extend_Array((char **) &pl_stm_tbl, &pl_stm_tbl_size, sizeof(StmInf *), TRUE);
+    {
+#ifdef PARALLEL_ENGINES
+      new_tbl = (StmInf **) Calloc(pl_stm_tbl_size * 2, sizeof(StmInf *));
+      memcpy(new_tbl, pl_stm_tbl, pl_stm_tbl_size * sizeof(StmInf *));
+      pl_stm_tbl = new_tbl;
+      pl_stm_tbl_size *= 2;
+#else
+      Pl_Extend_Array((char **) &pl_stm_tbl, &pl_stm_tbl_size, sizeof(StmInf *), TRUE);
+#endif
+    }
 
   pl_stm_tbl[stm] = (StmInf *) Malloc(sizeof(StmInf));
 
@@ -528,10 +599,14 @@ int
 Pl_Find_Stream_By_Alias(int atom_alias)
 {
   AliasInf *alias;
+  int stm;
 
+  Pl_Lock_Acquire(pl_stm_lock);
   alias = (AliasInf *) Pl_Hash_Find(pl_alias_tbl, atom_alias);
+  stm = (alias == NULL) ? -1 : Alias_Stm(alias);
+  Pl_Lock_Release(pl_stm_lock);
 
-  return (alias == NULL) ? -1 : alias->stm;
+  return stm;
 }
 
 
@@ -547,27 +622,34 @@ Pl_Set_Alias_To_Stream(int atom_alias, int stm, Bool reassign)
   AliasInf *alias;
   AliasInf alias_info;
 
-  alias = (AliasInf *) Pl_Hash_Find(pl_alias_tbl, atom_alias);
-  if (alias != NULL)
-    {
-      if (!reassign) /* return NULL if the alias is assigned to another stream */
-	return (alias->stm == stm) ? alias : NULL; 
+  Pl_Lock_Acquire(pl_stm_lock);
 
-      alias->stm = stm;		/* reassign it */
-      if (alias->atom == pl_atom_current_input)
-	pl_stm_current_input = stm;
-      else if (alias->atom == pl_atom_current_output)
-	pl_stm_current_output = stm;
+  alias = (AliasInf *) Pl_Hash_Find(pl_alias_tbl, atom_alias);
+  if (alias != NULL && !reassign)
+    {	       /* return NULL if the alias is assigned to another stream */
+      if (Alias_Stm(alias) != stm)
+	alias = NULL;
 
+      Pl_Lock_Release(pl_stm_lock);
       return alias;
-    }      
+    }
+
+  if (alias == NULL)
+    {
+      Pl_Extend_Table_If_Needed(&pl_alias_tbl);
 
-  Pl_Extend_Table_If_Needed(&pl_alias_tbl);
+      Pl_Keep_Atom(atom_alias);
+      alias_info.atom = atom_alias;
+      alias = (AliasInf *) Pl_Hash_Insert(pl_alias_tbl, (char *) &alias_info, FALSE);
+    }
 
-  alias_info.atom = atom_alias;
-  alias_info.stm = stm;
+  alias->stm = stm;		/* (re)assign it */
+  if (atom_alias == pl_atom_current_input)
+    pl_stm_current_input = stm;
+  else if (atom_alias == pl_atom_current_output)
+    pl_stm_current_output = stm;
 
-  alias = (AliasInf *) Pl_Hash_Insert(pl_alias_tbl, (char *) &alias_info, FALSE);
+  Pl_Lock_Release(pl_stm_lock);
 
   return alias;
 }
@@ -585,6 +667,12 @@ Del_Aliases_Of_Stream(int stm)
   HashScan scan;
   AliasInf *alias;
 
+  if (pl_stm_current_input == stm) /* those of the current engine */
+    pl_stm_current_input = pl_stm_stdin;
+
+  if (pl_stm_current_output == stm)
+    pl_stm_current_output = pl_stm_stdout;
+
   for (alias = (AliasInf *) Pl_Hash_First(pl_alias_tbl, &scan); alias;
        alias = (AliasInf *) Pl_Hash_Next(&scan))
     {
@@ -636,20 +724,27 @@ Pl_Add_Mirror_To_Stream(int stm, int m_stm)
   if (stm == m_stm)
     return;
 
+  Pl_Lock_Acquire(pl_stm_lock);
+
   for(m = pstm->mirror; m ; m = m->next)
     if (m->stm == m_stm)	/* already present */
-      return;
+      break;
 
-  m = (StmLst *) Malloc(sizeof(StmLst));
-  m->stm = m_stm;
-  m->next = pstm->mirror;
-  pstm->mirror = m;
+  if (m == NULL)
+    {
+      m = (StmLst *) Malloc(sizeof(StmLst));
+      m->stm = m_stm;
+      m->next = pstm->mirror;
+      pstm->mirror = m;
+
+      m = (StmLst *) Malloc(sizeof(StmLst));
+      m->stm = stm;
+      m->next = m_pstm->mirror_of;
 
-  m = (StmLst *) Malloc(sizeof(StmLst));
-  m->stm = stm;
-  m->next = m_pstm->mirror_of;
+      m_pstm->mirror_of = m;
+    }
 
-  m_pstm->mirror_of = m;
+  Pl_Lock_Release(pl_stm_lock);
 }
 
 
@@ -664,12 +759,17 @@ Pl_Del_Mirror_From_Stream(int stm, int m_stm)
 {
   StmInf *pstm = pl_stm_tbl[stm];
   StmInf *m_pstm = pl_stm_tbl[m_stm];
+  Bool found;
 
-  if (!Remove_In_Stream_List(m_stm, &pstm->mirror))
-    return FALSE;		/* not found */
+  Pl_Lock_Acquire(pl_stm_lock);
 
-  Remove_In_Stream_List(stm, &m_pstm->mirror_of);
-  return TRUE;
+  found = Remove_In_Stream_List(m_stm, &pstm->mirror);
+  if (found)
+    Remove_In_Stream_List(stm, &m_pstm->mirror_of);
+
+  Pl_Lock_Release(pl_stm_lock);
+
+  return found;
 }
 
 
@@ -791,7 +891,8 @@ Pl_Set_Stream_Buffering(int stm)
   f = Pl_Stdio_Desc_Of_Stream(stm);
   if (f == NULL)
     {
-      pstm->prop.buffering = STREAM_BUFFERING_NONE;
+      if (pstm->prop.other != SOCKET_STREAM) /* sockets handle buffering */
+	pstm->prop.buffering = STREAM_BUFFERING_NONE;
       return;
     }
 
@@ -970,7 +1071,7 @@ Pl_Check_Stream_Type(int stm, Bool check_text, Bool for_input)
 WamWord
 Pl_Make_Stream_Tagged_Word(int stm)
 {
-  static WamWord h[2];
+  static PL_THREAD_LOCAL WamWord h[2];
 
   h[0] = stream_1;
   h[1] = Tag_INT(stm);
@@ -1068,6 +1169,9 @@ Pl_Io_Fileno_Of_Stream(int stm)
   if (f)
     return fileno(f);
 
+  if (pl_stm_tbl[stm]->prop.other == SOCKET_STREAM)
+    return pl_stm_tbl[stm]->fileno;
+
   return -1;
 }
 
@@ -1108,7 +1212,6 @@ TTY_Getc(void)
 {
   int c;
   StmInf *pstm;
-  static int tty_linedit_depth = 0;
 
   if (tty_ptr == NULL)
     {
@@ -1279,7 +1382,7 @@ Basic_Call_Fct_Getc(StmInf *pstm)
 #endif
   c = CALL_GETC(pstm);
 
-  if (c != EOF)
+  if (c != EOF && c != STREAM_WOULD_BLOCK)
     for (m = pstm->mirror; m ; m = m->next)
       Pl_Stream_Putc(c, pl_stm_tbl[m->stm]);
 
@@ -1353,6 +1456,8 @@ Pl_Stream_Get_Key(StmInf *pstm, int echo, int catch_ctrl_c)
 	c = TTY_Get_Key(echo, catch_ctrl_c);
 #endif
       Stop_Protect_Regs_For_Signal;
+      if (c == STREAM_WOULD_BLOCK)
+	Stream_Would_Block(pstm);
     }
 
 
@@ -1398,6 +1503,8 @@ Pl_Stream_Getc(StmInf *pstm)
       Start_Protect_Regs_For_Signal;
       c = Basic_Call_Fct_Getc(pstm);
       Stop_Protect_Regs_For_Signal;
+      if (c == STREAM_WOULD_BLOCK)
+	Stream_Would_Block(pstm);
     }
   if (c == EOF)
     pstm->eof_reached = TRUE;
@@ -1461,6 +1568,8 @@ Pl_Stream_Peekc(StmInf *pstm)
   else
     {
       c = Basic_Call_Fct_Getc(pstm);
+      if (c == STREAM_WOULD_BLOCK)
+	Stream_Would_Block(pstm);
       PB_Push(pstm->pb_char, c);
     }
 
@@ -1470,6 +1579,184 @@ Pl_Stream_Peekc(StmInf *pstm)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_STREAM_BEGIN_READ                                                    *
+ *                                                                         *
+ * Called at the start of a read which consumes several characters (e.g.  *
+ * read_term/3). If a non-blocking stream has no more data before the end  *
+ * of the read, the stream is put back in the state recorded here (see     *
+ * Stream_Would_Block) so that the read can be retried later.              *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Stream_Begin_Read(StmInf *pstm)
+{
+  read_mark.pstm = pstm;
+  read_mark.file = pstm->file;
+  read_mark.stamp++;
+  read_mark.char_count = pstm->char_count;
+  read_mark.line_count = pstm->line_count;
+  read_mark.line_pos = pstm->line_pos;
+  read_mark.pb_char = pstm->pb_char;
+  read_mark.pb_line_pos = pstm->pb_line_pos;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_STREAM_END_READ                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Stream_End_Read(void)
+{
+  read_mark.pstm = NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_STREAM_READ_MARK                                                     *
+ *                                                                         *
+ * Used by the getc function of a stream which can return                  *
+ * STREAM_WOULD_BLOCK (file is its accessor). Returns TRUE if the stream   *
+ * must set its mark at its current position (the characters read from the *
+ * mark are kept until the end of the read, to be read again if it would  *
+ * block). stamp is a variable of the stream (initialized to 0).           *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Stream_Read_Mark(void *file, int *stamp)
+{
+  if (read_mark.pstm == NULL || read_mark.file != file)
+    return TRUE;
+
+  if (*stamp == read_mark.stamp)
+    return FALSE;
+
+  *stamp = read_mark.stamp;
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * STREAM_WOULD_BLOCK                                                      *
+ *                                                                         *
+ * The getc function has returned STREAM_WOULD_BLOCK (after going back to  *
+ * its mark). Restores the position of the read in progress (if any) and   *
+ * raises resource_error(would_block).                                     *
+ *-------------------------------------------------------------------------*/
+static void
+Stream_Would_Block(StmInf *pstm)
+{
+  if (read_mark.pstm == pstm)
+    {
+      pstm->char_count = read_mark.char_count;
+      pstm->line_count = read_mark.line_count;
+      pstm->line_pos = read_mark.line_pos;
+      pstm->pb_char = read_mark.pb_char;
+      pstm->pb_line_pos = read_mark.pb_line_pos;
+    }
+  read_mark.pstm = NULL;
+
+  Pl_Err_Resource(pl_resource_would_block);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_STREAM_READ_WINDOW                                                   *
+ *                                                                         *
+ * Returns the next characters of an input stream which are already in     *
+ * memory (the stdio buffer or the string of a string stream). They can be *
+ * scanned directly in [returned value, *end[ and then consumed with       *
+ * Pl_Stream_Read_Skip(). Returns NULL if the stream must be read          *
+ * character by character (pushed back chars, mirrors, eof reached, other  *
+ * kind of stream,...). The window can be empty (returned value == *end).  *
+ *-------------------------------------------------------------------------*/
+char *
+Pl_Stream_Read_Window(StmInf *pstm, char **end)
+{
+  if (pstm->eof_reached || !PB_Is_Empty(pstm->pb_char) || pstm->mirror)
+    return NULL;
+
+  if (pstm->fct_getc == (StmFct) Str_Stream_Getc)
+    {
+      StrSInf *str_stream = (StrSInf *) pstm->file;
+
+      *end = str_stream->end;
+      return str_stream->ptr;
+    }
+
+#ifdef STDIO_READ_PTR
+  if (pstm->fct_getc == (StmFct) fgetc)
+    {
+      FILE *f = (FILE *) pstm->file;
+
+#ifndef NO_USE_PIPED_STDIN_FOR_CONSULT
+      if (SYS_VAR_SAY_GETC && f == stdin)
+	return NULL;
+#endif
+      *end = STDIO_READ_END(f);
+      return STDIO_READ_PTR(f);
+    }
+#endif
+
+  return NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_STREAM_READ_SKIP                                                     *
+ *                                                                         *
+ * Consumes the characters of the window (see Pl_Stream_Read_Window) up to *
+ * ptr (excluded). The caller gives the number of '\n' in the consumed     *
+ * characters and, if nb_nl > 0, the start of the last line (i.e. the char *
+ * following the last '\n'), so that the position is updated at once.     *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Stream_Read_Skip(StmInf *pstm, char *ptr, int nb_nl, char *line_start)
+{
+  char *start;
+
+  if (pstm->fct_getc == (StmFct) Str_Stream_Getc)
+    {
+      StrSInf *str_stream = (StrSInf *) pstm->file;
+
+      start = str_stream->ptr;
+      str_stream->ptr = ptr;
+    }
+#ifdef STDIO_READ_PTR
+  else
+    {
+      FILE *f = (FILE *) pstm->file;
+
+      start = STDIO_READ_PTR(f);
+      STDIO_READ_SET(f, ptr);
+    }
+#else
+  else
+    start = ptr;		/* not reached: no window for stdio */
+#endif
+
+  pstm->char_count += ptr - start;
+  if (nb_nl == 0)
+    pstm->line_pos += ptr - start;
+  else
+    {
+      pstm->line_count += nb_nl;
+      pstm->line_pos = ptr - line_start;
+    }
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_STREAM_GETS                                                          *
  *                                                                         *
@@ -1583,7 +1870,7 @@ int
 Pl_Stream_Printf(StmInf *pstm, char *format, ...)
 {
   va_list arg_ptr;
-  static char str[BIG_BUFFER];
+  static PL_THREAD_LOCAL char str[BIG_BUFFER];
   char *p;
   int c;
 
@@ -1844,6 +2131,8 @@ Pl_Add_Str_Stream(char *buff, int prop_other)
   StmProp prop;
   StrSInf *str_stream;
 
+  Pl_Lock_Acquire(pl_stm_lock);	/* the static str streams are shared */
+
   str_stream = (buff) ? &static_str_stream_rd : &static_str_stream_wr;
   if (str_stream->ptr != NULL)	/* in use ? */
     {
@@ -1854,6 +2143,7 @@ Pl_Add_Str_Stream(char *buff, int prop_other)
   if (buff)
     {
       str_stream->buff = buff;
+      str_stream->end = buff + strlen(buff);
 
       prop.mode = STREAM_MODE_READ;
       prop.input = TRUE;
@@ -1890,6 +2180,8 @@ Pl_Add_Str_Stream(char *buff, int prop_other)
 		     STREAM_FCT_UNDEFINED, STREAM_FCT_UNDEFINED,
 		     STREAM_FCT_UNDEFINED, pstm);
 
+  Pl_Lock_Release(pl_stm_lock);
+
   return stm;
 }
 
@@ -1908,7 +2200,9 @@ Pl_Delete_Str_Stream(int stm)
   if (str_stream == &static_str_stream_rd ||
       str_stream == &static_str_stream_wr)
     {
+      Pl_Lock_Acquire(pl_stm_lock);
       str_stream->ptr = NULL;	/* not in use */
+      Pl_Lock_Release(pl_stm_lock);
     }
   else
     {
@@ -83,6 +83,8 @@
 
 #define STREAM_FCT_UNDEFINED       ((StmFct) (-1)) /* for optional fct */
 
+#define STREAM_WOULD_BLOCK         (-2) /* getc: no data yet (non-blocking) */
+
 
 
 
@@ -91,6 +93,8 @@
 #define TERM_STREAM_CHARS          2
 #define TERM_STREAM_CODES          3
 
+#define SOCKET_STREAM              4 /* prop.other of socket streams */
+
 
 
 
@@ -181,6 +185,7 @@ typedef struct			/* String Stream information      */
 {				/* ------------------------------ */
   char *buff;			/* the I/O buffer                 */
   char *ptr;			/* current position into the buff */
+  char *end;			/* end of the buff (iff input)    */
   Bool buff_alloc_size;		/* mallocated size (iff output)   */
 }
 StrSInf;
@@ -200,8 +205,10 @@ int pl_stm_last_used;
 
 char *pl_alias_tbl;
 
-WamWord pl_last_input_sora;
-WamWord pl_last_output_sora;
+PlLock pl_stm_lock;		/* protects the stream and alias tables */
+
+PL_THREAD_LOCAL WamWord pl_last_input_sora;
+PL_THREAD_LOCAL WamWord pl_last_output_sora;
 
 int pl_stm_stdin;
 int pl_stm_stdout;
@@ -211,8 +218,8 @@ AliasInf *pl_alias_user_input;
 AliasInf *pl_alias_user_output;
 AliasInf *pl_alias_user_error;
 
-AliasInf *pl_alias_current_input;
-AliasInf *pl_alias_current_output;
+PL_THREAD_LOCAL int pl_stm_current_input; /* private to each engine */
+PL_THREAD_LOCAL int pl_stm_current_output;
 
 AliasInf *pl_alias_top_level_input;
 AliasInf *pl_alias_top_level_output;
@@ -221,8 +228,8 @@ AliasInf * pl_alias_debugger_input;
 AliasInf *pl_alias_debugger_output;
 
 Bool pl_stream_use_linedit;
-char *pl_le_prompt;
-int pl_use_le_prompt;
+PL_THREAD_LOCAL char *pl_le_prompt;
+PL_THREAD_LOCAL int pl_use_le_prompt;
 
 int pl_atom_stream;
 
@@ -276,9 +283,11 @@ extern int pl_stm_last_used;
 
 extern char *pl_alias_tbl;
 
+extern PlLock pl_stm_lock;
+
 
-extern WamWord pl_last_input_sora;
-extern WamWord pl_last_output_sora;
+extern PL_THREAD_LOCAL WamWord pl_last_input_sora;
+extern PL_THREAD_LOCAL WamWord pl_last_output_sora;
 
 extern int pl_stm_stdin;
 extern int pl_stm_stdout;
@@ -288,8 +297,8 @@ extern AliasInf *pl_alias_user_input;
 extern AliasInf *pl_alias_user_output;
 extern AliasInf *pl_alias_user_error;
 
-extern AliasInf *pl_alias_current_input;
-extern AliasInf *pl_alias_current_output;
+extern PL_THREAD_LOCAL int pl_stm_current_input;
+extern PL_THREAD_LOCAL int pl_stm_current_output;
 
 extern AliasInf *pl_alias_top_level_input;
 extern AliasInf *pl_alias_top_level_output;
@@ -298,8 +307,8 @@ extern AliasInf *pl_alias_debugger_input;
 extern AliasInf *pl_alias_debugger_output;
 
 extern Bool pl_stream_use_linedit;
-extern char *pl_le_prompt;
-extern int pl_use_le_prompt;
+extern PL_THREAD_LOCAL char *pl_le_prompt;
+extern PL_THREAD_LOCAL int pl_use_le_prompt;
 
 extern int pl_atom_stream;
 
@@ -354,9 +363,6 @@ extern int pl_atom_null;
 #define pl_stm_user_output        (pl_alias_user_output->stm)
 #define pl_stm_user_error         (pl_alias_user_error->stm)
 
-#define pl_stm_current_input      (pl_alias_current_input->stm)
-#define pl_stm_current_output     (pl_alias_current_output->stm)
-
 #define pl_stm_top_level_input    (pl_alias_top_level_input->stm)
 #define pl_stm_top_level_output   (pl_alias_top_level_output->stm)
 
@@ -364,6 +370,15 @@ extern int pl_atom_null;
 #define pl_stm_debugger_output    (pl_alias_debugger_output->stm)
 
 
+	/* current_input/output are private to each engine: their entries */
+	/* in pl_alias_tbl are only used to enumerate the aliases          */
+
+#define Alias_Stm(alias)					\
+  ((alias)->atom == pl_atom_current_input ? pl_stm_current_input :	\
+   (alias)->atom == pl_atom_current_output ? pl_stm_current_output :	\
+   (alias)->stm)
+
+
 
 
 /* macros to cast and invoke file functions */
@@ -437,6 +452,16 @@ void Pl_Stream_Ungetc(int c, StmInf *pstm);
 
 int Pl_Stream_Peekc(StmInf *pstm);
 
+void Pl_Stream_Begin_Read(StmInf *pstm);
+
+void Pl_Stream_End_Read(void);
+
+Bool Pl_Stream_Read_Mark(void *file, int *stamp);
+
+char *Pl_Stream_Read_Window(StmInf *pstm, char **end);
+
+void Pl_Stream_Read_Skip(StmInf *pstm, char *ptr, int nb_nl, char *line_start);
+
 char *Pl_Stream_Gets(char *str, int size, StmInf *pstm);
 
 char *Pl_Stream_Gets_Prompt(char *prompt, StmInf *pstm_o,
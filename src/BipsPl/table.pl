@@ -0,0 +1,107 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : Prolog buit-in predicates                                       *
+ * File  : table.pl                                                        *
+ * Descr.: tabling (memoization of tabled predicates)                      *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+:-	built_in.
+
+'$use_table'.
+
+
+/* For a tabled predicate p/N (directive :- table(p/N)) the compiler renames
+ * the clauses of p/N as an auxiliary predicate Impl/N and defines p/N as:
+ *
+ * p(A1,...,AN) :-
+ *	'$tbl_variant'(p(A1,...,AN), S, E, Act),
+ *	(   Act = 1 ->
+ *	    (   '$tbl_iteration'(S),
+ *	        Impl(A1,...,AN),
+ *	        '$tbl_add_answer'(S, p(A1,...,AN)),
+ *	        fail
+ *	    ;   true
+ *	    )
+ *	;   true
+ *	),
+ *	'$tbl_answers'(S, E, p(A1,...,AN)).
+ *
+ * S is the subgoal of the table, E the epoch of the tables (incremented by
+ * abolish_all_tables/0) and Act tells if the subgoal has to be evaluated
+ * (1), or if its answers have only to be consumed (0: complete table,
+ * 2: variant of a subgoal under evaluation). See table_c.c.
+ */
+
+'$tbl_variant'(Goal, S, E, Act) :-
+	'$call_c'('Pl_Tbl_Variant_4'(Goal, S, E, Act)).
+
+
+
+
+'$tbl_iteration'(S) :-
+	'$call_c'('Pl_Tbl_Iteration_Start_1'(S)).
+
+'$tbl_iteration'(S) :-
+	'$call_c_test'('Pl_Tbl_Iteration_End_1'(S)),
+	'$tbl_iteration'(S).
+
+
+
+
+'$tbl_add_answer'(S, Goal) :-
+	'$call_c'('Pl_Tbl_Add_Answer_2'(S, Goal)).
+
+
+
+
+'$tbl_answers'(S, E, Goal) :-
+	'$tbl_answers'(S, E, 0, Goal).
+
+
+'$tbl_answers'(S, E, I, Goal) :-
+	'$call_c_test'('Pl_Tbl_Answer_5'(S, E, I, Answer, Last)),
+	(   Last = 1 ->
+	    Goal = Answer
+	;   Goal = Answer
+	;   I1 is I + 1,
+	    '$tbl_answers'(S, E, I1, Goal)
+	).
+
+
+
+
+abolish_all_tables :-
+	set_bip_name(abolish_all_tables, 0),
+	'$call_c'('Pl_Abolish_All_Tables_0').
@@ -0,0 +1,830 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : Prolog buit-in predicates                                       *
+ * File  : table_c.c                                                       *
+ * Descr.: tabling management - C part                                     *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+#define OBJ_INIT Table_Initializer
+
+#include "engine_pl.h"
+#include "bips_pl.h"
+
+
+
+
+/* Tabling is implemented with linear tabling (a variant of SLG where a
+ * looping subgoal is re-evaluated until a fixpoint is reached instead of
+ * being suspended, so no choice point/environment needs to be frozen):
+ *
+ * - a subgoal is identified (up to variable renaming) by a trie (the
+ *   subgoal trie) whose leaves point to a TblSubgoal. Each subgoal has its
+ *   own answer trie (to detect duplicate answers) and an array of answers
+ *   (contiguous copies of the answers in the order of their insertion).
+ *   Tables are allocated in the C heap (outside the WAM stacks).
+ *
+ * - a new subgoal is pushed on the tabling stack and evaluated (status
+ *   EVALUATING): its clauses are all executed, each answer is added.
+ *   A variant call to a subgoal under evaluation (EVALUATING) or evaluated
+ *   but not yet complete (INCOMPLETE) consumes the answers found so far
+ *   and makes the caller depend on it (dep is the lowest stack index the
+ *   subgoal depends on, looped records that some incomplete answers were
+ *   consumed).
+ *
+ * - at the end of an iteration a subgoal which depends on an older subgoal
+ *   (a follower) is popped, becomes INCOMPLETE and is added to the
+ *   incomplete list (its dep and looped are propagated to its caller).
+ *   A subgoal which only depends on itself (a leader) is re-evaluated
+ *   (followers of its SCC are then marked REEVAL to be evaluated again)
+ *   while it looped and new answers have been found. Then the leader and
+ *   all its followers (those added to the incomplete list since the leader
+ *   has been pushed) become COMPLETE.
+ *
+ * - if an exception occurs during an evaluation the subgoal is abandoned
+ *   (detected when its trail entry is undone): its answers are kept (they
+ *   are correct) but it is NEW again to be evaluated at the next call.
+ *
+ * Trie tokens: atoms and integers are their tagged words, a variable is
+ * Tag_REF(k) where k is its order of appearance, a list is Tag_LST(0)
+ * followed by its elements, a structure is Tag_STC(0) followed by its
+ * functor/arity word and its arguments, a float is Tag_FLT(0) followed by
+ * its raw words.
+ */
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define TBL_HASH_MIN_CHILD         8	/* hash the children above this */
+#define TBL_MAX_VARS               65536
+
+#define TBL_NEW                    0
+#define TBL_EVALUATING             1
+#define TBL_INCOMPLETE             2
+#define TBL_REEVAL                 3
+#define TBL_COMPLETE               4
+
+#define TBL_ACT_COMPLETE           0
+#define TBL_ACT_EVALUATE           1
+#define TBL_ACT_CONSUME            2
+
+#if WORD_SIZE == 32
+#define FLT_WORDS                  2
+#else
+#define FLT_WORDS                  1
+#endif
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct tblnode *TblNodeP;
+
+typedef struct tblnode
+{
+  WamWord token;
+  TblNodeP child;		/* first child */
+  TblNodeP sibling;		/* next sibling */
+  char *htbl;			/* children by token (if many) or NULL */
+  int nb_child;
+  void *info;			/* leaf: TblSubgoal * or answer marker */
+}
+TblNode;
+
+
+typedef struct			/* children hash table element */
+{
+  PlLong key;			/* the token */
+  TblNode *node;
+}
+TblHashInf;
+
+
+typedef struct
+{
+  int size;			/* size of the copy */
+  WamWord term_word;		/* contiguous copy of the answer */
+}
+TblAnswer;
+
+
+typedef struct tblsubgoal *TblSubgoalP;
+
+typedef struct tblsubgoal
+{
+  int sg_no;			/* index in sg_tbl */
+  int status;
+  int stack_idx;		/* when EVALUATING */
+  int dep;			/* lowest stack index depended on */
+  Bool looped;			/* some incomplete answers consumed */
+  PlLong iter_mark;		/* nb_new_answers at iteration start */
+  TblSubgoalP leader;		/* when INCOMPLETE: subgoal depended on */
+  TblSubgoalP list_mark;	/* incomplete list when pushed */
+  TblSubgoalP next_incomplete;
+  Bool in_list;			/* in the incomplete list ? */
+  TblNode answer_root;		/* answer trie (freed when complete) */
+  TblAnswer **answer;
+  int nb_answer;
+  int max_answer;
+}
+TblSubgoal;
+
+
+
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static PL_THREAD_LOCAL TblNode sg_root;	/* subgoal trie (per engine) */
+
+static PL_THREAD_LOCAL TblSubgoal **sg_tbl;
+static PL_THREAD_LOCAL int nb_sg;
+static PL_THREAD_LOCAL int max_sg;
+
+static PL_THREAD_LOCAL TblSubgoal **stack;	/* tabling stack */
+static PL_THREAD_LOCAL int top = -1;
+static PL_THREAD_LOCAL int max_stack;
+
+static PL_THREAD_LOCAL TblSubgoal *incomplete_list;
+
+static PL_THREAD_LOCAL PlLong nb_new_answers;
+static PL_THREAD_LOCAL PlLong epoch;
+
+static PL_THREAD_LOCAL WamWord *var_cell;	/* cells the variables are bound to */
+static PL_THREAD_LOCAL WamWord *var_save;	/* pairs (word, address) to restore */
+static PL_THREAD_LOCAL int nb_var;
+
+static int atom_table;
+static int atom_incomplete;
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static TblNode *Trie_Child(TblNode *node, WamWord token);
+
+static TblNode *Trie_Term(TblNode *node, WamWord start_word);
+
+static TblNode *Trie_Lookup(TblNode *root, WamWord start_word);
+
+static void Restore_Vars(void);
+
+static void Trie_Walk(TblNode *root, Bool free_nodes);
+
+static TblSubgoal *Get_Subgoal(WamWord sg_word);
+
+static void Abandon(TblSubgoal *sg);
+
+static void Tbl_Untrail(int n, WamWord *arg_frame);
+
+static void Atom_GC_Roots(void);
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TABLE_INITIALIZER                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Table_Initializer(void)
+{
+  atom_table = Pl_Create_Atom("table");
+  atom_incomplete = Pl_Create_Atom("incomplete");
+
+  Pl_Engine_Add_Context(&sg_root, sizeof(sg_root));
+  Pl_Engine_Add_Context(&sg_tbl, sizeof(sg_tbl));
+  Pl_Engine_Add_Context(&nb_sg, sizeof(nb_sg));
+  Pl_Engine_Add_Context(&max_sg, sizeof(max_sg));
+  Pl_Engine_Add_Context(&stack, sizeof(stack));
+  Pl_Engine_Add_Context(&top, sizeof(top));
+  Pl_Engine_Add_Context(&max_stack, sizeof(max_stack));
+  Pl_Engine_Add_Context(&incomplete_list, sizeof(incomplete_list));
+  Pl_Engine_Add_Context(&nb_new_answers, sizeof(nb_new_answers));
+  Pl_Engine_Add_Context(&epoch, sizeof(epoch));
+				/* main engine: allocated at 1st use */
+  Pl_Engine_Add_Buffer(&var_cell, TBL_MAX_VARS * sizeof(WamWord));
+  Pl_Engine_Add_Buffer(&var_save, 2 * TBL_MAX_VARS * sizeof(WamWord));
+
+  Pl_Atom_GC_Add_Engine_Root_Fct(Atom_GC_Roots);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_ROOTS                                                           *
+ *                                                                         *
+ * Mark the atoms of the tries and of the stored answers.                  *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Roots(void)
+{
+  TblSubgoal *sg;
+  int i, j;
+
+  Trie_Walk(&sg_root, FALSE);
+
+  for (i = 0; i < nb_sg; i++)
+    {
+      sg = sg_tbl[i];
+      Trie_Walk(&sg->answer_root, FALSE);
+      for (j = 0; j < sg->nb_answer; j++)
+	Pl_Atom_GC_Mark_Words(&sg->answer[j]->term_word, sg->answer[j]->size);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TRIE_CHILD                                                              *
+ *                                                                         *
+ * Return the child of node for token (created if needed).                 *
+ *-------------------------------------------------------------------------*/
+static TblNode *
+Trie_Child(TblNode *node, WamWord token)
+{
+  TblNode *child;
+  TblHashInf h, *p;
+
+  if (node->htbl)
+    {
+      p = (TblHashInf *) Pl_Hash_Find(node->htbl, (PlLong) token);
+      if (p)
+	return p->node;
+    }
+  else
+    for (child = node->child; child; child = child->sibling)
+      if (child->token == token)
+	return child;
+
+  child = (TblNode *) Calloc(1, sizeof(TblNode));
+  child->token = token;
+  child->sibling = node->child;
+  node->child = child;
+  node->nb_child++;
+
+  if (node->htbl == NULL && node->nb_child > TBL_HASH_MIN_CHILD)
+    {				/* switch to a hash table */
+      node->htbl = Pl_Hash_Alloc_Table(node->nb_child * 2, sizeof(TblHashInf));
+      for (child = node->child; child; child = child->sibling)
+	{
+	  Pl_Extend_Table_If_Needed(&node->htbl);
+	  h.key = (PlLong) child->token;
+	  h.node = child;
+	  Pl_Hash_Insert(node->htbl, (char *) &h, FALSE);
+	}
+      return node->child;
+    }
+
+  if (node->htbl)
+    {
+      Pl_Extend_Table_If_Needed(&node->htbl);
+      h.key = (PlLong) token;
+      h.node = child;
+      Pl_Hash_Insert(node->htbl, (char *) &h, FALSE);
+    }
+
+  return child;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TRIE_TERM                                                               *
+ *                                                                         *
+ * Follow (creating them if needed) the tokens of a term from node and     *
+ * return the reached node. A variable is bound to var_cell[k] at its 1st  *
+ * occurrence (see Restore_Vars).                                          *
+ *-------------------------------------------------------------------------*/
+static TblNode *
+Trie_Term(TblNode *node, WamWord start_word)
+{
+  WamWord word, tag_mask;
+  WamWord *adr;
+  int i;
+
+terminal_rec:
+
+  DEREF(start_word, word, tag_mask);
+
+  switch (Tag_From_Tag_Mask(tag_mask))
+    {
+    case REF:
+#ifndef NO_USE_FD_SOLVER
+    case FDV:
+#endif
+      adr = UnTag_Address(word);
+      if (adr >= var_cell && adr < var_cell + TBL_MAX_VARS)
+	i = adr - var_cell;
+      else
+	{
+	  if (nb_var >= TBL_MAX_VARS)
+	    {
+	      Restore_Vars();
+	      Pl_Err_Representation(pl_representation_too_many_variables);
+	    }
+	  i = nb_var++;
+	  var_save[2 * i] = *adr;
+	  var_save[2 * i + 1] = (WamWord) adr;
+	  var_cell[i] = Tag_REF(&var_cell[i]);
+	  *adr = Tag_REF(&var_cell[i]);
+	}
+      return Trie_Child(node, Tag_REF((WamWord *) ((PlLong) i * sizeof(WamWord))));
+
+    case FLT:
+      adr = UnTag_FLT(word);
+      node = Trie_Child(node, Tag_FLT(0));
+      for (i = 0; i < FLT_WORDS; i++)
+	node = Trie_Child(node, adr[i]);
+      return node;
+
+    case LST:
+      adr = UnTag_LST(word);
+      node = Trie_Child(node, Tag_LST(0));
+      node = Trie_Term(node, Car(adr));
+      start_word = Cdr(adr);
+      goto terminal_rec;
+
+    case STC:
+      adr = UnTag_STC(word);
+      node = Trie_Child(node, Tag_STC(0));
+      node = Trie_Child(node, Functor_And_Arity(adr));
+      i = Arity(adr);
+      adr = &Arg(adr, 0);
+      while (--i)
+	node = Trie_Term(node, *adr++);
+      start_word = *adr;
+      goto terminal_rec;
+
+    default:
+      return Trie_Child(node, word);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TRIE_LOOKUP                                                             *
+ *                                                                         *
+ * Return the leaf of the trie rooted at root for a term (created if       *
+ * needed). Two terms share the same leaf iff they are variants.           *
+ *-------------------------------------------------------------------------*/
+static TblNode *
+Trie_Lookup(TblNode *root, WamWord start_word)
+{
+  TblNode *node;
+
+  if (var_cell == NULL)
+    {
+      var_cell = (WamWord *) Malloc(TBL_MAX_VARS * sizeof(WamWord));
+      var_save = (WamWord *) Malloc(2 * TBL_MAX_VARS * sizeof(WamWord));
+    }
+
+  nb_var = 0;
+  node = Trie_Term(root, start_word);
+  Restore_Vars();
+
+  return node;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RESTORE_VARS                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Restore_Vars(void)
+{
+  while (nb_var > 0)
+    {
+      nb_var--;
+      *(WamWord *) var_save[2 * nb_var + 1] = var_save[2 * nb_var];
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TRIE_WALK                                                               *
+ *                                                                         *
+ * Visit all nodes of a trie (except the root) to mark their atoms or to   *
+ * free them (the root is then reset). Iterative since tries can be deep.  *
+ *-------------------------------------------------------------------------*/
+static void
+Trie_Walk(TblNode *root, Bool free_nodes)
+{
+  static PL_THREAD_LOCAL TblNode **todo;
+  static PL_THREAD_LOCAL int max_todo;
+  int nb_todo = 0;
+  TblNode *node, *child;
+
+  for (node = root;;)
+    {
+      for (child = node->child; child; child = child->sibling)
+	{
+	  if (nb_todo >= max_todo)
+	    {
+	      max_todo = (max_todo == 0) ? 1024 : max_todo * 2;
+	      todo = (TblNode **) Realloc(todo, max_todo * sizeof(TblNode *));
+	    }
+	  todo[nb_todo++] = child;
+	}
+
+      if (node != root)
+	{
+	  if (!free_nodes)
+	    Pl_Atom_GC_Mark_Words(&node->token, 1);
+	  else
+	    {
+	      if (node->htbl)
+		Pl_Hash_Free_Table(node->htbl);
+	      Free(node);
+	    }
+	}
+
+      if (nb_todo == 0)
+	break;
+
+      node = todo[--nb_todo];
+    }
+
+  if (free_nodes)
+    {
+      if (root->htbl)
+	Pl_Hash_Free_Table(root->htbl);
+      root->child = NULL;
+      root->htbl = NULL;
+      root->nb_child = 0;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GET_SUBGOAL                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static TblSubgoal *
+Get_Subgoal(WamWord sg_word)
+{
+  return sg_tbl[Pl_Rd_Integer(sg_word)];
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_TBL_VARIANT_4                                                        *
+ *                                                                         *
+ * Find (or create) the subgoal of goal_word and decide what to do (see    *
+ * table.pl).                                                              *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Tbl_Variant_4(WamWord goal_word, WamWord sg_word, WamWord epoch_word,
+		 WamWord act_word)
+{
+  TblNode *leaf;
+  TblSubgoal *sg, *t, *caller;
+  WamWord arg_frame[2];
+  int act;
+
+  leaf = Trie_Lookup(&sg_root, goal_word);
+  sg = (TblSubgoal *) leaf->info;
+  if (sg == NULL)
+    {
+      if (nb_sg >= max_sg)
+	{
+	  max_sg = (max_sg == 0) ? 1024 : max_sg * 2;
+	  sg_tbl = (TblSubgoal **) Realloc(sg_tbl, max_sg * sizeof(TblSubgoal *));
+	}
+      sg = (TblSubgoal *) Calloc(1, sizeof(TblSubgoal));
+      sg->sg_no = nb_sg;
+      sg->status = TBL_NEW;
+      sg_tbl[nb_sg++] = sg;
+      leaf->info = sg;
+    }
+
+  switch (sg->status)
+    {
+    case TBL_COMPLETE:
+      act = TBL_ACT_COMPLETE;
+      break;
+
+    case TBL_NEW:
+    case TBL_REEVAL:
+      if (++top >= max_stack)
+	{
+	  max_stack = (max_stack == 0) ? 256 : max_stack * 2;
+	  stack = (TblSubgoal **) Realloc(stack, max_stack * sizeof(TblSubgoal *));
+	}
+      stack[top] = sg;
+      sg->status = TBL_EVALUATING;
+      sg->stack_idx = top;
+      sg->list_mark = incomplete_list;
+      arg_frame[0] = sg->sg_no;
+      arg_frame[1] = epoch;
+      Trail_FC(Tbl_Untrail, 2, arg_frame);
+      act = TBL_ACT_EVALUATE;
+      break;
+
+    default:			/* EVALUATING or INCOMPLETE */
+      for (t = sg; t->status == TBL_INCOMPLETE; t = t->leader)
+	;
+      caller = stack[top];
+      if (t->status == TBL_EVALUATING)
+	{
+	  if (t->stack_idx < caller->dep)
+	    caller->dep = t->stack_idx;
+	  t->looped = TRUE;
+	}
+      act = TBL_ACT_CONSUME;
+    }
+
+  Pl_Get_Integer(sg->sg_no, sg_word);
+  Pl_Get_Integer(epoch, epoch_word);
+  Pl_Get_Integer(act, act_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_TBL_ITERATION_START_1                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Tbl_Iteration_Start_1(WamWord sg_word)
+{
+  TblSubgoal *sg = Get_Subgoal(sg_word);
+
+  sg->dep = sg->stack_idx;
+  sg->looped = FALSE;
+  sg->iter_mark = nb_new_answers;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_TBL_ITERATION_END_1                                                  *
+ *                                                                         *
+ * Succeeds if the subgoal needs another iteration.                        *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Tbl_Iteration_End_1(WamWord sg_word)
+{
+  TblSubgoal *sg = Get_Subgoal(sg_word);
+  TblSubgoal *parent, *s;
+
+  if (sg->dep < sg->stack_idx)	/* a follower */
+    {
+      top--;
+      parent = stack[top];
+      if (sg->dep < parent->dep)
+	parent->dep = sg->dep;
+      parent->looped |= sg->looped;
+      sg->leader = stack[sg->dep];
+      sg->status = TBL_INCOMPLETE;
+      if (!sg->in_list)
+	{
+	  sg->next_incomplete = incomplete_list;
+	  incomplete_list = sg;
+	  sg->in_list = TRUE;
+	}
+      return FALSE;
+    }
+
+  if (sg->looped && sg->iter_mark != nb_new_answers)
+    {				/* a leader which needs another iteration */
+      for (s = incomplete_list; s != sg->list_mark; s = s->next_incomplete)
+	if (s->status == TBL_INCOMPLETE)
+	  s->status = TBL_REEVAL;
+      return TRUE;
+    }
+
+				/* a leader which completes its SCC */
+  while (incomplete_list != sg->list_mark)
+    {
+      s = incomplete_list;
+      incomplete_list = s->next_incomplete;
+      s->in_list = FALSE;
+      if (s->status == TBL_INCOMPLETE)
+	{
+	  s->status = TBL_COMPLETE;
+	  Trie_Walk(&s->answer_root, TRUE);
+	}
+      else if (s->status == TBL_REEVAL)	/* not called in the last iteration */
+	s->status = TBL_NEW;
+    }
+
+  sg->status = TBL_COMPLETE;
+  Trie_Walk(&sg->answer_root, TRUE);
+  top--;
+  return FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_TBL_ADD_ANSWER_2                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Tbl_Add_Answer_2(WamWord sg_word, WamWord goal_word)
+{
+  TblSubgoal *sg = Get_Subgoal(sg_word);
+  TblNode *leaf;
+  TblAnswer *ans;
+  int size;
+  static PL_THREAD_LOCAL WamWord fix_bug;
+
+  leaf = Trie_Lookup(&sg->answer_root, goal_word);
+  if (leaf->info)		/* already an answer */
+    return;
+
+  leaf->info = sg;
+
+  size = Pl_Term_Size(goal_word);
+  ans = (TblAnswer *) Malloc(sizeof(TblAnswer) - sizeof(WamWord) +
+			     size * sizeof(WamWord));
+  ans->size = size;
+  fix_bug = goal_word;
+  Pl_Copy_Term(&ans->term_word, &fix_bug);
+
+  if (sg->nb_answer >= sg->max_answer)
+    {
+      sg->max_answer = (sg->max_answer == 0) ? 8 : sg->max_answer * 2;
+      sg->answer = (TblAnswer **) Realloc(sg->answer,
+					  sg->max_answer * sizeof(TblAnswer *));
+    }
+  sg->answer[sg->nb_answer++] = ans;
+  nb_new_answers++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_TBL_ANSWER_5                                                         *
+ *                                                                         *
+ * Return the answer number i of a subgoal (fails if no such answer). last *
+ * is 1 if it is the last answer of a complete table.                      *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Tbl_Answer_5(WamWord sg_word, WamWord epoch_word, WamWord i_word,
+		WamWord answer_word, WamWord last_word)
+{
+  TblSubgoal *sg;
+  TblAnswer *ans;
+  WamWord *adr;
+  int i;
+
+  if (Pl_Rd_Integer(epoch_word) != epoch)	/* tables abolished */
+    return FALSE;
+
+  sg = Get_Subgoal(sg_word);
+  i = Pl_Rd_Integer(i_word);
+  if (i >= sg->nb_answer)
+    return FALSE;
+
+  ans = sg->answer[i];
+  adr = H;
+  Pl_Copy_Contiguous_Term(adr, &ans->term_word);
+  H += ans->size;
+
+  Pl_Get_Integer(sg->status == TBL_COMPLETE && i == sg->nb_answer - 1,
+		 last_word);
+  return Pl_Unify(Tag_REF(adr), answer_word);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ABANDON                                                                 *
+ *                                                                         *
+ * Abandon the evaluation of a subgoal (and of the subgoals above it).     *
+ *-------------------------------------------------------------------------*/
+static void
+Abandon(TblSubgoal *sg)
+{
+  TblSubgoal *s;
+
+  while (top >= sg->stack_idx)
+    stack[top--]->status = TBL_NEW;
+
+  while (incomplete_list != sg->list_mark)
+    {
+      s = incomplete_list;
+      incomplete_list = s->next_incomplete;
+      s->in_list = FALSE;
+      if (s->status != TBL_COMPLETE)
+	s->status = TBL_NEW;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * TBL_UNTRAIL                                                             *
+ *                                                                         *
+ * Called when the trail entry pushed when a subgoal has been pushed is    *
+ * undone. If the subgoal is still under evaluation, an exception has been *
+ * raised (normally a subgoal is popped before).                           *
+ *-------------------------------------------------------------------------*/
+static void
+Tbl_Untrail(int n, WamWord *arg_frame)
+{
+  TblSubgoal *sg;
+
+  if (arg_frame[1] != epoch)
+    return;
+
+  sg = sg_tbl[arg_frame[0]];
+  if (sg->status == TBL_EVALUATING && sg->stack_idx <= top &&
+      stack[sg->stack_idx] == sg)
+    Abandon(sg);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ABOLISH_ALL_TABLES_0                                                 *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Abolish_All_Tables_0(void)
+{
+  TblSubgoal *sg;
+  int i, j;
+
+  if (top >= 0)
+    Pl_Err_Permission(pl_permission_operation_modify, atom_table,
+		      Tag_ATM(atom_incomplete));
+
+  for (i = 0; i < nb_sg; i++)
+    {
+      sg = sg_tbl[i];
+      Trie_Walk(&sg->answer_root, TRUE);
+      for (j = 0; j < sg->nb_answer; j++)
+	Free(sg->answer[j]);
+      if (sg->answer)
+	Free(sg->answer);
+      Free(sg);
+    }
+
+  Trie_Walk(&sg_root, TRUE);
+  nb_sg = 0;
+  incomplete_list = NULL;
+  epoch++;
+}
@@ -54,8 +54,8 @@
  * Global Variables                *
  *---------------------------------*/
 
-static PlLong *var_ptr;
-static PlLong *base_var_ptr;
+static PL_THREAD_LOCAL PlLong *var_ptr;
+static PL_THREAD_LOCAL PlLong *base_var_ptr;
 
 /*---------------------------------*
  * Function Prototypes             *
@@ -467,7 +467,7 @@ Pl_Copy_Term_2(WamWord u_word, WamWord v_word)
 /* fix_bug is because when gcc sees &xxx where xxx is a fct argument variable
  * it allocates a frame even with -fomit-frame-pointer.
  * This corrupts ebp on ix86 */
-  static WamWord fix_bug;
+  static PL_THREAD_LOCAL WamWord fix_bug;
 
   size = Pl_Term_Size(u_word);
   fix_bug = u_word;
@@ -38,6 +38,8 @@
 
 #include <string.h>
 
+#define OBJ_INIT Term_Supp_Initializer
+
 #define TERM_SUPP_FILE
 
 #include "engine_pl.h"
@@ -60,11 +62,10 @@
 
 	  /* copy term variables */
 
-static WamWord *base_copy;
+static PL_THREAD_LOCAL WamWord *base_copy;
 
-static WamWord vars[MAX_VAR_IN_TERM * 2];	/* needs 2 words for a variable */
-static WamWord *end_vars = vars + MAX_VAR_IN_TERM * 2;
-static WamWord *top_vars;
+static PL_THREAD_LOCAL WamWord *vars;	/* needs 2 words for a variable */
+static PL_THREAD_LOCAL WamWord *top_vars;
 
 
 
@@ -82,6 +83,20 @@ static Bool Term_Hash_Rec(WamWord start_word, PlLong depth, HashIncrInfo *hi);
 
 
 
+/*-------------------------------------------------------------------------*
+ * TERM_SUPP_INITIALIZER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Term_Supp_Initializer(void)
+{
+  Pl_Engine_Add_Buffer(&vars, MAX_VAR_IN_TERM * 2 * sizeof(WamWord));
+  Pl_Engine_Add_Buffer(&pl_glob_dico_var, MAX_VAR_IN_TERM * sizeof(PlLong));
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_TERM_COMPARE                                                         *
  *                                                                         *
@@ -342,7 +357,7 @@ Pl_Copy_Term(WamWord *dst_adr, WamWord *src_adr)
 /* fix_bug is because when gcc sees &xxx where xxx is a fct argument variable
  * it allocates a frame even with -fomit-frame-pointer.
  * This corrupts ebp on ix86 */
-  static WamWord *fix_bug;
+  static PL_THREAD_LOCAL WamWord *fix_bug;
 
   base_copy = dst_adr++;
 
@@ -391,7 +406,7 @@ terminal_rec:
 	  return;
 	}
 
-      if (top_vars >= end_vars)
+      if (top_vars >= vars + MAX_VAR_IN_TERM * 2)
 	Pl_Err_Representation(pl_representation_too_many_variables);
 
       *top_vars++ = word;	                /* word to restore    */
@@ -409,7 +424,7 @@ terminal_rec:
 	  return;
 	}
 
-      if (top_vars >= end_vars)
+      if (top_vars >= vars + MAX_VAR_IN_TERM * 2)
 	Pl_Err_Representation(pl_representation_too_many_variables);
 
       *top_vars++ = word;	        /* word to restore    */
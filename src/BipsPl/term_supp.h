@@ -50,17 +50,18 @@
 
 #ifdef TERM_SUPP_FILE
 
-WamWord pl_pi_name_word;
-WamWord pl_pi_arity_word;
+PL_THREAD_LOCAL WamWord pl_pi_name_word;
+PL_THREAD_LOCAL WamWord pl_pi_arity_word;
 
-PlLong pl_glob_dico_var[MAX_VAR_IN_TERM];	/* a general purpose dico */
+				/* a general purpose dico (per engine) */
+PL_THREAD_LOCAL PlLong *pl_glob_dico_var;
 
 #else
 
-extern WamWord pl_pi_name_word;
-extern WamWord pl_pi_arity_word;
+extern PL_THREAD_LOCAL WamWord pl_pi_name_word;
+extern PL_THREAD_LOCAL WamWord pl_pi_arity_word;
 
-extern PlLong pl_glob_dico_var[];
+extern PL_THREAD_LOCAL PlLong *pl_glob_dico_var;
 
 #endif
 
@@ -54,8 +54,8 @@
  * Global Variables                *
  *---------------------------------*/
 
-WamWord *pl_query_top_b;		/* overwritten by foreign_supp if present */
-WamWord pl_query_exception;	/* overwritten by foreign_supp if present */
+PL_THREAD_LOCAL WamWord *pl_query_top_b; /* set by foreign_supp if present */
+PL_THREAD_LOCAL WamWord pl_query_exception;
 
 
 
@@ -76,7 +76,7 @@
 
 
 #if !defined(NO_USE_REGS) && NB_OF_USED_MACHINE_REGS > 0
-static WamWord buff_save_machine_regs[NB_OF_USED_MACHINE_REGS];
+static PL_THREAD_LOCAL WamWord buff_save_machine_regs[NB_OF_USED_MACHINE_REGS];
 #endif
 
 /*---------------------------------*
@@ -164,19 +164,19 @@ static WamWord dollar_varname_1;
 
 static int atom_dots;
 
-static StmInf *pstm_o;
-static Bool quoted;
-static Bool ignore_op;
-static Bool number_vars;
-static Bool name_vars;
-static Bool space_args;
-static Bool portrayed;
+static PL_THREAD_LOCAL StmInf *pstm_o;
+static PL_THREAD_LOCAL Bool quoted;
+static PL_THREAD_LOCAL Bool ignore_op;
+static PL_THREAD_LOCAL Bool number_vars;
+static PL_THREAD_LOCAL Bool name_vars;
+static PL_THREAD_LOCAL Bool space_args;
+static PL_THREAD_LOCAL Bool portrayed;
 
-static WamWord *name_number_above_H;
+static PL_THREAD_LOCAL WamWord *name_number_above_H;
 
-static Bool last_is_space;	/* to avoid duplicate spaces (e.g. with space_args) */
-static int last_prefix_op = W_NO_PREFIX_OP;
-static Bool *p_bracket_op_minus;
+static PL_THREAD_LOCAL Bool last_is_space;	/* to avoid duplicate spaces (e.g. with space_args) */
+static PL_THREAD_LOCAL int last_prefix_op = W_NO_PREFIX_OP;
+static PL_THREAD_LOCAL Bool *p_bracket_op_minus;
 
 
 
@@ -481,7 +481,7 @@ char *
 Pl_Float_To_String(double d)
 {
   char *p, *q, *e;
-  static char buff[32];
+  static PL_THREAD_LOCAL char buff[32];
 
   sprintf(buff, "%#.17g", d);	/* a . with 16 significant digits */
 
@@ -42,3 +42,8 @@
 
 #define RANGE_TOP_STACK            CS
 #define INTERVAL_MAX_INTEGER       ((int)(((PlLong)1<<(32-TAG_SIZE-1))-1))	/* only 32 bits (even on 64 bits machine) */
+
+	  /* an interval list allocated since the last choice point can be  *
+	   * updated in place, an older one is copied before being modified */
+
+#define RANGE_CAN_MODIFY(adr)      ((WamWord *) (adr) >= CSB(B) && (WamWord *) (adr) < CS)
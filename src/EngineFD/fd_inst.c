@@ -38,6 +38,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 
 #define FD_INST_FILE
 
@@ -60,6 +61,8 @@
 
 #define MSG_VECTOR_TOO_SMALL       "Warning: Vector too small - maybe lost solutions (FD Var:_%ld)\n"
 
+#define ACTIVITY_DECAY             0.999
+
 
 
 
@@ -71,11 +74,15 @@
  * Global Variables                *
  *---------------------------------*/
 
-static WamWord *TP;
+static PL_THREAD_LOCAL WamWord *TP;
+
+static PL_THREAD_LOCAL WamWord dummy_fd_var[FD_VARIABLE_FRAME_SIZE];
 
-static WamWord dummy_fd_var[FD_VARIABLE_FRAME_SIZE];
+static PL_THREAD_LOCAL WamWord *cstr_queue_first[FD_NB_PRIORITY];
+static PL_THREAD_LOCAL WamWord *cstr_queue_last[FD_NB_PRIORITY];
+static PL_THREAD_LOCAL int cstr_queue_mask;	/* bit p set <=> queue of priority p not empty */
 
-static PlULong DATE;   /* NB: PlLong/PlULong have the same size as a WamWord (intptr_t) */
+static PL_THREAD_LOCAL PlULong DATE;   /* NB: PlLong/PlULong have the same size as a WamWord (intptr_t) */
 
 /*
  * When a constraint X in ...  is added the following sequence is executed:
@@ -163,6 +170,36 @@ static PlULong DATE;   /* NB: PlLong/PlULong have the same size as a WamWord (in
  * NB: if a constraint reexecution fails (in the above loop), X has the 
  * MASK_TO_KEEP_IN_QUEUE set. This is not a problem since at the next
  * constraint post the queue is cleared assigning 0 to each Queue_Propag_Mask.
+ *
+ * Only cheap constraints (Cstr_Priority(cf) == FD_PRIO_UNARY, e.g. X in r)
+ * are reexecuted as above. The others (costly global constraints, their
+ * priority is the cost class declared in the .fd file, see fd2c) are only
+ * scheduled in a constraint queue: there is one FIFO per priority and
+ * cstr_queue_mask records the non-empty FIFOs. When the variable queue is
+ * empty, the first constraint of the non-empty FIFO with the lowest priority
+ * is executed (which can in turn add variables to the variable queue). Thus
+ * a global constraint is only executed when cheaper propagators have reached
+ * their fix-point, and only once even if many of its variables are updated.
+ *
+ * A constraint is scheduled only once: Queue_Date(cf) == DATE means it is
+ * in the queue. Queue_Date is reset when the constraint is taken from the
+ * queue (before executing it since it can reschedule itself). In case of
+ * failure the queue is simply emptied (cstr_queue_mask = 0): the remaining
+ * constraints have a Queue_Date which is a past DATE, i.e. they are no
+ * longer considered as scheduled (there is nothing to clear).
+ *
+ * The counters pl_fd_nb_propag (constraint executions), pl_fd_nb_wake_up
+ * (reexecutions or schedulings due to an update) and pl_fd_nb_failure are
+ * available via fd_statistics/2.
+ *
+ * The propagation also records information for the adaptive labeling
+ * heuristics (fd_labeling/2). This information is not trailed (it persists
+ * across backtracking):
+ *   - Cstr_Weight(cf): 1 + number of failures of the constraint (dom/wdeg)
+ *   - Activity(X): number of decisions (pl_fd_nb_decision is incremented at
+ *     each variable selection) after which X has been updated, decayed by
+ *     ACTIVITY_DECAY at each decision. The decay is applied lazily: only
+ *     Activity_Date(X) (the last decision X was updated after) is stored.
  */
 
 #define DATE_NEVER   0
@@ -188,6 +225,8 @@ static void All_Propagations(WamWord *fdv_adr, int propag);
 
 static void Clear_Queue(void);
 
+static void Schedule_Constraint(WamWord *CF);
+
 
 
 
@@ -227,13 +266,17 @@ static void Clear_Queue(void);
 
 
 
+	  /* the content of an interval list is not trailed: it is only   *
+	   * modified in place if allocated after the last choice point    *
+	   * (else copied), see RANGE_CAN_MODIFY in fd_hook_range.h        */
+
 #define Trail_Range_If_Necessary(fdv_adr)                 	\
   do								\
     {								\
       if (Range_Stamp(fdv_adr) != STAMP)			\
 	{							\
 	  Trail_MV(fdv_adr + OFFSET_RANGE, RANGE_SIZE);		\
-	  if (Is_Sparse(Range(fdv_adr)))			\
+	  if (Is_Vector(Range(fdv_adr)))			\
 	      Trail_MV((WamWord *) Vec(fdv_adr), pl_vec_size);	\
 								\
 	  Range_Stamp(fdv_adr) = STAMP;				\
@@ -411,6 +454,15 @@ Pl_Fd_Init_Solver0(void)
   Pl_Define_Vector_Size(max_val);
 
   Pl_Fd_Reset_Solver0();
+				/* after their init: copied to new engines */
+  Pl_Engine_Add_Context(&pl_vec_size, sizeof(pl_vec_size));
+  Pl_Engine_Add_Context(&pl_vec_max_integer, sizeof(pl_vec_max_integer));
+  Pl_Engine_Add_Context(&DATE, sizeof(DATE));
+  Pl_Engine_Add_Context(&pl_fd_update_stamp, sizeof(pl_fd_update_stamp));
+  Pl_Engine_Add_Context(&pl_fd_nb_propag, sizeof(pl_fd_nb_propag));
+  Pl_Engine_Add_Context(&pl_fd_nb_wake_up, sizeof(pl_fd_nb_wake_up));
+  Pl_Engine_Add_Context(&pl_fd_nb_failure, sizeof(pl_fd_nb_failure));
+  Pl_Engine_Add_Context(&pl_fd_nb_decision, sizeof(pl_fd_nb_decision));
 
   pl_fd_unify_with_integer = Pl_Fd_Unify_With_Integer0;
   pl_fd_unify_with_fd_var = Pl_Fd_Unify_With_Fd_Var0;
@@ -431,6 +483,7 @@ Pl_Fd_Reset_Solver0(void)
   STAMP = 0;
   DATE = 1;
   TP = dummy_fd_var;		/* the queue is empty */
+  cstr_queue_mask = 0;
 }
 
 
@@ -528,11 +581,15 @@ Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word)
   WamWord *lst_adr;
   WamWord val;
   int n = 0;
+  int n_large = 0;
+  Ilist *il;
 
 
   save_list_word = list_word;
 
   range->extra_cstr = FALSE;
+  if (Is_Ilist(range))
+    range->vec = NULL;
   Vector_Allocate_If_Necessary(range->vec);
   Pl_Vector_Empty(range->vec);
 
@@ -553,8 +610,10 @@ Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word)
       
       val = Pl_Fd_Prolog_To_Value(Car(lst_adr));
 
-      if ((unsigned) val > (unsigned) pl_vec_max_integer)
+      if (val < 0)
 	range->extra_cstr = TRUE;
+      else if (val > pl_vec_max_integer)
+	n_large++;
       else
 	{
 	  Vector_Set_Value(range->vec, val);
@@ -564,6 +623,26 @@ Pl_Fd_List_Int_To_Range(Range *range, WamWord list_word)
       list_word = Cdr(lst_adr);
     }
 
+  if (n_large > 0)		/* too large for a vector: use an interval list */
+    {
+      Ilist_Allocate(il, n + n_large);
+      for (list_word = save_list_word;; list_word = Cdr(lst_adr))
+	{
+	  DEREF(list_word, word, tag_mask);
+	  if (word == NIL_WORD)
+	    break;
+
+	  lst_adr = UnTag_LST(word);
+	  val = Pl_Fd_Prolog_To_Value(Car(lst_adr));
+	  if (val >= 0)
+	    Ilist_Push_Interval(il, val, val);
+	}
+
+      Set_Range_Ilist(range, il);
+      Pl_Range_From_Ilist(range);
+      return;
+    }
+
   if (n == 0)
     Set_To_Empty(range);
   else
@@ -765,19 +844,29 @@ Pl_Fd_Prolog_To_Array_Fdv(WamWord list_word, Bool pl_var_ok)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 WamWord *
-Pl_Fd_Create_C_Frame(CstrFct cstr_fct , WamWord *AF, WamWord *fdv_adr, Bool optim2)
+Pl_Fd_Create_C_Frame(CstrFct cstr_fct , WamWord *AF, WamWord *fdv_adr, Bool optim2,
+		     int priority)
 {
   WamWord *CF = CS;
 
   AF_Pointer(CF) = AF;
   Optim_Pointer(CF) = (optim2 && fdv_adr) ? &FD_INT_Date(fdv_adr) : &optim2_date_always;
   Cstr_Address(CF) = cstr_fct;
+  Cstr_Prio_Weight(CF) = priority + (1 << CSTR_WEIGHT_SHIFT); /* weight = 1 */
+
+  pl_fd_nb_propag++;		/* it is executed just after its creation */
 
   /* if ground Nb_Cstr not allocated (Fd_Int_Frame) */
   if (fdv_adr && !Fd_Variable_Is_Ground(fdv_adr))
     Nb_Cstr(fdv_adr)++;
 
-  CS += CONSTRAINT_FRAME_SIZE;
+  if (priority == FD_PRIO_UNARY)
+    CS += CONSTRAINT_FRAME_SIZE;
+  else
+    {
+      Queue_Date(CF) = DATE_NEVER; /* not in the queue */
+      CS += QUEUED_CSTR_FRAME_SIZE;
+    }
 
   return CF;
 }
@@ -863,6 +952,10 @@ Pl_Fd_New_Variable_Interval(int min, int max)
   Chain_Min(fdv_adr) = Chain_Max(fdv_adr) = Chain_Min_Max(fdv_adr) = NULL;
   Chain_Dom(fdv_adr) = Chain_Val(fdv_adr) = NULL;
 
+  Activity(fdv_adr) = 0.0;
+  Activity_Date(fdv_adr) = pl_fd_nb_decision - 1;
+  Impact(fdv_adr) = 0.0;	/* unknown: behave as first-fail */
+
   CS += FD_VARIABLE_FRAME_SIZE;
   return fdv_adr;
 }
@@ -949,7 +1042,10 @@ Pl_Fd_Before_Add_Cstr(void)
   if (DATE == DATE_NEVER) /* reserve DATE_NEVER (i.e. 0) */
     DATE++;		  /* NB: it is not a problem if DATE == DATE_ALWAYS (i.e. 1) */
 
+  pl_fd_update_stamp++;
+
   TP = dummy_fd_var;		/* the queue is empty */
+  cstr_queue_mask = 0;
 
 #ifdef DEBUG_CHECK_DATES_AND_QUEUE
   Check_Queue_Consistency();
@@ -1000,6 +1096,8 @@ Clear_Queue(void)
   WamWord *BP;
   WamWord *fdv_adr;
 
+  cstr_queue_mask = 0;		/* nothing to clear (see comment above) */
+
   if (TP == dummy_fd_var)	/* empty ? */
     return;
 
@@ -1021,6 +1119,38 @@ Clear_Queue(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * SCHEDULE_CONSTRAINT                                                     *
+ *                                                                         *
+ * Adds CF at the end of the queue of its priority (if not yet scheduled). *
+ *-------------------------------------------------------------------------*/
+static void
+Schedule_Constraint(WamWord *CF)
+{
+  int prio;
+
+  if (Queue_Date(CF) == DATE)	/* already in the queue */
+    return;
+
+  pl_fd_nb_wake_up++;
+
+  Queue_Date(CF) = DATE;
+  Queue_Next_CF(CF) = NULL;
+
+  prio = Cstr_Priority(CF);
+  if (cstr_queue_mask & (1 << prio))
+    Queue_Next_CF(cstr_queue_last[prio]) = CF;
+  else
+    {
+      cstr_queue_first[prio] = CF;
+      cstr_queue_mask |= (1 << prio);
+    }
+  cstr_queue_last[prio] = CF;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_FD_TELL_VALUE                                                        *
  *                                                                         *
@@ -1081,32 +1211,9 @@ start:
 
 
   if (Is_Interval(r) && n != min && n != max)
-    {
-      if (min > pl_vec_max_integer)
-	{
-	  Pl_Fd_Display_Extra_Cstr(fdv_adr);
-	  return FALSE;
-	}
-
-      if (min == pl_vec_max_integer)
-	{
-	  Pl_Fd_Display_Extra_Cstr(fdv_adr);
-	  Update_Range_From_Int(fdv_adr, min, propag);
-	  All_Propagations(fdv_adr, propag);
-	  return TRUE;
-	}
-
-      Trail_Range_If_Necessary(fdv_adr);
+    {				/* a vector or an interval list (if max is */
+      Trail_Range_If_Necessary(fdv_adr);	/* too large), no value is lost */
       Pl_Range_Becomes_Sparse(r);
-      Nb_Elem(fdv_adr) = r->max - r->min + 1;
-      if (r->extra_cstr)	/* the max has been changed */
-	{
-	  propag = MASK_EMPTY;
-	  Set_Max_Mask(propag);
-	  Set_Min_Max_Mask(propag);
-	  Set_Dom_Mask(propag);
-	  All_Propagations(fdv_adr, propag);
-	}
       goto start;
     }
 
@@ -1125,11 +1232,26 @@ start:
 
   propag = MASK_EMPTY;
   Set_Dom_Mask(propag);
-  if (Is_Sparse(r))
-    Vector_Reset_Value(r->vec, n);
 
   Nb_Elem(fdv_adr)--;
 
+  if (Is_Ilist(r))		/* also updates min and max */
+    {
+      Pl_Range_Reset_Value(r, n);
+      if (n == min || n == max)
+	{
+	  Set_Min_Max_Mask(propag);
+	  if (n == min)
+	    Set_Min_Mask(propag);
+	  else
+	    Set_Max_Mask(propag);
+	}
+      goto do_propag;
+    }
+
+  if (Is_Sparse(r))
+    Vector_Reset_Value(r->vec, n);
+
   if (n == min)
     {
       Set_Min_Mask(propag);
@@ -1226,8 +1348,17 @@ Pl_Fd_Tell_Range_Range(WamWord *fdv_adr, Range *range)
   int nb_elem;
   int propag;
   WamWord *save_CS = CS;
+  WamWord *end;
+  Ilist *il;
 
-  if (range->vec)
+  if (Is_Ilist(range))		/* allocate after the list of range */
+    {
+      il = Range_Ilist(range);
+      end = (WamWord *) il + Ilist_Size(il->max_nb_itv);
+      if (end > CS)
+	CS = end;
+    }
+  else if (range->vec)
     CS = (WamWord *) range->vec;
   CS += pl_vec_size;
 
@@ -1315,10 +1446,22 @@ Pl_Fd_Tell_Range(WamWord *fdv_adr, Range *range)
 /*-------------------------------------------------------------------------*
  * ALL_PROPAGATIONS                                                        *
  *                                                                         *
+ * pl_fd_update_stamp is incremented at each update and at each new        *
+ * propagation phase (Pl_Fd_Before_Add_Cstr). A global constraint can thus *
+ * skip a reexecution if it is unchanged since it last reached its fix     *
+ * point (e.g. when it is awoken by its own updates).                      *
  *-------------------------------------------------------------------------*/
 static void
 All_Propagations(WamWord *fdv_adr, int propag)
 {
+  pl_fd_update_stamp++;
+
+  if (Activity_Date(fdv_adr) != pl_fd_nb_decision) /* 1st update since last decision */
+    {
+      Activity(fdv_adr) = (float) Pl_Fd_Activity(fdv_adr) + 1.0;
+      Activity_Date(fdv_adr) = pl_fd_nb_decision;
+    }
+
   if (propag &= Chains_Mask(fdv_adr))
     {				     /* here propag != 0 */
       if (!Is_Var_In_Queue(fdv_adr)) /* not yet in the queue */
@@ -1352,16 +1495,19 @@ Pl_Fd_After_Add_Cstr(Bool result_of_tell)
   PlULong *pdate;
   WamWord *AF;
   CstrFct fct;
+  int prio;
 
   if (!result_of_tell)
     {
     clear_queue:
+      pl_fd_nb_failure++;
       Clear_Queue(); /* Do it now, not in Pl_Fd_Before_Add_Cstr (see comment above) */
       return FALSE;
     }
 
+ var_queue:
   if (TP == dummy_fd_var)
-    return TRUE;
+    goto cstr_queue;
 
   BP = Queue_Next_Fdv_Adr(dummy_fd_var);
 
@@ -1393,6 +1539,15 @@ Pl_Fd_After_Add_Cstr(Bool result_of_tell)
 		  continue;
 #endif
 
+		if (Cstr_Priority(CF) != FD_PRIO_UNARY)
+		  {
+		    Schedule_Constraint(CF);
+		    continue;
+		  }
+
+		pl_fd_nb_wake_up++;
+		pl_fd_nb_propag++;
+
 		fct = Cstr_Address(CF);
 		AF = AF_Pointer(CF);
 
@@ -1401,6 +1556,7 @@ Pl_Fd_After_Add_Cstr(Bool result_of_tell)
 		if (fct == (CstrFct) FALSE)
 		  {
 		  failure:
+		    Cstr_Incr_Weight(CF);
 		    Queue_Next_Fdv_Adr(dummy_fd_var) = BP; /* update begin of remaining queue */
 		    goto clear_queue;
 		  }
@@ -1435,7 +1591,46 @@ Pl_Fd_After_Add_Cstr(Bool result_of_tell)
 
   TP = dummy_fd_var;		/* queue is now empty */
 
-  return TRUE;
+ cstr_queue:
+  if (cstr_queue_mask == 0)
+    return TRUE;
+
+  for (prio = 0; (cstr_queue_mask & (1 << prio)) == 0; prio++)
+    ;
+
+  CF = cstr_queue_first[prio];
+  if ((cstr_queue_first[prio] = Queue_Next_CF(CF)) == NULL)
+    cstr_queue_mask &= ~(1 << prio);
+
+  Queue_Date(CF) = DATE_NEVER;	/* no longer in the queue (can be rescheduled) */
+
+  pdate = Optim_Pointer(CF);	/* the constraint can have been stopped */
+  if (*pdate != DATE_ALWAYS && *pdate != date)
+    goto cstr_queue;
+
+  pl_fd_nb_propag++;
+
+  fct = Cstr_Address(CF);
+  AF = AF_Pointer(CF);
+
+  fct = (CstrFct) (*fct) (AF);
+
+  if (fct == (CstrFct) FALSE)
+    {
+    cstr_failure:
+      Cstr_Incr_Weight(CF);
+      goto clear_queue;
+    }
+
+  if (fct != (CstrFct) TRUE)	/* FD switch case triggered */
+    {
+      if ((*fct) (AF) == FALSE)
+	goto cstr_failure;
+
+      Pl_Fd_Stop_Constraint(CF);
+    }
+
+  goto var_queue;
 }
 
 
@@ -1455,6 +1650,54 @@ Pl_Fd_Stop_Constraint(WamWord *CF)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_FD_ACTIVITY                                                          *
+ *                                                                         *
+ * Returns the activity of a variable at the current decision.             *
+ *-------------------------------------------------------------------------*/
+double
+Pl_Fd_Activity(WamWord *fdv_adr)
+{
+  PlULong age = pl_fd_nb_decision - Activity_Date(fdv_adr);
+
+  if (age == 0)
+    return Activity(fdv_adr);
+
+  return Activity(fdv_adr) * pow(ACTIVITY_DECAY, (double) age);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FD_WEIGHTED_DEGREE                                                   *
+ *                                                                         *
+ * Returns the sum of the weights of the (not stopped) constraints         *
+ * depending on a variable.                                                *
+ *-------------------------------------------------------------------------*/
+PlLong
+Pl_Fd_Weighted_Degree(WamWord *fdv_adr)
+{
+  WamWord **chain_adr = &Chain_Min(fdv_adr);
+  WamWord *record_adr;
+  WamWord *CF;
+  PlLong wdeg = 0;
+  int i;
+
+  for (i = 0; i <= CHAIN_NB_VAL; i++, chain_adr++)
+    for (record_adr = *chain_adr; record_adr; record_adr = Next_Chain(record_adr))
+      {
+	CF = CF_Pointer(record_adr);
+	if (*Optim_Pointer(CF) != DATE_NEVER)
+	  wdeg += Cstr_Weight(CF);
+      }
+
+  return wdeg;
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_FD_IN_INTERVAL                                                       *
  *                                                                         *
@@ -1565,23 +1808,13 @@ Pl_Fd_Unify_With_Fd_Var0(WamWord *fdv_adr1, WamWord *fdv_adr2)
 Bool
 Pl_Fd_Use_Vector(WamWord *fdv_adr)
 {
-  Range range;
-
   if (Is_Sparse(Range(fdv_adr)))
     return TRUE;
+				/* a vector or an interval list (if max is */
+  Trail_Range_If_Necessary(fdv_adr);	/* too large), the domain is unchanged */
+  Pl_Range_Becomes_Sparse(Range(fdv_adr));
 
-  Pl_Fd_Before_Add_Cstr();
-  {
-    WamWord *save_CS = CS;	/* code of fd_allocate (from fd_to_c.h) */
-    CS += pl_vec_size;
-
-    Range_Init_Interval(&range, 0, INTERVAL_MAX_INTEGER);
-
-    Pl_Range_Becomes_Sparse(&range);
-
-    CS = save_CS;		/* code of fd_deallocate (from fd_to_c.h) */
-  }
-  return Pl_Fd_After_Add_Cstr(Pl_Fd_Tell_Range_Range(fdv_adr, &range));
+  return TRUE;
 }
 
 
@@ -1660,8 +1893,10 @@ Pl_Fd_Variable_Size0(WamWord *fdv_adr)
 {
   int size = FD_VARIABLE_FRAME_SIZE;
 
-  if (Is_Sparse(Range(fdv_adr)))
-      size += pl_vec_size;
+  if (Is_Ilist(Range(fdv_adr)))
+    size += Ilist_Size(Range_Ilist(Range(fdv_adr))->nb_itv);
+  else if (Is_Sparse(Range(fdv_adr)))
+    size += pl_vec_size;
 
   return size;
 }
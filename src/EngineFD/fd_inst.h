@@ -42,7 +42,7 @@
 
 	  /* FD Variable Frame */
 
-#define FD_VARIABLE_FRAME_SIZE     (OFFSET_RANGE + RANGE_SIZE + CHAINS_SIZE)
+#define FD_VARIABLE_FRAME_SIZE     (OFFSET_RANGE + RANGE_SIZE + CHAINS_SIZE + SEARCH_SIZE)
 #define FD_INT_VARIABLE_FRAME_SIZE (OFFSET_RANGE + RANGE_SIZE)
 
 #define OFFSET_RANGE               4
@@ -51,6 +51,9 @@
 #define OFFSET_CHAINS              (OFFSET_RANGE + RANGE_SIZE)
 #define CHAINS_SIZE                8
 
+#define OFFSET_SEARCH              (OFFSET_CHAINS + CHAINS_SIZE)
+#define SEARCH_SIZE                3
+
 
 
 #define FD_Tag_Value(fdv_adr)      (((WamWord *)  fdv_adr)[0])
@@ -72,6 +75,11 @@
 #define Chain_Dom(fdv_adr)         (((WamWord **) fdv_adr)[OFFSET_CHAINS + 6])
 #define Chain_Val(fdv_adr)         (((WamWord **) fdv_adr)[OFFSET_CHAINS + 7])
 
+	  /* not trailed: persist across backtracking (see fd_labeling/2) */
+#define Activity(fdv_adr)          (*(float *)   &(((WamWord *) fdv_adr)[OFFSET_SEARCH]))
+#define Activity_Date(fdv_adr)     (((PlULong *) fdv_adr)[OFFSET_SEARCH + 1])
+#define Impact(fdv_adr)            (*(float *)   &(((WamWord *) fdv_adr)[OFFSET_SEARCH + 2]))
+
 
 
 	  /* Shorthands for Queue management */
@@ -141,13 +149,38 @@
 
 typedef PlLong (*CstrFct) (WamWord *af);
 
-#define CONSTRAINT_FRAME_SIZE      3
+#define CONSTRAINT_FRAME_SIZE      4
+#define QUEUED_CSTR_FRAME_SIZE     6 /* if Cstr_Priority(cf) != FD_PRIO_UNARY */
 
 #define OFFSET_OF_OPTIM_POINTER    1	/* this offset must correspond to >>> */
 
 #define AF_Pointer(cf)             (*(WamWord **)    &(cf[0]))
 #define Optim_Pointer(cf)          (*(PlULong **)    &(cf[1]))	/* >>> this cell */
 #define Cstr_Address(cf)           (*(CstrFct *) &(cf[2]))
+#define Cstr_Prio_Weight(cf)       (cf[3])	/* priority + weight << 8 */
+#define Queue_Date(cf)             (*(PlULong *)     &(cf[4]))
+#define Queue_Next_CF(cf)          (*(WamWord **)    &(cf[5]))
+
+	  /* the weight (nb of failures + 1, not trailed) shares the priority */
+	  /* cell to keep constraint frames 4 words long                     */
+
+#define CSTR_WEIGHT_SHIFT          8
+
+#define Cstr_Priority(cf)          ((int) (Cstr_Prio_Weight(cf) & ((1 << CSTR_WEIGHT_SHIFT) - 1)))
+#define Cstr_Weight(cf)            ((PlLong) ((PlULong) Cstr_Prio_Weight(cf) >> CSTR_WEIGHT_SHIFT))
+#define Cstr_Incr_Weight(cf)       (Cstr_Prio_Weight(cf) += (1 << CSTR_WEIGHT_SHIFT))
+
+
+
+
+	  /* Priorities (cost classes of propagators, see fd2c) */
+
+#define FD_NB_PRIORITY             4
+
+#define FD_PRIO_UNARY              0
+#define FD_PRIO_LINEAR             1
+#define FD_PRIO_QUADRATIC          2
+#define FD_PRIO_CUBIC              3
 
 
 
@@ -180,13 +213,29 @@ typedef PlLong (*CstrFct) (WamWord *af);
 
 #ifdef FD_INST_FILE
 
-int pl_vec_size;
-int pl_vec_max_integer;
+PL_THREAD_LOCAL int pl_vec_size;
+PL_THREAD_LOCAL int pl_vec_max_integer;
+
+PL_THREAD_LOCAL PlULong pl_fd_update_stamp;
+
+PL_THREAD_LOCAL PlLong pl_fd_nb_propag;
+PL_THREAD_LOCAL PlLong pl_fd_nb_wake_up;
+PL_THREAD_LOCAL PlLong pl_fd_nb_failure;
+
+PL_THREAD_LOCAL PlULong pl_fd_nb_decision;
 
 #else
 
-extern int pl_vec_size;
-extern int pl_vec_max_integer;
+extern PL_THREAD_LOCAL int pl_vec_size;
+extern PL_THREAD_LOCAL int pl_vec_max_integer;
+
+extern PL_THREAD_LOCAL PlULong pl_fd_update_stamp;
+
+extern PL_THREAD_LOCAL PlLong pl_fd_nb_propag;
+extern PL_THREAD_LOCAL PlLong pl_fd_nb_wake_up;
+extern PL_THREAD_LOCAL PlLong pl_fd_nb_failure;
+
+extern PL_THREAD_LOCAL PlULong pl_fd_nb_decision;
 
 #endif
 
@@ -219,7 +268,8 @@ WamWord *Pl_Fd_New_Variable_Range(Range *r);
 
 WamWord *Pl_Fd_New_Int_Variable(int n);
 
-WamWord *Pl_Fd_Create_C_Frame(CstrFct cstr_fct, WamWord *AF, WamWord *fdv_adr, Bool optim2);
+WamWord *Pl_Fd_Create_C_Frame(CstrFct cstr_fct, WamWord *AF, WamWord *fdv_adr, Bool optim2,
+			      int priority);
 
 void Pl_Fd_Add_Dependency(WamWord *fdv_adr, int chain_nb, WamWord *CF);
 
@@ -233,6 +283,10 @@ Bool Pl_Fd_After_Add_Cstr(Bool result_of_tell);
 
 void Pl_Fd_Stop_Constraint(WamWord *CF);
 
+double Pl_Fd_Activity(WamWord *fdv_adr);
+
+PlLong Pl_Fd_Weighted_Degree(WamWord *fdv_adr);
+
 
 
 Bool Pl_Fd_Tell_Value(WamWord *fdv_adr, int n);
@@ -37,6 +37,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "bool.h"
@@ -90,6 +91,9 @@
 #define WRITE_INTERVALS_SEPARATOR  ":"
 #define WRITE_EXTRA_CSTR_SYMBOL    "@"
 
+#define ILIST_MAX_PAIRS            4096	/* max pairs of intervals combined */
+#define ILIST_MAX_ELEMS            4096	/* max products enumerated         */
+
 
 
 
@@ -105,6 +109,8 @@
  * Function Prototypes             *
  *---------------------------------*/
 
+static void Range_Becomes_Vector(Range *range);
+
 
 
 
@@ -115,6 +121,18 @@
 #define math_min(x, y)             ((x) <= (y) ? (x) : (y))
 #define math_max(x, y)             ((x) >= (y) ? (x) : (y))
 
+	  /* clip a PlLong to -1..INTERVAL_MAX_INTEGER+1 (i.e. out of range  *
+	   * values remain out of range but fit in an int)                   */
+
+#define Ilist_Clip(x)							\
+  ((x) < -1 ? -1 :							\
+   (x) > (PlLong) INTERVAL_MAX_INTEGER + 1 ? INTERVAL_MAX_INTEGER + 1 : (int) (x))
+
+	  /* a range which can be handled by the vector functions */
+
+#define Fits_In_Vector(range)						\
+  (!Is_Ilist(range) && (range)->min >= 0 && (range)->max <= pl_vec_max_integer)
+
 
 
 
@@ -662,124 +680,1098 @@ Pl_Vector_Add_Value(Vector vec, int n)
     }
   else
     {
-      word_no = Word_No(-n);
-      bit_no = Bit_No(-n);
+      word_no = Word_No(-n);
+      bit_no = Bit_No(-n);
+
+      if (word_no)
+	{
+	  i = 0;
+	  j = word_no;
+
+	  while (j < pl_vec_size)
+	    vec[i++] = vec[j++];
+
+	  while (i < pl_vec_size)
+	    vec[i++] = 0;
+	}
+
+      if (bit_no)
+	{
+	  rem = 0;
+	  for (i = pl_vec_size - 1 - word_no; i >= 0; i--)
+	    {
+	      rem1 = vec[i] << (WORD_SIZE - bit_no);
+	      vec[i] = (vec[i] >> bit_no) | rem;
+	      rem = rem1;
+	    }
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_MUL_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Mul_Value(Vector vec, int n)
+{
+  Vector aux_vec;
+  int vec_elem;
+  int x;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  x = vec_elem * n;
+
+  if ((unsigned) x > (unsigned) pl_vec_max_integer)
+    return;
+
+  Vector_Set_Value(vec, x);
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_DIV_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Div_Value(Vector vec, int n)
+{
+  Vector aux_vec;
+  int vec_elem;
+  int x;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  if (n == 0)
+    return;
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  if (vec_elem % n == 0)
+    {
+      x = vec_elem / n;
+      Vector_Set_Value(vec, x);
+    }
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_VECTOR_MOD_VALUE                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Vector_Mod_Value(Vector vec, int n)
+{
+  Vector aux_vec;
+  int vec_elem;
+  int x;
+
+  Vector_Allocate(aux_vec);
+  Pl_Vector_Copy(aux_vec, vec);
+  Pl_Vector_Empty(vec);
+
+  if (n == 0)
+    return;
+
+  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
+
+  x = vec_elem % n;
+  if ((unsigned) x <= (unsigned) pl_vec_max_integer)
+    Vector_Set_Value(vec, x);
+
+  VECTOR_END_ENUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * Interval lists: a sparse range whose max is > pl_vec_max_integer is     *
+ * stored as a sorted list of disjoint (and non adjacent) intervals of     *
+ * 0..INTERVAL_MAX_INTEGER (its vec field points to an Ilist, tagged by    *
+ * ILIST_TAG). Thus the pruning of large domains (e.g. timestamps or ids)  *
+ * is exact whereas a bit-vector could only record values up to           *
+ * pl_vec_max_integer. Ranges built by the functions below are normalized  *
+ * (see Pl_Range_From_Ilist): an empty list or a list with one interval    *
+ * becomes an interval and a list whose max fits becomes a bit-vector.     *
+ *                                                                         *
+ * The arithmetic operations compute the exact result when the number of  *
+ * elements (resp. of pairs of intervals) involved is small and otherwise  *
+ * an over-approximation (union of pairwise hulls or global hull) which is *
+ * sound for propagation.                                                  *
+ *                                                                         *
+ * The functions never modify an operand list except Pl_Range_Reset_Value  *
+ * (and Pl_Range_Copy into an existing list) which work in place when the  *
+ * list has been allocated since the last choice point (see the macro      *
+ * RANGE_CAN_MODIFY of fd_hook_range.h) and copy it otherwise.             *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * ILIST_SEARCH                                                            *
+ *                                                                         *
+ * Returns the index of the first interval whose max is >= n (nb_itv if    *
+ * none).                                                                  *
+ *-------------------------------------------------------------------------*/
+static int
+Ilist_Search(Ilist *il, int n)
+{
+  int lo = 0;
+  int hi = il->nb_itv;
+  int mid;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (il->itv[2 * mid + 1] < n)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_NB_ELEM                                                           *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static PlLong
+Ilist_Nb_Elem(Ilist *il)
+{
+  int *p = il->itv;
+  int *end = p + 2 * il->nb_itv;
+  PlLong nb_elem = 0;
+
+  for (; p < end; p += 2)
+    nb_elem += (PlLong) p[1] - p[0] + 1;
+
+  return nb_elem;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_COPY                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Ilist *
+Ilist_Copy(Ilist *il, int max_nb_itv)
+{
+  Ilist *il1;
+
+  Ilist_Allocate(il1, max_nb_itv);
+  il1->nb_itv = il->nb_itv;
+  memcpy(il1->itv, il->itv, 2 * il->nb_itv * sizeof(int));
+
+  return il1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_FROM_RANGE                                                        *
+ *                                                                         *
+ * Returns the interval list of a range (allocated if the range is not an  *
+ * interval list). If clip is FALSE the bounds of an interval are kept     *
+ * (arithmetic operations are then exact for negative values).             *
+ *-------------------------------------------------------------------------*/
+static Ilist *
+Ilist_From_Range(Range *range, Bool clip)
+{
+  Ilist *il;
+  int nb_itv;
+  int a, b;
+
+  if (Is_Ilist(range))
+    return Range_Ilist(range);
+
+  if (Is_Interval(range) || Is_Empty(range))
+    {
+      Ilist_Allocate(il, 1);
+      a = range->min;
+      b = range->max;
+      if (clip)
+	{
+	  a = math_max(a, 0);
+	  b = math_min(b, INTERVAL_MAX_INTEGER);
+	}
+      if (a <= b)
+	Ilist_Add_Interval(il, a, b);
+
+      return il;
+    }
+
+  nb_itv = 0;			/* count the runs of the vector */
+  for (a = Pl_Vector_Next_After(range->vec, -1); a >= 0;
+       a = Pl_Vector_Next_After(range->vec, b))
+    {
+      for (b = a; b < pl_vec_max_integer && Vector_Test_Value(range->vec, b + 1); b++)
+	;
+      nb_itv++;
+    }
+
+  Ilist_Allocate(il, math_max(nb_itv, 1));
+  for (a = Pl_Vector_Next_After(range->vec, -1); a >= 0;
+       a = Pl_Vector_Next_After(range->vec, b))
+    {
+      for (b = a; b < pl_vec_max_integer && Vector_Test_Value(range->vec, b + 1); b++)
+	;
+      Ilist_Add_Interval(il, a, b);
+    }
+
+  return il;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * VECTOR_SET_INTERVAL                                                     *
+ *                                                                         *
+ * Sets the values a..b (0 <= a <= b <= pl_vec_max_integer) in a vector.   *
+ *-------------------------------------------------------------------------*/
+static void
+Vector_Set_Interval(Vector vec, int a, int b)
+{
+  Vector w_a = vec + Word_No(a);
+  Vector w_b = vec + Word_No(b);
+  VecWord m_a = ALL_1 << Bit_No(a);
+  VecWord m_b = ALL_1 >> (WORD_SIZE - 1 - Bit_No(b));
+
+  if (w_a == w_b)
+    {
+      *w_a |= m_a & m_b;
+      return;
+    }
+
+  *w_a++ |= m_a;
+  while (w_a < w_b)
+    *w_a++ = ALL_1;
+  *w_b |= m_b;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CMP_INTERVAL                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Cmp_Interval(const void *i1, const void *i2)
+{
+  int a1 = *(int *) i1;
+  int a2 = *(int *) i2;
+
+  return (a1 > a2) - (a1 < a2);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_RANGE_BECOMES_ILIST                                                  *
+ *                                                                         *
+ * Converts an interval or a vector into an interval list (not normalized).*
+ *-------------------------------------------------------------------------*/
+void
+Pl_Range_Becomes_Ilist(Range *range)
+{
+  Ilist *il;
+
+  if (Is_Ilist(range))
+    return;
+
+  il = Ilist_From_Range(range, TRUE);
+  Set_Range_Ilist(range, il);
+
+  if (il->nb_itv == 0)
+    Set_To_Empty(range);
+  else
+    {
+      range->min = il->itv[0];
+      range->max = il->itv[2 * il->nb_itv - 1];
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_RANGE_FROM_ILIST                                                     *
+ *                                                                         *
+ * Normalizes a range whose interval list has been built with             *
+ * Ilist_Push_Interval / Ilist_Add_Interval: intervals are clipped to     *
+ * 0..INTERVAL_MAX_INTEGER, sorted and merged. The resulting range is an   *
+ * interval if at most one interval remains, a vector if the max fits, an  *
+ * interval list otherwise (min and max are updated in all cases).         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Range_From_Ilist(Range *range)
+{
+  Ilist *il = Range_Ilist(range);
+  int *p, *q, *end;
+  int a, b, i, nb_itv;
+  Bool sorted = TRUE;
+  Vector vec;
+
+  q = il->itv;
+  end = q + 2 * il->nb_itv;
+  for (p = q; p < end; p += 2)
+    {
+      a = math_max(p[0], 0);
+      b = math_min(p[1], INTERVAL_MAX_INTEGER);
+      if (a > b)
+	continue;
+
+      if (q > il->itv && a < q[-2])
+	sorted = FALSE;
+
+      *q++ = a;
+      *q++ = b;
+    }
+
+  nb_itv = (q - il->itv) / 2;
+  if (!sorted)
+    qsort(il->itv, nb_itv, 2 * sizeof(int), Cmp_Interval);
+
+  il->nb_itv = 0;
+  for (i = 0; i < nb_itv; i++)
+    {
+      a = il->itv[2 * i];
+      b = il->itv[2 * i + 1];
+      Ilist_Add_Interval(il, a, b);
+    }
+
+  nb_itv = il->nb_itv;
+  if (nb_itv == 0)
+    {
+      range->vec = NULL;
+      Set_To_Empty(range);
+      return;
+    }
+
+  range->min = il->itv[0];
+  range->max = il->itv[2 * nb_itv - 1];
+
+  if (nb_itv == 1)
+    {
+      range->vec = NULL;
+      return;
+    }
+
+  if (range->max > pl_vec_max_integer)
+    return;
+
+  Vector_Allocate(vec);
+  Pl_Vector_Empty(vec);
+  for (i = 0; i < nb_itv; i++)
+    Vector_Set_Interval(vec, il->itv[2 * i], il->itv[2 * i + 1]);
+
+  range->vec = vec;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_TEST_NULL_INTER                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static Bool
+Ilist_Test_Null_Inter(Range *range, Range *range1)
+{
+  Ilist *il;
+  int *p, *end;
+  int n;
+
+  if (!Is_Ilist(range))
+    {
+      Range *r = range;
+
+      range = range1;
+      range1 = r;
+    }
+
+  il = Range_Ilist(range);
+  end = il->itv + 2 * il->nb_itv;
+  for (p = il->itv; p < end; p += 2)
+    {
+      n = Pl_Range_Next_After(range1, p[0] - 1);
+      if (n >= 0 && n <= p[1])
+	return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_COPY_INTO_RANGE                                                   *
+ *                                                                         *
+ * Copies an interval list into range (reusing its list if possible). The  *
+ * source can be located above RANGE_TOP_STACK (overlapping allowed).      *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Copy_Into_Range(Range *range, Ilist *il1)
+{
+  Ilist *il = (Is_Ilist(range)) ? Range_Ilist(range) : NULL;
+  int nb_itv = il1->nb_itv;
+  int max_nb_itv;
+
+  if (il == il1)
+    return;
+
+  if (il == NULL || il->max_nb_itv < nb_itv || !RANGE_CAN_MODIFY(il))
+    {
+      il = (Ilist *) RANGE_TOP_STACK;
+      RANGE_TOP_STACK += Ilist_Size(nb_itv);
+      max_nb_itv = nb_itv;
+    }
+  else
+    max_nb_itv = il->max_nb_itv;
+
+  memmove(il->itv, il1->itv, 2 * nb_itv * sizeof(int));
+  il->nb_itv = nb_itv;
+  il->max_nb_itv = max_nb_itv;
+
+  Set_Range_Ilist(range, il);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_SET_VALUE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Set_Value(Range *range, int n)
+{
+  Ilist *il = Range_Ilist(range);
+
+  if (n < 0)
+    {
+      range->extra_cstr = TRUE;
+      return;
+    }
+
+  if (Pl_Range_Test_Value(range, n))
+    return;
+
+  il = Ilist_Copy(il, il->nb_itv + 1);
+  Ilist_Push_Interval(il, n, n);
+  Set_Range_Ilist(range, il);
+  Pl_Range_From_Ilist(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_RESET_VALUE                                                       *
+ *                                                                         *
+ * The list is updated in place if possible (else copied with some room).  *
+ * An interval list with one interval left becomes an interval.            *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Reset_Value(Range *range, int n)
+{
+  Ilist *il = Range_Ilist(range);
+  int i = Ilist_Search(il, n);
+  int *p;
+  int max;
+
+  if (i >= il->nb_itv || il->itv[2 * i] > n)	/* not present */
+    return;
+
+  if (!RANGE_CAN_MODIFY(il) || il->nb_itv == il->max_nb_itv)
+    {
+      il = Ilist_Copy(il, il->nb_itv + il->nb_itv / 4 + 2);
+      Set_Range_Ilist(range, il);
+    }
+
+  p = il->itv + 2 * i;
+  if (p[0] == p[1])		/* remove the interval */
+    {
+      memmove(p, p + 2, 2 * (il->nb_itv - i - 1) * sizeof(int));
+      il->nb_itv--;
+    }
+  else if (n == p[0])
+    p[0]++;
+  else if (n == p[1])
+    p[1]--;
+  else				/* split the interval */
+    {
+      max = p[1];
+      memmove(p + 4, p + 2, 2 * (il->nb_itv - i - 1) * sizeof(int));
+      p[1] = n - 1;
+      p[2] = n + 1;
+      p[3] = max;
+      il->nb_itv++;
+    }
+
+  if (il->nb_itv == 0)
+    {
+      range->vec = NULL;
+      Set_To_Empty(range);
+      return;
+    }
+
+  range->min = il->itv[0];
+  range->max = il->itv[2 * il->nb_itv - 1];
+  if (il->nb_itv == 1)
+    range->vec = NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_UNION                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Union(Range *range, Range *range1)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *il1 = Ilist_From_Range(range1, TRUE);
+  Ilist *res;
+  int *p = il->itv, *end = p + 2 * il->nb_itv;
+  int *p1 = il1->itv, *end1 = p1 + 2 * il1->nb_itv;
+
+  Ilist_Allocate(res, math_max(il->nb_itv + il1->nb_itv, 1));
+  while (p < end || p1 < end1)
+    {
+      if (p1 >= end1 || (p < end && p[0] <= p1[0]))
+	{
+	  Ilist_Add_Interval(res, p[0], p[1]);
+	  p += 2;
+	}
+      else
+	{
+	  Ilist_Add_Interval(res, p1[0], p1[1]);
+	  p1 += 2;
+	}
+    }
+
+  range->extra_cstr |= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_INTER                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Inter(Range *range, Range *range1)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *il1 = Ilist_From_Range(range1, TRUE);
+  Ilist *res;
+  int *p = il->itv, *end = p + 2 * il->nb_itv;
+  int *p1 = il1->itv, *end1 = p1 + 2 * il1->nb_itv;
+  int a, b;
+
+  Ilist_Allocate(res, math_max(il->nb_itv + il1->nb_itv, 1));
+  while (p < end && p1 < end1)
+    {
+      a = math_max(p[0], p1[0]);
+      b = math_min(p[1], p1[1]);
+      if (a <= b)
+	Ilist_Add_Interval(res, a, b);
+
+      if (p[1] < p1[1])
+	p += 2;
+      else
+	p1 += 2;
+    }
+
+  range->extra_cstr &= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_COMPL                                                             *
+ *                                                                         *
+ * Complement w.r.t. 0..INTERVAL_MAX_INTEGER.                              *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Compl(Range *range)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *res;
+  int *p = il->itv, *end = p + 2 * il->nb_itv;
+  int next = 0;
+
+  Ilist_Allocate(res, il->nb_itv + 1);
+  for (; p < end; p += 2)
+    {
+      if (p[0] > next)
+	Ilist_Add_Interval(res, next, p[0] - 1);
+      next = p[1] + 1;
+    }
+
+  if (next <= INTERVAL_MAX_INTEGER)
+    Ilist_Add_Interval(res, next, INTERVAL_MAX_INTEGER);
+
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_ADD_SUB_RANGE                                                     *
+ *                                                                         *
+ * Computes range + range1 (or range - range1 if sub is TRUE). The result  *
+ * is exact if the number of pairs of intervals is small enough, else the  *
+ * list with the most intervals is combined with the hull of the other.    *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Add_Sub_Range(Range *range, Range *range1, Bool sub)
+{
+  Ilist *il = Ilist_From_Range(range, FALSE);
+  Ilist *il1 = Ilist_From_Range(range1, FALSE);
+  Ilist *res;
+  int *p, *end = il->itv + 2 * il->nb_itv;
+  int *p1, *end1 = il1->itv + 2 * il1->nb_itv;
+  int hull[2];
+
+  if ((PlLong) il->nb_itv * il1->nb_itv <= ILIST_MAX_PAIRS)
+    {
+      Ilist_Allocate(res, math_max(il->nb_itv * il1->nb_itv, 1));
+      for (p = il->itv; p < end; p += 2)
+	for (p1 = il1->itv; p1 < end1; p1 += 2)
+	  if (sub)
+	    Ilist_Push_Interval(res, p[0] - p1[1], p[1] - p1[0]);
+	  else
+	    Ilist_Push_Interval(res, p[0] + p1[0], p[1] + p1[1]);
+    }
+  else if (il->nb_itv >= il1->nb_itv)
+    {
+      hull[0] = il1->itv[0];
+      hull[1] = end1[-1];
+      Ilist_Allocate(res, il->nb_itv);
+      for (p = il->itv; p < end; p += 2)
+	if (sub)
+	  Ilist_Push_Interval(res, p[0] - hull[1], p[1] - hull[0]);
+	else
+	  Ilist_Push_Interval(res, p[0] + hull[0], p[1] + hull[1]);
+    }
+  else
+    {
+      hull[0] = il->itv[0];
+      hull[1] = end[-1];
+      Ilist_Allocate(res, il1->nb_itv);
+      for (p1 = il1->itv; p1 < end1; p1 += 2)
+	if (sub)
+	  Ilist_Push_Interval(res, hull[0] - p1[1], hull[1] - p1[0]);
+	else
+	  Ilist_Push_Interval(res, hull[0] + p1[0], hull[1] + p1[1]);
+    }
+
+  range->extra_cstr |= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_FEW_PRODUCTS                                                      *
+ *                                                                         *
+ * Tests if the number of pairs of elements of 2 lists is small enough to  *
+ * compute an operation exactly (by enumeration).                          *
+ *-------------------------------------------------------------------------*/
+static Bool
+Ilist_Few_Products(Ilist *il, Ilist *il1)
+{
+  PlLong nb_elem = Ilist_Nb_Elem(il);
+  PlLong nb_elem1 = Ilist_Nb_Elem(il1);
+
+  return nb_elem <= ILIST_MAX_ELEMS && nb_elem1 <= ILIST_MAX_ELEMS &&
+    nb_elem * nb_elem1 <= ILIST_MAX_ELEMS;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_PAIRS                                                             *
+ *                                                                         *
+ * Defines the bounds of the lists of intervals to combine pairwise: the   *
+ * lists themselves or their hulls if there are too many pairs (never the  *
+ * case when Ilist_Few_Products() succeeds since ILIST_MAX_ELEMS <=        *
+ * ILIST_MAX_PAIRS).                                                       *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Pairs(Ilist *il, Ilist *il1, int *hull, int *hull1,
+	    int **start, int **end, int **start1, int **end1)
+{
+  *start = il->itv;
+  *end = il->itv + 2 * il->nb_itv;
+  *start1 = il1->itv;
+  *end1 = il1->itv + 2 * il1->nb_itv;
+
+  if ((PlLong) il->nb_itv * il1->nb_itv <= ILIST_MAX_PAIRS)
+    return;
+
+  hull[0] = il->itv[0];
+  hull[1] = (*end)[-1];
+  hull1[0] = il1->itv[0];
+  hull1[1] = (*end1)[-1];
+
+  *start = hull;
+  *end = hull + 2;
+  *start1 = hull1;
+  *end1 = hull1 + 2;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_MUL_RANGE                                                         *
+ *                                                                         *
+ * Exact if the number of products is small enough, else the union of the *
+ * hulls of the products of each pair of intervals.                        *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Mul_Range(Range *range, Range *range1)
+{
+  Ilist *il = Ilist_From_Range(range, FALSE);
+  Ilist *il1 = Ilist_From_Range(range1, FALSE);
+  Ilist *res;
+  int *p, *start, *end;
+  int *p1, *start1, *end1;
+  int hull[2], hull1[2];
+  PlLong x, y, lo, hi, z;
+
+  Ilist_Pairs(il, il1, hull, hull1, &start, &end, &start1, &end1);
+
+  if (Ilist_Few_Products(il, il1))
+    {
+      Ilist_Allocate(res, math_max(Ilist_Nb_Elem(il) * Ilist_Nb_Elem(il1), 1));
+      for (p = start; p < end; p += 2)
+	for (x = p[0]; x <= p[1]; x++)
+	  for (p1 = start1; p1 < end1; p1 += 2)
+	    for (y = p1[0]; y <= p1[1]; y++)
+	      {
+		z = Ilist_Clip(x * y);
+		Ilist_Push_Interval(res, z, z);
+	      }
+    }
+  else
+    {
+      Ilist_Allocate(res, (end - start) / 2 * ((end1 - start1) / 2));
+      for (p = start; p < end; p += 2)
+	for (p1 = start1; p1 < end1; p1 += 2)
+	  {
+	    lo = hi = (PlLong) p[0] * p1[0];
+	    z = (PlLong) p[0] * p1[1];
+	    lo = math_min(lo, z);
+	    hi = math_max(hi, z);
+	    z = (PlLong) p[1] * p1[0];
+	    lo = math_min(lo, z);
+	    hi = math_max(hi, z);
+	    z = (PlLong) p[1] * p1[1];
+	    lo = math_min(lo, z);
+	    hi = math_max(hi, z);
+	    Ilist_Push_Interval(res, Ilist_Clip(lo), Ilist_Clip(hi));
+	  }
+    }
 
-      if (word_no)
-	{
-	  i = 0;
-	  j = word_no;
+  range->extra_cstr |= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
 
-	  while (j < pl_vec_size)
-	    vec[i++] = vec[j++];
 
-	  while (i < pl_vec_size)
-	    vec[i++] = 0;
-	}
 
-      if (bit_no)
-	{
-	  rem = 0;
-	  for (i = pl_vec_size - 1 - word_no; i >= 0; i--)
-	    {
-	      rem1 = vec[i] << (WORD_SIZE - bit_no);
-	      vec[i] = (vec[i] >> bit_no) | rem;
-	      rem = rem1;
-	    }
-	}
+
+/*-------------------------------------------------------------------------*
+ * ILIST_DIV_RANGE                                                         *
+ *                                                                         *
+ * Exact division (as for vectors): x/y is kept only if y divides x.       *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Div_Range(Range *range, Range *range1)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *il1 = Ilist_From_Range(range1, TRUE);
+  Ilist *res;
+  int *p, *start, *end;
+  int *p1, *start1, *end1;
+  int hull[2], hull1[2];
+  int x, y, a, c;
+
+  Ilist_Pairs(il, il1, hull, hull1, &start, &end, &start1, &end1);
+
+  if (Ilist_Few_Products(il, il1))
+    {
+      Ilist_Allocate(res, math_max(Ilist_Nb_Elem(il) * Ilist_Nb_Elem(il1), 1));
+      for (p = start; p < end; p += 2)
+	for (x = p[0]; x <= p[1]; x++)
+	  for (p1 = start1; p1 < end1; p1 += 2)
+	    for (y = p1[0]; y <= p1[1]; y++)
+	      if (x == 0)
+		Ilist_Push_Interval(res, 0, 0);
+	      else if (y != 0 && x % y == 0)
+		Ilist_Push_Interval(res, x / y, x / y);
+    }
+  else
+    {
+      Ilist_Allocate(res, (end - start) * ((end1 - start1) / 2));
+      for (p = start; p < end; p += 2)
+	for (p1 = start1; p1 < end1; p1 += 2)
+	  {
+	    a = p[0];
+	    if (a == 0)
+	      {
+		Ilist_Push_Interval(res, 0, 0);
+		a = 1;
+	      }
+	    c = math_max(p1[0], 1);
+	    if (a <= p[1] && c <= p1[1])
+	      Ilist_Push_Interval(res, (a + p1[1] - 1) / p1[1], p[1] / c);
+	  }
     }
+
+  range->extra_cstr |= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_MUL_VALUE                                                     *
+ * ILIST_PUSH_MOD                                                          *
  *                                                                         *
+ * Pushes (at most 2 intervals) the values of a..b mod n (0 <= a, n > 0).  *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Mul_Value(Vector vec, int n)
+static void
+Ilist_Push_Mod(Ilist *il, int a, int b, int n)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
+  if (b - a + 1 >= n)
+    {
+      Ilist_Push_Interval(il, 0, n - 1);
+      return;
+    }
 
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
+  a = a % n;
+  b = b % n;
+  if (a <= b)
+    Ilist_Push_Interval(il, a, b);
+  else
+    {
+      Ilist_Push_Interval(il, 0, b);
+      Ilist_Push_Interval(il, a, n - 1);
+    }
+}
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
 
-  x = vec_elem * n;
 
-  if ((unsigned) x > (unsigned) pl_vec_max_integer)
-    return;
 
-  Vector_Set_Value(vec, x);
+/*-------------------------------------------------------------------------*
+ * ILIST_MOD_RANGE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Mod_Range(Range *range, Range *range1)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *il1 = Ilist_From_Range(range1, TRUE);
+  Ilist *res;
+  int *p, *start, *end;
+  int *p1, *start1, *end1;
+  int hull[2], hull1[2];
+  int x, y, c;
 
-  VECTOR_END_ENUM;
+  Ilist_Pairs(il, il1, hull, hull1, &start, &end, &start1, &end1);
+
+  if (Ilist_Few_Products(il, il1))
+    {
+      Ilist_Allocate(res, math_max(Ilist_Nb_Elem(il) * Ilist_Nb_Elem(il1), 1));
+      for (p = start; p < end; p += 2)
+	for (x = p[0]; x <= p[1]; x++)
+	  for (p1 = start1; p1 < end1; p1 += 2)
+	    for (y = p1[0]; y <= p1[1]; y++)
+	      if (y != 0)
+		Ilist_Push_Interval(res, x % y, x % y);
+    }
+  else
+    {
+      Ilist_Allocate(res, (end - start) * ((end1 - start1) / 2));
+      for (p = start; p < end; p += 2)
+	for (p1 = start1; p1 < end1; p1 += 2)
+	  {
+	    c = math_max(p1[0], 1);
+	    if (c > p1[1])
+	      continue;
+	    if (p[1] < c)	/* x < y: x mod y = x */
+	      Ilist_Push_Interval(res, p[0], p[1]);
+	    else if (c == p1[1])
+	      Ilist_Push_Mod(res, p[0], p[1], c);
+	    else
+	      Ilist_Push_Interval(res, 0, math_min(p[1], p1[1] - 1));
+	  }
+    }
+
+  range->extra_cstr |= range1->extra_cstr;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_DIV_VALUE                                                     *
+ * ILIST_ADD_VALUE                                                         *
  *                                                                         *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Div_Value(Vector vec, int n)
+static void
+Ilist_Add_Value(Range *range, int n)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
+  Ilist *il = Ilist_From_Range(range, FALSE);
+  Ilist *res;
+  int *p, *end = il->itv + 2 * il->nb_itv;
 
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
+  Ilist_Allocate(res, math_max(il->nb_itv, 1));
+  for (p = il->itv; p < end; p += 2)
+    Ilist_Push_Interval(res, Ilist_Clip((PlLong) p[0] + n),
+			Ilist_Clip((PlLong) p[1] + n));
 
-  if (n == 0)
-    return;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
 
-  if (vec_elem % n == 0)
+
+
+/*-------------------------------------------------------------------------*
+ * ILIST_MUL_VALUE                                                         *
+ *                                                                         *
+ * Exact if the number of elements is small enough, else each interval is *
+ * replaced by its image hull.                                             *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Mul_Value(Range *range, int n)
+{
+  Ilist *il = Ilist_From_Range(range, FALSE);
+  Ilist *res;
+  int *p, *end = il->itv + 2 * il->nb_itv;
+  PlLong nb_elem = Ilist_Nb_Elem(il);
+  PlLong x, z, z1;
+
+  if (nb_elem <= ILIST_MAX_ELEMS)
     {
-      x = vec_elem / n;
-      Vector_Set_Value(vec, x);
+      Ilist_Allocate(res, math_max((int) nb_elem, 1));
+      for (p = il->itv; p < end; p += 2)
+	for (x = p[0]; x <= p[1]; x++)
+	  {
+	    z = Ilist_Clip(x * n);
+	    Ilist_Push_Interval(res, z, z);
+	  }
+    }
+  else
+    {
+      Ilist_Allocate(res, math_max(il->nb_itv, 1));
+      for (p = il->itv; p < end; p += 2)
+	{
+	  z = Ilist_Clip((PlLong) p[0] * n);
+	  z1 = Ilist_Clip((PlLong) p[1] * n);
+	  Ilist_Push_Interval(res, math_min(z, z1), math_max(z, z1));
+	}
     }
 
-  VECTOR_END_ENUM;
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
 }
 
 
 
 
 /*-------------------------------------------------------------------------*
- * PL_VECTOR_MOD_VALUE                                                     *
+ * ILIST_DIV_VALUE                                                         *
  *                                                                         *
+ * Exact division (as for vectors): x/n is kept only if n divides x.       *
  *-------------------------------------------------------------------------*/
-void
-Pl_Vector_Mod_Value(Vector vec, int n)
+static void
+Ilist_Div_Value(Range *range, int n)
 {
-  Vector aux_vec;
-  int vec_elem;
-  int x;
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *res;
+  int *p, *end = il->itv + 2 * il->nb_itv;
+
+  Ilist_Allocate(res, math_max(il->nb_itv, 1));
+  if (n > 0)
+    for (p = il->itv; p < end; p += 2)
+      Ilist_Push_Interval(res, (p[0] + n - 1) / n, p[1] / n);
+  else if (il->nb_itv > 0 && il->itv[0] == 0)
+    Ilist_Push_Interval(res, 0, 0);
+
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
+}
 
-  Vector_Allocate(aux_vec);
-  Pl_Vector_Copy(aux_vec, vec);
-  Pl_Vector_Empty(vec);
 
-  if (n == 0)
-    return;
 
-  VECTOR_BEGIN_ENUM(aux_vec, vec_elem);
 
-  x = vec_elem % n;
-  if ((unsigned) x <= (unsigned) pl_vec_max_integer)
-    Vector_Set_Value(vec, x);
+/*-------------------------------------------------------------------------*
+ * ILIST_MOD_VALUE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Ilist_Mod_Value(Range *range, int n)
+{
+  Ilist *il = Ilist_From_Range(range, TRUE);
+  Ilist *res;
+  int *p, *end = il->itv + 2 * il->nb_itv;
 
-  VECTOR_END_ENUM;
+  Ilist_Allocate(res, math_max(2 * il->nb_itv, 1));
+  if (n > 0)
+    for (p = il->itv; p < end; p += 2)
+      Ilist_Push_Mod(res, p[0], p[1], n);
+
+  Set_Range_Ilist(range, res);
+  Pl_Range_From_Ilist(range);
 }
 
 
@@ -801,6 +1793,14 @@ Pl_Range_Test_Value(Range *range, int n)
   if (Is_Interval(range) || n == min || n == max)
     return TRUE;
 
+  if (Is_Ilist(range))
+    {
+      Ilist *il = Range_Ilist(range);
+      int i = Ilist_Search(il, n);
+
+      return i < il->nb_itv && il->itv[2 * i] <= n;
+    }
+
   return Vector_Test_Value(range->vec, n);
 }
 
@@ -823,6 +1823,9 @@ Pl_Range_Test_Null_Inter(Range *range, Range *range1)
       range->max == range1->min || range->max == range1->max)
     return FALSE;
 
+  if (Is_Ilist(range) || Is_Ilist(range1))
+    return Ilist_Test_Null_Inter(range, range1);
+
   swt = (Is_Sparse(range) << 1) + Is_Sparse(range1);
 
   if (swt == 3)			/* Sparse with Sparse */
@@ -867,8 +1870,12 @@ Pl_Range_Copy(Range *range, Range *range1)
 
   if (Is_Interval(range1))
     range->vec = NULL;
+  else if (Is_Ilist(range1))
+    Ilist_Copy_Into_Range(range, Range_Ilist(range1));
   else
     {
+      if (Is_Ilist(range))	/* never reuse a list as a vector */
+	range->vec = NULL;
       Vector_Allocate_If_Necessary(range->vec);
       Pl_Vector_Copy(range->vec, range1->vec);
     }
@@ -887,6 +1894,8 @@ Pl_Range_Nb_Elem(Range *range)
   if (Is_Interval(range))	/* here range is not empty */
     return range->max - range->min + 1;
 
+  if (Is_Ilist(range))
+    return (int) Ilist_Nb_Elem(Range_Ilist(range));
 
   return Pl_Vector_Nb_Elem(range->vec);
 }
@@ -913,6 +1922,21 @@ Pl_Range_Ith_Elem(Range *range, int i)
       return n < range->min || n > range->max ? -1 : n;
     }
 
+  if (Is_Ilist(range))
+    {
+      Ilist *il = Range_Ilist(range);
+      int *p = il->itv;
+      int *end = p + 2 * il->nb_itv;
+
+      for (; p < end && i > 0; p += 2)
+	{
+	  if (i <= p[1] - p[0] + 1)
+	    return p[0] + i - 1;
+	  i -= p[1] - p[0] + 1;
+	}
+
+      return -1;
+    }
 
   return Pl_Vector_Ith_Elem(range->vec, i);
 }
@@ -942,6 +1966,19 @@ Pl_Range_Next_After(Range *range, int n)
       return n;
     }
 
+  if (Is_Ilist(range))
+    {
+      Ilist *il = Range_Ilist(range);
+      int i;
+
+      if (n >= range->max)
+	return -1;
+
+      n++;
+      i = Ilist_Search(il, n);
+
+      return math_max(il->itv[2 * i], n);
+    }
 
   return Pl_Vector_Next_After(range->vec, n);
 }
@@ -971,6 +2008,21 @@ Pl_Range_Next_Before(Range *range, int n)
       return n;
     }
 
+  if (Is_Ilist(range))
+    {
+      Ilist *il = Range_Ilist(range);
+      int i;
+
+      if (n <= range->min)
+	return -1;
+
+      n--;
+      i = Ilist_Search(il, n);
+      if (i < il->nb_itv && il->itv[2 * i] <= n)
+	return n;
+
+      return il->itv[2 * i - 1];
+    }
 
   return Pl_Vector_Next_Before(range->vec, n);
 }
@@ -984,6 +2036,26 @@ Pl_Range_Next_Before(Range *range, int n)
  *-------------------------------------------------------------------------*/
 void
 Pl_Range_Becomes_Sparse(Range *range)
+{
+  if (range->max > pl_vec_max_integer)
+    {
+      Pl_Range_Becomes_Ilist(range);
+      return;
+    }
+
+  Range_Becomes_Vector(range);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RANGE_BECOMES_VECTOR                                                    *
+ *                                                                         *
+ * Values > pl_vec_max_integer are lost (extra_cstr is then set).          *
+ *-------------------------------------------------------------------------*/
+static void
+Range_Becomes_Vector(Range *range)
 {
   Vector_Allocate_If_Necessary(range->vec);
 
@@ -1068,20 +2140,23 @@ Pl_Range_Set_Value(Range *range, int n)
 	}
 
       Pl_Range_Becomes_Sparse(range);
-      if ((unsigned) n <= (unsigned) pl_vec_max_integer)
-	{
-	  Vector_Set_Value(range->vec, n);
-	  Pl_Range_From_Vector(range);
-	}
-      else
-	range->extra_cstr = TRUE;
+    }
 
+  if (Is_Ilist(range))
+    {
+      Ilist_Set_Value(range, n);
       return;
     }
 
   if ((unsigned) n > (unsigned) pl_vec_max_integer)
     {
-      range->extra_cstr = TRUE;
+      if (n < 0)
+	range->extra_cstr = TRUE;
+      else
+	{
+	  Pl_Range_Becomes_Ilist(range);
+	  Ilist_Set_Value(range, n);
+	}
       return;
     }
 
@@ -1124,13 +2199,14 @@ Pl_Range_Reset_Value(Range *range, int n)
 	}
 
       Pl_Range_Becomes_Sparse(range);
-      if ((unsigned) n <= (unsigned) pl_vec_max_integer)
-	Vector_Reset_Value(range->vec, n);
+    }
 
+  if (Is_Ilist(range))
+    {
+      Ilist_Reset_Value(range, n);
       return;
     }
 
-
   if ((unsigned) n > (unsigned) pl_vec_max_integer)
     return;
 
@@ -1164,7 +2240,16 @@ Pl_Range_Union(Range *range, Range *range1)
 	  range->max = math_max(range->max, range1->max);
 	  return;
 	}
+    }
 
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1))
+    {
+      Ilist_Union(range, range1);
+      return;
+    }
+
+  if (swt == 0)			/* Interval with Interval */
+    {
       Pl_Range_Becomes_Sparse(range);
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
@@ -1223,14 +2308,20 @@ Pl_Range_Inter(Range *range, Range *range1)
       return;
     }
 
+  if (Is_Ilist(range) || Is_Ilist(range1))
+    {
+      Ilist_Inter(range, range1);
+      return;
+    }
+				/* the result fits in a vector */
   if (swt == 1)			/* Interval with Sparse */
-    Pl_Range_Becomes_Sparse(range);
+    Range_Becomes_Vector(range);
   else if (swt == 2)		/* Sparse with Interval */
     {
       r.vec = NULL;
       Pl_Range_Copy(&r, range1);	/* we cannot modify range1 */
       range1 = &r;
-      Pl_Range_Becomes_Sparse(range1);
+      Range_Becomes_Vector(range1);
     }
   /* Sparse with Sparse */
 
@@ -1289,23 +2380,17 @@ Pl_Range_Compl(Range *range)
 
 	  return;
 	}
-
-      Pl_Range_Becomes_Sparse(range);
     }
-  /* Sparse */
-  range->extra_cstr = TRUE;
-
+  /* Sparse (or Interval in the middle) */
   if (Is_Empty(range))
     {
+      range->vec = NULL;
       range->min = 0;
-      range->max = pl_vec_max_integer;
-      Pl_Vector_Full(range->vec);
-    }
-  else
-    {
-      Pl_Vector_Compl(range->vec);
-      Pl_Range_From_Vector(range);
+      range->max = INTERVAL_MAX_INTEGER;
+      return;
     }
+
+  Ilist_Compl(range);
 }
 
 
@@ -1337,7 +2422,15 @@ Pl_Range_Add_Range(Range *range, Range *range1)
       range->max += range1->max;
       return;
     }
-  else if (swt == 1)		/* Interval with Sparse */
+
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1) ||
+      range->max + range1->max > pl_vec_max_integer)
+    {
+      Ilist_Add_Sub_Range(range, range1, FALSE);
+      return;
+    }
+
+  if (swt == 1)		/* Interval with Sparse */
     Pl_Range_Becomes_Sparse(range);
   else if (swt == 2)		/* Sparse with Interval */
     {
@@ -1388,7 +2481,14 @@ Pl_Range_Sub_Range(Range *range, Range *range1)
       range->max -= range1->min;
       return;
     }
-  else if (swt == 1)		/* Interval with Sparse */
+
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1))
+    {
+      Ilist_Add_Sub_Range(range, range1, TRUE);
+      return;
+    }
+
+  if (swt == 1)		/* Interval with Sparse */
     Pl_Range_Becomes_Sparse(range);
   else if (swt == 2)		/* Sparse with Interval */
     {
@@ -1430,6 +2530,13 @@ Pl_Range_Mul_Range(Range *range, Range *range1)
       return;
     }
 
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1) ||
+      (PlLong) range->max * range1->max > pl_vec_max_integer)
+    {
+      Ilist_Mul_Range(range, range1);
+      return;
+    }
+
   if (Is_Interval(range))
     Pl_Range_Becomes_Sparse(range);
 
@@ -1468,6 +2575,12 @@ Pl_Range_Div_Range(Range *range, Range *range1)
       return;
     }
 
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1))
+    {
+      Ilist_Div_Range(range, range1);
+      return;
+    }
+
   if (Is_Interval(range))
     Pl_Range_Becomes_Sparse(range);
 
@@ -1506,6 +2619,12 @@ Pl_Range_Mod_Range(Range *range, Range *range1)
       return;
     }
 
+  if (!Fits_In_Vector(range) || !Fits_In_Vector(range1))
+    {
+      Ilist_Mod_Range(range, range1);
+      return;
+    }
+
   if (Is_Interval(range))
     Pl_Range_Becomes_Sparse(range);
 
@@ -1545,6 +2664,12 @@ Pl_Range_Add_Value(Range *range, int n)
       return;
     }
   /* Sparse */
+  if (Is_Ilist(range) || (PlLong) range->max + n > pl_vec_max_integer)
+    {
+      Ilist_Add_Value(range, n);
+      return;
+    }
+
   Pl_Vector_Add_Value(range->vec, n);
 
   range->min += n;
@@ -1567,6 +2692,12 @@ Pl_Range_Mul_Value(Range *range, int n)
   if (n == 1 || Is_Empty(range))
     return;
 
+  if (!Fits_In_Vector(range) || (PlLong) range->max * n > pl_vec_max_integer)
+    {
+      Ilist_Mul_Value(range, n);
+      return;
+    }
+
   if (Is_Interval(range))	/* Interval */
     Pl_Range_Becomes_Sparse(range);
   /* Sparse */
@@ -1593,6 +2724,12 @@ Pl_Range_Div_Value(Range *range, int n)
   if (n == 1 || Is_Empty(range))
     return;
 
+  if (!Fits_In_Vector(range))
+    {
+      Ilist_Div_Value(range, n);
+      return;
+    }
+
   if (Is_Interval(range))	/* Interval */
     Pl_Range_Becomes_Sparse(range);
   /* Sparse */
@@ -1681,6 +2818,12 @@ Pl_Range_Mod_Value(Range *range, int n)
       return;
     }
   /* Sparse */
+  if (Is_Ilist(range))
+    {
+      Ilist_Mod_Value(range, n);
+      return;
+    }
+
   Pl_Vector_Mod_Value(range->vec, n);
 
   Pl_Range_From_Vector(range);
@@ -1699,7 +2842,7 @@ Pl_Range_To_String(Range *range)
   int vec_elem;
   int limit1 = -1;
   int limit2;
-  static char buff[100 * 1024];
+  static PL_THREAD_LOCAL char buff[100 * 1024];
 
 
   if (Is_Empty(range))
@@ -1725,6 +2868,33 @@ Pl_Range_To_String(Range *range)
 
   strcpy(buff, WRITE_BEGIN_RANGE);
 
+  if (Is_Ilist(range))
+    {
+      Ilist *il = Range_Ilist(range);
+      int *p = il->itv;
+      int *end = p + 2 * il->nb_itv;
+
+      for (; p < end; p += 2)
+	{
+	  if (strlen(buff) > sizeof(buff) - 64)
+	    {
+	      strcat(buff, "...");
+	      break;
+	    }
+	  if (p[0] == p[1])
+	    sprintf(buff + strlen(buff), "%d", p[0]);
+	  else
+	    sprintf(buff + strlen(buff), "%d%s%d",
+		    p[0], WRITE_LIMITS_SEPARATOR, p[1]);
+	  strcat(buff, (p + 2 < end) ? WRITE_INTERVALS_SEPARATOR : WRITE_END_RANGE);
+	}
+
+      if (range->extra_cstr)
+	strcat(buff, WRITE_EXTRA_CSTR_SYMBOL);
+
+      return buff;
+    }
+
   VECTOR_BEGIN_ENUM(range->vec, vec_elem);
   if (limit1 == -1)
     limit1 = limit2 = vec_elem;
@@ -61,6 +61,14 @@ typedef struct			/* Ranges are always handled through pointers */
 Range;
 
 
+typedef struct			/* Interval lists are handled through pointers */
+{				/* (stored in the vec field of a Range)        */
+  int nb_itv;			/* number of intervals                         */
+  int max_nb_itv;		/* number of allocated intervals               */
+  int itv[2];			/* itv[2*i]..itv[2*i+1]: i-th interval (sorted) */
+}
+Ilist;
+
 
 
 /*---------------------------------*
@@ -160,6 +168,10 @@ void Pl_Range_Becomes_Sparse(Range *range);
 
 void Pl_Range_From_Vector(Range *range);
 
+void Pl_Range_Becomes_Ilist(Range *range);
+
+void Pl_Range_From_Ilist(Range *range);
+
 void Pl_Range_Union(Range *range, Range *range1);
 
 void Pl_Range_Inter(Range *range, Range *range1);
@@ -269,6 +281,82 @@ char *Pl_Range_To_String(Range *range);
 
 
 
+/*---------------------------------*
+ * Interval List Management Macros *
+ *---------------------------------*/
+
+#define ILIST_TAG                  ((PlULong) 1)
+
+#define Is_Ilist(range)            (((PlULong) (range)->vec & ILIST_TAG) != 0)
+#define Is_Vector(range)           ((range)->vec != NULL && !Is_Ilist(range))
+
+#define Range_Ilist(range)         ((Ilist *) ((PlULong) (range)->vec & ~ILIST_TAG))
+#define Set_Range_Ilist(range, il) ((range)->vec = (Vector) ((PlULong) (il) | ILIST_TAG))
+
+
+#define Ilist_Size(max_nb_itv)						\
+  ((int) ((sizeof(Ilist) + ((max_nb_itv) - 1) * 2 * sizeof(int) +	\
+	   sizeof(VecWord) - 1) / sizeof(VecWord)))
+
+
+
+
+#define Ilist_Allocate(il, max_nb)		\
+  do						\
+    {						\
+      il = (Ilist *) RANGE_TOP_STACK;		\
+      RANGE_TOP_STACK += Ilist_Size(max_nb);	\
+      (il)->nb_itv = 0;				\
+      (il)->max_nb_itv = (max_nb);		\
+    }						\
+  while (0)
+
+
+
+
+	  /* Ilist_Add_Interval appends a..b (not empty) to an interval    *
+	   * list, intervals must be added by increasing lower bounds      *
+	   * (merging overlapping and adjacent ones)                       */
+
+#define Ilist_Add_Interval(il, a, b)				\
+  do								\
+    {								\
+      int *add_p = (il)->itv + 2 * (il)->nb_itv;		\
+								\
+      if ((il)->nb_itv > 0 && (a) <= add_p[-1] + 1)		\
+	{							\
+	  if ((b) > add_p[-1])					\
+	    add_p[-1] = (b);					\
+	}							\
+      else							\
+	{							\
+	  add_p[0] = (a);					\
+	  add_p[1] = (b);					\
+	  (il)->nb_itv++;					\
+	}							\
+    }								\
+  while (0)
+
+
+
+
+	  /* Ilist_Push_Interval appends a..b in any order (and possibly   *
+	   * empty or out of 0..INTERVAL_MAX_INTEGER), the resulting list  *
+	   * must be normalized with Pl_Range_From_Ilist()                 */
+
+#define Ilist_Push_Interval(il, a, b)				\
+  do								\
+    {								\
+      int *add_p = (il)->itv + 2 * (il)->nb_itv++;		\
+								\
+      add_p[0] = (a);						\
+      add_p[1] = (b);						\
+    }								\
+  while (0)
+
+
+
+
 /*---------------------------------*
  * Range Management Macros         *
  *---------------------------------*/
@@ -292,3 +380,22 @@ char *Pl_Range_To_String(Range *range);
     }							\
   while (0)
 
+
+
+
+	  /* To enumerate a range of values >= 0 (e.g. the domain of an FD *
+	   * variable) whatever its representation use RANGE_BEGIN_ENUM /  *
+	   * RANGE_END_ENUM macros as follows:                             *
+	   * ...                                                           *
+	   * RANGE_BEGIN_ENUM(the_range,range_elem)                        *
+	   *    your code (range_elem contains the current range element)  *
+	   * RANGE_END_ENUM                                                */
+
+#define RANGE_BEGIN_ENUM(range, range_elem)				\
+  for (range_elem = Pl_Range_Next_After(range, -1); range_elem >= 0;	\
+       range_elem = Pl_Range_Next_After(range, range_elem))		\
+    {
+
+
+#define RANGE_END_ENUM                                                  \
+    }
@@ -107,6 +107,19 @@
 #endif
 
 
+/* Thread-local variables: needed for engines running in parallel (see
+ * engine.c). Also used by the code generated by Ma2Asm (foreign/2 arrays,
+ * see x86_64_any.c) thus only defined where Ma2Asm handles them. pl_config.c
+ * then enables parallel engines if the WAM register bank is in a machine
+ * register (see PARALLEL_ENGINES and PL_THREAD_LOCAL in wam_regs.h).
+ */
+
+#if defined(M_x86_64) && defined(__ELF__) && !defined(M_darwin) && \
+    defined(__GNUC__) && defined(HAVE_PTHREAD_H)
+#define TLS_KEYWORD                __thread
+#endif
+
+
 /* check printf arguments */
 
 #if defined(__GNUC__) && !defined(M_win64) /* gcc on mingw64 warns about PRIdPTR in x86_64_any.c ??? */
@@ -67,6 +67,16 @@
 
 #define ERR_TABLE_FULL_NO_ENV      "Atom table full (max atom: %d - fixed size)"
 
+#define ERR_TABLE_FULL_MAX         "Atom table full (max atom: %d - maximum size)"
+
+
+	  /* an atom GC is requested after this number of new collectable
+	   * atoms (at least ATOM_GC_MIN_PERIOD or 1/ATOM_GC_PERIOD_DEN of
+	   * the table size) */
+
+#define ATOM_GC_MIN_PERIOD         4096
+#define ATOM_GC_PERIOD_DEN         4
+
 
 
 
@@ -115,6 +125,22 @@ char pl_escape_char[] = "\a\b\f\n\r\t\v";
 
 static char str_char[256][2];
 
+	  /* The atom table (pl_atom_tbl) is indexed by the atom number. Atoms
+	   * are found via a separate hash table of chains (hash_head/next)
+	   * so that the table can grow and free entries can be reused
+	   * (see atom GC in gc.c). The chain of free entries uses next too.
+	   * The hash chains are only accessed under pl_atom_lock while
+	   * pl_atom_tbl is read without lock (it is never freed). */
+
+static int *hash_head;		/* 1st atom of each chain (-1 = none) */
+static int *hash_next;		/* next atom in chain (or free entry) */
+static PlULong hash_size;	/* a power of 2                       */
+
+static int free_atom = -1;	/* chain of free (reclaimed) entries  */
+static PlULong nb_used_entry;	/* entries >= this one never used     */
+
+static PlULong nb_new_collectable; /* collectable atoms since last GC */
+
 
 
 
@@ -122,11 +148,16 @@ static char str_char[256][2];
  * Function Prototypes             *
  *---------------------------------*/
 
-static int Add_Atom(char *name, int len, unsigned hash, 
-		    AtomInf *patom, Bool allocate);
+static int Add_Atom(char *name, int len, unsigned hash,
+		    Bool allocate, Bool collectable);
+
+static int New_Atom_Entry(void);
 
+static void Grow_Atom_Table(void);
 
-static AtomInf *Locate_Atom(char *name, unsigned hash);
+static void Rehash_Atom_Table(PlULong new_size);
+
+static int Locate_Atom(char *name, unsigned hash);
 
 static unsigned Hash_String(char *str, int len);
 
@@ -144,17 +175,24 @@ Pl_Init_Atom(void)
 {
   int i, c;
   
-  if (pl_max_atom < 256)
-    pl_max_atom = 256;
-
   if (pl_max_atom <= ATOM_NIL)
-    pl_max_atom = ATOM_NIL + 1;	/* to be sure h([]) % pl_max_atom == ATOM_NIL */
+    pl_max_atom = ATOM_NIL + 1;	/* 1-char atoms + [] (created in that order) */
 
   if (pl_max_atom > ((PlULong) 1 << ATOM_MAX_BITS)) /* be sure f/n words can be encoded (see wam_inst.h) */
     pl_max_atom = ((PlULong) 1 << ATOM_MAX_BITS);
 
+  pl_atom_lock = Pl_Lock_Create();
+
   pl_atom_tbl = (AtomInf *) Calloc(pl_max_atom, sizeof(AtomInf));
+  hash_next = (int *) Malloc(pl_max_atom * sizeof(int));
   pl_nb_atom = 0;
+  nb_used_entry = 0;
+  free_atom = -1;
+
+  for (hash_size = 256; hash_size < pl_max_atom; hash_size *= 2)
+    ;
+  hash_head = NULL;
+  Rehash_Atom_Table(hash_size);
     
 
   for (c = 128; c < 256; c++) 
@@ -201,9 +239,27 @@ Pl_Create_Allocate_Atom(char *name)
 {
   int len = (int) strlen(name);
   unsigned hash = Hash_String(name, len);
-  AtomInf *patom = Locate_Atom(name, hash);
 
-  return Add_Atom(name, len, hash, patom, TRUE);
+  return Add_Atom(name, len, hash, TRUE, FALSE);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_CREATE_COLLECTABLE_ATOM                                              *
+ *                                                                         *
+ * Like Pl_Create_Allocate_Atom but the atom can be reclaimed by the atom  *
+ * GC when it is no longer referenced. Only use it for atoms which are not *
+ * recorded in C data (e.g. atoms built from Prolog data).                 *
+ *-------------------------------------------------------------------------*/
+int
+Pl_Create_Collectable_Atom(char *name)
+{
+  int len = (int) strlen(name);
+  unsigned hash = Hash_String(name, len);
+
+  return Add_Atom(name, len, hash, TRUE, TRUE);
 }
 
 
@@ -220,9 +276,7 @@ Pl_Create_Atom(char *name)
   int len = (int) strlen(name);
   unsigned hash = Hash_String(name, len);
 
-  AtomInf *patom = Locate_Atom(name, hash);
-
-  return Add_Atom(name, len, hash, patom, FALSE);
+  return Add_Atom(name, len, hash, FALSE, FALSE);
 }
 
 
@@ -233,19 +287,30 @@ Pl_Create_Atom(char *name)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 static int
-Add_Atom(char *name, int len, unsigned hash, AtomInf *patom, Bool allocate)
+Add_Atom(char *name, int len, unsigned hash, Bool allocate, Bool collectable)
 {
+  AtomInf *patom;
   AtomProp prop;
   char *p;
   int c_type;
   Bool identifier;
   Bool graphic;
+  int atom;
+  int *head;
 
-  if (patom == NULL)
-    Error_Table_Full();
+  Pl_Lock_Acquire(pl_atom_lock);
 
-  if (patom->name != NULL)
-    return (int) (patom - pl_atom_tbl);	/* already exists */
+  atom = Locate_Atom(name, hash);
+  if (atom >= 0)		/* already exists */
+    {
+      if (!collectable)		/* now referenced by C code: keep it */
+	pl_atom_tbl[atom].prop.collectable = FALSE;
+      Pl_Lock_Release(pl_atom_lock);
+      return atom;
+    }
+
+  atom = New_Atom_Entry();
+  patom = pl_atom_tbl + atom;
 
   if (allocate)
     name = Strdup(name);
@@ -254,8 +319,21 @@ Add_Atom(char *name, int len, unsigned hash, AtomInf *patom, Bool allocate)
 
   patom->name = name;
   patom->hash = hash;
+  patom->info = NULL;
+
+  head = hash_head + (hash & (hash_size - 1));
+  hash_next[atom] = *head;
+  *head = atom;
+
+  if (pl_nb_atom > hash_size)
+    Rehash_Atom_Table(hash_size * 2);
 
   prop.needs_scan = FALSE;
+  prop.collectable = collectable;
+
+  if (collectable && ++nb_new_collectable >= ATOM_GC_MIN_PERIOD &&
+      nb_new_collectable >= pl_max_atom / ATOM_GC_PERIOD_DEN)
+    Pl_Atom_GC_Request();
 
   identifier = graphic = (*name != '\0');
 
@@ -320,9 +398,224 @@ Add_Atom(char *name, int len, unsigned hash, AtomInf *patom, Bool allocate)
 
 finish:
   prop.op_mask = 0;
+  prop.pin_count = 0;
   patom->prop = prop;
 
-  return (int) (patom - pl_atom_tbl);
+  Pl_Lock_Release(pl_atom_lock);
+
+  return atom;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEW_ATOM_ENTRY                                                          *
+ *                                                                         *
+ * Returns a free entry of the atom table (growing it if needed). Entries  *
+ * are first used in increasing order (see ATOM_NIL and OPTIM_1_CHAR_ATOM) *
+ * then the entries reclaimed by the atom GC are reused.                   *
+ *-------------------------------------------------------------------------*/
+static int
+New_Atom_Entry(void)
+{
+  int atom;
+
+  if (free_atom >= 0)
+    {
+      atom = free_atom;
+      free_atom = hash_next[atom];
+      return atom;
+    }
+
+  if (nb_used_entry >= pl_max_atom)
+    Grow_Atom_Table();
+
+  return (int) nb_used_entry++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GROW_ATOM_TABLE                                                         *
+ *                                                                         *
+ * Atoms are identified by their index, the table is thus simply extended  *
+ * (the hash table is independent). With PARALLEL_ENGINES the old table is *
+ * not freed since other engines read it without lock.                     *
+ *-------------------------------------------------------------------------*/
+static void
+Grow_Atom_Table(void)
+{
+  PlULong max_atom = ((PlULong) 1 << ATOM_MAX_BITS);
+  PlULong new_max;
+
+  if (pl_fixed_sizes || pl_max_atom >= max_atom)
+    Error_Table_Full();
+
+  new_max = pl_max_atom * 2;
+  if (new_max > max_atom)
+    new_max = max_atom;
+
+#ifdef PARALLEL_ENGINES
+  {
+    AtomInf *new_tbl = (AtomInf *) Calloc(new_max, sizeof(AtomInf));
+
+    memcpy(new_tbl, pl_atom_tbl, pl_max_atom * sizeof(AtomInf));
+    pl_atom_tbl = new_tbl;
+  }
+#else
+  pl_atom_tbl = (AtomInf *) Realloc(pl_atom_tbl, new_max * sizeof(AtomInf));
+  memset(pl_atom_tbl + pl_max_atom, 0, (new_max - pl_max_atom) * sizeof(AtomInf));
+#endif
+
+  hash_next = (int *) Realloc(hash_next, new_max * sizeof(int));
+
+  pl_max_atom = new_max;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * REHASH_ATOM_TABLE                                                       *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Rehash_Atom_Table(PlULong new_size)
+{
+  PlULong i;
+  int *head;
+
+  if (hash_head)
+    Free(hash_head);
+
+  hash_size = new_size;
+  hash_head = (int *) Malloc(hash_size * sizeof(int));
+  for (i = 0; i < hash_size; i++)
+    hash_head[i] = -1;
+
+  for (i = 0; i < nb_used_entry; i++)
+    if (pl_atom_tbl[i].name)
+      {
+	head = hash_head + (pl_atom_tbl[i].hash & (hash_size - 1));
+	hash_next[i] = *head;
+	*head = (int) i;
+      }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_KEEP_ATOM                                                            *
+ *                                                                         *
+ * Make an atom permanent: to be called when C code records an atom which *
+ * can come from Prolog data (e.g. a stream file name).                    *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Keep_Atom(int atom)
+{
+  Pl_Lock_Acquire(pl_atom_lock);	/* prop is a bitfield also written by op/3 */
+  pl_atom_tbl[atom].prop.collectable = FALSE;
+  Pl_Lock_Release(pl_atom_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_PIN_ATOM                                                             *
+ *                                                                         *
+ * Protect an atom from the atom GC until Pl_Unpin_Atom is called (pins    *
+ * are counted). Part of the foreign interface (see gprolog.h): for C code *
+ * keeping an atom across calls (e.g. in a static variable) where the GC   *
+ * cannot see it. The count saturates: the atom then remains pinned.       *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Pin_Atom(int atom)
+{
+  AtomProp *prop;
+
+  Pl_Lock_Acquire(pl_atom_lock);	/* the table can be reallocated */
+  prop = &pl_atom_tbl[atom].prop;
+  if (prop->pin_count < MAX_ATOM_PIN_COUNT)
+    prop->pin_count++;
+  Pl_Lock_Release(pl_atom_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_UNPIN_ATOM                                                           *
+ *                                                                         *
+ * Undo a Pl_Pin_Atom (the atom can be reclaimed once it is no longer      *
+ * pinned nor referenced).                                                 *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Unpin_Atom(int atom)
+{
+  AtomProp *prop;
+
+  Pl_Lock_Acquire(pl_atom_lock);	/* the table can be reallocated */
+  prop = &pl_atom_tbl[atom].prop;
+  if (prop->pin_count > 0 && prop->pin_count < MAX_ATOM_PIN_COUNT)
+    prop->pin_count--;
+  Pl_Lock_Release(pl_atom_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_DELETE_ATOM                                                          *
+ *                                                                         *
+ * Called by the atom GC (see gc.c) for a collectable atom which is no     *
+ * longer referenced. Its entry can then be reused by a new atom.          *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Delete_Atom(int atom)
+{
+  AtomInf *patom = pl_atom_tbl + atom;
+  int *p;
+
+  Pl_Lock_Acquire(pl_atom_lock);
+
+  p = hash_head + (patom->hash & (hash_size - 1));
+  while (*p != atom)
+    p = hash_next + *p;
+
+  *p = hash_next[atom];
+
+#ifndef NO_USE_LINEDIT
+  if (patom->prop.length > 1 && patom->prop.type == IDENTIFIER_ATOM)
+    Pl_LE_Compl_Remove_Word(patom->name);
+#endif
+
+  Free(patom->name);
+  patom->name = NULL;
+  patom->info = NULL;
+
+  hash_next[atom] = free_atom;
+  free_atom = atom;
+  pl_nb_atom--;
+
+  Pl_Lock_Release(pl_atom_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_DONE                                                         *
+ *                                                                         *
+ * Called at the end of an atom GC to restart counting new atoms.          *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Done(void)
+{
+  nb_new_collectable = 0;
 }
 
 
@@ -352,10 +645,13 @@ Pl_Find_Atom(char *name)
 {
   int len = (int) strlen(name);
   unsigned hash = Hash_String(name, len);
-  AtomInf *patom;
+  int atom;
 
-  patom = Locate_Atom(name, hash);
-  return (patom == NULL || patom->name == NULL) ? -1 : (int) (patom - pl_atom_tbl);
+  Pl_Lock_Acquire(pl_atom_lock);
+  atom = Locate_Atom(name, hash);
+  Pl_Lock_Release(pl_atom_lock);
+
+  return atom;
 }
 
 
@@ -364,61 +660,26 @@ Pl_Find_Atom(char *name)
 /*-------------------------------------------------------------------------*
  * LOCATE_ATOM                                                             *
  *                                                                         *
- * We use a specific hash table for atoms that cannot be extended but which*
- * provides a unique integer (0..pl_max_atom-1) that could be used in the  *
- * future for tagged ATM words (and for structures).                       *
- *                                                                         *
- * index (in the table) = hash code % pl_max_atom                          *
+ * The atom number is the index in the atom table (0..pl_max_atom-1). It   *
+ * is independent of the hash code: atoms with the same hash code (modulo  *
+ * hash_size) are chained (see hash_head/hash_next).                       *
  *                                                                         *
- * return the address of the found atom (if exists)                        *
- *        the address of the corresponding free cell (if not exist)        *
- *        NULL if the table is full                                        *
+ * return the found atom or -1 if it does not exist.                       *
  *-------------------------------------------------------------------------*/
-static AtomInf *
+static int
 Locate_Atom(char *name, unsigned hash)
 {
-  int index;
-  AtomInf *patom0, *patom, *endt;
-
-  index = hash % pl_max_atom;
-  patom = patom0 = pl_atom_tbl + index;
-  endt = pl_atom_tbl + pl_max_atom;
-
-  while (patom->name && (patom->hash != hash || strcmp(patom->name, name) != 0))
-    {
-      patom++;
-      if (patom == endt)
-	patom = pl_atom_tbl;
-      if (patom == patom0)	/* one complete round: the table is full */
-	return NULL;
-    }
-
-#if 0
-  if (patom->name == NULL)
-    {
-      if (patom != patom0)
-	{
-	  printf("atom: (%s) collision ixd: %ld -> %ld\n", name, patom0 - pl_atom_tbl, patom - pl_atom_tbl);
-	}
-
-      if (hash !=  patom - pl_atom_tbl)
-	{
-	  printf("atom: (%s)   hash: %u   idx: %ld\n", name, hash, patom - pl_atom_tbl);
-	}
-    }
-#endif
+  int atom;
+  AtomInf *patom;
 
-#if 0
-  if (patom->name == NULL)
+  for (atom = hash_head[hash & (hash_size - 1)]; atom >= 0; atom = hash_next[atom])
     {
-      if (hash != index)
-	{
-	  printf("atom: (%s)   hash: %u   initial idx: %d\n", name, hash, index);
-	}
+      patom = pl_atom_tbl + atom;
+      if (patom->hash == hash && strcmp(patom->name, name) == 0)
+	break;
     }
-#endif
 
-  return patom;
+  return atom;
 }
 
 
@@ -492,18 +753,15 @@ Pl_Gen_New_Atom(char *prefix)
   unsigned hash;
   char *str;
   int c;
-  AtomInf *patom;
   int atom;
 
-  if (pl_nb_atom >= pl_max_atom)
-    Error_Table_Full();
-
-
 #ifdef DEBUG
   nb++;
   /* printf("GEN_SYM PREFIX : %s\n", prefix); */
 #endif
 
+  Pl_Lock_Acquire(pl_atom_lock);	/* also protects the static buffer and the RNG */
+
   strcpy(gen_sym_buff, prefix);
   str = gen_sym_buff + strlen(prefix);
 
@@ -517,18 +775,14 @@ Pl_Gen_New_Atom(char *prefix)
 
       hash = Hash_String(gen_sym_buff, len);
 
-#if 1
-      patom = Locate_Atom(gen_sym_buff, hash);
-#else
-      patom = pl_atom_tbl + (hash % pl_max_atom);
-#endif
+      atom = Locate_Atom(gen_sym_buff, hash);
 
 #ifdef DEBUG
       try_count++;
       /*      printf("GEN_SYM TRY %3d: %s   len: %d\n", try_count, gen_sym_buff, len); */
 #endif
 
-      if (patom->name == NULL)
+      if (atom < 0)
 	break;
 
       if (++try_no == TRY_MAX)
@@ -544,7 +798,7 @@ Pl_Gen_New_Atom(char *prefix)
     }
 
 
-  atom = Add_Atom(gen_sym_buff, len, hash, patom, TRUE);
+  atom = Add_Atom(gen_sym_buff, len, hash, TRUE, TRUE);
 
 #ifdef DEBUG
   sum_try += try_count;
@@ -567,6 +821,7 @@ Pl_Gen_New_Atom(char *prefix)
     }
 #endif
 
+  Pl_Lock_Release(pl_atom_lock);
 
   return atom;
 }
@@ -600,7 +855,9 @@ Pl_Find_Next_Atom(int last_atom)
 static void
 Error_Table_Full(void)
 {
-  if (pl_fixed_sizes)
+  if (pl_max_atom >= ((PlULong) 1 << ATOM_MAX_BITS))
+    Pl_Fatal_Error(ERR_TABLE_FULL_MAX, pl_max_atom);
+  else if (pl_fixed_sizes)
     Pl_Fatal_Error(ERR_TABLE_FULL_NO_ENV, pl_max_atom);
   else
     Pl_Fatal_Error(ERR_TABLE_FULL_ENV, pl_max_atom, ENV_VAR_MAX_ATOM);
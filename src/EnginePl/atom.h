@@ -81,6 +81,8 @@
 
 
 
+#define MAX_ATOM_PIN_COUNT         127	/* reached: the atom stays pinned */
+
 
 #define Is_Valid_Code(c)           ((PlULong) (c)-1 < 256-1)    /* 1 <= c < 256 */
 #define Is_Valid_Byte(c)           ((PlULong) (c) < 256)	/* 0 <= c < 256 */
@@ -101,6 +103,8 @@ typedef struct			/* Atom properties                */
   unsigned type:2;		/* IDENTIFIER GRAPHIC SOLO OTHER  */
   unsigned needs_quote:1;	/* needs ' around it ?            */
   unsigned needs_scan:1;	/* contains ' or control char ?   */
+  unsigned collectable:1;	/* can be reclaimed by atom GC ?  */
+  unsigned pin_count:7;		/* nb of Pl_Pin_Atom not undone   */
 }
 AtomProp;
 
@@ -129,6 +133,8 @@ AtomInf *pl_atom_tbl;
 PlULong pl_max_atom;
 PlULong pl_nb_atom;
 
+struct pl_lock *pl_atom_lock;	/* a PlLock: protects the atom and operator tables */
+
 int pl_atom_void;
 int pl_atom_curly_brackets;
 
@@ -154,6 +160,8 @@ extern AtomInf *pl_atom_tbl;
 extern PlULong pl_max_atom;
 extern PlULong pl_nb_atom;
 
+extern struct pl_lock *pl_atom_lock;
+
 extern int pl_atom_void;
 extern int pl_atom_curly_brackets;
 
@@ -188,6 +196,8 @@ int Pl_Create_Allocate_Atom(char *name);
 
 int Pl_Create_Atom(char *name);
 
+int Pl_Create_Collectable_Atom(char *name);
+
 WamWord FC Pl_Create_Atom_Tagged(char *name);
 
 int Pl_Find_Atom(char *name);
@@ -196,6 +206,16 @@ int Pl_Gen_New_Atom(char *prefix);
 
 int Pl_Find_Next_Atom(int last_atom);
 
+void Pl_Keep_Atom(int atom);
+
+void Pl_Pin_Atom(int atom);
+
+void Pl_Unpin_Atom(int atom);
+
+void Pl_Delete_Atom(int atom);
+
+void Pl_Atom_GC_Done(void);
+
 
 
 #ifdef OPTIM_1_CHAR_ATOM
@@ -52,6 +52,10 @@
 #include <sys/param.h>
 #endif
 
+#if !defined(_WIN32) && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#endif
+
 #define ENGINE_FILE
 
 #include "engine_pl.h"
@@ -70,6 +74,12 @@
 
 #define ERR_DIRECTIVE_FAILED       "warning: %s:%d: %s directive failed\n"
 
+#define MAX_ENGINE_CONTEXT         256
+#define MAX_ENGINE_INIT_FCT        8
+#define MAX_ENGINE_BUFFER          16
+
+#define GLOB_BUFF_SIZE             (1024 * 1024)
+
 
 
 
@@ -77,25 +87,152 @@
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct			/* global variable private to each engine */
+{
+  PlLong offset;		/* address - Ctx_Base (see Pl_Engine_Add_Context) */
+  int size;
+}
+EngineCtxInf;
+
+
+typedef struct			/* buffer private to each engine */
+{
+  int ctx_no;			/* context variable pointing to it */
+  int ctx_pos;			/* position of its value in the context */
+  int size;
+}
+EngineBuffInf;
+
+
+struct pl_engine		/* see PlEngine in engine.h */
+{
+  PlEngine next;		/* next engine in the list */
+  Bool attached;		/* attached to a thread ? (see list_lock) */
+  InfStack stk_tbl[NB_OF_STACKS];
+  WamWord *stacks_base;		/* stacks area (NULL for the main engine) */
+  size_t stacks_length;
+#ifdef NO_MACHINE_REG_FOR_REG_BANK
+  WamWord reg_bank[REG_BANK_SIZE];
+#else
+  WamWord *reg_bank;		/* at the beginning of the heap */
+#endif
+  WamWord buff_regs[NB_OF_USED_MACHINE_REGS + 1];  /* +1 if = 0 */
+  char *context;		/* values of the engine context variables */
+};
+
+
+
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+
+typedef CRITICAL_SECTION Mutex;
+typedef DWORD ThreadId;
+
+#define Mutex_Init(m)              InitializeCriticalSection(m)
+#define Mutex_Init_Recursive(m)    InitializeCriticalSection(m)
+#define Mutex_Lock(m)              EnterCriticalSection(m)
+#define Mutex_Unlock(m)            LeaveCriticalSection(m)
+#define Thread_Self()              GetCurrentThreadId()
+#define Thread_Equal(t1, t2)       ((t1) == (t2))
+
+#elif defined(HAVE_PTHREAD_H)
+
+typedef pthread_mutex_t Mutex;
+typedef pthread_t ThreadId;
+
+#define Mutex_Init(m)              pthread_mutex_init(m, NULL)
+#define Mutex_Init_Recursive(m)    Pthread_Mutex_Init_Recursive(m)
+#define Mutex_Lock(m)              pthread_mutex_lock(m)
+#define Mutex_Unlock(m)            pthread_mutex_unlock(m)
+#define Thread_Self()              pthread_self()
+#define Thread_Equal(t1, t2)       pthread_equal(t1, t2)
+
+#else
+
+typedef int Mutex;
+typedef int ThreadId;
+
+#define Mutex_Init(m)
+#define Mutex_Init_Recursive(m)
+#define Mutex_Lock(m)
+#define Mutex_Unlock(m)
+#define Thread_Self()              0
+#define Thread_Equal(t1, t2)       1
+
+#endif
+
+
+struct pl_lock			/* see PlLock in engine.h */
+{
+  Mutex mutex;
+};
+
+
+#ifdef PARALLEL_ENGINES		/* engines run in parallel */
+
+#define Run_Lock()
+#define Run_Unlock()
+
+#else				/* one engine runs at a time */
+
+#define Run_Lock()                 Mutex_Lock(&run_lock)
+#define Run_Unlock()               Mutex_Unlock(&run_lock)
+
+#endif
+
+
+	  /* context variables are thread-local with PARALLEL_ENGINES: their */
+	  /* offset from a thread-local variable is the same in all threads  */
+
+#define Ctx_Base                   ((char *) &cur_engine)
+#define Ctx_Adr(i)                 (Ctx_Base + ctx_tbl[i].offset)
+
+
+
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
 void (*pl_init_stream_supp)();  /* overwritten by foreign if present */
 
-#if !defined(NO_USE_REGS) && NB_OF_USED_MACHINE_REGS > 0
-static WamWord init_buff_regs[NB_OF_USED_MACHINE_REGS];
-#endif
+				/* machine regs of the thread before it attaches an engine */
+static PL_THREAD_LOCAL WamWord thread_buff_regs[NB_OF_USED_MACHINE_REGS + 1];
 
 
-static WamWord *heap_actual_start;
+static PL_THREAD_LOCAL WamWord *heap_actual_start;
 
 static int nb_user_directives = 0;
 
-static sigjmp_buf *p_jumper;
-static WamWord *p_buff_save;
+static PL_THREAD_LOCAL sigjmp_buf *p_jumper;
+static PL_THREAD_LOCAL WamWord *p_buff_save;
+
+static PL_THREAD_LOCAL CodePtr cont_jmp; /* we use a global var to support DEC alpha */
+
+static struct pl_engine main_engine;
+static PlEngine engine_list;	/* all engines (main engine first) */
+static PL_THREAD_LOCAL PlEngine cur_engine; /* attached engine (NULL if none) */
+
+static Mutex list_lock;		/* protects engine_list and the attached flags */
+
+#ifndef PARALLEL_ENGINES
+static Mutex run_lock;		/* held by the thread running an engine */
+static Bool lock_held;		/* run lock held (by lock_owner) ? */
+static ThreadId lock_owner;
+#endif
+
+static InfStack init_stk_tbl[NB_OF_STACKS]; /* initial sizes (for new engines) */
+
+static EngineCtxInf ctx_tbl[MAX_ENGINE_CONTEXT];
+static int nb_ctx = 0;
+static int ctx_size = 0;
+static char *init_context;	/* initial values of context variables */
+
+static EngineInitFct tbl_init_fct[MAX_ENGINE_INIT_FCT];
+static int nb_init_fct = 0;
 
-static CodePtr cont_jmp;        /* we use a global var to support DEC alpha */
+static EngineBuffInf buff_tbl[MAX_ENGINE_BUFFER];
+static int nb_buff = 0;
 
 
 
@@ -109,6 +246,22 @@ static void Call_Prolog_Success(void);
 
 static int Call_Next(CodePtr codep);
 
+static void Engine_Save(PlEngine engine);
+
+static void Engine_Restore(PlEngine engine);
+
+static Bool Has_Engine(void);
+
+static Bool Engine_Take(PlEngine engine);
+
+static void Engine_Release(PlEngine engine);
+
+#if !defined(_WIN32) && defined(HAVE_PTHREAD_H)
+
+static void Pthread_Mutex_Init_Recursive(pthread_mutex_t *m);
+
+#endif
+
 void Pl_Call_Compiled(CodePtr codep);   /* defined in engine1.c */
 
 
@@ -167,6 +320,27 @@ Pl_Start_Prolog(int argc, char *argv[])
         }      
     }
 
+  /* stacks can grow on demand up to max_stack_size (unless fixed sizes) */
+
+  x = (pl_fixed_sizes) ? 0 : DEFAULT_MAX_STACK_SIZE;
+  if (!pl_fixed_sizes)
+    {
+      p = (char *) getenv(ENV_VAR_MAX_STACK_SIZE);
+      if (p && *p)
+	x = strtol(p, &p, 0);
+#if defined(_WIN32) || defined(__CYGWIN__)
+      if (Read_Windows_Registry(ENV_VAR_MAX_STACK_SIZE, REG_DWORD, &y, sizeof(x)))
+	x = y;
+#endif
+    }
+
+  for (i = 0; i < NB_OF_STACKS; i++)
+    {
+      pl_stk_tbl[i].max_size = KBytes_To_Wam_Words(x);
+      if (pl_stk_tbl[i].max_size < pl_stk_tbl[i].size || pl_stk_tbl[i].size == 0)
+	pl_stk_tbl[i].max_size = pl_stk_tbl[i].size;
+    }
+
   /* similar treatment for max_atom */
 
   if ((pl_max_atom = pl_def_max_atom) == 0)
@@ -187,17 +361,42 @@ Pl_Start_Prolog(int argc, char *argv[])
     }
 
   Pl_Allocate_Stacks();
-  Save_Machine_Regs(init_buff_regs);
+  Save_Machine_Regs(thread_buff_regs);
+
+  memcpy(init_stk_tbl, pl_stk_tbl, sizeof(init_stk_tbl));
+
+  Mutex_Init_Recursive(&list_lock); /* see Pl_Engine_Exclusive_Begin */
+#ifndef PARALLEL_ENGINES
+  Mutex_Init(&run_lock);	/* the main engine is attached to this thread */
+  Mutex_Lock(&run_lock);
+  lock_owner = Thread_Self();
+  lock_held = TRUE;
+#endif
+  main_engine.attached = TRUE;
+  cur_engine = engine_list = &main_engine;
 
 #ifndef NO_MACHINE_REG_FOR_REG_BANK
   Init_Reg_Bank(Global_Stack);  /* allocated X regs + other non alloc regs */
   Global_Stack += REG_BANK_SIZE; /* at the beginning of the heap */
   Global_Size -= REG_BANK_SIZE;
+  Global_Max_Size -= REG_BANK_SIZE;
 #endif
 
   /* must be changed to store global info (see the debugger) */
   heap_actual_start = Global_Stack;
 
+  Pl_Engine_Add_Context(&heap_actual_start, sizeof(heap_actual_start));
+  Pl_Engine_Add_Context(&p_jumper, sizeof(p_jumper));
+  Pl_Engine_Add_Context(&p_buff_save, sizeof(p_buff_save));
+  Pl_Engine_Add_Context(&pl_call_prolog_depth, sizeof(pl_call_prolog_depth));
+  Pl_Engine_Add_Context(&pl_gc_trigger, sizeof(pl_gc_trigger));
+  Pl_Engine_Add_Context(&pl_gc_lock, sizeof(pl_gc_lock));
+  Pl_Engine_Add_Context(&pl_gc_nb_collections, sizeof(pl_gc_nb_collections));
+  Pl_Engine_Add_Context(&pl_gc_reclaimed, sizeof(pl_gc_reclaimed));
+  Pl_Engine_Add_Context(&pl_gc_time, sizeof(pl_gc_time));
+
+  Pl_Engine_Add_Buffer(&pl_glob_buff, GLOB_BUFF_SIZE);
+
   pl_le_mode = 0;	/* not compiled with linedit or deactivated (using env var) */
 
 #ifndef NO_USE_LINEDIT
@@ -234,7 +433,16 @@ Pl_Stop_Prolog(void)
   double d = (double) chain_len / (double) nb_deref;
   fprintf(stderr, "Deref: nb: %" PL_FMT_d "  avg len = %g\n", nb_deref, d);
 #endif
-  Restore_Machine_Regs(init_buff_regs);
+  if (Has_Engine())
+    {
+      Engine_Release(cur_engine);
+      cur_engine = NULL;
+#ifndef PARALLEL_ENGINES
+      lock_held = FALSE;
+#endif
+      Restore_Machine_Regs(thread_buff_regs);
+      Run_Unlock();
+    }
 }
 
 
@@ -255,6 +463,7 @@ Pl_Reset_Prolog(void)
   STAMP = 0;
   CS = Cstr_Stack;
   BCI = 0;                      /* BCI only needed for byte-code (cf. bips prolog) */
+  Pl_GC_Reset_Trigger();
 
   Pl_Create_Choice_Point(Call_Prolog_Fail, 0);  /* 1st choice point */
 
@@ -291,6 +500,584 @@ Pl_Set_Heap_Actual_Start(WamWord *new_heap_actual_start)
 
 
 
+/*-------------------------------------------------------------------------*
+ * PL_GET_HEAP_ACTUAL_START                                                *
+ *                                                                         *
+ * Start of the heap part which can be garbage collected.                  *
+ *-------------------------------------------------------------------------*/
+WamWord *
+Pl_Get_Heap_Actual_Start(void)
+{
+  return heap_actual_start;
+}
+
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * Engines                                                                 *
+ *                                                                         *
+ * An engine is a set of WAM stacks, registers and private C variables     *
+ * (registered with Pl_Engine_Add_Context) on which queries can be run.    *
+ * Atoms, predicates, the dynamic database, flags and streams are shared   *
+ * by all engines. The builtin state is private to each engine: global     *
+ * variables (g_vars), current input/output streams, tables, pollers,      *
+ * source readers, FD solver state and work buffers (see                   *
+ * Pl_Engine_Add_Buffer). The main engine is created by Pl_Start_Prolog.   *
+ * Any thread can attach an engine (Pl_Engine_Attach), run queries on it   *
+ * with the Pl_Query_XXX API and then detach it (Pl_Engine_Detach). An     *
+ * engine is attached to at most one thread.                               *
+ * With PARALLEL_ENGINES the WAM registers, the stack table and the        *
+ * context variables are thread-local and the shared tables (atoms,        *
+ * operators, predicates, dynamic database, streams) are protected by      *
+ * locks (see Pl_Lock_Create): engines attached to different threads run   *
+ * in parallel. Otherwise a global lock (run_lock) ensures only one engine *
+ * is executed at a time. The context switch only copies the registers,    *
+ * the stack table and the context variables (the stacks and the buffers   *
+ * never move). The collections of shared data referenced by the stacks    *
+ * (atom GC, erased clauses, unused JIT indexes) are deferred while other  *
+ * engines are attached (see Pl_Engine_Exclusive_Begin).                   *
+ *-------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_ADD_CONTEXT                                                   *
+ *                                                                         *
+ * Register a C global variable whose value is private to each engine. Its *
+ * current value is used as initial value for new engines. Must be called  *
+ * at initialization (before any engine is created). The variable must be  *
+ * declared PL_THREAD_LOCAL (it is then found in the thread running the    *
+ * engine by its offset from a thread-local variable of this file).        *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Engine_Add_Context(void *adr, int size)
+{
+  if (nb_ctx >= MAX_ENGINE_CONTEXT)
+    Pl_Fatal_Error("too many engine context variables (max: %d)", MAX_ENGINE_CONTEXT);
+
+  ctx_tbl[nb_ctx].offset = (char *) adr - Ctx_Base;
+  ctx_tbl[nb_ctx].size = size;
+  nb_ctx++;
+
+  init_context = (char *) Realloc(init_context, ctx_size + size);
+  memcpy(init_context + ctx_size, adr, size);
+  ctx_size += size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_ADD_INIT_FCT                                                  *
+ *                                                                         *
+ * Register a function called when a new engine is created (it is then     *
+ * the current engine) e.g. to reserve permanent space in its heap (H).    *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Engine_Add_Init_Fct(EngineInitFct fct)
+{
+  if (nb_init_fct >= MAX_ENGINE_INIT_FCT)
+    Pl_Fatal_Error("too many engine init functions (max: %d)", MAX_ENGINE_INIT_FCT);
+
+  tbl_init_fct[nb_init_fct++] = fct;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_ADD_BUFFER                                                    *
+ *                                                                         *
+ * Register a C global variable pointing to a buffer private to each       *
+ * engine (e.g. a big work array). A buffer of size bytes is allocated for *
+ * the current (main) engine and for each new engine (freed by             *
+ * Pl_Engine_Destroy). The variable is a context variable (it must be      *
+ * declared PL_THREAD_LOCAL, see Pl_Engine_Add_Context).                   *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Engine_Add_Buffer(void *adr, int size)
+{
+  if (nb_buff >= MAX_ENGINE_BUFFER)
+    Pl_Fatal_Error("too many engine buffers (max: %d)", MAX_ENGINE_BUFFER);
+
+  buff_tbl[nb_buff].ctx_no = nb_ctx;
+  buff_tbl[nb_buff].ctx_pos = ctx_size;
+  buff_tbl[nb_buff].size = size;
+  nb_buff++;
+
+  *(void **) adr = Malloc(size);
+  Pl_Engine_Add_Context(adr, sizeof(void *));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ENGINE_SAVE                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Engine_Save(PlEngine engine)
+{
+  char *p;
+  int i;
+
+  Save_Machine_Regs(engine->buff_regs);
+#ifdef NO_MACHINE_REG_FOR_REG_BANK
+  memcpy(engine->reg_bank, pl_reg_bank, sizeof(engine->reg_bank));
+#else
+  engine->reg_bank = pl_reg_bank;
+#endif
+  memcpy(engine->stk_tbl, pl_stk_tbl, sizeof(engine->stk_tbl));
+
+  if (engine->context == NULL)
+    engine->context = (char *) Malloc(ctx_size + 1);
+
+  for (i = 0, p = engine->context; i < nb_ctx; p += ctx_tbl[i++].size)
+    memcpy(p, Ctx_Adr(i), ctx_tbl[i].size);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ENGINE_RESTORE                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Engine_Restore(PlEngine engine)
+{
+  char *p;
+  int i;
+
+  memcpy(pl_stk_tbl, engine->stk_tbl, sizeof(engine->stk_tbl));
+
+  for (i = 0, p = engine->context; i < nb_ctx; p += ctx_tbl[i++].size)
+    memcpy(Ctx_Adr(i), p, ctx_tbl[i].size);
+
+  Restore_Machine_Regs(engine->buff_regs);
+#ifdef NO_MACHINE_REG_FOR_REG_BANK
+  memcpy(pl_reg_bank, engine->reg_bank, sizeof(engine->reg_bank));
+#else
+  Init_Reg_Bank(engine->reg_bank);
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * HAS_ENGINE                                                              *
+ *                                                                         *
+ * Has the calling thread an attached engine ?                             *
+ *-------------------------------------------------------------------------*/
+static Bool
+Has_Engine(void)
+{
+#ifdef PARALLEL_ENGINES
+  return cur_engine != NULL;	/* thread-local */
+#else
+  return lock_held && Thread_Equal(lock_owner, Thread_Self());
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ENGINE_TAKE                                                             *
+ *                                                                         *
+ * Mark engine as attached. Fails if it is attached to another thread.     *
+ *-------------------------------------------------------------------------*/
+static Bool
+Engine_Take(PlEngine engine)
+{
+  Bool ok;
+
+  Mutex_Lock(&list_lock);
+  ok = !engine->attached;
+  engine->attached = TRUE;
+  Mutex_Unlock(&list_lock);
+
+  return ok;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ENGINE_RELEASE                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Engine_Release(PlEngine engine)
+{
+  Mutex_Lock(&list_lock);
+  engine->attached = FALSE;
+  Mutex_Unlock(&list_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_CREATE                                                        *
+ *                                                                         *
+ * Create a new engine (with stacks of the initial sizes). The engine of   *
+ * the calling thread (if any) remains attached. Returns NULL if the       *
+ * stacks cannot be allocated.                                             *
+ *-------------------------------------------------------------------------*/
+PlEngine
+Pl_Engine_Create(void)
+{
+  Bool owned = Has_Engine();
+  WamWord buff_regs[NB_OF_USED_MACHINE_REGS + 1];  /* +1 if = 0 */
+  PlEngine engine, last;
+  char *p;
+  int i;
+
+  if (!owned)
+    {
+      Run_Lock();
+      Save_Machine_Regs(buff_regs);
+    }
+  else
+    Engine_Save(cur_engine);
+
+  engine = (PlEngine) Calloc(1, sizeof(struct pl_engine));
+  memcpy(engine->stk_tbl, init_stk_tbl, sizeof(init_stk_tbl));
+  engine->stacks_base = Pl_Allocate_Engine_Stacks(engine->stk_tbl, &engine->stacks_length);
+
+  if (engine->stacks_base == NULL)
+    {
+      Free(engine);
+      engine = NULL;
+      goto end;
+    }
+
+  memcpy(pl_stk_tbl, engine->stk_tbl, sizeof(engine->stk_tbl));
+
+#ifndef NO_MACHINE_REG_FOR_REG_BANK
+  Init_Reg_Bank(Global_Stack);  /* as in Pl_Start_Prolog */
+  Global_Stack += REG_BANK_SIZE;
+  Global_Size -= REG_BANK_SIZE;
+  Global_Max_Size -= REG_BANK_SIZE;
+#endif
+
+  for (i = 0, p = init_context; i < nb_ctx; p += ctx_tbl[i++].size)
+    memcpy(Ctx_Adr(i), p, ctx_tbl[i].size);	/* initial values */
+
+  for (i = 0; i < nb_buff; i++)
+    *(void **) Ctx_Adr(buff_tbl[i].ctx_no) = Malloc(buff_tbl[i].size);
+
+  H = heap_actual_start = Global_Stack;
+  for (i = 0; i < nb_init_fct; i++)
+    (*tbl_init_fct[i]) ();
+
+  Pl_Reset_Prolog();
+  Engine_Save(engine);
+
+  Mutex_Lock(&list_lock);
+  for (last = engine_list; last->next; last = last->next)
+    ;
+  last->next = engine;
+  Mutex_Unlock(&list_lock);
+
+ end:
+  if (!owned)
+    {
+      Restore_Machine_Regs(buff_regs);
+      Run_Unlock();
+    }
+  else
+    Engine_Restore(cur_engine);
+
+  return engine;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_ATTACH                                                        *
+ *                                                                         *
+ * Make engine the current engine of the calling thread (without           *
+ * PARALLEL_ENGINES waiting for other threads to detach their engine). A   *
+ * thread which has already an engine can switch to another one if it is   *
+ * not executing Prolog code. Fails if engine is attached to another       *
+ * thread.                                                                 *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Engine_Attach(PlEngine engine)
+{
+  if (engine == NULL)
+    return FALSE;
+
+  if (Has_Engine())
+    {
+      if (engine == cur_engine)
+	return TRUE;
+
+      if (pl_call_prolog_depth > 0 || !Engine_Take(engine))
+	return FALSE;
+
+      Engine_Save(cur_engine);
+      Engine_Release(cur_engine);
+    }
+  else
+    {
+      Run_Lock();
+      if (!Engine_Take(engine))
+	{
+	  Run_Unlock();
+	  return FALSE;
+	}
+      Save_Machine_Regs(thread_buff_regs); /* restored by Pl_Engine_Detach */
+#ifndef PARALLEL_ENGINES
+      lock_owner = Thread_Self();
+      lock_held = TRUE;
+#endif
+    }
+
+  Engine_Restore(engine);
+  cur_engine = engine;
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_DETACH                                                        *
+ *                                                                         *
+ * Detach the engine of the calling thread, allowing other threads to      *
+ * attach an engine. Fails if the engine is executing Prolog code.         *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Engine_Detach(void)
+{
+  if (!Has_Engine() || pl_call_prolog_depth > 0)
+    return FALSE;
+
+  Engine_Save(cur_engine);
+  Engine_Release(cur_engine);
+  cur_engine = NULL;
+#ifndef PARALLEL_ENGINES
+  lock_held = FALSE;
+#endif
+  Restore_Machine_Regs(thread_buff_regs);
+  Run_Unlock();
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_DESTROY                                                       *
+ *                                                                         *
+ * Free an engine (and its stacks). The main engine and the attached       *
+ * engines cannot be destroyed.                                            *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Engine_Destroy(PlEngine engine)
+{
+  PlEngine *p;
+  Bool ret = FALSE;
+  int i;
+
+  Mutex_Lock(&list_lock);
+  if (engine != &main_engine)
+    for (p = &engine_list; *p; p = &(*p)->next)
+      if (*p == engine)
+	{
+	  if (!engine->attached)
+	    {
+	      *p = engine->next;
+	      ret = TRUE;
+	    }
+	  break;
+	}
+  Mutex_Unlock(&list_lock);
+
+  if (ret)
+    {
+      Pl_Free_Engine_Stacks(engine->stacks_base, engine->stacks_length);
+      for (i = 0; i < nb_buff; i++)
+	Free(*(void **) (engine->context + buff_tbl[i].ctx_pos));
+      Free(engine->context);
+      Free(engine);
+    }
+
+  return ret;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_CURRENT                                                       *
+ *                                                                         *
+ * Returns the engine of the calling thread (or NULL).                     *
+ *-------------------------------------------------------------------------*/
+PlEngine
+Pl_Engine_Current(void)
+{
+  return (Has_Engine()) ? cur_engine : NULL;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_MAP_DETACHED                                                  *
+ *                                                                         *
+ * Call fct(arg) on each detached engine (it is temporarily made current). *
+ * Used to take into account the stacks of all engines (e.g. choice points *
+ * referencing dynamic clauses, atoms referenced by the stacks). Must be   *
+ * called inside Pl_Engine_Exclusive_Begin/End (no other engine running).  *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Engine_Map_Detached(void (*fct)(void *), void *arg)
+{
+  PlEngine engine;
+
+  if (engine_list == NULL || engine_list->next == NULL) /* only the main engine */
+    return;
+
+  Mutex_Lock(&list_lock);	/* the detached engines cannot be attached */
+  Engine_Save(cur_engine);
+  for (engine = engine_list; engine; engine = engine->next)
+    if (!engine->attached)
+      {
+	Engine_Restore(engine);
+	(*fct) (arg);
+      }
+
+  Engine_Restore(cur_engine);
+  Mutex_Unlock(&list_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_EXCLUSIVE_BEGIN                                               *
+ *                                                                         *
+ * Try to become the only running engine, e.g. to collect shared data      *
+ * referenced by the stacks of all engines. Fails if another engine is     *
+ * attached (the work should then be deferred). On success no engine can   *
+ * be attached until Pl_Engine_Exclusive_End.                              *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Engine_Exclusive_Begin(void)
+{
+  PlEngine engine;
+
+  Mutex_Lock(&list_lock);
+  for (engine = engine_list; engine; engine = engine->next)
+    if (engine->attached && engine != cur_engine)
+      {
+	Mutex_Unlock(&list_lock);
+	return FALSE;
+      }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ENGINE_EXCLUSIVE_END                                                 *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Engine_Exclusive_End(void)
+{
+  Mutex_Unlock(&list_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOCK_CREATE                                                          *
+ *                                                                         *
+ * Create a (recursive) lock protecting data shared by the engines (e.g.   *
+ * the atom table). Without PARALLEL_ENGINES a single engine runs at a     *
+ * time: no lock is needed and NULL is returned.                           *
+ *-------------------------------------------------------------------------*/
+PlLock
+Pl_Lock_Create(void)
+{
+#ifdef PARALLEL_ENGINES
+  PlLock lock = (PlLock) Malloc(sizeof(struct pl_lock));
+
+  Mutex_Init_Recursive(&lock->mutex);
+  return lock;
+#else
+  return NULL;
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOCK_ACQUIRE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Lock_Acquire(PlLock lock)
+{
+#ifdef PARALLEL_ENGINES
+  Mutex_Lock(&lock->mutex);
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_LOCK_RELEASE                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Lock_Release(PlLock lock)
+{
+#ifdef PARALLEL_ENGINES
+  Mutex_Unlock(&lock->mutex);
+#endif
+}
+
+
+
+
+#if !defined(_WIN32) && defined(HAVE_PTHREAD_H)
+
+/*-------------------------------------------------------------------------*
+ * PTHREAD_MUTEX_INIT_RECURSIVE                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Pthread_Mutex_Init_Recursive(pthread_mutex_t *m)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(m, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+#endif
+
+
+
+
 /*-------------------------------------------------------------------------*
  * PL_EXECUTE_DIRECTIVE                                                    *
  *                                                                         *
@@ -456,6 +1243,7 @@ Call_Next(CodePtr codep)
 
   p_jumper = &new_jumper;
   p_buff_save = buff_save_machine_regs;
+  pl_call_prolog_depth++;
 
 #if 0
   Save_All_Regs(buff_save_all_regs);
@@ -475,6 +1263,7 @@ Call_Next(CodePtr codep)
                                 /* normal return */
   p_jumper = old_jumper;
   p_buff_save = old_buff_save;
+  pl_call_prolog_depth--;
 
   if (jmp_val < 0)              /* false: restore WAM registers */
     {
@@ -61,6 +61,12 @@
  * Type Definitions                *
  *---------------------------------*/
 
+typedef struct pl_engine *PlEngine;	/* an engine (see engine.c) */
+
+typedef void (*EngineInitFct)(void);
+
+typedef struct pl_lock *PlLock;	/* a recursive lock (see engine.c) */
+
 
 
 /*---------------------------------*
@@ -75,13 +81,15 @@ char **pl_os_argv;
 char *pl_home;
 int pl_devel_mode;
 
-char pl_glob_buff[1024 * 1024];
+PL_THREAD_LOCAL char *pl_glob_buff; /* 1 MB, private to each engine */
 
 PlLong *pl_base_fl;		/* overwritten by foreign if present */
 double *pl_base_fd;		/* overwritten by foreign if present */
 
 int pl_le_mode;			/* LE_MODE_HOOK if GUI */
 
+PL_THREAD_LOCAL int pl_call_prolog_depth; /* nb of nested Call_Prolog */
+
 #else
 
 extern int pl_os_argc;
@@ -90,13 +98,15 @@ extern char **pl_os_argv;
 extern char *pl_home;
 extern int pl_devel_mode;
 
-extern char pl_glob_buff[];
+extern PL_THREAD_LOCAL char *pl_glob_buff;
 
 extern PlLong *pl_base_fl;
 extern double *pl_base_fd;
 
 extern int pl_le_mode;
 
+extern PL_THREAD_LOCAL int pl_call_prolog_depth;
+
 #endif
 
 
@@ -115,6 +125,37 @@ void Pl_Reset_Prolog_In_Signal(void);
 
 void Pl_Set_Heap_Actual_Start(WamWord *heap_actual_start);
 
+WamWord *Pl_Get_Heap_Actual_Start(void);
+
+
+PlEngine Pl_Engine_Create(void);
+
+Bool Pl_Engine_Attach(PlEngine engine);
+
+Bool Pl_Engine_Detach(void);
+
+Bool Pl_Engine_Destroy(PlEngine engine);
+
+PlEngine Pl_Engine_Current(void);
+
+void Pl_Engine_Add_Context(void *adr, int size);
+
+void Pl_Engine_Add_Init_Fct(EngineInitFct fct);
+
+void Pl_Engine_Add_Buffer(void *adr, int size);
+
+void Pl_Engine_Map_Detached(void (*fct)(void *), void *arg);
+
+Bool Pl_Engine_Exclusive_Begin(void);
+
+void Pl_Engine_Exclusive_End(void);
+
+PlLock Pl_Lock_Create(void);
+
+void Pl_Lock_Acquire(PlLock lock);
+
+void Pl_Lock_Release(PlLock lock);
+
 
 
 void Pl_Execute_Directive(int pl_file, int pl_line, Bool is_system, CodePtr proc);
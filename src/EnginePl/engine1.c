@@ -44,7 +44,7 @@
 #define UN
 #endif
 
-WamWord *pl_ensure_reserved;
+PL_THREAD_LOCAL WamWord *pl_ensure_reserved;
 
 #if !(defined(M_x86_64) && defined(_MSC_VER))/* see file eng1-x86_64_win.s */
 
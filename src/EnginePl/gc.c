@@ -0,0 +1,1031 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : Prolog engine                                                   *
+ * File  : gc.c                                                            *
+ * Descr.: global stack and atom garbage collector                         *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GC_FILE
+
+#include "engine_pl.h"
+
+
+#if 0
+#define DEBUG
+#endif
+
+
+
+
+/*---------------------------------------------------------------------*
+ * The heap (global stack) is collected by a sliding mark-compact      *
+ * algorithm (Morris style, with a mark bitmap instead of pointer      *
+ * reversal). Only the part above the heap actual start is collected   *
+ * (below are the reg bank and global info of the debugger/foreign).   *
+ *                                                                     *
+ * Marking starts from:                                                *
+ *   - the live X registers (passed by Pl_Allocate),                   *
+ *   - the Y variables of all reachable environments (NBYE is set by   *
+ *     Pl_Allocate, see GARBAGE_COLLECTOR in wam_inst.h),              *
+ *   - the arguments of all choice points,                             *
+ *   - the trail: trailed heap words are kept (they will be reset on   *
+ *     backtracking) and TOV saved values are roots,                   *
+ *   - functions registered with Pl_GC_Add_Root_Fct (e.g. g_vars).     *
+ *                                                                     *
+ * Then all pointers to the heap are updated using the rank of their   *
+ * target in the mark bitmap and the marked words are slided down.     *
+ * Since the order of the words is preserved, the HB of each choice    *
+ * point can be updated the same way and the trail stays valid.        *
+ *                                                                     *
+ * After a collection the freed pages are given back to the system and *
+ * the heap is extended if it is still more than half full (see        *
+ * Pl_Grow_Stack in stacks_sigsegv.c).                                 *
+ *                                                                     *
+ * The collection is only done when it is safe:                        *
+ *   - not inside a nested Call_Prolog (C code may hold heap refs),    *
+ *   - not inside a foreign query (see pl_gc_lock),                    *
+ *   - when the constraint stack is empty (FD variables).              *
+ * Else it is postponed (see pl_gc_trigger).                           *
+ *                                                                     *
+ * The atom table is collected at the same safe points: when enough    *
+ * collectable atoms have been created (see Add_Atom in atom.c) an     *
+ * atom GC is requested and done at the end of the next heap GC.       *
+ * Marking is conservative: each word of the stacks (and of the        *
+ * areas given by the functions registered with                        *
+ * Pl_Atom_GC_Add_Root_Fct, e.g. dynamic clauses) which looks like an  *
+ * atom or a functor keeps the atom. The stacks and the roots          *
+ * registered with Pl_Atom_GC_Add_Engine_Root_Fct (e.g. g_vars) are    *
+ * scanned in each engine. The atom GC is postponed while another      *
+ * engine is attached (it could be running, see                        *
+ * Pl_Engine_Exclusive_Begin). Atoms which are operators, have an     *
+ * info or are pinned by C code (Pl_Pin_Atom) are not reclaimed.       *
+ *---------------------------------------------------------------------*/
+
+
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+#define MAX_ROOT_FCT               16
+
+#define BITS_PER_WORD              ((int) (sizeof(PlULong) * 8))
+
+#define FLOAT_NB_WORDS             ((int) ((sizeof(double) + sizeof(WamWord) - 1) / sizeof(WamWord)))
+
+#define MARK_STACK_INIT_SIZE       4096
+
+	  /* the trigger is placed at TRIGGER_NUM / TRIGGER_DEN of the free space */
+
+#define TRIGGER_NUM                3
+#define TRIGGER_DEN                4
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static GCRootFct tbl_root_fct[MAX_ROOT_FCT];
+static int nb_root_fct = 0;
+
+static AtomGCRootFct tbl_atom_root_fct[MAX_ROOT_FCT];
+static int nb_atom_root_fct = 0;
+
+static AtomGCRootFct tbl_engine_root_fct[MAX_ROOT_FCT];
+static int nb_engine_root_fct = 0;
+
+static Bool atom_gc_requested = FALSE;
+static PlULong *atom_mark_bit;	/* 1 bit per atom: referenced atom */
+
+				/* state of the heap GC: private to each thread */
+static PL_THREAD_LOCAL WamWord *heap_lo; /* collected area: [heap_lo, heap_hi[ */
+static PL_THREAD_LOCAL WamWord *heap_hi;
+
+static PL_THREAD_LOCAL PlULong *mark_bit;	/* 1 bit per heap word: live word */
+static PL_THREAD_LOCAL PlULong *raw_bit;	/* 1 bit per heap word: functor/float data */
+static PL_THREAD_LOCAL PlLong *rank_tbl;	/* nb of marked words before each block */
+static PL_THREAD_LOCAL PlULong *low_bit;	/* 1 bit per word below heap_lo: visited */
+static PL_THREAD_LOCAL PlULong *env_bit;	/* 1 bit per local stack word: visited env */
+
+static PL_THREAD_LOCAL WamWord **mark_stack;
+static PL_THREAD_LOCAL PlLong mark_stack_size;
+static PL_THREAD_LOCAL PlLong mark_stack_top;
+
+static PL_THREAD_LOCAL Bool updating;		/* FALSE: mark phase, TRUE: update phase */
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static Bool Can_Collect(void);
+
+static void Postpone(void);
+
+static void Scan_All_Roots(int nb_live_x, GCScanFct scan);
+
+static void Scan_Env_Chain(WamWord *e, GCScanFct scan);
+
+static void Scan_Trail(GCScanFct scan);
+
+static void Mark_Root(WamWord *adr);
+
+static void Mark_Cell(WamWord *adr);
+
+static void Mark_Word(WamWord word);
+
+static void Mark_Stack_Push(WamWord *adr);
+
+static void Compute_Rank_Table(void);
+
+static WamWord *Forward(WamWord *adr);
+
+static void Update_Root(WamWord *adr);
+
+static WamWord Relocate(WamWord word);
+
+static void Update_Heap(void);
+
+static void Compact_Heap(void);
+
+static void Atom_GC(int nb_live_x);
+
+static void Atom_GC_Mark_Engine(void *arg);
+
+static int Bit_Count(PlULong w);
+
+static int First_Bit(PlULong w);
+
+
+
+#define Bit_Test(tbl, i)           ((tbl)[(i) / BITS_PER_WORD] & ((PlULong) 1 << ((i) % BITS_PER_WORD)))
+
+#define Bit_Set(tbl, i)            ((tbl)[(i) / BITS_PER_WORD] |= ((PlULong) 1 << ((i) % BITS_PER_WORD)))
+
+#define Nb_Bit_Words(n)            (((n) + BITS_PER_WORD) / BITS_PER_WORD) /* +1 word for n */
+
+#define In_Heap(adr)               ((adr) >= heap_lo && (adr) < heap_hi)
+
+#define Heap_End                   (Global_Stack + Global_Size)
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GC_RESET_TRIGGER                                                     *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_GC_Reset_Trigger(void)
+{
+  pl_gc_trigger = H + (Heap_End - H) / TRIGGER_DEN * TRIGGER_NUM;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GC_ADD_ROOT_FCT                                                      *
+ *                                                                         *
+ * Register a function called to scan the heap refs kept by C code. It    *
+ * must call its argument on each location containing such a ref (each    *
+ * location once).                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_GC_Add_Root_Fct(GCRootFct fct)
+{
+  if (nb_root_fct >= MAX_ROOT_FCT)
+    Pl_Fatal_Error("too many GC root functions (max: %d)", MAX_ROOT_FCT);
+
+  tbl_root_fct[nb_root_fct++] = fct;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_ADD_ROOT_FCT                                                 *
+ *                                                                         *
+ * Register a function called to mark the atoms kept by C code. It must   *
+ * call Pl_Atom_GC_Mark or Pl_Atom_GC_Mark_Words on them.                  *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Add_Root_Fct(AtomGCRootFct fct)
+{
+  if (nb_atom_root_fct >= MAX_ROOT_FCT)
+    Pl_Fatal_Error("too many atom GC root functions (max: %d)", MAX_ROOT_FCT);
+
+  tbl_atom_root_fct[nb_atom_root_fct++] = fct;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_ADD_ENGINE_ROOT_FCT                                          *
+ *                                                                         *
+ * Same as Pl_Atom_GC_Add_Root_Fct for atoms kept in context variables     *
+ * (see Pl_Engine_Add_Context): fct is called once for each engine.        *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Add_Engine_Root_Fct(AtomGCRootFct fct)
+{
+  if (nb_engine_root_fct >= MAX_ROOT_FCT)
+    Pl_Fatal_Error("too many atom GC root functions (max: %d)", MAX_ROOT_FCT);
+
+  tbl_engine_root_fct[nb_engine_root_fct++] = fct;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_REQUEST                                                      *
+ *                                                                         *
+ * The atom GC is done at the end of the next heap GC (forced here).      *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Request(void)
+{
+  atom_gc_requested = TRUE;
+  pl_gc_trigger = Global_Stack;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_MARK                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Mark(int atom)
+{
+  if (atom >= 0 && (PlULong) atom < pl_max_atom)
+    Bit_Set(atom_mark_bit, atom);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ATOM_GC_MARK_WORDS                                                   *
+ *                                                                         *
+ * Conservatively mark the atoms of nb words (atoms and functors).         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Atom_GC_Mark_Words(WamWord *adr, PlLong nb)
+{
+  WamWord word;
+  int arity;
+
+  while (nb-- > 0)
+    {
+      word = *adr++;
+      if (Tag_Mask_Of(word) == TAG_ATM_MASK)
+	Pl_Atom_GC_Mark((int) UnTag_ATM(word));
+      else
+	{
+	  arity = Arity_Of(word);
+	  if (arity >= 1 && arity <= MAX_ARITY)
+	    Pl_Atom_GC_Mark(Functor_Of(word));
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GC_COLLECT                                                           *
+ *                                                                         *
+ * nb_live_x: number of X registers containing live terms.                 *
+ * Returns TRUE if the collection has been done.                           *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_GC_Collect(int nb_live_x)
+{
+  PlLong nb_words, nb_blocks;
+  PlLong start_time;
+  WamWord *old_H = H;
+  WamWord *b;
+
+  if (!Can_Collect())
+    {
+      Postpone();
+      return FALSE;
+    }
+
+  start_time = Pl_M_User_Time();
+
+  heap_lo = Pl_Get_Heap_Actual_Start();
+  heap_hi = H;
+  nb_words = heap_hi - heap_lo;
+  nb_blocks = Nb_Bit_Words(nb_words);
+
+  mark_bit = (PlULong *) Calloc(nb_blocks, sizeof(PlULong));
+  raw_bit = (PlULong *) Calloc(nb_blocks, sizeof(PlULong));
+  rank_tbl = (PlLong *) Malloc(nb_blocks * sizeof(PlLong));
+  low_bit = (PlULong *) Calloc(Nb_Bit_Words(heap_lo - Global_Stack), sizeof(PlULong));
+  env_bit = (PlULong *) Calloc(Nb_Bit_Words(Local_Top - Local_Stack), sizeof(PlULong));
+
+  mark_stack_size = MARK_STACK_INIT_SIZE;
+  mark_stack = (WamWord **) Malloc(mark_stack_size * sizeof(WamWord *));
+  mark_stack_top = 0;
+
+				/* mark phase */
+  updating = FALSE;
+  Scan_All_Roots(nb_live_x, Mark_Root);
+
+  while (mark_stack_top > 0)
+    Mark_Word(*mark_stack[--mark_stack_top]);
+
+				/* update phase */
+  Compute_Rank_Table();
+
+  memset(low_bit, 0, Nb_Bit_Words(heap_lo - Global_Stack) * sizeof(PlULong));
+  memset(env_bit, 0, Nb_Bit_Words(Local_Top - Local_Stack) * sizeof(PlULong));
+
+  updating = TRUE;
+  Scan_All_Roots(nb_live_x, Update_Root);
+
+  for (b = B; b > Local_Stack; b = BB(b))
+    if (HB(b) >= heap_lo && HB(b) <= heap_hi)
+      HB(b) = Forward(HB(b));
+
+  Update_Heap();
+				/* compact phase */
+  Compact_Heap();
+
+  H = Forward(heap_hi);
+  HB1 = HB(B);
+
+  Free(mark_stack);
+  Free(env_bit);
+  Free(low_bit);
+  Free(rank_tbl);
+  Free(raw_bit);
+  Free(mark_bit);
+
+  pl_gc_nb_collections++;
+  pl_gc_reclaimed += old_H - H;
+
+  if (atom_gc_requested)
+    Atom_GC(nb_live_x);
+
+  pl_gc_time += Pl_M_User_Time() - start_time;
+
+#ifdef DEBUG
+  fprintf(stderr, "GC #%" PL_FMT_d ": %" PL_FMT_d " -> %" PL_FMT_d " words\n",
+	    pl_gc_nb_collections, old_H - heap_lo, H - heap_lo);
+#endif
+
+  Pl_Release_Stack_Pages(H, old_H);
+
+  if (H - heap_lo > Global_Size / 2) /* mostly live data: grow the heap */
+    Pl_Grow_Stack(Global_Stack + Global_Size);
+
+  Pl_GC_Reset_Trigger();
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC                                                                 *
+ *                                                                         *
+ * Called at the end of a heap GC (the heap is compacted).                 *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC(int nb_live_x)
+{
+  HashScan scan;
+  PredInf *pred;
+  AtomInf *patom;
+  PlLong nb_deleted = 0;
+  int atom, i;
+
+  Pl_Lock_Acquire(pl_pred_lock);	/* lock order: predicates then atoms */
+  Pl_Lock_Acquire(pl_atom_lock);
+
+  if (!Pl_Engine_Exclusive_Begin())	/* other engines running: retry later */
+    {
+      Pl_Lock_Release(pl_atom_lock);
+      Pl_Lock_Release(pl_pred_lock);
+      return;
+    }
+
+  atom_mark_bit = (PlULong *) Calloc(Nb_Bit_Words(pl_max_atom), sizeof(PlULong));
+
+				/* mark phase */
+  Pl_Atom_GC_Mark_Words(&X(0), nb_live_x);
+  Atom_GC_Mark_Engine(NULL);
+  Pl_Engine_Map_Detached(Atom_GC_Mark_Engine, NULL);
+
+  for (pred = (PredInf *) Pl_Hash_First(pl_pred_tbl, &scan); pred;
+       pred = (PredInf *) Pl_Hash_Next(&scan))
+    {
+      Pl_Atom_GC_Mark(Functor_Of(pred->f_n));
+      Pl_Atom_GC_Mark(pred->pl_file);
+    }
+
+  for (i = 0; i < nb_atom_root_fct; i++)
+    (*tbl_atom_root_fct[i]) ();
+
+				/* sweep phase */
+  for (atom = 0; (PlULong) atom < pl_max_atom; atom++)
+    {
+      patom = pl_atom_tbl + atom;
+      if (patom->name && patom->prop.collectable && !Bit_Test(atom_mark_bit, atom) &&
+	  patom->prop.op_mask == 0 && patom->prop.pin_count == 0 &&
+	  patom->info == NULL)
+	{
+	  Pl_Delete_Atom(atom);
+	  nb_deleted++;
+	}
+    }
+
+  Free(atom_mark_bit);
+
+  pl_atom_gc_nb_collections++;
+  pl_atom_gc_reclaimed += nb_deleted;
+
+#ifdef DEBUG
+  fprintf(stderr, "Atom GC #%" PL_FMT_d ": %" PL_FMT_d " atoms reclaimed\n",
+	  pl_atom_gc_nb_collections, nb_deleted);
+#endif
+
+  Pl_Atom_GC_Done();
+  atom_gc_requested = FALSE;
+
+  Pl_Engine_Exclusive_End();
+  Pl_Lock_Release(pl_atom_lock);
+  Pl_Lock_Release(pl_pred_lock);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ATOM_GC_MARK_ENGINE                                                     *
+ *                                                                         *
+ * Mark the atoms referenced by the stacks and the context variables of    *
+ * the current engine (called for each engine).                            *
+ *-------------------------------------------------------------------------*/
+static void
+Atom_GC_Mark_Engine(void *arg)
+{
+  int i;
+
+  Pl_Atom_GC_Mark_Words(Global_Stack, H - Global_Stack);
+  Pl_Atom_GC_Mark_Words(Local_Stack, Local_Top - Local_Stack);
+  Pl_Atom_GC_Mark_Words(Trail_Stack, TR - Trail_Stack);
+
+  for (i = 0; i < nb_engine_root_fct; i++)
+    (*tbl_engine_root_fct[i]) ();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CAN_COLLECT                                                             *
+ *                                                                         *
+ * Check that the collection is safe. The trail must only reference words *
+ * of the global or local stack (FD uses other areas and multiple values). *
+ *-------------------------------------------------------------------------*/
+static Bool
+Can_Collect(void)
+{
+  WamWord *p, *adr;
+  WamWord word;
+
+  if (pl_gc_lock > 0 || pl_call_prolog_depth != 1 || CS != Cstr_Stack)
+    return FALSE;
+
+  for (p = TR; p > Trail_Stack;)
+    {
+      word = *--p;
+      adr = (WamWord *) Trail_Value_Of(word);
+
+      switch (Trail_Tag_Of(word))
+	{
+	case TUV:
+	  break;
+
+	case TOV:
+	  p--;
+	  break;
+
+	case TMV:
+	  return FALSE;
+
+	default:		/* TFC: fct, nb, args */
+	  p -= 2;
+	  p -= *p;
+	  continue;
+	}
+
+      if (!(adr >= Global_Stack && adr < Heap_End) &&
+	  !(adr >= Local_Stack && adr < Local_Stack + Local_Size))
+	return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * POSTPONE                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Postpone(void)
+{
+  pl_gc_trigger = H + (Heap_End - H) / 2;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_ALL_ROOTS                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_All_Roots(int nb_live_x, GCScanFct scan)
+{
+  WamWord *b, *top;
+  int i, n;
+
+  for (i = 0; i < nb_live_x; i++)
+    (*scan) (&X(i));
+
+  for (b = B; b > Local_Stack; b = BB(b))
+    {
+      top = (BB(b) >= EB(b)) ? BB(b) : EB(b);
+      n = (int) (b - top - CHOICE_STATIC_SIZE);
+      for (i = 0; i < n; i++)
+	(*scan) (&AB(b, i));
+
+      Scan_Env_Chain(EB(b), scan);
+    }
+
+  Scan_Env_Chain(E, scan);
+
+  Scan_Trail(scan);
+
+  for (i = 0; i < nb_root_fct; i++)
+    (*tbl_root_fct[i]) (scan);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_ENV_CHAIN                                                          *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Env_Chain(WamWord *e, GCScanFct scan)
+{
+  PlLong i, n;
+
+  while (e > Local_Stack && e <= Local_Top)
+    {
+      i = e - Local_Stack;
+      if (Bit_Test(env_bit, i))	/* the rest of the chain is done */
+	return;
+      Bit_Set(env_bit, i);
+
+      n = NBYE(e);
+      for (i = 0; i < n; i++)
+	(*scan) (&Y(e, i));
+
+      e = EE(e);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SCAN_TRAIL                                                              *
+ *                                                                         *
+ * Trailed heap words are marked (they are reset on backtracking) and the  *
+ * trail entry is updated. Trailed words below the heap (global info) are  *
+ * roots (they can only reference the heap if they have been trailed).    *
+ * Trailed local words are part of environments (or are dead).            *
+ *-------------------------------------------------------------------------*/
+static void
+Scan_Trail(GCScanFct scan)
+{
+  WamWord *p, *adr;
+  WamWord word;
+  int tag;
+
+  for (p = TR; p > Trail_Stack;)
+    {
+      word = *--p;
+      adr = (WamWord *) Trail_Value_Of(word);
+      tag = Trail_Tag_Of(word);
+
+      switch (tag)
+	{
+	case TUV:
+	  break;
+
+	case TOV:
+	  (*scan) (p - 1);	/* saved value */
+	  break;
+
+	default:		/* TFC (TMV never here, see Can_Collect) */
+	  p -= 2;
+	  p -= *p;
+	  continue;
+	}
+
+      if (In_Heap(adr))
+	{
+	  if (updating)
+	    *p = Trail_Tag_Value(tag, Forward(adr));
+	  else
+	    Mark_Cell(adr);
+	}
+      else if (adr >= Global_Stack && adr < heap_lo &&
+	       !Bit_Test(low_bit, adr - Global_Stack))
+	{
+	  Bit_Set(low_bit, adr - Global_Stack);
+	  (*scan) (adr);
+	}
+
+      if (tag == TOV)
+	p--;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MARK_ROOT                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Root(WamWord *adr)
+{
+  Mark_Word(*adr);
+
+  while (mark_stack_top > 0)
+    Mark_Word(*mark_stack[--mark_stack_top]);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MARK_CELL                                                               *
+ *                                                                         *
+ * Mark a heap word whose content is a tagged word (to scan later).        *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Cell(WamWord *adr)
+{
+  PlLong i;
+
+  if (!In_Heap(adr))
+    return;
+
+  i = adr - heap_lo;
+  if (Bit_Test(mark_bit, i))
+    return;
+
+  Bit_Set(mark_bit, i);
+  Mark_Stack_Push(adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MARK_WORD                                                               *
+ *                                                                         *
+ * Mark the heap words referenced by a tagged word. Since roots can come   *
+ * from choice points of C built-ins (which store raw data), a structure   *
+ * is only followed if it starts with a valid functor.                    *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Word(WamWord word)
+{
+  WamWord *adr;
+  WamWord f_n;
+  PlLong i;
+  int n;
+
+  switch (Tag_Mask_Of(word))
+    {
+    case TAG_REF_MASK:
+      Mark_Cell(UnTag_REF(word));
+      break;
+
+    case TAG_LST_MASK:
+      adr = UnTag_LST(word);
+      if (!In_Heap(adr) || !In_Heap(adr + OFFSET_CAR + 1))
+	break;
+      Mark_Cell(&Car(adr));
+      Mark_Cell(&Cdr(adr));
+      break;
+
+    case TAG_STC_MASK:
+      adr = UnTag_STC(word);
+      if (!In_Heap(adr))
+	break;
+      i = adr - heap_lo;
+      if (Bit_Test(raw_bit, i))	/* already done */
+	break;
+      f_n = Functor_And_Arity(adr);
+      n = Arity_Of(f_n);
+      if (n <= 0 || n > MAX_ARITY || !Is_Valid_Atom(Functor_Of(f_n)) ||
+	  !In_Heap(adr + OFFSET_ARG + n - 1))
+	break;
+      Bit_Set(mark_bit, i);
+      Bit_Set(raw_bit, i);
+      while (--n >= 0)
+	Mark_Cell(&Arg(adr, n));
+      break;
+
+    case TAG_FLT_MASK:
+      adr = UnTag_FLT(word);
+      if (!In_Heap(adr) || !In_Heap(adr + FLOAT_NB_WORDS - 1))
+	break;
+      for (n = 0; n < FLOAT_NB_WORDS; n++)
+	{
+	  i = adr + n - heap_lo;
+	  Bit_Set(mark_bit, i);
+	  Bit_Set(raw_bit, i);
+	}
+      break;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * MARK_STACK_PUSH                                                         *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Mark_Stack_Push(WamWord *adr)
+{
+  if (mark_stack_top >= mark_stack_size)
+    {
+      mark_stack_size *= 2;
+      mark_stack = (WamWord **) Realloc(mark_stack, mark_stack_size * sizeof(WamWord *));
+    }
+
+  mark_stack[mark_stack_top++] = adr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPUTE_RANK_TABLE                                                      *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Compute_Rank_Table(void)
+{
+  PlLong k, nb_blocks = Nb_Bit_Words(heap_hi - heap_lo);
+  PlLong rank = 0;
+
+  for (k = 0; k < nb_blocks; k++)
+    {
+      rank_tbl[k] = rank;
+      rank += Bit_Count(mark_bit[k]);
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FORWARD                                                                 *
+ *                                                                         *
+ * Return the new address of a heap word (or of the end of the heap).     *
+ * adr must be in [heap_lo, heap_hi].                                      *
+ *-------------------------------------------------------------------------*/
+static WamWord *
+Forward(WamWord *adr)
+{
+  PlLong i = adr - heap_lo;
+  PlLong k = i / BITS_PER_WORD;
+  int j = (int) (i % BITS_PER_WORD);
+
+  return heap_lo + rank_tbl[k] + Bit_Count(mark_bit[k] & (((PlULong) 1 << j) - 1));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UPDATE_ROOT                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Update_Root(WamWord *adr)
+{
+  *adr = Relocate(*adr);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELOCATE                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static WamWord
+Relocate(WamWord word)
+{
+  WamWord *adr;
+
+  switch (Tag_Mask_Of(word))
+    {
+    case TAG_REF_MASK:
+      adr = UnTag_REF(word);
+      if (adr >= heap_lo && adr <= heap_hi)
+	word = Tag_REF(Forward(adr));
+      break;
+
+    case TAG_LST_MASK:
+      adr = UnTag_LST(word);
+      if (adr >= heap_lo && adr <= heap_hi)
+	word = Tag_LST(Forward(adr));
+      break;
+
+    case TAG_STC_MASK:
+      adr = UnTag_STC(word);
+      if (adr >= heap_lo && adr <= heap_hi)
+	word = Tag_STC(Forward(adr));
+      break;
+
+    case TAG_FLT_MASK:
+      adr = UnTag_FLT(word);
+      if (adr >= heap_lo && adr <= heap_hi)
+	word = Tag_FLT(Forward(adr));
+      break;
+    }
+
+  return word;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * UPDATE_HEAP                                                             *
+ *                                                                         *
+ * Relocate the content of all marked words (except functors and floats). *
+ *-------------------------------------------------------------------------*/
+static void
+Update_Heap(void)
+{
+  PlLong k, nb_blocks = Nb_Bit_Words(heap_hi - heap_lo);
+  PlULong bits;
+  WamWord *adr;
+
+  for (k = 0; k < nb_blocks; k++)
+    {
+      bits = mark_bit[k] & ~raw_bit[k];
+      while (bits)
+	{
+	  adr = heap_lo + k * BITS_PER_WORD + First_Bit(bits);
+	  *adr = Relocate(*adr);
+	  bits &= bits - 1;
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPACT_HEAP                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Compact_Heap(void)
+{
+  PlLong k, nb_blocks = Nb_Bit_Words(heap_hi - heap_lo);
+  PlULong bits;
+  WamWord *dst = heap_lo;
+
+  for (k = 0; k < nb_blocks; k++)
+    {
+      bits = mark_bit[k];
+      while (bits)
+	{
+	  *dst++ = heap_lo[k * BITS_PER_WORD + First_Bit(bits)];
+	  bits &= bits - 1;
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BIT_COUNT                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Bit_Count(PlULong w)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll((unsigned long long) w);
+#else
+  int n = 0;
+
+  while (w)
+    {
+      w &= w - 1;
+      n++;
+    }
+  return n;
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FIRST_BIT                                                               *
+ *                                                                         *
+ * Index of the least significant bit set (w != 0).                        *
+ *-------------------------------------------------------------------------*/
+static int
+First_Bit(PlULong w)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll((unsigned long long) w);
+#else
+  int n = 0;
+
+  while ((w & 1) == 0)
+    {
+      w >>= 1;
+      n++;
+    }
+  return n;
+#endif
+}
@@ -1,9 +1,9 @@
 /*-------------------------------------------------------------------------*
  * GNU Prolog                                                              *
  *                                                                         *
- * Part  : Prolog buit-in predicates                                       *
- * File  : consult_c.c                                                     *
- * Descr.: file consulting - C part                                        *
+ * Part  : Prolog engine                                                   *
+ * File  : gc.h                                                            *
+ * Descr.: global stack and atom garbage collector - header file           *
  * Author: Daniel Diaz                                                     *
  *                                                                         *
  * Copyright (C) 1999-2025 Daniel Diaz                                     *
@@ -36,12 +36,8 @@
  *-------------------------------------------------------------------------*/
 
 
-#include <errno.h>
-#include <sys/types.h>
-
-#include "engine_pl.h"
-#include "bips_pl.h"
-#include "linedit.h"
+#ifndef _GC_H
+#define _GC_H
 
 /*---------------------------------*
  * Constants                       *
@@ -51,124 +47,72 @@
  * Type Definitions                *
  *---------------------------------*/
 
+typedef void (*GCScanFct)(WamWord *adr);
+
+typedef void (*GCRootFct)(GCScanFct scan);
+
+typedef void (*AtomGCRootFct)(void);
+
 /*---------------------------------*
  * Global Variables                *
  *---------------------------------*/
 
+#ifdef GC_FILE
+
+PL_THREAD_LOCAL WamWord *pl_gc_trigger; /* Pl_Allocate collects when H is above */
+PL_THREAD_LOCAL int pl_gc_lock;	/* > 0: C code holds refs to the heap */
+
+PL_THREAD_LOCAL PlLong pl_gc_nb_collections; /* heap GC: per engine */
+PL_THREAD_LOCAL PlLong pl_gc_reclaimed;	/* in WamWords */
+PL_THREAD_LOCAL PlLong pl_gc_time;	/* in ms */
+
+PlLong pl_atom_gc_nb_collections;
+PlLong pl_atom_gc_reclaimed;	/* in atoms */
+
+#else
+
+extern PL_THREAD_LOCAL WamWord *pl_gc_trigger;
+extern PL_THREAD_LOCAL int pl_gc_lock;
+
+extern PL_THREAD_LOCAL PlLong pl_gc_nb_collections;
+extern PL_THREAD_LOCAL PlLong pl_gc_reclaimed;
+extern PL_THREAD_LOCAL PlLong pl_gc_time;
+
+extern PlLong pl_atom_gc_nb_collections;
+extern PlLong pl_atom_gc_reclaimed;
+
+#endif
+
 /*---------------------------------*
  * Function Prototypes             *
  *---------------------------------*/
 
-#if 1
+void Pl_GC_Reset_Trigger(void);
 
-/*-------------------------------------------------------------------------*
- * PL_CONSULT_3                                                            *
- *                                                                         *
- *-------------------------------------------------------------------------*/
-Bool
-Pl_Consult_1(WamWord pl2wam_args_word)
-{
-  StmInf *pstm_o = pl_stm_tbl[pl_stm_top_level_output];
-  StmInf *pstm_i = pl_stm_tbl[pl_stm_top_level_input];
-  int pid;
-  FILE *f_in = M_SPAWN_REDIRECT_CREATE;
-  FILE *f_out = M_SPAWN_REDIRECT_CREATE;
-  FILE **pf_in;
-  unsigned char *p = NULL;
-  int status, c;
-  int save_use_le_prompt;
-  char *arg[2 + Pl_List_Length(pl2wam_args_word)];
-  WamWord word, tag_mask;
-  WamWord *lst_adr;
-  int n = 0;
-
-  arg[n++] = "pl2wam";
-
-  for (;;)
-    {
-      DEREF(pl2wam_args_word, word, tag_mask);
-      if (word == NIL_WORD)
-        break;
-
-      lst_adr = UnTag_LST(word);
-
-      arg[n++] = Pl_Rd_String(Car(lst_adr));
-      pl2wam_args_word = Cdr(lst_adr);
-    }
-  arg[n] = NULL;
-
-#ifndef NO_USE_PIPED_STDIN_FOR_CONSULT
-  pf_in = &f_in;
-#else
-  f_in = NULL;
-  pf_in = NULL;
-#endif
+void Pl_GC_Add_Root_Fct(GCRootFct fct);
 
-  Pl_Flush_All_Streams();
-  pid = Pl_M_Spawn_Redirect(arg, 0, pf_in, &f_out, &f_out);
-
-  /* If pl2wam is not found we get ENOENT under Windows. 
-   * Under Unix the information is only obtained at Pl_M_Get_Status(). */
-
-  if (pid == -1 && errno != ENOENT)
-    Os_Test_Error(pid); /* ENOENT is for Windows */
-  if (pid < 0)
-    {
-    error_pl2wam:
-      Pl_Err_System(Pl_Create_Atom("error trying to execute pl2wam (maybe not found)"));
-      return FALSE;
-    }
-
-  save_use_le_prompt = pl_use_le_prompt;
-  pl_use_le_prompt = 0;
-  for (;;)
-    {
-#if 1
-      c = fgetc(f_out);
-#else
-      char c0;
-      c = (read(fileno(f_out), &c0, 1) == 1) ? c0 : EOF;
-#endif
-      if (c == EOF)
-	break;
-
-#ifndef NO_USE_PIPED_STDIN_FOR_CONSULT
-      if (c == CHAR_TO_EMIT_ON_PIPED_GETC)
-	{
-	  if (p == NULL)
-	    {
-	      c = Pl_Stream_Getc(pstm_i);
-	      if (c == EOF)
-		{
-		eof_reached:
-		  p = (unsigned char *) "end_of_file.\n";
-		  c = *p++;
-		}
-	    }
-	  else
-	    {
-	      if (*p == '\0')
-		goto eof_reached;
-	      else
-		c = *p++;
-	    }
-	  fputc(c, f_in);
-	  fflush(f_in);
-	  continue;
-	}
-#endif
-      Pl_Stream_Putc(c, pstm_o);
-    }
-  pl_use_le_prompt = save_use_le_prompt;
-  if (f_in)
-    fclose(f_in);
-  fclose(f_out);
+Bool Pl_GC_Collect(int nb_live_x);
 
-  status = Pl_M_Get_Status(pid);
-  if (status < 0)
-    goto error_pl2wam;
+void Pl_Atom_GC_Add_Root_Fct(AtomGCRootFct fct);
 
-  return status == 0;
-}
+void Pl_Atom_GC_Add_Engine_Root_Fct(AtomGCRootFct fct);
 
-#endif
+void Pl_Atom_GC_Request(void);
+
+void Pl_Atom_GC_Mark(int atom);
+
+void Pl_Atom_GC_Mark_Words(WamWord *adr, PlLong nb);
+
+
+
+#define GC_Check(nb_live_x)			\
+  do						\
+    {						\
+      if (H > pl_gc_trigger)			\
+	Pl_GC_Collect(nb_live_x);		\
+    }						\
+  while (0)
+
+
+
+#endif	/* !_GC_H */
@@ -91,6 +91,8 @@ typedef uintptr_t PlULong;
 
 typedef intptr_t PlTerm;
 
+typedef struct pl_engine *PlEngine;
+
 typedef struct
 {
   PlBool is_var;
@@ -110,8 +112,8 @@ PlFIOArg;
  * Global Variables                *
  *---------------------------------*/
 
-extern int pl_foreign_bkt_counter;
-extern char *pl_foreign_bkt_buffer;
+extern PL_THREAD_LOCAL PlLong pl_foreign_bkt_counter; /* private to each engine */
+extern PL_THREAD_LOCAL char *pl_foreign_bkt_buffer;
 
 extern int pl_type_atom;
 extern int pl_type_atomic;
@@ -160,12 +162,14 @@ extern int pl_domain_radix;
 extern int pl_domain_os_path;
 extern int pl_domain_os_file_permission;
 extern int pl_domain_selectable_item;
+extern int pl_domain_poll_event;
 extern int pl_domain_date_time;
 
 extern int pl_existence_procedure;
 extern int pl_existence_source_sink;
 extern int pl_existence_stream;
 extern int pl_existence_sr_descriptor;
+extern int pl_existence_poller;
 
 
 extern int pl_permission_operation_access;
@@ -207,6 +211,7 @@ extern int pl_evluation_zero_divisor;
 extern int pl_resource_print_object_not_linked;
 extern int pl_resource_finite_memory;
 extern int pl_resource_too_big_fd_constraint;
+extern int pl_resource_would_block;
 
 
 
@@ -225,6 +230,18 @@ PlBool Pl_Try_Execute_Top_Level(void);
 
 
 
+PlEngine Pl_Engine_Create(void);
+
+PlBool Pl_Engine_Attach(PlEngine engine);
+
+PlBool Pl_Engine_Detach(void);
+
+PlBool Pl_Engine_Destroy(PlEngine engine);
+
+PlEngine Pl_Engine_Current(void);
+
+
+
 
 #define Pl_Get_Choice_Counter()   pl_foreign_bkt_counter
 
@@ -250,6 +267,10 @@ int Pl_Create_Allocate_Atom(const char *atom);
 
 int Pl_Find_Atom(const char *atom);
 
+void Pl_Pin_Atom(int atom);
+
+void Pl_Unpin_Atom(int atom);
+
 int Pl_Atom_Char(char c);
 
 int Pl_Atom_Nil(void);
@@ -780,6 +801,7 @@ typedef PlFIOArg FIOArg;
 #define domain_os_path pl_domain_os_path
 #define domain_os_file_permission pl_domain_os_file_permission
 #define domain_selectable_item pl_domain_selectable_item
+#define domain_poll_event pl_domain_poll_event
 #define domain_date_time pl_domain_date_time
 
 
@@ -787,6 +809,7 @@ typedef PlFIOArg FIOArg;
 #define existence_source_sink pl_existence_source_sink
 #define existence_stream pl_existence_stream
 #define existence_sr_descriptor pl_existence_sr_descriptor
+#define existence_poller pl_existence_poller
 
 
 #define permission_operation_access pl_permission_operation_access
@@ -828,6 +851,7 @@ typedef PlFIOArg FIOArg;
 #define resource_print_object_not_linked pl_resource_print_object_not_linked
 #define resource_finite_memory pl_resource_finite_memory
 #define resource_too_big_fd_constraint pl_resource_too_big_fd_constraint
+#define resource_would_block pl_resource_would_block
 
 
 
@@ -136,7 +136,7 @@ static PlLong start_user_time = 0;
 static PlLong start_system_time = 0;
 static PlLong start_real_time = 0;
 
-static int cur_seed = 1;
+static PL_THREAD_LOCAL int cur_seed = 1; /* last seed given to srand() by this thread */
 
 
 
@@ -196,7 +196,7 @@ Pl_M_Sys_Err_String(int err_no)
 #endif
 
   char *str;
-  static char buff[64];
+  static PL_THREAD_LOCAL char buff[64];
 
 #if defined(_WIN32) || defined(__CYGWIN__)
   if (err_no == M_ERROR_WIN32)
@@ -367,7 +367,7 @@ Pl_M_Real_Time(void)
 void
 Pl_M_Randomize(void)
 {
-  static int count = 0;
+  static PL_THREAD_LOCAL int count = 0;
 #if defined(_WIN32) || defined(__CYGWIN__)
   int seed = GetTickCount();
 #else
@@ -451,7 +451,7 @@ Pl_M_Random_Float(double n)
 char *
 Pl_M_Host_Name_From_Name(char *host_name)
 {
-  static char buff[4096];
+  static PL_THREAD_LOCAL char buff[4096];
 
 #ifdef INET_MANAGEMENT
   struct hostent *host_entry;
@@ -575,7 +575,7 @@ Pl_M_Set_Working_Dir(char *path)
 char *
 Pl_M_Get_Working_Dir(void)
 {
-  static char cur_work_dir[MAXPATHLEN];
+  static PL_THREAD_LOCAL char cur_work_dir[MAXPATHLEN];
 
   if (getcwd(cur_work_dir, sizeof(cur_work_dir) - 1) == NULL)
     strcpy(cur_work_dir, ".");
@@ -602,8 +602,8 @@ Pl_M_Get_Working_Dir(void)
 char *
 Pl_M_Absolute_Path_Name0(char *src, Bool del_trail_slash)
 {
-  static char buff1[MAXPATHLEN];
-  static char buff2[MAXPATHLEN];
+  static PL_THREAD_LOCAL char buff1[MAXPATHLEN];
+  static PL_THREAD_LOCAL char buff2[MAXPATHLEN];
   char *dst, *base_dst;
   char *p, *q;
   char c;
@@ -864,8 +864,8 @@ Pl_M_Is_Absolute_File_Name(char *path)
 char *
 Pl_M_Decompose_File_Name(char *path, Bool del_trail_slashes, char **base, char **suffix)
 {
-  static char buff_dir[MAXPATHLEN];
-  static char buff_base[MAXPATHLEN];
+  static PL_THREAD_LOCAL char buff_dir[MAXPATHLEN];
+  static PL_THREAD_LOCAL char buff_base[MAXPATHLEN];
   int dir_start_pos = 0;	/* on _WIN32 maybe there is a drive specif */
 
 #if 0 && defined(_WIN32)	/* uncomment to explicitely use _splitpath() on Windows */
@@ -46,6 +46,7 @@
 #include <errno.h>
 
 #include "gp_config.h"
+#include "wam_regs.h"		/* for PL_THREAD_LOCAL */
 #include "bool.h"
 
 #if 0
@@ -546,7 +547,7 @@ typedef BOOL (WINAPI *PGPI) (DWORD, DWORD, DWORD, DWORD, PDWORD);
 char **
 Pl_M_Create_Shell_Command(char *cmd)
 {
-  static char *arg[4];
+  static PL_THREAD_LOCAL char *arg[4];
   char *p;
 
   /* first test SHELL env. var. (works under windows with msys2, ...) */
@@ -591,8 +592,8 @@ Pl_M_Create_Shell_Command(char *cmd)
 char **
 Pl_M_Cmd_Line_To_Argv(char *cmd, int *argc)
 {
-  static char **arg = NULL;
-  static int nb_arg = 0;
+  static PL_THREAD_LOCAL char **arg = NULL;
+  static PL_THREAD_LOCAL int nb_arg = 0;
   char *p = cmd;
   int i = 0;
 
@@ -914,7 +915,7 @@ Pl_M_Spawn_Redirect(char *arg[], int detach, FILE **f_in, FILE **f_out, FILE **f
   SECURITY_ATTRIBUTES sa = { 0 };
   STARTUPINFO si = { 0 };
   PROCESS_INFORMATION pi = { 0 };
-  static char buff[4096];
+  static PL_THREAD_LOCAL char buff[4096];
   char *cmd, *p;
   static char delim[2] = { '\0', '\0' };
   int i, n;
@@ -1139,7 +1140,7 @@ Pl_M_Mktemp(char *tmpl)
 				/* this code comes from glibc */
   int len;
   char *XXXXXX;
-  static PlULong value;
+  static PL_THREAD_LOCAL PlULong value;
   int count;
   struct stat buf;
   static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
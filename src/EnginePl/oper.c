@@ -187,6 +187,9 @@ Pl_Init_Oper(void)
 /*-------------------------------------------------------------------------*
  * PL_CREATE_OPER                                                          *
  *                                                                         *
+ * The operator table is protected by pl_atom_lock (the op_mask of an atom *
+ * shares its word with the other atom properties). An operator atom is    *
+ * never reclaimed by the atom GC.                                         *
  *-------------------------------------------------------------------------*/
 OperInf *
 Pl_Create_Oper(int atom_op, int type, int prec, int left, int right)
@@ -195,6 +198,8 @@ Pl_Create_Oper(int atom_op, int type, int prec, int left, int right)
   OperInf *oper;
 
 
+  Pl_Lock_Acquire(pl_atom_lock);
+
   Pl_Extend_Table_If_Needed(&pl_oper_tbl);
 
   oper_info.a_t = Make_Oper_Key(atom_op, type);
@@ -205,6 +210,9 @@ Pl_Create_Oper(int atom_op, int type, int prec, int left, int right)
   oper = (OperInf *) Pl_Hash_Insert(pl_oper_tbl, (char *) &oper_info, TRUE);
 
   pl_atom_tbl[atom_op].prop.op_mask |= Make_Op_Mask(type);
+  pl_atom_tbl[atom_op].prop.collectable = FALSE;
+
+  Pl_Lock_Release(pl_atom_lock);
 
   return oper;
 }
@@ -219,10 +227,16 @@ Pl_Create_Oper(int atom_op, int type, int prec, int left, int right)
 OperInf *
 Pl_Lookup_Oper(int atom_op, int type)
 {
+  OperInf *oper;
+
   if (!Check_Oper(atom_op, type))
     return NULL;
 
-  return (OperInf *) Pl_Hash_Find(pl_oper_tbl, Make_Oper_Key(atom_op, type));
+  Pl_Lock_Acquire(pl_atom_lock);
+  oper = (OperInf *) Pl_Hash_Find(pl_oper_tbl, Make_Oper_Key(atom_op, type));
+  Pl_Lock_Release(pl_atom_lock);
+
+  return oper;
 }
 
 
@@ -238,13 +252,13 @@ Pl_Lookup_Oper_Any_Type(int atom_op)
   int op_mask = pl_atom_tbl[atom_op].prop.op_mask;
 
   if (op_mask & Make_Op_Mask(PREFIX))
-    return (OperInf *) Pl_Hash_Find(pl_oper_tbl, Make_Oper_Key(atom_op, PREFIX));
+    return Pl_Lookup_Oper(atom_op, PREFIX);
 
   if (op_mask & Make_Op_Mask(INFIX))
-    return (OperInf *) Pl_Hash_Find(pl_oper_tbl, Make_Oper_Key(atom_op, INFIX));
+    return Pl_Lookup_Oper(atom_op, INFIX);
 
   if (op_mask & Make_Op_Mask(POSTFIX))
-    return (OperInf *) Pl_Hash_Find(pl_oper_tbl, Make_Oper_Key(atom_op, POSTFIX));
+    return Pl_Lookup_Oper(atom_op, POSTFIX);
 
   return NULL;
 }
@@ -255,13 +269,22 @@ Pl_Lookup_Oper_Any_Type(int atom_op)
 /*-------------------------------------------------------------------------*
  * PL_DELETE_OPER                                                          *
  *                                                                         *
+ * The operator is only removed from the op_mask of the atom (its entry is *
+ * kept and reused if it is redefined): an OperInf returned by a lookup    *
+ * thus remains valid (e.g. while another engine reads a term).            *
  *-------------------------------------------------------------------------*/
 OperInf *
 Pl_Delete_Oper(int atom_op, int type)
 {
   PlLong key = Make_Oper_Key(atom_op, type);
+  OperInf *oper;
+
+  Pl_Lock_Acquire(pl_atom_lock);
 
   pl_atom_tbl[atom_op].prop.op_mask &= ~Make_Op_Mask(type);
+  oper = (OperInf *) Pl_Hash_Find(pl_oper_tbl, key);
 
-  return (OperInf *) Pl_Hash_Delete(pl_oper_tbl, key);
+  Pl_Lock_Release(pl_atom_lock);
+
+  return oper;
 }
@@ -125,6 +125,7 @@ StackInf;
 
 UsedMachRegInf used_mach_reg[256];
 int nb_of_used_mach_regs;
+int parallel_engines;		/* per-engine state in thread-local vars ? */
 
 char save_str[STR_LENGTH];
 FILE *fw_r;
@@ -186,6 +187,7 @@ main(void)
     Fatal_Error("cannot open %s", FILE_WAM_REGS_H);
 
   fprintf(fw_r, "/* this file is automatically generated by pl_config.c */\n");
+  fprintf(fw_r, "\n#ifndef _WAM_REGS_H\n#define _WAM_REGS_H\n");
   fprintf(fw_r, "\n#include \"gp_config.h\"\n\n");
 
 
@@ -193,6 +195,7 @@ main(void)
     Fatal_Error("cannot open %s", FILE_WAM_STACKS_H);
 
   fprintf(fw_s, "/* this file is automatically generated by pl_config.c */\n");
+  fprintf(fw_s, "\n#include \"wam_regs.h\"\n\n");
 
   if ((fg_c = fopen(FILE_GPROLOG_CST_H, "wb")) == NULL)
     Fatal_Error("cannot open %s", FILE_GPROLOG_CST_H);
@@ -297,7 +300,9 @@ main(void)
   printf("                    NO_MACHINE_REG_FOR_REG_BANK is SET\n");
 #endif
 
-  
+  printf("Parallel engines  : %s\n", (parallel_engines) ? "Yes" : "No");
+
+  fprintf(fw_r, "\n#endif /* !_WAM_REGS_H */\n");
 
 #if 0
   fprintf(fg_c, "/* end of automatically generated part */\n");
@@ -645,6 +650,9 @@ Generate_Regs(FILE *f, FILE *g)
       fprintf(g, "register WamWord \t\t*pl_reg_bank asm (\"%s\");\n\n", *p);
       fprintf(fw_r, "#define MAP_REG_BANK\t\t\"%s\"\n\n", *p);
       p++;
+#ifdef TLS_KEYWORD
+      parallel_engines = 1;	/* the bank is then private to each thread */
+#endif
     }
   else
     {
@@ -656,6 +664,19 @@ Generate_Regs(FILE *f, FILE *g)
     }
 #endif
 
+  if (parallel_engines)
+    {
+      fprintf(fw_r, "#define PARALLEL_ENGINES\n");
+      fprintf(fw_r, "#define PL_THREAD_LOCAL\t\t%s\n\n", PP_STR(TLS_KEYWORD));
+				/* also for gprolog.h (foreign variables) */
+      fprintf(fg_c, "#define PL_THREAD_LOCAL\t\t%s\n\n", PP_STR(TLS_KEYWORD));
+    }
+  else
+    {
+      fprintf(fw_r, "#define PL_THREAD_LOCAL\n\n");
+      fprintf(fg_c, "#define PL_THREAD_LOCAL\n\n");
+    }
+
   for (i = 0; i < 10; i++)
     for (j = 0, total_nb_reg += nb_reg[i]; j < nb_reg[i]; j++)
       {
@@ -704,11 +725,11 @@ Generate_Regs(FILE *f, FILE *g)
 #ifdef NO_MACHINE_REG_FOR_REG_BANK
   fprintf(g, "WamWord pl_reg_bank[REG_BANK_SIZE];\n");
 #else
-  fprintf(g, "WamWord *save_reg_bank;\n\n");
+  fprintf(g, "PL_THREAD_LOCAL WamWord *save_reg_bank;\n\n");
 #endif
 
   if (regs_to_save_for_signal)
-    fprintf(g, "WamWord pl_buff_signal_reg[NB_OF_USED_MACHINE_REGS + 1];\n\n");
+    fprintf(g, "PL_THREAD_LOCAL WamWord pl_buff_signal_reg[NB_OF_USED_MACHINE_REGS + 1];\n\n");
 
   fprintf(g, "char *pl_reg_tbl[] = { ");
   k = 0;
@@ -725,11 +746,11 @@ Generate_Regs(FILE *f, FILE *g)
 #ifdef NO_MACHINE_REG_FOR_REG_BANK
   fprintf(g, "extern WamWord pl_reg_bank[];\n");
 #else
-  fprintf(g, "extern WamWord *save_reg_bank;\n\n");
+  fprintf(g, "extern PL_THREAD_LOCAL WamWord *save_reg_bank;\n\n");
 #endif
 
   if (regs_to_save_for_signal)
-    fprintf(g, "extern WamWord pl_buff_signal_reg[];\n\n");
+    fprintf(g, "extern PL_THREAD_LOCAL WamWord pl_buff_signal_reg[];\n\n");
 
   fprintf(g, "extern char *pl_reg_tbl[];\n");
 
@@ -1174,6 +1195,7 @@ Generate_Stacks(FILE *f, FILE *g)
 
       fprintf(fw_s, "#define %s_Stack       \t(pl_stk_tbl[%d].stack)\n", str, i);
       fprintf(fw_s, "#define %s_Size        \t(pl_stk_tbl[%d].size)\n", str, i);
+      fprintf(fw_s, "#define %s_Max_Size    \t(pl_stk_tbl[%d].max_size)\n", str, i);
       fprintf(fw_s, "#define %s_Offset(adr) \t((WamWord *)(adr) - %s_Stack)\n",
               str, str);
       fprintf(fw_s, "#define %s_Used_Size   \t%s_Offset(%s)\n\n", str, str,
@@ -1195,6 +1217,7 @@ Generate_Stacks(FILE *f, FILE *g)
   fprintf(fw_s, "  PlLong *p_def_size;  \t/* used for fixed_sizes */\n");
   fprintf(fw_s, "  PlLong default_size; \t/* in WamWords */\n");
   fprintf(fw_s, "  PlLong size;         \t/* in WamWords */\n");
+  fprintf(fw_s, "  PlLong max_size;     \t/* in WamWords (reserved, grows up to) */\n");
   fprintf(fw_s, "  WamWord *stack;\n");
   fprintf(fw_s, "}InfStack;\n\n\n");
 
@@ -1207,7 +1230,7 @@ Generate_Stacks(FILE *f, FILE *g)
     fprintf(fw_s, "PlLong pl_def_%s_size;\n", stack[i].name);
   fprintf(fw_s, "PlLong pl_fixed_sizes;\n\n");
 
-  fprintf(fw_s, "InfStack pl_stk_tbl[] =\n{\n");
+  fprintf(fw_s, "PL_THREAD_LOCAL InfStack pl_stk_tbl[] =\n{\n");
 
   for (i = 0; i < nb_stack; i++)
     {
@@ -1215,7 +1238,7 @@ Generate_Stacks(FILE *f, FILE *g)
       for (p1 = str; *p1; p1++)
         *p1 = toupper(*p1);
 
-      fprintf(fw_s, " { \"%s\", %s, \"%sSZ\", &pl_def_%s_size, %d, 0, NULL }%s",
+      fprintf(fw_s, " { \"%s\", %s, \"%sSZ\", &pl_def_%s_size, %d, 0, 0, NULL }%s",
               stack[i].name, stack[i].desc, str, stack[i].name, stack[i].def_size,
               (i < nb_stack - 1) ? ",\n" : "\n};\n");
     }
@@ -1225,7 +1248,7 @@ Generate_Stacks(FILE *f, FILE *g)
   for (i = 0; i < nb_stack; i++)
     fprintf(fw_s, "extern PlLong pl_def_%s_size;\n", stack[i].name);
   fprintf(fw_s, "extern PlLong pl_fixed_sizes;\n\n\n");
-  fprintf(fw_s, "extern InfStack pl_stk_tbl[];\n");
+  fprintf(fw_s, "extern PL_THREAD_LOCAL InfStack pl_stk_tbl[];\n");
   fprintf(fw_s, "\n#endif\n");
 
 
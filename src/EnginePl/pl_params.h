@@ -45,6 +45,14 @@
 #define ENV_VAR_MAX_ATOM           "MAX_ATOM"
 #define DEFAULT_MAX_ATOM           100000
 
+     /* stacks are reserved with this size (in Kb) and grow on demand */
+#define ENV_VAR_MAX_STACK_SIZE     "MAX_STACK_SIZE"
+#if WORD_SIZE == 64
+#define DEFAULT_MAX_STACK_SIZE     (4 * 1024 * 1024)
+#else
+#define DEFAULT_MAX_STACK_SIZE     0
+#endif
+
 #define NB_OF_X_REGS               256
 #define MAX_ARITY                  (NB_OF_X_REGS - 1)
 
@@ -89,6 +89,7 @@ Pl_Init_Pred(void)
 #endif
 
   pl_pred_tbl = Pl_Hash_Alloc_Table(START_PRED_TBL_SIZE, sizeof(PredInf));
+  pl_pred_lock = Pl_Lock_Create();
 
 /* The following control constructs are defined as predicates ONLY to:
  *
@@ -128,7 +129,8 @@ Pl_Init_Pred(void)
  * PL_CREATE_PRED                                                          *
  *                                                                         *
  * Called by compiled prolog code, by dynamic predicate support and by     *
- * byte-code support.                                                      *
+ * byte-code support. The predicate table is protected by pl_pred_lock (a  *
+ * PredInf remains valid until the predicate is deleted).                  *
  *-------------------------------------------------------------------------*/
 PredInf * FC
 Pl_Create_Pred(int func, int arity, int pl_file, int pl_line, int prop, PlLong *codep)
@@ -152,6 +154,8 @@ Pl_Create_Pred(int func, int arity, int pl_file, int pl_line, int prop, PlLong *
   pred_info.codep = codep;
   pred_info.dyn = NULL;
 
+  Pl_Lock_Acquire(pl_pred_lock);
+
   Pl_Extend_Table_If_Needed(&pl_pred_tbl);
   pred = (PredInf *) Pl_Hash_Insert(pl_pred_tbl, (char *) &pred_info, FALSE);
 
@@ -167,6 +171,8 @@ Pl_Create_Pred(int func, int arity, int pl_file, int pl_line, int prop, PlLong *
   pred->pl_line = pl_line;
 #endif
 
+  Pl_Lock_Release(pl_pred_lock);
+
   return pred;
 }
 
@@ -181,8 +187,13 @@ PredInf * FC
 Pl_Lookup_Pred(int func, int arity)
 {
   PlLong key = Functor_Arity(func, arity);
+  PredInf *pred;
 
-  return (PredInf *) Pl_Hash_Find(pl_pred_tbl, key);
+  Pl_Lock_Acquire(pl_pred_lock);
+  pred = (PredInf *) Pl_Hash_Find(pl_pred_tbl, key);
+  Pl_Lock_Release(pl_pred_lock);
+
+  return pred;
 }
 
 
@@ -197,5 +208,7 @@ Pl_Delete_Pred(int func, int arity)
 {
   PlLong key = Functor_Arity(func, arity);
 
+  Pl_Lock_Acquire(pl_pred_lock);
   Pl_Hash_Delete(pl_pred_tbl, key);
+  Pl_Lock_Release(pl_pred_lock);
 }
@@ -81,10 +81,14 @@ PredInf;
 
 char *pl_pred_tbl;
 
+struct pl_lock *pl_pred_lock;	/* a PlLock: protects the predicate table and dynamic db */
+
 #else
 
 extern char *pl_pred_tbl;
 
+extern struct pl_lock *pl_pred_lock;
+
 #endif
 
 
@@ -105,18 +105,26 @@
 #define MAX_SIGSEGV_HANDLER        10
 
 
+#if defined(HAVE_MMAP) && defined(HAVE_MPROTECT) && !defined(_WIN32) && !defined(__MSYS__)
+#define GROWABLE_STACKS
+#endif
+
+
           /* Error Messages */
 
 #define ERR_STACKS_ALLOCATION      "Memory allocation fault"
 
 #define ERR_CANNOT_OPEN_DEV0       "Cannot open /dev/zero : %s"
 #define ERR_CANNOT_UNMAP           "unmap failed : %s"
+#define ERR_CANNOT_MPROTECT        "mprotect failed : %s"
 
 #define ERR_CANNOT_FREE            "VirtualFree failed : %" PL_FMT_u
 #define ERR_CANNOT_PROTECT         "VirtualProtect failed : %" PL_FMT_u
 
 #define ERR_STACK_OVERFLOW_ENV     "%s stack overflow (size: %" PL_FMT_d " Kb, reached: %" PL_FMT_d " Kb, environment variable used: %s)"
 
+#define ERR_STACK_OVERFLOW_MAX_ENV "%s stack overflow (size: %" PL_FMT_d " Kb, reached: %" PL_FMT_d " Kb, environment variables used: %s, %s)"
+
 #define ERR_STACK_OVERFLOW_NO_ENV  "%s stack overflow (size: %" PL_FMT_d " Kb, reached: %" PL_FMT_d " Kb - fixed size)"
 
 
@@ -132,6 +140,8 @@
 
 static int page_size;
 
+static Bool stacks_reserved;	/* reserved (PROT_NONE) beyond stack size ? */
+
 static SegvHdlr tbl_handler[MAX_SIGSEGV_HANDLER];
 static int nb_handler = 0;
 
@@ -146,6 +156,12 @@ static void SIGSEGV_Handler();
 
 static void Handle_Bad_Address(void *bad_addr);
 
+static WamWord *Reserve_Stacks(InfStack *stk_tbl, Bool reserve_only, size_t *p_length);
+
+static void Map_Stacks(InfStack *stk_tbl, WamWord *addr);
+
+static Bool Grow_Stack(int stk_nb, WamWord *adr);
+
 static int Default_SIGSEGV_Handler(void *bad_addr);
 
 static char *Stack_Overflow_Err_Msg(int stk_nb);
@@ -182,7 +198,7 @@ getpagesize(void)
  *                                                                         *
  *-------------------------------------------------------------------------*/
 static void *
-Virtual_Mem_Alloc(void *addr, size_t length)
+Virtual_Mem_Alloc(void *addr, size_t length, Bool reserve_only)
 {
 #if defined(_WIN32) || defined(__MSYS__)
 
@@ -200,8 +216,12 @@ Virtual_Mem_Alloc(void *addr, size_t length)
     Pl_Fatal_Error(ERR_CANNOT_OPEN_DEV0, Pl_M_Sys_Err_String(errno));
 #endif /* !MAP_ANON */
 
-  addr = (void *) mmap((void *) addr, length, PROT_READ | PROT_WRITE,
+  addr = (void *) mmap((void *) addr, length,
+                          (reserve_only) ? PROT_NONE : PROT_READ | PROT_WRITE,
                           MAP_PRIVATE
+#if defined(GROWABLE_STACKS) && defined(MAP_NORESERVE)
+                          | ((reserve_only) ? MAP_NORESERVE : 0)
+#endif
 #ifdef MMAP_NEEDS_FIXED
                           | MAP_FIXED
 #endif
@@ -226,7 +246,6 @@ Virtual_Mem_Alloc(void *addr, size_t length)
 
 
 
-#if TAG_SIZE_HIGH > 0
 /*-------------------------------------------------------------------------*
  * VIRTUAL_MEM_FREE                                                        *
  *                                                                         *
@@ -250,7 +269,6 @@ Virtual_Mem_Free(void *addr, size_t length)
 
 #endif
 }
-#endif  /* TAG_SIZE_HIGH > 0 */
 
 
 
@@ -290,11 +308,34 @@ Virtual_Mem_Protect(void *addr, size_t length)
 
 
 /*-------------------------------------------------------------------------*
- * PL_ALLOCATE_STACKS                                                      *
+ * VIRTUAL_MEM_COMMIT                                                      *
  *                                                                         *
+ * Make a part of a reserved (PROT_NONE) area accessible.                  *
  *-------------------------------------------------------------------------*/
-void
-Pl_Allocate_Stacks(void)
+#ifdef GROWABLE_STACKS
+static Bool
+Virtual_Mem_Commit(void *addr, size_t length)
+{
+#ifdef DEBUG
+  DBGPRINTF("Commit at %p len: %d\n", addr, length);
+#endif
+  return mprotect((void *) addr, length, PROT_READ | PROT_WRITE) == 0;
+}
+#endif
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RESERVE_STACKS                                                          *
+ *                                                                         *
+ * Allocate a contiguous area for all stacks (each stack can grow up to    *
+ * its max_size followed by a guard page). If reserve_only is TRUE the     *
+ * area is only reserved (inaccessible), else it is fully accessible.      *
+ * The length (in bytes) of the area is stored in *p_length.               *
+ *-------------------------------------------------------------------------*/
+static WamWord *
+Reserve_Stacks(InfStack *stk_tbl, Bool reserve_only, size_t *p_length)
 {
   size_t length = 0, stk_sz;
   WamWord *addr;
@@ -314,16 +355,15 @@ Pl_Allocate_Stacks(void)
 #endif
     (WamWord *) -1 };
 
-  page_size = getpagesize() / sizeof(WamWord);
-
   for (i = 0; i < NB_OF_STACKS; i++)
     {
-      stk_sz = pl_stk_tbl[i].size = Round_Up(pl_stk_tbl[i].size, page_size);
+      stk_sz = stk_tbl[i].max_size;
       if (stk_sz == 0)
 	stk_sz = page_size;	/* at leat one page to write magic numbers */
       length += stk_sz + page_size;
     }
   length *= sizeof(WamWord);
+  *p_length = length;
 
   addr = NULL;
   for(i = 0; addr == NULL && addr_to_try[i] != (WamWord *) -1; i++)
@@ -340,7 +380,7 @@ Pl_Allocate_Stacks(void)
 #ifdef DEBUG
       DBGPRINTF("base: %p length: %d Kb\n", addr, length / 1024);
 #endif
-      addr = Virtual_Mem_Alloc(addr, length);
+      addr = Virtual_Mem_Alloc(addr, length, reserve_only);
 
 #ifdef DEBUG
       DBGPRINTF("obtaining: %p  (end: %p)\n", addr, (WamWord *) ((PlULong) addr + length));
@@ -357,25 +397,60 @@ Pl_Allocate_Stacks(void)
 #endif /* TAG_SIZE_HIGH > 0 */
     }
 
-  if (addr == NULL)
-    Pl_Fatal_Error(ERR_STACKS_ALLOCATION);
+  return addr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ALLOCATE_STACKS                                                      *
+ *                                                                         *
+ * Each stack is followed by an inaccessible area of max_size - size words *
+ * (see Grow_Stack) and a guard page.                                      *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Allocate_Stacks(void)
+{
+  size_t length;
+  WamWord *addr = NULL;
+  int i;
+
+  page_size = getpagesize() / sizeof(WamWord);
 
   for (i = 0; i < NB_OF_STACKS; i++)
     {
-      pl_stk_tbl[i].stack = addr;
-      stk_sz = pl_stk_tbl[i].size;
-      if (stk_sz == 0)
-	stk_sz = page_size;	/* at least one page for magic numbers */
-#ifdef DEBUG
-      DBGPRINTF("  stack: %d %-10s length: %5ld Kb   addr:[%p..%p[ + 1 free page, next addr: %p\n", 
-		i, pl_stk_tbl[i].name, stk_sz * sizeof(WamWord) / 1024, 
-		addr, addr + stk_sz, addr + stk_sz + page_size);
+      pl_stk_tbl[i].size = Round_Up(pl_stk_tbl[i].size, page_size);
+#ifdef GROWABLE_STACKS
+      pl_stk_tbl[i].max_size = Round_Up(pl_stk_tbl[i].max_size, page_size);
+      if (pl_stk_tbl[i].max_size < pl_stk_tbl[i].size)
 #endif
-      addr += stk_sz;
-      Virtual_Mem_Protect(addr, page_size * sizeof(WamWord));
-      addr += page_size;
+	pl_stk_tbl[i].max_size = pl_stk_tbl[i].size;
     }
 
+  stacks_reserved = FALSE;
+
+#ifdef GROWABLE_STACKS
+  for (i = 0; i < NB_OF_STACKS; i++)
+    if (pl_stk_tbl[i].max_size > pl_stk_tbl[i].size)
+      stacks_reserved = TRUE;
+
+  if (stacks_reserved && (addr = Reserve_Stacks(pl_stk_tbl, TRUE, &length)) == NULL)
+    {				/* cannot reserve: fall back to fixed sizes */
+      stacks_reserved = FALSE;
+      for (i = 0; i < NB_OF_STACKS; i++)
+	pl_stk_tbl[i].max_size = pl_stk_tbl[i].size;
+    }
+#endif
+
+  if (!stacks_reserved)
+    addr = Reserve_Stacks(pl_stk_tbl, FALSE, &length);
+
+  if (addr == NULL)
+    Pl_Fatal_Error(ERR_STACKS_ALLOCATION);
+
+  Map_Stacks(pl_stk_tbl, addr);
+
   Install_SIGSEGV_Handler();	/* install the real (and unique) SIGSEGV handler */
   Pl_Push_SIGSEGV_Handler(Default_SIGSEGV_Handler); /* install initial user SIGSEGV handler */
 
@@ -389,6 +464,170 @@ Pl_Allocate_Stacks(void)
 
 
 
+/*-------------------------------------------------------------------------*
+ * MAP_STACKS                                                              *
+ *                                                                         *
+ * Set the stack addresses of stk_tbl in the area addr (see Reserve_Stacks)*
+ * making accessible the initial part of each stack.                       *
+ *-------------------------------------------------------------------------*/
+static void
+Map_Stacks(InfStack *stk_tbl, WamWord *addr)
+{
+  size_t stk_sz, max_sz;
+  int i;
+
+  for (i = 0; i < NB_OF_STACKS; i++)
+    {
+      stk_tbl[i].stack = addr;
+      stk_sz = stk_tbl[i].size;
+      if (stk_sz == 0)
+	stk_sz = page_size;	/* at least one page for magic numbers */
+      max_sz = stk_tbl[i].max_size;
+      if (max_sz < stk_sz)
+	max_sz = stk_sz;
+#ifdef DEBUG
+      DBGPRINTF("  stack: %d %-10s length: %5ld Kb (max: %ld Kb)  addr:[%p..%p[ + 1 free page, next addr: %p\n", 
+		i, stk_tbl[i].name, stk_sz * sizeof(WamWord) / 1024, max_sz * sizeof(WamWord) / 1024,
+		addr, addr + stk_sz, addr + max_sz + page_size);
+#endif
+#ifdef GROWABLE_STACKS
+      if (stacks_reserved && !Virtual_Mem_Commit(addr, stk_sz * sizeof(WamWord)))
+	Pl_Fatal_Error(ERR_CANNOT_MPROTECT, Pl_M_Sys_Err_String(errno));
+#endif
+      addr += stk_sz;
+      Virtual_Mem_Protect(addr, (max_sz - stk_sz + page_size) * sizeof(WamWord));
+      addr += max_sz - stk_sz + page_size;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_ALLOCATE_ENGINE_STACKS                                               *
+ *                                                                         *
+ * Allocate a new set of stacks (see engine.c) whose sizes are given in    *
+ * stk_tbl (as adjusted by Pl_Allocate_Stacks). The stacks are reserved in *
+ * the same way as the initial ones. Returns the base of the area (and its *
+ * length in *p_length) or NULL if the memory is exhausted.                *
+ *-------------------------------------------------------------------------*/
+WamWord *
+Pl_Allocate_Engine_Stacks(InfStack *stk_tbl, size_t *p_length)
+{
+  WamWord *addr;
+
+  addr = Reserve_Stacks(stk_tbl, stacks_reserved, p_length);
+  if (addr != NULL)
+    Map_Stacks(stk_tbl, addr);
+
+  return addr;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_FREE_ENGINE_STACKS                                                   *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Free_Engine_Stacks(WamWord *addr, size_t length)
+{
+  Virtual_Mem_Free(addr, length);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GROW_STACK                                                              *
+ *                                                                         *
+ * Extend a stack (in place) so that adr becomes accessible. The size is   *
+ * at least doubled to amortize the cost of the faults. Returns FALSE if   *
+ * adr is not in the reserved part of the stack (overflow).                *
+ *-------------------------------------------------------------------------*/
+static Bool
+Grow_Stack(int stk_nb, WamWord *adr)
+{
+#ifdef GROWABLE_STACKS
+  InfStack *s = pl_stk_tbl + stk_nb;
+  WamWord *end = s->stack + s->size;
+  WamWord *max_end = s->stack + s->max_size;
+  WamWord *new_end;
+
+  if (!stacks_reserved || adr < end || adr >= max_end)
+    return FALSE;
+
+  new_end = s->stack + 2 * s->size;
+  if (new_end <= adr)
+    new_end = adr + 1;
+
+  new_end = (WamWord *) Round_Up((PlULong) new_end, page_size * sizeof(WamWord));
+  if (new_end > max_end)
+    new_end = max_end;
+
+#ifdef DEBUG
+  DBGPRINTF("Grow stack: %s from %ld Kb to %ld Kb\n", s->name,
+	    Wam_Words_To_KBytes(s->size), Wam_Words_To_KBytes(new_end - s->stack));
+#endif
+
+  if (!Virtual_Mem_Commit(end, (new_end - end) * sizeof(WamWord)))
+    return FALSE;
+
+  s->size = new_end - s->stack;
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_GROW_STACK                                                           *
+ *                                                                         *
+ * Make adr accessible if it is in the reserved part of a stack.           *
+ *-------------------------------------------------------------------------*/
+Bool
+Pl_Grow_Stack(WamWord *adr)
+{
+  int i;
+
+  for (i = 0; i < NB_OF_STACKS; i++)
+    if (adr >= pl_stk_tbl[i].stack && adr < pl_stk_tbl[i].stack + pl_stk_tbl[i].max_size)
+      return adr < pl_stk_tbl[i].stack + pl_stk_tbl[i].size || Grow_Stack(i, adr);
+
+  return FALSE;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PL_RELEASE_STACK_PAGES                                                  *
+ *                                                                         *
+ * Give back to the system the physical pages of [from, to[ (e.g. the part *
+ * of the heap freed by the garbage collector). The area remains usable    *
+ * (and is zero-filled on next access).                                    *
+ *-------------------------------------------------------------------------*/
+void
+Pl_Release_Stack_Pages(WamWord *from, WamWord *to)
+{
+#if defined(GROWABLE_STACKS) && defined(MADV_DONTNEED)
+  PlULong page_bytes = page_size * sizeof(WamWord);
+  PlULong beg = Round_Up((PlULong) from, page_bytes);
+  PlULong end = Round_Down((PlULong) to, page_bytes);
+
+  if (beg < end)
+    madvise((void *) beg, end - beg, MADV_DONTNEED);
+#endif
+}
+
+
+
+
+
 #if !defined(__MSYS__) && (defined(__unix__) || defined(__CYGWIN__))
 
 /*-------------------------------------------------------------------------*
@@ -581,6 +820,9 @@ Handle_Bad_Address(void *bad_addr)
 {
   int i = nb_handler;
 
+  if (bad_addr != NULL && Pl_Grow_Stack((WamWord *) bad_addr))
+    return;			/* stack extended: resume faulting instruction */
+
   while(--i >= 0)
     {
       if ((*tbl_handler[i])(bad_addr))
@@ -648,7 +890,7 @@ Default_SIGSEGV_Handler(void *bad_addr)
 #endif
 
   i = NB_OF_STACKS - 1;
-  if (addr < pl_stk_tbl[i].stack + pl_stk_tbl[i].size + page_size)
+  if (addr < pl_stk_tbl[i].stack + pl_stk_tbl[i].max_size + page_size)
     while (i >= 0)
       {
 #ifdef DEBUG
@@ -741,7 +983,7 @@ Stack_Overflow_Err_Msg(int stk_nb)
   char *var = s->env_var_name;
   PlLong size = s->size;
   PlLong usage = (Stack_Top(stk_nb) - s->stack);
-  static char msg[256];
+  static PL_THREAD_LOCAL char msg[256];
 
   if (s->stack == Global_Stack)
     size += REG_BANK_SIZE;      /* see Init_Engine */
@@ -751,6 +993,9 @@ Stack_Overflow_Err_Msg(int stk_nb)
 
   if (pl_fixed_sizes || var[0] == '\0')
     sprintf(msg, ERR_STACK_OVERFLOW_NO_ENV, s->name, size, usage);
+  else if (stacks_reserved)
+    sprintf(msg, ERR_STACK_OVERFLOW_MAX_ENV, s->name, size, usage, var,
+	    ENV_VAR_MAX_STACK_SIZE);
   else
     sprintf(msg, ERR_STACK_OVERFLOW_ENV, s->name, size, usage, var);
 
@@ -59,6 +59,14 @@ typedef int (*SegvHdlr)(void *bad_addr);
 
 void Pl_Allocate_Stacks(void);
 
+WamWord *Pl_Allocate_Engine_Stacks(InfStack *stk_tbl, size_t *p_length);
+
+void Pl_Free_Engine_Stacks(WamWord *addr, size_t length);
+
+Bool Pl_Grow_Stack(WamWord *adr);
+
+void Pl_Release_Stack_Pages(WamWord *from, WamWord *to);
+
 void Pl_Push_SIGSEGV_Handler(SegvHdlr handler);
 
 void Pl_Pop_SIGSEGV_Handler(void);
@@ -1022,9 +1022,10 @@ Pl_Globalize_If_In_Local(WamWord start_word)
  * PL_ALLOCATE                                                             *
  *                                                                         *
  * Called by compiled prolog code.                                         *
+ * nb_live_x: nb of X registers live (args + cut reg), used by the GC.     *
  *-------------------------------------------------------------------------*/
 void FC
-Pl_Allocate(int n)
+Pl_Allocate(int n, int nb_live_x)
 {
   WamWord *old_E = E;
   WamWord *cur_E = Local_Top + ENVIR_STATIC_SIZE + n;
@@ -1045,6 +1046,8 @@ Pl_Allocate(int n)
       *cur_E = Make_Self_Ref(cur_E);
       cur_E--;
     }
+
+  GC_Check(nb_live_x);
 #endif
 }
 
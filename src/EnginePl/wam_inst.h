@@ -36,9 +36,7 @@
  *-------------------------------------------------------------------------*/
 
 
-#if 0
-#define GARBAGE_COLLECTOR
-#endif
+#define GARBAGE_COLLECTOR		/* NBYE in environments (see gc.c) */
 
 
 /*---------------------------------*
@@ -348,7 +346,7 @@ Bool FC Pl_Unify_Structure(int func, int arity);
 
 WamWord FC Pl_Globalize_If_In_Local(WamWord start_word);
 
-void FC Pl_Allocate(int n);
+void FC Pl_Allocate(int n, int nb_live_x);
 
 void FC Pl_Deallocate(void);
 
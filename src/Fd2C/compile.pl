@@ -121,7 +121,7 @@ e_body(by(LBloc, WaitSwt), LFctName1) :-
 	e_bloc_lst(LBloc, LFctName),
 	(   WaitSwt = ws(LUse, LCase) ->
 	    e_wait_swt(LUse, LCase, FctName1),
-	    e_fct_install_triggers(-1, LUse, -1, always, FctName1, FctName),
+	    e_fct_install_triggers(-1, LUse, -1, always, 0, FctName1, FctName),
 	    append(LFctName, [FctName], LFctName1)
 	;   LFctName1 = LFctName
 	).
@@ -198,9 +198,9 @@ e_bloc_lst([Bloc|LBloc], [FctName|LFctName]) :-
 
 
 
-e_bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always), FctName1) :-
+e_bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always, Prio), FctName1) :-
 	e_bloc(LUse, LWInst, FctName),
-	e_fct_install_triggers(BNo, LDep, TellFdv, Always, FctName, FctName1).
+	e_fct_install_triggers(BNo, LDep, TellFdv, Always, Prio, FctName, FctName1).
 
 
 
@@ -218,7 +218,7 @@ e_bloc(LUse, LWInst1, FctName) :-
 
 
 
-e_fct_install_triggers(BNo, LDep, TellFdv, Always, FctName, FctName1) :-
+e_fct_install_triggers(BNo, LDep, TellFdv, Always, Prio, FctName, FctName1) :-
 	e_has_dependencies(LDep), !,
 	(   Always = always ->
 	    Optim = 0
@@ -227,7 +227,7 @@ e_fct_install_triggers(BNo, LDep, TellFdv, Always, FctName, FctName1) :-
 	atom_concat(FctName, '_inst', FctName1),
 	format(stream_c, '~nfd_begin_internal(~a)~n~n', [FctName1]),
 	format(stream_c, '   fd_local_cf_pointer~n', []),
-	format(stream_c, '   fd_create_c_frame(~a,~d,~d)~n', [FctName, TellFdv, Optim]),
+	format(stream_c, '   fd_create_c_frame(~a,~d,~d,~d)~n', [FctName, TellFdv, Optim, Prio]),
 	(   BNo = -1 ->
 	    true
 	;   format(stream_c, '   fd_cf_in_a_frame(~d)~n', [BNo])
@@ -238,7 +238,7 @@ e_fct_install_triggers(BNo, LDep, TellFdv, Always, FctName, FctName1) :-
 	format(stream_c, '   fd_return~n', []),
 	format(stream_c, '~nfd_end_internal~n', []).
 
-e_fct_install_triggers(_, _, _, _, FctName, FctName).
+e_fct_install_triggers(_, _, _, _, _, FctName, FctName).
 
 
 
@@ -176,7 +176,7 @@ bloc_lst([]) -->
 
 
 
-bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always)) -->
+bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always, Prio)) -->
 	{ clause(hvar(LVar), _) },
 	foreach(LVar, LUse, LWInst1, LWInst, HasForEach),
 	terminal(start),
@@ -196,6 +196,7 @@ bloc_one(bl(BNo, LDep, LUse, LWInst, TellFdv, Always)) -->
 	},
 	trig(LVar, LUse, LDep),
 	always(Always),
+	cost(TellFdv, HasForAll, HasForEach, Prio),
 	{ close_list(LDep), close_list(LUse) }.
 
 
@@ -280,6 +281,33 @@ always(optimized) -->
 
 
 
+cost(_, _, _, Prio) -->
+	terminal(cost), !,
+	ident_check(Cost),
+	(   { cost_priority(Cost, Prio) } ->
+	    []
+	;
+	    sem_error('unknown cost class "~a"', [Cost])
+	).
+
+cost(TellFdv, HasForAll, HasForEach, Prio) -->
+	{ TellFdv \== -1, HasForAll \== t, HasForEach \== t ->
+	  cost_priority(unary, Prio)
+	;
+	  cost_priority(linear, Prio)
+	}.
+
+
+
+
+cost_priority(unary, 0).
+cost_priority(linear, 1).
+cost_priority(quadratic, 2).
+cost_priority(cubic, 3).
+
+
+
+
 elem_lst(LVar, LUse, LWNext, LWInst) -->
 	elem_one(LVar, LUse, LWInst1, LWInst),
 	elem_lst(LVar, LUse, LWNext, LWInst1).
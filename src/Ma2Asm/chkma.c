@@ -98,10 +98,12 @@ PlULong pl_max_atom;		/* to not need atom.o */
 
 /* these 4 lines are get from foreign_supp.c */
 
-PlLong pl_foreign_long[NB_OF_X_REGS];
-double pl_foreign_double[NB_OF_X_REGS];
+PL_THREAD_LOCAL PlLong pl_foreign_long[NB_OF_X_REGS];
+PL_THREAD_LOCAL double pl_foreign_double[NB_OF_X_REGS];
+#ifndef PARALLEL_ENGINES
 PlLong *pl_base_fl = pl_foreign_long;   /* overwrite var of engine.c */
 double *pl_base_fd = pl_foreign_double; /* overwrite var of engine.c */
+#endif
 
 
 WamWord stack[1024 * 128];
@@ -1138,6 +1140,30 @@ void
 Pl_Allocate_Stacks(void)
 {
 }
+WamWord *
+Pl_Allocate_Engine_Stacks(InfStack *stk_tbl, size_t *p_length)
+{
+  return NULL;
+}
+void
+Pl_Free_Engine_Stacks(WamWord *addr, size_t length)
+{
+}
+void *
+Pl_Malloc_Check(size_t size, char *src_file, int src_line)
+{
+  return malloc(size);
+}
+void *
+Pl_Calloc_Check(size_t nb, size_t size, char *src_file, int src_line)
+{
+  return calloc(nb, size);
+}
+void *
+Pl_Realloc_Check(void *ptr, size_t size, char *src_file, int src_line)
+{
+  return realloc(ptr, size);
+}
 AtomInf *pl_atom_tbl;
 void FC
 Pl_Create_Choice_Point(CodePtr codep_alt, int arity)
@@ -1152,6 +1178,23 @@ void
 Pl_Fd_Reset_Solver(void)
 {
 }
+void
+Pl_GC_Reset_Trigger(void)
+{
+}
+PL_THREAD_LOCAL WamWord *pl_gc_trigger;
+PL_THREAD_LOCAL int pl_gc_lock;
+PL_THREAD_LOCAL PlLong pl_gc_nb_collections;
+PL_THREAD_LOCAL PlLong pl_gc_reclaimed;
+PL_THREAD_LOCAL PlLong pl_gc_time;
+void
+Pl_Atom_GC_Add_Root_Fct(AtomGCRootFct fct)
+{
+}
+void
+Pl_Atom_GC_Mark_Words(WamWord *adr, PlLong nb)
+{
+}
 
 void
 SIGSEGV_Handler(void)
@@ -107,6 +107,7 @@ char *file_name_out;
 Bool comment;
 Bool pic_code;
 Bool ignore_fc;
+Bool obj_file;			/* produce an object file (not assembly) ? */
 
 MapperInf mi;
 
@@ -177,6 +178,7 @@ main(int argc, char *argv[])
   mi.double_symb_prefix = "LD";
   mi.strings_need_null = FALSE;
   mi.call_c_reverse_args = FALSE;
+  mi.can_produce_obj_file = FALSE;
 
   Init_Mapper();
 
@@ -184,7 +186,7 @@ main(int argc, char *argv[])
 
   if (file_name_out == NULL)
     file_out = stdout;
-  else if ((file_out = fopen(file_name_out, "wt")) == NULL)
+  else if ((file_out = fopen(file_name_out, (obj_file) ? "wb" : "wt")) == NULL)
     {
       fprintf(stderr, "cannot open output file %s\n", file_name_out);
       exit(1);
@@ -198,6 +200,9 @@ main(int argc, char *argv[])
 #endif
   
   Label_Gen_Init(&lg_cont, "cont");	/* available for any mapper */
+
+  if (obj_file)
+    Obj_Start();
   
   Asm_Start();
 
@@ -254,6 +259,9 @@ main(int argc, char *argv[])
 
   Asm_Stop();
 
+  if (obj_file)
+    Obj_Stop(file_out);
+
   if (file_out != stdout)
     fclose(file_out);
 
@@ -794,12 +802,22 @@ Label_Printf(char *label, ...)
 {
   va_list arg_ptr;
 
+  static char buff[4096];
+
   va_start(arg_ptr, label);
 
-  vfprintf(file_out, label, arg_ptr);
+  if (obj_file)
+    {
+      vsnprintf(buff, sizeof(buff), label, arg_ptr);
+      Obj_Line(buff);
+    }
+  else
+    {
+      vfprintf(file_out, label, arg_ptr);
+      fputc('\n', file_out);
+    }
 
   va_end(arg_ptr);
-  fputc('\n', file_out);
 }
 
 
@@ -814,13 +832,23 @@ Inst_Printf(char *op, char *operands, ...)
 {
   va_list arg_ptr;
 
+  static char buff[4096];
+
   va_start(arg_ptr, operands);
 
-  fprintf(file_out, "\t%s\t", op);
-  vfprintf(file_out, operands, arg_ptr);
+  if (obj_file)
+    {
+      vsnprintf(buff, sizeof(buff), operands, arg_ptr);
+      Obj_Inst(op, buff);
+    }
+  else
+    {
+      fprintf(file_out, "\t%s\t", op);
+      vfprintf(file_out, operands, arg_ptr);
+      fputc('\n', file_out);
+    }
 
   va_end(arg_ptr);
-  fputc('\n', file_out);
 }
 
 
@@ -833,7 +861,10 @@ Inst_Printf(char *op, char *operands, ...)
 void
 Inst_Out(char *op, char *operands)
 {
-  fprintf(file_out, "\t%s\t%s\n", op, operands);
+  if (obj_file)
+    Obj_Inst(op, operands);
+  else
+    fprintf(file_out, "\t%s\t%s\n", op, operands);
 }
 
 
@@ -896,6 +927,7 @@ Parse_Arguments(int argc, char *argv[])
   comment = FALSE;
   pic_code = FALSE;
   ignore_fc = FALSE;
+  obj_file = FALSE;
 
   for (i = 1; i < argc; i++)
     {
@@ -922,6 +954,17 @@ Parse_Arguments(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "--direct-obj"))
+	    {
+	      if (!mi.can_produce_obj_file)
+		{
+		  fprintf(stderr, "option %s not available - cannot produce an object file for this architecture\n", argv[i]);
+		  exit(1);
+		}
+	      obj_file = TRUE;
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--ignore-fast"))
 	    {
 	      ignore_fc = TRUE;
@@ -967,9 +1010,9 @@ Parse_Arguments(int argc, char *argv[])
       strcpy(str, file_name_in);
       i = (int) strlen(str);
       if (strcmp(str + i - 3, ".ma") == 0)
-	strcpy(str + i - 3, DEFAULT_OUTPUT_SUFFIX);
+	strcpy(str + i - 3, (obj_file) ? OBJ_SUFFIX : DEFAULT_OUTPUT_SUFFIX);
       else
-	strcpy(str + i, DEFAULT_OUTPUT_SUFFIX);
+	strcpy(str + i, (obj_file) ? OBJ_SUFFIX : DEFAULT_OUTPUT_SUFFIX);
       file_name_out = str;
     }
 
@@ -993,6 +1036,7 @@ Display_Help(void)
   L("Options:");
   L("  -o FILE, --output FILE      set output file name");
   L("  --pic, -fPIC, --dynamic     produce position independent code (PIC)");
+  L("  --direct-obj                produce an object file (no assembler needed)");
   L("  --ignore-fast               ignore fast call (FC) declarations");
   L("  --comment                   include comments in the output file");
   L("  -h, --help                  print this help and exit");
@@ -124,6 +124,37 @@
 
 #error __FILE__ " no MA mapper file included"
 
+#endif
+
+
+	  /* include the object file emitter (if any) */
+
+#if defined(M_x86_64) && defined(__ELF__) && !defined(M_darwin)
+
+#include "x86_64_elf.c"
+
+#else
+
+void
+Obj_Start(void)
+{
+}
+
+void
+Obj_Line(char *line)
+{
+}
+
+void
+Obj_Inst(char *op, char *operands)
+{
+}
+
+void
+Obj_Stop(FILE *f)
+{
+}
+
 #endif
 
 
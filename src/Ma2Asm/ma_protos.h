@@ -36,6 +36,8 @@
  *-------------------------------------------------------------------------*/
 
 
+#include <stdio.h>
+
 #include "../EnginePl/pl_long.h" /* ensure stdint.h */
 #include "../EnginePl/bool.h"
 
@@ -69,6 +71,7 @@ typedef struct
   char *double_symb_prefix;
   Bool strings_need_null;
   Bool call_c_reverse_args;
+  Bool can_produce_obj_file;	/* can encode the code itself (see Obj_Xxx) */
 }
 MapperInf;
 
@@ -178,6 +181,7 @@ extern int nb_appox_inst_line;	 /* total (at end of first pass) */
 
 extern Bool comment;
 extern Bool pic_code;
+extern Bool obj_file;
 extern MapperInf mi;
 extern LabelGen lg_cont;	/* used by macros Label_Cont_XXX() below */
 
@@ -250,6 +254,17 @@ void String_Out(char *s);
 void Int_Out(int d);
 
 
+	  /* defined in ma2asm_inst.c (direct object file emission) */
+
+void Obj_Start(void);
+
+void Obj_Line(char *line);
+
+void Obj_Inst(char *op, char *operands);
+
+void Obj_Stop(FILE *f);
+
+
 	  /* defined in each mappers used by parser and ma2asm */
 
 void Init_Mapper(void);
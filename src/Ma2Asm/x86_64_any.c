@@ -201,6 +201,10 @@ void Init_Mapper(void)
 
   mi.strings_need_null = FALSE;
   mi.call_c_reverse_args = FALSE;
+
+#if defined(__ELF__) && !defined(M_darwin)
+  mi.can_produce_obj_file = TRUE;
+#endif
 }
 
 
@@ -826,6 +830,17 @@ Call_C_Arg_Foreign_L(int offset, Bool adr_of, int index)
 {
   BEFORE_ARG;
 
+#ifdef PARALLEL_ENGINES		/* thread-local: offset from %fs (initial-exec) */
+  Inst_Printf("movq", UN "pl_foreign_long@GOTTPOFF(%%rip), %s", r_aux);
+  if (adr_of)
+    {
+      Inst_Printf("addq", "%%fs:0, %s", r_aux);
+      if (index != 0)
+	Inst_Printf("addq", "$%d, %s", index * 8, r_aux);
+    }
+  else
+    Inst_Printf("movq", "%%fs:%d(%s), %s", index * 8, r_aux, r_aux);
+#else
   if (pic_code)
     {
       Inst_Printf("movq", UN "pl_foreign_long@GOTPCREL(%%rip), %s", r_aux);
@@ -851,6 +866,7 @@ Call_C_Arg_Foreign_L(int offset, Bool adr_of, int index)
 	  Inst_Printf("movq", UN "pl_foreign_long+%d(%%rip), %s", index * 8, r_aux);
 	}
     }
+#endif
 
   AFTER_ARG;
 
@@ -869,6 +885,12 @@ Call_C_Arg_Foreign_D(int offset, Bool adr_of, int index)
     {
       BEFORE_ARG;
 
+#ifdef PARALLEL_ENGINES
+      Inst_Printf("movq", UN "pl_foreign_double@GOTTPOFF(%%rip), %s", r_aux);
+      Inst_Printf("addq", "%%fs:0, %s", r_aux);
+      if (index != 0)
+	Inst_Printf("addq", "$%d, %s", index * 8, r_aux);
+#else
       if (pic_code)
 	{
 	  Inst_Printf("movq", UN "pl_foreign_double@GOTPCREL(%%rip), %s", r_aux);
@@ -882,6 +904,7 @@ Call_C_Arg_Foreign_D(int offset, Bool adr_of, int index)
 	  else
 	    Inst_Printf("movq", "$" UN "pl_foreign_double+%d, %s", index * 8, r_aux);
 	}
+#endif
       
       AFTER_ARG;
       return 1;
@@ -889,6 +912,10 @@ Call_C_Arg_Foreign_D(int offset, Bool adr_of, int index)
 
   BEFORE_ARG_DOUBLE;
 
+#ifdef PARALLEL_ENGINES
+  Inst_Printf("movq", UN "pl_foreign_double@GOTTPOFF(%%rip), %%r10");
+  Inst_Printf("movsd", "%%fs:%d(%%r10), %s", index * 8, r_aux);
+#else
   if (pic_code)
     {
       Inst_Printf("movq", UN "pl_foreign_double@GOTPCREL(%%rip), %%r10");
@@ -898,6 +925,7 @@ Call_C_Arg_Foreign_D(int offset, Bool adr_of, int index)
     {
       Inst_Printf("movsd", UN "pl_foreign_double+%d(%%rip), %s", index * 8, r_aux);
     }
+#endif
   
   AFTER_ARG_DOUBLE;
 
@@ -1018,6 +1046,10 @@ Move_Ret_To_Reg_Y(int index)
 void
 Move_Ret_To_Foreign_L(int index)
 {
+#ifdef PARALLEL_ENGINES
+  Inst_Printf("movq", UN "pl_foreign_long@GOTTPOFF(%%rip), " "%%r10");
+  Inst_Printf("movq", "%%rax, " "%%fs:%d(%%r10)", index * 8);
+#else
   if (pic_code)
     {
       Inst_Printf("movq", UN "pl_foreign_long@GOTPCREL(%%rip), " "%%r10");
@@ -1027,6 +1059,7 @@ Move_Ret_To_Foreign_L(int index)
     {
       Inst_Printf("movq", "%%rax, " UN "pl_foreign_long+%d(%%rip)", index * 8);
     }
+#endif
 }
 
 
@@ -1039,6 +1072,10 @@ Move_Ret_To_Foreign_L(int index)
 void
 Move_Ret_To_Foreign_D(int index)
 {
+#ifdef PARALLEL_ENGINES
+  Inst_Printf("movq", UN "pl_foreign_double@GOTTPOFF(%%rip), " "%%r10");
+  Inst_Printf("movsd", "%%xmm0, " "%%fs:%d(%%r10)", index * 8);
+#else
   if (pic_code)
     {
       Inst_Printf("movq", UN "pl_foreign_double@GOTPCREL(%%rip), " "%%r10");
@@ -1048,6 +1085,7 @@ Move_Ret_To_Foreign_D(int index)
     {
       Inst_Printf("movsd", "%%xmm0, " UN "pl_foreign_double+%d(%%rip)", index * 8);
     }
+#endif
 }
 
 
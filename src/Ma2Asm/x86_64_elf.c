@@ -0,0 +1,2411 @@
+/*-------------------------------------------------------------------------*
+ * GNU Prolog                                                              *
+ *                                                                         *
+ * Part  : mini-assembler to assembler translator                          *
+ * File  : x86_64_elf.c                                                    *
+ * Descr.: direct ELF object file emission for AMD x86-64                  *
+ * Author: Daniel Diaz                                                     *
+ *                                                                         *
+ * Copyright (C) 1999-2025 Daniel Diaz                                     *
+ *                                                                         *
+ * This file is part of GNU Prolog                                         *
+ *                                                                         *
+ * GNU Prolog is free software: you can redistribute it and/or             *
+ * modify it under the terms of either:                                    *
+ *                                                                         *
+ *   - the GNU Lesser General Public License as published by the Free      *
+ *     Software Foundation; either version 3 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or                                                                      *
+ *                                                                         *
+ *   - the GNU General Public License as published by the Free             *
+ *     Software Foundation; either version 2 of the License, or (at your   *
+ *     option) any later version.                                          *
+ *                                                                         *
+ * or both in parallel, as here.                                           *
+ *                                                                         *
+ * GNU Prolog is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU       *
+ * General Public License for more details.                                *
+ *                                                                         *
+ * You should have received copies of the GNU General Public License and   *
+ * the GNU Lesser General Public License along with this program.  If      *
+ * not, see http://www.gnu.org/licenses/.                                  *
+ *-------------------------------------------------------------------------*/
+
+#include <stdarg.h>
+#include <ctype.h>
+
+#define MAP_KEY_TYPE char *
+#define MAP_KEY_CMP(x, y) strcmp(x, y)
+#define MAP_VALUE_TYPE int
+#define MAP_NAME map_osym
+#include "../Tools/map_rbtree.h"
+
+/* This file is included by ma2asm_inst.c after x86_64_any.c.
+ *
+ * With ma2asm --direct-obj, the lines produced by the mapper (via
+ * Inst_Printf and Label_Printf) are not written in an assembly file but
+ * passed to Obj_Inst/Obj_Line which encode them and build an ELF
+ * relocatable object (written by Obj_Stop). Thus the mapper is unchanged
+ * and the produced code is the one the assembler would produce from the
+ * assembly file.
+ *
+ * Only the subset of the AT&T syntax used by x86_64_any.c is recognized
+ * (64-bit general registers, %xmm registers, disp(%reg) and
+ * symbol+disp(%rip) memory operands, the %fs segment, @PLT, @GOTPCREL and
+ * @GOTTPOFF modifiers, and the directives of an ELF target). Anything else
+ * is reported as an error.
+ *
+ * Like gas, jumps to a label of the same section are relaxed (a short
+ * jump is used when the target is close enough), references to local
+ * labels are resolved (or replaced by a relocation against the section
+ * symbol) and references to other symbols give rise to relocations.
+ */
+
+
+
+
+/*---------------------------------*
+ * Constants                       *
+ *---------------------------------*/
+
+	  /* ELF constants (to not depend on <elf.h>) */
+
+#define ELF_SHT_PROGBITS           1
+#define ELF_SHT_SYMTAB             2
+#define ELF_SHT_STRTAB             3
+#define ELF_SHT_RELA               4
+#define ELF_SHT_NOTE               7
+#define ELF_SHT_NOBITS             8
+
+#define ELF_SHF_WRITE              0x1
+#define ELF_SHF_ALLOC              0x2
+#define ELF_SHF_EXECINSTR          0x4
+#define ELF_SHF_MERGE              0x10
+#define ELF_SHF_STRINGS            0x20
+#define ELF_SHF_INFO_LINK          0x40
+
+#define ELF_STB_LOCAL              0
+#define ELF_STB_GLOBAL             1
+
+#define ELF_STT_NOTYPE             0
+#define ELF_STT_OBJECT             1
+#define ELF_STT_FUNC               2
+#define ELF_STT_SECTION            3
+#define ELF_STT_TLS                6
+
+#define ELF_SHN_UNDEF              0
+#define ELF_SHN_COMMON             0xfff2
+
+#define ELF_EM_X86_64              62
+
+#define R_X86_64_64                1
+#define R_X86_64_PC32              2
+#define R_X86_64_PLT32             4
+#define R_X86_64_GOTPCREL          9
+#define R_X86_64_32S               11
+#define R_X86_64_GOTTPOFF          22
+
+#define ELF_EHDR_SIZE              64
+#define ELF_SHDR_SIZE              64
+#define ELF_SYM_SIZE               24
+#define ELF_RELA_SIZE              24
+
+
+	  /* registers */
+
+#define REG_NONE                   -1
+#define REG_RIP                    16
+
+
+	  /* operand kinds */
+
+#define OPND_REG                   0 /* general register */
+#define OPND_XMM                   1 /* SSE register */
+#define OPND_IMM                   2 /* $expr */
+#define OPND_MEM                   3 /* expr(%reg) or expr (absolute) */
+#define OPND_SYM                   4 /* expr as branch target */
+
+
+	  /* segment override prefixes */
+
+#define SEG_NONE                   0
+#define SEG_FS                     0x64
+
+
+	  /* symbol modifiers */
+
+#define MODIF_NONE                 0
+#define MODIF_PLT                  1
+#define MODIF_GOTPCREL             2
+#define MODIF_GOTTPOFF             3
+
+
+	  /* fixup kinds (resolved or turned into relocations at the end) */
+
+#define FIX_PCREL                  0 /* 32-bit PC-relative data reference */
+#define FIX_CALL                   1 /* 32-bit PC-relative call target */
+#define FIX_PLT                    2 /* 32-bit PC-relative via the PLT */
+#define FIX_GOTPCREL               3 /* 32-bit PC-relative GOT entry */
+#define FIX_ABS32S                 4 /* 32-bit sign-extended absolute */
+#define FIX_ABS64                  5 /* 64-bit absolute */
+#define FIX_GOTTPOFF               6 /* 32-bit PC-relative GOT entry (TLS offset) */
+
+
+	  /* variable part of a fragment */
+
+#define VAR_NONE                   0
+#define VAR_ALIGN                  1
+#define VAR_BRANCH                 2
+
+#define COND_JMP                   -1 /* cond of an unconditional branch */
+
+
+#define SECT_UNDEF                 -1
+#define SECT_COMMON                -2
+
+
+
+
+/*---------------------------------*
+ * Type Definitions                *
+ *---------------------------------*/
+
+typedef struct
+{
+  unsigned char *data;
+  PlULong size;
+  PlULong max_size;
+}
+ObjBuff;
+
+
+typedef struct			/* a fixed part followed by a variable part */
+{
+  PlULong fix_start;		/* start of the fixed part in the section data */
+  PlULong fix_size;		/* size of the fixed part */
+  int var_type;			/* VAR_NONE, VAR_ALIGN or VAR_BRANCH */
+  int align;			/* VAR_ALIGN: alignment (power of 2) */
+  int max_skip;			/* VAR_ALIGN: max number of padding bytes */
+  int cond;			/* VAR_BRANCH: condition code or COND_JMP */
+  int sym;			/* VAR_BRANCH: target symbol */
+  PlLong addend;		/* VAR_BRANCH: target offset */
+  Bool is_long;			/* VAR_BRANCH: is a rel32 branch ? */
+  PlULong address;		/* computed: address of the fragment */
+  PlULong var_size;		/* computed: size of the variable part */
+}
+ObjFrag;
+
+
+typedef struct
+{
+  char *name;
+  int type;			/* ELF_SHT_xxx */
+  PlULong flags;		/* ELF_SHF_xxx */
+  PlULong entsize;
+  int align;
+  ObjBuff data;			/* fixed parts (not used for NOBITS) */
+  PlULong bss_size;		/* size of a NOBITS section */
+  ObjFrag *frag;
+  int nb_frag;
+  int max_frag;
+  ObjBuff rela;			/* final relocations */
+  int nb_rela;
+  ObjBuff image;		/* final contents */
+  int elf_index;
+  int rela_elf_index;
+  int sym_index;		/* index of the section symbol */
+}
+ObjSection;
+
+
+typedef struct
+{
+  char *name;
+  int sect;			/* section no, SECT_UNDEF or SECT_COMMON */
+  int frag;			/* defining fragment */
+  PlULong offset;		/* offset in the fixed part of the fragment */
+  PlULong size;
+  PlULong comm_align;
+  int type;			/* ELF_STT_xxx */
+  Bool global;
+  Bool local;			/* declared with .local */
+  Bool in_symtab;		/* needs an entry in the symbol table */
+  int elf_index;
+}
+ObjSymbol;
+
+
+typedef struct
+{
+  int sect;
+  int frag;
+  PlULong offset;		/* offset in the fixed part of the fragment */
+  int kind;			/* FIX_xxx */
+  int sym;
+  PlLong addend;
+  int size;			/* 4 or 8 bytes */
+}
+ObjFixup;
+
+
+typedef struct
+{
+  int kind;			/* OPND_xxx */
+  Bool indirect;		/* prefixed by '*' */
+  int reg;			/* register / base register (REG_NONE, REG_RIP) */
+  PlLong val;			/* immediate value or displacement */
+  int sym;			/* symbol (or -1) */
+  int modif;			/* MODIF_xxx */
+  int seg;			/* SEG_xxx (memory operand) */
+}
+Operand;
+
+
+
+
+/*---------------------------------*
+ * Global Variables                *
+ *---------------------------------*/
+
+static ObjSection *obj_sect;
+static int obj_nb_sect;
+static int obj_max_sect;
+static int obj_cur_sect;
+
+static ObjSymbol *obj_sym;
+static int obj_nb_sym;
+static int obj_max_sym;
+
+static ObjFixup *obj_fix;
+static int obj_nb_fix;
+static int obj_max_fix;
+
+static struct map_rbt obj_map_sym = MAP_INIT;
+
+static char *obj_cur_line;	/* for error messages */
+
+	  /* current instruction */
+
+static unsigned char inst[32];
+static int inst_len;
+static ObjFixup inst_fix[2];	/* offset = position in inst */
+static int inst_nb_fix;
+
+
+static char *reg_name[] = {
+  "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+  "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", NULL
+};
+
+
+static struct
+{
+  char *name;
+  int cond;
+}
+cond_tbl[] = {
+  { "jo", 0x0 }, { "jno", 0x1 }, { "jb", 0x2 }, { "jc", 0x2 }, { "jnae", 0x2 },
+  { "jae", 0x3 }, { "jnb", 0x3 }, { "jnc", 0x3 }, { "je", 0x4 }, { "jz", 0x4 },
+  { "jne", 0x5 }, { "jnz", 0x5 }, { "jbe", 0x6 }, { "jna", 0x6 }, { "ja", 0x7 },
+  { "jnbe", 0x7 }, { "js", 0x8 }, { "jns", 0x9 }, { "jp", 0xa }, { "jpe", 0xa },
+  { "jnp", 0xb }, { "jpo", 0xb }, { "jl", 0xc }, { "jnge", 0xc }, { "jge", 0xd },
+  { "jnl", 0xd }, { "jle", 0xe }, { "jng", 0xe }, { "jg", 0xf }, { "jnle", 0xf },
+  { NULL, 0 }
+};
+
+
+static struct			/* ext: /digit of the imm form, op base */
+{
+  char *name;
+  int ext;
+}
+alu_tbl[] = {
+  { "add", 0 }, { "or", 1 }, { "and", 4 }, { "sub", 5 }, { "xor", 6 }, { "cmp", 7 },
+  { NULL, 0 }
+};
+
+
+	  /* the NOPs used by gas to fill the code */
+
+static unsigned char nop_tbl[][11] = {
+  { 0 },
+  { 0x90 },
+  { 0x66, 0x90 },
+  { 0x0f, 0x1f, 0x00 },
+  { 0x0f, 0x1f, 0x40, 0x00 },
+  { 0x0f, 0x1f, 0x44, 0x00, 0x00 },
+  { 0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00 },
+  { 0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00 },
+  { 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+};
+
+#define MAX_NOP_SIZE               11
+
+
+
+
+/*---------------------------------*
+ * Function Prototypes             *
+ *---------------------------------*/
+
+static void Obj_Error(char *format, ...) ATTR_PRINTF(1);
+
+static void Buff_Need(ObjBuff *b, PlULong n);
+
+static void Buff_Put(ObjBuff *b, void *p, PlULong n);
+
+static void Buff_Put_Int(ObjBuff *b, PlULong v, int size);
+
+static void Buff_Pad(ObjBuff *b, PlULong align);
+
+static int Find_Section(char *name);
+
+static int New_Section(char *name, int type, PlULong flags, PlULong entsize);
+
+static ObjFrag *Cur_Frag(ObjSection *s);
+
+static ObjFrag *New_Frag(ObjSection *s);
+
+static void Sect_Align(int align, int max_skip);
+
+static void Sect_Put(void *p, PlULong n);
+
+static int Find_Symbol(char *name);
+
+static ObjSymbol *Get_Symbol(char *name);
+
+static void New_Fixup(int kind, int sym, PlLong addend, PlULong offset, int size);
+
+static void Define_Label(char *name);
+
+static void Parse_String(char *p, Bool add_null);
+
+static void Directive(char *op, char *operands);
+
+static char *Parse_Symbol_Name(char **p);
+
+static void Parse_Expr(char *p, Operand *o);
+
+static int Parse_Operands(char *operands, Operand o[]);
+
+static void Encode_Inst(char *op, char *operands);
+
+static void Inst_Byte(int b);
+
+static void Inst_Int(PlLong v, int size);
+
+static void Inst_Fixup(int kind, int sym, PlLong addend, int size);
+
+static void Inst_Rex(Bool w, int reg, Operand *rm);
+
+static void Inst_Modrm(int reg, Operand *rm);
+
+static void Inst_Imm(Operand *o, int size);
+
+static void Inst_Flush(void);
+
+static PlULong Symbol_Value(ObjSymbol *sym);
+
+static void Relax_Section(ObjSection *s);
+
+static void Build_Image(ObjSection *s);
+
+static void Resolve_Fixup(ObjFixup *f);
+
+static void Add_Rela(ObjSection *s, PlULong offset, int sym, int type, PlLong addend);
+
+
+
+
+#define Sym_In_Sect(sym, s)       ((sym)->sect == (s))
+
+#define Is_Local_Label(name)      (strncmp(name, mi.local_symb_prefix, strlen(mi.local_symb_prefix)) == 0)
+
+#define Fits_Int8(x)              ((x) >= -128 && (x) <= 127)
+
+#define Realloc_Array(array, nb, max, type)                             \
+  do                                                                    \
+    {                                                                   \
+      if ((nb) == (max))                                                \
+        {                                                               \
+          (max) = ((max) == 0) ? 64 : (max) * 2;                        \
+          if (((array) = (type *) realloc(array, (max) * sizeof(type))) == NULL) \
+            Obj_Error("memory allocation fault");                       \
+        }                                                               \
+    }                                                                   \
+  while (0)
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OBJ_START                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Obj_Start(void)
+{
+  New_Section(".text", ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_EXECINSTR, 0);
+  New_Section(".data", ELF_SHT_PROGBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE, 0);
+  New_Section(".bss", ELF_SHT_NOBITS, ELF_SHF_ALLOC | ELF_SHF_WRITE, 0);
+  obj_cur_sect = 0;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OBJ_LINE                                                                *
+ *                                                                         *
+ * Handles a line emitted via Label_Printf (a label, a directive, a        *
+ * comment or an empty line). The line can contain several lines.          *
+ *-------------------------------------------------------------------------*/
+void
+Obj_Line(char *line)
+{
+  char *p, *q, *end;
+  char save;
+
+  for (p = line; *p; p = end)
+    {
+      if ((end = strchr(p, '\n')) == NULL)
+        end = p + strlen(p);
+
+      while (p < end && isspace(*p))
+        p++;
+
+      for (q = end; q > p && isspace(q[-1]); q--)
+        ;
+
+      save = *q;
+      *q = '\0';
+      obj_cur_line = p;
+
+      if (*p == '\0' || strncmp(p, mi.comment_prefix, strlen(mi.comment_prefix)) == 0)
+        ;
+      else if (q[-1] == ':')
+        {
+          q[-1] = '\0';
+          Define_Label(p);
+          q[-1] = ':';
+        }
+      else
+        {
+          char *op = p;
+
+          while (*p && !isspace(*p))
+            p++;
+          if (*p)
+            {
+              *p = '\0';
+              Obj_Inst(op, p + 1);
+              *p = ' ';
+            }
+          else
+            Obj_Inst(op, "");
+        }
+
+      *q = save;
+      if (*end == '\n')
+        end++;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OBJ_INST                                                                *
+ *                                                                         *
+ * Handles an instruction or a directive emitted via Inst_Printf.          *
+ *-------------------------------------------------------------------------*/
+void
+Obj_Inst(char *op, char *operands)
+{
+  static char buff[1024];
+
+  if (*op == '\0')		/* comment */
+    return;
+
+  sprintf(buff, "%s %.1000s", op, operands);
+  obj_cur_line = buff;
+
+  while (isspace(*operands))
+    operands++;
+
+  if (*op == '.')
+    Directive(op, operands);
+  else
+    Encode_Inst(op, operands);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OBJ_ERROR                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Obj_Error(char *format, ...)
+{
+  va_list arg_ptr;
+
+  fprintf(stderr, "ma2asm: cannot produce the object file: ");
+  va_start(arg_ptr, format);
+  vfprintf(stderr, format, arg_ptr);
+  va_end(arg_ptr);
+  if (obj_cur_line)
+    fprintf(stderr, " (in: %s)", obj_cur_line);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BUFF_NEED                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Buff_Need(ObjBuff *b, PlULong n)
+{
+  if (b->size + n <= b->max_size)
+    return;
+
+  do
+    b->max_size = (b->max_size == 0) ? 4096 : b->max_size * 2;
+  while (b->size + n > b->max_size);
+
+  if ((b->data = (unsigned char *) realloc(b->data, b->max_size)) == NULL)
+    Obj_Error("memory allocation fault");
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BUFF_PUT                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Buff_Put(ObjBuff *b, void *p, PlULong n)
+{
+  Buff_Need(b, n);
+  if (p)
+    memcpy(b->data + b->size, p, n);
+  else
+    memset(b->data + b->size, 0, n);
+  b->size += n;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BUFF_PUT_INT                                                            *
+ *                                                                         *
+ * Stores a little-endian integer of size bytes.                           *
+ *-------------------------------------------------------------------------*/
+static void
+Buff_Put_Int(ObjBuff *b, PlULong v, int size)
+{
+  Buff_Need(b, size);
+  while (size--)
+    {
+      b->data[b->size++] = (unsigned char) v;
+      v >>= 8;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BUFF_PAD                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Buff_Pad(ObjBuff *b, PlULong align)
+{
+  Buff_Put(b, NULL, (align - b->size % align) % align);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FIND_SECTION                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Find_Section(char *name)
+{
+  int i;
+
+  for (i = 0; i < obj_nb_sect; i++)
+    if (strcmp(obj_sect[i].name, name) == 0)
+      return i;
+
+  return -1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEW_SECTION                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static int
+New_Section(char *name, int type, PlULong flags, PlULong entsize)
+{
+  ObjSection *s;
+
+  Realloc_Array(obj_sect, obj_nb_sect, obj_max_sect, ObjSection);
+  s = obj_sect + obj_nb_sect;
+  memset(s, 0, sizeof(ObjSection));
+  s->name = strdup(name);
+  s->type = type;
+  s->flags = flags;
+  s->entsize = entsize;
+  s->align = 1;
+  New_Frag(s);
+
+  return obj_nb_sect++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CUR_FRAG                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static ObjFrag *
+Cur_Frag(ObjSection *s)
+{
+  return s->frag + s->nb_frag - 1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEW_FRAG                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static ObjFrag *
+New_Frag(ObjSection *s)
+{
+  ObjFrag *f;
+
+  Realloc_Array(s->frag, s->nb_frag, s->max_frag, ObjFrag);
+  f = s->frag + s->nb_frag++;
+  memset(f, 0, sizeof(ObjFrag));
+  f->fix_start = s->data.size;
+  f->var_type = VAR_NONE;
+
+  return f;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SECT_ALIGN                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Sect_Align(int align, int max_skip)
+{
+  ObjSection *s = obj_sect + obj_cur_sect;
+  ObjFrag *f;
+
+  if (align <= 1)
+    return;
+
+  if ((align & (align - 1)) != 0)
+    Obj_Error("alignment is not a power of 2");
+
+  if (align > s->align)
+    s->align = align;
+
+  if (s->type == ELF_SHT_NOBITS)
+    {
+      s->bss_size = (s->bss_size + align - 1) & ~((PlULong) align - 1);
+      return;
+    }
+
+  f = Cur_Frag(s);
+  f->var_type = VAR_ALIGN;
+  f->align = align;
+  f->max_skip = (max_skip <= 0 || max_skip >= align) ? align - 1 : max_skip;
+  New_Frag(s);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SECT_PUT                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Sect_Put(void *p, PlULong n)
+{
+  ObjSection *s = obj_sect + obj_cur_sect;
+
+  if (s->type == ELF_SHT_NOBITS)
+    Obj_Error("data in section %s", s->name);
+
+  Buff_Put(&s->data, p, n);
+  Cur_Frag(s)->fix_size += n;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * FIND_SYMBOL                                                             *
+ *                                                                         *
+ * Returns the index of the symbol name (created if needed).               *
+ *-------------------------------------------------------------------------*/
+static int
+Find_Symbol(char *name)
+{
+  struct map_osym_entry *entry;
+  bool created;
+  ObjSymbol *sym;
+
+  entry = map_osym_put(&obj_map_sym, name, &created);
+  if (!created)
+    return entry->value;
+
+  Realloc_Array(obj_sym, obj_nb_sym, obj_max_sym, ObjSymbol);
+  sym = obj_sym + obj_nb_sym;
+  memset(sym, 0, sizeof(ObjSymbol));
+  sym->name = strdup(name);
+  sym->sect = SECT_UNDEF;
+  sym->type = ELF_STT_NOTYPE;
+
+  entry->key = sym->name;	/* name can be a temporary buffer */
+  entry->value = obj_nb_sym;
+
+  return obj_nb_sym++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * GET_SYMBOL                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static ObjSymbol *
+Get_Symbol(char *name)
+{
+  int i = Find_Symbol(name);	/* can realloc obj_sym */
+
+  return obj_sym + i;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * NEW_FIXUP                                                               *
+ *                                                                         *
+ * offset: offset of the field in the current fixed part.                  *
+ *-------------------------------------------------------------------------*/
+static void
+New_Fixup(int kind, int sym, PlLong addend, PlULong offset, int size)
+{
+  ObjSection *s = obj_sect + obj_cur_sect;
+  ObjFixup *f;
+
+  Realloc_Array(obj_fix, obj_nb_fix, obj_max_fix, ObjFixup);
+  f = obj_fix + obj_nb_fix++;
+  f->sect = obj_cur_sect;
+  f->frag = s->nb_frag - 1;
+  f->offset = offset;
+  f->kind = kind;
+  f->sym = sym;
+  f->addend = addend;
+  f->size = size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DEFINE_LABEL                                                            *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Define_Label(char *name)
+{
+  ObjSection *s = obj_sect + obj_cur_sect;
+  ObjSymbol *sym = Get_Symbol(name);
+
+  if (sym->sect != SECT_UNDEF)
+    Obj_Error("symbol %s already defined", name);
+
+  if (s->type == ELF_SHT_NOBITS)
+    Obj_Error("label in section %s", s->name);
+
+  sym->sect = obj_cur_sect;
+  sym->frag = s->nb_frag - 1;
+  sym->offset = Cur_Frag(s)->fix_size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PARSE_STRING                                                            *
+ *                                                                         *
+ * Parses a "..." string (with the escape sequences of gas) and stores it  *
+ * in the current section.                                                 *
+ *-------------------------------------------------------------------------*/
+static void
+Parse_String(char *p, Bool add_null)
+{
+  unsigned char c;
+  int i;
+
+  if (*p++ != '"')
+    Obj_Error("string expected");
+
+  for (;;)
+    {
+      c = *p++;
+      if (c == '\0')
+        Obj_Error("unterminated string");
+
+      if (c == '"')
+        break;
+
+      if (c == '\\')
+        {
+          c = *p++;
+          switch (c)
+            {
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'v': c = '\v'; break;
+
+            case 'x': case 'X':
+              for (c = 0; isxdigit(*p); p++)
+                c = c * 16 + (isdigit(*p) ? *p - '0' : tolower(*p) - 'a' + 10);
+              break;
+
+            case '\0':
+              Obj_Error("unterminated string");
+
+            default:
+              if (c >= '0' && c <= '7')
+                {
+                  c -= '0';
+                  for (i = 1; i < 3 && *p >= '0' && *p <= '7'; i++)
+                    c = c * 8 + (*p++ - '0');
+                }
+              break;
+            }
+        }
+
+      Sect_Put(&c, 1);
+    }
+
+  if (add_null)
+    Sect_Put("", 1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * DIRECTIVE                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Directive(char *op, char *operands)
+{
+  char *p = operands;
+  char *name, *q;
+  ObjSymbol *sym;
+  ObjSection *s;
+  Operand o;
+  PlLong size, align;
+  PlULong flags, entsize;
+  int type, i;
+
+  if (strcmp(op, ".text") == 0 || strcmp(op, ".data") == 0 || strcmp(op, ".bss") == 0)
+    {
+      obj_cur_sect = Find_Section(op);
+      return;
+    }
+
+  if (strcmp(op, ".section") == 0)
+    {
+      for (q = p; *q && *q != ',' && !isspace(*q); q++)	/* can contain '-' */
+	;
+      if (q == p)
+	Obj_Error("section name expected");
+      name = strndup(p, q - p);
+      for (p = q; isspace(*p); p++)
+	;
+      if ((obj_cur_sect = Find_Section(name)) >= 0)
+	{
+	  free(name);
+	  return;
+	}
+
+      flags = 0;
+      type = ELF_SHT_PROGBITS;
+      entsize = 0;
+      if (*p == ',')
+	{
+	  p++;
+	  if (*p++ != '"')
+	    Obj_Error("section flags expected");
+	  for (; *p && *p != '"'; p++)
+	    switch (*p)
+	      {
+	      case 'a': flags |= ELF_SHF_ALLOC; break;
+	      case 'w': flags |= ELF_SHF_WRITE; break;
+	      case 'x': flags |= ELF_SHF_EXECINSTR; break;
+	      case 'M': flags |= ELF_SHF_MERGE; break;
+	      case 'S': flags |= ELF_SHF_STRINGS; break;
+	      default: Obj_Error("unknown section flag %c", *p);
+	      }
+	  if (*p == '"')
+	    p++;
+	}
+      if (*p == ',')
+	{
+	  p++;
+	  if (strncmp(p, "@progbits", 9) == 0)
+	    type = ELF_SHT_PROGBITS, p += 9;
+	  else if (strncmp(p, "@nobits", 7) == 0)
+	    type = ELF_SHT_NOBITS, p += 7;
+	  else if (strncmp(p, "@note", 5) == 0)
+	    type = ELF_SHT_NOTE, p += 5;
+	  else
+	    Obj_Error("unknown section type");
+	}
+      if (*p == ',')
+	entsize = strtol(p + 1, &p, 0);
+
+      obj_cur_sect = New_Section(name, type, flags, entsize);
+      free(name);
+      return;
+    }
+
+  if (strcmp(op, ".align") == 0 || strcmp(op, ".balign") == 0)
+    {
+      Sect_Align(strtol(p, &p, 0), -1);
+      return;
+    }
+
+  if (strcmp(op, ".p2align") == 0)
+    {
+      align = strtol(p, &p, 0);
+      size = -1;
+      if (*p == ',' && *++p != ',')	/* ignore fill value (NOPs or 0s) */
+	strtol(p, &p, 0);
+      if (*p == ',')
+	size = strtol(p + 1, &p, 0);
+      Sect_Align(1 << align, (int) size);
+      return;
+    }
+
+  if (strcmp(op, ".globl") == 0 || strcmp(op, ".global") == 0 || strcmp(op, ".local") == 0)
+    {
+      if ((name = Parse_Symbol_Name(&p)) == NULL)
+	Obj_Error("symbol expected");
+      sym = Get_Symbol(name);
+      if (op[1] == 'l')
+	sym->local = TRUE;
+      else
+	sym->global = TRUE;
+      return;
+    }
+
+  if (strcmp(op, ".type") == 0)
+    {
+      if ((name = Parse_Symbol_Name(&p)) == NULL || *p++ != ',')
+	Obj_Error("symbol expected");
+      sym = Get_Symbol(name);
+      if (strcmp(p, "@function") == 0)
+	sym->type = ELF_STT_FUNC;
+      else if (strcmp(p, "@object") == 0)
+	sym->type = ELF_STT_OBJECT;
+      else
+	Obj_Error("unknown symbol type");
+      return;
+    }
+
+  if (strcmp(op, ".size") == 0)
+    {
+      if ((name = Parse_Symbol_Name(&p)) == NULL || *p++ != ',')
+	Obj_Error("symbol expected");
+      sym = Get_Symbol(name);
+      sym->size = strtol(p, &q, 0);
+      if (*q)
+	Obj_Error("constant size expected");
+      return;
+    }
+
+  if (strcmp(op, ".comm") == 0 || strcmp(op, ".lcomm") == 0)
+    {
+      if ((name = Parse_Symbol_Name(&p)) == NULL || *p++ != ',')
+	Obj_Error("symbol expected");
+      sym = Get_Symbol(name);
+      size = strtol(p, &p, 0);
+      align = (*p == ',') ? strtol(p + 1, &p, 0) : 1;
+      if (sym->sect != SECT_UNDEF)
+	Obj_Error("symbol %s already defined", sym->name);
+
+      sym->size = size;
+      sym->type = ELF_STT_OBJECT;
+      if (sym->local || op[1] == 'l')	/* local common: allocate in .bss */
+	{
+	  i = obj_cur_sect;
+	  obj_cur_sect = Find_Section(".bss");
+	  s = obj_sect + obj_cur_sect;
+	  Sect_Align((int) align, -1);
+	  sym->sect = obj_cur_sect;
+	  sym->frag = -1;
+	  sym->offset = s->bss_size;
+	  s->bss_size += size;
+	  obj_cur_sect = i;
+	}
+      else
+	{
+	  sym->sect = SECT_COMMON;
+	  sym->comm_align = align;
+	  sym->global = TRUE;
+	}
+      return;
+    }
+
+  if (strcmp(op, ".string") == 0 || strcmp(op, ".asciz") == 0 || strcmp(op, ".ascii") == 0)
+    {
+      Parse_String(p, op[3] != 'c');
+      return;
+    }
+
+  if (strcmp(op, ".zero") == 0 || strcmp(op, ".skip") == 0 || strcmp(op, ".space") == 0)
+    {
+      size = strtol(p, &q, 0);
+      if (obj_sect[obj_cur_sect].type == ELF_SHT_NOBITS)
+	obj_sect[obj_cur_sect].bss_size += size;
+      else
+	Sect_Put(NULL, size);
+      return;
+    }
+
+  if (strcmp(op, ".byte") == 0 || strcmp(op, ".short") == 0 ||
+      strcmp(op, ".long") == 0 || strcmp(op, ".quad") == 0)
+    {
+      size = (op[1] == 'b') ? 1 : (op[1] == 's') ? 2 : (op[1] == 'l') ? 4 : 8;
+      for (;;)
+	{
+	  q = strchr(p, ',');
+	  if (q)
+	    *q = '\0';
+	  Parse_Expr(p, &o);
+	  if (q)
+	    *q = ',';
+	  if (o.sym >= 0)
+	    {
+	      if (size != 8 || o.modif != MODIF_NONE)
+		Obj_Error("unsupported relocation");
+	      New_Fixup(FIX_ABS64, o.sym, o.val,
+			Cur_Frag(obj_sect + obj_cur_sect)->fix_size, 8);
+	      o.val = 0;
+	    }
+	  Buff_Put_Int(&obj_sect[obj_cur_sect].data, (PlULong) o.val, (int) size);
+	  Cur_Frag(obj_sect + obj_cur_sect)->fix_size += size;
+	  if (q == NULL)
+	    break;
+	  p = q + 1;
+	}
+      return;
+    }
+
+  Obj_Error("unknown directive %s", op);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PARSE_SYMBOL_NAME                                                       *
+ *                                                                         *
+ * Parses a symbol name at *p (skipping spaces). Updates *p and returns a  *
+ * static copy of the name (or NULL if no symbol is found).                *
+ *-------------------------------------------------------------------------*/
+static char *
+Parse_Symbol_Name(char **p)
+{
+  static char name[1024];
+  char *q = *p;
+  int n = 0;
+
+  while (isspace(*q))
+    q++;
+
+  if (!isalpha(*q) && *q != '_' && *q != '.' && *q != '$')
+    return NULL;
+
+  while ((isalnum(*q) || *q == '_' || *q == '.' || *q == '$') && n < (int) sizeof(name) - 1)
+    name[n++] = *q++;
+  name[n] = '\0';
+
+  while (isspace(*q))
+    q++;
+
+  *p = q;
+  return name;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PARSE_EXPR                                                              *
+ *                                                                         *
+ * Parses [symbol[@modif]] {(+|-) integer} or integer.                     *
+ *-------------------------------------------------------------------------*/
+static void
+Parse_Expr(char *p, Operand *o)
+{
+  char *name;
+  PlLong n;
+
+  o->sym = -1;
+  o->val = 0;
+  o->modif = MODIF_NONE;
+
+  if ((name = Parse_Symbol_Name(&p)) != NULL)
+    {
+      o->sym = Find_Symbol(name);
+      if (*p == '@')
+	{
+	  if (strncmp(p, "@PLT", 4) == 0)
+	    o->modif = MODIF_PLT, p += 4;
+	  else if (strncmp(p, "@GOTPCREL", 9) == 0)
+	    o->modif = MODIF_GOTPCREL, p += 9;
+	  else if (strncmp(p, "@GOTTPOFF", 9) == 0)
+	    o->modif = MODIF_GOTTPOFF, p += 9;
+	  else
+	    Obj_Error("unknown symbol modifier");
+	}
+    }
+
+  for (;;)
+    {
+      while (isspace(*p))
+	p++;
+      if (*p == '\0')
+	break;
+
+      if (*p == '+')
+	p++;
+      else if (*p != '-' && (o->sym >= 0 || o->val != 0 || !isdigit(*p)))
+	Obj_Error("invalid expression");
+
+      n = Str_To_PlLong(p, &p, 0);
+      o->val += n;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * PARSE_OPERANDS                                                          *
+ *                                                                         *
+ * Returns the number of operands.                                         *
+ *-------------------------------------------------------------------------*/
+static int
+Parse_Operands(char *operands, Operand o[])
+{
+  static char buff[1024];
+  char *p, *q, *r;
+  int n = 0;
+  int level;
+  int i;
+
+  strncpy(buff, operands, sizeof(buff) - 1);
+  buff[sizeof(buff) - 1] = '\0';
+
+  for (p = buff; *p; n++)
+    {
+      if (n == 3)
+	Obj_Error("too many operands");
+
+      while (isspace(*p))
+	p++;
+
+      for (q = p, level = 0; *q && (*q != ',' || level > 0); q++)
+	if (*q == '(')
+	  level++;
+	else if (*q == ')')
+	  level--;
+
+      if (*q)
+	*q++ = '\0';
+      for (r = p + strlen(p); r > p && isspace(r[-1]); r--)
+	;
+      *r = '\0';
+
+      o[n].indirect = (*p == '*');
+      if (o[n].indirect)
+	p++;
+
+      o[n].reg = REG_NONE;
+      o[n].sym = -1;
+      o[n].val = 0;
+      o[n].modif = MODIF_NONE;
+      o[n].seg = SEG_NONE;
+
+      if (strncmp(p, "%fs:", 4) == 0)	/* thread-local data */
+	{
+	  o[n].seg = SEG_FS;
+	  p += 4;
+	  if (strchr(p, '(') == NULL)
+	    {
+	      o[n].kind = OPND_MEM;	/* absolute address */
+	      Parse_Expr(p, o + n);
+	      p = q;
+	      continue;
+	    }
+	}
+
+      if (*p == '%')
+	{
+	  p++;
+	  if (strncmp(p, "xmm", 3) == 0)
+	    {
+	      o[n].kind = OPND_XMM;
+	      o[n].reg = strtol(p + 3, &r, 10);
+	      if (*r || o[n].reg > 15)
+		Obj_Error("unknown register %%%s", p);
+	    }
+	  else
+	    {
+	      o[n].kind = OPND_REG;
+	      for (i = 0; reg_name[i] && strcmp(reg_name[i], p) != 0; i++)
+		;
+	      if (reg_name[i] == NULL)
+		Obj_Error("unknown register %%%s", p);
+	      o[n].reg = i;
+	    }
+	}
+      else if (*p == '$')
+	{
+	  o[n].kind = OPND_IMM;
+	  Parse_Expr(p + 1, o + n);
+	}
+      else if ((r = strchr(p, '(')) != NULL)
+	{
+	  o[n].kind = OPND_MEM;
+	  *r++ = '\0';
+	  Parse_Expr(p, o + n);
+	  if (*r++ != '%' || (p = strchr(r, ')')) == NULL || p[1] != '\0')
+	    Obj_Error("unsupported memory operand");
+	  *p = '\0';
+	  if (strcmp(r, "rip") == 0)
+	    o[n].reg = REG_RIP;
+	  else
+	    {
+	      for (i = 0; reg_name[i] && strcmp(reg_name[i], r) != 0; i++)
+		;
+	      if (reg_name[i] == NULL)
+		Obj_Error("unknown register %%%s", r);
+	      o[n].reg = i;
+	    }
+	}
+      else
+	{
+	  o[n].kind = OPND_SYM;	/* branch target or absolute address */
+	  Parse_Expr(p, o + n);
+	}
+
+      p = q;
+    }
+
+  for (i = 0; i < n; i++)	/* the segment prefix comes first (as gas) */
+    if (o[i].seg != SEG_NONE)
+      Inst_Byte(o[i].seg);
+
+  return n;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_BYTE                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Byte(int b)
+{
+  inst[inst_len++] = (unsigned char) b;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_INT                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Int(PlLong v, int size)
+{
+  while (size--)
+    {
+      inst[inst_len++] = (unsigned char) v;
+      v >>= 8;
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_FIXUP                                                              *
+ *                                                                         *
+ * Records a fixup for a field starting at the current position.           *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Fixup(int kind, int sym, PlLong addend, int size)
+{
+  ObjFixup *f = inst_fix + inst_nb_fix++;
+
+  f->kind = kind;
+  f->sym = sym;
+  f->addend = addend;
+  f->offset = inst_len;
+  f->size = size;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_REX                                                                *
+ *                                                                         *
+ * Emits the REX prefix (if needed). reg is the register (or the opcode    *
+ * extension) of the ModRM reg field, rm is the r/m operand (or NULL).     *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Rex(Bool w, int reg, Operand *rm)
+{
+  int rex = 0x40;
+
+  if (w)
+    rex |= 8;
+
+  if (reg & 8)
+    rex |= 4;
+
+  if (rm && rm->reg >= 0 && rm->reg < 16 && (rm->reg & 8))
+    rex |= 1;
+
+  if (rex != 0x40)
+    Inst_Byte(rex);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_MODRM                                                              *
+ *                                                                         *
+ * Emits the ModRM byte (and SIB, displacement) for a reg field and an     *
+ * r/m operand (a register or a memory operand).                           *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Modrm(int reg, Operand *rm)
+{
+  int base, mod;
+
+  reg = (reg & 7) << 3;
+
+  if (rm->kind == OPND_REG || rm->kind == OPND_XMM)
+    {
+      Inst_Byte(0xc0 | reg | (rm->reg & 7));
+      return;
+    }
+
+  if (rm->kind != OPND_MEM && rm->kind != OPND_SYM)
+    Obj_Error("invalid operand");
+
+  if (rm->reg == REG_RIP)
+    {
+      Inst_Byte(0x05 | reg);
+      Inst_Fixup((rm->modif == MODIF_GOTPCREL) ? FIX_GOTPCREL :
+		 (rm->modif == MODIF_GOTTPOFF) ? FIX_GOTTPOFF : FIX_PCREL,
+		 rm->sym, rm->val, 4);
+      Inst_Int(0, 4);
+      return;
+    }
+
+  if (rm->modif != MODIF_NONE)
+    Obj_Error("symbol modifier needs %%rip");
+
+  if (rm->reg == REG_NONE)	/* absolute address: disp32 via SIB */
+    {
+      Inst_Byte(0x04 | reg);
+      Inst_Byte(0x25);
+      if (rm->sym >= 0)
+	{
+	  Inst_Fixup(FIX_ABS32S, rm->sym, rm->val, 4);
+	  Inst_Int(0, 4);
+	}
+      else
+	Inst_Int(rm->val, 4);
+      return;
+    }
+
+  if (rm->sym >= 0)
+    Obj_Error("symbolic displacement with a base register");
+
+  if (!LITTLE_INT(rm->val))
+    Obj_Error("displacement too large");
+
+  base = rm->reg & 7;
+  if (rm->val == 0 && base != 5)	/* rbp/r13 need a displacement */
+    mod = 0;
+  else if (Fits_Int8(rm->val))
+    mod = 1;
+  else
+    mod = 2;
+
+  Inst_Byte((mod << 6) | reg | base);
+  if (base == 4)		/* rsp/r12 need a SIB */
+    Inst_Byte(0x24);
+
+  if (mod == 1)
+    Inst_Int(rm->val, 1);
+  else if (mod == 2)
+    Inst_Int(rm->val, 4);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_IMM                                                                *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Imm(Operand *o, int size)
+{
+  if (o->sym >= 0)
+    {
+      if (o->modif != MODIF_NONE)
+	Obj_Error("unsupported symbol modifier");
+      Inst_Fixup((size == 8) ? FIX_ABS64 : FIX_ABS32S, o->sym, o->val, size);
+      Inst_Int(0, size);
+      return;
+    }
+
+  if (size == 4 && !LITTLE_INT(o->val))
+    Obj_Error("immediate too large");
+
+  Inst_Int(o->val, size);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * INST_FLUSH                                                              *
+ *                                                                         *
+ * Copies the current instruction in the section (with its fixups). The    *
+ * addend of a PC-relative field is relative to the end of the field while *
+ * the CPU uses the end of the instruction (they differ with an immediate).*
+ *-------------------------------------------------------------------------*/
+static void
+Inst_Flush(void)
+{
+  ObjSection *s = obj_sect + obj_cur_sect;
+  PlULong start = Cur_Frag(s)->fix_size;
+  ObjFixup *f;
+  int i;
+
+  if (s->type == ELF_SHT_NOBITS)
+    Obj_Error("code in section %s", s->name);
+
+  for (i = 0; i < inst_nb_fix; i++)
+    {
+      f = inst_fix + i;
+      if (f->kind != FIX_ABS32S && f->kind != FIX_ABS64)
+	f->addend -= inst_len - f->offset;
+      New_Fixup(f->kind, f->sym, f->addend, start + f->offset, f->size);
+    }
+
+  Sect_Put(inst, inst_len);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ENCODE_INST                                                             *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+static void
+Encode_Inst(char *op, char *operands)
+{
+  static char mnemo[32];
+  Operand o[3];
+  Operand *src = o, *dst = o + 1;
+  ObjSection *s;
+  ObjFrag *f;
+  int n, l, i;
+
+  inst_len = 0;
+  inst_nb_fix = 0;
+
+  n = Parse_Operands(operands, o);
+
+  for (i = 0; cond_tbl[i].name && strcmp(cond_tbl[i].name, op) != 0; i++)
+    ;
+
+  if (cond_tbl[i].name || strcmp(op, "jmp") == 0)
+    {
+      if (n != 1)
+	Obj_Error("one operand expected");
+
+      if (src->indirect)
+	{
+	  if (cond_tbl[i].name)
+	    Obj_Error("indirect conditional jump");
+	  Inst_Rex(FALSE, 4, src);
+	  Inst_Byte(0xff);
+	  Inst_Modrm(4, src);
+	  Inst_Flush();
+	  return;
+	}
+
+      if (src->kind != OPND_SYM || src->sym < 0)
+	Obj_Error("jump target expected");
+
+      if (src->modif == MODIF_PLT)
+	{
+	  if (cond_tbl[i].name)
+	    {
+	      Inst_Byte(0x0f);
+	      Inst_Byte(0x80 | cond_tbl[i].cond);
+	    }
+	  else
+	    Inst_Byte(0xe9);
+	  Inst_Fixup(FIX_PLT, src->sym, src->val, 4);
+	  Inst_Int(0, 4);
+	  Inst_Flush();
+	  return;
+	}
+
+      if (src->modif != MODIF_NONE)
+	Obj_Error("unsupported symbol modifier");
+
+      /* a relaxable branch: the variable part of the current fragment */
+      s = obj_sect + obj_cur_sect;
+      f = Cur_Frag(s);
+      f->var_type = VAR_BRANCH;
+      f->cond = (cond_tbl[i].name) ? cond_tbl[i].cond : COND_JMP;
+      f->sym = src->sym;
+      f->addend = src->val;
+      New_Frag(s);
+      return;
+    }
+
+  if (strcmp(op, "call") == 0 || strcmp(op, "callq") == 0)
+    {
+      if (n != 1)
+	Obj_Error("one operand expected");
+
+      if (src->indirect)
+	{
+	  Inst_Rex(FALSE, 2, src);
+	  Inst_Byte(0xff);
+	  Inst_Modrm(2, src);
+	}
+      else
+	{
+	  if (src->kind != OPND_SYM || src->sym < 0 ||
+	      (src->modif != MODIF_NONE && src->modif != MODIF_PLT))
+	    Obj_Error("call target expected");
+	  Inst_Byte(0xe8);
+	  Inst_Fixup((src->modif == MODIF_PLT) ? FIX_PLT : FIX_CALL, src->sym, src->val, 4);
+	  Inst_Int(0, 4);
+	}
+      Inst_Flush();
+      return;
+    }
+
+  if (strcmp(op, "ret") == 0 || strcmp(op, "retq") == 0)
+    {
+      Inst_Byte(0xc3);
+      Inst_Flush();
+      return;
+    }
+
+  if (strcmp(op, "movsd") == 0)
+    {
+      if (n != 2)
+	Obj_Error("two operands expected");
+      Inst_Byte(0xf2);
+      if (dst->kind == OPND_XMM)	/* load */
+	{
+	  Inst_Rex(FALSE, dst->reg, src);
+	  Inst_Byte(0x0f);
+	  Inst_Byte(0x10);
+	  Inst_Modrm(dst->reg, src);
+	}
+      else if (src->kind == OPND_XMM)	/* store */
+	{
+	  Inst_Rex(FALSE, src->reg, dst);
+	  Inst_Byte(0x0f);
+	  Inst_Byte(0x11);
+	  Inst_Modrm(src->reg, dst);
+	}
+      else
+	Obj_Error("invalid operands");
+      Inst_Flush();
+      return;
+    }
+
+	  /* 64-bit integer instructions: accept an optional q suffix */
+
+  l = (int) strlen(op);
+  if (l >= (int) sizeof(mnemo))
+    Obj_Error("unknown instruction %s", op);
+  strcpy(mnemo, op);
+  if (mnemo[l - 1] == 'q' && strcmp(mnemo, "movq") != 0)
+    mnemo[l - 1] = '\0';
+
+  if (strcmp(mnemo, "push") == 0 || strcmp(mnemo, "pop") == 0)
+    {
+      if (n != 1 || src->kind != OPND_REG)
+	Obj_Error("register expected");
+      Inst_Rex(FALSE, 0, src);
+      Inst_Byte(((mnemo[1] == 'u') ? 0x50 : 0x58) + (src->reg & 7));
+      Inst_Flush();
+      return;
+    }
+
+  if (n != 2)
+    Obj_Error("two operands expected");
+
+  if (strcmp(mnemo, "movq") == 0 || strcmp(mnemo, "mov") == 0)
+    {
+      if (src->kind == OPND_XMM || dst->kind == OPND_XMM)
+	{
+	  if (src->kind == OPND_XMM && dst->kind == OPND_MEM)
+	    {
+	      Inst_Byte(0x66);
+	      Inst_Rex(FALSE, src->reg, dst);
+	      Inst_Byte(0x0f);
+	      Inst_Byte(0xd6);
+	      Inst_Modrm(src->reg, dst);
+	    }
+	  else if (src->kind == OPND_MEM || (src->kind == OPND_XMM && dst->kind == OPND_XMM))
+	    {
+	      Inst_Byte(0xf3);
+	      Inst_Rex(FALSE, dst->reg, src);
+	      Inst_Byte(0x0f);
+	      Inst_Byte(0x7e);
+	      Inst_Modrm(dst->reg, src);
+	    }
+	  else if (src->kind == OPND_REG)	/* gp -> xmm */
+	    {
+	      Inst_Byte(0x66);
+	      Inst_Rex(TRUE, dst->reg, src);
+	      Inst_Byte(0x0f);
+	      Inst_Byte(0x6e);
+	      Inst_Modrm(dst->reg, src);
+	    }
+	  else if (dst->kind == OPND_REG)	/* xmm -> gp */
+	    {
+	      Inst_Byte(0x66);
+	      Inst_Rex(TRUE, src->reg, dst);
+	      Inst_Byte(0x0f);
+	      Inst_Byte(0x7e);
+	      Inst_Modrm(src->reg, dst);
+	    }
+	  else
+	    Obj_Error("invalid operands");
+	}
+      else if (src->kind == OPND_REG && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+	{
+	  Inst_Rex(TRUE, src->reg, dst);
+	  Inst_Byte(0x89);
+	  Inst_Modrm(src->reg, dst);
+	}
+      else if ((src->kind == OPND_MEM || src->kind == OPND_SYM) && dst->kind == OPND_REG)
+	{
+	  Inst_Rex(TRUE, dst->reg, src);
+	  Inst_Byte(0x8b);
+	  Inst_Modrm(dst->reg, src);
+	}
+      else if (src->kind == OPND_IMM && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+	{
+	  if (src->sym < 0 && !LITTLE_INT(src->val))
+	    {
+	      if (dst->kind != OPND_REG)
+		Obj_Error("immediate too large");
+	      goto movabs;
+	    }
+	  Inst_Rex(TRUE, 0, dst);
+	  Inst_Byte(0xc7);
+	  Inst_Modrm(0, dst);
+	  Inst_Imm(src, 4);
+	}
+      else
+	Obj_Error("invalid operands");
+      Inst_Flush();
+      return;
+    }
+
+  if (strcmp(mnemo, "movabs") == 0)
+    {
+      if (src->kind != OPND_IMM || dst->kind != OPND_REG)
+	Obj_Error("invalid operands");
+    movabs:
+      Inst_Rex(TRUE, 0, dst);
+      Inst_Byte(0xb8 + (dst->reg & 7));
+      Inst_Imm(src, 8);
+      Inst_Flush();
+      return;
+    }
+
+  if (strcmp(mnemo, "lea") == 0)
+    {
+      if ((src->kind != OPND_MEM && src->kind != OPND_SYM) || dst->kind != OPND_REG)
+	Obj_Error("invalid operands");
+      Inst_Rex(TRUE, dst->reg, src);
+      Inst_Byte(0x8d);
+      Inst_Modrm(dst->reg, src);
+      Inst_Flush();
+      return;
+    }
+
+  if (strcmp(mnemo, "test") == 0)
+    {
+      if (src->kind == OPND_REG && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+	{
+	  Inst_Rex(TRUE, src->reg, dst);
+	  Inst_Byte(0x85);
+	  Inst_Modrm(src->reg, dst);
+	}
+      else if (src->kind == OPND_IMM && dst->kind == OPND_REG && dst->reg == 0)
+	{
+	  Inst_Rex(TRUE, 0, NULL);
+	  Inst_Byte(0xa9);
+	  Inst_Imm(src, 4);
+	}
+      else if (src->kind == OPND_IMM && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+	{
+	  Inst_Rex(TRUE, 0, dst);
+	  Inst_Byte(0xf7);
+	  Inst_Modrm(0, dst);
+	  Inst_Imm(src, 4);
+	}
+      else
+	Obj_Error("invalid operands");
+      Inst_Flush();
+      return;
+    }
+
+  for (i = 0; alu_tbl[i].name && strcmp(alu_tbl[i].name, mnemo) != 0; i++)
+    ;
+
+  if (alu_tbl[i].name == NULL)
+    Obj_Error("unknown instruction %s", op);
+
+  l = alu_tbl[i].ext;
+  if (src->kind == OPND_IMM && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+    {
+      if (src->sym < 0 && Fits_Int8(src->val))
+	{
+	  Inst_Rex(TRUE, 0, dst);
+	  Inst_Byte(0x83);
+	  Inst_Modrm(l, dst);
+	  Inst_Int(src->val, 1);
+	}
+      else if (dst->kind == OPND_REG && dst->reg == 0)	/* short form for %rax */
+	{
+	  Inst_Rex(TRUE, 0, NULL);
+	  Inst_Byte(l * 8 + 5);
+	  Inst_Imm(src, 4);
+	}
+      else
+	{
+	  Inst_Rex(TRUE, 0, dst);
+	  Inst_Byte(0x81);
+	  Inst_Modrm(l, dst);
+	  Inst_Imm(src, 4);
+	}
+    }
+  else if (src->kind == OPND_REG && (dst->kind == OPND_REG || dst->kind == OPND_MEM))
+    {
+      Inst_Rex(TRUE, src->reg, dst);
+      Inst_Byte(l * 8 + 1);
+      Inst_Modrm(src->reg, dst);
+    }
+  else if (src->kind == OPND_MEM && dst->kind == OPND_REG)
+    {
+      Inst_Rex(TRUE, dst->reg, src);
+      Inst_Byte(l * 8 + 3);
+      Inst_Modrm(dst->reg, src);
+    }
+  else
+    Obj_Error("invalid operands");
+
+  Inst_Flush();
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * SYMBOL_VALUE                                                            *
+ *                                                                         *
+ * Offset of a defined symbol in its section (after relaxation).           *
+ *-------------------------------------------------------------------------*/
+static PlULong
+Symbol_Value(ObjSymbol *sym)
+{
+  if (sym->frag < 0)		/* in .bss */
+    return sym->offset;
+
+  return obj_sect[sym->sect].frag[sym->frag].address + sym->offset;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RELAX_SECTION                                                           *
+ *                                                                         *
+ * Computes the address of each fragment. All branches to a symbol of the  *
+ * same section start short and are made long until they all fit.          *
+ *-------------------------------------------------------------------------*/
+static void
+Relax_Section(ObjSection *s)
+{
+  int sect_no = s - obj_sect;
+  ObjFrag *f;
+  ObjSymbol *sym;
+  PlULong addr;
+  PlLong disp;
+  Bool changed;
+  int i;
+
+  for (i = 0; i < s->nb_frag; i++)
+    {
+      f = s->frag + i;
+      if (f->var_type == VAR_BRANCH)
+	f->is_long = !Sym_In_Sect(obj_sym + f->sym, sect_no);
+    }
+
+  do
+    {
+      addr = 0;
+      for (i = 0; i < s->nb_frag; i++)
+	{
+	  f = s->frag + i;
+	  f->address = addr;
+	  addr += f->fix_size;
+	  switch (f->var_type)
+	    {
+	    case VAR_ALIGN:
+	      f->var_size = (f->align - addr % f->align) % f->align;
+	      if (f->var_size > (PlULong) f->max_skip)
+		f->var_size = 0;
+	      break;
+
+	    case VAR_BRANCH:
+	      f->var_size = (!f->is_long) ? 2 : (f->cond == COND_JMP) ? 5 : 6;
+	      break;
+
+	    default:
+	      f->var_size = 0;
+	    }
+	  addr += f->var_size;
+	}
+
+      changed = FALSE;
+      for (i = 0; i < s->nb_frag; i++)
+	{
+	  f = s->frag + i;
+	  if (f->var_type != VAR_BRANCH || f->is_long)
+	    continue;
+
+	  sym = obj_sym + f->sym;
+	  disp = (PlLong) (Symbol_Value(sym) + f->addend) -
+	    (PlLong) (f->address + f->fix_size + 2);
+	  if (!Fits_Int8(disp))
+	    {
+	      f->is_long = TRUE;
+	      changed = TRUE;
+	    }
+	}
+    }
+  while (changed);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * BUILD_IMAGE                                                             *
+ *                                                                         *
+ * Builds the final contents of a section (fixed parts, paddings and       *
+ * branches). Branches to other sections or undefined symbols become       *
+ * fixups.                                                                 *
+ *-------------------------------------------------------------------------*/
+static void
+Build_Image(ObjSection *s)
+{
+  int sect_no = s - obj_sect;
+  ObjFrag *f;
+  ObjSymbol *sym;
+  PlULong pad, k;
+  PlLong disp;
+  int i;
+
+  for (i = 0; i < s->nb_frag; i++)
+    {
+      f = s->frag + i;
+      Buff_Put(&s->image, s->data.data + f->fix_start, f->fix_size);
+
+      switch (f->var_type)
+	{
+	case VAR_ALIGN:
+	  pad = f->var_size;
+	  if (!(s->flags & ELF_SHF_EXECINSTR))
+	    Buff_Put(&s->image, NULL, pad);
+	  else
+	    while (pad > 0)
+	      {
+		k = (pad > MAX_NOP_SIZE) ? MAX_NOP_SIZE : pad;
+		Buff_Put(&s->image, nop_tbl[k], k);
+		pad -= k;
+	      }
+	  break;
+
+	case VAR_BRANCH:
+	  sym = obj_sym + f->sym;
+	  if (!f->is_long)
+	    {
+	      disp = (PlLong) (Symbol_Value(sym) + f->addend) - (PlLong) (f->address + f->fix_size + 2);
+	      Buff_Put_Int(&s->image, (f->cond == COND_JMP) ? 0xeb : 0x70 | f->cond, 1);
+	      Buff_Put_Int(&s->image, (PlULong) disp, 1);
+	      break;
+	    }
+
+	  if (f->cond == COND_JMP)
+	    Buff_Put_Int(&s->image, 0xe9, 1);
+	  else
+	    {
+	      Buff_Put_Int(&s->image, 0x0f, 1);
+	      Buff_Put_Int(&s->image, 0x80 | f->cond, 1);
+	    }
+
+	  if (Sym_In_Sect(sym, sect_no))
+	    {
+	      disp = (PlLong) (Symbol_Value(sym) + f->addend) - (PlLong) (s->image.size + 4);
+	      Buff_Put_Int(&s->image, (PlULong) disp, 4);
+	    }
+	  else
+	    {
+	      Realloc_Array(obj_fix, obj_nb_fix, obj_max_fix, ObjFixup);
+	      obj_fix[obj_nb_fix].sect = sect_no;
+	      obj_fix[obj_nb_fix].frag = -1;		/* offset is absolute */
+	      obj_fix[obj_nb_fix].offset = s->image.size;
+	      obj_fix[obj_nb_fix].kind = FIX_CALL;
+	      obj_fix[obj_nb_fix].sym = f->sym;
+	      obj_fix[obj_nb_fix].addend = f->addend - 4;
+	      obj_fix[obj_nb_fix].size = 4;
+	      obj_nb_fix++;
+	      Buff_Put_Int(&s->image, 0, 4);
+	    }
+	  break;
+	}
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * ADD_RELA                                                                *
+ *                                                                         *
+ * sym is the index in obj_sym or -(section no + 1) for a section symbol.  *
+ * The ELF symbol index is set when writing the file (see Obj_Stop).       *
+ *-------------------------------------------------------------------------*/
+static void
+Add_Rela(ObjSection *s, PlULong offset, int sym, int type, PlLong addend)
+{
+  Buff_Put_Int(&s->rela, offset, 8);
+  Buff_Put_Int(&s->rela, type, 4);	/* r_info: type in low 32 bits */
+  Buff_Put_Int(&s->rela, (PlULong) (PlLong) sym, 4);
+  Buff_Put_Int(&s->rela, (PlULong) addend, 8);
+  s->nb_rela++;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * RESOLVE_FIXUP                                                           *
+ *                                                                         *
+ * A reference to a local symbol of the same section is resolved (except   *
+ * absolute ones). A reference to a local symbol of another section uses   *
+ * the section symbol (except in mergeable sections where the offset is    *
+ * meaningless). Other references use the symbol itself.                   *
+ *-------------------------------------------------------------------------*/
+static void
+Resolve_Fixup(ObjFixup *fx)
+{
+  ObjSection *s = obj_sect + fx->sect;
+  ObjSymbol *sym = obj_sym + fx->sym;
+  PlULong offset;
+  PlLong v;
+  Bool local;
+  int type = 0;
+  int i;
+
+  offset = (fx->frag < 0) ? fx->offset : s->frag[fx->frag].address + fx->offset;
+
+  local = !sym->global && sym->sect >= 0;
+
+  switch (fx->kind)
+    {
+    case FIX_PCREL:
+      type = R_X86_64_PC32;
+      break;
+
+    case FIX_CALL:
+      type = (local) ? R_X86_64_PC32 : R_X86_64_PLT32;
+      break;
+
+    case FIX_PLT:
+      type = R_X86_64_PLT32;
+      local = FALSE;
+      break;
+
+    case FIX_GOTPCREL:
+      type = R_X86_64_GOTPCREL;
+      local = FALSE;
+      break;
+
+    case FIX_GOTTPOFF:
+      type = R_X86_64_GOTTPOFF;
+      local = FALSE;
+      if (sym->sect == SECT_UNDEF)
+	sym->type = ELF_STT_TLS;	/* as gas: a thread-local variable */
+      break;
+
+    case FIX_ABS32S:
+      type = R_X86_64_32S;
+      break;
+
+    case FIX_ABS64:
+      type = R_X86_64_64;
+      break;
+    }
+
+  if (local && fx->kind != FIX_ABS32S && fx->kind != FIX_ABS64 && Sym_In_Sect(sym, fx->sect))
+    {
+      v = (PlLong) (Symbol_Value(sym) + fx->addend) - (PlLong) offset;
+      if (!LITTLE_INT(v))
+	Obj_Error("PC-relative offset too large for %s", sym->name);
+      for (i = 0; i < 4; i++, v >>= 8)
+	s->image.data[offset + i] = (unsigned char) v;
+      return;
+    }
+
+  if (local && !(obj_sect[sym->sect].flags & ELF_SHF_MERGE))
+    {
+      Add_Rela(s, offset, -(sym->sect + 1), type, (PlLong) Symbol_Value(sym) + fx->addend);
+      return;
+    }
+
+  sym->in_symtab = TRUE;
+  Add_Rela(s, offset, fx->sym, type, fx->addend);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * OBJ_STOP                                                                *
+ *                                                                         *
+ * Resolves the references and writes the ELF file in f.                   *
+ *-------------------------------------------------------------------------*/
+void
+Obj_Stop(FILE *f)
+{
+  ObjBuff file = { NULL, 0, 0 };
+  ObjBuff symtab = { NULL, 0, 0 };
+  ObjBuff strtab = { NULL, 0, 0 };
+  ObjBuff shstrtab = { NULL, 0, 0 };
+  ObjBuff shdr = { NULL, 0, 0 };
+  ObjSection *s;
+  ObjSymbol *sym;
+  PlULong *sect_offset;
+  PlULong shoff, sym_offset, str_offset, shstr_offset, x;
+  int nb_elf_sect, nb_local, nb_elf_sym;
+  int symtab_index, i, j, k;
+  unsigned char *p;
+
+  obj_cur_line = NULL;
+
+  for (i = 0; i < obj_nb_sect; i++)
+    Relax_Section(obj_sect + i);
+
+  for (i = 0; i < obj_nb_sect; i++)
+    if (obj_sect[i].type != ELF_SHT_NOBITS)
+      Build_Image(obj_sect + i);
+
+  for (i = 0; i < obj_nb_fix; i++)
+    Resolve_Fixup(obj_fix + i);
+
+	  /* section numbers */
+
+  nb_elf_sect = 1;
+  for (i = 0; i < obj_nb_sect; i++)
+    obj_sect[i].elf_index = nb_elf_sect++;
+  for (i = 0; i < obj_nb_sect; i++)
+    if (obj_sect[i].nb_rela)
+      obj_sect[i].rela_elf_index = nb_elf_sect++;
+  symtab_index = nb_elf_sect++;
+  nb_elf_sect += 2;		/* .strtab .shstrtab */
+
+	  /* symbol table: null, section symbols, local symbols, globals */
+
+  Buff_Put(&strtab, NULL, 1);
+  Buff_Put(&symtab, NULL, ELF_SYM_SIZE);
+  nb_elf_sym = 1;
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      s = obj_sect + i;
+      s->sym_index = nb_elf_sym++;
+      Buff_Put_Int(&symtab, 0, 4);
+      Buff_Put_Int(&symtab, (ELF_STB_LOCAL << 4) | ELF_STT_SECTION, 1);
+      Buff_Put_Int(&symtab, 0, 1);
+      Buff_Put_Int(&symtab, s->elf_index, 2);
+      Buff_Put_Int(&symtab, 0, 8);
+      Buff_Put_Int(&symtab, 0, 8);
+    }
+
+  for (k = 0; k < 2; k++)	/* k = 0: locals, k = 1: globals */
+    {
+      if (k == 1)
+	nb_local = nb_elf_sym;
+
+      for (i = 0; i < obj_nb_sym; i++)
+	{
+	  sym = obj_sym + i;
+	  if (sym->sect == SECT_UNDEF || sym->sect == SECT_COMMON)
+	    sym->global = TRUE;	/* undefined symbols are global */
+
+	  if (sym->global != k)
+	    continue;
+
+	  if (!sym->global && !sym->in_symtab && Is_Local_Label(sym->name))
+	    continue;
+
+	  if (sym->sect == SECT_UNDEF && !sym->in_symtab)
+	    {			/* only referenced in .type/.globl */
+	      for (j = 0; j < obj_nb_fix && obj_fix[j].sym != i; j++)
+		;
+	      if (j == obj_nb_fix && !sym->global)
+		continue;
+	    }
+
+	  sym->elf_index = nb_elf_sym++;
+	  Buff_Put_Int(&symtab, strtab.size, 4);
+	  Buff_Put(&strtab, sym->name, strlen(sym->name) + 1);
+	  Buff_Put_Int(&symtab, ((sym->global ? ELF_STB_GLOBAL : ELF_STB_LOCAL) << 4) | sym->type, 1);
+	  Buff_Put_Int(&symtab, 0, 1);
+	  if (sym->sect == SECT_UNDEF)
+	    {
+	      Buff_Put_Int(&symtab, ELF_SHN_UNDEF, 2);
+	      Buff_Put_Int(&symtab, 0, 8);
+	    }
+	  else if (sym->sect == SECT_COMMON)
+	    {
+	      Buff_Put_Int(&symtab, ELF_SHN_COMMON, 2);
+	      Buff_Put_Int(&symtab, sym->comm_align, 8);
+	    }
+	  else
+	    {
+	      Buff_Put_Int(&symtab, obj_sect[sym->sect].elf_index, 2);
+	      Buff_Put_Int(&symtab, Symbol_Value(sym), 8);
+	    }
+	  Buff_Put_Int(&symtab, sym->size, 8);
+	}
+    }
+
+	  /* set the symbol indexes in the relocations */
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      s = obj_sect + i;
+      for (j = 0; j < s->nb_rela; j++)
+	{
+	  p = s->rela.data + j * ELF_RELA_SIZE + 12;
+	  k = (int) (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned) p[3] << 24));
+	  k = (k < 0) ? obj_sect[-k - 1].sym_index : obj_sym[k].elf_index;
+	  for (x = (PlULong) k; p < s->rela.data + (j + 1) * ELF_RELA_SIZE - 8; x >>= 8)
+	    *p++ = (unsigned char) x;
+	}
+    }
+
+	  /* file layout: header, contents, relocations, symtab, strtabs */
+
+  if ((sect_offset = (PlULong *) calloc(nb_elf_sect, sizeof(PlULong))) == NULL)
+    Obj_Error("memory allocation fault");
+
+  Buff_Put(&file, NULL, ELF_EHDR_SIZE);
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      s = obj_sect + i;
+      Buff_Pad(&file, s->align);
+      sect_offset[s->elf_index] = file.size;
+      if (s->type != ELF_SHT_NOBITS)
+	Buff_Put(&file, s->image.data, s->image.size);
+    }
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      s = obj_sect + i;
+      if (s->nb_rela == 0)
+	continue;
+      Buff_Pad(&file, 8);
+      sect_offset[s->rela_elf_index] = file.size;
+      Buff_Put(&file, s->rela.data, s->rela.size);
+    }
+
+  Buff_Pad(&file, 8);
+  sym_offset = file.size;
+  Buff_Put(&file, symtab.data, symtab.size);
+
+  str_offset = file.size;
+  Buff_Put(&file, strtab.data, strtab.size);
+
+	  /* section names and section headers */
+
+  Buff_Put(&shstrtab, NULL, 1);
+  Buff_Put(&shdr, NULL, ELF_SHDR_SIZE);
+
+#define Put_Shdr(sh_name, sh_type, sh_flags, sh_offset, sh_size, sh_link, sh_info, sh_align, sh_entsize) \
+  do                                                                    \
+    {                                                                   \
+      Buff_Put_Int(&shdr, shstrtab.size, 4);                            \
+      Buff_Put(&shstrtab, sh_name, strlen(sh_name) + 1);                \
+      Buff_Put_Int(&shdr, sh_type, 4);                                  \
+      Buff_Put_Int(&shdr, sh_flags, 8);                                 \
+      Buff_Put_Int(&shdr, 0, 8);                                        \
+      Buff_Put_Int(&shdr, sh_offset, 8);                                \
+      Buff_Put_Int(&shdr, sh_size, 8);                                  \
+      Buff_Put_Int(&shdr, sh_link, 4);                                  \
+      Buff_Put_Int(&shdr, sh_info, 4);                                  \
+      Buff_Put_Int(&shdr, sh_align, 8);                                 \
+      Buff_Put_Int(&shdr, sh_entsize, 8);                               \
+    }                                                                   \
+  while (0)
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      s = obj_sect + i;
+      Put_Shdr(s->name, s->type, s->flags, sect_offset[s->elf_index],
+	       (s->type == ELF_SHT_NOBITS) ? s->bss_size : s->image.size,
+	       0, 0, s->align, s->entsize);
+    }
+
+  for (i = 0; i < obj_nb_sect; i++)
+    {
+      static char name[1024];
+
+      s = obj_sect + i;
+      if (s->nb_rela == 0)
+	continue;
+      sprintf(name, ".rela%.1000s", s->name);
+      Put_Shdr(name, ELF_SHT_RELA, ELF_SHF_INFO_LINK, sect_offset[s->rela_elf_index],
+	       s->rela.size, symtab_index, s->elf_index, 8, ELF_RELA_SIZE);
+    }
+
+  Put_Shdr(".symtab", ELF_SHT_SYMTAB, 0, sym_offset, symtab.size,
+	   symtab_index + 1, nb_local, 8, ELF_SYM_SIZE);
+  Put_Shdr(".strtab", ELF_SHT_STRTAB, 0, str_offset, strtab.size, 0, 0, 1, 0);
+
+  shstr_offset = file.size;
+  Put_Shdr(".shstrtab", ELF_SHT_STRTAB, 0, shstr_offset, shstrtab.size + sizeof(".shstrtab"),
+	   0, 0, 1, 0);
+  Buff_Put(&file, shstrtab.data, shstrtab.size);
+
+#undef Put_Shdr
+
+  Buff_Pad(&file, 8);
+  shoff = file.size;
+  Buff_Put(&file, shdr.data, shdr.size);
+
+	  /* ELF header */
+
+  p = file.data;
+  memcpy(p, "\177ELF", 4);
+  p[4] = 2;			/* ELFCLASS64 */
+  p[5] = 1;			/* ELFDATA2LSB */
+  p[6] = 1;			/* EV_CURRENT */
+  file.size = 16;
+  Buff_Put_Int(&file, 1, 2);	/* ET_REL */
+  Buff_Put_Int(&file, ELF_EM_X86_64, 2);
+  Buff_Put_Int(&file, 1, 4);	/* EV_CURRENT */
+  Buff_Put_Int(&file, 0, 8);	/* entry */
+  Buff_Put_Int(&file, 0, 8);	/* phoff */
+  Buff_Put_Int(&file, shoff, 8);
+  Buff_Put_Int(&file, 0, 4);	/* flags */
+  Buff_Put_Int(&file, ELF_EHDR_SIZE, 2);
+  Buff_Put_Int(&file, 0, 2);	/* phentsize */
+  Buff_Put_Int(&file, 0, 2);	/* phnum */
+  Buff_Put_Int(&file, ELF_SHDR_SIZE, 2);
+  Buff_Put_Int(&file, nb_elf_sect, 2);
+  Buff_Put_Int(&file, nb_elf_sect - 1, 2);	/* shstrndx */
+  file.size = shoff + shdr.size;
+
+  if (fwrite(file.data, 1, file.size, f) != file.size)
+    Obj_Error("cannot write the object file");
+
+  free(file.data);
+  free(symtab.data);
+  free(strtab.data);
+  free(shstrtab.data);
+  free(shdr.data);
+  free(sect_offset);
+}
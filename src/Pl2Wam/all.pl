@@ -7,7 +7,8 @@
 :- include(first_arg).
 :- include(indexing).
 :- include(wam_emit).
-:- include(pl2wam).  % last since contains :- initialization
+:- include(pl2wam).
+:- include(pl2wam_main).  % last since contains :- initialization
 
 %go:- abort
 %:- initialization(go).
@@ -37,10 +37,10 @@
 
 
 code_generation(Head, Body, NbChunk, NbY, WamHead) :-
-	g_assign(last_pred, f),
-	g_assign(treat_body, f),
+	g_assign('$last_pred', f),
+	g_assign('$treat_body', f),
 	generate_head(Head, NbChunk, NbY, WamBody, WamHead),
-	g_assign(treat_body, t),
+	g_assign('$treat_body', t),
 	generate_body(Body, NbChunk, WamBody).
 
 
@@ -48,7 +48,7 @@ code_generation(Head, Body, NbChunk, NbY, WamHead) :-
 
 generate_head(p(_, _, _ / N, LArg), NbChunk, NbY, WamNext, WamHead) :-
 	gen_list_integers(0, N, LReg),
-	(   g_read(reorder, t) ->
+	(   g_read('$reorder', t) ->
 	    reorder_head_arg_lst(LArg, LReg, LArg1, LReg1)
 	;
 	    LArg1 = LArg,
@@ -80,7 +80,7 @@ generate_body([], _, [proceed]).
 
 generate_body([p(NoPred, Module, Pred / N, LArg)|Body], NbChunk, WamPred) :-
 	(   NoPred = NbChunk ->
-	    g_assign(last_pred, t)
+	    g_assign('$last_pred', t)
 	;
 	    true
 	),
@@ -136,7 +136,7 @@ generate_body1(Pred, N, _, LArg, NoPred, Body, NbChunk, WamPred) :-
 
 generate_body1(Pred, N, Module, LArg, NoPred, Body, NbChunk, WamLArg) :-
 	gen_list_integers(0, N, LReg),
-	(   g_read(reorder, t) ->
+	(   g_read('$reorder', t) ->
 	    reorder_body_arg_lst(LArg, LReg, LArg1, LReg1)
 	;
 	    LArg1 = LArg,
@@ -247,7 +247,7 @@ gen_unif_arg(var(VarName, Info), Reg, WamNext, WamArg) :-
 	    (   VarName == x(void) ->
 	        WamArg = WamNext
 	    ;
-		(   g_read(treat_body, t), VarName = y(_) ->
+		(   g_read('$treat_body', t), VarName = y(_) ->
 		    Info = unsafe   % p :- A=B, dummy, A=1, q(B). needs a put_unsafe_value for B (y(1))
 		;
 		    Info = not_in_cur_env
@@ -301,7 +301,7 @@ gen_load_arg(var(VarName, Info), Reg, WamNext, WamCode) :-
 	            Info = in_heap
 	        ;
 		    Info = unsafe,
-		    (   g_read(last_pred, t) -> % can occur for false y var by optim: p :- _=B, dummy, r(B).
+		    (   g_read('$last_pred', t) -> % can occur for false y var by optim: p :- _=B, dummy, r(B).
 			WamInstBis = put_unsafe_value(VarName, Reg)
 		    ;
 			true
@@ -312,7 +312,7 @@ gen_load_arg(var(VarName, Info), Reg, WamNext, WamCode) :-
 	;
 		    
 	    Info = unsafe,
-	    g_read(last_pred, t) ->
+	    g_read('$last_pred', t) ->
 	    WamInst = put_unsafe_value(VarName, Reg)
 	;
 	    WamInst = put_value(VarName, Reg)
@@ -360,7 +360,7 @@ flat_stc_arg_lst([StcArg|LStcArg], HB, [StcArg|LStcArg1], LArgAux, LRegAux) :-
 	flat_stc_arg_lst(LStcArg, HB, LStcArg1, LArgAux, LRegAux).
 
 flat_stc_arg_lst([StcArg], HB, [stc(F, N, LStcArg1)], LArgAux, LRegAux) :-
-	g_read(opt_last_subterm, t),     % last subterm unif stc optimization
+	g_read('$opt_last_subterm', t),     % last subterm unif stc optimization
 	StcArg = stc(F, N, LStcArg),
 	( F \== '$mt' ; N \== 2 ), !,
 	flat_stc_arg_lst(LStcArg, HB, LStcArg1, LArgAux, LRegAux).
@@ -608,7 +608,7 @@ load_math_expr(var(VarName, Info), Reg, WamNext, WamMath) :-
 	    error('unbound variable in arithmetic expression', [])
 	;   true
 	),
-	(   g_read(fast_math, t) ->
+	(   g_read('$fast_math', t) ->
 	    WamMath = [math_fast_load_value(VarName, Reg)|WamNext]
 	;
 	    WamMath = [math_load_value(VarName, Reg)|WamNext]
@@ -643,7 +643,7 @@ load_math_expr1(-, 2, [Arg1, int(1)], Reg, WamNext, WamMath) :-
 	load_math_expr1(dec, 1, [Arg1], Reg, WamNext, WamMath).
 
 load_math_expr1(F, N, LArg, Reg, WamNext, WamMath) :-
-	(   g_read(fast_math, t) ->
+	(   g_read('$fast_math', t) ->
 	    fast_exp_functor_name(F, N, Name)
 	;
 	    math_exp_functor_name(F, N, Name)
@@ -755,7 +755,7 @@ math_exp_functor_name(float_integer_part, 1, 'Pl_Fct_Float_Integ_Part').
 
 
 gen_inline_pred(F, 2, LArg, WamNext, WamMath) :-
-	(   g_read(fast_math, t) ->
+	(   g_read('$fast_math', t) ->
 	    fast_cmp_functor_name(F, Name)
 	;
 	    math_cmp_functor_name(F, Name)
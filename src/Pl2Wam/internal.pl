@@ -80,7 +80,7 @@ internal_format(Head, Body, Head1, Body1, NbChunk, NbY) :-
 
 
 format_head(Head, DicoVar, Head1) :-
-	g_read(module, Module),	% not really necessary since Module info in p(...) is never used
+	g_read('$module', Module),	% not really necessary since Module info in p(...) is never used
 	format_pred(Module:Head, 0, DicoVar, Head1, _).
 
 
@@ -278,7 +278,7 @@ classif_vars([v(_, _, _, var(y(Y), _))|DicoVar], Y, NbY) :-
 	% gen_inline_pred/5 in pass 3 describing their associated code
 
 inline_predicate(Pred, Arity) :-
-	g_read(inline, Inline),
+	g_read('$inline', Inline),
 	inline_predicate(Pred, Arity, Inline).
 
 
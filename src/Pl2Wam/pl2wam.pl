@@ -47,6 +47,14 @@ pl2wam(LArg) :-
 
 
 
+          % true if the compiler is linked in the run-time (see consult.pl)
+
+in_process :-
+	g_read('$in_process', t).
+
+
+
+
 pl2wam1(LArg) :-
 	read_file_init,		% inits before read_pl_file
 	cmd_line_args(LArg, PlFile, WamFile, LInclude),
@@ -82,10 +90,10 @@ compile_list_include(_).
 
 compile_and_emit_file(PlFile) :-
 	read_file_init(PlFile),
-	g_read(native_code, NativeCode),
+	g_read('$native_code', NativeCode),
 	repeat,
 	read_predicate(Pred, N, LSrcCl),
-	add_counter(user_read_file, real_read_file),
+	add_counter('$user_read_file', '$real_read_file'),
 	(   LSrcCl = [] ->	% [] at end of file
 	    !
 	;
@@ -101,22 +109,22 @@ compile_and_emit_pred(t, Pred, N, LSrcCl) :-
 	compile_emit_inits(Pred, N, LSrcCl, PlFile, PlLine),
 	compile_lst_clause(LSrcCl, LCompCl),
 	indexing(LCompCl, WamCode),
-	add_counter(user_indexing, real_indexing),
+	add_counter('$user_indexing', '$real_indexing'),
 	emit_code(Pred, N, PlFile, PlLine, WamCode),
-	add_counter(user_wam_emit, real_wam_emit).
+	add_counter('$user_wam_emit', '$real_wam_emit').
 
 compile_and_emit_pred(f, Pred, N, LSrcCl) :-
 	compile_emit_inits(Pred, N, LSrcCl, PlFile, PlLine),
 	bc_compile_lst_clause(LSrcCl, LCompCl),
 	bc_emit_code(Pred, N, PlFile, PlLine, LCompCl),
-	add_counter(user_wam_emit, real_wam_emit).
+	add_counter('$user_wam_emit', '$real_wam_emit').
 
 
 
 
 compile_emit_inits(Pred, N, LSrcCl, PlFile1, PlLine) :-
-	g_assign(cur_func, Pred),
-	g_assign(cur_arity, N),
+	g_assign('$cur_func', Pred),
+	g_assign('$cur_arity', N),
 	LSrcCl = [[of(PlFile, _, _)|_] + (PlLine - _) + _|_],
 	absolute_file_name(PlFile, PlFile1),
 	syntactic_sugar_init_pred(Pred, N, PlFile1).
@@ -134,17 +142,17 @@ compile_lst_clause([SrcCl|LSrcCl], [cl(_, FirstArg, WamCl)|LCC]) :-
 
 
 compile_clause(Where + Cl, FirstArg, WamCl) :-
-	g_assign(where, Where),
+	g_assign('$where', Where),
 	syntactic_sugar(Cl, Head, Body),
-	add_counter(user_syn_sugar, real_syn_sugar),
+	add_counter('$user_syn_sugar', '$real_syn_sugar'),
 	internal_format(Head, Body, Head1, Body1, NbChunk, NbY),
-	add_counter(user_internal, real_internal),
+	add_counter('$user_internal', '$real_internal'),
 	code_generation(Head1, Body1, NbChunk, NbY, WamCl),
-	add_counter(user_code_gen, real_code_gen),
+	add_counter('$user_code_gen', '$real_code_gen'),
 	allocate_registers(WamCl),
-	add_counter(user_reg_alloc, real_reg_alloc),
+	add_counter('$user_reg_alloc', '$real_reg_alloc'),
 	find_first_arg(WamCl, FirstArg),
-	add_counter(user_first_arg, real_first_arg).
+	add_counter('$user_first_arg', '$real_first_arg').
 
 
 
@@ -159,32 +167,45 @@ bc_compile_lst_clause([SrcCl|LSrcCl], [bc(Cl, WamCl)|LCC]) :-
 
 
 compile_msg_start(_) :-
-	g_read(compile_msg, f), !.
+	g_read('$compile_msg', f), !.
 
 compile_msg_start(PlFile) :-
-	(   g_read(native_code, t) ->
+	(   g_read('$native_code', t) ->
 	    Type = 'native code'
 	;   Type = 'byte code'
 	),
 	format('compiling ~a for ~a...~n', [PlFile, Type]),
-	flush_output.
+	flush_output,
+	real_time(Time),
+	g_assign('$start_time', Time).
 
 
 
 
 compile_msg_end(_, _, _, _, _) :-
-	g_read(compile_msg, f), !.
+	g_read('$compile_msg', f), !.
+
+compile_msg_end(PlFile, _InBytes, InLines, _OutBytes, _OutLines) :-
+	in_process, !,
+	compile_time(Time),
+	format('~a compiled, ~d lines read - ~d ms~n', [PlFile, InLines, Time]).
 
 compile_msg_end(PlFile, _InBytes, InLines, OutBytes, _OutLines) :-
-	real_time(Time),
+	compile_time(Time),
 	format('~a compiled, ~d lines read - ~d bytes written, ~d ms~n', [PlFile, InLines, OutBytes, Time]).
 
 
+compile_time(Time) :-
+	real_time(Time1),
+	g_read('$start_time', Time0),
+	Time is Time1 - Time0.
+
+
 
 
 cur_pred(Func, Arity) :-
-	g_read(cur_func, Func),
-	g_read(cur_arity, Arity).
+	g_read('$cur_func', Func),
+	g_read('$cur_arity', Arity).
 
 
 cur_pred_without_aux(Func1, Arity1) :-
@@ -195,32 +216,32 @@ cur_pred_without_aux(Func1, Arity1) :-
 
 
 init_counters :-
-	g_read(statistics, f), !.
+	g_read('$statistics', f), !.
 
 init_counters :-
-	g_assign(user_read_file, 0),
-	g_assign(real_read_file, 0),
-	g_assign(user_syn_sugar, 0),
-	g_assign(real_syn_sugar, 0),
-	g_assign(user_internal, 0),
-	g_assign(real_internal, 0),
-	g_assign(user_code_gen, 0),
-	g_assign(real_code_gen, 0),
-	g_assign(user_reg_alloc, 0),
-	g_assign(real_reg_alloc, 0),
-	g_assign(user_indexing, 0),
-	g_assign(real_indexing, 0),
-	g_assign(user_first_arg, 0),
-	g_assign(real_first_arg, 0),
-	g_assign(user_wam_emit, 0),
-	g_assign(real_wam_emit, 0),
+	g_assign('$user_read_file', 0),
+	g_assign('$real_read_file', 0),
+	g_assign('$user_syn_sugar', 0),
+	g_assign('$real_syn_sugar', 0),
+	g_assign('$user_internal', 0),
+	g_assign('$real_internal', 0),
+	g_assign('$user_code_gen', 0),
+	g_assign('$real_code_gen', 0),
+	g_assign('$user_reg_alloc', 0),
+	g_assign('$real_reg_alloc', 0),
+	g_assign('$user_indexing', 0),
+	g_assign('$real_indexing', 0),
+	g_assign('$user_first_arg', 0),
+	g_assign('$real_first_arg', 0),
+	g_assign('$user_wam_emit', 0),
+	g_assign('$real_wam_emit', 0),
 	last_times(_, _).
 
 
 
 
 add_counter(_, _) :-
-	g_read(statistics, f), !.
+	g_read('$statistics', f), !.
 
 add_counter(UserCounter, RealCounter) :-
 	last_times(User1, Real1),
@@ -242,25 +263,25 @@ last_times(User, Real) :-
 
 
 display_counters :-
-	g_read(statistics, f), !.
+	g_read('$statistics', f), !.
 
 display_counters :-
-	g_read(user_read_file, UReadFile),
-	g_read(real_read_file, RReadFile),
-	g_read(user_syn_sugar, USynSugar),
-	g_read(real_syn_sugar, RSynSugar),
-	g_read(user_internal, UInternal),
-	g_read(real_internal, RInternal),
-	g_read(user_code_gen, UCodeGen),
-	g_read(real_code_gen, RCodeGen),
-	g_read(user_reg_alloc, URegAlloc),
-	g_read(real_reg_alloc, RRegAlloc),
-	g_read(user_indexing, UIndexing),
-	g_read(real_indexing, RIndexing),
-	g_read(user_first_arg, UFirstArg),
-	g_read(real_first_arg, RFirstArg),
-	g_read(user_wam_emit, UWamEmit),
-	g_read(real_wam_emit, RWamEmit),
+	g_read('$user_read_file', UReadFile),
+	g_read('$real_read_file', RReadFile),
+	g_read('$user_syn_sugar', USynSugar),
+	g_read('$real_syn_sugar', RSynSugar),
+	g_read('$user_internal', UInternal),
+	g_read('$real_internal', RInternal),
+	g_read('$user_code_gen', UCodeGen),
+	g_read('$real_code_gen', RCodeGen),
+	g_read('$user_reg_alloc', URegAlloc),
+	g_read('$real_reg_alloc', RRegAlloc),
+	g_read('$user_indexing', UIndexing),
+	g_read('$real_indexing', RIndexing),
+	g_read('$user_first_arg', UFirstArg),
+	g_read('$real_first_arg', RFirstArg),
+	g_read('$user_wam_emit', UWamEmit),
+	g_read('$real_wam_emit', RWamEmit),
 	U is UReadFile + USynSugar + UInternal + UCodeGen + URegAlloc + UIndexing + UFirstArg + UWamEmit,
 	R is RReadFile + RSynSugar + RInternal + RCodeGen + RRegAlloc + RIndexing + RFirstArg + RWamEmit,
 	user_time(UTotal),
@@ -285,32 +306,32 @@ display_counters :-
           % Command-line options reading
 
 cmd_line_args(LArg, PlFile, WamFile, LInclude) :-
-	g_assign(plfile, ''),
-	g_assign(wamfile, ''),
-	g_assign(native_code, t),
-	g_assign(wam_comment, ''),
-	g_assign(susp_warn, t),
-	g_assign(singl_warn, t),
-	g_assign(redef_error, t),
-	g_assign(foreign_only, f),
-	g_assign(call_c, t),
-	g_assign(inline, t),
-	g_assign(optim_fail, t), % does not correspond to a command-line option (TODO ?)
-	g_assign(reorder, t),
-	g_assign(reg_opt, 2),
-	g_assign(opt_last_subterm, t),
-	g_assign(keep_void_inst, f),
-	g_assign(fast_math, f),
-	g_assign(statistics, f),
-	g_assign(compile_msg, f),
+	g_assign('$plfile', ''),
+	g_assign('$wamfile', ''),
+	g_assign('$native_code', t),
+	g_assign('$wam_comment', ''),
+	g_assign('$susp_warn', t),
+	g_assign('$singl_warn', t),
+	g_assign('$redef_error', t),
+	g_assign('$foreign_only', f),
+	g_assign('$call_c', t),
+	g_assign('$inline', t),
+	g_assign('$optim_fail', t), % does not correspond to a command-line option (TODO ?)
+	g_assign('$reorder', t),
+	g_assign('$reg_opt', 2),
+	g_assign('$opt_last_subterm', t),
+	g_assign('$keep_void_inst', f),
+	g_assign('$fast_math', f),
+	g_assign('$statistics', f),
+	g_assign('$compile_msg', f),
 	cmd_line_args(LArg, LInclude),
-	g_read(plfile, PlFile),
+	g_read('$plfile', PlFile),
 	(   PlFile = '' ->
 	    format('no input file~n', []),
 	    abandon_exec
 	;   true
 	),
-	g_read(wamfile, WamFile).
+	g_read('$wamfile', WamFile).
 
 
 
@@ -318,9 +339,9 @@ cmd_line_args(LArg, PlFile, WamFile, LInclude) :-
 cmd_line_args([], []).
 
 cmd_line_args([Arg|LArg], LInclude1) :-
-	g_assign(include_file, ''),
+	g_assign('$include_file', ''),
 	cmd_line_arg1(Arg, LArg, LArg1), !,
-	g_read(include_file, IncludeFile),
+	g_read('$include_file', IncludeFile),
 	(   IncludeFile == '' ->
 	    LInclude1 = LInclude
 	;   LInclude1 = [IncludeFile|LInclude]
@@ -338,79 +359,79 @@ cmd_line_arg1('--output', LArg, LArg1) :-
 	;   format('FILE missing after --output option~n', []),
 	    abandon_exec
 	),
-	g_read(wamfile, WamFile0),
+	g_read('$wamfile', WamFile0),
 	(   WamFile0 = '' ->
 	    true
 	;   format('output file already specified (~a)~n', [WamFile0]),
 	    abandon_exec
 	),
-	g_assign(wamfile, WamFile).
+	g_assign('$wamfile', WamFile).
 
 cmd_line_arg1('-i', LArg, LArg1) :-
 	cmd_line_arg1('--include', LArg, LArg1).
 
 cmd_line_arg1('--include', [File|LArg], LArg) :-
 	prolog_file_name(File, PlFile),
-	g_assign(include_file, PlFile).
+	g_assign('$include_file', PlFile).
 
 cmd_line_arg1('-W', LArg, LArg1) :-
 	cmd_line_arg1('--wam-for-native', LArg, LArg1).
 
 cmd_line_arg1('--wam-for-native', LArg, LArg) :-
-	g_assign(native_code, t).
+	g_assign('$native_code', t).
 
 cmd_line_arg1('-w', LArg, LArg1) :-
 	cmd_line_arg1('--wam-for-byte-code', LArg, LArg1).
 
 cmd_line_arg1('--wam-for-byte-code', LArg, LArg) :-
-	g_assign(native_code, f),
-	g_assign(inline, f),                              % force --no-inline
-	g_assign(call_c, f).                              % force --no-call-c
+	g_assign('$native_code', f),
+	g_assign('$inline', f),                              % force --no-inline
+	g_assign('$call_c', f).                              % force --no-call-c
 
 cmd_line_arg1('--wam-comment', [Cmt|LArg], LArg) :-
-	g_assign(wam_comment, Cmt).
+	g_assign('$wam_comment', Cmt).
 
 cmd_line_arg1('--no-susp-warn', LArg, LArg) :-
-	g_assign(susp_warn, f).
+	g_assign('$susp_warn', f).
 
 cmd_line_arg1('--no-singl-warn', LArg, LArg) :-
-	g_assign(singl_warn, f).
+	g_assign('$singl_warn', f).
 
 cmd_line_arg1('--no-redef-error', LArg, LArg) :-
-	g_assign(redef_error, f).
+	g_assign('$redef_error', f).
 
 cmd_line_arg1('--foreign-only', LArg, LArg) :-
-	g_assign(foreign_only, t).
+	g_assign('$foreign_only', t).
 
 cmd_line_arg1('--no-call-c', LArg, LArg) :-
-	g_assign(call_c, f).
+	g_assign('$call_c', f).
 
 cmd_line_arg1('--no-inline', LArg, LArg) :-
-	g_assign(inline, f).
+	g_assign('$inline', f).
 
 cmd_line_arg1('--no-reorder', LArg, LArg) :-
-	g_assign(reorder, f).
+	g_assign('$reorder', f).
 
 cmd_line_arg1('--no-reg-opt', LArg, LArg) :-
-	g_assign(reg_opt, 0).
+	g_assign('$reg_opt', 0).
 
 cmd_line_arg1('--min-reg-opt', LArg, LArg) :-
-	g_assign(reg_opt, 1).
+	g_assign('$reg_opt', 1).
 
 cmd_line_arg1('--no-opt-last-subterm', LArg, LArg) :-
-	g_assign(opt_last_subterm, f).
+	g_assign('$opt_last_subterm', f).
 
 cmd_line_arg1('--fast-math', LArg, LArg) :-
-	g_assign(fast_math, t).
+	g_assign('$fast_math', t).
 
 cmd_line_arg1('--keep-void-inst', LArg, LArg) :-
-	g_assign(keep_void_inst, t).
+	g_assign('$keep_void_inst', t).
 
 cmd_line_arg1('--statistics', LArg, LArg) :-
-	g_assign(statistics, t).
+	g_assign('$statistics', t).
 
 cmd_line_arg1('--compile-msg', LArg, LArg) :-
-	g_assign(compile_msg, t).
+	g_assign('$compile_msg', t).
 
 cmd_line_arg1('--version', LArg, LArg) :-
 	display_copying,
@@ -436,13 +457,13 @@ cmd_line_arg1(Arg, _, _) :-
 	abandon_exec.
 
 cmd_line_arg1(PlFile, LArg, LArg) :-
-	g_read(plfile, PlFile0),
+	g_read('$plfile', PlFile0),
 	(   PlFile0 = '' ->
 	    true
 	;   format('input file already specified (~a)~n', [PlFile0]),
 	    abandon_exec
 	),
-	g_assign(plfile, PlFile).
+	g_assign('$plfile', PlFile).
 
 
 
@@ -508,14 +529,3 @@ h('  --help                      print this help and exit').
 h('  --version                   print version number and exit').
 h('').
 h('''user'' can be given as FILE for the standard input/output').
-
-
-
-
-          % Starting directive
-
-go :-
-	argument_list(LArg),
-	pl2wam(LArg).
-
-:-	initialization(go).
@@ -61,13 +61,13 @@
  *                                                                         *
  * Buffers for special predicate management (with assert/retract):         *
  *                                                                         *
- * buff_aux_pred(Pred,N,LSrcCl):                                           *
+ * '$buff_aux_pred'(Pred,N,LSrcCl):                                        *
  *    records the clauses of an auxiliary predicate.                       *
  *    Asserted by Pass 1 (syntactic sugar removing) when splitting ;/2,etc.*
  *    Retracted at the very next invocation of read_predicate/3 to         *
  *    ensure that aux. predicates always follow their "father" predicate.  *
  *                                                                         *
- * buff_discontig_clause(Pred,N,SrcCl):                                    *
+ * '$buff_discontig_clause'(Pred,N,SrcCl):                                 *
  *    records a clause of a discontiguous predicate (:- discontiguous).    *
  *    Each clause of a discontiguous predicate is asserted when it is read *
  *    When the end of file is reached all clauses of a discontiguous pred  *
@@ -75,7 +75,7 @@
  *    Thus discontiguous predicates are always compiled after other        *
  *    predicates.                                                          *
  *                                                                         *
- * buff_dyn_interf_clause(Pred,N,SrcCl):                                   *
+ * '$buff_dyn_interf_clause'(Pred,N,SrcCl):                                *
  *    records the interface clause of a dynamic predicate (:- dynamic).    *
  *    This clause is of the form Head:- call(Head) and only ensures that   *
  *    an external invocation to this predicate will not need to know that  *
@@ -85,25 +85,25 @@
  *    a dynamic predicate give rise to a system executable directive to    *
  *    assert(z) it.                                                        *
  *                                                                         *
- * empty_dyn_pred(Pred,N,Where):                                           *
+ * '$empty_dyn_pred'(Pred,N,Where):                                        *
  *    asserted when the declaration of a dynamic predicate is encoutered   *
  *    (:- dynamic). Retracted when a clause of a dynamic predicate is read.*
  *    At the end, only contains dynamic predicate with no clauses.         *
  *    Used then to define the interface clause.                            *
  *                                                                         *
- * ensure_linked(Pred,N):                                                  *
+ * '$ensure_linked'(Pred,N):                                               *
  *    asserted for each Pred/N occuring in a :- ensure_linked directive.   *
  *                                                                         *
- * module_export(Pred,N,Module):                                           *
+ * '$module_export'(Pred,N,Module):                                        *
  *    asserted for each imported Pred/N from Module.                       *
  *    asserted for each exported Pred/N from Module.                       *
  *                                                                         *
- * meta_pred(Pred,N,MetaDecl):                                             *
+ * '$meta_pred'(Pred,N,MetaDecl):                                          *
  *    asserted for each meta_predicate declaration.                        *
  *                                                                         *
  * Buffers for executable directive management (with assert/retract):      *
  *                                                                         *
- * buff_exe_system(SrcDirec)                                               *
+ * '$buff_exe_system'(SrcDirec)                                            *
  *     SrcDirec = Where+Body (i.e. source directive).                      *
  *     records a system directive.                                         *
  *     Asserted for dynamic clauses (to assertz it), and to execute, at    *
@@ -111,7 +111,7 @@
  *     Retracted only when the end of file has been reached to provide a   *
  *     predicate '$exe_system':- Body.                                     *
  *                                                                         *
- * buff_exe_user(SrcDirec)                                                 *
+ * '$buff_exe_user'(SrcDirec)                                              *
  *     records user defined directives (:- initialization).                *
  *     Asserted when a :- initialization declaration is encountered.       *
  *     Retracted just after all '$buff_exe_system' to ensure that any user *
@@ -119,73 +119,78 @@
  *                                                                         *
  * Buffers for special clause management (with assert/retract):            *
  *                                                                         *
- * buff_raw_clause(Cl,Where):                                              *
+ * '$buff_raw_clause'(Cl,Where):                                           *
  *    to handle term_expansion/2 which can return a list of (raw) clauses. *
  *    The first one is handled directly, for the others we                 *
- *    assert/retract(buff_raw_clause(Cl,Where)).                           *
+ *    assert/retract('$buff_raw_clause'(Cl,Where)).                        *
  *    Read at the very next invocation of get_next_clause/3.               *
  *                                                                         *
- * buff_src_clause(Pred,N,SrcCl):                                          *
+ * '$buff_src_clause'(Pred,N,SrcCl):                                       *
  *    the reader needs a lookahead clause (to group clauses by predicates).*
- *    For such a clause we assert/retract(buff_src_clause(Pred,N,SrcCl)).  *
+ *    For such a clause we assert/retract it.                              *
  *    Read at the next invocation of get_next_clause/3.                    *
+ *    Also used for the 1st (renamed) clause of a tabled predicate.        *
  *-------------------------------------------------------------------------*/
 
-:- op(200, fx, ?).
-
 read_file_init :-
 	pp_start,
-	retractall(buff_raw_clause(_, _)),
-	retractall(buff_src_clause(_, _, _)),
-	retractall(buff_aux_pred(_, _, _)),
-	retractall(buff_discontig_clause(_, _, _)),
-	retractall(buff_dyn_interf_clause(_, _, _)),
-	retractall(buff_exe_system(_)),
-	retractall(buff_exe_user(_)),
-	retractall(empty_dyn_pred(_, _, _)),
-	retractall(ensure_linked(_, _)),
-	retractall(pred_info(_, _, _)),
-	retractall(module_export(_, _, _)),
-	retractall(meta_pred(_, _, _)),
-	g_assign(module, user),
-	g_assign(module_already_seen, f),
-	g_assign(default_kind, user),
-	g_assign(open_file_stack, []),
-	g_assign(where, 0),
-	g_assign(syn_error_nb, 0),
-	g_assign(in_lines, 0),
-	g_assign(in_bytes, 0),
-	g_assign(compiler_mode, default),
+	read_file_clean,
+	g_assign('$module', user),
+	g_assign('$module_already_seen', f),
+	g_assign('$default_kind', user),
+	g_assign('$open_file_stack', []),
+	g_assign('$where', 0),
+	g_assign('$syn_error_nb', 0),
+	g_assign('$in_lines', 0),
+	g_assign('$in_bytes', 0),
+	g_assign('$compiler_mode', default),
 	set_pred_flag(dyn, term_expansion, 2).
 
 
 
 
+read_file_clean :-
+	retractall('$buff_raw_clause'(_, _)),
+	retractall('$buff_src_clause'(_, _, _)),
+	retractall('$buff_aux_pred'(_, _, _)),
+	retractall('$buff_discontig_clause'(_, _, _)),
+	retractall('$buff_dyn_interf_clause'(_, _, _)),
+	retractall('$buff_exe_system'(_)),
+	retractall('$buff_exe_user'(_)),
+	retractall('$empty_dyn_pred'(_, _, _)),
+	retractall('$ensure_linked'(_, _)),
+	retractall('$pred_info'(_, _, _)),
+	retractall('$module_export'(_, _, _)),
+	retractall('$meta_pred'(_, _, _)).
+
+
+
+
 read_file_init(PlFile) :-
-	g_assign(reading_dyn_pred, f),
-	g_assign(eof_reached, f),
+	g_assign('$reading_dyn_pred', f),
+	g_assign('$eof_reached', f),
 	open_new_prolog_file(PlFile, 0). % 0 means parent = command-line
 
 
 
 
 read_file_term(Bytes, Lines) :-
-	g_read(in_bytes, Bytes),
-	g_read(in_lines, Lines).
+	g_read('$in_bytes', Bytes),
+	g_read('$in_lines', Lines).
 
 
 
 
 read_file_error_nb(SynErrNb) :-
-	g_read(syn_error_nb, SynErrNb).
+	g_read('$syn_error_nb', SynErrNb).
 
 
 
 
 open_new_prolog_file(PlFile, ParIncLine) :-
-	g_read(open_file_stack, OpenFileStack),
+	g_read('$open_file_stack', OpenFileStack),
 	open_new_prolog_file1(PlFile, OpenFileStack, PlFile1, Stream), !,
-	g_assign(open_file_stack, [of(PlFile1, Stream, ParIncLine)|OpenFileStack]),
+	g_assign('$open_file_stack', [of(PlFile1, Stream, ParIncLine)|OpenFileStack]),
 	(   peek_char(Stream, '#'), % ignore #! starting line (for shebang support)
 	    repeat,
 	    get_char(Stream, X),
@@ -231,17 +236,20 @@ try_other_directory([_|OpenFileStack], PlFile, PlFile1, Stream) :-
 
 
 close_last_prolog_file :-
-	g_read(open_file_stack, [of(_, Stream, _)|OpenFileStack]),
-	g_assign(open_file_stack, OpenFileStack),
-	g_read(in_bytes, Bytes1),
-	g_read(in_lines, Lines1),
+	g_read('$open_file_stack', [of(PlFile, Stream, _)|OpenFileStack]),
+	g_assign('$open_file_stack', OpenFileStack),
+	g_read('$in_bytes', Bytes1),
+	g_read('$in_lines', Lines1),
 	character_count(Stream, Bytes2),
 	line_count(Stream, Lines2),
 	Bytes is Bytes1 + Bytes2,
 	Lines is Lines1 + Lines2,
-	g_assign(in_bytes, Bytes),
-	g_assign(in_lines, Lines),
-	close(Stream).
+	g_assign('$in_bytes', Bytes),
+	g_assign('$in_lines', Lines),
+	(   PlFile = user ->		% do not close the input of the caller
+	    true
+	;   close(Stream)
+	).
 
 
 
@@ -252,8 +260,8 @@ read_predicate(Pred, N, LSrcCl) :-
 	repeat,
 	read_predicate1(Pred, N, LSrcCl),                % standard predicate
 % !,
-	(   g_read(reading_dyn_pred, f),
-	    g_read(native_code, t) ->
+	(   g_read('$reading_dyn_pred', f),
+	    g_read('$native_code', t) ->
 	    read_predicate_next(Pred, N, LSrcCl)
 	;   true
 	).
@@ -278,16 +286,16 @@ read_predicate_next(_, _, _).
 
 
 read_predicate1(Pred, N, LSrcCl) :-
-	retract(buff_aux_pred(Pred, N, LSrcCl)), !. % aux. pred (cf syn_sugar)
+	retract('$buff_aux_pred'(Pred, N, LSrcCl)), !. % aux. pred (cf syn_sugar)
 
 read_predicate1(Pred, N, LSrcCl) :-
-	g_read(eof_reached, f), !,
+	g_read('$eof_reached', f), !,
 	repeat,
 	get_next_clause(Pred, N, SrcCl),
 	SrcCl = _ + Cl,
-	retractall(empty_dyn_pred(Pred, N, _)),
+	retractall('$empty_dyn_pred'(Pred, N, _)),
 	(   test_pred_flag(discontig, Pred, N) ->
-	    assertz(buff_discontig_clause(Pred, N, SrcCl)),
+	    assertz('$buff_discontig_clause'(Pred, N, SrcCl)),
 	    define_predicate(Pred, N),
 	    fail                               % backtrack to read_predicate1
 	;   true
@@ -303,31 +311,31 @@ read_predicate1(Pred, N, LSrcCl) :-
 	group_clauses_by_pred(Pred, N, SrcCl, LSrcCl).
 
 read_predicate1(Pred, N, [SrcCl|LSrcCl]) :-
-	retract(buff_discontig_clause(Pred, N, SrcCl)), !,  % discontiguous pred
+	retract('$buff_discontig_clause'(Pred, N, SrcCl)), !,  % discontiguous pred
 	collect_discontig_clauses(Pred, N, LSrcCl).
 
 read_predicate1(Pred, N, [SrcCl]) :-
-	g_assign(reading_dyn_pred, t),
-	retract(buff_dyn_interf_clause(Pred, N, SrcCl)), !.     % dyn predicate
+	g_assign('$reading_dyn_pred', t),
+	retract('$buff_dyn_interf_clause'(Pred, N, SrcCl)), !.     % dyn predicate
 
 read_predicate1(Pred, N, [SrcCl]) :-
-	g_assign(reading_dyn_pred, t),
-	retract(empty_dyn_pred(Pred, N, Where)),        % empty dyn predicate
+	g_assign('$reading_dyn_pred', t),
+	retract('$empty_dyn_pred'(Pred, N, Where)),        % empty dyn predicate
 	define_predicate(Pred, N),
-	(   g_read(native_code, t) ->
+	(   g_read('$native_code', t) ->
 	    create_dyn_interf_clause(Pred, N, Where, SrcCl)
 	;   SrcCl = Where + '$$empty$$predicate$$clause$$'
 	), !.
 
 read_predicate1(Pred, N, LSrcCl) :-
-	g_assign(reading_dyn_pred, f),
-	retract(buff_exe_system(Where + Body)),       % system exe directives
+	g_assign('$reading_dyn_pred', f),
+	retract('$buff_exe_system'(Where + Body)),       % system exe directives
 	Pred = '$exe_system',
 	N = 0,
 	LSrcCl = [Where + (Pred :- Body)], !.
 
 read_predicate1(Pred, N, LSrcCl) :-
-	retract(buff_exe_user(Where + Body)),           % user exe directives
+	retract('$buff_exe_user'(Where + Body)),           % user exe directives
 	Pred = '$exe_user',
 	N = 0,
 	LSrcCl = [Where + (Pred :- Body)], !.
@@ -350,7 +358,7 @@ group_clauses_by_pred(Pred, N, SrcCl, [SrcCl|LSrcCl1]) :-
 	    (   Pred1 = end_of_file,
 	        N1 = 0 ->
 	        true
-	    ;   asserta(buff_src_clause(Pred1, N1, SrcCl1))
+	    ;   asserta('$buff_src_clause'(Pred1, N1, SrcCl1))
 	    )
 	).
 
@@ -358,11 +366,11 @@ group_clauses_by_pred(Pred, N, SrcCl, [SrcCl|LSrcCl1]) :-
 
 
 add_dyn_interf_clause(Pred, N, _) :-
-	clause(buff_dyn_interf_clause(Pred, N, _), true), !.  % already asserted
+	clause('$buff_dyn_interf_clause'(Pred, N, _), true), !.  % already asserted
 
 add_dyn_interf_clause(Pred, N, Where) :-
 	create_dyn_interf_clause(Pred, N, Where, SrcCl),
-	assertz(buff_dyn_interf_clause(Pred, N, SrcCl)).
+	assertz('$buff_dyn_interf_clause'(Pred, N, SrcCl)).
 
 
 
@@ -376,14 +384,14 @@ create_dyn_interf_clause(Pred, N, Where, SrcCl) :-
 
 /* Version with findall */
 collect_discontig_clauses(Pred, N, LSrcCl) :-
-	findall(SrcCl, retract(buff_discontig_clause(Pred, N, SrcCl)), LSrcCl).
+	findall(SrcCl, retract('$buff_discontig_clause'(Pred, N, SrcCl)), LSrcCl).
 
 /* Version with retract recursive (do not omit the cut). Can be worse than 
  * with findall depending on how LDUV is implemented (see dynam_supp.c)
  */
 /*
 collect_discontig_clauses(Pred, N, [SrcCl|LSrcCl]) :-
-	retract(buff_discontig_clause(Pred, N, SrcCl)), !,
+	retract('$buff_discontig_clause'(Pred, N, SrcCl)), !,
 	collect_discontig_clauses(Pred, N, LSrcCl).
 
 collect_discontig_clauses(_, _, []).
@@ -418,33 +426,38 @@ get_file_name([of(PlFile, _, _)|_] + _, PlFile).
 
 
 
-get_next_clause(Pred, N, SrcCl) :-
-	retract(buff_raw_clause(Cl, Where)), !,
-	g_assign(where, Where),
-	get_next_clause2(Cl, Where, [], Pred, N, SrcCl).
+get_next_clause(Pred, N, SrcCl) :-	% a lookahead clause precedes raw ones
+	retract('$buff_src_clause'(Pred, N, SrcCl)), !,
+	SrcCl = Where + _,
+	g_assign('$where', Where).
 
 
 get_next_clause(Pred, N, SrcCl) :-
-	retract(buff_src_clause(Pred, N, SrcCl)), !,
-	SrcCl = Where + _,
-	g_assign(where, Where).
+	retract('$buff_raw_clause'(Cl, Where)), !,
+	g_assign('$where', Where),
+	get_next_clause2(Cl, Where, [], Pred, N, SrcCl).
 
 get_next_clause(Pred, N, SrcCl) :-
-	g_read(open_file_stack, OpenFileStack),
+	g_read('$open_file_stack', OpenFileStack),
 	OpenFileStack = [of(_, Stream, _)|_],
-	'$catch'(read_term(Stream, Cl, [singletons(SingNames)]), error(syntax_error(Err), _), after_syn_error, any, 0, false),
+	'$catch'(read_term(Stream, Cl, [singletons(SingNames)]), error(syntax_error(Err), _), true, any, 0, false),
 	(   var(Err) ->
 	    last_read_start_line_column(L1, _),
-	    '$catch'('$expand_term1'(Cl, Cl1, TermExpans), error(Err, _), expand_error(Err, Cl, Cl1), any, 0, false),
+	    '$catch'('$expand_term1'(Cl, Cl1, TermExpans), error(ExpErr, _), true, any, 0, false),
+	    (   var(ExpErr) ->
+	        true
+	    ;   expand_error(ExpErr, Cl, Cl1)
+	    ),
 	    stream_line_column(Stream, Line, Col),
 	    (   Col = 1 ->
 	        L2 is Line - 1
 	    ;   L2 = Line
 	    ),
 	    Where = OpenFileStack + (L1 - L2),
-	    g_assign(where, Where),
+	    g_assign('$where', Where),
 	    get_next_clause1(Cl1, Where, SingNames, Pred, N, SrcCl, TermExpans)
-	;   get_next_clause(Pred, N, SrcCl)
+	;   after_syn_error,
+	    get_next_clause(Pred, N, SrcCl)
 	), !.
 
 
@@ -455,7 +468,7 @@ get_next_clause1(LstCl, Where, SingNames, Pred, N, SrcCl, TermExpans) :-
 	    get_next_clause(Pred, N, SrcCl)
 	;   LstCl = [Cl|LstCl1],	    
 	    (   member(Cl1, LstCl1),
-	        assertz(buff_raw_clause(Cl1, Where)),
+	        assertz('$buff_raw_clause'(Cl1, Where)),
 	        fail
 	    ;
 		get_next_clause2(Cl, Where, SingNames, Pred, N, SrcCl)
@@ -470,12 +483,12 @@ get_next_clause1(Cl, Where, SingNames, Pred, N, SrcCl, _) :-
 
 get_next_clause2(end_of_file, _, _, Pred, N, SrcCl) :-
 	close_last_prolog_file,
-	g_read(open_file_stack, OpenFileStack),
+	g_read('$open_file_stack', OpenFileStack),
 	(   OpenFileStack = [] ->
 	    Pred = end_of_file,
 	    N = 0,
 	    SrcCl = _ + end_of_file,
-	    g_assign(eof_reached, t),
+	    g_assign('$eof_reached', t),
 	    pp_stop
 	;
 	    get_next_clause(Pred, N, SrcCl)
@@ -487,7 +500,7 @@ get_next_clause2(T, _, _, Pred, N, SrcCl) :-
 
 get_next_clause2((:- D), Where, SingNames, Pred, N, SrcCl) :- % other directives than pp
 	display_singletons(SingNames),
-	(   g_read(foreign_only, f)
+	(   g_read('$foreign_only', f)
 	;   functor(D, foreign, _)
 	),
 	(   handle_directive(D, Where)
@@ -495,7 +508,7 @@ get_next_clause2((:- D), Where, SingNames, Pred, N, SrcCl) :- % other directives
 	), !,
 	get_next_clause(Pred, N, SrcCl).
 
-get_next_clause2(Cl, Where, SingNames, Pred, N, Where + Cl) :-
+get_next_clause2(Cl, Where, SingNames, Pred1, N, SrcCl) :-
 	(   Cl = (Head :- _) ->
 	    true
 	;   Cl = Head
@@ -506,8 +519,9 @@ get_next_clause2(Cl, Where, SingNames, Pred, N, Where + Cl) :-
 	check_module_clash(Pred, N),
 	check_predicate(Pred, N),
 	display_singletons(SingNames),
-	g_read(foreign_only, f),	    % fail if --foreign-only
-	embed_clause(Pred, N, Cl), !.    % fail if embed only (no compiled)
+	g_read('$foreign_only', f),	    % fail if --foreign-only
+	embed_clause(Pred, N, Cl), !,    % fail if embed only (no compiled)
+	table_clause(Pred, N, Cl, Where, Pred1, SrcCl).
 
 		% ignore clause with --foreign-only or if embed only
 get_next_clause2(_, _, _, Pred, N, SrcCl) :-
@@ -516,13 +530,69 @@ get_next_clause2(_, _, _, Pred, N, SrcCl) :-
 
 
 
+	% a clause of a tabled predicate p/n is renamed as a clause of an aux
+	% predicate (the implementation). When the 1st clause is read, the
+	% clause returned is the one of the tabled predicate p/n (see table.pl)
+	% and the renamed clause is the lookahead clause.
+
+table_clause(Pred, N, Cl, Where, Pred, Where + Cl) :-
+	test_not_pred_flag(table, Pred, N), !.
+
+table_clause(Pred, N, _, _, _, _) :-
+	test_pred_flag(dyn, Pred, N), !,
+	error('a dynamic predicate cannot be tabled (~q)', [Pred / N]).
+
+table_clause(Pred, N, Cl, Where, Pred1, SrcCl) :-
+	'$make_aux_name'(Pred, N, 0, Impl),
+	(   Cl = (Head :- Body) ->
+	    Cl1 = (Head1 :- Body)
+	;   Head = Cl,
+	    Cl1 = Head1
+	),
+	Head =.. [_|LArg],
+	Head1 =.. [Impl|LArg],
+	(   test_pred_flag(discontig, Pred, N) ->
+	    set_pred_flag(discontig, Impl, N)
+	;   true
+	),
+	(   test_pred_flag(def, Pred, N) ->
+	    Pred1 = Impl,
+	    SrcCl = Where + Cl1
+	;   assertz('$buff_src_clause'(Impl, N, Where + Cl1)),
+	    Pred1 = Pred,
+	    table_pred_clause(Pred, N, Impl, Cl2),
+	    SrcCl = Where + Cl2
+	).
+
+
+
+
+table_pred_clause(Pred, N, Impl, (Head :- Body)) :-
+	functor(Head, Pred, N),
+	Head =.. [_|LArg],
+	Goal =.. [Impl|LArg],
+	Body = ('$tbl_variant'(Head, S, E, Act),
+		(   Act = 1 ->
+		    (   '$tbl_iteration'(S),
+			Goal,
+			'$tbl_add_answer'(S, Head),
+			fail
+		    ;   true
+		    )
+		;   true
+		),
+		'$tbl_answers'(S, E, Head)).
+
+
+
+
 after_syn_error :-
-	g_read(syn_error_nb, SynErrNb),
+	g_read('$syn_error_nb', SynErrNb),
 	SynErrNb1 is SynErrNb + 1,
-	g_assign(syn_error_nb, SynErrNb1),
+	g_assign('$syn_error_nb', SynErrNb1),
 	syntax_error_info(_, Line, Column, Msg),
-	g_read(open_file_stack, OpenFileStack),
-	g_assign(where, OpenFileStack + (Line - Line)),
+	g_read('$open_file_stack', OpenFileStack),
+	g_assign('$where', OpenFileStack + (Line - Line)),
 	disp_msg('syntax error', Column, '~a', [Msg]).
 
 
@@ -533,15 +603,15 @@ expand_error(existence_error(procedure,'$expand_term1'/3), Cl, Cl) :-
 
 expand_error(Err, Cl, Cl) :-
 	last_read_start_line_column(Line, _),
-	g_read(open_file_stack, OpenFileStack),
-	g_assign(where, OpenFileStack + (Line - Line)),
+	g_read('$open_file_stack', OpenFileStack),
+	g_assign('$where', OpenFileStack + (Line - Line)),
 	warn('term rewriting (DCG or term_expansion/2) raised exception: ~q', [Err]).
 
 
 
 
 display_singletons(SingNames) :-
-	g_read(singl_warn, t), !,
+	g_read('$singl_warn', t), !,
 	get_singletons(SingNames, Sing),
 	(   Sing = [] ->
 	    true
@@ -582,23 +652,23 @@ pp_handle_term((:- D)) :-
 	pp_handle_directive(D), !.
 
 pp_handle_term(_) :-
-	g_read(pp_stack, [pp(_, Action)|_]),
+	g_read('$pp_stack', [pp(_, Action)|_]),
 	Action \== keep.	% success = ignore term, failure = continue with term
 
 
 
 
 pp_handle_directive(if(Goal)) :-
-	g_read(pp_stack, PPStack),
+	g_read('$pp_stack', PPStack),
 	(   PPStack = [pp(_, Action)|_], Action \== keep -> % fail is pp_stack is empty
-	    g_assign(pp_stack, [pp(in_then, ignore_all)|PPStack])
+	    g_assign('$pp_stack', [pp(in_then, ignore_all)|PPStack])
 	;   pp_exec_if_goal(Goal, PPStack, if)
 	).
 
 pp_handle_directive(elif(Goal)) :-
-	(   g_read(pp_stack, [pp(in_then, Action)|PPStack]) ->
+	(   g_read('$pp_stack', [pp(in_then, Action)|PPStack]) ->
 	    (   Action \== ignore ->
-		g_assign(pp_stack, [pp(in_then, ignore_all)|PPStack])
+		g_assign('$pp_stack', [pp(in_then, ignore_all)|PPStack])
 	    ;	pp_exec_if_goal(Goal, PPStack, elif)
 	    )
 	;
@@ -606,20 +676,20 @@ pp_handle_directive(elif(Goal)) :-
 	).
 
 pp_handle_directive(else) :-
-	(   g_read(pp_stack, [pp(in_then, Action)|PPStack]) ->
+	(   g_read('$pp_stack', [pp(in_then, Action)|PPStack]) ->
 	    (	Action = keep, Action1 = ignore
 	    ;	Action = ignore, Action1 = keep
 	    ;	Action = ignore_all, Action1 = ignore_all
 	    ), !,
-	    g_assign(pp_stack, [pp(in_else, Action1)|PPStack])
+	    g_assign('$pp_stack', [pp(in_else, Action1)|PPStack])
 	;
 	    error('unexpected else directive', [])
 	).
 
 
 pp_handle_directive(endif) :-
-	(   g_read(pp_stack, [_|PPStack]) ->
-	    g_assign(pp_stack, PPStack)
+	(   g_read('$pp_stack', [_|PPStack]) ->
+	    g_assign('$pp_stack', PPStack)
 	;   error('unexpected endif directive', [])
 	).
 
@@ -627,23 +697,27 @@ pp_handle_directive(endif) :-
 
 
 pp_exec_if_goal(Goal, PPStack, What) :-
-	(   '$catch'(Goal, Err, (warn('~a directive raised exception: ~q', [What, Err]), fail),
-		     What, 1, false) ->
-	    g_assign(pp_stack, [pp(in_then, keep)|PPStack])
-	;   g_assign(pp_stack, [pp(in_then, ignore)|PPStack])
+	(   '$catch'(Goal, Err, true, What, 1, false),
+	    (   var(Err) ->
+	        true
+	    ;   warn('~a directive raised exception: ~q', [What, Err]),
+	        fail
+	    ) ->
+	    g_assign('$pp_stack', [pp(in_then, keep)|PPStack])
+	;   g_assign('$pp_stack', [pp(in_then, ignore)|PPStack])
 	).
 
 
 
 
 pp_start :-
-	g_assign(pp_stack, []).
+	g_assign('$pp_stack', []).
 
 
 
 
 pp_stop :-
-	g_read(pp_stack, []), !.
+	g_read('$pp_stack', []), !.
 
 pp_stop :-
 	error('endif directive expected', []).
@@ -684,6 +758,11 @@ handle_directive(multifile, DLst, Where) :-
 	set_flag_for_preds(DLst, multi),
 	add_empty_dyn(DLst, Where).
 
+handle_directive(table, DLst, _) :-
+	!,
+	check_pi_list(DLst, f),
+	set_flag_for_preds(DLst, table).
+
 handle_directive(discontiguous, DLst, _) :-
 	!,
 	check_pi_list(DLst, f),
@@ -692,16 +771,16 @@ handle_directive(discontiguous, DLst, _) :-
 handle_directive(compiler_mode, [CompMode], _) :-
 	!,
 	(   memberchk(CompMode, [default, embed, compile]),
-	    g_assign(compiler_mode, CompMode)
+	    g_assign('$compiler_mode', CompMode)
 	;   memberchk(CompMode, [embed_compile, both, embed+compile, compile+embed]),
-	    g_assign(compiler_mode, embed_compile)
+	    g_assign('$compiler_mode', embed_compile)
 	), !.
 
 handle_directive(built_in, DLst, _) :-
 	!,
 	check_pi_list(DLst, t),
 	(   DLst = [] ->
-	    g_assign(default_kind, built_in)
+	    g_assign('$default_kind', built_in)
 	;   set_flag_for_preds(DLst, bpl)
 	).
 
@@ -709,14 +788,18 @@ handle_directive(built_in_fd, DLst, _) :-
 	!,
 	check_pi_list(DLst, t),
 	(   DLst = [] ->
-	    g_assign(default_kind, built_in_fd)
+	    g_assign('$default_kind', built_in_fd)
 	;   set_flag_for_preds(DLst, bfd)
 	).
 
+handle_directive(hidden, [], _) :-
+	!,
+	g_assign('$default_kind', hidden).
+
 handle_directive(ensure_linked, DLst, _) :-
 	!,
 	check_pi_list(DLst, f),
-	(   g_read(native_code, f) ->
+	(   g_read('$native_code', f) ->
 	    warn('ensure_linked directive ignored in byte-code compilation mode', [])
 	;   add_ensure_linked(DLst)
 	).
@@ -749,15 +832,15 @@ handle_directive(set_prolog_flag, [X, Y], Where) :-
 	handle_init_directive(set_prolog_flag(X, Y), system, Where),
 	(   X = singleton_warning -> % singl_warn and singleton_warning flag can be decorelated (use only flag ?)
 	    (   current_prolog_flag(singleton_warning, off) ->
-		g_assign(singl_warn, f)
-	    ;   g_assign(singl_warn, t)
+		g_assign('$singl_warn', f)
+	    ;   g_assign('$singl_warn', t)
 	    )
 	;   true
 	),
 	(   X = suspicious_warning -> % idem for susp_warn and suspicious_warning flag
 	    (   current_prolog_flag(suspicious_warning, off) ->
-		g_assign(susp_warn, f)
-	    ;   g_assign(susp_warn, t)
+		g_assign('$susp_warn', f)
+	    ;   g_assign('$susp_warn', t)
 	    )
 	;   true
 	).
@@ -770,9 +853,9 @@ handle_directive(module, [Module, DLst], _) :-
 	!,
 	check_pi_list(DLst, f),
 	check_module_name(Module, f),
-	(   g_read(module_already_seen, f) ->
-	    g_assign(module_already_seen, t),
-	    g_assign(module, Module),
+	(   g_read('$module_already_seen', f) ->
+	    g_assign('$module_already_seen', t),
+	    g_assign('$module', Module),
 	    add_module_export_info(DLst, Module)
 	;
 	    error('directive module/2 already declared', [])
@@ -788,10 +871,10 @@ handle_directive(meta_predicate, [MetaDecl], Where) :-
 	(   callable(MetaDecl) ->
 	    functor(MetaDecl, Pred, N),
 	    set_flag_for_preds(Pred/N, meta),
-	    assertz(meta_pred(Pred, N, MetaDecl)),
+	    assertz('$meta_pred'(Pred, N, MetaDecl)),
 	    set_flag_for_preds('$prop_meta_pred'/3, discontig),
 	    set_flag_for_preds('$prop_meta_pred'/3, multi),
-	    assertz(buff_discontig_clause('$prop_meta_pred', 3, Where+'$prop_meta_pred'(Pred, N, MetaDecl)))
+	    assertz('$buff_discontig_clause'('$prop_meta_pred', 3, Where+'$prop_meta_pred'(Pred, N, MetaDecl)))
 	;
 	    error('invalide directive meta_predicate/1 ~q', [MetaDecl])
 	).
@@ -801,7 +884,7 @@ handle_directive(foreign, [Template], Where) :-
 	handle_directive(foreign, [Template, []], Where).
 
 handle_directive(foreign, _, _) :-
-	g_read(call_c, f), !,
+	g_read('$call_c', f), !,
 	warn('foreign directive ignored (not allowed in this mode)', []).
 
 handle_directive(foreign, [Template, Options], Where) :-
@@ -813,20 +896,20 @@ handle_directive(foreign, [Template, Options], Where) :-
 	    error('foreign predicate ~q should not be public/dynamic', [Pred/N])
 	;   true),
 	define_predicate(Pred, N),
-	g_assign(foreign_fct_name, Pred),
-	g_assign(foreign_return, boolean),
-	g_assign(foreign_bip, Pred/N),
-	g_assign(foreign_choice_size, -1),
+	g_assign('$foreign_fct_name', Pred),
+	g_assign('$foreign_return', boolean),
+	g_assign('$foreign_bip', Pred/N),
+	g_assign('$foreign_choice_size', -1),
 	foreign_get_options(Options),
 	foreign_check_types(0, N, Template, LType),
-	g_read(foreign_fct_name, FctName),
-	g_read(foreign_return, Return),
-	g_read(foreign_bip, BipPred),
-	g_read(foreign_choice_size, ChcSize),
+	g_read('$foreign_fct_name', FctName),
+	g_read('$foreign_return', Return),
+	g_read('$foreign_bip', BipPred),
+	g_read('$foreign_choice_size', ChcSize),
 	mk_no_internal_transf(args(FctName, Return, BipPred, ChcSize, LType), Args),
 	functor(Head, Pred, N),
 	SrcCl = Where + (Head :- '$foreign_call_c'(Args)),
-	assertz(buff_discontig_clause(Pred, N, SrcCl)),
+	assertz('$buff_discontig_clause'(Pred, N, SrcCl)),
 	add_ensure_linked('$force_foreign_link' / 0).
                      % to force the link of foreign.o and then foreign_supp.o
 
@@ -842,7 +925,7 @@ foreign_get_options([X|Options]) :-
 
 foreign_get_options1(fct_name(FctName)) :-
 	atom(FctName),
-	g_assign(foreign_fct_name, FctName).
+	g_assign('$foreign_fct_name', FctName).
 
 foreign_get_options1(return(Return)) :-
 	atom(Return),
@@ -850,26 +933,26 @@ foreign_get_options1(return(Return)) :-
 	;   Return = boolean
 	;   Return = jump
 	),
-	g_assign(foreign_return, Return).
+	g_assign('$foreign_return', Return).
 
 foreign_get_options1(bip_name(X)) :-
 	nonvar(X),
 	X = none,
-	g_assign(foreign_bip, ''/ -1).
+	g_assign('$foreign_bip', ''/ -1).
 
 foreign_get_options1(bip_name(BipName, BipArity)) :-
 	atom(BipName),
 	integer(BipArity),
-	g_assign(foreign_bip, BipName/BipArity).
+	g_assign('$foreign_bip', BipName/BipArity).
 
 foreign_get_options1(bip_name(BipName/BipArity)) :-
 	atom(BipName),
 	integer(BipArity),
-	g_assign(foreign_bip, BipName/BipArity).
+	g_assign('$foreign_bip', BipName/BipArity).
 
 foreign_get_options1(choice_size(ChcSize)) :-
 	integer(ChcSize),
-	g_assign(foreign_choice_size, ChcSize).
+	g_assign('$foreign_choice_size', ChcSize).
 
 
 
@@ -885,7 +968,7 @@ foreign_check_types(I, N, Template, [(Mode, A)|LArgType]) :-
 	    Mode = in
 	;   Arg = - A,
 	    Mode = out
-	;   Arg = ? A,
+	;   Arg = ?(A),
 	    Mode = in_out
 	;   Arg = term,
 	    A = term,
@@ -916,7 +999,7 @@ foreign_check_arg(term).
 
 
 embed_clause(Pred, N, Cl) :-
-	g_read(compiler_mode, CompMode),
+	g_read('$compiler_mode', CompMode),
 	(   CompMode = default, Pred = term_expansion, N = 2
 	;   CompMode = embed
 	;   CompMode = embed_compile
@@ -944,15 +1027,15 @@ handle_init_directive(_, _, _).
 
 
 embed_directive(Goal, SystemUser) :-
-	g_read(compiler_mode, CompMode),
+	g_read('$compiler_mode', CompMode),
 	(   CompMode = default, SystemUser = system
 	;   CompMode = embed
 	;   CompMode = embed_compile
 	), !,
 	exec_directive(Goal),
 	(   current_prolog_flag(singleton_warning, off) -> % in case of :- set_prolog_flag
-	    g_assign(singl_warn, f)
-	;   g_assign(singl_warn, t)
+	    g_assign('$singl_warn', f)
+	;   g_assign('$singl_warn', t)
 	),
 	CompMode \== embed.	% fail if embed only (do not compile)
 
@@ -963,7 +1046,11 @@ embed_directive(_, _).
 
 exec_directive(Goal) :-
 	check_callable(Goal, 'directive goal'),
-	'$catch'(Goal, Err, exec_directive_exception(Goal, Err), any, 0, false), !.
+	'$catch'(Goal, Err, true, any, 0, false), !,
+	(   var(Err) ->
+	    true
+	;   exec_directive_exception(Goal, Err)
+	).
 
 exec_directive(Goal) :-
 	warn('directive goal failed (~q)', [Goal]).
@@ -976,10 +1063,10 @@ exec_directive_exception(Goal, Err) :-
 
 
 record_initialization(system, Body, Where) :-
-	assertz(buff_exe_system(Where + Body)).
+	assertz('$buff_exe_system'(Where + Body)).
 
 record_initialization(user, Body, Where) :-
-	assertz(buff_exe_user(Where + Body)).
+	assertz('$buff_exe_user'(Where + Body)).
 
 
 
@@ -998,9 +1085,9 @@ add_empty_dyn((P1, P2), Where) :-
 	add_empty_dyn(P2, Where).
 
 add_empty_dyn(Pred / N, Where) :-
-	(   clause(empty_dyn_pred(Pred, N, _), _) ->
+	(   clause('$empty_dyn_pred'(Pred, N, _), _) ->
 	    true
-	;   assertz(empty_dyn_pred(Pred, N, Where))
+	;   assertz('$empty_dyn_pred'(Pred, N, Where))
 	).
 
 
@@ -1020,10 +1107,10 @@ add_ensure_linked((P1, P2)) :-
 	add_ensure_linked(P2).
 
 add_ensure_linked(Pred / N) :-
-	clause(ensure_linked(Pred, N), true), !.
+	clause('$ensure_linked'(Pred, N), true), !.
 
 add_ensure_linked(Pred / N) :-
-	assertz(ensure_linked(Pred, N)).
+	assertz('$ensure_linked'(Pred, N)).
 
 
 
@@ -1042,11 +1129,11 @@ add_module_export_info((P1, P2), Module) :-
 	add_module_export_info(P2, Module).
 
 add_module_export_info(Pred / N, _) :-
-	clause(module_export(Pred, N, Module1), true), !,
+	clause('$module_export'(Pred, N, Module1), true), !,
 	error('predicate ~q already exported from module ~q', [Pred/N, Module1]).
 
 add_module_export_info(Pred / N, Module) :-
-	assertz(module_export(Pred, N, Module)),
+	assertz('$module_export'(Pred, N, Module)),
 	(   test_pred_flag(def, Pred, N) ->
 	    check_module_clash(Pred, N)
 	;   true
@@ -1134,8 +1221,8 @@ check_head_is_module_free(_).
 
 
 check_module_clash(Pred, N) :-  % Pred/N is defined in current module check for clash with an import
-	clause(module_export(Pred, N, Module), true), !,
-	g_read(module, Module1),
+	clause('$module_export'(Pred, N, Module), true), !,
+	g_read('$module', Module1),
 	Module \== Module1, !,
 	error('clash on ~q - defined in module ~q (here) and imported from ~q',
 	      [Pred / N, Module1, Module]).
@@ -1146,7 +1233,7 @@ check_module_clash(_, _).
 
 
 get_owner_module(Pred, N, Module) :-
-	clause(module_export(Pred, N, Module), true), !,
+	clause('$module_export'(Pred, N, Module), true), !,
 	Module \== system, !.
 
 get_owner_module(_, _, _).
@@ -1154,7 +1241,7 @@ get_owner_module(_, _, _).
 
 
 is_exported(Pred, N) :-
-	clause(module_export(Pred, N, _), true), !.
+	clause('$module_export'(Pred, N, _), true), !.
 
 
 
@@ -1165,7 +1252,7 @@ get_module_of_cur_pred(Module) :-
 	    Module = system
 	;   test_pred_flag(bfd, Pred, N) ->
 	    Module = system
-	;   g_read(module, Module)
+	;   g_read('$module', Module)
 	).
 
 
@@ -1223,13 +1310,18 @@ define_predicate(F, N) :-
 	test_pred_flag(bfd, F, N), !.
 
 define_predicate(F, N) :-
-	g_read(default_kind, built_in), !,
+	g_read('$default_kind', built_in), !,
 	set_pred_flag(bpl, F, N).
 
 define_predicate(F, N) :-
-	g_read(default_kind, built_in_fd), !,
+	g_read('$default_kind', built_in_fd), !,
 	set_pred_flag(bfd, F, N).
 
+define_predicate(F, N) :-		% only '$' predicates are visible if hidden
+	g_read('$default_kind', hidden),
+	sub_atom(F, 0, 1, _, '$'), !,
+	set_pred_flag(bpl, F, N).
+
 define_predicate(_, _).
 
 
@@ -1245,6 +1337,7 @@ flag_bit(need_cut_level, 6).
 flag_bit(meta, 7).
 flag_bit(multi, 8).
 flag_bit(embed, 9).
+flag_bit(table, 10).
 
 
 
@@ -1252,20 +1345,20 @@ flag_bit(embed, 9).
 /* Version with assert/retract */
 set_pred_flag(Flag, F, N) :-
 	flag_bit(Flag, Bit),
-	(   retract(pred_info(F, N, InfoMask)), !
+	(   retract('$pred_info'(F, N, InfoMask)), !
 	;   InfoMask = 0
 	), !,
 	InfoMask1 is InfoMask \/ 1 << Bit,
-	assertz(pred_info(F, N, InfoMask1)).
+	assertz('$pred_info'(F, N, InfoMask1)).
 
 
 
 
 unset_pred_flag(Flag, F, N) :-
 	flag_bit(Flag, Bit),
-	retract(pred_info(F, N, InfoMask)), !,
+	retract('$pred_info'(F, N, InfoMask)), !,
 	InfoMask1 is InfoMask /\ \ (1 << Bit),
-	assertz(pred_info(F, N, InfoMask1)).
+	assertz('$pred_info'(F, N, InfoMask1)).
 
 unset_pred_flag(_, _, _).
 
@@ -1274,7 +1367,7 @@ unset_pred_flag(_, _, _).
 
 test_pred_flag(Flag, F, N) :-
 	flag_bit(Flag, Bit),
-	clause(pred_info(F, N, InfoMask), _), !,
+	clause('$pred_info'(F, N, InfoMask), _), !,
 	InfoMask /\ 1 << Bit > 0.
 
 
@@ -1282,7 +1375,7 @@ test_pred_flag(Flag, F, N) :-
 
 test_not_pred_flag(Flag, F, N) :-
 	flag_bit(Flag, Bit),
-	clause(pred_info(F, N, InfoMask), _), !,
+	clause('$pred_info'(F, N, InfoMask), _), !,
 	InfoMask /\ 1 << Bit =:= 0.
 
 test_not_pred_flag(_, _, _).	% succeeds if not clause defined for F/N
@@ -1336,17 +1429,17 @@ f_n_to_key(F, N, Key) :-
 
 
 check_predicate(Pred, N) :-
-	g_read(redef_error, t),
+	g_read('$redef_error', t),
 	control_construct(Pred, N), !,
 	error('redefining control construct ~q', [Pred / N]).
 
 check_predicate(Pred, N) :-
-	g_read(redef_error, t),
+	g_read('$redef_error', t),
 	bip(Pred, N), !,
 	error('redefining built-in predicate ~q', [Pred / N]).
 
 check_predicate(Pred, N) :-
-	g_read(susp_warn, t),
+	g_read('$susp_warn', t),
 	suspicious_predicate(Pred, N), !,
 	warn('suspicious predicate ~q', [Pred / N]).
 
@@ -1412,6 +1505,10 @@ error(Msg, LArg) :-
 
 
 
+abandon_exec :-			% compiler linked in the run-time (see consult.pl)
+	g_read('$in_process', t), !,
+	throw(abandon_exec).
+
 abandon_exec :-
 	abort.
 
@@ -1420,7 +1517,7 @@ abandon_exec :-
 
 disp_msg(MsgType, Column, Msg, LArg) :-
 	numbervars(LArg),
-	g_read(where, Where),
+	g_read('$where', Where),
 	(   Where = OpenFileStack + L12,
 	    L12 = _ - _ ->
 	    disp_file_name(OpenFileStack, _, _),
@@ -1478,8 +1575,8 @@ disp_column(_) :-
 exception(error(syntax_error(_), _)) :-
 	!,
 	syntax_error_info(_, Line, Char, Msg),
-	g_read(open_file_stack, OpenFileStack),
-	g_assign(where, OpenFileStack + (Line - Line)),
+	g_read('$open_file_stack', OpenFileStack),
+	g_assign('$where', OpenFileStack + (Line - Line)),
 	error('syntax error: ~a (char:~d)', [Msg, Char]).
 
 exception(error(existence_error(source_sink, File), _)) :-
@@ -1491,7 +1588,8 @@ exception(error(permission_error(open, source_sink, File), _)) :-
 	error('cannot open file ~a - permission error', [File]).
 
 exception(abandon_exec) :-
-	abort.
+	!,
+	abandon_exec.
 
 exception(Err) :-
 	error('exception raised: ~q', [Err]).
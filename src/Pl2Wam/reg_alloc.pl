@@ -100,7 +100,7 @@ allocate_registers(LInstW) :-
 
 
 allocate_registers(LInstW, MaxRegUsed) :-
-	g_read(reg_opt, OptReg),
+	g_read('$reg_opt', OptReg),
 	(   OptReg > 0 ->
 	    aliases(LInstW, [], LAlias)
 	;   true
@@ -245,7 +245,7 @@ handle_one_code(c(Reg, Reg1), Alias, _, InLife, InLife2, LTmp, LTmp2) :-
 
 
 constraints(Reg, InLife, Alias, Cstr) :-
-	(   g_read(reg_opt, 2),
+	(   g_read('$reg_opt', 2),
 	    find_aliases_of(Alias, Reg, LSame) ->
 	    set_diff(InLife, LSame, Cstr)
 	;   Cstr = InLife
@@ -299,7 +299,7 @@ make_imposs([Reg|Cstr], Imposs, LTmp, LTmp2) :-
           % Register assignment
 
 assign_lst_tmp(LTmp, MaxRegUsed) :-
-	g_read(reg_opt, OptReg),
+	g_read('$reg_opt', OptReg),
 	(   OptReg = 2 ->
 	    assign_wishes(LTmp, LTmp1)
 	;   no_wish(LTmp, OptReg, LTmp1)
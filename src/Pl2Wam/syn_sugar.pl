@@ -56,7 +56,7 @@ syntactic_sugar_init_pred(Pred, _, _) :-
      */
 
 syntactic_sugar_init_pred(Pred, N, PlFile) :-
-	(   g_read(native_code, f), test_pred_flag(multi, Pred, N) ->
+	(   g_read('$native_code', f), test_pred_flag(multi, Pred, N) ->
 	    randomize,
 	    term_hash(PlFile, H),
 	    Max is (1 << 26),
@@ -65,7 +65,7 @@ syntactic_sugar_init_pred(Pred, N, PlFile) :-
 	;
 	    Aux = 1
 	),
-	g_assign(aux, Aux).
+	g_assign('$aux', Aux).
 
 
 
@@ -171,7 +171,7 @@ normalize_cuts1((IfThen ; R), CutVar, Body, HasCut) :-
 	    Body1 = ('$get_current_choice'(CutVar1), P1, '$soft_cut'(CutVar1), Q1 ; R1)
 	),
 	normalize_cuts1(R, CutVar, R1, HasCut),
-	(   g_read(optim_fail, t), R1 == fail ->
+	(   g_read('$optim_fail', t), R1 == fail ->
 	    normalize_cuts1(IfThen, CutVar, Body, HasCut)
 	;
 	    normalize_cuts_in_if(P, P1),
@@ -192,9 +192,9 @@ normalize_cuts1((P *-> Q), CutVar, (P1, Q1), HasCut) :-
 normalize_cuts1((P ; Q), CutVar, Body, HasCut) :-
 	normalize_cuts1(P, CutVar, P1, HasCut),
 	normalize_cuts1(Q, CutVar, Q1, HasCut),
-	(   g_read(optim_fail, t), P1 == fail, Body = Q1
+	(   g_read('$optim_fail', t), P1 == fail, Body = Q1
 	;
-	    g_read(optim_fail, t), Q1 == fail, Body = P1
+	    g_read('$optim_fail', t), Q1 == fail, Body = P1
 	;
 	    Body = (P1; Q1)
 	).
@@ -285,8 +285,8 @@ distrib_module_qualif_goal(G, M, M:G).
 
 normalize_alts(Body, Head, Body1) :-
 	functor(Head, Pred, N),
-	g_assign(head_functor, Pred),
-	g_assign(head_arity, N),
+	g_assign('$head_functor', Pred),
+	g_assign('$head_arity', N),
 	normalize_alts1(Body, Head, Body1), !.
 
 
@@ -303,13 +303,13 @@ normalize_alts1(Body, RestC, AuxPred) :-
 	lst_var(Body, [], VarAlt),
 	set_inter(VarAlt, VarRestC, V),
 	length(V, AuxN),
-	g_read(head_functor, Pred),
-	g_read(head_arity, N),
+	g_read('$head_functor', Pred),
+	g_read('$head_arity', N),
 	init_aux_pred_name(Pred, N, AuxName, AuxN),
 	AuxPred =.. [AuxName|V],
-	g_read(where, Where),
+	g_read('$where', Where),
 	linearize(Body, AuxPred, Where, LAuxCl),
-	asserta(buff_aux_pred(AuxName, AuxN, LAuxCl)).
+	asserta('$buff_aux_pred'(AuxName, AuxN, LAuxCl)).
 
 normalize_alts1(P, _, P1) :-
 	pred_rewriting(P, P1), !.
@@ -318,9 +318,9 @@ normalize_alts1(P, _, P1) :-
 
 
 init_aux_pred_name(Pred, N, AuxName, AuxN) :-
-	g_read(aux, Aux),
+	g_read('$aux', Aux),
 	Aux1 is (Aux + 1) /\ (1 << 26 - 1),  % avoid negative numbers
-	g_assign(aux, Aux1),
+	g_assign('$aux', Aux1),
 	'$make_aux_name'(Pred, N, Aux, AuxName),
 	(   test_pred_flag(bpl, Pred, N), % useful ?
 	    set_pred_flag(bpl, AuxName, AuxN)
@@ -343,7 +343,7 @@ linearize(Body, AuxPred, Where, LAuxCl) :-
 
 /* should no longer occurs since detected in normalize_cuts - to be removed
 linearize1(fail, _, _, []) :-
-	g_read(optim_fail, t), !.
+	g_read('$optim_fail', t), !.
 */
 linearize1(P, AuxPred, Where, [Where + AltP]) :-
 	copy_term((AuxPred :- P), AltP).
@@ -380,7 +380,7 @@ pred_rewriting(fd_tell(X), T) :-                          % FD transformation
 	pred_rewriting('$call_c'(X, [boolean]), T).
 
 pred_rewriting(set_bip_name(Name, Arity), Pred1) :-
-	g_read(inline, t),      % also if byte code since implies --no-inline
+	g_read('$inline', t),      % also if byte code since implies --no-inline
 	(   atom(Name), integer(Arity) ->
 	    CallC = '$call_c'('Pl_Set_Bip_Name_Untagged_2'(Name, Arity), [by_value])
 	;
@@ -389,8 +389,8 @@ pred_rewriting(set_bip_name(Name, Arity), Pred1) :-
 	pred_rewriting(CallC, Pred1).
 
 pred_rewriting(Pred, Pred1) :-                     % math define current bip
-	g_read(inline, t),      % also if byte code since implies --no-inline
-	g_read(fast_math, f),
+	g_read('$inline', t),      % also if byte code since implies --no-inline
+	g_read('$fast_math', f),
 	functor(Pred, F, 2),
 	(   F = (is)
 	;   math_cmp_functor_name(F, _)
@@ -399,7 +399,7 @@ pred_rewriting(Pred, Pred1) :-                     % math define current bip
 	Pred1 = (T, Pred).
 
 pred_rewriting(term_hash(Term, Hash), Pred1) :-
-	g_read(inline, t),      % also if byte code since implies --no-inline
+	g_read('$inline', t),      % also if byte code since implies --no-inline
 	catch(term_hash(Term, Hash1), _, fail), % if there is an error, do not inline !
 	integer(Hash1), !,
 	pred_rewriting(set_bip_name(term_hash, 2), T),
@@ -407,7 +407,7 @@ pred_rewriting(term_hash(Term, Hash), Pred1) :-
 	Pred1 = (T, T2).
 
 pred_rewriting(term_hash(Term, Depth, Range, Hash), Pred1) :-
-	g_read(inline, t),      % also if byte code since implies --no-inline
+	g_read('$inline', t),      % also if byte code since implies --no-inline
 	catch(term_hash(Term, Depth, Range, Hash1), _, fail), % if there is an error, do not inline !
 	integer(Hash1), !,
 	pred_rewriting(set_bip_name(term_hash, 4), T),
@@ -449,7 +449,7 @@ pred_rewriting(P, P).
 
 
 test_c_call_allowed(_) :-
-	g_read(call_c, t), !.
+	g_read('$call_c', t), !.
 
 test_c_call_allowed(X) :-
 	error('~q not allowed in this mode', [X]).
@@ -476,7 +476,7 @@ add_wrapper_to_dyn_clause(Pred, N, Where + Cl, AuxName) :-
 	    Cl1 = (Head1 :- Body)
 	;   head_wrapper(Cl, AuxName, Cl1)
 	),
-	assertz(buff_aux_pred(AuxName, N, [Where + Cl1])).
+	assertz('$buff_aux_pred'(AuxName, N, [Where + Cl1])).
 
 
 head_wrapper(Head, AuxName, Head1) :-
@@ -491,7 +491,7 @@ head_wrapper(Head, AuxName, Head1) :-
 meta_pred_rewriting(P1, P2) :-
 	nonvar(P1),
 	functor(P1, Pred, N),
-	clause(meta_pred(Pred, N, MetaDecl), _), !,
+	clause('$meta_pred'(Pred, N, MetaDecl), _), !,
 	functor(P2, Pred, N),
 	meta_pred_rewrite_args(1, N, P1, MetaDecl, P2).
 */
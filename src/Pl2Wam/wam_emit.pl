@@ -99,19 +99,23 @@
  * L      : integer >= 1 (with no "holes") or 'fail' inside switch_on_term *
  *-------------------------------------------------------------------------*/
 
+emit_code_init(_, _) :-
+	in_process, !,
+	g_assign('$cur_pl_file', '').
+
 emit_code_init(WamFile, PlFile) :-
 	emit_code_files(WamFile, PlFile, WamFile1),
 	(   WamFile1 = user ->
 	    current_output(Stream)
 	;   open(WamFile1, write, Stream)
 	),
-	g_assign(streamwamfile, Stream),
-	g_assign(cur_pl_file, ''),
+	g_assign('$streamwamfile', Stream),
+	g_assign('$cur_pl_file', ''),
 	prolog_name(Name),
 	prolog_version(Version),
 	format(Stream, '% compiler: ~a ~a~n', [Name, Version]),
 	format(Stream, '% file    : ~a~n', [PlFile]),
-	g_read(wam_comment, Cmt),
+	g_read('$wam_comment', Cmt),
 	(   Cmt = '' ->
 	    true
 	;
@@ -127,7 +131,7 @@ emit_code_files('', user, user) :-
 emit_code_files('', PlFile, WamFile) :-
 	!,
 	decompose_file_name(PlFile, _, Prefix, Suffix),
-	(   g_read(native_code, t) ->
+	(   g_read('$native_code', t) ->
 	    WamSuffix = '.wam'
 	;
 	    WamSuffix = '.wbc'
@@ -150,8 +154,11 @@ emit_code_files(WamFile, _, WamFile).
 */
 
 
+emit_code_term(0, 0) :-
+	in_process, !.
+
 emit_code_term(Bytes, Lines) :-
-	g_read(streamwamfile, Stream),
+	g_read('$streamwamfile', Stream),
 	character_count(Stream, Bytes),
 	line_count(Stream, Lines),
 	close(Stream).
@@ -160,7 +167,7 @@ emit_code_term(Bytes, Lines) :-
 
 
 emit_code(Pred, N, PlFile, PlLine, WamCode) :-
-	g_read(streamwamfile, Stream),
+	g_read('$streamwamfile', Stream),
 	emit_pred_start(Pred, N, PlFile, PlLine, Stream, _),
 	emit_wam_code(WamCode, _, Stream),
 	write(Stream, ']).'),
@@ -169,17 +176,28 @@ emit_code(Pred, N, PlFile, PlLine, WamCode) :-
 
 
 
-emit_pred_start(Pred, 0, PlFile, PlLine, Stream, Type) :-
-	(   Pred = '$exe_user',
-	    Type = user
-	;   Pred = '$exe_system',
-	    Type = system
-	), !,
+emit_pred_start(Pred, N, PlFile, PlLine, Stream, Type) :-
+	directive_type(Pred, N, Type), !,
 	emit_file_name_if_needed(PlFile, Stream),
 	format(Stream, '~n~ndirective(~d,~a,', [PlLine, Type]).
 
 emit_pred_start(Pred, N, PlFile, PlLine, Stream, _) :-
 	emit_file_name_if_needed(PlFile, Stream),
+	pred_properties(Pred, N, StaDyn, PubPriv, MonoMulti, ExportBplBfd),
+  		% MODULES: then add Module:Pred/N instead of Pred/N in the next line
+	format(Stream, '~n~npredicate(~q,~d,~a,~a,~a,~a,',
+	       [Pred/N, PlLine, StaDyn, PubPriv, MonoMulti, ExportBplBfd]).
+
+
+
+
+directive_type('$exe_user', 0, user).
+directive_type('$exe_system', 0, system).
+
+
+
+
+pred_properties(Pred, N, StaDyn, PubPriv, MonoMulti, ExportBplBfd) :-
 	(   test_pred_flag(dyn, Pred, N) ->
 	    StaDyn = dynamic
 	;   StaDyn = static
@@ -192,13 +210,14 @@ emit_pred_start(Pred, N, PlFile, PlLine, Stream, _) :-
 	    MonoMulti = multifile
 	;   MonoMulti = monofile
 	),
-	g_read(module, Module0),
-	export_type(Pred, N, Module0, _Module, ExportBplBfd),
-  		% MODULES: then add Module:Pred/N instead of Pred/N in the next line
-	format(Stream, '~n~npredicate(~q,~d,~a,~a,~a,~a,',
-	       [Pred/N, PlLine, StaDyn, PubPriv, MonoMulti, ExportBplBfd]).
+	g_read('$module', Module0),
+	export_type(Pred, N, Module0, _Module, ExportBplBfd).
+
 
 
+export_type(Pred, N, Module, Module, hidden) :-
+	g_read('$default_kind', hidden),
+	test_not_pred_flag(bpl, Pred, N), !.
 
 export_type(Pred, _, Module, Module, local) :-
 	'$aux_name'(Pred), !.
@@ -216,7 +235,7 @@ export_type(Pred, N, system, system, built_in) :-  % an exported pred in system
 	is_exported(Pred, N), !.
 
 export_type(_, _, Module, Module, global) :-
-	g_read(module_already_seen, f), !.
+	g_read('$module_already_seen', f), !.
 
 export_type(Pred, N, Module, Module, global) :-
 	is_exported(Pred, N), !.
@@ -227,11 +246,11 @@ export_type(_, _, Module, Module, local).
 
 
 emit_file_name_if_needed(PlFile, _) :-
-	g_read(cur_pl_file, PlFile), !.
+	g_read('$cur_pl_file', PlFile), !.
 
 emit_file_name_if_needed(PlFile, Stream) :-
 	format(Stream, '~n~nfile_name(~q).~n', [PlFile]),
-	g_assign(cur_pl_file, PlFile).
+	g_assign('$cur_pl_file', PlFile).
 
 
 
@@ -247,7 +266,7 @@ emit_wam_code(WamInst, First, Stream) :-
 	emit_wam_code(WamInst1, First, Stream).
 
 emit_wam_code(WamInst, _, _) :-
-	g_read(keep_void_inst, KeepVoidInst),
+	g_read('$keep_void_inst', KeepVoidInst),
 	dummy_instruction(WamInst, KeepVoidInst), !.
 
 emit_wam_code(WamInst, First, Stream) :-
@@ -305,7 +324,7 @@ emit_one_arg([X|L], Stream) :-
 	emit_list(L, PrefixTab, PrefixSpc, Stream).
 
 emit_one_arg(A, Stream) :-
-	g_read(native_code, f),	    % if also wanted to .wam remove this line
+	g_read('$native_code', f),	    % if also wanted to .wam remove this line
 	emit_one_f_n(A, Stream), !. % if fail breakthrough
 
 emit_one_arg(A, Stream) :-
@@ -340,10 +359,13 @@ emit_list([X|L], PrefixTab, PrefixSpc, Stream) :-
 
 
 emit_ensure_linked :-
-	g_read(streamwamfile, Stream),
-	retract(ensure_linked(Name, Arity)), !,
+	in_process, !.
+
+emit_ensure_linked :-
+	g_read('$streamwamfile', Stream),
+	retract('$ensure_linked'(Name, Arity)), !,
 	format(Stream, '~n~nensure_linked([~q', [Name / Arity]),
-	(   clause(ensure_linked(Name1, Arity1), _),
+	(   clause('$ensure_linked'(Name1, Arity1), _),
 	    format(Stream, ',~q', [Name1 / Arity1]),
 	    fail
 	;   true
@@ -357,26 +379,33 @@ emit_ensure_linked.
 
 
 bc_emit_code(Pred, N, PlFile, PlLine, LCompCl) :-
-	g_read(streamwamfile, Stream),
+	in_process, !,
+	bc_record_code(Pred, N, PlFile, PlLine, LCompCl).
+
+bc_emit_code(Pred, N, PlFile, PlLine, LCompCl) :-
+	g_read('$streamwamfile', Stream),
 	emit_pred_start(Pred, N, PlFile, PlLine, Stream, Type),
 	(   nonvar(Type) ->
 	    LCompCl = [bc((_ :- Body), _)],
 	    bc_emit_prolog_term(Stream, Body),
 	    format(Stream, ').~n', [])
-	;   length(LCompCl, NbCl),
-	    (   LCompCl = [bc('$$empty$$predicate$$clause$$', [proceed])] ->
-	        NbCl1 = 0,
-	        LCompCl1 = []
-	    ;   NbCl1 = NbCl,
-	        LCompCl1 = LCompCl
-	    ),
-	    format(Stream, '~d).~n', [NbCl1]),
+	;   bc_lst_clause(LCompCl, NbCl, LCompCl1),
+	    format(Stream, '~d).~n', [NbCl]),
 	    bc_emit_lst_clause(LCompCl1, Stream)
 	).
 
 
 
 
+bc_lst_clause([bc('$$empty$$predicate$$clause$$', [proceed])], 0, []) :-
+	!.
+
+bc_lst_clause(LCompCl, NbCl, LCompCl) :-
+	length(LCompCl, NbCl).
+
+
+
+
 bc_emit_lst_clause([], _).
 
 bc_emit_lst_clause([bc(Cl, WamCode)|LCompCl], Stream) :-
@@ -398,3 +427,55 @@ bc_emit_prolog_term(Stream, Term) :- % create choice point for '$above'/1 write
 	fail.
 
 bc_emit_prolog_term(_, _).
+
+
+
+
+          % Byte-code recording (compiler linked in the run-time)
+          %
+          % The terms a .wbc file would contain are recorded, in the same
+          % order, as '$pl2wam_bc'(Key, Term) facts where Key is given by the
+          % caller (see '$pl2wam_compile'/2 and consult.pl). Clause codes are
+          % flattened as done by emit_wam_code/3.
+
+bc_record_code(Pred, N, PlFile, PlLine, LCompCl) :-
+	g_read('$bc_key', Key),
+	(   g_read('$cur_pl_file', PlFile) ->
+	    true
+	;   assertz('$pl2wam_bc'(Key, file_name(PlFile))),
+	    g_assign('$cur_pl_file', PlFile)
+	),
+	(   directive_type(Pred, N, Type) ->
+	    LCompCl = [bc((_ :- Body), _)],
+	    assertz('$pl2wam_bc'(Key, directive(PlLine, Type, Body)))
+	;   pred_properties(Pred, N, StaDyn, PubPriv, MonoMulti, ExportBplBfd),
+	    bc_lst_clause(LCompCl, NbCl, LCompCl1),
+	    assertz('$pl2wam_bc'(Key, predicate(Pred/N, PlLine, StaDyn, PubPriv, MonoMulti, ExportBplBfd, NbCl))),
+	    (   member(bc(Cl, WamCode), LCompCl1),
+	        bc_flat_wam_code(WamCode, WamCl, []),
+	        assertz('$pl2wam_bc'(Key, clause(Cl, WamCl))),
+	        fail
+	    ;   true
+	    )
+	).
+
+
+
+
+bc_flat_wam_code([], WamCl, WamCl) :-
+	!.
+
+bc_flat_wam_code([WamInst|WamCode], WamCl, End) :-
+	!,
+	bc_flat_wam_code(WamInst, WamCl, WamCl1),          % for nested code
+	bc_flat_wam_code(WamCode, WamCl1, End).
+
+bc_flat_wam_code(WamInst, WamCl, End) :-
+	special_form(WamInst, WamInst1), !,
+	bc_flat_wam_code(WamInst1, WamCl, End).
+
+bc_flat_wam_code(WamInst, WamCl, WamCl) :-
+	g_read('$keep_void_inst', KeepVoidInst),
+	dummy_instruction(WamInst, KeepVoidInst), !.
+
+bc_flat_wam_code(WamInst, [WamInst|End], End).
@@ -10,3 +10,4 @@
 :-	include(indexing).
 :-	include(wam_emit).
 :-	include(pl2wam).
+:-	include(pl2wam_main).
@@ -50,6 +50,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <process.h>
+#include <direct.h>
 #include <fcntl.h>
 #include <io.h>
 #else
@@ -138,6 +139,9 @@
 #define CC_COMPILE_OPT             "-c "
 #define CC_INCLUDE_OPT             "-I"
 
+#define CACHE_ENV_VARIABLE         "GPLC_CACHE_DIR"
+#define CACHE_MAX_INCLUDE_DEPTH    16
+
 
 
 /*---------------------------------*
@@ -212,6 +216,12 @@ char warn_str[1024] = "";
 char *temp_dir = NULL;
 int no_del_temp_files = 0;
 
+int nb_jobs = 1;
+char *cache_dir = NULL;
+int direct_obj = 0;		/* ma2asm directly produces the object file */
+char **pl_incl_file = NULL;	/* files passed with --include (for the cache) */
+int nb_pl_incl_file = 0;
+
 /* Almost each string ends with a space. However, executable names
  * EXE_XXX_NAME do not end with a space (so they can be used in Search_Path)
  * thus options must begin with a space (and end with a space too).
@@ -245,6 +255,26 @@ void Determine_Pathnames(void);
 
 void Compile_Files(void);
 
+void Compile_One_File(FileInf *f, int stage_end);
+
+#if defined(__unix__) || defined(__CYGWIN__)
+void Compile_Files_In_Parallel(int stage_end);
+
+int Wait_One_Job(int *job_pid, int *job_fd, FileInf **job_file);
+#endif
+
+int Cache_File_Name(FileInf *f, int stage_end, char *cache_file);
+
+void Hash_Bytes(unsigned long long *h, void *p, size_t n);
+
+void Hash_Exe_File(unsigned long long *h, char *exe_name);
+
+void Hash_Source_File(unsigned long long *h, char *name, int depth);
+
+void Cache_Store(char *cache_file, char *name);
+
+int Copy_File(char *src, char *dst);
+
 void Create_Output_File_Name(FileInf *f, char *buff);
 
 void New_Work_File(FileInf *f, int stage, int stop_after);
@@ -360,9 +390,7 @@ void
 Compile_Files(void)
 {
   FileInf *f;
-  int stage;
   int stage_end;
-  size_t l;
   FILE *fd;
 
 
@@ -383,6 +411,11 @@ Compile_Files(void)
   else
     stage_end = FILE_ASM;
 
+  if (stage_end < FILE_ASM)	/* assembly file wanted (-S): needs ma2asm */
+    direct_obj = 0;
+  else if (direct_obj)
+    strcat(cmd_ma2asm.opt, "--direct-obj ");
+
   if (needs_stack_file)
     {
       f = file_lopt + nb_file_lopt;
@@ -422,94 +455,548 @@ Compile_Files(void)
     fprintf(stderr, "\n*** Compiling\n");
 
 
+  if (cache_dir == NULL)
+    cache_dir = getenv(CACHE_ENV_VARIABLE);
+
+  if (cache_dir && *cache_dir == '\0')
+    cache_dir = NULL;
+
+  if (cache_dir)
+    {
+#ifdef _WIN32
+      _mkdir(cache_dir);
+#else
+      mkdir(cache_dir, 0777);
+#endif
+      if (verbose)
+        fprintf(stderr, "cache directory: %s\n", cache_dir);
+    }
+
+#if defined(__unix__) || defined(__CYGWIN__)
+  /* %c in the output name is a counter incremented for each created file,
+   * this is only well defined if files are compiled one after the other.
+   */
+  if (nb_jobs > 1 && !(stop_after < FILE_LINK && file_name_out &&
+                       strstr(file_name_out, "%c")))
+    Compile_Files_In_Parallel(stage_end);
+  else
+#endif
+    for (f = file_lopt; f->name; f++)
+      if (f->type != LINK_OPTION)
+        Compile_One_File(f, stage_end);
+
+  if (stop_after < FILE_LINK)
+    return;
+
+  if (verbose)
+    fprintf(stderr, "\n*** Linking\n\n");
+
+  Link_Cmd();
+
+  /* removing temp files after link */
   for (f = file_lopt; f->name; f++)
+    if (f->work_name1 != f->name) /* also ok if f->type == LINK_OPTION */
+      Delete_Temp_File(f->work_name1);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * COMPILE_ONE_FILE                                                        *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Compile_One_File(FileInf *f, int stage_end)
+{
+  int stage;
+  size_t l;
+  int use_cache;
+  static char cache_file[MAXPATHLEN];
+
+
+  if (verbose &&
+      (f->type == FILE_FD || f->type == FILE_C || f->type <= stage_end))
+    fprintf(stderr, "\n--- file: %s\n", f->name);
+
+  if (f->type == FILE_FD && stop_after >= FILE_ASM)
     {
-      if (f->type == LINK_OPTION)
-        continue;
+      stage = FILE_FD;          /* to generate the correct C suffix */
+      New_Work_File(f, stage, (stop_after == FILE_FD) ? stop_after : 10000);
+      Compile_Cmd(&cmd_fd2c, f);
+      if (stop_after != FILE_FD)
+        {
+          stage = FILE_ASM;     /* to generate the correct obj suffix */
+          New_Work_File(f, stage, stop_after);
+          l = strlen(cmd_cc.opt);       /* add fd2c C options */
+          strcpy(cmd_cc.opt + l, cc_fd2c_flags);
+          Compile_Cmd(&cmd_cc, f);
+          cmd_cc.opt[l] = '\0'; /* remove them */
+        }
+      Free_Work_File2(f);       /* to suppress last useless temp file */
+      return;
+    }
+
+  if (f->type == FILE_C && stop_after >= FILE_ASM && stop_after != FILE_FD)
+    {
+      stage = FILE_ASM;         /* to generate the correct obj suffix */
+      New_Work_File(f, stage, stop_after);
+      Compile_Cmd(&cmd_cc, f);
+      Free_Work_File2(f);
+      return;
+    }
+
+  if (f->type == FILE_FD || f->type == FILE_C ||
+      stop_after == FILE_FD || f->type > stop_after)
+    {
+      fprintf(stderr, "unused input file: %s\n", f->name);
+      return;
+    }
+
+  /* the stack size file is a temporary file, not worth caching */
+  use_cache = (cache_dir != NULL && f->type <= stage_end &&
+               !(needs_stack_file && f == file_lopt + nb_file_lopt) &&
+               Cache_File_Name(f, stage_end, cache_file));
 
-      if (verbose &&
-          (f->type == FILE_FD || f->type == FILE_C || f->type <= stage_end))
-        fprintf(stderr, "\n--- file: %s\n", f->name);
+  if (use_cache && access(cache_file, R_OK) == 0)
+    {
+      New_Work_File(f, stage_end, stop_after);
+      if (verbose)
+        fprintf(stderr, "found in cache: %s\n", cache_file);
+      if (!Copy_File(cache_file, f->work_name2))
+        Pl_Fatal_Error("cannot copy %s to %s", cache_file, f->work_name2);
+      Free_Work_File2(f);
+      return;
+    }
 
-      if (f->type == FILE_FD && stop_after >= FILE_ASM)
+  for (stage = f->type; stage <= stage_end; stage++)
+    {
+      /* with --direct-obj ma2asm produces the object (FILE_ASM suffix) */
+      New_Work_File(f, (stage == FILE_MA && direct_obj) ? FILE_ASM : stage, stop_after);
+      switch (stage)
         {
-          stage = FILE_FD;      /* to generate the correct C suffix */
-          New_Work_File(f, stage, (stop_after == FILE_FD) ? stop_after : 10000);
-          Compile_Cmd(&cmd_fd2c, f);
-          if (stop_after != FILE_FD)
+        case FILE_PL:
+          Compile_Cmd(&cmd_pl2wam, f);
+          break;
+
+        case FILE_WAM:
+          Compile_Cmd(&cmd_wam2ma, f);
+          break;
+
+        case FILE_MA:
+          Compile_Cmd(&cmd_ma2asm, f);
+          if (needs_stack_file && f == file_lopt + nb_file_lopt &&
+              !no_del_temp_files)
             {
-              stage = FILE_ASM; /* to generate the correct obj suffix */
-              New_Work_File(f, stage, stop_after);
-              l = strlen(cmd_cc.opt);   /* add fd2c C options */
-              strcpy(cmd_cc.opt + l, cc_fd2c_flags);
-              Compile_Cmd(&cmd_cc, f);
-              cmd_cc.opt[l] = '\0';     /* remove them */
+              if (verbose)
+                fprintf(stderr, "deleting stack size file\n");
+              Delete_Temp_File(f->name);
             }
-          goto free_work_file;
+
+          if (direct_obj)
+            stage = FILE_ASM;   /* no need for the assembler */
+          break;
+
+        case FILE_ASM:
+          Compile_Cmd(&cmd_asm, f);
+          break;
         }
+    }
+
+  Free_Work_File2(f);           /* to suppress last useless temp file */
+
+  if (use_cache)
+    Cache_Store(cache_file, f->work_name1);
+}
+
+
+
+
+#if defined(__unix__) || defined(__CYGWIN__)
 
-      if (f->type == FILE_C && stop_after >= FILE_ASM && stop_after != FILE_FD)
+/*-------------------------------------------------------------------------*
+ * COMPILE_FILES_IN_PARALLEL                                               *
+ *                                                                         *
+ * Each file is compiled by a child process (at most nb_jobs at a time).   *
+ * The child sends back the name of the file it has produced via a pipe.   *
+ *-------------------------------------------------------------------------*/
+void
+Compile_Files_In_Parallel(int stage_end)
+{
+  FileInf *f;
+  int *job_pid, *job_fd;
+  FileInf **job_file;
+  int nb_running = 0;
+  int error = 0;
+  int fds[2];
+  int pid, k;
+  char *out;
+
+  job_pid = (int *) calloc(nb_jobs, sizeof(int));
+  job_fd = (int *) calloc(nb_jobs, sizeof(int));
+  job_file = (FileInf **) calloc(nb_jobs, sizeof(FileInf *));
+  if (job_pid == NULL || job_fd == NULL || job_file == NULL)
+    Pl_Fatal_Error("memory allocation fault");
+
+  for (f = file_lopt; f->name; f++)
+    {
+      if (f->type == LINK_OPTION)
+        continue;
+
+      if (nb_running == nb_jobs)
         {
-          stage = FILE_ASM;     /* to generate the correct obj suffix */
-          New_Work_File(f, stage, stop_after);
-          Compile_Cmd(&cmd_cc, f);
-          goto free_work_file;
+          error |= Wait_One_Job(job_pid, job_fd, job_file);
+          nb_running--;
         }
 
-      if (f->type == FILE_FD || f->type == FILE_C ||
-          stop_after == FILE_FD || f->type > stop_after)
+      if (pipe(fds) != 0)
+        Pl_Fatal_Error("cannot create a pipe (%s)", strerror(errno));
+
+      fflush(stdout);
+      fflush(stderr);
+      pid = fork();
+      if (pid < 0)
+        Pl_Fatal_Error("cannot create a process (%s)", strerror(errno));
+
+      if (pid == 0)             /* child: compile and send back the output */
         {
-          fprintf(stderr, "unused input file: %s\n", f->name);
-          continue;
+          close(fds[0]);
+          Compile_One_File(f, stage_end);
+          out = (f->work_name1 != f->name) ? f->work_name1 : "";
+          if (write(fds[1], out, strlen(out)) < 0)
+            exit(1);
+          close(fds[1]);
+          exit(0);
         }
 
-      for (stage = f->type; stage <= stage_end; stage++)
+      close(fds[1]);
+      for (k = 0; job_pid[k] != 0; k++)
+        ;
+      job_pid[k] = pid;
+      job_fd[k] = fds[0];
+      job_file[k] = f;
+      nb_running++;
+    }
+
+  while (nb_running > 0)
+    {
+      error |= Wait_One_Job(job_pid, job_fd, job_file);
+      nb_running--;
+    }
+
+  free(job_pid);
+  free(job_fd);
+  free(job_file);
+
+  if (error)
+    Pl_Fatal_Error("compilation failed");
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * WAIT_ONE_JOB                                                            *
+ *                                                                         *
+ * Waits for the termination of one child and frees its slot.              *
+ * Returns 1 if the compilation of the corresponding file failed (0 else). *
+ *-------------------------------------------------------------------------*/
+int
+Wait_One_Job(int *job_pid, int *job_fd, FileInf **job_file)
+{
+  static char buff[MAXPATHLEN];
+  int pid, status, k;
+  ssize_t n;
+  size_t l = 0;
+
+  do
+    pid = wait(&status);
+  while (pid < 0 && errno == EINTR);
+
+  if (pid < 0)
+    Pl_Fatal_Error("error waiting for a compilation process (%s)", strerror(errno));
+
+  for (k = 0; job_pid[k] != pid; k++)
+    ;
+
+  while (l < sizeof(buff) - 1 &&
+         (n = read(job_fd[k], buff + l, sizeof(buff) - 1 - l)) > 0)
+    l += n;
+  buff[l] = '\0';
+  close(job_fd[k]);
+  job_pid[k] = 0;
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    return 1;
+
+  if (*buff)                    /* else the source is the output (unused file) */
+    job_file[k]->work_name1 = strdup(buff);
+
+  return 0;
+}
+
+#endif
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CACHE_FILE_NAME                                                         *
+ *                                                                         *
+ * Computes the name of the cache entry for the compilation of f up to     *
+ * stage_end. The key is a hash of: the compiler version, the commands     *
+ * (with their options and the date of their executable), the source file, *
+ * the files it includes and the files passed with --include.              *
+ * Returns 1 if a name can be computed (0 else).                           *
+ *-------------------------------------------------------------------------*/
+int
+Cache_File_Name(FileInf *f, int stage_end, char *cache_file)
+{
+  static CmdInf *cmd[] = { &cmd_pl2wam, &cmd_wam2ma, &cmd_ma2asm, &cmd_asm };
+  unsigned long long h = 14695981039346656037ULL;      /* FNV-1a offset basis */
+  int stage;
+  int i;
+
+  Hash_Bytes(&h, PROLOG_VERSION, sizeof(PROLOG_VERSION));
+  Hash_Bytes(&h, &stage_end, sizeof(stage_end));
+  Hash_Bytes(&h, &f->type, sizeof(f->type));
+
+  for (stage = f->type; stage <= stage_end; stage++)
+    {
+      Hash_Bytes(&h, cmd[stage]->exe_name, strlen(cmd[stage]->exe_name) + 1);
+      Hash_Bytes(&h, cmd[stage]->opt, strlen(cmd[stage]->opt) + 1);
+      Hash_Exe_File(&h, cmd[stage]->exe_name);
+    }
+
+  if (access(f->name, R_OK) != 0)
+    return 0;
+
+  Hash_Source_File(&h, f->name, (f->type == FILE_PL) ? 0 : CACHE_MAX_INCLUDE_DEPTH);
+
+  if (f->type == FILE_PL)
+    for (i = 0; i < nb_pl_incl_file; i++)
+      Hash_Source_File(&h, pl_incl_file[i], 0);
+
+  if (strlen(cache_dir) + 1 + 16 + strlen(suffixes[stage_end + 1]) >= MAXPATHLEN)
+    return 0;
+
+  sprintf(cache_file, "%s" DIR_SEP_S "%016llx%s", cache_dir, h, suffixes[stage_end + 1]);
+  return 1;
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * HASH_BYTES                                                              *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+void
+Hash_Bytes(unsigned long long *h, void *p, size_t n)
+{
+  unsigned char *q = (unsigned char *) p;
+
+  while (n--)
+    {
+      *h ^= *q++;
+      *h *= 1099511628211ULL;   /* FNV-1a prime */
+    }
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * HASH_EXE_FILE                                                           *
+ *                                                                         *
+ * A new version of a sub-compiler changes its size or its date.           *
+ *-------------------------------------------------------------------------*/
+void
+Hash_Exe_File(unsigned long long *h, char *exe_name)
+{
+  struct stat st;
+  char *p = exe_name;
+  long long x;
+
+  if (strchr(exe_name, DIR_SEP_C) == NULL)
+    p = Search_Path(exe_name);
+
+  if (p == NULL || stat(p, &st) != 0)
+    return;
+
+  x = st.st_size;
+  Hash_Bytes(h, &x, sizeof(x));
+  x = st.st_mtime;
+  Hash_Bytes(h, &x, sizeof(x));
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * HASH_SOURCE_FILE                                                        *
+ *                                                                         *
+ * Hashes the contents of a file. For a Prolog file, the files referenced  *
+ * by include/1 and ensure_loaded/1 are also hashed (they are searched in  *
+ * the directory of the file, then in the current directory). The scan is  *
+ * textual and can find spurious references: this only costs a few cache  *
+ * misses.                                                                 *
+ *-------------------------------------------------------------------------*/
+void
+Hash_Source_File(unsigned long long *h, char *name, int depth)
+{
+  static char *directive[] = { "include(", "ensure_loaded(", NULL };
+  char **d;
+  FILE *fd;
+  char *buff, *p, *q, *end;
+  size_t size = 0, max_size = 65536, n;
+  char inc_name[MAXPATHLEN];
+  char path[MAXPATHLEN];
+  int quote, dir_len;
+
+  Hash_Bytes(h, name, strlen(name) + 1);
+
+  if ((fd = fopen(name, "rb")) == NULL)
+    return;
+
+  if ((buff = (char *) malloc(max_size + 1)) == NULL)
+    Pl_Fatal_Error("memory allocation fault");
+
+  while ((n = fread(buff + size, 1, max_size - size, fd)) > 0)
+    {
+      size += n;
+      if (size == max_size)
         {
-          New_Work_File(f, stage, stop_after);
-          switch (stage)
-            {
-            case FILE_PL:
-              Compile_Cmd(&cmd_pl2wam, f);
-              break;
-
-            case FILE_WAM:
-              Compile_Cmd(&cmd_wam2ma, f);
-              break;
-
-            case FILE_MA:
-              Compile_Cmd(&cmd_ma2asm, f);
-              if (needs_stack_file && f == file_lopt + nb_file_lopt &&
-                  !no_del_temp_files)
-                {
-                  if (verbose)
-                    fprintf(stderr, "deleting stack size file\n");
-                  Delete_Temp_File(f->name);
-                }
-
-              break;
-
-            case FILE_ASM:
-              Compile_Cmd(&cmd_asm, f);
-              break;
-            }
+          max_size *= 2;
+          if ((buff = (char *) realloc(buff, max_size + 1)) == NULL)
+            Pl_Fatal_Error("memory allocation fault");
         }
+    }
+  fclose(fd);
+  buff[size] = '\0';
 
-    free_work_file:
-      Free_Work_File2(f);       /* to suppress last useless temp file */
+  Hash_Bytes(h, buff, size);
+
+  if (depth >= CACHE_MAX_INCLUDE_DEPTH)
+    {
+      free(buff);
+      return;
     }
 
-  if (stop_after < FILE_LINK)
-    return;
+  for (p = name + strlen(name); p > name && p[-1] != '/' && p[-1] != DIR_SEP_C; p--)
+    ;
+  dir_len = p - name;
+
+  end = buff + size;
+  for (d = directive; *d; d++)
+    for (p = buff; (p = strstr(p, *d)) != NULL; )
+      {
+        p += strlen(*d);
+        while (p < end && isspace(*p))
+          p++;
+
+        quote = (*p == '\'');
+        if (quote)
+          p++;
+
+        for (q = p; q < end && q - p < MAXPATHLEN / 2 &&
+               (quote ? *q != '\'' : (isalnum(*q) || strchr("_/.-", *q))); q++)
+          ;
+
+        if (q == p || q - p >= MAXPATHLEN / 2)
+          continue;
+
+        sprintf(inc_name, "%.*s", (int) (q - p), p);
+
+        if (dir_len + strlen(inc_name) >= MAXPATHLEN - 8)
+          continue;
+
+        if (*inc_name == '/' || *inc_name == DIR_SEP_C)
+          *path = '\0';
+        else
+          sprintf(path, "%.*s", dir_len, name);
+        strcat(path, inc_name);
+
+        if (access(path, R_OK) != 0)
+          strcat(path, PL_SUFFIX);
+
+        if (access(path, R_OK) != 0 && access(strcpy(path, inc_name), R_OK) != 0)
+          strcat(path, PL_SUFFIX);
+
+        Hash_Source_File(h, path, depth + 1);
+      }
 
+  free(buff);
+}
+
+
+
+
+/*-------------------------------------------------------------------------*
+ * CACHE_STORE                                                             *
+ *                                                                         *
+ * Copies name into the cache. The copy is done in a temporary file which  *
+ * is then renamed (so concurrent gplc never see a partial entry). Errors  *
+ * are ignored: the cache is only an optimization.                         *
+ *-------------------------------------------------------------------------*/
+void
+Cache_Store(char *cache_file, char *name)
+{
+  char tmp_file[MAXPATHLEN + 32];
+
+  sprintf(tmp_file, "%s.%d.tmp", cache_file, (int) getpid());
+
+  if (Copy_File(name, tmp_file) && rename(tmp_file, cache_file) == 0)
+    {
+      if (verbose)
+        fprintf(stderr, "stored in cache: %s\n", cache_file);
+      return;
+    }
+
+  unlink(tmp_file);
   if (verbose)
-    fprintf(stderr, "\n*** Linking\n\n");
+    fprintf(stderr, "cannot store %s in cache\n", name);
+}
 
-  Link_Cmd();
 
-  /* removing temp files after link */
-  for (f = file_lopt; f->name; f++)
-    if (f->work_name1 != f->name) /* also ok if f->type == LINK_OPTION */
-      Delete_Temp_File(f->work_name1);
+
+
+/*-------------------------------------------------------------------------*
+ * COPY_FILE                                                               *
+ *                                                                         *
+ *-------------------------------------------------------------------------*/
+int
+Copy_File(char *src, char *dst)
+{
+  FILE *fd_in, *fd_out;
+  char buff[8192];
+  size_t n;
+  int ok = 1;
+
+  if ((fd_in = fopen(src, "rb")) == NULL)
+    return 0;
+
+  if ((fd_out = fopen(dst, "wb")) == NULL)
+    {
+      fclose(fd_in);
+      return 0;
+    }
+
+  while ((n = fread(buff, 1, sizeof(buff), fd_in)) > 0)
+    if (fwrite(buff, 1, n, fd_out) != n)
+      {
+        ok = 0;
+        break;
+      }
+
+  if (ferror(fd_in))
+    ok = 0;
+
+  fclose(fd_in);
+  if (fclose(fd_out) != 0)
+    ok = 0;
+
+  return ok;
 }
 
 
@@ -591,11 +1078,29 @@ New_Work_File(FileInf *f, int stage, int stop_after)
 {
   static char buff[MAXPATHLEN];
   char *p;
+#if defined(__unix__) || defined(__CYGWIN__)
+  int l, fd;
+#endif
 
   if (stage < stop_after)       /* intermediate stage */
     {
       p = Pl_M_Tempnam(temp_dir, TEMP_FILE_PREFIX);
+      if (p == NULL)
+        Pl_Fatal_Error("cannot create a temporary file name (%s)", strerror(errno));
+#if defined(__unix__) || defined(__CYGWIN__)
+      /* the name is reserved by creating the file (with O_EXCL): the
+       * processes of -j N share the state of mktemp and would else get
+       * the same names.
+       */
+      l = strlen(p) - 6;        /* replace the XXXXXX part of the name */
+      sprintf(buff, "%.*sXXXXXX%s", l, p, suffixes[stage + 1]);
+      fd = mkstemps(buff, strlen(suffixes[stage + 1]));
+      if (fd < 0)
+        Pl_Fatal_Error("cannot create temporary file %s (%s)", buff, strerror(errno));
+      close(fd);
+#else
       sprintf(buff, "%s%s", p, suffixes[stage + 1]);
+#endif
       free(p);
     }
   else                          /* final stage */
@@ -1102,6 +1607,12 @@ Parse_Arguments(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "--direct-obj"))
+	    {
+	      direct_obj = 1;
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--temp-dir"))
 	    {
 	      if (++i >= argc)
@@ -1117,6 +1628,26 @@ Parse_Arguments(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "-j") || Check_Arg(i, "--jobs"))
+	    {
+	      if (++i >= argc)
+		Pl_Fatal_Error("N missing after %s option", last_opt);
+
+	      nb_jobs = strtol(argv[i], &q, 10);
+	      if (*q || nb_jobs <= 0)
+		Pl_Fatal_Error("invalid number of jobs (%s)", argv[i]);
+	      continue;
+	    }
+
+	  if (Check_Arg(i, "--cache-dir"))
+	    {
+	      if (++i >= argc)
+		Pl_Fatal_Error("PATH missing after %s option", last_opt);
+
+	      cache_dir = argv[i];
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--no-decode-hexa") || Check_Arg(i, "--no-demangling"))
 	    {
 	      no_decode_hex = 1;
@@ -1154,6 +1685,11 @@ Parse_Arguments(int argc, char *argv[])
 	      Add_Last_Option(cmd_pl2wam.opt);
 	      last_opt = argv[i];
 	      Add_Last_Option(cmd_pl2wam.opt);
+
+	      pl_incl_file = (char **) realloc(pl_incl_file, (nb_pl_incl_file + 1) * sizeof(char *));
+	      if (pl_incl_file == NULL)
+		Pl_Fatal_Error("memory allocation fault");
+	      pl_incl_file[nb_pl_incl_file++] = argv[i];
 	      continue;
 	    }
 
@@ -1503,6 +2039,8 @@ Display_Help(void)
   L("  -c, --object                stop after producing object file(s)");
   L("  --temp-dir PATH             use PATH as directory for temporary files");
   L("  --no-del-temp-files         do not delete temporary files");
+  L("  -j N, --jobs N              compile up to N files in parallel");
+  L("  --cache-dir PATH            reuse/store compiled files in the cache directory PATH");
   L("  --no-demangling             do not decode hexadecimal predicate names");
   L("  --no-decode-hexa            same as --no-demanling (deprecated)");
   L("  -v, --verbose               print executed commands");
@@ -1533,6 +2071,7 @@ Display_Help(void)
   L("Mini-assembly to assembly translator options:");
   L("  --comment                   include comments in the output file");
   L("  --pic, -fPIC, --dynamic     produce position independent code (PIC)");
+  L("  --direct-obj                directly produce the object file (no assembler)");
   L(" ");
   L("C Compiler options:");
   L("  --c-compiler FILE           use FILE as C compiler/linker");
@@ -67,6 +67,8 @@
 
 static void Display_Help(void);
 
+static WamWord Load_Program_Goal(char *file);
+
 #define Check_Arg(i, str)  (strncmp(argv[i], str, strlen(argv[i])) == 0)
 
 
@@ -142,6 +144,15 @@ Main_Wrapper(int argc, char *argv[])
 	      continue;
 	    }
 
+	  if (Check_Arg(i, "--load-program"))
+	    {
+	      if (++i >= argc)
+		Pl_Fatal_Error("File missing after --load-program option");
+
+	      init_goal[nb_init_goal++] = Load_Program_Goal(argv[i]);
+	      continue;
+	    }
+
 	  if (Check_Arg(i, "--consult-file"))
 	    {
 	      if (++i >= argc)
@@ -235,6 +246,37 @@ main(int argc, char *argv[])
 }
 
 
+/*-------------------------------------------------------------------------*
+ * LOAD_PROGRAM_GOAL                                                       *
+ *                                                                         *
+ * Returns the init goal (an atom) loading a saved program: the text of   *
+ * load_program(File) with File quoted.                                    *
+ *-------------------------------------------------------------------------*/
+static WamWord
+Load_Program_Goal(char *file)
+{
+  char *buff, *p;
+  int atom;
+
+  buff = (char *) Malloc(2 * strlen(file) + 32);
+  p = buff + sprintf(buff, "load_program('");
+  for (; *file; file++)
+    {
+      if (*file == '\'' || *file == '\\')
+	*p++ = *file;
+      *p++ = *file;
+    }
+  strcpy(p, "')");
+
+  atom = Pl_Create_Allocate_Atom(buff);
+  Free(buff);
+
+  return Tag_ATM(atom);
+}
+
+
+
+
 /*-------------------------------------------------------------------------*
  * DISPLAY_HELP                                                            *
  *                                                                         *
@@ -245,6 +287,7 @@ Display_Help(void)
 {
   fprintf(stderr, "Usage: %s [OPTION]... \n", TOP_LEVEL);
   L("");
+  L("  --load-program FILE         load the saved program FILE (see save_program/1)");
   L("  --consult-file FILE         consult FILE inside the the top-level");
   L("  --init-goal    GOAL         execute GOAL before entering the top-level");
   L("  --entry-goal   GOAL         execute GOAL inside the top-level");
@@ -168,6 +168,7 @@ typedef struct predinf
   char *hexa;
   int line_no;
   int prop;
+  Bool hidden;			/* not recorded in the predicate table */
   struct map_entry *pl_file;
   int pl_line;
   SwtTbl *swt_tbl[3];
@@ -495,6 +496,7 @@ F_predicate(ArgVal arg[])
   Bool module_user_system = FALSE;
   int prop = 0;			/* init for the compiler */
   Bool local_symbol = FALSE;
+  Bool hidden = FALSE;
   Args6(MP_N(module, functor, arity), C_INT(pl_line),
 	STR(static_dynamic), STR(public_private), STR(mono_multi), STR(built_in_local_global));
 
@@ -538,9 +540,11 @@ F_predicate(ArgVal arg[])
     prop |= MASK_PRED_BUILTIN_FD;
   else if (strcmp(built_in_local_global, "local") == 0)
     local_symbol = TRUE;
+  else if (strcmp(built_in_local_global, "hidden") == 0)
+    local_symbol = hidden = TRUE;
   else if (strcmp(built_in_local_global, "user") != 0 &&
 	   strcmp(built_in_local_global, "global") != 0)
-    Syntax_Error("built_in, built_in_fd, local or global (or user) expected");
+    Syntax_Error("built_in, built_in_fd, local, hidden or global (or user) expected");
   /* 'user' is accepted for compatibility as 'global' - no longer generated */
 
 
@@ -575,6 +579,7 @@ F_predicate(ArgVal arg[])
   cur_pred->pl_file = cur_pl_file;
   cur_pred->pl_line = (int) pl_line;
   cur_pred->prop = prop;
+  cur_pred->hidden = hidden;
   cur_pred->swt_tbl[0] = NULL;
   cur_pred->swt_tbl[1] = NULL;
   cur_pred->swt_tbl[2] = NULL;
@@ -1174,7 +1179,7 @@ void
 F_allocate(ArgVal arg[])
 {
   Args1(C_INT(n));
-  Inst_Printf("call_c", FAST "Pl_Allocate(%d)", n);
+  Inst_Printf("call_c", FAST "Pl_Allocate(%d,%d)", n, cur_arity); /* live X for the GC */
 }
 
 
@@ -2083,14 +2088,15 @@ Emit_Obj_Initializer(void)
       else
 	q = "0";
 
+      if (!p->hidden)		/* a hidden pred is only reachable from its file */
 #if 0  /* uncomment this to support modules */
-      Inst_Printf("call_c", FAST "Pl_Create_Pred(at(%d),at(%d),%d,at(%d),%d,%d,%s)",
-		  p->module->value, p->functor->value, p->arity, p->pl_file->value, p->pl_line,
-		  p->prop, q);
+	Inst_Printf("call_c", FAST "Pl_Create_Pred(at(%d),at(%d),%d,at(%d),%d,%d,%s)",
+		    p->module->value, p->functor->value, p->arity, p->pl_file->value, p->pl_line,
+		    p->prop, q);
 #else
-      Inst_Printf("call_c", FAST "Pl_Create_Pred(at(%d),%d,at(%d),%d,%d,%s)",
-		  p->functor->value, p->arity, p->pl_file->value, p->pl_line,
-		  p->prop, q);
+	Inst_Printf("call_c", FAST "Pl_Create_Pred(at(%d),%d,at(%d),%d,%d,%s)",
+		    p->functor->value, p->arity, p->pl_file->value, p->pl_line,
+		    p->prop, q);
 #endif
 
       cur_pred_no++;		/* for FORMAT_LABEL */